@@ -0,0 +1,156 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "teem/air.h"
+
+/*
+** Tests:
+** airArenaNew, airArenaAlloc, airArenaReset, airArenaNix
+** airMopArenaAlloc
+** (including that allocations are 16-byte aligned, for SIMD types)
+**
+** Also uses:
+** airMopNew, airMopAdd, airMopError, airMopOkay
+*/
+
+#define ALLOC_NUM 1000
+#define ALIGN 16
+
+static int
+check(airArena *arena, const char *me) {
+  unsigned char *mem[ALLOC_NUM];
+  size_t sz, allocBytes;
+  unsigned int ii, jj;
+
+  allocBytes = 0;
+  for (ii=0; ii<ALLOC_NUM; ii++) {
+    /* mostly small, with some bigger than the block size */
+    sz = (ii % 100 ? ii % 37 : 3*arena->blockSize + ii);
+    mem[ii] = AIR_CAST(unsigned char *, airArenaAlloc(arena, sz));
+    if (!mem[ii]) {
+      fprintf(stderr, "%s: allocation %u (size %u) failed\n", me,
+              ii, AIR_UINT(sz));
+      return 1;
+    }
+    if (0 != AIR_CAST(size_t, mem[ii]) % ALIGN) {
+      fprintf(stderr, "%s: allocation %u (%p) not %u-byte aligned\n", me,
+              ii, AIR_VOIDP(mem[ii]), ALIGN);
+      return 1;
+    }
+    for (jj=0; jj<sz; jj++) {
+      if (mem[ii][jj]) {
+        fprintf(stderr, "%s: allocation %u not zero-filled\n", me, ii);
+        return 1;
+      }
+    }
+    /* fill with something that a later overlapping allocation will see */
+    memset(mem[ii], 1 + ii % 250, sz);
+    allocBytes += sz;
+  }
+  /* make sure nothing overlapped */
+  for (ii=0; ii<ALLOC_NUM; ii++) {
+    sz = (ii % 100 ? ii % 37 : 3*arena->blockSize + ii);
+    for (jj=0; jj<sz; jj++) {
+      if (1 + ii % 250 != mem[ii][jj]) {
+        fprintf(stderr, "%s: allocation %u was overwritten\n", me, ii);
+        return 1;
+      }
+    }
+  }
+  if (ALLOC_NUM != arena->allocNum || allocBytes != arena->allocBytes) {
+    fprintf(stderr, "%s: stats allocNum %u allocBytes %u != %u %u\n", me,
+            AIR_UINT(arena->allocNum), AIR_UINT(arena->allocBytes),
+            ALLOC_NUM, AIR_UINT(allocBytes));
+    return 1;
+  }
+  if (arena->blockBytes < allocBytes
+      || arena->blockBytesMax < arena->blockBytes) {
+    fprintf(stderr, "%s: stats blockBytes %u (max %u) < allocBytes %u\n",
+            me, AIR_UINT(arena->blockBytes), AIR_UINT(arena->blockBytesMax),
+            AIR_UINT(allocBytes));
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(int argc, const char *argv[]) {
+  airArray *mop;
+  airArena *arena;
+  const char *me;
+  double *dd;
+  unsigned int ii;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  arena = airArenaNew(1000);
+  airMopAdd(mop, arena, (airMopper)airArenaNix, airMopAlways);
+  if (!arena) {
+    fprintf(stderr, "%s: couldn't make arena\n", me);
+    airMopError(mop); exit(1);
+  }
+  if (check(arena, me)) {
+    airMopError(mop); exit(1);
+  }
+  airArenaReset(arena);
+  if (1 != arena->blockNum || arena->allocNum || arena->allocBytes) {
+    fprintf(stderr, "%s: after reset, blockNum %u allocNum %u "
+            "allocBytes %u != 1 0 0\n", me, AIR_UINT(arena->blockNum),
+            AIR_UINT(arena->allocNum), AIR_UINT(arena->allocBytes));
+    airMopError(mop); exit(1);
+  }
+  /* same again, re-using the block that reset kept */
+  if (check(arena, me)) {
+    airMopError(mop); exit(1);
+  }
+  if (airArenaAlloc(NULL, 10)) {
+    fprintf(stderr, "%s: airArenaAlloc(NULL) didn't return NULL\n", me);
+    airMopError(mop); exit(1);
+  }
+
+  /* arena managed by the mop; all its memory freed by airMopOkay */
+  for (ii=0; ii<ALLOC_NUM; ii++) {
+    dd = AIR_CAST(double *, airMopArenaAlloc(mop, (1 + ii)*sizeof(double)));
+    if (!dd) {
+      fprintf(stderr, "%s: airMopArenaAlloc %u failed\n", me, ii);
+      airMopError(mop); exit(1);
+    }
+    if (0 != AIR_CAST(size_t, dd) % ALIGN) {
+      fprintf(stderr, "%s: airMopArenaAlloc %u (%p) not %u-byte aligned\n",
+              me, ii, AIR_VOIDP(dd), ALIGN);
+      airMopError(mop); exit(1);
+    }
+    dd[ii] = ii;
+  }
+  /* arena + mop arena */
+  if (2 != mop->len) {
+    fprintf(stderr, "%s: mop has %u entries, not 2\n", me, mop->len);
+    airMopError(mop); exit(1);
+  }
+
+  airMopOkay(mop);
+  exit(0);
+}
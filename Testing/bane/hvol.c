@@ -0,0 +1,201 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/bane.h"
+
+/*
+** Tests:
+** baneMakeHVol, measuring by streaming separable convolution and by
+** gageProbe()ing every voxel, with 1 and with 3 threads, with and
+** without the measurement volume: all must give the same histogram
+** volume, for node- and cell-centered inputs, for the 2nd DD and the
+** Laplacian, and for two sets of kernels
+*/
+
+#define HVOL_RES 32
+
+typedef struct {
+  int center;
+  int secondMeasr;                      /* measure on axis 1 */
+  const char *kern[3];                  /* k00, k11, k22 */
+} hvolCase;
+
+typedef struct {
+  int separable, makeMeasrVol;
+  unsigned int numThreads;
+} hvolHow;
+
+/* makes the histogram volume of nin in nout, as hc and how say */
+static int
+makeHVol(Nrrd *nout, const Nrrd *nin, const hvolCase *hc,
+         const hvolHow *how, airArray *mop) {
+  static const char me[]="makeHVol";
+  static const int kidx[3] = {gageKernel00, gageKernel11, gageKernel22};
+  baneHVolParm *hvp;
+  baneMeasr *measr;
+  baneInc *inc;
+  baneClip *clip;
+  double parm[BANE_PARM_NUM];
+  unsigned int ki;
+  char *err;
+
+  hvp = baneHVolParmNew();
+  airMopAdd(mop, hvp, (airMopper)baneHVolParmNix, airMopAlways);
+  baneHVolParmGKMSInit(hvp);
+  hvp->verbose = 0;
+  hvp->k3pack = AIR_TRUE;
+  hvp->separable = how->separable;
+  hvp->makeMeasrVol = how->makeMeasrVol;
+  hvp->numThreads = how->numThreads;
+  for (ki=0; ki<3; ki++) {
+    hvp->axis[ki].res = HVOL_RES;
+    if (nrrdKernelParse(&(hvp->k[kidx[ki]]), hvp->kparm[kidx[ki]],
+                        hc->kern[ki])) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble parsing \"%s\":\n%s", me,
+              hc->kern[ki], err);
+      return 1;
+    }
+  }
+  if (baneMeasr2ndDD != hc->secondMeasr) {
+    /* the measure ignores these; the inclusion uses them */
+    parm[0] = 1024;
+    parm[1] = 0.25;
+    measr = baneMeasrNew(hc->secondMeasr, parm);
+    airMopAdd(mop, measr, (airMopper)baneMeasrNix, airMopAlways);
+    inc = baneIncNew(baneIncPercentile, measr->range, parm);
+    airMopAdd(mop, inc, (airMopper)baneIncNix, airMopAlways);
+    baneHVolParmAxisSet(hvp, 1, HVOL_RES, measr, inc);
+  }
+  /* so that the output is the raw hit count, up to 255 */
+  parm[0] = 255;
+  clip = baneClipNew(baneClipAbsolute, parm);
+  airMopAdd(mop, clip, (airMopper)baneClipNix, airMopAlways);
+  baneHVolParmClipSet(hvp, clip);
+  if (baneMakeHVol(nout, AIR_CAST(Nrrd *, nin), hvp)) {
+    airMopAdd(mop, err = biffGetDone(BANE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble making histogram volume:\n%s", me, err);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(void) {
+  static const hvolCase hcase[] = {
+    {nrrdCenterNode, baneMeasr2ndDD, {"cubic:0,0.5", "cubicd:1,0",
+                                      "cubicdd:1,0"}},
+    {nrrdCenterCell, baneMeasr2ndDD, {"tent", "cubicd:0,0.5",
+                                      "cubicdd:1,0"}},
+    {nrrdCenterNode, baneMeasrLaplacian, {"cubic:0,0.5", "cubicd:1,0",
+                                          "cubicdd:1,0"}},
+    {nrrdCenterCell, baneMeasrLaplacian, {"bspl5", "bspl5d",
+                                          "bspl5dd"}}
+  };
+  static const hvolHow hhow[] = {
+    /* the first one is the reference */
+    {AIR_FALSE, AIR_TRUE, 1},
+    {AIR_TRUE, AIR_TRUE, 1},
+    {AIR_TRUE, AIR_TRUE, 3},
+    {AIR_TRUE, AIR_FALSE, 3},
+    {AIR_FALSE, AIR_TRUE, 3},
+    {AIR_FALSE, AIR_FALSE, 1}
+  };
+  airArray *mop;
+  airRandMTState *rng;
+  char *err;
+  Nrrd *nin, *nref, *nout;
+  double val, xx, yy, zz;
+  size_t ii, NN, hits;
+  unsigned int ci, hi, ai;
+  int center[3];
+
+  mop = airMopNew();
+  rng = airRandMTStateNew(4242);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nref = nrrdNew();
+  airMopAdd(mop, nref, (airMopper)nrrdNuke, airMopAlways);
+  nout = nrrdNew();
+  airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  /* a slightly noisy blurry ball */
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, 23),
+                        AIR_CAST(size_t, 20), AIR_CAST(size_t, 18))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.1, 1.3);
+  NN = nrrdElementNumber(nin);
+  for (ii=0; ii<NN; ii++) {
+    xx = AIR_AFFINE(0, ii % 23, 22, -1, 1);
+    yy = AIR_AFFINE(0, (ii/23) % 20, 19, -1, 1);
+    zz = AIR_AFFINE(0, ii/(23*20), 17, -1, 1);
+    val = 100*(1 + tanh(10*(0.6 - sqrt(xx*xx + yy*yy + zz*zz))));
+    val += AIR_AFFINE(0, airDrandMT_r(rng), 1, -2, 2);
+    nrrdFInsert[nrrdTypeFloat](nin->data, ii, AIR_CAST(float, val));
+  }
+
+  for (ci=0; ci<AIR_CAST(unsigned int, sizeof(hcase)/sizeof(hcase[0]));
+       ci++) {
+    const hvolCase *hc = hcase + ci;
+    for (ai=0; ai<3; ai++) {
+      center[ai] = hc->center;
+    }
+    nrrdAxisInfoSet_nva(nin, nrrdAxisInfoCenter, center);
+    for (hi=0; hi<AIR_CAST(unsigned int, sizeof(hhow)/sizeof(hhow[0]));
+         hi++) {
+      if (makeHVol(hi ? nout : nref, nin, hc, hhow + hi, mop)) {
+        fprintf(stderr, "case %u, how %u: trouble\n", ci, hi);
+        airMopError(mop); return 1;
+      }
+      if (!hi) {
+        /* the reference has to have something in it */
+        hits = 0;
+        for (ii=0; ii<nrrdElementNumber(nref); ii++) {
+          hits += nrrdDLookup[nref->type](nref->data, ii) > 0;
+        }
+        if (hits < 100) {
+          fprintf(stderr, "case %u: only %u bins hit\n", ci,
+                  AIR_CAST(unsigned int, hits));
+          airMopError(mop); return 1;
+        }
+        continue;
+      }
+      if (nrrdElementNumber(nout) != nrrdElementNumber(nref)
+          || nout->type != nref->type
+          || memcmp(nout->data, nref->data,
+                    nrrdElementNumber(nref)*nrrdElementSize(nref))) {
+        fprintf(stderr, "case %u: histogram volume with separable %d, "
+                "makeMeasrVol %d, %u threads differs from reference\n", ci,
+                hhow[hi].separable, hhow[hi].makeMeasrVol,
+                hhow[hi].numThreads);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,175 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/biff.h"
+
+/*
+** Tests:
+** biffThreadLocalSet
+** biffAddf, biffCheck, biffGetDone from concurrent threads
+** threads inheriting the store of the thread that started them
+**
+** Also uses:
+** airThreadNew, airThreadStart, airThreadJoin, airThreadNix
+*/
+
+#define THREAD_NUM 8
+#define ERR_NUM 200
+
+typedef struct {
+  unsigned int idx;
+  int local, bad;
+} tTask;
+
+static void *
+tWorker(void *_task) {
+  tTask *task;
+  unsigned int ei;
+  char *err, good[AIR_STRLEN_MED];
+
+  task = AIR_CAST(tTask *, _task);
+  if (task->local && biffThreadLocalSet(AIR_TRUE)) {
+    task->bad = AIR_TRUE;
+    return _task;
+  }
+  for (ei=0; ei<ERR_NUM; ei++) {
+    biffAddf("tthread", "thread %u error %u", task->idx, ei);
+  }
+  if (task->local) {
+    /* this thread should see only its own messages */
+    if (ERR_NUM != biffCheck("tthread")) {
+      task->bad = AIR_TRUE;
+    }
+    err = biffGetDone("tthread");
+    sprintf(good, "[tthread] thread %u error %u\n", task->idx, ERR_NUM-1);
+    if (strncmp(err, good, strlen(good))) {
+      task->bad = AIR_TRUE;
+    }
+    free(err);
+    if (biffThreadLocalSet(AIR_FALSE)) {
+      task->bad = AIR_TRUE;
+    }
+  }
+  return _task;
+}
+
+static int
+tRun(const char *me, int local) {
+  airThread *thread[THREAD_NUM];
+  tTask task[THREAD_NUM];
+  unsigned int ti;
+  int ret;
+
+  ret = 0;
+  for (ti=0; ti<THREAD_NUM; ti++) {
+    task[ti].idx = ti;
+    task[ti].local = local;
+    task[ti].bad = AIR_FALSE;
+    thread[ti] = airThreadNew();
+    if (airThreadStart(thread[ti], tWorker, task + ti)) {
+      fprintf(stderr, "%s: couldn't start thread %u\n", me, ti);
+      return 1;
+    }
+  }
+  for (ti=0; ti<THREAD_NUM; ti++) {
+    if (airThreadJoin(thread[ti], NULL)) {
+      fprintf(stderr, "%s: couldn't join thread %u\n", me, ti);
+      return 1;
+    }
+    airThreadNix(thread[ti]);
+    if (task[ti].bad) {
+      fprintf(stderr, "%s: (local=%d) thread %u saw wrong messages\n",
+              me, local, ti);
+      ret = 1;
+    }
+  }
+  return ret;
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  char *err;
+  unsigned int num;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+
+  /* a message in the process-wide store, which the threads with their
+     own stores shouldn't see or disturb */
+  biffAdd("tthread", "main error");
+  if (tRun(me, AIR_TRUE)) {
+    exit(1);
+  }
+  if (1 != biffCheck("tthread")) {
+    fprintf(stderr, "%s: process-wide store disturbed (%u != 1)\n",
+            me, biffCheck("tthread"));
+    exit(1);
+  }
+
+  /* all threads adding to the process-wide store at once */
+  if (tRun(me, AIR_FALSE)) {
+    exit(1);
+  }
+  num = biffCheck("tthread");
+  if (1 + THREAD_NUM*ERR_NUM != num) {
+    fprintf(stderr, "%s: got %u messages, not %u\n", me, num,
+            1 + THREAD_NUM*ERR_NUM);
+    exit(1);
+  }
+  err = biffGetDone("tthread");
+  free(err);
+
+  /* with the main thread using its own store, threads it starts add to
+     that store, and not to the process-wide one */
+  biffAdd("tthread", "main error");
+  if (biffThreadLocalSet(AIR_TRUE)) {
+    fprintf(stderr, "%s: couldn't set local store\n", me);
+    exit(1);
+  }
+  if (tRun(me, AIR_FALSE)) {
+    exit(1);
+  }
+  num = biffCheck("tthread");
+  if (airThreadCapable && THREAD_NUM*ERR_NUM != num) {
+    fprintf(stderr, "%s: got %u inherited messages, not %u\n", me, num,
+            THREAD_NUM*ERR_NUM);
+    exit(1);
+  }
+  err = biffGetDone("tthread");
+  free(err);
+  if (biffThreadLocalSet(AIR_FALSE)) {
+    fprintf(stderr, "%s: couldn't unset local store\n", me);
+    exit(1);
+  }
+  num = biffCheck("tthread");
+  if (airThreadCapable && 1 != num) {
+    fprintf(stderr, "%s: process-wide store has %u messages, not 1\n",
+            me, num);
+    exit(1);
+  }
+  err = biffGetDone("tthread");
+  free(err);
+
+  exit(0);
+}
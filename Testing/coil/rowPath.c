@@ -0,0 +1,149 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/coil.h"
+
+/*
+** Tests:
+** that the row path of coilIterate (kind->filterRow[], with temporal
+** blocking over slabs) gives output bit-identical to the per-voxel
+** path, for the scalar methods that have a filterRow, with 1 and with
+** 3 threads, and with various iteration blocks and slab sizes
+*/
+
+#define ITER_NUM 5  /* not a multiple of any iterBlock below */
+
+typedef struct {
+  unsigned int numThreads, iterBlock, slabSize;
+} rowCase;
+
+/* filters nin with method, with or without the row path */
+static int
+coilRun(Nrrd *nout, const Nrrd *nin, const coilMethod *method,
+        double parm[COIL_PARMS_NUM], int rowPath, const rowCase *rc,
+        airArray *mop) {
+  static const char me[]="coilRun";
+  coilContext *cctx;
+  char *err;
+
+  cctx = coilContextNew();
+  airMopAdd(mop, cctx, (airMopper)coilContextNix, airMopAlways);
+  if (coilContextAllSet(cctx, nin, coilKindScalar, method,
+                        1, rc->numThreads, 0, parm)) {
+    airMopAdd(mop, err = biffGetDone(COIL), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up %s:\n%s", me, method->name, err);
+    return 1;
+  }
+  cctx->rowPath = rowPath;
+  cctx->iterBlock = rc->iterBlock;
+  cctx->slabSize = rc->slabSize;
+  if (coilStart(cctx)
+      || coilIterate(cctx, ITER_NUM)
+      || coilFinish(cctx)
+      || coilOutputGet(nout, cctx)) {
+    airMopAdd(mop, err = biffGetDone(COIL), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble filtering with %s:\n%s", me,
+            method->name, err);
+    return 1;
+  }
+  if (rowPath && !cctx->rowDo) {
+    fprintf(stderr, "%s: row path wasn't used for %s\n", me, method->name);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(void) {
+  static const rowCase rcase[] = {
+    {1, 1, 1},
+    {1, 2, 16},
+    {3, 2, 4},
+    {3, 3, 5},
+    {1, 4, 100}
+  };
+  static const unsigned int methodType[] = {
+    coilMethodTypeHomogeneous,
+    coilMethodTypePeronaMalik,
+    coilMethodTypeModifiedCurvature
+  };
+  airArray *mop;
+  airRandMTState *rng;
+  char *err;
+  Nrrd *nin, *nvox, *nrow;
+  double parm[COIL_PARMS_NUM], val;
+  size_t ii, NN;
+  unsigned int mi, ci;
+
+  mop = airMopNew();
+  rng = airRandMTStateNew(4242);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nvox = nrrdNew();
+  airMopAdd(mop, nvox, (airMopper)nrrdNuke, airMopAlways);
+  nrow = nrrdNew();
+  airMopAdd(mop, nrow, (airMopper)nrrdNuke, airMopAlways);
+  /* a noisy step edge, with anisotropic spacing */
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, 13),
+                        AIR_CAST(size_t, 11), AIR_CAST(size_t, 17))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.2, 0.8);
+  NN = nrrdElementNumber(nin);
+  for (ii=0; ii<NN; ii++) {
+    val = (ii % 13 + ii/(13*11) > 14 ? 10 : 0);
+    val += AIR_AFFINE(0, airDrandMT_r(rng), 1, -1, 1);
+    nrrdFInsert[nrrdTypeFloat](nin->data, ii, AIR_CAST(float, val));
+  }
+
+  for (mi=0; mi<AIR_CAST(unsigned int,
+                         sizeof(methodType)/sizeof(methodType[0])); mi++) {
+    const coilMethod *method = coilMethodArray[methodType[mi]];
+    parm[0] = 0.1;   /* time step */
+    parm[1] = 3;     /* K, if used */
+    parm[2] = 0.3;   /* lerp, if used */
+    for (ci=0; ci<AIR_CAST(unsigned int, sizeof(rcase)/sizeof(rcase[0]));
+         ci++) {
+      const rowCase *rc = rcase + ci;
+      if (coilRun(nvox, nin, method, parm, AIR_FALSE, rc, mop)
+          || coilRun(nrow, nin, method, parm, AIR_TRUE, rc, mop)) {
+        airMopError(mop); return 1;
+      }
+      if (nrrdElementNumber(nvox) != nrrdElementNumber(nrow)
+          || nvox->type != nrow->type
+          || memcmp(nvox->data, nrow->data,
+                    nrrdElementNumber(nvox)*nrrdElementSize(nvox))) {
+        fprintf(stderr, "%s with %u threads, iterBlock %u, slabSize %u: "
+                "row path differs from per-voxel path\n", method->name,
+                rc->numThreads, rc->iterBlock, rc->slabSize);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
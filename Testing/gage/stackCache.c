@@ -0,0 +1,184 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** gageStackBlurCacheGet, with a cache in the current directory: the
+** same volume is reused from the cache, but the same values placed
+** differently in world space (space origin or direction) are blurred
+** anew and cached separately; gageStackBlurCheck rejecting blurrings of a differently
+** oriented volume.  The volume values are seeded by the time, so that
+** cached stacks from earlier runs aren't found; the small cache size
+** keeps the current directory from filling up with them.
+*/
+
+#define CACHE_DIR "."
+#define CACHE_MB 2.0
+
+/* gets blurrings of nin through the cache; *recP is set to whether
+   they were recomputed */
+static int
+cacheGet(Nrrd ***nblurP, int *recP, gageStackBlurParm *sbp,
+         const Nrrd *nin, const char *what, airArray *mop) {
+  char *err;
+  unsigned int ii;
+
+  *nblurP = AIR_CALLOC(sbp->num, Nrrd *);
+  airMopAdd(mop, *nblurP, airFree, airMopAlways);
+  for (ii=0; ii<sbp->num; ii++) {
+    (*nblurP)[ii] = nrrdNew();
+    airMopAdd(mop, (*nblurP)[ii], (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (gageStackBlurCacheGet(*nblurP, recP, sbp, CACHE_DIR, CACHE_MB,
+                            nin, gageKindScl)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble getting %s blurrings:\n%s", what, err);
+    return 1;
+  }
+  if (gageStackBlurCheck(AIR_CAST(const Nrrd*const*, *nblurP), sbp,
+                         nin, gageKindScl)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s blurrings don't match their volume:\n%s",
+            what, err);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(void) {
+  airArray *mop;
+  gageStackBlurParm *sbp;
+  char *err;
+  Nrrd *nin, *nmov, *nrot, **nblur, **nbmov, **nbrot;
+  double *in, origin[3] = {1, 2, 3}, dir[3][3] = {{1.5, 0, 0},
+                                                  {0, 1.5, 0},
+                                                  {0, 0, 2}};
+  size_t sizes[3] = {20, 21, 22}, ii, nn;
+  int rec;
+
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_nva(nin, nrrdTypeDouble, 3, sizes)
+      || nrrdSpaceSet(nin, nrrdSpaceRightAnteriorSuperior)
+      || nrrdSpaceOriginSet(nin, origin)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting up volume:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpaceDirection,
+                     dir[0], dir[1], dir[2]);
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoCenter, nrrdCenterCell,
+                     nrrdCenterCell, nrrdCenterCell);
+  in = AIR_CAST(double *, nin->data);
+  nn = nrrdElementNumber(nin);
+  airSrandMT(AIR_UINT(1000000*airTime()));
+  for (ii=0; ii<nn; ii++) {
+    in[ii] = airDrandMT();
+  }
+
+  sbp = gageStackBlurParmNew();
+  airMopAdd(mop, sbp, (airMopper)gageStackBlurParmNix, airMopAlways);
+  if (gageStackBlurParmParse(sbp, NULL, NULL, "1-3-3-d/k=gauss:1,4/b=bleed")
+      || gageStackBlurParmVerboseSet(sbp, 0)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting blur parms:\n%s", err);
+    airMopError(mop); return 1;
+  }
+
+  /* new values: have to be computed; then they are cached */
+  if (cacheGet(&nblur, &rec, sbp, nin, "original", mop)) {
+    airMopError(mop); return 1;
+  }
+  if (!rec) {
+    fprintf(stderr, "blurrings of new volume weren't recomputed\n");
+    airMopError(mop); return 1;
+  }
+  if (cacheGet(&nblur, &rec, sbp, nin, "original", mop)) {
+    airMopError(mop); return 1;
+  }
+  if (rec) {
+    fprintf(stderr, "cached blurrings weren't reused\n");
+    airMopError(mop); return 1;
+  }
+
+  /* the same values, moved */
+  nmov = nrrdNew();
+  airMopAdd(mop, nmov, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdCopy(nmov, nin)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble copying:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  nmov->spaceOrigin[1] += 10;
+  if (cacheGet(&nbmov, &rec, sbp, nmov, "moved", mop)) {
+    airMopError(mop); return 1;
+  }
+  if (!rec) {
+    fprintf(stderr, "blurrings of moved volume weren't recomputed\n");
+    airMopError(mop); return 1;
+  }
+  /* the same values, with the first two axes swapped in world space */
+  nrot = nrrdNew();
+  airMopAdd(mop, nrot, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdCopy(nrot, nin)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble copying:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  ELL_3V_SET(nrot->axis[0].spaceDirection, 0, 1.5, 0);
+  ELL_3V_SET(nrot->axis[1].spaceDirection, 1.5, 0, 0);
+  if (cacheGet(&nbrot, &rec, sbp, nrot, "rotated", mop)) {
+    airMopError(mop); return 1;
+  }
+  if (!rec) {
+    fprintf(stderr, "blurrings of rotated volume weren't recomputed\n");
+    airMopError(mop); return 1;
+  }
+
+  /* with its own cache key, the original didn't get overwritten */
+  if (cacheGet(&nblur, &rec, sbp, nin, "original", mop)) {
+    airMopError(mop); return 1;
+  }
+  if (rec) {
+    fprintf(stderr, "cached blurrings of original were overwritten\n");
+    airMopError(mop); return 1;
+  }
+
+  /* blurrings are only right for the orientation they were made for */
+  if (!gageStackBlurCheck(AIR_CAST(const Nrrd*const*, nblur), sbp,
+                          nmov, gageKindScl)
+      || !gageStackBlurCheck(AIR_CAST(const Nrrd*const*, nbrot), sbp,
+                             nin, gageKindScl)) {
+    fprintf(stderr, "gageStackBlurCheck didn't notice orientation "
+            "change\n");
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,310 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** gageStackLazyNew and gageStackLazyPerVolumeNew, probing lazily
+** blurred stacks (from several threads, with gageContextCopy, and with
+** a memory limit small enough that bricks are evicted) against probing
+** the levels from gageStackBlur; a brick that can't be blurred making
+** gageStackProbe fail with gageErrStackLazy, without leaving messages
+** in the NRRD biff key, and the same probe working once it can be.
+*/
+
+#define THREAD_NUM 3
+#define PROBE_NUM 2000  /* # of probes per thread */
+/* the largest difference allowed between lazy and full blurring;
+   both resample the same way, so they should agree to rounding */
+#define LAZY_EPS 1e-12
+
+/* a stack context probing the value and gradient of the blurrings
+   nblur, if non-NULL, or else of the lazily blurred lazy */
+static gageContext *
+stackContext(const Nrrd *nin, const gageStackBlurParm *sbp,
+             const Nrrd *const *nblur, gageStackLazy *lazy,
+             gagePerVolume **pvlP, airArray *mop) {
+  gageContext *ctx;
+  gagePerVolume *pvl, **pvlSS;
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 0.0, 0.5};
+  char *err;
+  int E;
+
+  ctx = gageContextNew();
+  airMopAdd(mop, ctx, (airMopper)gageContextNix, airMopAlways);
+  pvlSS = AIR_CALLOC(sbp->num, gagePerVolume *);
+  airMopAdd(mop, pvlSS, airFree, airMopAlways);
+  gageParmSet(ctx, gageParmStackUse, AIR_TRUE);
+  E = 0;
+  if (!E) E |= !(pvl = gagePerVolumeNew(ctx, nin, gageKindScl));
+  if (!E) E |= (nblur
+                ? gageStackPerVolumeNew(ctx, pvlSS, nblur, sbp->num,
+                                        gageKindScl)
+                : gageStackLazyPerVolumeNew(ctx, pvlSS, lazy));
+  if (!E) E |= gageStackPerVolumeAttach(ctx, pvl, pvlSS, sbp->sigma,
+                                        sbp->num);
+  if (!E) E |= gageKernelSet(ctx, gageKernel00, nrrdKernelBCCubic, kparm);
+  if (!E) E |= gageKernelSet(ctx, gageKernel11, nrrdKernelBCCubicD,
+                             kparm);
+  if (!E) E |= gageKernelSet(ctx, gageKernelStack, nrrdKernelTent, kparm);
+  if (!E) E |= gageQueryItemOn(ctx, pvl, gageSclValue);
+  if (!E) E |= gageQueryItemOn(ctx, pvl, gageSclGradVec);
+  if (!E) E |= gageUpdate(ctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting up %s context:\n%s",
+            nblur ? "full" : "lazy", err);
+    return NULL;
+  }
+  *pvlP = pvl;
+  return ctx;
+}
+
+typedef struct {
+  gageContext *ctx[THREAD_NUM];
+  gagePerVolume *pvl[THREAD_NUM];
+  const double *pos;           /* 4 x THREAD_NUM x PROBE_NUM positions */
+  double *ans;                 /* 4 x THREAD_NUM x PROBE_NUM answers */
+  int failed;
+} probeShared;
+
+static void
+probeJob(void *_shared, unsigned int jobIdx, unsigned int threadIdx) {
+  probeShared *shared;
+  const double *val, *grad, *pos;
+  double *ans;
+  unsigned int pi;
+
+  shared = AIR_CAST(probeShared *, _shared);
+  val = gageAnswerPointer(shared->ctx[threadIdx], shared->pvl[threadIdx],
+                          gageSclValue);
+  grad = gageAnswerPointer(shared->ctx[threadIdx], shared->pvl[threadIdx],
+                           gageSclGradVec);
+  for (pi=0; pi<PROBE_NUM; pi++) {
+    pos = shared->pos + 4*(pi + PROBE_NUM*jobIdx);
+    ans = shared->ans + 4*(pi + PROBE_NUM*jobIdx);
+    if (gageStackProbe(shared->ctx[threadIdx], pos[0], pos[1], pos[2],
+                       pos[3])) {
+      fprintf(stderr, "probe (%g,%g,%g,%g) failed: %s\n", pos[0], pos[1],
+              pos[2], pos[3], shared->ctx[threadIdx]->errStr);
+      shared->failed = AIR_TRUE;
+      return;
+    }
+    ans[0] = val[0];
+    ELL_3V_COPY(ans + 1, grad);
+  }
+  return;
+}
+
+/* probes nin's blurrings both ways, with boundary behavior bound, and
+   sets *diffP to the largest difference */
+static int
+compareProbe(double *diffP, unsigned int *evictP, const Nrrd *nin,
+             const char *bound, airArray *mop) {
+  gageStackBlurParm *sbp;
+  gageStackLazy *lazy;
+  probeShared shared[2];
+  Nrrd **nblur;
+  char *err, sbpStr[AIR_STRLEN_MED];
+  double *pos, *ans[2], step, diff;
+  unsigned int ii, ti, si, nn;
+
+  sprintf(sbpStr, "1-6-5/k=gauss:1,4/b=%s", bound);
+  sbp = gageStackBlurParmNew();
+  airMopAdd(mop, sbp, (airMopper)gageStackBlurParmNix, airMopAlways);
+  if (gageStackBlurParmParse(sbp, NULL, NULL, sbpStr)
+      || gageStackBlurParmVerboseSet(sbp, 0)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble parsing \"%s\":\n%s", sbpStr, err);
+    return 1;
+  }
+  nblur = AIR_CALLOC(sbp->num, Nrrd *);
+  airMopAdd(mop, nblur, airFree, airMopAlways);
+  for (ii=0; ii<sbp->num; ii++) {
+    nblur[ii] = nrrdNew();
+    airMopAdd(mop, nblur[ii], (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (gageStackBlur(nblur, sbp, nin, gageKindScl)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble blurring \"%s\":\n%s", sbpStr, err);
+    return 1;
+  }
+  /* 8^3 bricks of doubles are 4K; this is room for 10 of them, less
+     than the (up to) 16 that each context can have pinned at once */
+  lazy = gageStackLazyNew(nin, gageKindScl, sbp, 8, 40.0/1024);
+  if (!lazy) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble creating lazy stack:\n%s", err);
+    return 1;
+  }
+  /* added before the contexts, so it is nixed after them */
+  airMopAdd(mop, lazy, (airMopper)gageStackLazyNix, airMopAlways);
+
+  nn = 4*THREAD_NUM*PROBE_NUM;
+  pos = AIR_CALLOC(nn, double);
+  airMopAdd(mop, pos, airFree, airMopAlways);
+  for (ii=0; ii<THREAD_NUM*PROBE_NUM; ii++) {
+    /* a random walk, so that successive probes often share bricks */
+    for (ti=0; ti<3; ti++) {
+      step = airDrandMT() - 0.5;
+      pos[ti + 4*ii] = (ii % PROBE_NUM
+                        ? AIR_CLAMP(0, pos[ti + 4*(ii-1)] + step,
+                                    nin->axis[ti].size - 1)
+                        : airDrandMT()*(nin->axis[ti].size - 1));
+    }
+    pos[3 + 4*ii] = airDrandMT()*(sbp->num - 1);
+  }
+  for (si=0; si<2; si++) {
+    /* si=0: full blurrings, si=1: lazy */
+    ans[si] = AIR_CALLOC(nn, double);
+    airMopAdd(mop, ans[si], airFree, airMopAlways);
+    shared[si].pos = pos;
+    shared[si].ans = ans[si];
+    shared[si].failed = AIR_FALSE;
+    if (!( shared[si].ctx[0] =
+           stackContext(nin, sbp,
+                        si ? NULL : AIR_CAST(const Nrrd*const*, nblur),
+                        lazy, shared[si].pvl + 0, mop) )) {
+      return 1;
+    }
+    for (ti=1; ti<THREAD_NUM; ti++) {
+      shared[si].ctx[ti] = gageContextCopy(shared[si].ctx[0]);
+      if (!shared[si].ctx[ti]) {
+        airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+        fprintf(stderr, "trouble copying context:\n%s", err);
+        return 1;
+      }
+      airMopAdd(mop, shared[si].ctx[ti], (airMopper)gageContextNix,
+                airMopAlways);
+      shared[si].pvl[ti] = shared[si].ctx[ti]->pvl[sbp->num];
+    }
+    if (nrrdThreadRun(THREAD_NUM, THREAD_NUM, probeJob, shared + si)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "trouble running threads:\n%s", err);
+      return 1;
+    }
+    if (shared[si].failed) {
+      fprintf(stderr, "a %s probe failed\n", si ? "lazy" : "full");
+      return 1;
+    }
+  }
+  diff = 0;
+  for (ii=0; ii<nn; ii++) {
+    diff = AIR_MAX(diff, AIR_ABS(ans[1][ii] - ans[0][ii]));
+  }
+  *diffP = diff;
+  *evictP = lazy->evictNum;
+  return 0;
+}
+
+int
+main(void) {
+  static const char *bstr[] = {"bleed", "mirror"};
+  airArray *mop;
+  char *err;
+  gageStackBlurParm *sbp;
+  gageStackLazy *lazy;
+  gageContext *ctx;
+  gagePerVolume *pvl;
+  Nrrd *nin;
+  double *in, diff;
+  size_t sizes[3] = {23, 26, 21}, ii, nn;
+  unsigned int bi, evictNum;
+  const NrrdKernel *kernel;
+  int ret;
+
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_nva(nin, nrrdTypeDouble, 3, sizes)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoCenter, nrrdCenterCell,
+                     nrrdCenterCell, nrrdCenterCell);
+  in = AIR_CAST(double *, nin->data);
+  nn = nrrdElementNumber(nin);
+  airSrandMT(4242);
+  for (ii=0; ii<nn; ii++) {
+    in[ii] = airDrandMT();
+  }
+  for (bi=0; bi<AIR_CAST(unsigned int, sizeof(bstr)/sizeof(bstr[0]));
+       bi++) {
+    if (compareProbe(&diff, &evictNum, nin, bstr[bi], mop)) {
+      airMopError(mop); return 1;
+    }
+    printf("%s: max |lazy - full| = %g (%u bricks evicted)\n",
+           bstr[bi], diff, evictNum);
+    if (!( diff <= LAZY_EPS && evictNum )) {
+      fprintf(stderr, "%s: lazy differs from full by %g > %g, or no "
+              "bricks evicted (%u)\n", bstr[bi], diff, LAZY_EPS,
+              evictNum);
+      airMopError(mop); return 1;
+    }
+  }
+
+  /* if bricks can't be blurred, probing has to fail */
+  sbp = gageStackBlurParmNew();
+  airMopAdd(mop, sbp, (airMopper)gageStackBlurParmNix, airMopAlways);
+  if (gageStackBlurParmParse(sbp, NULL, NULL, "1-3-3/k=gauss:1,4/b=bleed")
+      || gageStackBlurParmVerboseSet(sbp, 0)
+      || !(lazy = gageStackLazyNew(nin, gageKindScl, sbp, 8, 0))) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble creating lazy stack:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, lazy, (airMopper)gageStackLazyNix, airMopAlways);
+  if (!(ctx = stackContext(nin, sbp, NULL, lazy, &pvl, mop))) {
+    airMopError(mop); return 1;
+  }
+  /* (going behind gageStackLazyNew's back, which would have refused):
+     a kernel with a missing parameter, which resampling rejects */
+  kernel = lazy->sbp->kspec->kernel;
+  lazy->sbp->kspec->kernel = nrrdKernelBCCubic;
+  lazy->sbp->kspec->parm[2] = AIR_NAN;
+  ret = gageStackProbe(ctx, 10, 10, 10, 1);
+  lazy->sbp->kspec->kernel = kernel;
+  if (!( ret && gageErrStackLazy == ctx->errNum )) {
+    fprintf(stderr, "probing with bad kernel didn't fail right "
+            "(%d, %d)\n", ret, ctx->errNum);
+    airMopError(mop); return 1;
+  }
+  if (biffCheck(NRRD)) {
+    fprintf(stderr, "failed probe left %u NRRD biff messages\n",
+            biffCheck(NRRD));
+    airMopError(mop); return 1;
+  }
+  printf("probing with bad kernel failed as expected:\n%s\n",
+         ctx->errStr);
+  /* with the kernel fixed, the same probe has to work */
+  if (gageStackProbe(ctx, 10, 10, 10, 1)) {
+    fprintf(stderr, "probe after failure failed: %s\n", ctx->errStr);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
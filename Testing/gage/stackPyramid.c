@@ -0,0 +1,132 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** gageStackBlur with gageStackBlurParmPyramidSet, against blurring
+** every level directly, for each boundary behavior, with several
+** threads for the pyramid (and one for direct blurring).  nrrdBoundaryWeight
+** is not tested, since direct blurring with it makes NaNs (in
+** nrrdResampleExecute) near the volume boundary.
+*/
+
+/* the largest difference allowed, as a fraction of the data range
+   (which is [0,1] here); the differences measured are below 2e-5 */
+#define PYRAMID_EPS 3e-5
+
+/* blurs nin with and without pyramid, and sets *diffP to the largest
+   difference over all levels */
+static int
+compareBlur(double *diffP, const Nrrd *nin, const char *sbpStr,
+            int pyramid, airArray *mop) {
+  gageStackBlurParm *sbp;
+  Nrrd **nblur[2];
+  char *err;
+  double *pyr, *dir, diff;
+  unsigned int ii, pi;
+  size_t jj, nn;
+
+  sbp = gageStackBlurParmNew();
+  airMopAdd(mop, sbp, (airMopper)gageStackBlurParmNix, airMopAlways);
+  if (gageStackBlurParmParse(sbp, NULL, NULL, sbpStr)
+      || gageStackBlurParmVerboseSet(sbp, 0)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble parsing \"%s\":\n%s", sbpStr, err);
+    return 1;
+  }
+  for (pi=0; pi<2; pi++) {
+    nblur[pi] = AIR_CALLOC(sbp->num, Nrrd *);
+    airMopAdd(mop, nblur[pi], airFree, airMopAlways);
+    for (ii=0; ii<sbp->num; ii++) {
+      nblur[pi][ii] = nrrdNew();
+      airMopAdd(mop, nblur[pi][ii], (airMopper)nrrdNuke, airMopAlways);
+    }
+    /* pi=0: direct, with one thread; pi=1: pyramid, with three */
+    nrrdStateNumThreads = pi ? 3 : 1;
+    if (gageStackBlurParmPyramidSet(sbp, pi ? pyramid : AIR_FALSE)
+        || gageStackBlur(nblur[pi], sbp, nin, gageKindScl)) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "trouble blurring \"%s\" (pyramid %d):\n%s",
+              sbpStr, pi, err);
+      return 1;
+    }
+  }
+  nrrdStateNumThreads = 1;
+  diff = 0;
+  nn = nrrdElementNumber(nin);
+  for (ii=0; ii<sbp->num; ii++) {
+    dir = AIR_CAST(double *, nblur[0][ii]->data);
+    pyr = AIR_CAST(double *, nblur[1][ii]->data);
+    for (jj=0; jj<nn; jj++) {
+      diff = AIR_MAX(diff, AIR_ABS(pyr[jj] - dir[jj]));
+    }
+  }
+  *diffP = diff;
+  return 0;
+}
+
+int
+main(void) {
+  static const char *bound[] = {"bleed", "wrap", "pad:0.5", "mirror"};
+  airArray *mop;
+  char *err, sbpStr[AIR_STRLEN_MED];
+  Nrrd *nin;
+  double *in, diff;
+  size_t sizes[3] = {37, 42, 33}, ii, nn;
+  unsigned int bi;
+
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_nva(nin, nrrdTypeDouble, 3, sizes)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  /* values in [0,1]: uniform noise, all frequencies present */
+  in = AIR_CAST(double *, nin->data);
+  nn = nrrdElementNumber(nin);
+  airSrandMT(4242);
+  for (ii=0; ii<nn; ii++) {
+    in[ii] = airDrandMT();
+  }
+  for (bi=0; bi<AIR_CAST(unsigned int, sizeof(bound)/sizeof(bound[0]));
+       bi++) {
+    /* sigmas 1, 2.5, ... 11.5: factors 1, 2, and 4 are all used */
+    sprintf(sbpStr, "1-8-11.5-d/k=gauss:1,4/b=%s", bound[bi]);
+    if (compareBlur(&diff, nin, sbpStr, AIR_TRUE, mop)) {
+      airMopError(mop); return 1;
+    }
+    printf("%s: max |pyramid - direct| = %g\n", sbpStr, diff);
+    if (!( diff <= PYRAMID_EPS )) {
+      fprintf(stderr, "%s: pyramid differs from direct by %g > %g\n",
+              sbpStr, diff, PYRAMID_EPS);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -162,6 +162,8 @@ main(int argc, const char **argv) {
   parseOrDie("0-4-8.3-u");
   parseOrDie("0-4-8.3-u1rpn/k=dg:1,5");
   parseOrDie("0-4-8.3-u1rpn/k=dg:1,5/b=pad:42/v=1/dggsm=8");
+  parseOrDie("0-4-8.3-ui/k=gauss:1,4/b=bleed");
+  parseOrDie("0-4-8.3-ud/k=gauss:1,4/b=wrap");
   printf("\n");
 
   airMopOkay(mop);
@@ -0,0 +1,184 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/meet.h"
+
+/*
+** Tests:
+** pullRun with population control on a sphere isosurface, with one
+** thread, and partial neighbor discovery (so that neighbor lists
+** learned when new points are not added matter), against the result
+** (number of points, and sums of position coordinates and of their
+** squares) computed by the single-threaded population control that
+** preceded the parallel binning of new points.
+*/
+
+#define SIZE 48
+/* results from before parallel binning; differences in sums are
+   relative to POS_SQSUM, since POS_SUM is near zero */
+#define POINT_NUM 1734
+#define POS_SUM 95.04682374769267
+#define POS_SQSUM 679.47437049666144
+#define EPS 1e-9
+
+int
+main(void) {
+  static const char *infoStr[] = {"isoval-c:V:val:0:1",
+                                  "isogradvec:V:gvec",
+                                  "isohessian:V:hess"};
+  airArray *mop;
+  char *err;
+  Nrrd *nin, *npos;
+  NrrdKernelSpec *ksp[3];
+  pullContext *pctx;
+  pullEnergySpec *enspR, *enspS, *enspWin;
+  meetPullInfo *minf[3];
+  float *in;
+  double *pos, sum, sqsum;
+  unsigned int xi, yi, zi, ii, pntNum;
+  size_t sizes[3] = {SIZE, SIZE, SIZE};
+  int E;
+
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_nva(nin, nrrdTypeFloat, 3, sizes)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  /* signed distance to a sphere of radius 15, slightly off-center */
+  in = AIR_CAST(float *, nin->data);
+  for (zi=0; zi<SIZE; zi++) {
+    for (yi=0; yi<SIZE; yi++) {
+      for (xi=0; xi<SIZE; xi++) {
+        double xx, yy, zz;
+        xx = xi - SIZE/2.0 + 0.3;
+        yy = yi - SIZE/2.0 + 0.1;
+        zz = zi - SIZE/2.0 - 0.2;
+        in[xi + SIZE*(yi + SIZE*zi)] =
+          AIR_CAST(float, sqrt(xx*xx + yy*yy + zz*zz) - 15);
+      }
+    }
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoCenter, nrrdCenterCell,
+                     nrrdCenterCell, nrrdCenterCell);
+
+  for (ii=0; ii<3; ii++) {
+    ksp[ii] = nrrdKernelSpecNew();
+    airMopAdd(mop, ksp[ii], (airMopper)nrrdKernelSpecNix, airMopAlways);
+  }
+  enspR = pullEnergySpecNew();
+  airMopAdd(mop, enspR, (airMopper)pullEnergySpecNix, airMopAlways);
+  enspS = pullEnergySpecNew();
+  airMopAdd(mop, enspS, (airMopper)pullEnergySpecNix, airMopAlways);
+  enspWin = pullEnergySpecNew();
+  airMopAdd(mop, enspWin, (airMopper)pullEnergySpecNix, airMopAlways);
+  if (nrrdKernelSpecParse(ksp[0], "c4h")
+      || nrrdKernelSpecParse(ksp[1], "c4hd")
+      || nrrdKernelSpecParse(ksp[2], "c4hdd")) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble with kernels:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  if (pullEnergySpecParse(enspR, "cwell:0.7,-0.01")
+      || pullEnergySpecParse(enspS, "zero")
+      || pullEnergySpecParse(enspWin, "butter:16,0.8")) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "trouble with energies:\n%s", err);
+    airMopError(mop); return 1;
+  }
+
+  pctx = pullContextNew();
+  airMopAdd(mop, pctx, (airMopper)pullContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= pullVerboseSet(pctx, 0);
+  if (!E) E |= pullThreadNumSet(pctx, 1);
+  if (!E) E |= pullRngSeedSet(pctx, 42);
+  if (!E) E |= pullIterParmSet(pctx, pullIterParmMax, 60);
+  if (!E) E |= pullIterParmSet(pctx, pullIterParmPopCntlPeriod, 1);
+  if (!E) E |= pullIterParmSet(pctx, pullIterParmStuckMax, 5);
+  if (!E) E |= pullFlagSet(pctx, pullFlagPermuteOnRebin, AIR_TRUE);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmRadiusSpace, 0.08);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmBeta, 1.0);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmWall, 0.0);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmEnergyDecreaseMin, 0.0001);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmEnergyDecreasePopCntlMin,
+                              0.5);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmNeighborTrueProb, 0.3);
+  if (!E) E |= pullInterEnergySet(pctx, pullInterTypeJustR,
+                                  enspR, enspS, enspWin);
+  if (!E) E |= pullInitRandomSet(pctx, 30);
+  if (!E) E |= pullVolumeSingleAdd(pctx, gageKindScl, "V", nin,
+                                   ksp[0], ksp[1], ksp[2]);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting up system:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  for (ii=0; ii<3; ii++) {
+    minf[ii] = meetPullInfoNew();
+    airMopAdd(mop, minf[ii], (airMopper)meetPullInfoNix, airMopAlways);
+    if (meetPullInfoParse(minf[ii], infoStr[ii])) {
+      airMopAdd(mop, err = biffGetDone(MEET), airFree, airMopAlways);
+      fprintf(stderr, "trouble parsing info \"%s\":\n%s", infoStr[ii], err);
+      airMopError(mop); return 1;
+    }
+  }
+  if (meetPullInfoAddMulti(pctx, minf, 3)) {
+    airMopAdd(mop, err = biffGetDone(MEET), airFree, airMopAlways);
+    fprintf(stderr, "trouble adding infos:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  npos = nrrdNew();
+  airMopAdd(mop, npos, (airMopper)nrrdNuke, airMopAlways);
+  if (pullStart(pctx)
+      || pullRun(pctx)
+      || pullOutputGet(npos, NULL, NULL, NULL, 0, pctx)
+      || pullFinish(pctx)) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "trouble running system:\n%s", err);
+    airMopError(mop); return 1;
+  }
+
+  pntNum = AIR_UINT(npos->axis[1].size);
+  pos = AIR_CAST(double *, npos->data);
+  sum = sqsum = 0;
+  for (ii=0; ii<4*pntNum; ii++) {
+    sum += pos[ii];
+    sqsum += pos[ii]*pos[ii];
+  }
+  printf("%u points; sum = %.17g; sqsum = %.17g\n", pntNum, sum, sqsum);
+  if (!( POINT_NUM == pntNum
+         && AIR_ABS(sum - POS_SUM) <= EPS*POS_SQSUM
+         && AIR_ABS(sqsum - POS_SQSUM) <= EPS*POS_SQSUM )) {
+    fprintf(stderr, "result (%u points; %.17g, %.17g) != expected "
+            "(%u points; %.17g, %.17g)\n", pntNum, sum, sqsum,
+            POINT_NUM, POS_SUM, POS_SQSUM);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
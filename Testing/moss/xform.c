@@ -0,0 +1,163 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/moss.h"
+
+/*
+** Tests:
+** mossLinearTransform, with 1 and with 3 threads, giving exactly what
+** mossSamplerSample gives at every output pixel, for a shear (for which
+** the input y position depends only on the output row), for a scaling
+** with pad boundary (separable, with rows of background), and for a
+** general rotation (every pixel on its own)
+*/
+
+#define SX 23
+#define SY 19
+#define NCOL 2
+
+/* the transform of each case, with mat set by the case index */
+static void
+matSet(double *mat, unsigned int caseIdx) {
+  double tmp[6];
+
+  switch (caseIdx) {
+  case 0:
+    mossMatShearSet(mat, 0, 0.4);
+    break;
+  case 1:
+    mossMatScaleSet(mat, 1.7, 0.6);
+    mossMatLeftMultiply(mat, mossMatTranslateSet(tmp, 2.5, -1.5));
+    break;
+  case 2:
+    mossMatRotateSet(mat, 23);
+    mossMatLeftMultiply(mat, mossMatTranslateSet(tmp, -1.0, 3.0));
+    break;
+  }
+  return;
+}
+
+int
+main(int argc, const char **argv) {
+  static const int boundary[3] = {nrrdBoundaryBleed, nrrdBoundaryPad,
+                                  nrrdBoundaryWrap};
+  static const unsigned int numThreads[2] = {1, 3};
+  const char *me;
+  airArray *mop;
+  Nrrd *nin, *nout;
+  mossSampler *msp;
+  airRandMTState *rng;
+  double mat[6], inv[6], kparm[NRRD_KERNEL_PARMS_NUM],
+    xInPos, yInPos, xOutPos, yOutPos;
+  float *in, *out, val[NCOL], bg[NCOL] = {-3.0f, 7.0f};
+  unsigned int ii, caseIdx, ti, numThreadsSave;
+  int xi, yi, ci, xCent, yCent;
+  char *err;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nout = nrrdNew();
+  airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  msp = mossSamplerNew();
+  airMopAdd(mop, msp, (airMopper)mossSamplerNix, airMopAlways);
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, NCOL),
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  in = AIR_CAST(float *, nin->data);
+  for (ii=0; ii<NCOL*SX*SY; ii++) {
+    in[ii] = AIR_CAST(float, airDrandMT_r(rng));
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoMin, AIR_NAN, 0.0, 0.0);
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoMax, AIR_NAN,
+                     AIR_CAST(double, SX), AIR_CAST(double, SY));
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoCenter, nrrdCenterUnknown,
+                     nrrdCenterCell, nrrdCenterCell);
+  ELL_3V_SET(kparm, 1.0, 1.0, 0.0);
+  if (mossSamplerKernelSet(msp, nrrdKernelBCCubic, kparm)) {
+    airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with kernel:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  numThreadsSave = nrrdStateNumThreads;
+  for (caseIdx=0; caseIdx<3; caseIdx++) {
+    msp->boundary = boundary[caseIdx];
+    for (ti=0; ti<2; ti++) {
+      matSet(mat, caseIdx);
+      nrrdStateNumThreads = numThreads[ti];
+      if (mossLinearTransform(nout, nin, bg, mat, msp,
+                              -2.0, SX + 2.0, -3.0, SY + 1.0,
+                              31, 27)) {
+        nrrdStateNumThreads = numThreadsSave;
+        airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble transforming:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+      nrrdStateNumThreads = numThreadsSave;
+      /* sample each output pixel the way mossLinearTransform once did;
+         the sampler is still set up for nin */
+      out = AIR_CAST(float *, nout->data);
+      xCent = nout->axis[1].center;
+      yCent = nout->axis[2].center;
+      mossMatInvert(inv, mat);
+      for (yi=0; yi<27; yi++) {
+        yOutPos = NRRD_POS(yCent, -3.0, SY + 1.0, 27, yi);
+        for (xi=0; xi<31; xi++) {
+          xOutPos = NRRD_POS(xCent, -2.0, SX + 2.0, 31, xi);
+          mossMatApply(&xInPos, &yInPos, inv, xOutPos, yOutPos);
+          xInPos = NRRD_IDX(xCent, nin->axis[1].min, nin->axis[1].max,
+                            nin->axis[1].size, xInPos);
+          yInPos = NRRD_IDX(yCent, nin->axis[2].min, nin->axis[2].max,
+                            nin->axis[2].size, yInPos);
+          if (mossSamplerSample(val, msp, xInPos, yInPos)) {
+            airMopAdd(mop, err = biffGetDone(MOSS), airFree, airMopAlways);
+            fprintf(stderr, "%s: trouble sampling:\n%s", me, err);
+            airMopError(mop); return 1;
+          }
+          for (ci=0; ci<NCOL; ci++) {
+            if (val[ci] != out[ci + NCOL*(xi + 31*yi)]) {
+              fprintf(stderr, "%s: case %u (%s boundary), %u threads: "
+                      "pixel (%d,%d)[%d] is %.9g, not %.9g\n", me,
+                      caseIdx, airEnumStr(nrrdBoundary, boundary[caseIdx]),
+                      numThreads[ti], xi, yi, ci,
+                      out[ci + NCOL*(xi + 31*yi)], val[ci]);
+              airMopError(mop); return 1;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
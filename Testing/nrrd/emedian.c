@@ -0,0 +1,236 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdExactMedian, with 1 and with 3 threads, against sorting every
+** window, for 1-, 2-, and 3-D inputs with odd and even axis sizes,
+** with and without padding, for the median and for quantiles whose
+** rank quantile*(N-1) is fractional (so rounding matters), both when
+** the values are exact and when they are quantized to fewer bins
+*/
+
+#define VAL_NUM 23  /* distinct values in exact cases */
+
+typedef struct {
+  int type;
+  unsigned int dim, size[3], radius, bins;
+} emCase;
+
+/* index of (possibly out-of-bounds) position pos, with bleed */
+static size_t
+bleedIndex(const Nrrd *nin, const int *pos) {
+  size_t II;
+  unsigned int ai;
+  int pp;
+
+  II = 0;
+  for (ai=nin->dim; ai>0; ai--) {
+    pp = AIR_CLAMP(0, pos[ai-1], AIR_CAST(int, nin->axis[ai-1].size) - 1);
+    II = II*nin->axis[ai-1].size + AIR_CAST(size_t, pp);
+  }
+  return II;
+}
+
+/* the output of nrrdExactMedian, by sorting every window of nquant
+   (nin, quantized if it needs to be); without padding, samples near
+   the boundary are copied from nin */
+static void
+slowMedian(Nrrd *nslow, const Nrrd *nin, const Nrrd *nquant, int pad,
+           unsigned int radius, double quantile, double *win) {
+  double (*lup)(const void *, size_t);
+  int pos[3], off[3], wpos[3], sz[3], rr;
+  unsigned int ai, rank, winNum, wi;
+  size_t II, NN;
+
+  lup = nrrdDLookup[nin->type];
+  rr = AIR_CAST(int, radius);
+  winNum = 1;
+  for (ai=0; ai<3; ai++) {
+    sz[ai] = (ai < nin->dim ? AIR_CAST(int, nin->axis[ai].size) : 1);
+    winNum *= ai < nin->dim ? 2*radius + 1 : 1;
+  }
+  rank = AIR_CAST(unsigned int, quantile*(winNum - 1) + 0.5);
+  NN = nrrdElementNumber(nin);
+  for (II=0; II<NN; II++) {
+    pos[0] = AIR_CAST(int, II % sz[0]);
+    pos[1] = AIR_CAST(int, (II/sz[0]) % sz[1]);
+    pos[2] = AIR_CAST(int, II/(sz[0]*sz[1]));
+    if (!pad) {
+      for (ai=0; ai<nin->dim; ai++) {
+        if (pos[ai] < rr || pos[ai] >= sz[ai] - rr) {
+          break;
+        }
+      }
+      if (ai < nin->dim) {
+        nrrdDInsert[nslow->type](nslow->data, II, lup(nin->data, II));
+        continue;
+      }
+    }
+    wi = 0;
+    for (off[2]=(nin->dim > 2 ? -rr : 0);
+         off[2]<=(nin->dim > 2 ? rr : 0); off[2]++) {
+      for (off[1]=(nin->dim > 1 ? -rr : 0);
+           off[1]<=(nin->dim > 1 ? rr : 0); off[1]++) {
+        for (off[0]=-rr; off[0]<=rr; off[0]++) {
+          for (ai=0; ai<3; ai++) {
+            wpos[ai] = pos[ai] + off[ai];
+          }
+          win[wi++] = lup(nquant->data, bleedIndex(nquant, wpos));
+        }
+      }
+    }
+    qsort(win, winNum, sizeof(double), nrrdValCompare[nrrdTypeDouble]);
+    nrrdDInsert[nslow->type](nslow->data, II, win[rank]);
+  }
+  return;
+}
+
+int
+main(void) {
+  static const emCase ecase[] = {
+    /* 1-D, even size, quick integer levels */
+    {nrrdTypeUChar, 1, {40, 1, 1}, 3, 256},
+    /* 2-D, odd by even, exact float values */
+    {nrrdTypeFloat, 2, {13, 10, 1}, 1, 256},
+    /* 2-D, radius 2, values quantized to 8 bins */
+    {nrrdTypeDouble, 2, {12, 9, 1}, 2, 8},
+    /* 3-D, even and odd sizes */
+    {nrrdTypeShort, 3, {10, 9, 8}, 1, 256},
+    /* 3-D, radius 2, exact float values */
+    {nrrdTypeFloat, 3, {7, 6, 8}, 2, 256}
+  };
+  static const double quantile[] = {0.5, 0.25, 0.3125, 0.75, 0.0, 1.0};
+  static const unsigned int numThreads[2] = {1, 3};
+  airArray *mop;
+  airRandMTState *rng;
+  char *err;
+  Nrrd *nin, *nquant, *nout, *nslow;
+  NrrdRange *range;
+  double val, *win;
+  size_t ii, NN, sz[3];
+  unsigned int ci, qi, ti, pad;
+
+  mop = airMopNew();
+  rng = airRandMTStateNew(4242);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nquant = nrrdNew();
+  airMopAdd(mop, nquant, (airMopper)nrrdNuke, airMopAlways);
+  nout = nrrdNew();
+  airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  nslow = nrrdNew();
+  airMopAdd(mop, nslow, (airMopper)nrrdNuke, airMopAlways);
+  /* big enough for any window */
+  win = AIR_CALLOC(5*5*5, double);
+  airMopAdd(mop, win, airFree, airMopAlways);
+
+  for (ci=0; ci<AIR_CAST(unsigned int, sizeof(ecase)/sizeof(ecase[0]));
+       ci++) {
+    const emCase *ec = ecase + ci;
+    for (ii=0; ii<3; ii++) {
+      sz[ii] = ec->size[ii];
+    }
+    if (nrrdMaybeAlloc_nva(nin, ec->type, ec->dim, sz)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "case %u: trouble allocating:\n%s", ci, err);
+      airMopError(mop); return 1;
+    }
+    NN = nrrdElementNumber(nin);
+    for (ii=0; ii<NN; ii++) {
+      if (ec->bins < VAL_NUM) {
+        /* many distinct values, to be quantized */
+        val = AIR_AFFINE(0, airDrandMT_r(rng), 1, -5, 5);
+      } else {
+        /* few distinct values, so there are lots of ties */
+        val = airUIrandMT_r(rng) % VAL_NUM;
+        val = nrrdTypeIsIntegral[ec->type] ? val - 3 : (val - 3)/7.0;
+      }
+      nrrdDInsert[ec->type](nin->data, ii, val);
+    }
+    /* the values as nrrdExactMedian sees them: quantized the same way
+       when there are more than ec->bins of them */
+    if (nrrdCopy(nquant, nin)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "case %u: trouble copying:\n%s", ci, err);
+      airMopError(mop); return 1;
+    }
+    if (ec->bins < VAL_NUM) {
+      range = nrrdRangeNewSet(nin, nrrdBlind8BitRangeFalse);
+      airMopAdd(mop, range, (airMopper)nrrdRangeNix, airMopAlways);
+      for (ii=0; ii<NN; ii++) {
+        val = nrrdDLookup[ec->type](nin->data, ii);
+        val = NRRD_NODE_POS(range->min, range->max, ec->bins,
+                            airIndex(range->min, val, range->max,
+                                     ec->bins));
+        nrrdDInsert[ec->type](nquant->data, ii, val);
+      }
+    }
+    if (nrrdCopy(nslow, nin)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "case %u: trouble copying:\n%s", ci, err);
+      airMopError(mop); return 1;
+    }
+    for (pad=0; pad<2; pad++) {
+      for (qi=0; qi<AIR_CAST(unsigned int,
+                             sizeof(quantile)/sizeof(quantile[0])); qi++) {
+        slowMedian(nslow, nin, nquant, AIR_CAST(int, pad), ec->radius,
+                   quantile[qi], win);
+        for (ti=0; ti<2; ti++) {
+          nrrdStateNumThreads = numThreads[ti];
+          if (nrrdExactMedian(nout, nin, AIR_CAST(int, pad), ec->radius,
+                              quantile[qi], ec->bins)) {
+            airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+            fprintf(stderr, "case %u: trouble filtering:\n%s", ci, err);
+            airMopError(mop); return 1;
+          }
+          if (nout->type != nslow->type) {
+            fprintf(stderr, "case %u: output type %s != input type %s\n",
+                    ci, airEnumStr(nrrdType, nout->type),
+                    airEnumStr(nrrdType, nslow->type));
+            airMopError(mop); return 1;
+          }
+          for (ii=0; ii<NN; ii++) {
+            if (nrrdDLookup[nout->type](nout->data, ii)
+                != nrrdDLookup[nslow->type](nslow->data, ii)) {
+              fprintf(stderr, "case %u (pad %u, quantile %g, %u threads): "
+                      "sample %u: got %g, not %g\n", ci, pad,
+                      quantile[qi], numThreads[ti],
+                      AIR_CAST(unsigned int, ii),
+                      nrrdDLookup[nout->type](nout->data, ii),
+                      nrrdDLookup[nslow->type](nslow->data, ii));
+              airMopError(mop); return 1;
+            }
+          }
+        }
+      }
+    }
+  }
+  nrrdStateNumThreads = 1;
+
+  airMopOkay(mop);
+  return 0;
+}
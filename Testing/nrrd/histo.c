@@ -0,0 +1,240 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdHisto and nrrdHistoJoint, with 1 and with 3 threads, against
+** accumulating one sample at a time (clamping the count at every
+** increment), for inputs with non-existent and out-of-range values,
+** with and without weights (including negative ones), and with outputs
+** that saturate
+*/
+
+#define NUM 40000  /* enough samples for 3 jobs */
+#define BINS 20
+
+typedef struct {
+  int inType, wghtType, outType;
+  double wmin, wmax;        /* range of weights, if wghtType is known */
+} histoCase;
+
+/* the histogram of samples of nin in [min,max], one at a time */
+static void
+slowHisto(Nrrd *nslow, const Nrrd *nin, const Nrrd *nwght,
+          double min, double max) {
+  double val, count;
+  size_t ii, idx;
+
+  for (ii=0; ii<NUM; ii++) {
+    val = nrrdDLookup[nin->type](nin->data, ii);
+    if (!( AIR_EXISTS(val) && AIR_IN_CL(min, val, max) )) {
+      continue;
+    }
+    idx = airIndex(min, val, max, BINS);
+    count = nrrdDLookup[nslow->type](nslow->data, idx);
+    count += nwght ? nrrdDLookup[nwght->type](nwght->data, ii) : 1;
+    nrrdDInsert[nslow->type](nslow->data, idx,
+                             nrrdDClamp[nslow->type](count));
+  }
+  return;
+}
+
+/* the joint histogram of nin[0] (clamped) and nin[1] (not clamped) */
+static void
+slowHistoJoint(Nrrd *nslow, const Nrrd *const nin[2], const Nrrd *nwght,
+               double min, double max) {
+  double val[2], count;
+  size_t ii, idx[2];
+  unsigned int ai;
+
+  for (ii=0; ii<NUM; ii++) {
+    for (ai=0; ai<2; ai++) {
+      val[ai] = nrrdDLookup[nin[ai]->type](nin[ai]->data, ii);
+    }
+    if (!( AIR_EXISTS(val[0]) && AIR_EXISTS(val[1])
+           && AIR_IN_CL(min, val[1], max) )) {
+      continue;
+    }
+    val[0] = AIR_CLAMP(min, val[0], max);
+    for (ai=0; ai<2; ai++) {
+      idx[ai] = AIR_CAST(size_t, airIndexClampULL(min, val[ai], max,
+                                                  BINS));
+    }
+    count = nrrdDLookup[nslow->type](nslow->data, idx[0] + BINS*idx[1]);
+    count += nwght ? nrrdDLookup[nwght->type](nwght->data, ii) : 1;
+    nrrdDInsert[nslow->type](nslow->data, idx[0] + BINS*idx[1],
+                             nrrdDClamp[nslow->type](count));
+  }
+  return;
+}
+
+static int
+sameData(const Nrrd *na, const Nrrd *nb) {
+  size_t ii, nn;
+
+  nn = nrrdElementNumber(na);
+  if (nn != nrrdElementNumber(nb) || na->type != nb->type) {
+    return AIR_FALSE;
+  }
+  for (ii=0; ii<nn; ii++) {
+    if (nrrdDLookup[na->type](na->data, ii)
+        != nrrdDLookup[nb->type](nb->data, ii)) {
+      return AIR_FALSE;
+    }
+  }
+  return AIR_TRUE;
+}
+
+/* random values in [-1,11], a few of them NaN (if the type has NaN) */
+static void
+fillInput(Nrrd *nin, airRandMTState *rng) {
+  double val;
+  size_t ii;
+
+  for (ii=0; ii<NUM; ii++) {
+    val = AIR_AFFINE(0, airDrandMT_r(rng), 1, -1, 11);
+    if (nrrdTypeIsIntegral[nin->type]) {
+      val = floor(val);
+    } else if (airDrandMT_r(rng) < 0.01) {
+      val = AIR_NAN;
+    }
+    nrrdDInsert[nin->type](nin->data, ii, val);
+  }
+  return;
+}
+
+int
+main(void) {
+  static const histoCase hcase[] = {
+    /* unweighted, with room */
+    {nrrdTypeUChar, nrrdTypeUnknown, nrrdTypeUInt, 0, 0},
+    /* unweighted, saturating */
+    {nrrdTypeFloat, nrrdTypeUnknown, nrrdTypeUChar, 0, 0},
+    /* unsigned weights, saturating */
+    {nrrdTypeShort, nrrdTypeUShort, nrrdTypeUChar, 0, 3},
+    /* signed weights, saturating on the way */
+    {nrrdTypeFloat, nrrdTypeShort, nrrdTypeUChar, -3, 4},
+    /* real weights, float output */
+    {nrrdTypeDouble, nrrdTypeDouble, nrrdTypeFloat, -0.5, 1}
+  };
+  static const unsigned int numThreads[2] = {1, 3};
+  static const int clamp[2] = {AIR_TRUE, AIR_FALSE};
+  airArray *mop;
+  airRandMTState *rng;
+  char *err;
+  Nrrd *nin[2], *nwght, *nout, *nslow;
+  NrrdRange *range;
+  const NrrdRange *jrange[2];
+  size_t jbins[2] = {BINS, BINS}, ii;
+  unsigned int ci, ti, ai;
+
+  mop = airMopNew();
+  rng = airRandMTStateNew(4242);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  for (ai=0; ai<2; ai++) {
+    nin[ai] = nrrdNew();
+    airMopAdd(mop, nin[ai], (airMopper)nrrdNuke, airMopAlways);
+  }
+  nwght = nrrdNew();
+  airMopAdd(mop, nwght, (airMopper)nrrdNuke, airMopAlways);
+  nout = nrrdNew();
+  airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  nslow = nrrdNew();
+  airMopAdd(mop, nslow, (airMopper)nrrdNuke, airMopAlways);
+  range = nrrdRangeNew(0, 10);
+  airMopAdd(mop, range, (airMopper)nrrdRangeNix, airMopAlways);
+  jrange[0] = jrange[1] = range;
+
+  for (ci=0; ci<AIR_CAST(unsigned int, sizeof(hcase)/sizeof(hcase[0]));
+       ci++) {
+    const histoCase *hc = hcase + ci;
+    for (ai=0; ai<2; ai++) {
+      if (nrrdMaybeAlloc_va(nin[ai], hc->inType, 1,
+                            AIR_CAST(size_t, NUM))) {
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "trouble allocating:\n%s", err);
+        airMopError(mop); return 1;
+      }
+      fillInput(nin[ai], rng);
+    }
+    if (hc->wghtType) {
+      if (nrrdMaybeAlloc_va(nwght, hc->wghtType, 1,
+                            AIR_CAST(size_t, NUM))) {
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "trouble allocating:\n%s", err);
+        airMopError(mop); return 1;
+      }
+      for (ii=0; ii<NUM; ii++) {
+        double ww = AIR_AFFINE(0, airDrandMT_r(rng), 1, hc->wmin, hc->wmax);
+        nrrdDInsert[hc->wghtType](nwght->data, ii,
+                                  (nrrdTypeIsIntegral[hc->wghtType]
+                                   ? floor(ww) : ww));
+      }
+    }
+    for (ti=0; ti<2; ti++) {
+      nrrdStateNumThreads = numThreads[ti];
+      /* 1-D */
+      if (nrrdMaybeAlloc_va(nslow, hc->outType, 1, AIR_CAST(size_t, BINS))
+          || nrrdHisto(nout, nin[0], range, hc->wghtType ? nwght : NULL,
+                       BINS, hc->outType)) {
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "case %u: trouble with nrrdHisto:\n%s", ci, err);
+        airMopError(mop); return 1;
+      }
+      memset(nslow->data, 0, nrrdElementNumber(nslow)
+             *nrrdElementSize(nslow));
+      slowHisto(nslow, nin[0], hc->wghtType ? nwght : NULL, 0, 10);
+      if (!sameData(nout, nslow)) {
+        fprintf(stderr, "case %u: nrrdHisto with %u threads differs "
+                "from slow\n", ci, numThreads[ti]);
+        airMopError(mop); return 1;
+      }
+      /* 2-D */
+      if (nrrdMaybeAlloc_va(nslow, hc->outType, 2, AIR_CAST(size_t, BINS),
+                            AIR_CAST(size_t, BINS))
+          || nrrdHistoJoint(nout, AIR_CAST(const Nrrd *const *, nin),
+                            jrange, 2, hc->wghtType ? nwght : NULL, jbins,
+                            hc->outType, clamp)) {
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "case %u: trouble with nrrdHistoJoint:\n%s",
+                ci, err);
+        airMopError(mop); return 1;
+      }
+      memset(nslow->data, 0, nrrdElementNumber(nslow)
+             *nrrdElementSize(nslow));
+      slowHistoJoint(nslow, AIR_CAST(const Nrrd *const *, nin),
+                     hc->wghtType ? nwght : NULL, 0, 10);
+      if (!sameData(nout, nslow)) {
+        fprintf(stderr, "case %u: nrrdHistoJoint with %u threads differs "
+                "from slow\n", ci, numThreads[ti]);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+  nrrdStateNumThreads = 1;
+
+  airMopOkay(mop);
+  return 0;
+}
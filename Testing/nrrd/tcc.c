@@ -0,0 +1,118 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdCCFind
+** nrrdCCAdjacency
+** nrrdCCMerge
+** with nrrdStateNumThreads == 1 and > 1, which should give identical
+** results, for random 2-D and 3-D data and all connectivities
+*/
+
+static int
+ccRun(Nrrd *nout[3], Nrrd *nval, const Nrrd *nin, unsigned int conny,
+      unsigned int numThreads) {
+
+  nrrdStateNumThreads = numThreads;
+  return (nrrdCCFind(nout[0], &nval, nin, nrrdTypeDefault, conny)
+          || nrrdCCAdjacency(nout[1], nout[0], conny)
+          || nrrdCCMerge(nout[2], nout[0], nval, 1, 0, 2, conny));
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  static const char * const what[3] = {"ccfind", "ccadj", "ccmerge"};
+  char explain[AIR_STRLEN_LARGE];
+  Nrrd *nin, *nval[2], *nout[2][3];
+  airArray *mop;
+  airRandMTState *rng;
+  unsigned int dim, conny, ti, oi, wi;
+  unsigned char *data;
+  size_t size[3], II, NN;
+  int differ;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  for (ti=0; ti<2; ti++) {
+    nval[ti] = nrrdNew();
+    airMopAdd(mop, nval[ti], (airMopper)nrrdNuke, airMopAlways);
+    for (oi=0; oi<3; oi++) {
+      nout[ti][oi] = nrrdNew();
+      airMopAdd(mop, nout[ti][oi], (airMopper)nrrdNuke, airMopAlways);
+    }
+  }
+  for (wi=0; wi<40; wi++) {
+    dim = 2 + wi % 2;
+    conny = 1 + (wi/2) % dim;
+    size[0] = 1 + airRandInt_r(rng, 50);
+    size[1] = 1 + airRandInt_r(rng, 50);
+    size[2] = 1 + airRandInt_r(rng, 50);
+    if (nrrdMaybeAlloc_nva(nin, nrrdTypeUChar, dim, size)) {
+      char *err;
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+      airMopError(mop); return 1;
+    }
+    data = AIR_CAST(unsigned char *, nin->data);
+    NN = nrrdElementNumber(nin);
+    for (II=0; II<NN; II++) {
+      /* mostly two values, with fewer large CCs than small */
+      data[II] = AIR_CAST(unsigned char, airRandInt_r(rng, 2 + wi % 3));
+    }
+    if (ccRun(nout[0], nval[0], nin, conny, 1)
+        || ccRun(nout[1], nval[1], nin, conny, 2 + wi % 5)) {
+      char *err;
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with CCs:\n%s", me, err);
+      airMopError(mop); return 1;
+    }
+    for (oi=0; oi<3; oi++) {
+      if (nrrdCompare(nout[0][oi], nout[1][oi], AIR_TRUE /* onlyData */,
+                      0.0 /* epsilon */, &differ, explain)) {
+        char *err;
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble comparing:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+      if (differ) {
+        fprintf(stderr, "%s: single- and multi-threaded %s differ "
+                "(%u-D, conny %u): %s\n", me, what[oi], dim, conny,
+                explain);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+  printf("%s: good: single- and multi-threaded CCs same\n", me);
+
+  airMopOkay(mop);
+  return 0;
+}
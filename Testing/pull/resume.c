@@ -0,0 +1,428 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/pull.h"
+
+/*
+** Tests:
+** pullContextSnapshotWrite and pullContextSnapshotRead: a run that is
+** interrupted part way (by saving a snapshot from the callback) and
+** resumed (in a new context, from the snapshot) ends with exactly the
+** same points as the run that was not interrupted, with population
+** control nixing points along the way; the snapshot is saved right
+** after population control, when neighbor lists refer to nixed points
+** in the tasks' pools, and all those neighbors and pooled points have
+** to be there after the snapshot is read. As the population shrinks,
+** the pools have to be trimmed to no more than the live points.
+** _pullTaskPointNew: after every iteration of that run, and of a run
+** that starts with few points (so that population control tries adding
+** points, re-using pooled ones), no live point's neighbor list may hold a
+** pooled point that population control can re-use (one that was
+** recycled before the lists were last learned), or hold any point twice
+*/
+
+#define VOL_SIZE 20
+#define ITER_SNAP 15    /* right after population control */
+#define ITER_MAX 25
+#define INIT_NUM 150    /* initial # points */
+#define SPARSE_NUM 40   /* initial # points for run that tries adding */
+
+typedef struct {
+  pullContext *pctx;
+  FILE *file;
+  unsigned int neighNum, poolNum;
+  int bad;
+} snapInfo;
+
+typedef struct {
+  pullContext *pctx;
+  pullPoint **pool;          /* the pooled points after the last iter */
+  unsigned int *poolIdtag,   /* and their idtags */
+    poolNum,
+    reuseNum;                /* # points seen to have been re-used */
+  int bad;
+} sparseInfo;
+
+/* checks the neighbor lists of the live points against the pooled
+   points that may be re-used, and for repeats */
+static int
+neighCheck(const pullContext *pctx) {
+  static const char me[]="neighCheck";
+  unsigned int bi, pi, ni, nj, ti, ri;
+  const pullPoint *point, *her;
+  const pullTask *task;
+
+  for (bi=0; bi<pctx->binNum; bi++) {
+    for (pi=0; pi<pctx->bin[bi].pointNum; pi++) {
+      point = pctx->bin[bi].point[pi];
+      for (ni=0; ni<point->neighPointNum; ni++) {
+        her = point->neighPoint[ni];
+        for (nj=0; nj<ni; nj++) {
+          if (her == point->neighPoint[nj]) {
+            fprintf(stderr, "%s: iter %u: point %u has neighbor %u "
+                    "twice\n", me, pctx->iter, point->idtag, her->idtag);
+            return 1;
+          }
+        }
+        for (ti=0; ti<pctx->threadNum; ti++) {
+          task = pctx->task[ti];
+          for (ri=0; ri<task->poolPointReuseNum; ri++) {
+            if (her == task->poolPoint[ri]) {
+              fprintf(stderr, "%s: iter %u: point %u has neighbor %u, "
+                      "which task %u may re-use\n", me, pctx->iter,
+                      point->idtag, her->idtag, ti);
+              return 1;
+            }
+          }
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+/* the total lengths of the points' neighbor lists and of the pools */
+static void
+stateCount(unsigned int *neighNum, unsigned int *poolNum,
+          const pullContext *pctx) {
+  unsigned int bi, pi, ti;
+
+  *neighNum = *poolNum = 0;
+  for (bi=0; bi<pctx->binNum; bi++) {
+    for (pi=0; pi<pctx->bin[bi].pointNum; pi++) {
+      *neighNum += pctx->bin[bi].point[pi]->neighPointNum;
+    }
+  }
+  for (ti=0; ti<pctx->threadNum; ti++) {
+    *poolNum += pctx->task[ti]->poolPointNum;
+  }
+  return;
+}
+
+/* checks neighbor lists, and saves a snapshot when the run reaches
+   ITER_SNAP */
+static void
+snapCallback(void *_sni) {
+  snapInfo *sni;
+  char *err;
+
+  sni = AIR_CAST(snapInfo *, _sni);
+  if (neighCheck(sni->pctx)) {
+    sni->bad = AIR_TRUE;
+  }
+  if (ITER_SNAP != sni->pctx->iter) {
+    return;
+  }
+  stateCount(&(sni->neighNum), &(sni->poolNum), sni->pctx);
+  if (pullContextSnapshotWrite(sni->file, sni->pctx)) {
+    err = biffGetDone(PULL);
+    fprintf(stderr, "snapCallback: trouble:\n%s", err);
+    free(err);
+    sni->bad = AIR_TRUE;
+  }
+  return;
+}
+
+/* if point was pooled after the previous iteration, but has a new
+   idtag now, it was re-used */
+static void
+reuseCount(sparseInfo *spi, const pullPoint *point) {
+  unsigned int ri;
+
+  for (ri=0; ri<spi->poolNum; ri++) {
+    if (point == spi->pool[ri]) {
+      spi->reuseNum += (point->idtag != spi->poolIdtag[ri]);
+      return;
+    }
+  }
+  return;
+}
+
+/* checks neighbor lists, and counts the (live or pooled) points that
+   were re-used since the previous iteration */
+static void
+sparseCallback(void *_spi) {
+  sparseInfo *spi;
+  const pullContext *pctx;
+  unsigned int bi, pi, ti, ri;
+
+  spi = AIR_CAST(sparseInfo *, _spi);
+  pctx = spi->pctx;
+  if (neighCheck(pctx)) {
+    spi->bad = AIR_TRUE;
+  }
+  for (bi=0; bi<pctx->binNum; bi++) {
+    for (pi=0; pi<pctx->bin[bi].pointNum; pi++) {
+      reuseCount(spi, pctx->bin[bi].point[pi]);
+    }
+  }
+  for (ti=0; ti<pctx->threadNum; ti++) {
+    for (pi=0; pi<pctx->task[ti]->poolPointNum; pi++) {
+      reuseCount(spi, pctx->task[ti]->poolPoint[pi]);
+    }
+  }
+  spi->pool = AIR_CAST(pullPoint **, airFree(spi->pool));
+  spi->poolIdtag = AIR_CAST(unsigned int *, airFree(spi->poolIdtag));
+  spi->poolNum = 0;
+  for (ti=0; ti<pctx->threadNum; ti++) {
+    spi->poolNum += pctx->task[ti]->poolPointNum;
+  }
+  spi->pool = AIR_CALLOC(AIR_MAX(1, spi->poolNum), pullPoint *);
+  spi->poolIdtag = AIR_CALLOC(AIR_MAX(1, spi->poolNum), unsigned int);
+  if (!( spi->pool && spi->poolIdtag )) {
+    fprintf(stderr, "sparseCallback: couldn't allocate\n");
+    spi->poolNum = 0;
+    spi->bad = AIR_TRUE;
+    return;
+  }
+  ri = 0;
+  for (ti=0; ti<pctx->threadNum; ti++) {
+    for (pi=0; pi<pctx->task[ti]->poolPointNum; pi++) {
+      spi->pool[ri] = pctx->task[ti]->poolPoint[pi];
+      spi->poolIdtag[ri] = spi->pool[ri]->idtag;
+      ri++;
+    }
+  }
+  return;
+}
+
+/* pullFinish, as an airMopper */
+static void *
+pullFinishMop(void *pctx) {
+
+  pullFinish(AIR_CAST(pullContext *, pctx));
+  return NULL;
+}
+
+/* sets up pctx to sample the isosurface of nin with initNum points,
+   the same way every time, and starts it */
+static int
+pullSetup(pullContext *pctx, const Nrrd *nin, unsigned int initNum,
+          airArray *mop) {
+  static const char me[]="pullSetup";
+  static const int info[3] = {pullInfoIsovalue, pullInfoIsovalueGradient,
+                              pullInfoIsovalueHessian};
+  static const int item[3] = {gageSclValue, gageSclGradVec, gageSclHessian};
+  NrrdKernelSpec *ksp[3];
+  pullEnergySpec *ensp;
+  pullInfoSpec *ispec;
+  unsigned int ii;
+  char *err;
+  int E;
+
+  E = 0;
+  for (ii=0; ii<3; ii++) {
+    ksp[ii] = nrrdKernelSpecNew();
+    airMopAdd(mop, ksp[ii], (airMopper)nrrdKernelSpecNix, airMopAlways);
+  }
+  if (nrrdKernelSpecParse(ksp[0], "c4h")
+      || nrrdKernelSpecParse(ksp[1], "c4hd")
+      || nrrdKernelSpecParse(ksp[2], "c4hdd")) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with kernels:\n%s", me, err);
+    return 1;
+  }
+  ensp = pullEnergySpecNew();
+  airMopAdd(mop, ensp, (airMopper)pullEnergySpecNix, airMopAlways);
+  if (!E) E |= pullEnergySpecParse(ensp, "cotan");
+  if (!E) E |= pullVolumeSingleAdd(pctx, gageKindScl, "vol", nin,
+                                   ksp[0], ksp[1], ksp[2]);
+  for (ii=0; ii<3 && !E; ii++) {
+    /* not mopped: pullInfoSpecAdd hands it to pctx */
+    ispec = pullInfoSpecNew();
+    ispec->info = info[ii];
+    ispec->source = pullSourceGage;
+    ispec->volName = airStrdup("vol");
+    ispec->item = item[ii];
+    ispec->scale = 1;
+    ispec->zero = 100;
+    ispec->constraint = (pullInfoIsovalue == info[ii]);
+    E |= pullInfoSpecAdd(pctx, ispec);
+  }
+  if (!E) E |= pullInterEnergySet(pctx, pullInterTypeJustR,
+                                  ensp, NULL, NULL);
+  if (!E) E |= pullInitRandomSet(pctx, initNum);
+  if (!E) E |= pullRngSeedSet(pctx, 42);
+  if (!E) E |= pullThreadNumSet(pctx, 1);
+  if (!E) E |= pullIterParmSet(pctx, pullIterParmMin, ITER_MAX);
+  if (!E) E |= pullIterParmSet(pctx, pullIterParmMax, ITER_MAX);
+  if (!E) E |= pullIterParmSet(pctx, pullIterParmPopCntlPeriod, 5);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmRadiusSpace, 0.8);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmBinWidthSpace, 1.6);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmNeighborTrueProb, 0.5);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmEnergyDecreasePopCntlMin,
+                              1.0);
+  if (!E) E |= pullStart(pctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up:\n%s", me, err);
+    return 1;
+  }
+  /* (before pullContextNix, since the mop goes in reverse order) */
+  airMopAdd(mop, pctx, pullFinishMop, airMopAlways);
+  return 0;
+}
+
+int
+main(void) {
+  airArray *mop;
+  char *err;
+  Nrrd *nin, *nposA, *nposB;
+  pullContext *pctxA, *pctxB, *pctxC;
+  snapInfo sni;
+  sparseInfo spi;
+  double xx, yy, zz, val;
+  size_t ii, NN;
+  unsigned int neighNum, poolNum;
+  FILE *file;
+  int E;
+
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nposA = nrrdNew();
+  airMopAdd(mop, nposA, (airMopper)nrrdNuke, airMopAlways);
+  nposB = nrrdNew();
+  airMopAdd(mop, nposB, (airMopper)nrrdNuke, airMopAlways);
+  /* a blurry ball */
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, VOL_SIZE),
+                        AIR_CAST(size_t, VOL_SIZE),
+                        AIR_CAST(size_t, VOL_SIZE))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoCenter, nrrdCenterCell,
+                     nrrdCenterCell, nrrdCenterCell);
+  NN = nrrdElementNumber(nin);
+  for (ii=0; ii<NN; ii++) {
+    xx = AIR_AFFINE(0, ii % VOL_SIZE, VOL_SIZE-1, -1, 1);
+    yy = AIR_AFFINE(0, (ii/VOL_SIZE) % VOL_SIZE, VOL_SIZE-1, -1, 1);
+    zz = AIR_AFFINE(0, ii/(VOL_SIZE*VOL_SIZE), VOL_SIZE-1, -1, 1);
+    val = 100*(1 + tanh(4*(0.6 - sqrt(xx*xx + yy*yy + zz*zz))));
+    nrrdFInsert[nrrdTypeFloat](nin->data, ii, AIR_CAST(float, val));
+  }
+  if (!(file = tmpfile())) {
+    fprintf(stderr, "couldn't open temporary file\n");
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, file, (airMopper)airFclose, airMopAlways);
+
+  /* the uninterrupted run, saving a snapshot along the way */
+  pctxA = pullContextNew();
+  airMopAdd(mop, pctxA, (airMopper)pullContextNix, airMopAlways);
+  if (pullSetup(pctxA, nin, INIT_NUM, mop)) {
+    airMopError(mop); return 1;
+  }
+  sni.pctx = pctxA;
+  sni.file = file;
+  sni.neighNum = sni.poolNum = 0;
+  sni.bad = AIR_FALSE;
+  if (pullCallbackSet(pctxA, snapCallback, &sni)
+      || pullRun(pctxA)
+      || pullOutputGet(nposA, NULL, NULL, NULL, 0.0, pctxA)) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "trouble with uninterrupted run:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  if (sni.bad) {
+    airMopError(mop); return 1;
+  }
+  if (!sni.poolNum) {
+    fprintf(stderr, "no nixed points in pools at iter %u\n", ITER_SNAP);
+    airMopError(mop); return 1;
+  }
+  stateCount(&neighNum, &poolNum, pctxA);
+  if (poolNum > pullPointNumber(pctxA)) {
+    fprintf(stderr, "%u pooled points, but only %u live points\n",
+            poolNum, pullPointNumber(pctxA));
+    airMopError(mop); return 1;
+  }
+
+  /* the resumed run */
+  rewind(file);
+  pctxB = pullContextNew();
+  airMopAdd(mop, pctxB, (airMopper)pullContextNix, airMopAlways);
+  if (pullSetup(pctxB, nin, INIT_NUM, mop)) {
+    airMopError(mop); return 1;
+  }
+  if (pullContextSnapshotRead(pctxB, file)) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "trouble reading snapshot:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  stateCount(&neighNum, &poolNum, pctxB);
+  if (neighNum != sni.neighNum || poolNum != sni.poolNum) {
+    fprintf(stderr, "read %u neighbors and %u pooled points, but saved "
+            "%u and %u\n", neighNum, poolNum, sni.neighNum, sni.poolNum);
+    airMopError(mop); return 1;
+  }
+  if (pullRun(pctxB)
+      || pullOutputGet(nposB, NULL, NULL, NULL, 0.0, pctxB)) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "trouble with resumed run:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  if (pctxA->iter != pctxB->iter
+      || nrrdElementNumber(nposA) != nrrdElementNumber(nposB)
+      || memcmp(nposA->data, nposB->data,
+                nrrdElementNumber(nposA)*nrrdElementSize(nposA))) {
+    fprintf(stderr, "resumed run (%u points, iter %u) differs from "
+            "uninterrupted run (%u points, iter %u)\n",
+            AIR_CAST(unsigned int, nposB->axis[1].size), pctxB->iter,
+            AIR_CAST(unsigned int, nposA->axis[1].size), pctxA->iter);
+    airMopError(mop); return 1;
+  }
+
+  /* the run that starts sparse */
+  pctxC = pullContextNew();
+  airMopAdd(mop, pctxC, (airMopper)pullContextNix, airMopAlways);
+  if (pullSetup(pctxC, nin, SPARSE_NUM, mop)) {
+    airMopError(mop); return 1;
+  }
+  spi.pctx = pctxC;
+  spi.pool = NULL;
+  spi.poolIdtag = NULL;
+  spi.poolNum = spi.reuseNum = 0;
+  spi.bad = AIR_FALSE;
+  E = (pullCallbackSet(pctxC, sparseCallback, &spi)
+       || pullRun(pctxC));
+  spi.pool = AIR_CAST(pullPoint **, airFree(spi.pool));
+  spi.poolIdtag = AIR_CAST(unsigned int *, airFree(spi.poolIdtag));
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "trouble with sparse run:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  if (spi.bad) {
+    airMopError(mop); return 1;
+  }
+  if (!spi.reuseNum) {
+    fprintf(stderr, "no pooled points were re-used in sparse run\n");
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,207 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/pull.h"
+
+/*
+** Tests:
+** pullTraceMultiWrite and pullTraceMultiRead: writing traces (with and
+** without strengths) in the text and in the binary format, and reading
+** them back, gives the same traces; reading a truncated file fails
+*/
+
+#define TRACE_NUM 5
+
+/* a trace of vertNum vertices, with strengths if withStrn */
+static int
+traceMake(pullTrace *trc, unsigned int vertNum, int withStrn,
+          airRandMTState *rng) {
+  static const char me[]="traceMake";
+  double *vert, *strn, *velo;
+  unsigned int vi;
+  char *err;
+
+  if (nrrdMaybeAlloc_va(trc->nvert, nrrdTypeDouble, 2, AIR_CAST(size_t, 4),
+                        AIR_CAST(size_t, vertNum))
+      || nrrdMaybeAlloc_va(trc->nvelo, nrrdTypeDouble, 1,
+                           AIR_CAST(size_t, vertNum))
+      || (withStrn
+          && nrrdMaybeAlloc_va(trc->nstrn, nrrdTypeDouble, 1,
+                               AIR_CAST(size_t, vertNum)))) {
+    err = biffGetDone(NRRD);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    free(err);
+    return 1;
+  }
+  vert = AIR_CAST(double *, trc->nvert->data);
+  velo = AIR_CAST(double *, trc->nvelo->data);
+  strn = withStrn ? AIR_CAST(double *, trc->nstrn->data) : NULL;
+  for (vi=0; vi<vertNum; vi++) {
+    /* values that don't print exactly with %g */
+    ELL_4V_SET(vert + 4*vi, airDrandMT_r(rng), -airDrandMT_r(rng),
+               1e6*airDrandMT_r(rng), 1e-6*airDrandMT_r(rng));
+    velo[vi] = airDrandMT_r(rng)/3;
+    if (strn) {
+      strn[vi] = airDrandMT_r(rng)/7;
+    }
+  }
+  /* the text format prints the seed position with 15 decimals */
+  ELL_4V_SET(trc->seedPos, 0.5, -0.25, 12.0, 1.0/64);
+  trc->seedIdx = vertNum/2;
+  trc->whyStop[0] = pullTraceStopSpeeding;
+  trc->whyStop[1] = withStrn ? pullTraceStopBounds : pullTraceStopLength;
+  trc->whyNowhere = pullTraceStopUnknown;
+  return 0;
+}
+
+static int
+sameNrrd(const Nrrd *na, const Nrrd *nb) {
+  size_t nn;
+
+  if (!na->data || !nb->data) {
+    return !na->data && !nb->data;
+  }
+  nn = nrrdElementNumber(na);
+  return (na->type == nb->type
+          && na->dim == nb->dim
+          && nn == nrrdElementNumber(nb)
+          && !memcmp(na->data, nb->data, nn*nrrdElementSize(na)));
+}
+
+static int
+sameTrace(const pullTrace *ta, const pullTrace *tb) {
+
+  return (ELL_4V_EQUAL(ta->seedPos, tb->seedPos)
+          && ta->seedIdx == tb->seedIdx
+          && ta->whyStop[0] == tb->whyStop[0]
+          && ta->whyStop[1] == tb->whyStop[1]
+          && ta->whyNowhere == tb->whyNowhere
+          && sameNrrd(ta->nvert, tb->nvert)
+          && sameNrrd(ta->nstrn, tb->nstrn)
+          && sameNrrd(ta->nvelo, tb->nvelo));
+}
+
+int
+main(void) {
+  airArray *mop;
+  airRandMTState *rng;
+  char *err, *buff;
+  FILE *file;
+  pullTraceMulti *mtrc, *mread;
+  pullTrace *trc;
+  unsigned int ti;
+  long flen;
+  int binary, added;
+
+  mop = airMopNew();
+  rng = airRandMTStateNew(4242);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  mtrc = pullTraceMultiNew();
+  airMopAdd(mop, mtrc, (airMopper)pullTraceMultiNix, airMopAlways);
+  mread = pullTraceMultiNew();
+  airMopAdd(mop, mread, (airMopper)pullTraceMultiNix, airMopAlways);
+  for (ti=0; ti<TRACE_NUM; ti++) {
+    trc = pullTraceNew();
+    if (traceMake(trc, 3 + 7*ti, ti % 2, rng)
+        || pullTraceMultiAdd(mtrc, trc, &added)) {
+      pullTraceNix(trc);
+      if (biffCheck(PULL)) {
+        airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+        fprintf(stderr, "trouble adding trace %u:\n%s", ti, err);
+      }
+      airMopError(mop); return 1;
+    }
+    if (!added) {
+      pullTraceNix(trc);
+      fprintf(stderr, "trace %u wasn't added\n", ti);
+      airMopError(mop); return 1;
+    }
+  }
+
+  for (binary=0; binary<2; binary++) {
+    if (!( file = tmpfile() )) {
+      fprintf(stderr, "couldn't open temporary file\n");
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, file, (airMopper)airFclose, airMopAlways);
+    if (pullTraceMultiWrite(file, mtrc, binary)) {
+      airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+      fprintf(stderr, "trouble writing (binary %d):\n%s", binary, err);
+      airMopError(mop); return 1;
+    }
+    rewind(file);
+    if (pullTraceMultiRead(mread, file)) {
+      airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+      fprintf(stderr, "trouble reading (binary %d):\n%s", binary, err);
+      airMopError(mop); return 1;
+    }
+    if (mread->traceNum != mtrc->traceNum) {
+      fprintf(stderr, "binary %d: read %u traces, not %u\n", binary,
+              mread->traceNum, mtrc->traceNum);
+      airMopError(mop); return 1;
+    }
+    for (ti=0; ti<mtrc->traceNum; ti++) {
+      if (!sameTrace(mtrc->trace[ti], mread->trace[ti])) {
+        fprintf(stderr, "binary %d: trace %u differs after reading\n",
+                binary, ti);
+        airMopError(mop); return 1;
+      }
+    }
+
+    /* without the last few bytes, the last trace can't be read */
+    fseek(file, 0, SEEK_END);
+    flen = ftell(file);
+    buff = AIR_CALLOC(flen, char);
+    airMopAdd(mop, buff, airFree, airMopAlways);
+    rewind(file);
+    if (flen < 20
+        || AIR_CAST(size_t, flen) != fread(buff, 1, flen, file)) {
+      fprintf(stderr, "binary %d: couldn't re-read file\n", binary);
+      airMopError(mop); return 1;
+    }
+    /* no portable way to shorten the file, so make another */
+    airMopSub(mop, file, (airMopper)airFclose);
+    airFclose(file);
+    if (!( file = tmpfile() )) {
+      fprintf(stderr, "couldn't open temporary file\n");
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, file, (airMopper)airFclose, airMopAlways);
+    fwrite(buff, 1, flen - 20, file);
+    rewind(file);
+    if (!pullTraceMultiRead(mread, file)) {
+      fprintf(stderr, "binary %d: read truncated file without error\n",
+              binary);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    if (mread->traceNum != mtrc->traceNum - 1) {
+      fprintf(stderr, "binary %d: kept %u traces from truncated file, "
+              "not %u\n", binary, mread->traceNum, mtrc->traceNum - 1);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,263 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/pull.h"
+
+/*
+** Tests:
+** pullTraceMultiSet: tracing a set of seeds (through the scale-space of
+** a ball whose isosurface grows with scale) with 1 and with 3 threads
+** gives exactly the traces that pullTraceSet gives, one seed at a time
+*/
+
+#define VOL_SIZE 20
+#define SCALE_NUM 5
+#define SEED_NUM 12
+
+/* pullFinish, as an airMopper */
+static void *
+pullFinishMop(void *pctx) {
+
+  pullFinish(AIR_CAST(pullContext *, pctx));
+  return NULL;
+}
+
+/* sets up pctx with threadNum threads to trace the isosurface of the
+   scale-space ninSS, and starts it */
+static int
+pullSetup(pullContext *pctx, unsigned int threadNum,
+          const Nrrd *const *ninSS, double *scalePos, airArray *mop) {
+  static const char me[]="pullSetup";
+  static const int info[3] = {pullInfoIsovalue, pullInfoIsovalueGradient,
+                              pullInfoIsovalueHessian};
+  static const int item[3] = {gageSclValue, gageSclGradVec, gageSclHessian};
+  NrrdKernelSpec *ksp[4];
+  pullEnergySpec *ensp;
+  pullInfoSpec *ispec;
+  unsigned int ii;
+  char *err;
+  int E;
+
+  E = 0;
+  for (ii=0; ii<4; ii++) {
+    ksp[ii] = nrrdKernelSpecNew();
+    airMopAdd(mop, ksp[ii], (airMopper)nrrdKernelSpecNix, airMopAlways);
+  }
+  if (nrrdKernelSpecParse(ksp[0], "c4h")
+      || nrrdKernelSpecParse(ksp[1], "c4hd")
+      || nrrdKernelSpecParse(ksp[2], "c4hdd")
+      || nrrdKernelSpecParse(ksp[3], "hermite")) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with kernels:\n%s", me, err);
+    return 1;
+  }
+  ensp = pullEnergySpecNew();
+  airMopAdd(mop, ensp, (airMopper)pullEnergySpecNix, airMopAlways);
+  if (!E) E |= pullEnergySpecParse(ensp, "cotan");
+  if (!E) E |= pullVolumeStackAdd(pctx, gageKindScl, "vol", ninSS[0],
+                                  ninSS, scalePos, SCALE_NUM,
+                                  AIR_TRUE, 0.0,
+                                  ksp[0], ksp[1], ksp[2], ksp[3]);
+  for (ii=0; ii<3 && !E; ii++) {
+    /* not mopped: pullInfoSpecAdd hands it to pctx */
+    ispec = pullInfoSpecNew();
+    ispec->info = info[ii];
+    ispec->source = pullSourceGage;
+    ispec->volName = airStrdup("vol");
+    ispec->item = item[ii];
+    ispec->scale = 1;
+    ispec->zero = 100;
+    ispec->constraint = (pullInfoIsovalue == info[ii]);
+    E |= pullInfoSpecAdd(pctx, ispec);
+  }
+  if (!E) E |= pullInterEnergySet(pctx, pullInterTypeSeparable,
+                                  ensp, ensp, NULL);
+  if (!E) E |= pullInitRandomSet(pctx, SEED_NUM);
+  if (!E) E |= pullRngSeedSet(pctx, 42);
+  if (!E) E |= pullThreadNumSet(pctx, threadNum);
+  if (!E) E |= pullFlagSet(pctx, pullFlagStartSkipsPoints, AIR_TRUE);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmRadiusSpace, 0.8);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmRadiusScale, 0.5);
+  if (!E) E |= pullSysParmSet(pctx, pullSysParmBinWidthSpace, 1.6);
+  if (!E) E |= pullStart(pctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up:\n%s", me, err);
+    return 1;
+  }
+  /* (before pullContextNix, since the mop goes in reverse order) */
+  airMopAdd(mop, pctx, pullFinishMop, airMopAlways);
+  return 0;
+}
+
+/* whether two nrrds (either of which may be empty) differ */
+static int
+nrrdDiffer(const Nrrd *na, const Nrrd *nb) {
+  size_t sz;
+
+  if (!na->data || !nb->data) {
+    return (!na->data != !nb->data);
+  }
+  sz = nrrdElementNumber(na)*nrrdElementSize(na);
+  return (!nrrdSameSize(na, nb, AIR_FALSE)
+          || na->type != nb->type
+          || memcmp(na->data, nb->data, sz));
+}
+
+/* whether two traces differ */
+static int
+traceDiffer(const pullTrace *ta, const pullTrace *tb) {
+
+  return (memcmp(ta->seedPos, tb->seedPos, 4*sizeof(double))
+          || ta->seedIdx != tb->seedIdx
+          || ta->whyStop[0] != tb->whyStop[0]
+          || ta->whyStop[1] != tb->whyStop[1]
+          || ta->whyNowhere != tb->whyNowhere
+          || nrrdDiffer(ta->nvert, tb->nvert)
+          || nrrdDiffer(ta->nstrn, tb->nstrn)
+          || nrrdDiffer(ta->nvelo, tb->nvelo));
+}
+
+int
+main(void) {
+  static const unsigned int threadNum[2] = {1, 3};
+  airArray *mop;
+  char *err;
+  Nrrd *nss[SCALE_NUM];
+  pullContext *pctx[2];
+  pullTraceMulti *mtrc[2], *strc;
+  pullTrace *trc;
+  double scalePos[SCALE_NUM], seedPos[4*SEED_NUM], ssrange[2],
+    xx, yy, zz, rr, val, scaleDelta;
+  unsigned int si, ti, mi, ci;
+  size_t ii, NN;
+  float *data;
+  int added;
+
+  mop = airMopNew();
+  /* a ball whose isosurface grows with scale */
+  for (si=0; si<SCALE_NUM; si++) {
+    nss[si] = nrrdNew();
+    airMopAdd(mop, nss[si], (airMopper)nrrdNuke, airMopAlways);
+    scalePos[si] = 1 + 0.5*si;
+    if (nrrdMaybeAlloc_va(nss[si], nrrdTypeFloat, 3,
+                          AIR_CAST(size_t, VOL_SIZE),
+                          AIR_CAST(size_t, VOL_SIZE),
+                          AIR_CAST(size_t, VOL_SIZE))) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "trouble allocating:\n%s", err);
+      airMopError(mop); return 1;
+    }
+    nrrdAxisInfoSet_va(nss[si], nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+    nrrdAxisInfoSet_va(nss[si], nrrdAxisInfoCenter, nrrdCenterCell,
+                       nrrdCenterCell, nrrdCenterCell);
+    data = AIR_CAST(float *, nss[si]->data);
+    NN = nrrdElementNumber(nss[si]);
+    for (ii=0; ii<NN; ii++) {
+      xx = AIR_AFFINE(0, ii % VOL_SIZE, VOL_SIZE-1, -1, 1);
+      yy = AIR_AFFINE(0, (ii/VOL_SIZE) % VOL_SIZE, VOL_SIZE-1, -1, 1);
+      zz = AIR_AFFINE(0, ii/(VOL_SIZE*VOL_SIZE), VOL_SIZE-1, -1, 1);
+      rr = sqrt(xx*xx + yy*yy + zz*zz);
+      val = 100*(1 + tanh(4*(0.5 + 0.05*scalePos[si] - rr)));
+      data[ii] = AIR_CAST(float, val);
+    }
+  }
+  for (ci=0; ci<2; ci++) {
+    pctx[ci] = pullContextNew();
+    airMopAdd(mop, pctx[ci], (airMopper)pullContextNix, airMopAlways);
+    if (pullSetup(pctx[ci], threadNum[ci],
+                  AIR_CAST(const Nrrd *const *, nss), scalePos, mop)) {
+      airMopError(mop); return 1;
+    }
+  }
+  /* seeds near the isosurface, around the ball, at different scales */
+  for (mi=0; mi<SEED_NUM; mi++) {
+    double th;
+    th = AIR_AFFINE(0, mi, SEED_NUM, 0, 2*AIR_PI);
+    /* (world space is [-1,1]^3, as for the ball) */
+    rr = 0.6;
+    seedPos[0 + 4*mi] = rr*cos(th);
+    seedPos[1 + 4*mi] = rr*sin(th);
+    seedPos[2 + 4*mi] = 0.3*rr*cos(3*th);
+    seedPos[3 + 4*mi] = scalePos[mi % SCALE_NUM];
+  }
+  if (pullConstraintScaleRange(pctx[0], ssrange)) {
+    airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+    fprintf(stderr, "trouble with scale range:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  scaleDelta = (ssrange[1] - ssrange[0])/50;
+
+  /* pullTraceSet, one seed at a time */
+  strc = pullTraceMultiNew();
+  airMopAdd(mop, strc, (airMopper)pullTraceMultiNix, airMopAlways);
+  for (mi=0; mi<SEED_NUM; mi++) {
+    trc = pullTraceNew();
+    if (pullTraceSet(pctx[0], trc, AIR_FALSE, AIR_TRUE, scaleDelta,
+                     (ssrange[1] - ssrange[0])/2, 10.0, 50,
+                     seedPos + 4*mi)
+        || pullTraceMultiAdd(strc, trc, &added)) {
+      pullTraceNix(trc);
+      airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+      fprintf(stderr, "trouble tracing seed %u:\n%s", mi, err);
+      airMopError(mop); return 1;
+    }
+    if (!added) {
+      pullTraceNix(trc);
+    }
+  }
+  if (!strc->traceNum) {
+    fprintf(stderr, "no seeds led to traces\n");
+    airMopError(mop); return 1;
+  }
+
+  /* pullTraceMultiSet, with each number of threads */
+  for (ci=0; ci<2; ci++) {
+    mtrc[ci] = pullTraceMultiNew();
+    airMopAdd(mop, mtrc[ci], (airMopper)pullTraceMultiNix, airMopAlways);
+    if (pullTraceMultiSet(pctx[ci], mtrc[ci], AIR_FALSE, AIR_TRUE,
+                          scaleDelta, (ssrange[1] - ssrange[0])/2,
+                          10.0, 50, seedPos, SEED_NUM)) {
+      airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+      fprintf(stderr, "trouble tracing with %u threads:\n%s",
+              threadNum[ci], err);
+      airMopError(mop); return 1;
+    }
+    if (mtrc[ci]->traceNum != strc->traceNum) {
+      fprintf(stderr, "got %u traces with %u threads, but %u from "
+              "pullTraceSet\n", mtrc[ci]->traceNum, threadNum[ci],
+              strc->traceNum);
+      airMopError(mop); return 1;
+    }
+    for (ti=0; ti<strc->traceNum; ti++) {
+      if (traceDiffer(mtrc[ci]->trace[ti], strc->trace[ti])) {
+        fprintf(stderr, "trace %u with %u threads differs from the one "
+                "from pullTraceSet\n", ti, threadNum[ci]);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
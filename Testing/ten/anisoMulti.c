@@ -0,0 +1,126 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenAnisoVolumeMulti, with 1 and with 3 threads, giving exactly the
+** values of tenAnisoVolume for every anisotropy measure, on random
+** tensors (some below the confidence threshold); and with closedForm,
+** giving values within CLOSED_TOL (relative to 1 + |value|) of them
+*/
+
+#define SX 17
+#define SY 13
+#define SZ 11
+#define CLOSED_TOL 1e-5   /* closed-form eigenvalues are floats */
+
+int
+main(int argc, const char **argv) {
+  /* exact with 1 and 3 threads, then closed-form with 3 threads */
+  static const unsigned int numThreads[3] = {1, 3, 3};
+  static const int closedForm[3] = {AIR_FALSE, AIR_FALSE, AIR_TRUE};
+  const char *me;
+  airArray *mop;
+  Nrrd *nten, *nmulti, *nsingle;
+  airRandMTState *rng;
+  float *ten, *multi, *single, tol;
+  int aniso[TEN_ANISO_MAX];
+  unsigned int anisoNum, ai, ii, ti, NN;
+  char *err;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  nmulti = nrrdNew();
+  airMopAdd(mop, nmulti, (airMopper)nrrdNuke, airMopAlways);
+  nsingle = nrrdNew();
+  airMopAdd(mop, nsingle, (airMopper)nrrdNuke, airMopAlways);
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+
+  NN = SX*SY*SZ;
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_CAST(size_t, 7),
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY),
+                        AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  ten = AIR_CAST(float *, nten->data);
+  for (ii=0; ii<NN; ii++) {
+    /* some voxels are below the confidence threshold */
+    ten[0 + 7*ii] = AIR_CAST(float, airDrandMT_r(rng) < 0.9);
+    ten[1 + 7*ii] = AIR_CAST(float, 1 + airDrandMT_r(rng));
+    ten[2 + 7*ii] = AIR_CAST(float, airDrandMT_r(rng) - 0.5);
+    ten[3 + 7*ii] = AIR_CAST(float, airDrandMT_r(rng) - 0.5);
+    ten[4 + 7*ii] = AIR_CAST(float, 1 + airDrandMT_r(rng));
+    ten[5 + 7*ii] = AIR_CAST(float, airDrandMT_r(rng) - 0.5);
+    ten[6 + 7*ii] = AIR_CAST(float, 1 + airDrandMT_r(rng));
+  }
+  /* all of them */
+  anisoNum = TEN_ANISO_MAX;
+  for (ai=0; ai<anisoNum; ai++) {
+    aniso[ai] = tenAnisoUnknown + 1 + AIR_INT(ai);
+  }
+  for (ti=0; ti<3; ti++) {
+    if (tenAnisoVolumeMulti(nmulti, nten, aniso, anisoNum, 0.5,
+                            closedForm[ti], numThreads[ti])) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble:\n%s", me, err);
+      airMopError(mop); return 1;
+    }
+    if (!( 4 == nmulti->dim && anisoNum == nmulti->axis[0].size )) {
+      fprintf(stderr, "%s: got %u-D output with axis[0].size %u\n", me,
+              nmulti->dim, AIR_UINT(nmulti->axis[0].size));
+      airMopError(mop); return 1;
+    }
+    multi = AIR_CAST(float *, nmulti->data);
+    for (ai=0; ai<anisoNum; ai++) {
+      if (tenAnisoVolume(nsingle, nten, aniso[ai], 0.5)) {
+        airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+      single = AIR_CAST(float *, nsingle->data);
+      for (ii=0; ii<NN; ii++) {
+        tol = (closedForm[ti]
+               ? AIR_CAST(float, CLOSED_TOL*(1 + AIR_ABS(single[ii])))
+               : 0.0f);
+        if (!( AIR_ABS(multi[ai + anisoNum*ii] - single[ii]) <= tol )) {
+          fprintf(stderr, "%s: %s at voxel %u (%u threads%s): multi %.9g "
+                  "!= single %.9g\n", me, airEnumStr(tenAniso, aniso[ai]),
+                  ii, numThreads[ti], closedForm[ti] ? ", closed form" : "",
+                  multi[ai + anisoNum*ii], single[ii]);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,223 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenFiberMultiTrace, with 1 and with 3 threads, with and without
+** seedSort: every fiber (including those that went nowhere) and the
+** total number of probes must be the same, and no biff messages may
+** be left behind by the worker threads
+*/
+
+#define SIZE_XY 24
+#define SIZE_Z 8
+#define SEED_NUM 300
+
+/* tensors whose principal eigenvectors circle around the Z axis, with
+   isotropic tensors (where fibers stop on anisotropy) in the middle */
+static void
+circleVolume(Nrrd *nten) {
+  double xx, yy, rr, ee[3], ten[7];
+  unsigned int xi, yi, zi;
+  float *tdata;
+
+  tdata = AIR_CAST(float *, nten->data);
+  for (zi=0; zi<SIZE_Z; zi++) {
+    for (yi=0; yi<SIZE_XY; yi++) {
+      for (xi=0; xi<SIZE_XY; xi++) {
+        xx = xi - (SIZE_XY-1)/2.0;
+        yy = yi - (SIZE_XY-1)/2.0;
+        rr = sqrt(xx*xx + yy*yy);
+        ELL_3V_SET(ee, -yy, xx, 0);
+        if (rr) {
+          ELL_3V_SCALE(ee, 1/rr, ee);
+        }
+        /* eigenvalues 1 (along ee) and 0.2, or isotropic */
+        TEN_T_SET(ten, 1.0,
+                  0.2, 0, 0,
+                  0.2, 0,
+                  0.2);
+        if (rr > 3) {
+          ten[1] += 0.8*ee[0]*ee[0];
+          ten[2] += 0.8*ee[0]*ee[1];
+          ten[4] += 0.8*ee[1]*ee[1];
+        }
+        TEN_T_COPY_TT(tdata, float, ten);
+        tdata += 7;
+      }
+    }
+  }
+  return;
+}
+
+static int
+sameFiber(const tenFiberSingle *fa, const tenFiberSingle *fb) {
+  size_t nn;
+
+  if (!( fa->whyNowhere == fb->whyNowhere
+         && fa->dirIdx == fb->dirIdx
+         && fa->dirNum == fb->dirNum
+         && ELL_3V_EQUAL(fa->seedPos, fb->seedPos) )) {
+    return AIR_FALSE;
+  }
+  if (tenFiberStopUnknown != fa->whyNowhere) {
+    return AIR_TRUE;
+  }
+  if (!( fa->stepNum[0] == fb->stepNum[0]
+         && fa->stepNum[1] == fb->stepNum[1]
+         && fa->seedIdx == fb->seedIdx
+         && fa->halfLen[0] == fb->halfLen[0]
+         && fa->halfLen[1] == fb->halfLen[1]
+         && fa->whyStop[0] == fb->whyStop[0]
+         && fa->whyStop[1] == fb->whyStop[1] )) {
+    return AIR_FALSE;
+  }
+  nn = nrrdElementNumber(fa->nvert);
+  return (nn == nrrdElementNumber(fb->nvert)
+          && !memcmp(fa->nvert->data, fb->nvert->data, nn*sizeof(double)));
+}
+
+int
+main(void) {
+  static const unsigned int numThreads[3] = {1, 3, 3};
+  static const int seedSort[3] = {AIR_FALSE, AIR_FALSE, AIR_TRUE};
+  airArray *mop;
+  airRandMTState *rng;
+  char *err;
+  Nrrd *nten, *nseed;
+  tenFiberContext *tfx;
+  tenFiberMulti *tfml[3];
+  double *seed, kparm[NRRD_KERNEL_PARMS_NUM];
+  unsigned int ii, ti, started;
+  int E;
+
+  mop = airMopNew();
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  nseed = nrrdNew();
+  airMopAdd(mop, nseed, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_CAST(size_t, 7),
+                        AIR_CAST(size_t, SIZE_XY), AIR_CAST(size_t, SIZE_XY),
+                        AIR_CAST(size_t, SIZE_Z))
+      || nrrdMaybeAlloc_va(nseed, nrrdTypeDouble, 2, AIR_CAST(size_t, 3),
+                           AIR_CAST(size_t, SEED_NUM))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  circleVolume(nten);
+  nten->axis[0].kind = nrrdKind3DMaskedSymMatrix;
+  nrrdAxisInfoSet_va(nten, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  nrrdAxisInfoSet_va(nten, nrrdAxisInfoCenter, nrrdCenterUnknown,
+                     nrrdCenterCell, nrrdCenterCell, nrrdCenterCell);
+  /* seeds all over, including some outside the volume (which go
+     nowhere) and some in the isotropic middle (which stop right away) */
+  rng = airRandMTStateNew(4242);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  seed = AIR_CAST(double *, nseed->data);
+  for (ii=0; ii<SEED_NUM; ii++) {
+    ELL_3V_SET(seed + 3*ii,
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, -1, SIZE_XY),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, -1, SIZE_XY),
+               AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, SIZE_Z - 1));
+  }
+
+  tfx = tenFiberContextNew(nten);
+  if (!tfx) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble creating context:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, tfx, (airMopper)tenFiberContextNix, airMopAlways);
+  kparm[0] = 1.0;
+  E = 0;
+  if (!E) E |= tenFiberTypeSet(tfx, tenFiberTypeEvec0);
+  if (!E) E |= tenFiberKernelSet(tfx, nrrdKernelTent, kparm);
+  if (!E) E |= tenFiberIntgSet(tfx, tenFiberIntgRK4);
+  if (!E) E |= tenFiberStopSet(tfx, tenFiberStopAniso, tenAniso_Cl1, 0.2);
+  if (!E) E |= tenFiberStopSet(tfx, tenFiberStopLength, 30.0);
+  if (!E) E |= tenFiberStopSet(tfx, tenFiberStopNumSteps, 200);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmStepSize, 0.3);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmUseIndexSpace, AIR_TRUE);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting up context:\n%s", err);
+    airMopError(mop); return 1;
+  }
+
+  for (ti=0; ti<3; ti++) {
+    tfml[ti] = tenFiberMultiNew();
+    airMopAdd(mop, tfml[ti], (airMopper)tenFiberMultiNix, airMopAlways);
+    if (tenFiberParmSet(tfx, tenFiberParmNumThreads, numThreads[ti])
+        || tenFiberParmSet(tfx, tenFiberParmSeedSort, seedSort[ti])
+        || tenFiberUpdate(tfx)
+        || tenFiberMultiTrace(tfx, tfml[ti], nseed)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "trouble tracing with %u threads:\n%s",
+              numThreads[ti], err);
+      airMopError(mop); return 1;
+    }
+    if (biffCheck(TEN)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "tracing with %u threads left messages:\n%s",
+              numThreads[ti], err);
+      airMopError(mop); return 1;
+    }
+    if (SEED_NUM != tfml[ti]->fiberNum) {
+      fprintf(stderr, "got %u fibers with %u threads, not %u\n",
+              tfml[ti]->fiberNum, numThreads[ti], SEED_NUM);
+      airMopError(mop); return 1;
+    }
+  }
+  started = 0;
+  for (ii=0; ii<SEED_NUM; ii++) {
+    started += (tenFiberStopUnknown == tfml[0]->fiber[ii].whyNowhere
+                && tfml[0]->fiber[ii].stepNum[0]
+                + tfml[0]->fiber[ii].stepNum[1] > 10);
+    for (ti=1; ti<3; ti++) {
+      if (!sameFiber(tfml[0]->fiber + ii, tfml[ti]->fiber + ii)) {
+        fprintf(stderr, "fiber %u with %u threads (seedSort %d) differs "
+                "from with 1\n", ii, numThreads[ti], seedSort[ti]);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+  if (started < SEED_NUM/2) {
+    fprintf(stderr, "only %u of %u fibers went anywhere\n",
+            started, SEED_NUM);
+    airMopError(mop); return 1;
+  }
+  for (ti=1; ti<3; ti++) {
+    if (tfml[ti]->probeNum != tfml[0]->probeNum) {
+      fprintf(stderr, "%u probes with %u threads, but %u with 1\n",
+              AIR_CAST(unsigned int, tfml[ti]->probeNum), numThreads[ti],
+              AIR_CAST(unsigned int, tfml[0]->probeNum));
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,238 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** the number of steps that fiber tracing reports for each fiber half
+** (tenFiberSingle->stepNum[], tfx->numSteps[]), with and without
+** tenFiberParmResample, for each way a fiber can stop: each half has
+** one more vertex than steps, and seedIdx is the index of the seed
+** point. Without resampling, tracing into a buffer (tenFiberTraceSet
+** with NULL nfiber) has to give the same vertices, between *startIdxP
+** and *endIdxP
+*/
+
+#define SIZE_XY 24
+#define SIZE_Z 8
+#define SEED_NUM 60
+
+typedef struct {
+  double aniso, length;
+  unsigned int numSteps;
+} stopCase;
+
+/* tensors whose principal eigenvectors circle around the Z axis, with
+   isotropic tensors (where fibers stop on anisotropy) in the middle */
+static void
+circleVolume(Nrrd *nten) {
+  double xx, yy, rr, ee[3], ten[7];
+  unsigned int xi, yi, zi;
+  float *tdata;
+
+  tdata = AIR_CAST(float *, nten->data);
+  for (zi=0; zi<SIZE_Z; zi++) {
+    for (yi=0; yi<SIZE_XY; yi++) {
+      for (xi=0; xi<SIZE_XY; xi++) {
+        xx = xi - (SIZE_XY-1)/2.0;
+        yy = yi - (SIZE_XY-1)/2.0;
+        rr = sqrt(xx*xx + yy*yy);
+        ELL_3V_SET(ee, -yy, xx, 0);
+        if (rr) {
+          ELL_3V_SCALE(ee, 1/rr, ee);
+        }
+        TEN_T_SET(ten, 1.0,
+                  0.2, 0, 0,
+                  0.2, 0,
+                  0.2);
+        if (rr > 3) {
+          ten[1] += 0.8*ee[0]*ee[0];
+          ten[2] += 0.8*ee[0]*ee[1];
+          ten[4] += 0.8*ee[1]*ee[1];
+        }
+        TEN_T_COPY_TT(tdata, float, ten);
+        tdata += 7;
+      }
+    }
+  }
+  return;
+}
+
+int
+main(void) {
+  static const stopCase scase[] = {
+    {0.2, 30.0, 200},   /* mostly length, some aniso and bounds */
+    {0.2, 60.0, 15},    /* mostly numSteps */
+    {0.5, 60.0, 300}    /* mostly aniso and bounds */
+  };
+  static const int intg[3] = {tenFiberIntgEuler, tenFiberIntgRK4,
+                              tenFiberIntgRK45};
+  airArray *mop;
+  airRandMTState *rng;
+  char *err;
+  Nrrd *nten;
+  tenFiberContext *tfx;
+  tenFiberSingle *tfbs;
+  double seed[3], kparm[NRRD_KERNEL_PARMS_NUM], *vert, *buff;
+  unsigned int si, ci, ii, rs, vertNum, startIdx, endIdx, halfBuffLen,
+    seen[TEN_FIBER_STOP_MAX+1];
+  int E, whyStop;
+
+  mop = airMopNew();
+  nten = nrrdNew();
+  airMopAdd(mop, nten, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nten, nrrdTypeFloat, 4, AIR_CAST(size_t, 7),
+                        AIR_CAST(size_t, SIZE_XY), AIR_CAST(size_t, SIZE_XY),
+                        AIR_CAST(size_t, SIZE_Z))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  circleVolume(nten);
+  nten->axis[0].kind = nrrdKind3DMaskedSymMatrix;
+  nrrdAxisInfoSet_va(nten, nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  nrrdAxisInfoSet_va(nten, nrrdAxisInfoCenter, nrrdCenterUnknown,
+                     nrrdCenterCell, nrrdCenterCell, nrrdCenterCell);
+  rng = airRandMTStateNew(4242);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  tfbs = tenFiberSingleNew();
+  airMopAdd(mop, tfbs, (airMopper)tenFiberSingleNix, airMopAlways);
+  /* big enough for any numSteps in scase[] */
+  buff = AIR_CALLOC(3*(2*300 + 1), double);
+  airMopAdd(mop, buff, airFree, airMopAlways);
+  tfx = tenFiberContextNew(nten);
+  if (!tfx) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble creating context:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, tfx, (airMopper)tenFiberContextNix, airMopAlways);
+  kparm[0] = 1.0;
+  for (ii=0; ii<=TEN_FIBER_STOP_MAX; ii++) {
+    seen[ii] = 0;
+  }
+
+  for (ci=0; ci<AIR_CAST(unsigned int, sizeof(scase)/sizeof(scase[0]));
+       ci++) {
+    for (ii=0; ii<3*2; ii++) {
+      /* ii/2 is the integrator, ii%2 whether to resample */
+      rs = ii % 2;
+      E = 0;
+      if (!E) E |= tenFiberTypeSet(tfx, tenFiberTypeEvec0);
+      if (!E) E |= tenFiberKernelSet(tfx, nrrdKernelTent, kparm);
+      if (!E) E |= tenFiberIntgSet(tfx, intg[ii/2]);
+      if (!E) E |= tenFiberStopSet(tfx, tenFiberStopAniso, tenAniso_Cl1,
+                                   scase[ci].aniso);
+      if (!E) E |= tenFiberStopSet(tfx, tenFiberStopLength,
+                                   scase[ci].length);
+      if (!E) E |= tenFiberStopSet(tfx, tenFiberStopNumSteps,
+                                   scase[ci].numSteps);
+      if (!E) E |= tenFiberParmSet(tfx, tenFiberParmStepSize, 0.3);
+      if (!E) E |= tenFiberParmSet(tfx, tenFiberParmUseIndexSpace, AIR_TRUE);
+      if (!E) E |= tenFiberParmSet(tfx, tenFiberParmResample, rs);
+      if (!E) E |= tenFiberUpdate(tfx);
+      if (E) {
+        airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+        fprintf(stderr, "trouble setting up context:\n%s", err);
+        airMopError(mop); return 1;
+      }
+      for (si=0; si<SEED_NUM; si++) {
+        ELL_3V_SET(seed,
+                   AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, SIZE_XY - 1),
+                   AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, SIZE_XY - 1),
+                   AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, SIZE_Z - 1));
+        if (tenFiberSingleTrace(tfx, tfbs, seed, 0)) {
+          airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+          fprintf(stderr, "trouble tracing:\n%s", err);
+          airMopError(mop); return 1;
+        }
+        if (tenFiberStopUnknown != tfbs->whyNowhere) {
+          continue;
+        }
+        vertNum = AIR_CAST(unsigned int, tfbs->nvert->axis[1].size);
+        vert = AIR_CAST(double *, tfbs->nvert->data);
+        if (tfbs->stepNum[0] + tfbs->stepNum[1] + 1 != vertNum
+            || tfbs->seedIdx != tfbs->stepNum[0]
+            || !(ELL_3V_DIST(vert + 3*tfbs->seedIdx, seed) < 1e-9)) {
+          fprintf(stderr, "case %u, intg %s, resample %u, seed %u: "
+                  "%u + %u steps (stopped %s, %s) but %u vertices, "
+                  "seed at %u is (%g,%g,%g) not (%g,%g,%g)\n", ci,
+                  airEnumStr(tenFiberIntg, intg[ii/2]), rs, si,
+                  tfbs->stepNum[0], tfbs->stepNum[1],
+                  airEnumStr(tenFiberStop, tfbs->whyStop[0]),
+                  airEnumStr(tenFiberStop, tfbs->whyStop[1]), vertNum,
+                  tfbs->seedIdx, vert[0 + 3*tfbs->seedIdx],
+                  vert[1 + 3*tfbs->seedIdx], vert[2 + 3*tfbs->seedIdx],
+                  seed[0], seed[1], seed[2]);
+          airMopError(mop); return 1;
+        }
+        if (rs) {
+          continue;
+        }
+        whyStop = tfbs->whyStop[1];
+        seen[tfbs->whyStop[0]]++;
+        seen[whyStop]++;
+        if (tenFiberStopNumSteps == whyStop
+            && tfbs->stepNum[1] != scase[ci].numSteps) {
+          fprintf(stderr, "case %u, seed %u: stopped on numSteps after "
+                  "%u steps, not %u\n", ci, si, tfbs->stepNum[1],
+                  scase[ci].numSteps);
+          airMopError(mop); return 1;
+        }
+        /* the same fiber, into a buffer (which also sets numSteps) */
+        halfBuffLen = scase[ci].numSteps;
+        if (tenFiberTraceSet(tfx, NULL, buff, halfBuffLen,
+                             &startIdx, &endIdx, seed)) {
+          airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+          fprintf(stderr, "trouble tracing into buffer:\n%s", err);
+          airMopError(mop); return 1;
+        }
+        if (!( halfBuffLen - tfbs->seedIdx == startIdx
+               && startIdx + vertNum - 1 == endIdx
+               && !memcmp(buff + 3*startIdx, vert,
+                          3*vertNum*sizeof(double)) )) {
+          fprintf(stderr, "case %u, intg %s, seed %u: buffer [%u,%u] "
+                  "differs from the %u vertices (seed at %u)\n", ci,
+                  airEnumStr(tenFiberIntg, intg[ii/2]), si, startIdx,
+                  endIdx, vertNum, tfbs->seedIdx);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+  for (ii=0; ii<=TEN_FIBER_STOP_MAX; ii++) {
+    if ((tenFiberStopAniso == AIR_CAST(int, ii)
+         || tenFiberStopLength == AIR_CAST(int, ii)
+         || tenFiberStopNumSteps == AIR_CAST(int, ii)
+         || tenFiberStopBounds == AIR_CAST(int, ii))
+        && !seen[ii]) {
+      fprintf(stderr, "no fiber half stopped on %s\n",
+              airEnumStr(tenFiberStop, AIR_CAST(int, ii)));
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
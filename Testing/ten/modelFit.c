@@ -0,0 +1,172 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/ten.h"
+
+/*
+** Tests:
+** tenModelSqeFit, recovering (to DIFF_EPS) the ball diffusivities
+** that tenModelSimulate made noise-free DWIs from, and giving the
+** same 1stick fits with 1 and with 3 threads; tenModelNllFit failing
+** for a model without ML fitting
+*/
+
+#define GRAD_NUM 30
+#define DIFF_EPS 1e-6   /* max relative error in ball diffusivity */
+
+/* simulates DWIs from random parameters for model, and fits them
+   with 1 and with 3 threads */
+static int
+simFit(Nrrd *nparm, Nrrd *ndwi, Nrrd *const nfit[2],
+       const tenModel *model, tenExperSpec *espec,
+       unsigned int sampNum, airArray *mop) {
+  static const unsigned int numThreads[2] = {1, 3};
+  airRandMTState *rng;
+  char *err;
+  double *parm, len;
+  unsigned int ii, ti;
+  size_t sz[2];
+
+  sz[0] = model->parmNum;
+  sz[1] = sampNum;
+  if (nrrdMaybeAlloc_nva(nparm, nrrdTypeDouble, 2, sz)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "trouble allocating:\n%s", err);
+    return 1;
+  }
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  parm = AIR_CAST(double *, nparm->data);
+  for (ii=0; ii<sampNum; ii++) {
+    double *pp = parm + model->parmNum*ii;
+    /* B0 and diffusivity are first for both ball and 1stick */
+    pp[0] = AIR_AFFINE(0, airDrandMT_r(rng), 1, 500, 1500);
+    pp[1] = AIR_AFFINE(0, airDrandMT_r(rng), 1, 0.0005, 0.002);
+    if (5 == model->parmNum) {
+      airNormalRand_r(pp + 2, pp + 3, rng);
+      airNormalRand_r(pp + 4, NULL, rng);
+      ELL_3V_NORM(pp + 2, pp + 2, len);
+    }
+  }
+  if (tenModelSimulate(ndwi, nrrdTypeDouble, espec, model,
+                       NULL, nparm, AIR_FALSE)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble simulating %s:\n%s", model->name, err);
+    return 1;
+  }
+  for (ti=0; ti<2; ti++) {
+    airSrandMT_r(rng, 4242);
+    if (tenModelSqeFit(nfit[ti], NULL, NULL, NULL, model,
+                       espec, ndwi, AIR_TRUE /* knownB0 */,
+                       AIR_TRUE /* saveB0 */, nrrdTypeDouble,
+                       3, 500, 5 /* starts */, 0, 0.00001, rng,
+                       numThreads[ti], AIR_FALSE)) {
+      airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "trouble fitting %s with %u threads:\n%s",
+              model->name, numThreads[ti], err);
+      return 1;
+    }
+  }
+  if (nrrdElementSize(nfit[0])*nrrdElementNumber(nfit[0])
+      != nrrdElementSize(nfit[1])*nrrdElementNumber(nfit[1])
+      || memcmp(nfit[0]->data, nfit[1]->data,
+                nrrdElementSize(nfit[0])*nrrdElementNumber(nfit[0]))) {
+    fprintf(stderr, "%s fit with %u threads differs from fit with %u\n",
+            model->name, numThreads[1], numThreads[0]);
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(void) {
+  airArray *mop;
+  char *err;
+  tenExperSpec *espec;
+  airRandMTState *rng;
+  Nrrd *nparm, *ndwi, *nfit[2];
+  double grad[3*GRAD_NUM], *parm, *fit, theta, phi, derr;
+  unsigned int ii, ti;
+
+  mop = airMopNew();
+  /* directions spiraling over the sphere */
+  for (ii=0; ii<GRAD_NUM; ii++) {
+    theta = acos(AIR_AFFINE(-0.5, ii, GRAD_NUM-0.5, 1, -1));
+    phi = sqrt(GRAD_NUM*AIR_PI)*theta;
+    ELL_3V_SET(grad + 3*ii, cos(phi)*sin(theta), sin(phi)*sin(theta),
+               cos(theta));
+  }
+  espec = tenExperSpecNew();
+  airMopAdd(mop, espec, (airMopper)tenExperSpecNix, airMopAlways);
+  if (tenExperSpecGradSingleBValSet(espec, AIR_TRUE /* insertB0 */,
+                                    1000, grad, GRAD_NUM)) {
+    airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+    fprintf(stderr, "trouble setting experiment:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  nparm = nrrdNew();
+  airMopAdd(mop, nparm, (airMopper)nrrdNuke, airMopAlways);
+  ndwi = nrrdNew();
+  airMopAdd(mop, ndwi, (airMopper)nrrdNuke, airMopAlways);
+  for (ti=0; ti<2; ti++) {
+    nfit[ti] = nrrdNew();
+    airMopAdd(mop, nfit[ti], (airMopper)nrrdNuke, airMopAlways);
+  }
+
+  /* ball: the fit has to find the known answer */
+  if (simFit(nparm, ndwi, nfit, tenModelBall, espec, 40, mop)) {
+    airMopError(mop); return 1;
+  }
+  parm = AIR_CAST(double *, nparm->data);
+  fit = AIR_CAST(double *, nfit[0]->data);
+  for (ii=0; ii<40; ii++) {
+    derr = AIR_ABS(fit[1 + 2*ii] - parm[1 + 2*ii])/parm[1 + 2*ii];
+    if (!( fit[0 + 2*ii] == parm[0 + 2*ii] && derr < DIFF_EPS )) {
+      fprintf(stderr, "ball sample %u: fit (%g) %g not close to "
+              "truth (%g) %g\n", ii, fit[0 + 2*ii], fit[1 + 2*ii],
+              parm[0 + 2*ii], parm[1 + 2*ii]);
+      airMopError(mop); return 1;
+    }
+  }
+  /* 1stick: gradient descent doesn't converge tightly enough to
+     compare against the known answer, but threading must not matter */
+  if (simFit(nparm, ndwi, nfit, tenModel1Stick, espec, 10, mop)) {
+    airMopError(mop); return 1;
+  }
+
+  /* no model has maximum-likelihood fitting, so this has to fail */
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  if (!tenModelNllFit(nfit[0], NULL, tenModel1Stick, espec, ndwi,
+                      AIR_TRUE, 10, AIR_TRUE, AIR_TRUE, nrrdTypeDouble,
+                      5, 0, 0.00001, rng, 1, AIR_FALSE)) {
+    fprintf(stderr, "tenModelNllFit didn't fail for %s\n",
+            tenModel1Stick->name);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
+  printf("tenModelNllFit failed as expected:\n%s", err);
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -352,6 +352,9 @@ pullInterTypeUnknown = 0
 airMopAlways = 3
 airTypeSize_t = 6
 airMopNever = 0
+airThreadOnceUnknown = 0
+airThreadOnceBiff = 1
+airThreadOnceLast = 2
 tenAniso_Ct2 = 13
 tenGageTensorGradRotE = 176
 nrrdSpaceUnknown = 0
@@ -427,9 +430,10 @@ nrrdField_block_size = 5
 nrrdBinaryOpIf = 21
 alanParmTextureType = 2
 nrrdSpaceLeftPosteriorSuperior = 3
-gageErrLast = 7
+gageErrLast = 8
 nrrdBinaryOpExists = 20
 gageErrStackUnused = 6
+gageErrStackLazy = 7
 limnPrimitiveNoop = 1
 nrrdBinaryOpNotEqual = 19
 tenAniso_Ca2 = 10
@@ -534,6 +538,8 @@ airNoDio_std = 3
 tenDwiGageLast = 36
 tenDwiGage2TensorPeledLevmarInfo = 35
 alanParmWrapAround = 21
+alanParmIterBlock = 22
+alanParmSlabSize = 23
 alanParmConstantFilename = 20
 alanParmAlpha = 18
 tenGageFALaplacian = 108
@@ -601,8 +607,9 @@ limnDeviceGL = 2
 airFP_POS_DENORM = 7
 tenInterpTypeRThetaPhiLinear = 11
 pullIterParmMax = 2
-echoTypeLast = 12
+echoTypeLast = 13
 echoTypeInstance = 11
+echoTypeBVH = 12
 tenDwiGageTensorWLSErrorLog = 12
 echoTypeList = 10
 echoTypeSplit = 9
@@ -644,7 +651,7 @@ coilMethodTypeLast = 9
 tenDwiGageUnknown = 0
 tenGageFAHessianFrob = 105
 gageSigmaSamplingOptimal3DL2L2 = 3
-tenFiberIntgLast = 4
+tenFiberIntgLast = 5
 tenTripleTypeRThetaZ = 4
 tenGageTensorQuatGeoLoxK = 164
 echoMatterGlassFuzzy = 3
@@ -1008,7 +1015,13 @@ limnQN14checker = 6
 nrrdTypeLast = 12
 gageSclHessEvec1 = 17
 gageSclHessEvec0 = 16
-tenFiberParmLast = 5
+tenFiberParmLast = 11
+tenFiberParmNumThreads = 5
+tenFiberParmSeedSort = 6
+tenFiberParmErrTol = 7
+tenFiberParmStepSizeMin = 8
+tenFiberParmStepSizeMax = 9
+tenFiberParmResample = 10
 nrrdMeasureHistoProduct = 26
 nrrdBoundaryMirror = 5
 nrrdMeasureHistoMode = 25
@@ -1270,6 +1283,7 @@ nrrdTernaryOpMin = 3
 gageVecCurlNormGrad = 20
 nrrdUnaryOpCeil = 19
 tenFiberIntgRK4 = 3
+tenFiberIntgRK45 = 4
 nrrdSpaceScannerXYZTime = 8
 tenFiberIntgEuler = 1
 gageItemPackPartGradMag = 3
@@ -1401,7 +1415,7 @@ gageVecLength = 5
 tenAniso_Det = 25
 nrrdUnaryOpLast = 33
 nrrdUnaryOpSigmaOfTau = 32
-alanParmLast = 22
+alanParmLast = 24
 nrrdUnaryOpTauOfSigma = 31
 nrrdUnaryOpOne = 30
 nrrdUnaryOpZero = 29
@@ -1579,6 +1593,30 @@ airHeapRemove.argtypes = [POINTER(airHeap), c_uint]
 airHeapUpdate = libteem.airHeapUpdate
 airHeapUpdate.restype = c_int
 airHeapUpdate.argtypes = [POINTER(airHeap), c_uint, c_double, c_void_p]
+class airArena(Structure):
+    pass
+airArena._fields_ = [
+    ('blockSize', c_size_t),
+    ('block', c_void_p),
+    ('used', c_size_t),
+    ('allocNum', c_size_t),
+    ('allocBytes', c_size_t),
+    ('blockNum', c_size_t),
+    ('blockBytes', c_size_t),
+    ('blockBytesMax', c_size_t),
+]
+airArenaNew = libteem.airArenaNew
+airArenaNew.restype = POINTER(airArena)
+airArenaNew.argtypes = [c_size_t]
+airArenaAlloc = libteem.airArenaAlloc
+airArenaAlloc.restype = c_void_p
+airArenaAlloc.argtypes = [POINTER(airArena), c_size_t]
+airArenaReset = libteem.airArenaReset
+airArenaReset.restype = None
+airArenaReset.argtypes = [POINTER(airArena)]
+airArenaNix = libteem.airArenaNix
+airArenaNix.restype = POINTER(airArena)
+airArenaNix.argtypes = [POINTER(airArena)]
 airThreadCapable = (c_int).in_dll(libteem, 'airThreadCapable')
 airThreadNoopWarning = (c_int).in_dll(libteem, 'airThreadNoopWarning')
 class _airThread(Structure):
@@ -1590,6 +1628,9 @@ airThreadMutex = _airThreadMutex
 class _airThreadCond(Structure):
     pass
 airThreadCond = _airThreadCond
+class _airThreadKey(Structure):
+    pass
+airThreadKey = _airThreadKey
 class airThreadBarrier(Structure):
     pass
 airThreadBarrier._fields_ = [
@@ -1646,6 +1687,24 @@ airThreadBarrierWait.argtypes = [POINTER(airThreadBarrier)]
 airThreadBarrierNix = libteem.airThreadBarrierNix
 airThreadBarrierNix.restype = POINTER(airThreadBarrier)
 airThreadBarrierNix.argtypes = [POINTER(airThreadBarrier)]
+airThreadKeyNew = libteem.airThreadKeyNew
+airThreadKeyNew.restype = POINTER(airThreadKey)
+airThreadKeyNew.argtypes = []
+airThreadKeyGet = libteem.airThreadKeyGet
+airThreadKeyGet.restype = c_void_p
+airThreadKeyGet.argtypes = [POINTER(airThreadKey)]
+airThreadKeySet = libteem.airThreadKeySet
+airThreadKeySet.restype = c_int
+airThreadKeySet.argtypes = [POINTER(airThreadKey), c_void_p]
+airThreadKeyNix = libteem.airThreadKeyNix
+airThreadKeyNix.restype = POINTER(airThreadKey)
+airThreadKeyNix.argtypes = [POINTER(airThreadKey)]
+airThreadKeyInheritSet = libteem.airThreadKeyInheritSet
+airThreadKeyInheritSet.restype = c_int
+airThreadKeyInheritSet.argtypes = [POINTER(airThreadKey), c_int]
+airThreadOnce = libteem.airThreadOnce
+airThreadOnce.restype = c_int
+airThreadOnce.argtypes = [c_int, CFUNCTYPE(None)]
 class airFloat(Union):
     pass
 airFloat._fields_ = [
@@ -2079,6 +2138,9 @@ airMopSingleError.argtypes = [POINTER(airArray), c_void_p]
 airMopSingleOkay = libteem.airMopSingleOkay
 airMopSingleOkay.restype = None
 airMopSingleOkay.argtypes = [POINTER(airArray), c_void_p]
+airMopArenaAlloc = libteem.airMopArenaAlloc
+airMopArenaAlloc.restype = c_void_p
+airMopArenaAlloc.argtypes = [POINTER(airArray), c_size_t]
 alan_t = c_float
 class alanContext_t(Structure):
     pass
@@ -2097,6 +2159,8 @@ alanContext_t._fields_ = [
     ('saveInterval', c_int),
     ('maxIteration', c_int),
     ('constFilename', c_int),
+    ('iterBlock', c_int),
+    ('slabSize', c_int),
     ('K', alan_t),
     ('F', alan_t),
     ('deltaX', alan_t),
@@ -2121,6 +2185,9 @@ alanContext_t._fields_ = [
     ('changeCount', c_int),
     ('changeMutex', POINTER(airThreadMutex)),
     ('iterBarrier', POINTER(airThreadBarrier)),
+    ('slabLen', c_int),
+    ('nextSlab', c_int),
+    ('blockStop', c_int),
     ('stop', c_int),
 ]
 alanContext = alanContext_t
@@ -2273,6 +2340,8 @@ baneHVolParm._fields_ = [
     ('kparm', c_double * 8 * 8),
     ('clip', POINTER(baneClip)),
     ('incLimit', c_double),
+    ('numThreads', c_uint),
+    ('separable', c_int),
     ('axis', baneAxis * 3),
     ('measrVol', POINTER(Nrrd)),
     ('measrVolDone', c_int),
@@ -2283,6 +2352,7 @@ baneDefMakeMeasrVol = (c_int).in_dll(libteem, 'baneDefMakeMeasrVol')
 baneDefIncLimit = (c_double).in_dll(libteem, 'baneDefIncLimit')
 baneDefRenormalize = (c_int).in_dll(libteem, 'baneDefRenormalize')
 baneDefPercHistBins = (c_int).in_dll(libteem, 'baneDefPercHistBins')
+baneDefSeparable = (c_int).in_dll(libteem, 'baneDefSeparable')
 baneStateHistEqBins = (c_int).in_dll(libteem, 'baneStateHistEqBins')
 baneStateHistEqSmart = (c_int).in_dll(libteem, 'baneStateHistEqSmart')
 baneHack = (c_int).in_dll(libteem, 'baneHack')
@@ -2510,6 +2580,9 @@ biffMovef.argtypes = [STRING, STRING, STRING]
 biffSetStrDone = libteem.biffSetStrDone
 biffSetStrDone.restype = None
 biffSetStrDone.argtypes = [STRING, STRING]
+biffThreadLocalSet = libteem.biffThreadLocalSet
+biffThreadLocalSet.restype = c_int
+biffThreadLocalSet.argtypes = [c_int]
 biffDone = libteem.biffDone
 biffDone.restype = None
 biffDone.argtypes = [STRING]
@@ -2531,6 +2604,7 @@ coilKind._fields_ = [
     ('valLen', c_uint),
     ('filter', CFUNCTYPE(None, POINTER(coil_t), c_int, c_int, c_int, POINTER(POINTER(coil_t)), POINTER(c_double), POINTER(c_double)) * 9),
     ('update', CFUNCTYPE(None, POINTER(coil_t), POINTER(coil_t))),
+    ('filterRow', CFUNCTYPE(None, POINTER(coil_t), POINTER(POINTER(coil_t)), POINTER(coil_t), c_uint, POINTER(c_double), POINTER(c_double)) * 9),
 ]
 class coilTask(Structure):
     pass
@@ -2543,6 +2617,9 @@ coilTask._fields_ = [
     ('_iv3', POINTER(coil_t)),
     ('iv3', POINTER(POINTER(coil_t))),
     ('iv3Fill', CFUNCTYPE(None, POINTER(POINTER(coil_t)), POINTER(coil_t), c_uint, c_int, c_int, c_int, c_int, c_int, c_int, c_int)),
+    ('slab', POINTER(coil_t) * 2),
+    ('rowDelta', POINTER(coil_t)),
+    ('rowBuff', POINTER(coil_t)),
     ('returnPtr', c_void_p),
 ]
 coilContext_t._pack_ = 4
@@ -2554,6 +2631,9 @@ coilContext_t._fields_ = [
     ('numThreads', c_uint),
     ('verbose', c_int),
     ('parm', c_double * 6),
+    ('rowPath', c_int),
+    ('iterBlock', c_uint),
+    ('slabSize', c_uint),
     ('iter', c_uint),
     ('size', c_size_t * 3),
     ('nextSlice', c_size_t),
@@ -2566,6 +2646,10 @@ coilContext_t._fields_ = [
     ('task', POINTER(POINTER(coilTask))),
     ('filterBarrier', POINTER(airThreadBarrier)),
     ('updateBarrier', POINTER(airThreadBarrier)),
+    ('rowDo', c_int),
+    ('rowSrc', c_uint),
+    ('rowIter', c_uint),
+    ('nextSlab', c_uint),
 ]
 coilContext = coilContext_t
 coilPresent = (c_int).in_dll(libteem, 'coilPresent')
@@ -2699,12 +2783,14 @@ echoRTParm._fields_ = [
     ('seedRand', c_int),
     ('sqNRI', c_int),
     ('numThreads', c_int),
+    ('tileSize', c_int),
     ('sqTol', echoPos_t),
     ('shadow', echoCol_t),
     ('glassC', echoCol_t),
     ('aperture', c_float),
     ('timeGamma', c_float),
     ('boxOpac', c_float),
+    ('adaptThresh', c_float),
     ('maxRecCol', echoCol_t * 3),
 ]
 class echoGlobalState(Structure):
@@ -2724,6 +2810,8 @@ echoGlobalState._fields_ = [
     ('parm', POINTER(echoRTParm)),
     ('workIdx', c_int),
     ('workMutex', POINTER(airThreadMutex)),
+    ('refinePass', c_int),
+    ('refine', POINTER(c_ubyte)),
 ]
 class echoThreadState(Structure):
     pass
@@ -2818,6 +2906,15 @@ echoRectangle._fields_ = [
     ('edge0', echoPos_t * 3),
     ('edge1', echoPos_t * 3),
 ]
+class echoBVHNode(Structure):
+    pass
+echoBVHNode._pack_ = 4
+echoBVHNode._fields_ = [
+    ('min', echoPos_t * 3),
+    ('max', echoPos_t * 3),
+    ('offset', c_uint),
+    ('num', c_uint),
+]
 class echoTriMesh(Structure):
     pass
 echoTriMesh._pack_ = 4
@@ -2834,6 +2931,9 @@ echoTriMesh._fields_ = [
     ('numF', c_int),
     ('pos', POINTER(echoPos_t)),
     ('vert', POINTER(c_int)),
+    ('bvh', POINTER(echoBVHNode)),
+    ('bvhNum', c_uint),
+    ('bvhFace', POINTER(c_uint)),
 ]
 class echoIsosurface(Structure):
     pass
@@ -2884,6 +2984,15 @@ echoInstance._fields_ = [
     ('M', echoPos_t * 16),
     ('obj', POINTER(echoObject)),
 ]
+class echoBVH(Structure):
+    pass
+echoBVH._fields_ = [
+    ('type', c_byte),
+    ('node', POINTER(echoBVHNode)),
+    ('nodeNum', c_uint),
+    ('obj', POINTER(POINTER(echoObject))),
+    ('objNum', c_uint),
+]
 echoScene_t._fields_ = [
     ('cat', POINTER(POINTER(echoObject))),
     ('catArr', POINTER(airArray)),
@@ -2984,6 +3093,9 @@ echoListSplit.argtypes = [POINTER(echoScene), POINTER(echoObject), c_int]
 echoListSplit3 = libteem.echoListSplit3
 echoListSplit3.restype = POINTER(echoObject)
 echoListSplit3.argtypes = [POINTER(echoScene), POINTER(echoObject), c_int]
+echoListBVH = libteem.echoListBVH
+echoListBVH.restype = POINTER(echoObject)
+echoListBVH.argtypes = [POINTER(echoScene), POINTER(echoObject)]
 echoSphereSet = libteem.echoSphereSet
 echoSphereSet.restype = None
 echoSphereSet.argtypes = [POINTER(echoObject), echoPos_t, echoPos_t, echoPos_t, echoPos_t]
@@ -3517,6 +3629,8 @@ class NrrdKernelSpec(Structure):
     pass
 class gagePerVolume_t(Structure):
     pass
+class gageStackLazy_t(Structure):
+    pass
 gageContext_t._pack_ = 4
 gageContext_t._fields_ = [
     ('verbose', c_int),
@@ -3540,6 +3654,8 @@ gageContext_t._fields_ = [
     ('errStr', c_char * 513),
     ('errNum', c_int),
     ('edgeFrac', c_double),
+    ('probeNum', c_size_t),
+    ('fillNum', c_size_t),
 ]
 class gageKind_t(Structure):
     pass
@@ -3575,6 +3691,11 @@ gagePerVolume_t._fields_ = [
     ('answer', POINTER(c_double)),
     ('directAnswer', POINTER(POINTER(c_double))),
     ('data', c_void_p),
+    ('lazy', POINTER(gageStackLazy_t)),
+    ('lazyIdx', c_uint),
+    ('lazyPinLo', c_uint * 3),
+    ('lazyPinHi', c_uint * 3),
+    ('lazyPinned', c_int),
 ]
 gageKind = gageKind_t
 class gageItemSpec(Structure):
@@ -3604,9 +3725,32 @@ gageStackBlurParm._fields_ = [
     ('bspec', POINTER(NrrdBoundarySpec)),
     ('oneDim', c_int),
     ('needSpatialBlur', c_int),
+    ('recursive', c_int),
+    ('pyramid', c_int),
     ('verbose', c_int),
     ('dgGoodSigmaMax', c_double),
 ]
+gageStackLazy_t._fields_ = [
+    ('nin', POINTER(Nrrd)),
+    ('kind', POINTER(gageKind_t)),
+    ('sbp', POINTER(gageStackBlurParm)),
+    ('brickSize', c_uint),
+    ('brickNum', c_uint * 3),
+    ('slotNum', c_uint),
+    ('nbrick', POINTER(POINTER(Nrrd))),
+    ('pinNum', POINTER(c_uint)),
+    ('lruPrev', POINTER(c_uint)),
+    ('lruNext', POINTER(c_uint)),
+    ('lruFirst', c_uint),
+    ('lruLast', c_uint),
+    ('memMax', c_size_t),
+    ('memUsed', c_size_t),
+    ('computeNum', c_uint),
+    ('evictNum', c_uint),
+    ('slotMutex', POINTER(airThreadMutex) * 16),
+    ('lruMutex', POINTER(airThreadMutex)),
+]
+gageStackLazy = gageStackLazy_t
 class gageOptimSigContext(Structure):
     pass
 gageOptimSigContext._pack_ = 4
@@ -3816,6 +3960,8 @@ gageStackProbeSpace = libteem.gageStackProbeSpace
 gageStackProbeSpace.restype = c_int
 gageStackProbeSpace.argtypes = [POINTER(gageContext), c_double, c_double, c_double, c_double, c_int, c_int]
 gageSigmaSampling = (POINTER(airEnum)).in_dll(libteem, 'gageSigmaSampling')
+gageStackBlurRecursiveSigmaMin = (c_double).in_dll(libteem, 'gageStackBlurRecursiveSigmaMin')
+gageStackBlurPyramidSigmaMin = (c_double).in_dll(libteem, 'gageStackBlurPyramidSigmaMin')
 gageStackBlurParmNew = libteem.gageStackBlurParmNew
 gageStackBlurParmNew.restype = POINTER(gageStackBlurParm)
 gageStackBlurParmNew.argtypes = []
@@ -3860,6 +4006,12 @@ gageStackBlurParmBoundarySpecSet.argtypes = [POINTER(gageStackBlurParm), POINTER
 gageStackBlurParmNeedSpatialBlurSet = libteem.gageStackBlurParmNeedSpatialBlurSet
 gageStackBlurParmNeedSpatialBlurSet.restype = c_int
 gageStackBlurParmNeedSpatialBlurSet.argtypes = [POINTER(gageStackBlurParm), c_int]
+gageStackBlurParmRecursiveSet = libteem.gageStackBlurParmRecursiveSet
+gageStackBlurParmRecursiveSet.restype = c_int
+gageStackBlurParmRecursiveSet.argtypes = [POINTER(gageStackBlurParm), c_int]
+gageStackBlurParmPyramidSet = libteem.gageStackBlurParmPyramidSet
+gageStackBlurParmPyramidSet.restype = c_int
+gageStackBlurParmPyramidSet.argtypes = [POINTER(gageStackBlurParm), c_int]
 gageStackBlurParmVerboseSet = libteem.gageStackBlurParmVerboseSet
 gageStackBlurParmVerboseSet.restype = c_int
 gageStackBlurParmVerboseSet.argtypes = [POINTER(gageStackBlurParm), c_int]
@@ -3891,6 +4043,18 @@ NrrdEncoding = NrrdEncoding_t
 gageStackBlurManage = libteem.gageStackBlurManage
 gageStackBlurManage.restype = c_int
 gageStackBlurManage.argtypes = [POINTER(POINTER(POINTER(Nrrd))), POINTER(c_int), POINTER(gageStackBlurParm), STRING, c_int, POINTER(NrrdEncoding), POINTER(Nrrd), POINTER(gageKind)]
+gageStackBlurCacheGet = libteem.gageStackBlurCacheGet
+gageStackBlurCacheGet.restype = c_int
+gageStackBlurCacheGet.argtypes = [POINTER(POINTER(Nrrd)), POINTER(c_int), POINTER(gageStackBlurParm), STRING, c_double, POINTER(Nrrd), POINTER(gageKind)]
+gageStackLazyNew = libteem.gageStackLazyNew
+gageStackLazyNew.restype = POINTER(gageStackLazy)
+gageStackLazyNew.argtypes = [POINTER(Nrrd), POINTER(gageKind), POINTER(gageStackBlurParm), c_uint, c_double]
+gageStackLazyNix = libteem.gageStackLazyNix
+gageStackLazyNix.restype = POINTER(gageStackLazy)
+gageStackLazyNix.argtypes = [POINTER(gageStackLazy)]
+gageStackLazyPerVolumeNew = libteem.gageStackLazyPerVolumeNew
+gageStackLazyPerVolumeNew.restype = c_int
+gageStackLazyPerVolumeNew.argtypes = [POINTER(gageContext), POINTER(POINTER(gagePerVolume)), POINTER(gageStackLazy)]
 gageContextNew = libteem.gageContextNew
 gageContextNew.restype = POINTER(gageContext)
 gageContextNew.argtypes = []
@@ -4736,7 +4900,7 @@ meetPullVolStackBlurParmFinishMulti.restype = c_int
 meetPullVolStackBlurParmFinishMulti.argtypes = [POINTER(POINTER(meetPullVol)), c_uint, POINTER(c_uint), POINTER(c_uint), POINTER(NrrdKernelSpec), POINTER(NrrdBoundarySpec)]
 meetPullVolLoadMulti = libteem.meetPullVolLoadMulti
 meetPullVolLoadMulti.restype = c_int
-meetPullVolLoadMulti.argtypes = [POINTER(POINTER(meetPullVol)), c_uint, STRING, c_int]
+meetPullVolLoadMulti.argtypes = [POINTER(POINTER(meetPullVol)), c_uint, STRING, c_double, c_int]
 class pullContext_t(Structure):
     pass
 pullContext = pullContext_t
@@ -5054,6 +5218,7 @@ nrrdStateMeasureType = (c_int).in_dll(libteem, 'nrrdStateMeasureType')
 nrrdStateMeasureModeBins = (c_int).in_dll(libteem, 'nrrdStateMeasureModeBins')
 nrrdStateMeasureHistoType = (c_int).in_dll(libteem, 'nrrdStateMeasureHistoType')
 nrrdStateDisallowIntegerNonExist = (c_int).in_dll(libteem, 'nrrdStateDisallowIntegerNonExist')
+nrrdStateNumThreads = (c_uint).in_dll(libteem, 'nrrdStateNumThreads')
 nrrdStateAlwaysSetContent = (c_int).in_dll(libteem, 'nrrdStateAlwaysSetContent')
 nrrdStateDisableContent = (c_int).in_dll(libteem, 'nrrdStateDisableContent')
 nrrdStateUnknownContent = (STRING).in_dll(libteem, 'nrrdStateUnknownContent')
@@ -5079,6 +5244,7 @@ nrrdEnvVarStateMeasureType = (STRING).in_dll(libteem, 'nrrdEnvVarStateMeasureTyp
 nrrdEnvVarStateMeasureModeBins = (STRING).in_dll(libteem, 'nrrdEnvVarStateMeasureModeBins')
 nrrdEnvVarStateMeasureHistoType = (STRING).in_dll(libteem, 'nrrdEnvVarStateMeasureHistoType')
 nrrdEnvVarStateGrayscaleImage3D = (STRING).in_dll(libteem, 'nrrdEnvVarStateGrayscaleImage3D')
+nrrdEnvVarStateNumThreads = (STRING).in_dll(libteem, 'nrrdEnvVarStateNumThreads')
 nrrdGetenvBool = libteem.nrrdGetenvBool
 nrrdGetenvBool.restype = c_int
 nrrdGetenvBool.argtypes = [POINTER(c_int), POINTER(STRING), STRING]
@@ -5763,6 +5929,9 @@ nrrdCRC32.argtypes = [POINTER(Nrrd), c_int]
 nrrdCheapMedian = libteem.nrrdCheapMedian
 nrrdCheapMedian.restype = c_int
 nrrdCheapMedian.argtypes = [POINTER(Nrrd), POINTER(Nrrd), c_int, c_int, c_uint, c_float, c_uint]
+nrrdExactMedian = libteem.nrrdExactMedian
+nrrdExactMedian.restype = c_int
+nrrdExactMedian.argtypes = [POINTER(Nrrd), POINTER(Nrrd), c_int, c_uint, c_double, c_uint]
 nrrdDistanceL2 = libteem.nrrdDistanceL2
 nrrdDistanceL2.restype = c_int
 nrrdDistanceL2.argtypes = [POINTER(Nrrd), POINTER(Nrrd), c_int, POINTER(c_int), c_double, c_int]
@@ -5934,6 +6103,13 @@ nrrdFFT.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(c_uint), c_uint, c_int
 nrrdFFTWWisdomWrite = libteem.nrrdFFTWWisdomWrite
 nrrdFFTWWisdomWrite.restype = c_int
 nrrdFFTWWisdomWrite.argtypes = [POINTER(FILE)]
+nrrdThreadJob = CFUNCTYPE(None, c_void_p, c_uint, c_uint)
+nrrdThreadRun = libteem.nrrdThreadRun
+nrrdThreadRun.restype = c_int
+nrrdThreadRun.argtypes = [c_uint, c_uint, nrrdThreadJob, c_void_p]
+nrrdThreadNum = libteem.nrrdThreadNum
+nrrdThreadNum.restype = c_uint
+nrrdThreadNum.argtypes = [c_uint, c_uint]
 nrrdKernelTMF = (POINTER(NrrdKernel) * 5 * 5 * 4).in_dll(libteem, 'nrrdKernelTMF')
 nrrdKernelTMF_maxD = (c_uint).in_dll(libteem, 'nrrdKernelTMF_maxD')
 nrrdKernelTMF_maxC = (c_uint).in_dll(libteem, 'nrrdKernelTMF_maxC')
@@ -6107,6 +6283,7 @@ pullVolume._fields_ = [
     ('kind', POINTER(gageKind)),
     ('ninSingle', POINTER(Nrrd)),
     ('ninScale', POINTER(POINTER(Nrrd))),
+    ('lazySS', POINTER(gageStackLazy)),
     ('scaleNum', c_uint),
     ('scalePos', POINTER(c_double)),
     ('scaleDerivNorm', c_int),
@@ -6141,8 +6318,13 @@ pullTask_t._fields_ = [
     ('nixPoint', POINTER(POINTER(pullPoint))),
     ('nixPointNum', c_uint),
     ('nixPointArr', POINTER(airArray)),
+    ('poolPoint', POINTER(POINTER(pullPoint))),
+    ('poolPointNum', c_uint),
+    ('poolPointArr', POINTER(airArray)),
+    ('poolPointReuseNum', c_uint),
     ('returnPtr', c_void_p),
     ('stuckNum', c_uint),
+    ('err', c_char_p),
 ]
 pullTask = pullTask_t
 class pullInitParm(Structure):
@@ -6262,8 +6444,19 @@ pullContext_t._fields_ = [
     ('task', POINTER(POINTER(pullTask))),
     ('iterBarrierA', POINTER(airThreadBarrier)),
     ('iterBarrierB', POINTER(airThreadBarrier)),
+    ('finishCrew', c_void_p),
     ('logAdd', POINTER(FILE)),
+    ('runActive', c_int),
+    ('runResume', c_int),
+    ('runConverged', c_int),
+    ('runIterFirst', c_uint),
+    ('runEnergyLast', c_double),
+    ('runEnergyDecreaseAvg', c_double),
     ('timeIteration', c_double),
+    ('timeProcess', c_double),
+    ('timeFinish', c_double),
+    ('timeProcessTotal', c_double),
+    ('timeFinishTotal', c_double),
     ('timeRun', c_double),
     ('energy', c_double),
     ('addNum', c_uint),
@@ -6395,6 +6588,9 @@ pullVolumeSingleAdd.argtypes = [POINTER(pullContext), POINTER(gageKind), STRING,
 pullVolumeStackAdd = libteem.pullVolumeStackAdd
 pullVolumeStackAdd.restype = c_int
 pullVolumeStackAdd.argtypes = [POINTER(pullContext), POINTER(gageKind), STRING, POINTER(Nrrd), POINTER(POINTER(Nrrd)), POINTER(c_double), c_uint, c_int, c_double, POINTER(NrrdKernelSpec), POINTER(NrrdKernelSpec), POINTER(NrrdKernelSpec), POINTER(NrrdKernelSpec)]
+pullVolumeStackLazyAdd = libteem.pullVolumeStackLazyAdd
+pullVolumeStackLazyAdd.restype = c_int
+pullVolumeStackLazyAdd.argtypes = [POINTER(pullContext), POINTER(gageKind), STRING, POINTER(Nrrd), POINTER(gageStackLazy), POINTER(c_double), c_int, c_double, POINTER(NrrdKernelSpec), POINTER(NrrdKernelSpec), POINTER(NrrdKernelSpec), POINTER(NrrdKernelSpec)]
 pullVolumeLookup = libteem.pullVolumeLookup
 pullVolumeLookup.restype = POINTER(pullVolume)
 pullVolumeLookup.argtypes = [POINTER(pullContext), STRING]
@@ -6502,6 +6698,9 @@ pullTraceMultiNix.argtypes = [POINTER(pullTraceMulti)]
 pullTraceMultiAdd = libteem.pullTraceMultiAdd
 pullTraceMultiAdd.restype = c_int
 pullTraceMultiAdd.argtypes = [POINTER(pullTraceMulti), POINTER(pullTrace), POINTER(c_int)]
+pullTraceMultiSet = libteem.pullTraceMultiSet
+pullTraceMultiSet.restype = c_int
+pullTraceMultiSet.argtypes = [POINTER(pullContext), POINTER(pullTraceMulti), c_int, c_int, c_double, c_double, c_double, c_uint, POINTER(c_double), c_uint]
 pullTraceMultiFilterConcaveDown = libteem.pullTraceMultiFilterConcaveDown
 pullTraceMultiFilterConcaveDown.restype = c_int
 pullTraceMultiFilterConcaveDown.argtypes = [POINTER(Nrrd), POINTER(pullTraceMulti), c_double]
@@ -6510,7 +6709,7 @@ pullTraceMultiPlotAdd.restype = c_int
 pullTraceMultiPlotAdd.argtypes = [POINTER(Nrrd), POINTER(pullTraceMulti), POINTER(Nrrd), c_int, c_uint, c_uint]
 pullTraceMultiWrite = libteem.pullTraceMultiWrite
 pullTraceMultiWrite.restype = c_int
-pullTraceMultiWrite.argtypes = [POINTER(FILE), POINTER(pullTraceMulti)]
+pullTraceMultiWrite.argtypes = [POINTER(FILE), POINTER(pullTraceMulti), c_int]
 pullTraceMultiRead = libteem.pullTraceMultiRead
 pullTraceMultiRead.restype = c_int
 pullTraceMultiRead.argtypes = [POINTER(pullTraceMulti), POINTER(FILE)]
@@ -6532,6 +6731,12 @@ pullRun.argtypes = [POINTER(pullContext)]
 pullFinish = libteem.pullFinish
 pullFinish.restype = c_int
 pullFinish.argtypes = [POINTER(pullContext)]
+pullContextSnapshotWrite = libteem.pullContextSnapshotWrite
+pullContextSnapshotWrite.restype = c_int
+pullContextSnapshotWrite.argtypes = [POINTER(FILE), POINTER(pullContext)]
+pullContextSnapshotRead = libteem.pullContextSnapshotRead
+pullContextSnapshotRead.restype = c_int
+pullContextSnapshotRead.argtypes = [POINTER(pullContext), POINTER(FILE)]
 pullCCFind = libteem.pullCCFind
 pullCCFind.restype = c_int
 pullCCFind.argtypes = [POINTER(pullContext)]
@@ -6985,17 +7190,23 @@ tenFiberContext._fields_ = [
     ('stop', c_int),
     ('useIndexSpace', c_int),
     ('verbose', c_int),
+    ('numThreads', c_uint),
+    ('seedSort', c_int),
     ('anisoThresh', c_double),
     ('anisoSpeedFunc', c_double * 3),
     ('maxNumSteps', c_uint),
     ('minNumSteps', c_uint),
     ('stepSize', c_double),
+    ('stepSizeMin', c_double),
+    ('stepSizeMax', c_double),
+    ('errTol', c_double),
     ('maxHalfLen', c_double),
     ('minWholeLen', c_double),
     ('confThresh', c_double),
     ('minRadius', c_double),
     ('minFraction', c_double),
     ('wPunct', c_double),
+    ('resample', c_int),
     ('ten2Which', c_uint),
     ('query', gageQuery),
     ('halfIdx', c_int),
@@ -7006,6 +7217,7 @@ tenFiberContext._fields_ = [
     ('wDir', c_double * 3),
     ('lastDir', c_double * 3),
     ('seedEvec', c_double * 3),
+    ('stepSizeCurr', c_double),
     ('lastDirSet', c_int),
     ('lastTenSet', c_int),
     ('ten2Use', c_uint),
@@ -7051,6 +7263,8 @@ tenFiberMulti._fields_ = [
     ('fiber', POINTER(tenFiberSingle)),
     ('fiberNum', c_uint),
     ('fiberArr', POINTER(airArray)),
+    ('probeNum', c_size_t),
+    ('fillNum', c_size_t),
 ]
 class tenEMBimodalParm(Structure):
     pass
@@ -7278,6 +7492,7 @@ tenDefFiberAnisoStopType = (c_int).in_dll(libteem, 'tenDefFiberAnisoStopType')
 tenDefFiberAnisoThresh = (c_double).in_dll(libteem, 'tenDefFiberAnisoThresh')
 tenDefFiberIntg = (c_int).in_dll(libteem, 'tenDefFiberIntg')
 tenDefFiberWPunct = (c_double).in_dll(libteem, 'tenDefFiberWPunct')
+tenDefFiberErrTol = (c_double).in_dll(libteem, 'tenDefFiberErrTol')
 tenTripleConvertSingle_d = libteem.tenTripleConvertSingle_d
 tenTripleConvertSingle_d.restype = None
 tenTripleConvertSingle_d.argtypes = [POINTER(c_double), c_int, POINTER(c_double), c_int]
@@ -7583,6 +7798,9 @@ tenAnisoPlot.argtypes = [POINTER(Nrrd), c_int, c_uint, c_int, c_int, c_int]
 tenAnisoVolume = libteem.tenAnisoVolume
 tenAnisoVolume.restype = c_int
 tenAnisoVolume.argtypes = [POINTER(Nrrd), POINTER(Nrrd), c_int, c_double]
+tenAnisoVolumeMulti = libteem.tenAnisoVolumeMulti
+tenAnisoVolumeMulti.restype = c_int
+tenAnisoVolumeMulti.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(c_int), c_uint, c_double, c_int, c_uint]
 tenAnisoHistogram = libteem.tenAnisoHistogram
 tenAnisoHistogram.restype = c_int
 tenAnisoHistogram.argtypes = [POINTER(Nrrd), POINTER(Nrrd), POINTER(Nrrd), c_int, c_int, c_uint]
@@ -7754,10 +7972,10 @@ tenModelSimulate.restype = c_int
 tenModelSimulate.argtypes = [POINTER(Nrrd), c_int, POINTER(tenExperSpec), POINTER(tenModel), POINTER(Nrrd), POINTER(Nrrd), c_int]
 tenModelSqeFit = libteem.tenModelSqeFit
 tenModelSqeFit.restype = c_int
-tenModelSqeFit.argtypes = [POINTER(Nrrd), POINTER(POINTER(Nrrd)), POINTER(POINTER(Nrrd)), POINTER(POINTER(Nrrd)), POINTER(tenModel), POINTER(tenExperSpec), POINTER(Nrrd), c_int, c_int, c_int, c_uint, c_uint, c_uint, c_double, POINTER(airRandMTState), c_int]
+tenModelSqeFit.argtypes = [POINTER(Nrrd), POINTER(POINTER(Nrrd)), POINTER(POINTER(Nrrd)), POINTER(POINTER(Nrrd)), POINTER(tenModel), POINTER(tenExperSpec), POINTER(Nrrd), c_int, c_int, c_int, c_uint, c_uint, c_uint, c_uint, c_double, POINTER(airRandMTState), c_uint, c_int]
 tenModelNllFit = libteem.tenModelNllFit
 tenModelNllFit.restype = c_int
-tenModelNllFit.argtypes = [POINTER(Nrrd), POINTER(POINTER(Nrrd)), POINTER(tenModel), POINTER(tenExperSpec), POINTER(Nrrd), c_int, c_double, c_int]
+tenModelNllFit.argtypes = [POINTER(Nrrd), POINTER(POINTER(Nrrd)), POINTER(tenModel), POINTER(tenExperSpec), POINTER(Nrrd), c_int, c_double, c_int, c_int, c_int, c_uint, c_uint, c_double, POINTER(airRandMTState), c_uint, c_int]
 tenModelConvert = libteem.tenModelConvert
 tenModelConvert.restype = c_int
 tenModelConvert.argtypes = [POINTER(Nrrd), POINTER(c_int), POINTER(tenModel), POINTER(Nrrd), POINTER(tenModel)]
@@ -8579,7 +8797,9 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'meetHestPullVol', 'nrrdZlibStrategyDefault',
            'baneClipUnknown', 'pushOutputGet', 'tenEMBimodalParmNix',
            'tenAniso_Cp1', 'nrrdIterNix', 'tenAniso_Cp2',
-           'airMopSingleOkay', 'tijk_refine_rankk_parm_new',
+           'airMopSingleOkay', 'airMopArenaAlloc', 'airArena',
+           'airArenaNew', 'airArenaAlloc', 'airArenaReset', 'airArenaNix',
+           'tijk_refine_rankk_parm_new',
            'nrrdUIInsert', 'gageErrNone', 'tend_shrinkCmd',
            'tend_expCmd', 'ell_3m_svd_d', 'limnQN9octa',
            'unrrdu_axinsertCmd', 'airBesselIn', 'baneHVolParmNew',
@@ -8653,6 +8873,7 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'NrrdResampleInfo', 'gageDefDefaultCenter', 'meetTeemLibs',
            'airTypeUInt', 'coilKindScalar', 'tenInterpTypeLinear',
            'unrrduCmd', 'limnVertex', 'nrrdCheck', 'pullCCFind',
+           'pullContextSnapshotWrite', 'pullContextSnapshotRead',
            'limnObjectVertexNumPreSet', 'gageVecMultiGrad',
            'coilMethodTypeSelf', 'airBesselI0', 'nrrdKindUnknown',
            'ell_cubic_root', 'tenEstimateMethodSet', 'nrrdMeasureSum',
@@ -8774,6 +8995,10 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'pullIterParm', 'tenFiberStopFraction', 'airToLower',
            'nrrd1DIrregAclCheck', 'unrrdu_joinCmd',
            'elfKernelStick_f', 'miteValZw', 'airThreadCond',
+           'airThreadKey', 'airThreadKeyNew', 'airThreadKeyGet',
+           'airThreadKeySet', 'airThreadKeyNix', 'airThreadOnce',
+           'airThreadKeyInheritSet', 'airThreadOnceUnknown',
+           'airThreadOnceBiff', 'airThreadOnceLast',
            'tendTitle', 'pullSysParmWall', 'tenMake',
            'unrrdu_makeCmd', 'miteValZi', 'ell_cubic',
            'tenGageClpmin2', 'nrrdResampleNonExistentWeight',
@@ -8988,6 +9213,7 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'pullCountProbe', 'limnPolyDataNeighborList',
            'limnSplineEvaluate', 'hooverStubRenderBegin',
            'tijk_refine_rank1_3d_d', 'biffSetStrDone',
+           'biffThreadLocalSet',
            'pullInfoStrength', 'gageKernel10', 'gageKernel11',
            'tenFiberTypeTensorLine', 'airFPFprintf_f',
            'airFPFprintf_d', 'limnSpaceUnknown', 'tenAniso_Mode',
@@ -9034,7 +9260,12 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'gageStackBlurParmBoundarySet', 'nrrdTypeLast',
            'pullTraceStopLength', 'baneHack', 'gageQuerySet',
            'tenDwiFiberType12BlendEvec0', 'echoMatterGlassIndex',
-           'gageStackBlurManage', 'tenSimulate', 'pullPropLast',
+           'gageStackBlurManage', 'gageStackBlurCacheGet',
+           'gageStackLazyNew', 'gageStackLazyNix',
+           'gageStackLazyPerVolumeNew', 'gageStackLazy',
+           'gageStackLazy_t', 'gageErrStackLazy',
+           'pullVolumeStackLazyAdd',
+           'tenSimulate', 'pullPropLast',
            'nrrdEnvVarStateDisableContent', 'gageVecDivGradient',
            'nrrdKind3DSymMatrix', 'nrrdBasicInfoSpaceDimension',
            'tijk_eval_esh_basis_d', 'nrrdAxisInfoIdx', 'alanInit',
@@ -9194,6 +9425,7 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'meetPullVolParse', 'nrrdTypeChar', 'nrrdCCRevalue',
            'ell_3v_barycentric_spherical_d', 'echoObject',
            'nrrdFFTWWisdomWrite', 'pullInitHaltonSet',
+           'nrrdThreadJob', 'nrrdThreadRun', 'nrrdThreadNum',
            'pullIterParmSnap', 'nrrdSpace3DLeftHandedTime',
            'ell_biff_key', 'gageSclNormal', 'nrrdDefaultResampleType',
            'nrrdDeringContextNew', 'unrrdu_axdeleteCmd',
@@ -9377,6 +9609,8 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'unrrdu_undosCmd', 'coilKindArray', 'alanParmHomogAniso',
            'limnPolyDataCCFind', 'airTeemReleaseDate',
            'limnObjectFaceNormals', 'gageStackBlurParmVerboseSet',
+           'gageStackBlurParmRecursiveSet', 'gageStackBlurRecursiveSigmaMin',
+           'gageStackBlurParmPyramidSet', 'gageStackBlurPyramidSigmaMin',
            'nrrdKernelTMF_maxC', 'nrrdIoStateDetachedHeader',
            'alanStopDiverged', 'tend_expandCmd', 'tenGlyphParmNix',
            'tenEstimate2MethodQSegLLS', 'unrrduHestMaybeTypeCB',
@@ -9615,6 +9849,8 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'echoMatterMetalKa', 'unrrduScaleMultiply',
            'unrrdu_vidiconCmd', 'gageKindScl',
            'hestCleverPluralizeOtherY', 'nrrdCheapMedian',
+           'nrrdExactMedian', 'nrrdStateNumThreads',
+           'nrrdEnvVarStateNumThreads',
            'nrrdKernelDiscreteGaussian', 'limnSplineInfoUnknown',
            'tenEstimateLinearSingle_d', 'tenEstimateLinearSingle_f',
            'tenModel1Vector2D', 'nrrdSaveMulti', 'baneDefIncLimit',
@@ -9678,7 +9914,8 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'seekTypeValleySurfaceT', 'limnPolyDataWriteIV',
            'nrrdFormatArray', 'nrrdCCMax', 'airBesselI0ExpScaled',
            'tenTripleTypeK', 'tenTripleTypeJ', 'coilTask',
-           'tenTripleTypeR', 'mossDefCenter', 'tenVerbose',
+           'tenTripleTypeR', 'mossDefCenter',
+           'tenVerbose',
            'miteDefOpacNear1', 'nrrdIoStateUnknown',
            'pullSysParmRadiusScale', 'nrrdKernelSpecParse',
            'gageDefCurvNormalSide', 'tijk_approx_heur_parm_nix',
@@ -9873,6 +10110,7 @@ __all__ = ['tenFiberStopUIntSet', 'biffMsgAddf',
            'tenFiberStopUnknown', 'tenDwiGageLast', 'meetPullInfoNew',
            'limnLightSwitch', 'echoObjectNew', 'tijk_init_max_2d_d',
            'pullTraceMultiAdd', 'nrrdMeasureLineIntercept',
+           'pullTraceMultiSet',
            'airNoDioErr', 'nrrdResample_t',
            'gageOptimSigErrorPlotSliding', 'nrrdUnaryOpRoundDown',
            'coilVerbose', 'pullProcessMode', 'airArrayPointerCB',
@@ -9903,6 +10141,8 @@ AIR_STRLEN_MED = (256+1)
 AIR_STRLEN_LARGE = (512+1)
 AIR_STRLEN_HUGE = (1024+1) # has to be big enough to hold
 AIR_RANDMT_N = 624
+AIR_THREAD_ONCE_MAX = 1
+AIR_ARENA_BLOCK_SIZE = 8192 # block size from airArenaNew(0)
 AIR_TYPE_MAX = 12
 AIR_INSANE_MAX = 11
 AIR_PRIME_NUM = 1000
@@ -9934,18 +10174,21 @@ ECHO_IMG_CHANNELS = 5
 ECHO_EPSILON = 0.00005      # used for adjusting ray positions
 ECHO_NEAR0 = 0.004          # used for comparing transparency to zero
 ECHO_LEN_SMALL_ENOUGH = 5   # to control splitting for split objects
+ECHO_BVH_LEAF_SIZE = 4      # BVH nodes this small are always leaves
+ECHO_BVH_BIN_NUM = 16       # # centroid bins for SAH split search
+ECHO_BVH_DEPTH_MAX = 48     # BVH depth limit, bounds traversal stack
 ECHO_THREAD_MAX = 512       # max number of threads
 ECHO_JITTER_NUM = 4
 ECHO_JITTABLE_NUM = 7
 ECHO_MATTER_MAX = 4
 ECHO_MATTER_PARM_NUM = 4
-ECHO_TYPE_NUM = 12
+ECHO_TYPE_NUM = 13
 ELL = ell_biff_key
 ELL_EPS = 1.0e-10
 ELL_CUBIC_ROOT_MAX = 4
 GAGE = gageBiffKey
 GAGE_DERIV_MAX = 2
-GAGE_ERR_MAX = 6
+GAGE_ERR_MAX = 7
 GAGE_CTX_FLAG_MAX = 6
 GAGE_PVL_FLAG_MAX = 3
 GAGE_KERNEL_MAX = 7
@@ -9957,6 +10200,7 @@ GAGE_SIGMA_SAMPLING_MAX = 3
 GAGE_QUERY_BYTES_NUM = 32
 GAGE_ITEM_MAX = ((8*GAGE_QUERY_BYTES_NUM)-1)
 GAGE_PERVOLUME_ARR_INCR = 32
+GAGE_STACK_LAZY_MUTEX_NUM = 16
 GAGE_OPTIMSIG_SIGMA_MAX = 11
 GAGE_OPTIMSIG_SAMPLES_MAXNUM = 11
 HOOVER = hooverBiffKey
@@ -10090,10 +10334,11 @@ TEN_ESTIMATE_1_METHOD_MAX = 4
 TEN_ESTIMATE_2_METHOD_MAX = 2
 TEN_FIBER_TYPE_MAX = 6
 TEN_DWI_FIBER_TYPE_MAX = 3
-TEN_FIBER_INTG_MAX = 3
+TEN_FIBER_INTG_MAX = 4
 TEN_FIBER_STOP_MAX = 10
 TEN_FIBER_NUM_STEPS_MAX = 10240
-TEN_FIBER_PARM_MAX = 4
+TEN_FIBER_PARM_MAX = 10
+TEN_FIBER_THREAD_MAX = 512
 TEN_TRIPLE_TYPE_MAX = 9
 TEN_MODEL_B0_MAX = 65500    # HEY: fairly arbitrary, but is set to be
 TEN_MODEL_DIFF_MAX = 0.006  # in units of mm^2/sec; diffusivity of
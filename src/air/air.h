@@ -306,6 +306,27 @@ AIR_EXPORT int airHeapRemove(airHeap *h, unsigned int ai);
 AIR_EXPORT int airHeapUpdate(airHeap *h, unsigned int ai,
                              double newKey, const void *newData);
 
+/* arena.c: region allocator, for many small allocations that can all be
+   freed at once.  Allocations are 16-byte aligned (as long as malloc()'s
+   are).  There is no way to free an individual allocation, and an arena
+   is not thread-safe: give each thread its own */
+#define AIR_ARENA_BLOCK_SIZE 8192 /* block size from airArenaNew(0) */
+typedef struct {
+  size_t blockSize;   /* size of the blocks that allocations are carved out
+                         of; requests bigger than a quarter of this get a
+                         block of their own */
+  void *block;        /* list of blocks, most recent first */
+  size_t used;        /* # bytes used in most recent block */
+  /* the statistics: allocNum and allocBytes count requests since creation
+     or the last airArenaReset; blockNum and blockBytes count what is
+     currently malloc()ed; blockBytesMax is the high-water mark of that */
+  size_t allocNum, allocBytes, blockNum, blockBytes, blockBytesMax;
+} airArena;
+AIR_EXPORT airArena *airArenaNew(size_t blockSize);
+AIR_EXPORT void *airArenaAlloc(airArena *arena, size_t size);
+AIR_EXPORT void airArenaReset(airArena *arena);
+AIR_EXPORT airArena *airArenaNix(airArena *arena);
+
 /* threadAir.c: simplistic wrapper functions for multi-threading  */
 /*
 ********  airThreadCapable
@@ -329,6 +350,7 @@ AIR_EXPORT int airThreadNoopWarning;
 typedef struct _airThread airThread;
 typedef struct _airThreadMutex airThreadMutex;
 typedef struct _airThreadCond airThreadCond;
+typedef struct _airThreadKey airThreadKey;
 typedef struct {
   unsigned int numUsers, numDone;
   airThreadMutex *doneMutex;
@@ -356,6 +378,32 @@ AIR_EXPORT airThreadBarrier *airThreadBarrierNew(unsigned numUsers);
 AIR_EXPORT int airThreadBarrierWait(airThreadBarrier *barrier);
 AIR_EXPORT airThreadBarrier *airThreadBarrierNix(airThreadBarrier *barrier);
 
+/* each thread has its own value (initially NULL) for an airThreadKey.
+   With airThreadKeyInheritSet(key, AIR_TRUE), a thread started by
+   airThreadStart begins with the value that the starting thread had */
+AIR_EXPORT airThreadKey *airThreadKeyNew(void);
+AIR_EXPORT void *airThreadKeyGet(airThreadKey *key);
+AIR_EXPORT int airThreadKeySet(airThreadKey *key, void *val);
+AIR_EXPORT int airThreadKeyInheritSet(airThreadKey *key, int inherit);
+AIR_EXPORT airThreadKey *airThreadKeyNix(airThreadKey *key);
+
+/*
+******** airThreadOnce* enum
+**
+** the once-only initializations that Teem libraries do with
+** airThreadOnce(which, init), which calls init() only on the first of
+** all the (possibly concurrent) calls with the same "which".  This is
+** done with pthread_once (or InitOnceExecuteOnce), so that the calls
+** after the first don't take any lock.
+*/
+enum {
+  airThreadOnceUnknown,    /* 0: nobody knows */
+  airThreadOnceBiff,       /* 1: biff's thread state */
+  airThreadOnceLast
+};
+#define AIR_THREAD_ONCE_MAX   1
+AIR_EXPORT int airThreadOnce(int which, void (*init)(void));
+
 /* ---- END non-NrrdIO */
 
 /*
@@ -701,6 +749,7 @@ AIR_EXPORT void airMopDebug(airArray *arr);
 AIR_EXPORT void airMopSingleDone(airArray *arr, void *ptr, int error);
 AIR_EXPORT void airMopSingleError(airArray *arr, void *ptr);
 AIR_EXPORT void airMopSingleOkay(airArray *arr, void *ptr);
+AIR_EXPORT void *airMopArenaAlloc(airArray *arr, size_t size);
 /* ---- END non-NrrdIO */
 
 
@@ -0,0 +1,193 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "air.h"
+
+/*
+** an airArena hands out memory by carving it, in order, out of
+** big blocks obtained with malloc().  Allocating is just bumping an
+** offset, and all the blocks are freed at once by airArenaReset or
+** airArenaNix, so this is for code that would otherwise do many small
+** malloc()s and free()s of things that all die together.
+**
+** Each block starts with an _airArenaBlock header, padded so that the
+** memory after it (and every allocation) is _AIR_ARENA_ALIGN-aligned
+** as long as malloc()'s return is.
+*/
+
+#define _AIR_ARENA_ALIGN 16
+#define _AIR_ARENA_PAD(S) (((S) + _AIR_ARENA_ALIGN - 1)      \
+                           & ~AIR_CAST(size_t, _AIR_ARENA_ALIGN - 1))
+
+typedef struct _airArenaBlock {
+  struct _airArenaBlock *next;
+  size_t size;                  /* # bytes usable after header */
+} _airArenaBlock;
+
+#define _AIR_ARENA_HEAD _AIR_ARENA_PAD(sizeof(_airArenaBlock))
+#define _AIR_ARENA_DATA(B) (AIR_CAST(char *, B) + _AIR_ARENA_HEAD)
+
+static _airArenaBlock *
+_airArenaBlockNew(airArena *arena, size_t size) {
+  _airArenaBlock *blk;
+
+  blk = AIR_CAST(_airArenaBlock *, malloc(_AIR_ARENA_HEAD + size));
+  if (blk) {
+    blk->next = NULL;
+    blk->size = size;
+    arena->blockNum++;
+    arena->blockBytes += _AIR_ARENA_HEAD + size;
+    arena->blockBytesMax = AIR_MAX(arena->blockBytesMax, arena->blockBytes);
+  }
+  return blk;
+}
+
+/*
+******** airArenaNew
+**
+** creates an arena that allocates out of blocks of blockSize bytes, or
+** AIR_ARENA_BLOCK_SIZE bytes if blockSize is 0.  No blocks are
+** allocated until the first airArenaAlloc.  Returns NULL if the arena
+** couldn't be allocated.
+*/
+airArena *
+airArenaNew(size_t blockSize) {
+  airArena *arena;
+
+  arena = AIR_CALLOC(1, airArena);
+  if (arena) {
+    arena->blockSize = _AIR_ARENA_PAD(blockSize
+                                      ? blockSize
+                                      : AIR_ARENA_BLOCK_SIZE);
+    arena->block = NULL;
+    arena->used = 0;
+    arena->allocNum = 0;
+    arena->allocBytes = 0;
+    arena->blockNum = 0;
+    arena->blockBytes = 0;
+    arena->blockBytesMax = 0;
+  }
+  return arena;
+}
+
+/*
+******** airArenaAlloc
+**
+** returns a pointer to size bytes of zero-filled memory, which lives
+** until the next airArenaReset or airArenaNix.  The memory must NOT be
+** passed to free() or airFree().  Returns NULL if the arena is NULL or
+** if malloc() failed.
+*/
+void *
+airArenaAlloc(airArena *arena, size_t size) {
+  _airArenaBlock *blk;
+  size_t pad;
+  char *ret;
+
+  if (!arena
+      || size > AIR_CAST(size_t, -1) - _AIR_ARENA_HEAD - _AIR_ARENA_ALIGN) {
+    return NULL;
+  }
+  /* even a zero-size request gets its own (distinct) address */
+  pad = _AIR_ARENA_PAD(size ? size : 1);
+  blk = AIR_CAST(_airArenaBlock *, arena->block);
+  if (pad > arena->blockSize/4) {
+    /* big request gets a block of its own; this goes in the list after
+       the current block, so that the current block can keep filling */
+    _airArenaBlock *big;
+    if (!(big = _airArenaBlockNew(arena, pad))) {
+      return NULL;
+    }
+    if (blk) {
+      big->next = blk->next;
+      blk->next = big;
+    } else {
+      arena->block = big;
+      arena->used = pad;
+    }
+    ret = _AIR_ARENA_DATA(big);
+  } else {
+    if (!blk || arena->used + pad > blk->size) {
+      if (!(blk = _airArenaBlockNew(arena, arena->blockSize))) {
+        return NULL;
+      }
+      blk->next = AIR_CAST(_airArenaBlock *, arena->block);
+      arena->block = blk;
+      arena->used = 0;
+    }
+    ret = _AIR_ARENA_DATA(blk) + arena->used;
+    arena->used += pad;
+  }
+  memset(ret, 0, size);
+  arena->allocNum++;
+  arena->allocBytes += size;
+  return ret;
+}
+
+/*
+******** airArenaReset
+**
+** invalidates everything allocated from the arena, and frees all of its
+** blocks except one normal-sized block, so that an arena being re-used
+** (e.g. once per iteration of some loop) doesn't go back to malloc()
+** for its first block.  Resets allocNum and allocBytes.
+*/
+void
+airArenaReset(airArena *arena) {
+  _airArenaBlock *blk, *next, *keep;
+
+  if (!arena) {
+    return;
+  }
+  keep = NULL;
+  for (blk = AIR_CAST(_airArenaBlock *, arena->block); blk; blk = next) {
+    next = blk->next;
+    if (!keep && arena->blockSize == blk->size) {
+      keep = blk;
+      keep->next = NULL;
+    } else {
+      arena->blockNum--;
+      arena->blockBytes -= _AIR_ARENA_HEAD + blk->size;
+      free(blk);
+    }
+  }
+  arena->block = keep;
+  arena->used = 0;
+  arena->allocNum = 0;
+  arena->allocBytes = 0;
+  return;
+}
+
+airArena *
+airArenaNix(airArena *arena) {
+  _airArenaBlock *blk, *next;
+
+  if (arena) {
+    for (blk = AIR_CAST(_airArenaBlock *, arena->block); blk; blk = next) {
+      next = blk->next;
+      free(blk);
+    }
+    free(arena);
+  }
+  return NULL;
+}
@@ -341,4 +341,55 @@ airMopSingleOkay(airArray *arr, void *ptr) {
   airMopSingleDone(arr, ptr, AIR_FALSE);
 }
 
+/*
+** the mopper for the arena created by airMopArenaAlloc; this is distinct
+** from airArenaNix so that airMopArenaAlloc never mistakes some arena
+** that the caller registered with the mop for its own
+*/
+static void *
+_airMopArenaNix(void *arena) {
+
+  return airArenaNix(AIR_CAST(airArena *, arena));
+}
+
+/*
+******** airMopArenaAlloc
+**
+** returns size bytes of zero-filled memory, from an airArena that
+** belongs to the mop: the arena is created (and added to the mop with
+** airMopAlways) on the first call, and all its memory is freed at once
+** by airMopDone.  This replaces the calloc() + airMopAdd(airFree) of
+** temporary buffers, with fewer trips to malloc().  The memory must not
+** be freed any other way, and it can't be airMopSub()ed.  Returns NULL
+** if the mop is NULL or allocation failed.
+*/
+void *
+airMopArenaAlloc(airArray *arr, size_t size) {
+  airArena *arena;
+  airMop *mops;
+  unsigned int ii;
+
+  if (!arr) {
+    return NULL;
+  }
+  arena = NULL;
+  mops = (airMop *)arr->data;
+  for (ii=0; ii<arr->len; ii++) {
+    if (_airMopArenaNix == mops[ii].mop) {
+      arena = AIR_CAST(airArena *, mops[ii].ptr);
+      break;
+    }
+  }
+  if (!arena) {
+    if (!(arena = airArenaNew(0))) {
+      return NULL;
+    }
+    if (airMopAdd(arr, arena, _airMopArenaNix, airMopAlways)) {
+      airArenaNix(arena);
+      return NULL;
+    }
+  }
+  return airArenaAlloc(arena, size);
+}
+
 /* ---- END non-NrrdIO */
@@ -3,6 +3,7 @@
 set(AIR_SOURCES
   754.c
   air.h
+  arena.c
   array.c
   dio.c
   endianAir.c
@@ -27,6 +27,19 @@
 
 int airThreadNoopWarning = AIR_TRUE;
 
+/*
+** the keys for which airThreadStart passes the starting thread's value
+** on to the new thread (see airThreadKeyInheritSet); the list itself is
+** maintained (with locking by _airThreadInheritLock) below all the
+** OS-specific code
+*/
+#define _AIR_THREAD_INHERIT_MAX 8
+static void _airThreadInheritLock(int lock);
+#if TEEM_PTHREAD || defined(_WIN32)
+static unsigned int _airThreadInheritGet(airThreadKey **key, void **val);
+#endif
+static void _airThreadInheritDrop(airThreadKey *key);
+
 /* ------------------------------------------------------------------ */
 #if TEEM_PTHREAD /* ----------------------------------------- PTHREAD */
 /* ------------------------------------------------------------------ */
@@ -37,6 +50,11 @@ const int airThreadCapable = AIR_TRUE;
 
 struct _airThread {
   pthread_t id;
+  void *(*body)(void *);
+  void *arg;
+  unsigned int inheritNum;
+  airThreadKey *inheritKey[_AIR_THREAD_INHERIT_MAX];
+  void *inheritVal[_AIR_THREAD_INHERIT_MAX];
 };
 
 struct _airThreadMutex {
@@ -47,6 +65,28 @@ struct _airThreadCond {
   pthread_cond_t id;
 };
 
+struct _airThreadKey {
+  pthread_key_t id;
+};
+
+static pthread_mutex_t
+_airThreadInheritMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t
+_airThreadOnceCtl[AIR_THREAD_ONCE_MAX+1] = {PTHREAD_ONCE_INIT,
+                                            PTHREAD_ONCE_INIT};
+
+static void
+_airThreadInheritLock(int lock) {
+
+  if (lock) {
+    pthread_mutex_lock(&_airThreadInheritMutex);
+  } else {
+    pthread_mutex_unlock(&_airThreadInheritMutex);
+  }
+  return;
+}
+
 airThread *
 airThreadNew(void) {
   airThread *thread;
@@ -56,15 +96,32 @@ airThreadNew(void) {
   return thread;
 }
 
+static void *
+_airThreadBody(void *_thread) {
+  airThread *thread;
+  unsigned int ii;
+
+  thread = (airThread *)_thread;
+  for (ii=0; ii<thread->inheritNum; ii++) {
+    pthread_setspecific(thread->inheritKey[ii]->id, thread->inheritVal[ii]);
+  }
+  return thread->body(thread->arg);
+}
+
 int
 airThreadStart(airThread *thread, void *(*threadBody)(void *), void *arg) {
   pthread_attr_t attr;
 
+  thread->body = threadBody;
+  thread->arg = arg;
+  thread->inheritNum = _airThreadInheritGet(thread->inheritKey,
+                                            thread->inheritVal);
   pthread_attr_init(&attr);
 #ifdef __sgi
   pthread_attr_setscope(&attr, PTHREAD_SCOPE_BOUND_NP);
 #endif
-  return pthread_create(&(thread->id), &attr, threadBody, arg);
+  return pthread_create(&(thread->id), &attr, _airThreadBody,
+                        AIR_CAST(void *, thread));
 }
 
 int
@@ -161,13 +218,61 @@ airThreadCondNix(airThreadCond *cond) {
   return cond;
 }
 
+airThreadKey *
+airThreadKeyNew(void) {
+  airThreadKey *key;
+
+  key = AIR_CALLOC(1, airThreadKey);
+  if (key) {
+    if (pthread_key_create(&(key->id), NULL)) {
+      /* there was an error */
+      key = (airThreadKey *)airFree(key);
+    }
+  }
+  return key;
+}
+
+void *
+airThreadKeyGet(airThreadKey *key) {
+
+  return pthread_getspecific(key->id);
+}
+
+int
+airThreadKeySet(airThreadKey *key, void *val) {
+
+  return pthread_setspecific(key->id, val);
+}
+
+airThreadKey *
+airThreadKeyNix(airThreadKey *key) {
+
+  if (key) {
+    _airThreadInheritDrop(key);
+    if (!pthread_key_delete(key->id)) {
+      /* there was no error */
+      key = (airThreadKey *)airFree(key);
+    }
+  }
+  return key;
+}
+
+int
+airThreadOnce(int which, void (*init)(void)) {
+
+  if (!( 0 < which && which <= AIR_THREAD_ONCE_MAX && init )) {
+    return 1;
+  }
+  return pthread_once(_airThreadOnceCtl + which, init);
+}
+
 /* ------------------------------------------------------------------ */
 #elif defined(_WIN32) /* ------------------------------------- WIN 32 */
 /* ------------------------------------------------------------------ */
 
 #if defined(_WIN32)
-   /* SignalObjectAndWait supported by NT4.0 and greater only */
-#  define _WIN32_WINNT 0x400
+   /* InitOnceExecuteOnce and SRW locks need Vista or greater */
+#  define _WIN32_WINNT 0x600
 #  include <windows.h>
 #endif
 
@@ -178,6 +283,9 @@ struct _airThread {
   void *(*body)(void *);
   void *arg;
   void *ret;
+  unsigned int inheritNum;
+  airThreadKey *inheritKey[_AIR_THREAD_INHERIT_MAX];
+  void *inheritVal[_AIR_THREAD_INHERIT_MAX];
 };
 
 struct _airThreadMutex {
@@ -192,6 +300,28 @@ struct _airThreadCond {
   size_t broadcast;
 };
 
+struct _airThreadKey {
+  DWORD index;
+};
+
+static SRWLOCK
+_airThreadInheritSRW = SRWLOCK_INIT;
+
+static INIT_ONCE
+_airThreadOnceCtl[AIR_THREAD_ONCE_MAX+1] = {INIT_ONCE_STATIC_INIT,
+                                            INIT_ONCE_STATIC_INIT};
+
+static void
+_airThreadInheritLock(int lock) {
+
+  if (lock) {
+    AcquireSRWLockExclusive(&_airThreadInheritSRW);
+  } else {
+    ReleaseSRWLockExclusive(&_airThreadInheritSRW);
+  }
+  return;
+}
+
 airThread *
 airThreadNew(void) {
   airThread *thread;
@@ -211,8 +341,12 @@ int
 #endif /* defined(__BORLANDC__) */
 WINAPI _airThreadWin32Body(void *_thread) {
   airThread *thread;
+  unsigned int ii;
 
   thread = (airThread *)_thread;
+  for (ii=0; ii<thread->inheritNum; ii++) {
+    TlsSetValue(thread->inheritKey[ii]->index, thread->inheritVal[ii]);
+  }
   thread->ret = thread->body(thread->arg);
   return 0;
 }
@@ -222,6 +356,8 @@ airThreadStart(airThread *thread, void *(*threadBody)(void *), void *arg) {
 
   thread->body = threadBody;
   thread->arg = arg;
+  thread->inheritNum = _airThreadInheritGet(thread->inheritKey,
+                                            thread->inheritVal);
   thread->handle = CreateThread(0, 0, _airThreadWin32Body,
                                 (void *)thread, 0, 0);
   return NULL == thread->handle;
@@ -409,6 +545,72 @@ airThreadCondNix(airThreadCond *cond) {
   return ret;
 }
 
+airThreadKey *
+airThreadKeyNew(void) {
+  airThreadKey *key;
+
+  key = AIR_CALLOC(1, airThreadKey);
+  if (key) {
+    key->index = TlsAlloc();
+    if (TLS_OUT_OF_INDEXES == key->index) {
+      return airFree(key);
+    }
+  }
+  return key;
+}
+
+void *
+airThreadKeyGet(airThreadKey *key) {
+
+  return TlsGetValue(key->index);
+}
+
+int
+airThreadKeySet(airThreadKey *key, void *val) {
+
+  return 0 == TlsSetValue(key->index, val);
+}
+
+airThreadKey *
+airThreadKeyNix(airThreadKey *key) {
+
+  if (key) {
+    _airThreadInheritDrop(key);
+    TlsFree(key->index);
+    key = airFree(key);
+  }
+  return key;
+}
+
+/* ISO C forbids conversion of function pointer to object pointer type */
+typedef union {
+  void (*f)(void);
+  void *v;
+} _airThreadOnceUnion;
+
+static BOOL CALLBACK
+_airThreadOnceWin32(PINIT_ONCE once, PVOID param, PVOID *ctx) {
+  _airThreadOnceUnion ou;
+
+  AIR_UNUSED(once);
+  AIR_UNUSED(ctx);
+  ou.v = param;
+  ou.f();
+  return TRUE;
+}
+
+int
+airThreadOnce(int which, void (*init)(void)) {
+  _airThreadOnceUnion ou;
+
+  if (!( 0 < which && which <= AIR_THREAD_ONCE_MAX && init )) {
+    return 1;
+  }
+  ou.f = init;
+  return !InitOnceExecuteOnce(_airThreadOnceCtl + which,
+                              _airThreadOnceWin32, ou.v, NULL);
+}
+
 /* ------------------------------------------------------------------ */
 #else /* --------------------------------------- (no multi-threading) */
 /* ------------------------------------------------------------------ */
@@ -427,6 +629,10 @@ struct _airThreadCond {
   int dummy;
 };
 
+struct _airThreadKey {
+  void *val;
+};
+
 airThread *
 airThreadNew(void) {
   airThread *thread;
@@ -545,10 +751,138 @@ airThreadCondNix(airThreadCond *cond) {
   return NULL;
 }
 
+airThreadKey *
+airThreadKeyNew(void) {
+  airThreadKey *key;
+
+  key = AIR_CALLOC(1, airThreadKey);
+  return key;
+}
+
+void *
+airThreadKeyGet(airThreadKey *key) {
+
+  return key->val;
+}
+
+int
+airThreadKeySet(airThreadKey *key, void *val) {
+
+  key->val = val;
+  return 0;
+}
+
+airThreadKey *
+airThreadKeyNix(airThreadKey *key) {
+
+  _airThreadInheritDrop(key);
+  airFree(key);
+  return NULL;
+}
+
+static int
+_airThreadOnceDone[AIR_THREAD_ONCE_MAX+1] = {AIR_FALSE, AIR_FALSE};
+
+static void
+_airThreadInheritLock(int lock) {
+
+  AIR_UNUSED(lock);
+  return;
+}
+
+int
+airThreadOnce(int which, void (*init)(void)) {
+
+  if (!( 0 < which && which <= AIR_THREAD_ONCE_MAX && init )) {
+    return 1;
+  }
+  if (!_airThreadOnceDone[which]) {
+    init();
+    _airThreadOnceDone[which] = AIR_TRUE;
+  }
+  return 0;
+}
+
 /* ------------------------------------------------------------------ */
 #endif /* ----------------------------------------------------------- */
 /* ------------------------------------------------------------------ */
 
+static airThreadKey *
+_airThreadInheritKey[_AIR_THREAD_INHERIT_MAX];
+static unsigned int
+_airThreadInheritNum = 0;
+
+#if TEEM_PTHREAD || defined(_WIN32)
+/*
+** _airThreadInheritGet
+**
+** for airThreadStart: sets key[] to the inherited keys, and val[] to
+** the calling thread's values for them, and returns how many there are
+*/
+static unsigned int
+_airThreadInheritGet(airThreadKey **key, void **val) {
+  unsigned int ii, num;
+
+  _airThreadInheritLock(AIR_TRUE);
+  num = _airThreadInheritNum;
+  for (ii=0; ii<num; ii++) {
+    key[ii] = _airThreadInheritKey[ii];
+    val[ii] = airThreadKeyGet(key[ii]);
+  }
+  _airThreadInheritLock(AIR_FALSE);
+  return num;
+}
+#endif
+
+static void
+_airThreadInheritDrop(airThreadKey *key) {
+  unsigned int ii;
+
+  _airThreadInheritLock(AIR_TRUE);
+  for (ii=0; ii<_airThreadInheritNum; ii++) {
+    if (key == _airThreadInheritKey[ii]) {
+      _airThreadInheritNum--;
+      _airThreadInheritKey[ii] = _airThreadInheritKey[_airThreadInheritNum];
+      break;
+    }
+  }
+  _airThreadInheritLock(AIR_FALSE);
+  return;
+}
+
+/*
+******** airThreadKeyInheritSet
+**
+** with non-zero "inherit", threads started (by airThreadStart) after
+** this call begin with the same value for the key as the thread that
+** started them, rather than with NULL.  Any number of threads can thus
+** end up with the same value; making that safe is up to the user of
+** the key.  Returns non-zero if there are already too many inherited
+** keys.
+*/
+int
+airThreadKeyInheritSet(airThreadKey *key, int inherit) {
+  unsigned int ii;
+  int ret;
+
+  if (!key) {
+    return 1;
+  }
+  _airThreadInheritDrop(key);
+  ret = 0;
+  if (inherit) {
+    _airThreadInheritLock(AIR_TRUE);
+    if (_airThreadInheritNum < _AIR_THREAD_INHERIT_MAX) {
+      ii = _airThreadInheritNum++;
+      _airThreadInheritKey[ii] = key;
+    } else {
+      ret = 1;
+    }
+    _airThreadInheritLock(AIR_FALSE);
+  }
+  return ret;
+}
+
 airThreadBarrier *
 airThreadBarrierNew(unsigned int numUsers) {
   airThreadBarrier *barrier;
@@ -79,6 +79,8 @@ enum {
   alanParmBeta,
   alanParmConstantFilename,
   alanParmWrapAround,
+  alanParmIterBlock,
+  alanParmSlabSize,
   alanParmLast
 };
 
@@ -121,7 +123,14 @@ typedef struct alanContext_t {
     frameInterval,    /* # of iterations between which to an image */
     saveInterval,     /* # of iterations between which to save all state */
     maxIteration,     /* cap on # of iterations, or 0 if there is no limit */
-    constFilename;    /* always use the same filename when saving frames */
+    constFilename,    /* always use the same filename when saving frames */
+    iterBlock,        /* # of iterations to do on each slab of the texture
+                         while it is in cache, before moving on to the next
+                         slab.  With iterBlock > 1, convergence and
+                         divergence are only checked, and perIteration
+                         only called, at the end of each such block */
+    slabSize;         /* # of rows (2D) or slices (3D) in each slab, or 0
+                         to pick something based on texture size */
   alan_t K, F,        /* simulation variables */
     deltaX,           /* size of spatial grid discretization */
     minAverageChange, /* min worthwhile "avergageChange" value (see below),
@@ -152,6 +161,9 @@ typedef struct alanContext_t {
   airThreadMutex *changeMutex;
                       /* to synchronize separate iterations of simulation */
   airThreadBarrier *iterBarrier;
+  int slabLen,        /* # rows or slices per slab actually used */
+    nextSlab,         /* next slab to be processed in this block */
+    blockStop;        /* any problem found by any thread in this block */
 
   /* OUTPUT ---------------------------- */
   int stop;          /* why we stopped */
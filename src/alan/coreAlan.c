@@ -195,12 +195,12 @@ _alanPerIteration(alanContext *actx, int iter) {
   }
   if (actx->saveInterval && !(iter % actx->saveInterval)) {
     sprintf(fname, "%06d.nrrd", actx->constFilename ? 0 : iter);
-    nrrdSave(fname, actx->_nlev[(iter+1) % 2], NULL);
+    nrrdSave(fname, actx->nlev, NULL);
     fprintf(stderr, "%s: iter = %d, averageChange = %g, saved %s\n",
             me, iter, actx->averageChange, fname);
   }
   if (actx->frameInterval && !(iter % actx->frameInterval)) {
-    nrrdSlice(nslc=nrrdNew(), actx->_nlev[(iter+1) % 2], 0, 0);
+    nrrdSlice(nslc=nrrdNew(), actx->nlev, 0, 0);
     nrrdQuantize(nimg=nrrdNew(), nslc, NULL, 8);
     sprintf(fname, (2 == actx->dim ? "%06d.png" : "%06d.nrrd"),
             actx->constFilename ? 0 : iter);
@@ -225,19 +225,335 @@ typedef struct {
      return, and currently that will just end up pointing back to this
      struct */
   void *me;
+  /* two time levels of the morphogens in the current slab, with
+     iterBlock ghost rows or slices on either side; each row has one
+     value of padding on both ends (see _alanRowLoad) */
+  alan_t *slabA[2], *slabB[2],
+    /* per-row scratch: laplacians (plus correction terms), react*conf
+       (see _alanTuringRow), and the deltas */
+    *rowLapA, *rowLapB, *rowRC, *rowDA, *rowDB;
 } alanTask;
 
+/*
+** The texture is processed in slabs along its slowest axis (Y in 2D,
+** Z in 3D); a "plane" is then one row in 2D, or one slice of sy rows in
+** 3D.  Within a slab, the morphogens are de-interleaved into separate
+** rows of A and B, each padded (according to actx->wrap) by one value
+** on either end, so that the inner loops over X have no boundary logic,
+** no function calls, and no branches, so that the compiler can
+** vectorize them.
+*/
+
+void
+_alanRowLoad(alan_t *rowA, alan_t *rowB, const alan_t *lev,
+             int sx, int wrap) {
+  int x;
+
+  for (x=0; x<sx; x++) {
+    rowA[x] = lev[0 + 2*x];
+    rowB[x] = lev[1 + 2*x];
+  }
+  rowA[-1] = rowA[wrap ? sx-1 : 0];
+  rowB[-1] = rowB[wrap ? sx-1 : 0];
+  rowA[sx] = rowA[wrap ? 0 : sx-1];
+  rowB[sx] = rowB[wrap ? 0 : sx-1];
+  return;
+}
+
+/*
+** _alanTuringRow
+**
+** one row of one iteration of the Turing simulation: from the padded
+** rows rA[], rB[] (in 2D: [1],[2],[3] are Y-1, Y, Y+1; in 3D: [0],[4]
+** are Z-1, Z+1 and [1],[2],[3] are Y-1, Y, Y+1), set outA, outB.  yy
+** and zz are the (wrapped) texel coordinates of the row, and my, py
+** the Y coordinates of its neighbors. The arithmetic per texel is as
+** it has always been.  Adds the sum of |deltaA| to *changeP, and sets
+** *stopP if there was a problem.
+*/
+void
+_alanTuringRow(alanTask *task, alan_t *outA, alan_t *outB,
+               alan_t **rA, alan_t **rB, int yy, int zz, int my, int py,
+               alan_t *changeP, int *stopP) {
+  alanContext *actx;
+  alan_t *tendata, *ten, *tpx, *tmx, *tpy, *tmy, *parm,
+    *lapA, *lapB, *rc, *dA, *dB,
+    conf, Dxx, Dxy, Dyy, A, B, K, react, diffA, diffB,
+    corrA, corrB, change, maxA, chk;
+  int dim, sx, sy, x, px, mx;
+
+  actx = task->actx;
+  dim = actx->dim;
+  sx = actx->size[0];
+  sy = actx->size[1];
+  tendata = actx->nten ? (alan_t *)actx->nten->data : NULL;
+  parm = (alan_t*)(actx->nparm->data) + 3*sx*(yy + sy*zz);
+  K = actx->K;
+  react = actx->react;
+  diffA = AIR_CAST(alan_t, actx->diffA/pow(actx->deltaX, dim));
+  diffB = AIR_CAST(alan_t, actx->diffB/pow(actx->deltaX, dim));
+  lapA = task->rowLapA;
+  lapB = task->rowLapB;
+  rc = task->rowRC;
+  dA = task->rowDA;
+  dB = task->rowDB;
+
+  /* first: diffusion */
+  if (2 == dim) {
+    if (tendata) {
+      /*
+      **  0 1 2    Dxy/2          Dyy        -Dxy/2
+      **  3 4 5     Dxx     -2*(Dxx + Dyy)     Dxx
+      **  6 7 8   -Dxy/2          Dyy         Dxy/2
+      **
+      **  0 = rA[1][x-1]   1 = rA[1][x]   2 = rA[1][x+1]
+      **  3 = rA[2][x-1]   4 = rA[2][x]   5 = rA[2][x+1]
+      **  6 = rA[3][x-1]   7 = rA[3][x]   8 = rA[3][x+1]
+      */
+      for (x=0; x<sx; x++) {
+        A = rA[2][x];
+        B = rB[2][x];
+        ten = tendata + 4*(x + sx*yy);
+        conf = AIR_CAST(alan_t, (AIR_CLAMP(0.3, ten[0], 1) - 0.3)/0.7);
+        corrA = corrB = 0;
+        if (conf) {
+          Dxx = ten[1];
+          Dxy = ten[2];
+          Dyy = ten[3];
+          lapA[x] = (Dxy*(rA[1][x-1] + rA[3][x+1]
+                          - rA[1][x+1] - rA[3][x-1])/2
+                     + Dxx*(rA[2][x-1] + rA[2][x+1])
+                     + Dyy*(rA[1][x] + rA[3][x])
+                     - 2*(Dxx + Dyy)*A);
+          lapB[x] = (Dxy*(rB[1][x-1] + rB[3][x+1]
+                          - rB[1][x+1] - rB[3][x-1])/2
+                     + Dxx*(rB[2][x-1] + rB[2][x+1])
+                     + Dyy*(rB[1][x] + rB[3][x])
+                     - 2*(Dxx + Dyy)*B);
+          if (!(actx->homogAniso)) {
+            if (actx->wrap) {
+              px = AIR_MOD(x+1, sx);
+              mx = AIR_MOD(x-1, sx);
+            } else {
+              px = AIR_MIN(x+1, sx-1);
+              mx = AIR_MAX(x-1, 0);
+            }
+            tpx = tendata + 4*(px + sx*yy);
+            tmx = tendata + 4*(mx + sx*yy);
+            tpy = tendata + 4*( x + sx*py);
+            tmy = tendata + 4*( x + sx*my);
+            corrA = ((tpx[1]-tmx[1])*(rA[2][x+1]-rA[2][x-1])/4+
+                     (tpx[2]-tmx[2])*(rA[3][x]-rA[1][x])/4+
+                     (tpy[2]-tmy[2])*(rA[2][x+1]-rA[2][x-1])/4+
+                     (tpy[3]-tmy[3])*(rA[3][x]-rA[1][x]));
+            corrB = ((tpx[1]-tmx[1])*(rB[2][x+1]-rB[2][x-1])/4+
+                     (tpx[2]-tmx[2])*(rB[3][x]-rB[1][x])/4+
+                     (tpy[2]-tmy[2])*(rB[2][x+1]-rB[2][x-1])/4+
+                     (tpy[3]-tmy[3])*(rB[3][x]-rB[1][x]));
+          }
+        } else {
+          /* no confidence; you diffuse */
+          lapA[x] = rA[1][x] + rA[2][x-1] + rA[2][x+1] + rA[3][x] - 4*A;
+          lapB[x] = rB[1][x] + rB[2][x-1] + rB[2][x+1] + rB[3][x] - 4*B;
+        }
+        lapA[x] += corrA;
+        lapB[x] += corrB;
+        rc[x] = react*conf;
+      }
+    } else {
+      /* no data; you diffuse */
+      for (x=0; x<sx; x++) {
+        lapA[x] = (rA[1][x] + rA[2][x-1] + rA[2][x+1] + rA[3][x]
+                   - 4*rA[2][x]);
+        lapB[x] = (rB[1][x] + rB[2][x-1] + rB[2][x+1] + rB[3][x]
+                   - 4*rB[2][x]);
+      }
+    }
+  } else {
+    /* 3 == dim */
+    if (tendata) {
+      /* (anisotropic diffusion in 3D not yet implemented) */
+      for (x=0; x<sx; x++) {
+        lapA[x] = lapB[x] = 0;
+      }
+    } else {
+      for (x=0; x<sx; x++) {
+        lapA[x] = (rA[0][x] + rA[1][x] + rA[2][x-1]
+                   + rA[2][x+1] + rA[3][x] + rA[4][x] - 6*rA[2][x]);
+        lapB[x] = (rB[0][x] + rB[1][x] + rB[2][x-1]
+                   + rB[2][x+1] + rB[3][x] + rB[4][x] - 6*rB[2][x]);
+      }
+    }
+  }
+
+  /* second: reaction, and update */
+  for (x=0; x<sx; x++) {
+    A = rA[2][x];
+    B = rB[2][x];
+    dA[x] = parm[0 + 3*x]*(rc[x]*K*(parm[1 + 3*x] - A*B)
+                           + diffA*lapA[x]);
+    dB[x] = parm[0 + 3*x]*(rc[x]*K*(A*B - B - parm[2 + 3*x])
+                           + diffB*lapB[x]);
+    outA[x] = A + dA[x];
+    outB[x] = AIR_MAX(0, B + dB[x]);
+  }
+  outA[-1] = outA[actx->wrap ? sx-1 : 0];
+  outB[-1] = outB[actx->wrap ? sx-1 : 0];
+  outA[sx] = outA[actx->wrap ? 0 : sx-1];
+  outB[sx] = outB[actx->wrap ? 0 : sx-1];
+
+  /* third: bookkeeping, kept out of the loops above */
+  change = maxA = chk = 0;
+  for (x=0; x<sx; x++) {
+    change += AIR_ABS(dA[x]);
+    maxA = AIR_MAX(maxA, AIR_ABS(dA[x]));
+    chk += (dA[x] - dA[x]) + (dB[x] - dB[x]);
+  }
+  if (maxA > actx->maxPixelChange) {
+    *stopP = alanStopDiverged;
+  }
+  if (!AIR_EXISTS(chk)) {
+    *stopP = alanStopNonExist;
+  }
+  *changeP += change;
+  return;
+}
+
+/*
+** _alanTuringSlab
+**
+** does iterNum iterations, from lev0 to lev1, of the part of the
+** texture in slab slabIdx: loads the slab plus iterNum ghost planes on
+** either side, and then each iteration computes one fewer ghost plane
+** on either side, so that the last one computes exactly the slab.
+** Without wrapping, the ghost planes stop at the texture boundary
+** (where neighbors are clamped, as always).  Adds to *changeP the
+** change in the last iteration.
+*/
+void
+_alanTuringSlab(alanTask *task, const alan_t *lev0, alan_t *lev1,
+                int slabIdx, int iterNum, alan_t *changeP, int *stopP) {
+  alanContext *actx;
+  alan_t *rA[5], *rB[5], *outA, *outB, change;
+  int sx, sy, so, pr, stride, wrap, z0, z1, lo0, lo, hi, it, cur, pi,
+    gg, gm, gp, ri, rm, rp, yy, zz, my, py, x;
+
+  actx = task->actx;
+  sx = actx->size[0];
+  sy = actx->size[1];
+  so = (2 == actx->dim ? sy : AIR_CAST(int, actx->size[2]));
+  pr = (2 == actx->dim ? 1 : sy);
+  stride = sx + 2;
+  wrap = actx->wrap;
+  z0 = slabIdx*actx->slabLen;
+  z1 = AIR_MIN(z0 + actx->slabLen, so);
+  lo0 = wrap ? z0 - iterNum : AIR_MAX(z0 - iterNum, 0);
+  hi = wrap ? z1 + iterNum : AIR_MIN(z1 + iterNum, so);
+#define ROW(buff, pi, ri) ((buff) + 1 + stride*((ri) + pr*((pi) - lo0)))
+  for (pi=lo0; pi<hi; pi++) {
+    gg = AIR_MOD(pi, so);
+    for (ri=0; ri<pr; ri++) {
+      _alanRowLoad(ROW(task->slabA[0], pi, ri), ROW(task->slabB[0], pi, ri),
+                   lev0 + 2*sx*(ri + pr*gg), sx, wrap);
+    }
+  }
+  cur = 0;
+  for (it=1; it<=iterNum; it++) {
+    lo = wrap ? z0 - (iterNum - it) : AIR_MAX(z0 - (iterNum - it), 0);
+    hi = wrap ? z1 + (iterNum - it) : AIR_MIN(z1 + (iterNum - it), so);
+    change = 0;
+    for (pi=lo; pi<hi; pi++) {
+      gg = AIR_MOD(pi, so);
+      /* neighboring planes within the slab */
+      gm = wrap ? pi - 1 : AIR_MAX(pi - 1, 0);
+      gp = wrap ? pi + 1 : AIR_MIN(pi + 1, so - 1);
+      for (ri=0; ri<pr; ri++) {
+        if (2 == actx->dim) {
+          rA[1] = ROW(task->slabA[cur], gm, ri);
+          rA[3] = ROW(task->slabA[cur], gp, ri);
+          rB[1] = ROW(task->slabB[cur], gm, ri);
+          rB[3] = ROW(task->slabB[cur], gp, ri);
+          yy = gg;
+          zz = 0;
+          my = AIR_MOD(gm, so);
+          py = AIR_MOD(gp, so);
+        } else {
+          if (wrap) {
+            rp = AIR_MOD(ri+1, pr);
+            rm = AIR_MOD(ri-1, pr);
+          } else {
+            rp = AIR_MIN(ri+1, pr-1);
+            rm = AIR_MAX(ri-1, 0);
+          }
+          rA[0] = ROW(task->slabA[cur], gm, ri);
+          rA[1] = ROW(task->slabA[cur], pi, rm);
+          rA[3] = ROW(task->slabA[cur], pi, rp);
+          rA[4] = ROW(task->slabA[cur], gp, ri);
+          rB[0] = ROW(task->slabB[cur], gm, ri);
+          rB[1] = ROW(task->slabB[cur], pi, rm);
+          rB[3] = ROW(task->slabB[cur], pi, rp);
+          rB[4] = ROW(task->slabB[cur], gp, ri);
+          yy = ri;
+          zz = gg;
+          my = rm;
+          py = rp;
+        }
+        rA[2] = ROW(task->slabA[cur], pi, ri);
+        rB[2] = ROW(task->slabB[cur], pi, ri);
+        _alanTuringRow(task, ROW(task->slabA[1-cur], pi, ri),
+                       ROW(task->slabB[1-cur], pi, ri),
+                       rA, rB, yy, zz, my, py, &change, stopP);
+      }
+    }
+    cur = 1 - cur;
+  }
+  *changeP += change;
+  for (pi=z0; pi<z1; pi++) {
+    for (ri=0; ri<pr; ri++) {
+      outA = ROW(task->slabA[cur], pi, ri);
+      outB = ROW(task->slabB[cur], pi, ri);
+      for (x=0; x<sx; x++) {
+        lev1[0 + 2*(x + sx*(ri + pr*pi))] = outA[x];
+        lev1[1 + 2*(x + sx*(ri + pr*pi))] = outB[x];
+      }
+    }
+  }
+#undef ROW
+  return;
+}
+
+/*
+** _alanIterNum
+**
+** how many iterations to do in the block starting with iteration iter:
+** at most iterBlock, and ending on the last iteration, or on one where
+** _alanPerIteration saves a frame or a snapshot
+*/
+int
+_alanIterNum(alanContext *actx, int iter) {
+  int num;
+
+  num = AIR_MAX(1, actx->iterBlock);
+  if (actx->maxIteration) {
+    num = AIR_MIN(num, actx->maxIteration - iter);
+  }
+  if (actx->frameInterval) {
+    num = AIR_MIN(num, 1 + ((actx->frameInterval
+                             - iter % actx->frameInterval)
+                            % actx->frameInterval));
+  }
+  if (actx->saveInterval) {
+    num = AIR_MIN(num, 1 + ((actx->saveInterval
+                             - iter % actx->saveInterval)
+                            % actx->saveInterval));
+  }
+  return num;
+}
+
 void *
 _alanTuringWorker(void *_task) {
-  alan_t *tendata, *ten, react,
-    conf, Dxx, Dxy, Dyy, /* Dxz, Dyz, */
-    *tpx, *tmx, *tpy, *tmy, /* *tpz, *tmz, */
-    *lev0, *lev1, *parm, deltaT, alpha, beta, A, B,
-    *v[27], lapA, lapB, corrA, corrB,
-    deltaA, deltaB, diffA, diffB, change;
-  int dim, iter, stop, startW, endW, idx,
-    px, mx, py, my, pz, mz,
-    startY, endY, startZ, endZ, sx, sy, sz, x, y, z;
+  alan_t *lev0, *lev1, change;
+  int dim, iter, iterNum, stop, src, slabIdx, slabNum, sx, sy, sz;
   alanTask *task;
 
   task = (alanTask *)_task;
@@ -245,216 +561,73 @@ _alanTuringWorker(void *_task) {
   sx = task->actx->size[0];
   sy = task->actx->size[1];
   sz = (2 == dim ? 1 : task->actx->size[2]);
-  parm = (alan_t*)(task->actx->nparm->data);
-  diffA = AIR_CAST(alan_t, task->actx->diffA/pow(task->actx->deltaX, dim));
-  diffB = AIR_CAST(alan_t, task->actx->diffB/pow(task->actx->deltaX, dim));
-  startW = task->idx*sy/task->actx->numThreads;
-  endW = (task->idx+1)*sy/task->actx->numThreads;
-  tendata = task->actx->nten ? (alan_t *)task->actx->nten->data : NULL;
-  react = task->actx->react;
-
-  if (2 == dim) {
-    startZ = 0;
-    endZ = 1;
-    startY = startW;
-    endY = endW;
-  } else {
-    startZ = startW;
-    endZ = endW;
-    startY = 0;
-    endY = sy;
-  }
+  slabNum = ((2 == dim ? sy : sz) + task->actx->slabLen - 1)
+    /task->actx->slabLen;
 
+  src = 0;
   for (iter = 0;
        (alanStopNot == task->actx->stop
         && (0 == task->actx->maxIteration
             || iter < task->actx->maxIteration));
-       iter++) {
+       iter += iterNum) {
 
+    iterNum = _alanIterNum(task->actx, iter);
     if (0 == task->idx) {
-      task->actx->iter = iter;
-      task->actx->nlev = task->actx->_nlev[(iter+1) % 2];
+      task->actx->iter = iter + iterNum - 1;
+      task->actx->nlev = task->actx->_nlev[1 - src];
     }
-    lev0 = (alan_t*)(task->actx->_nlev[iter % 2]->data);
-    lev1 = (alan_t*)(task->actx->_nlev[(iter+1) % 2]->data);
+    lev0 = (alan_t*)(task->actx->_nlev[src]->data);
+    lev1 = (alan_t*)(task->actx->_nlev[1 - src]->data);
     stop = alanStopNot;
     change = 0;
-    conf = 1;  /* if you have no data; this will stay 1 */
-    for (z = startZ; z < endZ; z++) {
-      if (task->actx->wrap) {
-        pz = AIR_MOD(z+1, sz);
-        mz = AIR_MOD(z-1, sz);
-      } else {
-        pz = AIR_MIN(z+1, sz-1);
-        mz = AIR_MAX(z-1, 0);
+    while (1) {
+      airThreadMutexLock(task->actx->changeMutex);
+      slabIdx = task->actx->nextSlab;
+      if (task->actx->nextSlab < slabNum) {
+        task->actx->nextSlab++;
       }
-      for (y = startY; y < endY; y++) {
-        if (task->actx->wrap) {
-          py = AIR_MOD(y+1, sy);
-          my = AIR_MOD(y-1, sy);
-        } else {
-          py = AIR_MIN(y+1, sy-1);
-          my = AIR_MAX(y-1, 0);
-        }
-        for (x = 0; x < sx; x++) {
-          if (task->actx->wrap) {
-            px = AIR_MOD(x+1, sx);
-            mx = AIR_MOD(x-1, sx);
-          } else {
-            px = AIR_MIN(x+1, sx-1);
-            mx = AIR_MAX(x-1, 0);
-          }
-          idx = x + sx*(y + sy*z);
-          A = lev0[0 + 2*idx];
-          B = lev0[1 + 2*idx];
-          deltaT = parm[0 + 3*idx];
-          alpha = parm[1 + 3*idx];
-          beta = parm[2 + 3*idx];
-          lapA = lapB = corrA = corrB = 0;
-          if (2 == dim) {
-            /*
-            **  0 1 2 ----> X
-            **  3 4 5
-            **  6 7 8
-            **  |
-            **  v Y
-            */
-            v[1] = lev0 + 2*( x + sx*(my));
-            v[3] = lev0 + 2*(mx + sx*( y));
-            v[5] = lev0 + 2*(px + sx*( y));
-            v[7] = lev0 + 2*( x + sx*(py));
-            if (tendata) {
-              /*
-              **  0 1 2    Dxy/2          Dyy        -Dxy/2
-              **  3 4 5     Dxx     -2*(Dxx + Dyy)     Dxx
-              **  6 7 8   -Dxy/2          Dyy         Dxy/2
-              */
-              v[0] = lev0 + 2*(mx + sx*(my));
-              v[2] = lev0 + 2*(px + sx*(my));
-              v[6] = lev0 + 2*(mx + sx*(py));
-              v[8] = lev0 + 2*(px + sx*(py));
-              ten = tendata + 4*idx;
-              conf = AIR_CAST(alan_t, (AIR_CLAMP(0.3, ten[0], 1) - 0.3)/0.7);
-              if (conf) {
-                Dxx = ten[1];
-                Dxy = ten[2];
-                Dyy = ten[3];
-                lapA = (Dxy*(v[0][0] + v[8][0] - v[2][0] - v[6][0])/2
-                        + Dxx*(v[3][0] + v[5][0]) + Dyy*(v[1][0] + v[7][0])
-                        - 2*(Dxx + Dyy)*A);
-                lapB = (Dxy*(v[0][1] + v[8][1] - v[2][1] - v[6][1])/2
-                        + Dxx*(v[3][1] + v[5][1]) + Dyy*(v[1][1] + v[7][1])
-                        - 2*(Dxx + Dyy)*B);
-                if (!(task->actx->homogAniso)) {
-                  tpx = tendata + 4*(px + sx*( y + sy*( z)));
-                  tmx = tendata + 4*(mx + sx*( y + sy*( z)));
-                  tpy = tendata + 4*( x + sx*(py + sy*( z)));
-                  tmy = tendata + 4*( x + sx*(my + sy*( z)));
-                  corrA = ((tpx[1]-tmx[1])*(v[5][0]-v[3][0])/4+ /* Dxx,x*A,x */
-                           (tpx[2]-tmx[2])*(v[7][0]-v[1][0])/4+ /* Dxy,x*A,y */
-                           (tpy[2]-tmy[2])*(v[5][0]-v[3][0])/4+ /* Dxy,y*A,x */
-                           (tpy[3]-tmy[3])*(v[7][0]-v[1][0]));  /* Dyy,y*A,y */
-                  corrB = ((tpx[1]-tmx[1])*(v[5][1]-v[3][1])/4+ /* Dxx,x*B,x */
-                           (tpx[2]-tmx[2])*(v[7][1]-v[1][1])/4+ /* Dxy,x*B,y */
-                           (tpy[2]-tmy[2])*(v[5][1]-v[3][1])/4+ /* Dxy,y*B,x */
-                           (tpy[3]-tmy[3])*(v[7][1]-v[1][1]));  /* Dyy,y*B,y */
-                }
-              } else {
-                /* no confidence; you diffuse */
-                lapA = v[1][0] + v[3][0] + v[5][0] + v[7][0] - 4*A;
-                lapB = v[1][1] + v[3][1] + v[5][1] + v[7][1] - 4*B;
-              }
-            } else {
-              /* no data; you diffuse */
-              lapA = v[1][0] + v[3][0] + v[5][0] + v[7][0] - 4*A;
-              lapB = v[1][1] + v[3][1] + v[5][1] + v[7][1] - 4*B;
-            }
-          } else {
-            /* 3 == dim */
-            /*
-            **          0   1   2   ---- X
-            **        3   4   5
-            **      6   7   8
-            **    /
-            **  /       9  10  11
-            ** Y     12  13  14
-            **     15  16  17
-            **
-            **         18  19  20
-            **       21  22  23
-            **     24  25  26
-            **         |
-            **         |
-            **         Z
-            */
-            v[ 4] = lev0 + 2*( x + sx*( y + sy*(mz)));
-            v[10] = lev0 + 2*( x + sx*(my + sy*( z)));
-            v[12] = lev0 + 2*(mx + sx*( y + sy*( z)));
-            v[14] = lev0 + 2*(px + sx*( y + sy*( z)));
-            v[16] = lev0 + 2*( x + sx*(py + sy*( z)));
-            v[22] = lev0 + 2*( x + sx*( y + sy*(pz)));
-            if (tendata) {
-
-              if (!(task->actx->homogAniso)) {
-
-              }
-            } else {
-              lapA = (v[ 4][0] + v[10][0] + v[12][0]
-                      + v[14][0] + v[16][0] + v[22][0] - 6*A);
-              lapB = (v[ 4][1] + v[10][1] + v[12][1]
-                      + v[14][1] + v[16][1] + v[22][1] - 6*B);
-            }
-          }
-
-          deltaA = deltaT*(react*conf*task->actx->K*(alpha - A*B)
-                           + diffA*(lapA + corrA));
-          if (AIR_ABS(deltaA) > task->actx->maxPixelChange) {
-            stop = alanStopDiverged;
-          }
-          change += AIR_ABS(deltaA);
-          deltaB = deltaT*(react*conf*task->actx->K*(A*B - B - beta)
-                           + diffB*(lapB + corrB));
-          if (!( AIR_EXISTS(deltaA) && AIR_EXISTS(deltaB) )) {
-            stop = alanStopNonExist;
-          }
-
-          A += deltaA;
-          B = AIR_MAX(0, B + deltaB);
-          lev1[0 + 2*idx] = A;
-          lev1[1 + 2*idx] = B;
-        }
+      airThreadMutexUnlock(task->actx->changeMutex);
+      if (slabIdx == slabNum) {
+        break;
       }
+      _alanTuringSlab(task, lev0, lev1, slabIdx, iterNum, &change, &stop);
     }
 
     /* add change to global sum in a threadsafe way */
     airThreadMutexLock(task->actx->changeMutex);
     task->actx->averageChange += change/(sx*sy*sz);
     task->actx->changeCount += 1;
+    if (alanStopNot != stop) {
+      task->actx->blockStop = stop;
+    }
     if (task->actx->changeCount == task->actx->numThreads) {
       /* I must be the last thread to reach this point; all
          others must have passed the mutex unlock, and are
          sitting at the barrier */
-      if (alanStopNot != stop) {
+      if (alanStopNot != task->actx->blockStop) {
         /* there was some problem in going from lev0 to lev1, which
            we deal with now by setting actx->stop */
-        task->actx->stop = stop;
+        task->actx->stop = task->actx->blockStop;
       } else if (task->actx->averageChange < task->actx->minAverageChange) {
         /* we converged */
         task->actx->stop = alanStopConverged;
       } else {
         /* we keep going */
-        _alanPerIteration(task->actx, iter);
+        _alanPerIteration(task->actx, task->actx->iter);
         if (task->actx->perIteration) {
-          task->actx->perIteration(task->actx, iter);
+          task->actx->perIteration(task->actx, task->actx->iter);
         }
       }
       task->actx->averageChange = 0;
       task->actx->changeCount = 0;
+      task->actx->blockStop = alanStopNot;
+      task->actx->nextSlab = 0;
     }
     airThreadMutexUnlock(task->actx->changeMutex);
 
-    /* force all threads to line up here, once per iteration */
+    /* force all threads to line up here, once per block of iterations */
     airThreadBarrierWait(task->actx->iterBarrier);
+    src = 1 - src;
   }
 
   if (iter == task->actx->maxIteration) {
@@ -465,10 +638,64 @@ _alanTuringWorker(void *_task) {
   return _task;
 }
 
+/*
+** _alanTaskBuffersNew
+**
+** allocates the per-thread slab buffers; returns non-zero on failure
+*/
+int
+_alanTaskBuffersNew(alanTask *task) {
+  alanContext *actx;
+  size_t planeLen, slabLen;
+  unsigned int ii;
+
+  actx = task->actx;
+  planeLen = (actx->size[0] + 2)*(2 == actx->dim ? 1 : actx->size[1]);
+  slabLen = planeLen*(actx->slabLen + 2*AIR_MAX(1, actx->iterBlock));
+  for (ii=0; ii<2; ii++) {
+    task->slabA[ii] = AIR_CALLOC(slabLen, alan_t);
+    task->slabB[ii] = AIR_CALLOC(slabLen, alan_t);
+  }
+  task->rowLapA = AIR_CALLOC(actx->size[0], alan_t);
+  task->rowLapB = AIR_CALLOC(actx->size[0], alan_t);
+  task->rowRC = AIR_CALLOC(actx->size[0], alan_t);
+  task->rowDA = AIR_CALLOC(actx->size[0], alan_t);
+  task->rowDB = AIR_CALLOC(actx->size[0], alan_t);
+  if (!( task->slabA[0] && task->slabA[1] && task->slabB[0] && task->slabB[1]
+         && task->rowLapA && task->rowLapB && task->rowRC
+         && task->rowDA && task->rowDB )) {
+    return 1;
+  }
+  if (!( 2 == actx->dim && actx->nten )) {
+    /* without anisotropy, conf is always 1 */
+    for (ii=0; ii<actx->size[0]; ii++) {
+      task->rowRC[ii] = actx->react*1;
+    }
+  }
+  return 0;
+}
+
+void
+_alanTaskBuffersNix(alanTask *task) {
+  unsigned int ii;
+
+  for (ii=0; ii<2; ii++) {
+    task->slabA[ii] = (alan_t *)airFree(task->slabA[ii]);
+    task->slabB[ii] = (alan_t *)airFree(task->slabB[ii]);
+  }
+  task->rowLapA = (alan_t *)airFree(task->rowLapA);
+  task->rowLapB = (alan_t *)airFree(task->rowLapB);
+  task->rowRC = (alan_t *)airFree(task->rowRC);
+  task->rowDA = (alan_t *)airFree(task->rowDA);
+  task->rowDB = (alan_t *)airFree(task->rowDB);
+  return;
+}
+
 int
 alanRun(alanContext *actx) {
   static const char me[]="alanRun";
-  int tid, hack=AIR_FALSE;
+  int tid, hack=AIR_FALSE, so, bad;
+  size_t planeBytes;
   alanTask task[ALAN_THREAD_MAX];
 
   if (_alanCheck(actx)) {
@@ -481,18 +708,45 @@ alanRun(alanContext *actx) {
     return 1;
   }
 
+  so = (2 == actx->dim ? actx->size[1] : actx->size[2]);
+  if (actx->slabSize) {
+    actx->slabLen = actx->slabSize;
+  } else {
+    /* aim for the four planes buffers of a slab to fit in 512K, while
+       not spending more than half the effort on ghost planes */
+    planeBytes = (4*sizeof(alan_t)*(actx->size[0] + 2)
+                  *(2 == actx->dim ? 1 : actx->size[1]));
+    actx->slabLen = AIR_CAST(int, 512*1024/planeBytes);
+    actx->slabLen -= 2*actx->iterBlock;
+    actx->slabLen = AIR_MAX(actx->slabLen, 2*actx->iterBlock);
+  }
+  actx->slabLen = AIR_MIN(actx->slabLen, so);
+
   if (!airThreadCapable && 1 == actx->numThreads) {
     hack = airThreadNoopWarning;
     airThreadNoopWarning = AIR_FALSE;
   }
+  bad = AIR_FALSE;
+  for (tid=0; tid<actx->numThreads; tid++) {
+    task[tid].actx = actx;
+    task[tid].idx = tid;
+    bad |= _alanTaskBuffersNew(task + tid);
+  }
+  if (bad) {
+    for (tid=0; tid<actx->numThreads; tid++) {
+      _alanTaskBuffersNix(task + tid);
+    }
+    biffAddf(ALAN, "%s: couldn't allocate slab buffers", me);
+    return 1;
+  }
   actx->changeMutex = airThreadMutexNew();
   actx->iterBarrier = airThreadBarrierNew(actx->numThreads);
   actx->averageChange = 0;
   actx->changeCount = 0;
+  actx->nextSlab = 0;
+  actx->blockStop = alanStopNot;
   actx->stop = alanStopNot;
   for (tid=0; tid<actx->numThreads; tid++) {
-    task[tid].actx = actx;
-    task[tid].idx = tid;
     task[tid].thread = airThreadNew();
     airThreadStart(task[tid].thread, _alanTuringWorker,
                    (void *)&(task[tid]));
@@ -500,6 +754,7 @@ alanRun(alanContext *actx) {
   for (tid=0; tid<actx->numThreads; tid++) {
     airThreadJoin(task[tid].thread, &(task[tid].me));
     task[tid].thread = airThreadNix(task[tid].thread);
+    _alanTaskBuffersNix(task + tid);
   }
   actx->iterBarrier = airThreadBarrierNix(actx->iterBarrier);
   actx->changeMutex = airThreadMutexNix(actx->changeMutex);
@@ -63,6 +63,8 @@ alanContextInit(alanContext *actx) {
     actx->nparm = nrrdNuke(actx->nparm);
     actx->nten = nrrdNuke(actx->nten);
     actx->constFilename = AIR_FALSE;
+    actx->iterBlock = 1;
+    actx->slabSize = 0;
   }
   return;
 }
@@ -222,7 +224,7 @@ alanParmSet(alanContext *actx, int whichParm, double parm) {
     actx->verbose = parmI;
     break;
   case alanParmTextureType:
-    parmI = !!parm;
+    parmI = AIR_CAST(int, parm);
     switch(parmI) {
     case alanTextureTypeTuring:
       actx->initA = 4.0;
@@ -244,7 +246,12 @@ alanParmSet(alanContext *actx, int whichParm, double parm) {
     actx->textureType = parmI;
     break;
   case alanParmNumThreads:
-    parmI = !!parm;
+    parmI = AIR_CAST(int, parm);
+    if (!( 1 <= parmI && parmI <= ALAN_THREAD_MAX )) {
+      biffAddf(ALAN, "%s: # threads %d not in [1,%d]", me, parmI,
+               ALAN_THREAD_MAX);
+      return 1;
+    }
     if (!airThreadCapable) {
       fprintf(stderr, "%s: WARNING: no multi-threading available, so 1 thread "
               "will be used, not %d\n", me, parmI);
@@ -257,15 +264,15 @@ alanParmSet(alanContext *actx, int whichParm, double parm) {
     actx->homogAniso = parmI;
     break;
   case alanParmSaveInterval:
-    parmI = !!parm;
+    parmI = AIR_CAST(int, parm);
     actx->saveInterval = parmI;
     break;
   case alanParmFrameInterval:
-    parmI = !!parm;
+    parmI = AIR_CAST(int, parm);
     actx->frameInterval = parmI;
     break;
   case alanParmMaxIteration:
-    parmI = !!parm;
+    parmI = AIR_CAST(int, parm);
     actx->maxIteration = parmI;
     break;
   case alanParmConstantFilename:
@@ -312,6 +319,22 @@ alanParmSet(alanContext *actx, int whichParm, double parm) {
     parmI = !!parm;
     actx->wrap = parmI;
     break;
+  case alanParmIterBlock:
+    parmI = AIR_CAST(int, parm);
+    if (!( parmI >= 1 )) {
+      biffAddf(ALAN, "%s: iterBlock %d invalid", me, parmI);
+      return 1;
+    }
+    actx->iterBlock = parmI;
+    break;
+  case alanParmSlabSize:
+    parmI = AIR_CAST(int, parm);
+    if (!( parmI >= 0 )) {
+      biffAddf(ALAN, "%s: slabSize %d invalid", me, parmI);
+      return 1;
+    }
+    actx->slabSize = parmI;
+    break;
   default:
     biffAddf(ALAN, "%s: parameter %d invalid", me, whichParm);
     return 1;
@@ -285,6 +285,18 @@ typedef struct {
   double incLimit;                     /* lowest permissible fraction of the
                                           data remaining after new inclusion
                                           has been determined */
+  unsigned int numThreads;             /* number of threads to measure with
+                                          (0 for nrrdStateNumThreads);
+                                          each has its own gageContext and,
+                                          while filling the histogram
+                                          volume, its own (int) copy of it */
+  int separable;                       /* if all three measures allow it
+                                          (value, gradient magnitude,
+                                          Laplacian, 2nd DD), measure by
+                                          streaming separable convolution
+                                          through the volume, instead of
+                                          gageProbe()ing every voxel.  The
+                                          results are the same. */
   baneAxis axis[3];
   /* -------------- internal */
   Nrrd *measrVol;
@@ -298,6 +310,7 @@ BANE_EXPORT int baneDefMakeMeasrVol;
 BANE_EXPORT double baneDefIncLimit;
 BANE_EXPORT int baneDefRenormalize;
 BANE_EXPORT int baneDefPercHistBins;
+BANE_EXPORT int baneDefSeparable;
 BANE_EXPORT int baneStateHistEqBins;
 BANE_EXPORT int baneStateHistEqSmart;
 BANE_EXPORT int baneHack;
@@ -183,7 +183,7 @@ baneClip *
 baneClipNix(baneClip *clip) {
 
   if (clip) {
-    airFree(clip->name);
+    /* clip->name is an array inside clip, not separately allocated */
     airFree(clip);
   }
   return NULL;
@@ -41,6 +41,9 @@ baneDefRenormalize = AIR_TRUE;
 int
 baneDefPercHistBins = 1024;
 
+int
+baneDefSeparable = AIR_TRUE;
+
 int
 baneStateHistEqBins = 4096;
 
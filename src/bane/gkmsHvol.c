@@ -39,7 +39,8 @@ baneGkms_hvolMain(int argc, const char **argv, const char *me,
   char *out, *perr;
   Nrrd *nin, *nout;
   airArray *mop;
-  int pret, dim[3], lapl, slow, gz = AIR_FALSE;
+  int pret, dim[3], lapl, slow, probe, gz = AIR_FALSE;
+  unsigned int numThreads;
   double inc[3*(1+BANE_PARM_NUM)];
   baneHVolParm *hvp;
   NrrdIoState *nio;
@@ -78,6 +79,14 @@ baneGkms_hvolMain(int argc, const char **argv, const char *me,
              "Instead of allocating a floating point VGH volume and measuring "
              "V,G,H once, measure V,G,H multiple times on separate passes "
              "(slower, but needs less memory)");
+  hestOptAdd(&opt, "gp", NULL, airTypeInt, 0, 0, &probe, NULL,
+             "measure V,G,H by probing every voxel with gage, instead of "
+             "by streaming separable convolution through the volume "
+             "(slower, same results)");
+  hestOptAdd(&opt, "nt", "# threads", airTypeUInt, 1, 1, &numThreads, "0",
+             "number of threads to measure with, or 0 to use the "
+             "NRRD_STATE_NUM_THREADS environment variable "
+             "(or 1 if that isn't set)");
   if (nrrdEncodingGzip->available()) {
     hestOptAdd(&opt, "gz", NULL, airTypeInt, 0, 0, &gz, NULL,
                "Use gzip compression for output histo-volume; "
@@ -103,6 +112,8 @@ baneGkms_hvolMain(int argc, const char **argv, const char *me,
   airMopAdd(mop, hvp, (airMopper)baneHVolParmNix, airMopAlways);
   baneHVolParmGKMSInit(hvp);
   hvp->makeMeasrVol = !slow;
+  hvp->separable = !probe;
+  hvp->numThreads = numThreads;
 
   fprintf(stderr, "!%s: need to be using baneHVolParmAxisSet\n", me);
   /*
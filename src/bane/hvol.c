@@ -86,23 +86,587 @@ baneProbe(double val[3],
   return;
 }
 
+/*
+** _baneSep: for measuring the value, gradient, and Hessian at all the
+** voxels of a slice at once, with the same results as gageProbe()ing
+** each of them (with gageKindScl and a 3-pack of kernels).  This uses
+** the same filter weights (learned from one probe), the same clamping
+** at the volume boundary, and the same order of operations as
+** gageScl3PFilterN(): filtering along X, then Y, then Z.  Convolving
+** along X and Y is done once per slice; the results for the last fd
+** slices are kept in a ring buffer, to be convolved along Z.
+**
+** The "combos" are the X and Y derivatives that are needed:
+** 0:x0y0, 1:x0y1, 2:x0y2, 3:x1y0, 4:x1y1, 5:x2y0
+*/
+#define _BANE_SEP_COMBO_NUM 6
+static const unsigned int
+_baneSepComboX[_BANE_SEP_COMBO_NUM] = {0, 0, 0, 1, 1, 2},
+_baneSepComboY[_BANE_SEP_COMBO_NUM] = {0, 1, 2, 0, 1, 0};
+
+typedef struct {
+  const void *data;
+  double (*lup)(const void *v, size_t I);
+  unsigned int size[3], fr, fd;
+  int needD[3],
+    needX[3],                        /* need X derivative 0, 1, 2 */
+    needC[_BANE_SEP_COMBO_NUM];      /* need combo */
+  double *fw,                        /* fd weights for each axis, for
+                                        kernels 00, 11, 22 (in that order)
+                                        laid out as in gageContext->fw */
+    ItoWSubInvTransp[9], ItoWSubInv[9],
+    *row,                            /* one scanline, padded by clamping */
+    *slcX[3],                        /* one slice convolved along X */
+    *ring[_BANE_SEP_COMBO_NUM];      /* fd slices convolved along X, Y */
+  int *ringSlice;                    /* which slice is in each ring place */
+  size_t *zoff;                      /* offsets into ring for Z filtering */
+} _baneSep;
+
+static _baneSep *
+_baneSepNix(_baneSep *sep) {
+  unsigned int ii;
+
+  if (sep) {
+    airFree(sep->fw);
+    airFree(sep->row);
+    for (ii=0; ii<3; ii++) {
+      airFree(sep->slcX[ii]);
+    }
+    for (ii=0; ii<_BANE_SEP_COMBO_NUM; ii++) {
+      airFree(sep->ring[ii]);
+    }
+    airFree(sep->ringSlice);
+    airFree(sep->zoff);
+    airFree(sep);
+  }
+  return NULL;
+}
+
+/*
+** _baneSepNew: ctx has to be set up (with gageUpdate) for a 3-pack of
+** kernels on a scalar volume; it will be probed once, to learn the
+** filter weights.  Returns NULL on allocation error.
+*/
+static _baneSep *
+_baneSepNew(gageContext *ctx, const Nrrd *nin) {
+  _baneSep *sep;
+  gagePerVolume *pvl;
+  size_t sxy;
+  unsigned int ii, kx;
+  int E;
+
+  sep = AIR_CALLOC(1, _baneSep);
+  if (!sep) {
+    return NULL;
+  }
+  pvl = ctx->pvl[0];
+  sep->data = nin->data;
+  sep->lup = nrrdDLookup[nin->type];
+  sep->size[0] = AIR_CAST(unsigned int, nin->axis[0].size);
+  sep->size[1] = AIR_CAST(unsigned int, nin->axis[1].size);
+  sep->size[2] = AIR_CAST(unsigned int, nin->axis[2].size);
+  sep->fr = ctx->radius;
+  sep->fd = 2*ctx->radius;
+  ELL_3V_COPY(sep->needD, pvl->needD);
+  sep->needX[0] = AIR_TRUE;
+  sep->needX[1] = sep->needD[1] || sep->needD[2];
+  sep->needX[2] = sep->needD[2];
+  for (ii=0; ii<_BANE_SEP_COMBO_NUM; ii++) {
+    sep->needC[ii] = (sep->needX[_baneSepComboX[ii]]
+                      && sep->needX[_baneSepComboY[ii]]
+                      && (_baneSepComboX[ii] + _baneSepComboY[ii] <= 1
+                          || sep->needD[2]));
+  }
+  /* any grid point has the same weights */
+  gageProbe(ctx, sep->size[0]/2, sep->size[1]/2, sep->size[2]/2);
+  sep->fw = AIR_CALLOC(3*3*sep->fd, double);
+  sep->row = AIR_CALLOC(sep->size[0] + sep->fd - 1, double);
+  sep->ringSlice = AIR_CALLOC(sep->fd, int);
+  sep->zoff = AIR_CALLOC(sep->fd, size_t);
+  E = !(sep->fw && sep->row && sep->ringSlice && sep->zoff);
+  if (!E) {
+    for (ii=0; ii<3*sep->fd; ii++) {
+      sep->fw[ii + 3*sep->fd*0] = ctx->fw[ii + 3*sep->fd*gageKernel00];
+      sep->fw[ii + 3*sep->fd*1] = ctx->fw[ii + 3*sep->fd*gageKernel11];
+      sep->fw[ii + 3*sep->fd*2] = ctx->fw[ii + 3*sep->fd*gageKernel22];
+    }
+  }
+  sxy = AIR_CAST(size_t, sep->size[0])*sep->size[1];
+  for (kx=0; kx<3 && !E; kx++) {
+    if (sep->needX[kx]) {
+      E |= !(sep->slcX[kx] = AIR_CALLOC(sxy, double));
+    }
+  }
+  for (ii=0; ii<_BANE_SEP_COMBO_NUM && !E; ii++) {
+    if (sep->needC[ii]) {
+      E |= !(sep->ring[ii] = AIR_CALLOC(sep->fd*sxy, double));
+    }
+  }
+  if (E) {
+    return _baneSepNix(sep);
+  }
+  for (ii=0; ii<sep->fd; ii++) {
+    sep->ringSlice[ii] = -1;
+  }
+  ELL_3M_COPY(sep->ItoWSubInvTransp, ctx->shape->ItoWSubInvTransp);
+  ELL_3M_COPY(sep->ItoWSubInv, ctx->shape->ItoWSubInv);
+  return sep;
+}
+
+/*
+** _baneSepLoad: convolve slice zi along X and Y, into the ring buffer
+*/
+static void
+_baneSepLoad(_baneSep *sep, unsigned int zi) {
+  unsigned int sx, sy, fd, fr, place, xi, yi, ii, kx, cc;
+  int pos;
+  size_t sxy;
+  double *fw, *out, *in;
+
+  fd = sep->fd;
+  place = zi % fd;
+  if (AIR_CAST(int, zi) == sep->ringSlice[place]) {
+    return;
+  }
+  sx = sep->size[0];
+  sy = sep->size[1];
+  fr = sep->fr;
+  sxy = AIR_CAST(size_t, sx)*sy;
+  for (yi=0; yi<sy; yi++) {
+    for (ii=0; ii<sx + fd - 1; ii++) {
+      pos = AIR_CAST(int, ii) - AIR_CAST(int, fr - 1);
+      pos = AIR_CLAMP(0, pos, AIR_CAST(int, sx - 1));
+      sep->row[ii] = sep->lup(sep->data, pos + sx*(yi + sy*zi));
+    }
+    for (kx=0; kx<3; kx++) {
+      if (!sep->needX[kx]) {
+        continue;
+      }
+      /* weights for axis X of kernel kx */
+      fw = sep->fw + fd*(0 + 3*kx);
+      out = sep->slcX[kx] + sx*yi;
+      for (xi=0; xi<sx; xi++) {
+        out[xi] = 0.0;
+      }
+      for (ii=0; ii<fd; ii++) {
+        for (xi=0; xi<sx; xi++) {
+          out[xi] += fw[ii]*sep->row[xi + ii];
+        }
+      }
+    }
+  }
+  for (cc=0; cc<_BANE_SEP_COMBO_NUM; cc++) {
+    if (!sep->needC[cc]) {
+      continue;
+    }
+    /* weights for axis Y of kernel _baneSepComboY[cc] */
+    fw = sep->fw + fd*(1 + 3*_baneSepComboY[cc]);
+    for (yi=0; yi<sy; yi++) {
+      out = sep->ring[cc] + place*sxy + sx*yi;
+      for (xi=0; xi<sx; xi++) {
+        out[xi] = 0.0;
+      }
+      for (ii=0; ii<fd; ii++) {
+        pos = AIR_CAST(int, yi + ii) - AIR_CAST(int, fr - 1);
+        pos = AIR_CLAMP(0, pos, AIR_CAST(int, sy - 1));
+        in = sep->slcX[_baneSepComboX[cc]] + sx*pos;
+        for (xi=0; xi<sx; xi++) {
+          out[xi] += fw[ii]*in[xi];
+        }
+      }
+    }
+  }
+  sep->ringSlice[place] = AIR_CAST(int, zi);
+  return;
+}
+
+static int
+_baneSepMeasrOkay(const baneMeasr *measr) {
+
+  switch (measr->type) {
+  case baneMeasrValuePositive:
+  case baneMeasrValueZeroCentered:
+  case baneMeasrValueAnywhere:
+  case baneMeasrGradMag:
+  case baneMeasrLaplacian:
+  case baneMeasr2ndDD:
+    return AIR_TRUE;
+  }
+  return AIR_FALSE;
+}
+
+/*
+** computes from val, gvec, and hess the same as _gageSclAnswer would
+*/
+static double
+_baneSepAnswer(const baneMeasr *measr,
+               double val, const double gvec[3], const double hess[9]) {
+  double gmag, norm[3], tmpVec[3], ret;
+
+  switch (measr->type) {
+  case baneMeasrGradMag:
+    ret = sqrt(ELL_3V_DOT(gvec, gvec));
+    break;
+  case baneMeasrLaplacian:
+    ret = hess[0] + hess[4] + hess[8];
+    break;
+  case baneMeasr2ndDD:
+    gmag = sqrt(ELL_3V_DOT(gvec, gvec));
+    if (gmag) {
+      ELL_3V_SCALE(norm, 1/gmag, gvec);
+    } else {
+      ELL_3V_COPY(norm, gageZeroNormal);
+    }
+    ELL_3MV_MUL(tmpVec, hess, norm);
+    ret = ELL_3V_DOT(norm, tmpVec);
+    break;
+  default:
+    ret = val;
+    break;
+  }
+  return ret;
+}
+
+static double
+_baneSepZ(const double *in, const size_t *zoff, const double *fw,
+          unsigned int fd) {
+  unsigned int kk;
+  double T;
+
+  T = 0.0;
+  for (kk=0; kk<fd; kk++) {
+    T += fw[kk]*in[zoff[kk]];
+  }
+  return T;
+}
+
+/*
+** _baneSepSlice: sets the 3 measurements of every voxel in slice zi
+*/
+static void
+_baneSepSlice(_baneSep *sep, double *mval, baneMeasr *measr[3],
+              unsigned int zi) {
+  unsigned int fd, kk, ai, sz;
+  int pos;
+  size_t sxy, II, *zoff;
+  double val, gvec[3], hess[9], matA[9], *fwZ0, *fwZ1, *fwZ2;
+
+  fd = sep->fd;
+  sz = sep->size[2];
+  sxy = AIR_CAST(size_t, sep->size[0])*sep->size[1];
+  zoff = sep->zoff;
+  for (kk=0; kk<fd; kk++) {
+    pos = AIR_CAST(int, zi + kk) - AIR_CAST(int, sep->fr - 1);
+    pos = AIR_CLAMP(0, pos, AIR_CAST(int, sz - 1));
+    _baneSepLoad(sep, AIR_CAST(unsigned int, pos));
+    zoff[kk] = (pos % fd)*sxy;
+  }
+  /* weights for axis Z of the three kernels */
+  fwZ0 = sep->fw + fd*(2 + 3*0);
+  fwZ1 = sep->fw + fd*(2 + 3*1);
+  fwZ2 = sep->fw + fd*(2 + 3*2);
+  val = 0;
+  ELL_3V_SET(gvec, 0, 0, 0);
+  ELL_3M_ZERO_SET(hess);
+  for (II=0; II<sxy; II++) {
+    if (sep->needD[0]) {
+      val = _baneSepZ(sep->ring[0] + II, zoff, fwZ0, fd);
+    }
+    if (sep->needD[1]) {
+      gvec[2] = _baneSepZ(sep->ring[0] + II, zoff, fwZ1, fd);
+      gvec[1] = _baneSepZ(sep->ring[1] + II, zoff, fwZ0, fd);
+      gvec[0] = _baneSepZ(sep->ring[3] + II, zoff, fwZ0, fd);
+      ell_3mv_mul_d(gvec, sep->ItoWSubInvTransp, gvec);
+    }
+    if (sep->needD[2]) {
+      hess[8] = _baneSepZ(sep->ring[0] + II, zoff, fwZ2, fd);
+      hess[5] = hess[7] = _baneSepZ(sep->ring[1] + II, zoff, fwZ1, fd);
+      hess[4] = _baneSepZ(sep->ring[2] + II, zoff, fwZ0, fd);
+      hess[2] = hess[6] = _baneSepZ(sep->ring[3] + II, zoff, fwZ1, fd);
+      hess[1] = hess[3] = _baneSepZ(sep->ring[4] + II, zoff, fwZ0, fd);
+      hess[0] = _baneSepZ(sep->ring[5] + II, zoff, fwZ0, fd);
+      ELL_3M_MUL(matA, sep->ItoWSubInvTransp, hess);
+      ELL_3M_MUL(hess, matA, sep->ItoWSubInv);
+    }
+    for (ai=0; ai<3; ai++) {
+      mval[ai + 3*II] = _baneSepAnswer(measr[ai], val, gvec, hess);
+    }
+  }
+  return;
+}
+
+/*
+** The passes through the volume (passes A and B of the inclusion
+** initialization, and filling the histogram volume) are split into one
+** job per thread (hvp->numThreads, or nrrdStateNumThreads if that is
+** 0), run by nrrdThreadRun, each handling a contiguous range of slices,
+** so that the separable filtering can stream through them.  Each job
+** processes the measurements into its own copies of the baneIncs (in
+** the first two passes) or its own raw histogram volume (in the last),
+** and these are merged afterwards.  Job 0 uses the originals.
+*/
+typedef struct {
+  Nrrd *nin;
+  baneHVolParm *hvp;
+  int pass;                   /* 0, 1: inclusion passes A, B;
+                                 2: filling the histogram volume */
+  unsigned int lo[3], hi[3],  /* bounds of voxels visited */
+    shsz[3];                  /* histogram volume sizes (pass 2) */
+  double min[3], max[3];      /* inclusion (pass 2) */
+} _baneHVolShared;
+
+typedef struct {
+  _baneHVolShared *shr;
+  unsigned int zlo, zhi;      /* range of slices for this job */
+  gageContext *gctx;
+  _baneSep *sep;              /* NULL if gageProbe()ing */
+  baneInc *inc[3];
+  double *mval;               /* 3 measurements at each voxel in slice */
+  int *rhv;                   /* raw histogram volume */
+  size_t included;
+} _baneHVolTask;
+
+static void
+_baneHVolJob(void *_task0, unsigned int jobIdx, unsigned int threadIdx) {
+  char prog[AIR_STRLEN_SMALL];
+  _baneHVolTask *task;
+  _baneHVolShared *shr;
+  baneHVolParm *hvp;
+  baneMeasr *measr[3];
+  unsigned int xi, yi, zi, sx, sy, hx, hy, hz, ai;
+  size_t hidx;
+  double *val;
+  float *mdata;
+  int pass;
+
+  AIR_UNUSED(threadIdx);
+  task = AIR_CAST(_baneHVolTask *, _task0) + jobIdx;
+  shr = task->shr;
+  hvp = shr->hvp;
+  pass = shr->pass;
+  sx = AIR_CAST(unsigned int, shr->nin->axis[0].size);
+  sy = AIR_CAST(unsigned int, shr->nin->axis[1].size);
+  for (ai=0; ai<3; ai++) {
+    measr[ai] = hvp->axis[ai].measr;
+  }
+  for (zi=task->zlo; zi<task->zhi; zi++) {
+    if (hvp->verbose && !jobIdx) {
+      fprintf(stderr, "%s", airDoneStr(task->zlo, zi, task->zhi, prog));
+      fflush(stderr);
+    }
+    if (task->sep) {
+      _baneSepSlice(task->sep, task->mval, measr, zi);
+      if (hvp->makeMeasrVol) {
+        mdata = (float*)(hvp->measrVol->data) + 3*sx*sy*zi;
+        for (hidx=0; hidx<3*sx*sy; hidx++) {
+          mdata[hidx] = AIR_CAST(float, task->mval[hidx]);
+        }
+      }
+    } else {
+      for (yi=shr->lo[1]; yi<shr->hi[1]; yi++) {
+        for (xi=shr->lo[0]; xi<shr->hi[0]; xi++) {
+          baneProbe(task->mval + 3*(xi + sx*yi), shr->nin, hvp, task->gctx,
+                    xi, yi, zi);
+        }
+      }
+    }
+    for (yi=shr->lo[1]; yi<shr->hi[1]; yi++) {
+      for (xi=shr->lo[0]; xi<shr->hi[0]; xi++) {
+        val = task->mval + 3*(xi + sx*yi);
+        if (pass < 2) {
+          for (ai=0; ai<3; ai++) {
+            if (task->inc[ai]->process[pass]) {
+              task->inc[ai]->process[pass](task->inc[ai], val[ai]);
+            }
+          }
+          continue;
+        }
+        if (!( AIR_IN_CL(shr->min[0], val[0], shr->max[0]) &&
+               AIR_IN_CL(shr->min[1], val[1], shr->max[1]) &&
+               AIR_IN_CL(shr->min[2], val[2], shr->max[2]) )) {
+          continue;
+        }
+        /* else this voxel will contribute to the histovol */
+        hx = airIndex(shr->min[0], val[0], shr->max[0], shr->shsz[0]);
+        hy = airIndex(shr->min[1], val[1], shr->max[1], shr->shsz[1]);
+        hz = airIndex(shr->min[2], val[2], shr->max[2], shr->shsz[2]);
+        hidx = hx + shr->shsz[0]*(hy + shr->shsz[1]*hz);
+        if (task->rhv[hidx] < INT_MAX) {
+          ++task->rhv[hidx];
+        }
+        ++task->included;
+      }
+    }
+  }
+  return;
+}
+
+/*
+** _baneHVolPass: one pass (shr->pass) through the voxels in
+** [shr->lo, shr->hi), with hvp->numThreads threads (or
+** nrrdStateNumThreads, if hvp->numThreads is 0).  For pass 2, the
+** raw histogram volume rhv is incremented, and the number of voxels
+** included is put in *includedP.
+*/
+static int
+_baneHVolPass(_baneHVolShared *shr, gageContext *ctx,
+              int *rhv, size_t *includedP) {
+  static const char me[]="_baneHVolPass";
+  baneHVolParm *hvp;
+  _baneHVolTask *task;
+  airArray *mop;
+  unsigned int tidx, numThreads, ai, sx, sy, sz, zn;
+  size_t hnum, hidx;
+  int useSep, *prhv;
+
+  hvp = shr->hvp;
+  sx = AIR_CAST(unsigned int, shr->nin->axis[0].size);
+  sy = AIR_CAST(unsigned int, shr->nin->axis[1].size);
+  sz = AIR_CAST(unsigned int, shr->nin->axis[2].size);
+  /* one job per thread; never more jobs than slices */
+  zn = shr->hi[2] - shr->lo[2];
+  numThreads = nrrdThreadNum(hvp->numThreads, AIR_MAX(1, zn));
+  if (hvp->makeMeasrVol && !hvp->measrVol) {
+    if (nrrdMaybeAlloc_va(hvp->measrVol=nrrdNew(), nrrdTypeFloat, 4,
+                          AIR_CAST(size_t, 3),
+                          AIR_CAST(size_t, sx),
+                          AIR_CAST(size_t, sy),
+                          AIR_CAST(size_t, sz))) {
+      biffMovef(BANE, NRRD, "%s: couldn't allocate 3x%ux%ux%u VGH volume",
+                me, sx, sy, sz);
+      return 1;
+    }
+  }
+  useSep = (hvp->separable
+            && !(hvp->makeMeasrVol && hvp->measrVolDone)
+            && ctx->parm.k3pack
+            && gageKindScl == ctx->pvl[0]->kind
+            && _baneSepMeasrOkay(hvp->axis[0].measr)
+            && _baneSepMeasrOkay(hvp->axis[1].measr)
+            && _baneSepMeasrOkay(hvp->axis[2].measr));
+  hnum = 2 == shr->pass ? (AIR_CAST(size_t, shr->shsz[0])
+                           *shr->shsz[1]*shr->shsz[2]) : 0;
+
+  mop = airMopNew();
+  task = AIR_CALLOC(numThreads, _baneHVolTask);
+  if (!task) {
+    biffAddf(BANE, "%s: couldn't allocate %u tasks", me, numThreads);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  for (tidx=0; tidx<numThreads; tidx++) {
+    task[tidx].shr = shr;
+    task[tidx].zlo = shr->lo[2] + zn*tidx/numThreads;
+    task[tidx].zhi = shr->lo[2] + zn*(tidx+1)/numThreads;
+    if (tidx) {
+      if (!(task[tidx].gctx = gageContextCopy(ctx))) {
+        biffMovef(BANE, GAGE, "%s: couldn't copy gage context for "
+                  "thread %u", me, tidx);
+        airMopError(mop); return 1;
+      }
+      airMopAdd(mop, task[tidx].gctx, (airMopper)gageContextNix,
+                airMopAlways);
+    } else {
+      task[tidx].gctx = ctx;
+    }
+    if (useSep) {
+      if (!(task[tidx].sep = _baneSepNew(task[tidx].gctx, shr->nin))) {
+        biffAddf(BANE, "%s: couldn't allocate separable filtering "
+                 "buffers for thread %u", me, tidx);
+        airMopError(mop); return 1;
+      }
+      airMopAdd(mop, task[tidx].sep, (airMopper)_baneSepNix, airMopAlways);
+    }
+    if (!(task[tidx].mval = AIR_CALLOC(3*AIR_CAST(size_t, sx)*sy, double))) {
+      biffAddf(BANE, "%s: couldn't allocate slice of measurements "
+               "for thread %u", me, tidx);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, task[tidx].mval, airFree, airMopAlways);
+    if (shr->pass < 2) {
+      for (ai=0; ai<3; ai++) {
+        if (!tidx) {
+          task[tidx].inc[ai] = hvp->axis[ai].inc;
+          continue;
+        }
+        if (!(task[tidx].inc[ai] = baneIncCopy(hvp->axis[ai].inc))) {
+          biffAddf(BANE, "%s: couldn't copy inclusion %u for thread %u",
+                   me, ai, tidx);
+          airMopError(mop); return 1;
+        }
+        airMopAdd(mop, task[tidx].inc[ai], (airMopper)baneIncNix,
+                  airMopAlways);
+        if (hvp->axis[ai].inc->nhist) {
+          /* what was learned in the previous pass */
+          task[tidx].inc[ai]->nhist->axis[0].min
+            = hvp->axis[ai].inc->nhist->axis[0].min;
+          task[tidx].inc[ai]->nhist->axis[0].max
+            = hvp->axis[ai].inc->nhist->axis[0].max;
+        }
+      }
+    } else {
+      if (!tidx) {
+        task[tidx].rhv = rhv;
+      } else {
+        if (!(task[tidx].rhv = AIR_CALLOC(hnum, int))) {
+          biffAddf(BANE, "%s: couldn't allocate histogram volume "
+                   "for thread %u", me, tidx);
+          airMopError(mop); return 1;
+        }
+        airMopAdd(mop, task[tidx].rhv, airFree, airMopAlways);
+      }
+    }
+  }
+  if (nrrdThreadRun(numThreads, numThreads, _baneHVolJob, task)) {
+    biffMovef(BANE, NRRD, "%s: trouble with %u threads", me, numThreads);
+    airMopError(mop); return 1;
+  }
+
+  /* merge what the other jobs found into job 0's */
+  for (tidx=1; tidx<numThreads; tidx++) {
+    if (shr->pass < 2) {
+      for (ai=0; ai<3; ai++) {
+        _baneIncMerge(hvp->axis[ai].inc, task[tidx].inc[ai], shr->pass);
+      }
+    } else {
+      prhv = task[tidx].rhv;
+      for (hidx=0; hidx<hnum; hidx++) {
+        if (prhv[hidx] > INT_MAX - rhv[hidx]) {
+          rhv[hidx] = INT_MAX;
+        } else {
+          rhv[hidx] += prhv[hidx];
+        }
+      }
+      task[0].included += task[tidx].included;
+    }
+  }
+  if (includedP) {
+    *includedP = task[0].included;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
 int
 baneFindInclusion(double min[3], double max[3],
                   Nrrd *nin, baneHVolParm *hvp, gageContext *ctx) {
   static const char me[]="baneFindInclusion";
-  char prog[13],
-    aname[3][AIR_STRLEN_SMALL] = {"grad-mag", "2nd deriv", "data value"};
-  int sx, sy, sz, x, y, z, E, ai;
+  char aname[3][AIR_STRLEN_SMALL] = {"grad-mag", "2nd deriv", "data value"};
+  int E, ai;
   baneInc *inc[3];
   /* HEY HEY HEY:  The variable "hist" is used before its value is set.
   Nrrd *hist[3];
   */
-  double val[3];
+  _baneHVolShared shr;
 
   /* conveniance copies */
-  sx = nin->axis[0].size;
-  sy = nin->axis[1].size;
-  sz = nin->axis[2].size;
+  memset(&shr, 0, sizeof(shr));
+  shr.nin = nin;
+  shr.hvp = hvp;
+  for (ai=0; ai<3; ai++) {
+    shr.lo[ai] = 0;
+    shr.hi[ai] = AIR_CAST(unsigned int, nin->axis[ai].size);
+  }
   inc[0] = hvp->axis[0].inc;
   inc[1] = hvp->axis[1].inc;
   inc[2] = hvp->axis[2].inc;
@@ -138,30 +702,10 @@ baneFindInclusion(double min[3], double max[3],
     fprintf(stderr, "%s: inclusion pass CBs = %p %p %p \n", me,
             incPass[0], incPass[1], incPass[2]);
     */
-    if (hvp->makeMeasrVol && !hvp->measrVol) {
-      if (nrrdMaybeAlloc_va(hvp->measrVol=nrrdNew(), nrrdTypeFloat, 4,
-                            AIR_CAST(size_t, 3),
-                            AIR_CAST(size_t, sx),
-                            AIR_CAST(size_t, sy),
-                            AIR_CAST(size_t, sz))) {
-        biffMovef(BANE, NRRD, "%s: couldn't allocate 3x%dx%dx%d VGH volume",
-                  me, sx, sy, sz);
-        return 1;
-      }
-    }
-    for (z=0; z<sz; z++) {
-      for (y=0; y<sy; y++) {
-        if (hvp->verbose && !((y+sy*z)%200)) {
-          fprintf(stderr, "%s", airDoneStr(0, y+sy*z, sy*sz, prog));
-          fflush(stderr);
-        }
-        for (x=0; x<sx; x++) {
-          baneProbe(val, nin, hvp, ctx, x, y, z);
-          if (inc[0]->process[0]) inc[0]->process[0](inc[0], val[0]);
-          if (inc[1]->process[0]) inc[1]->process[0](inc[1], val[1]);
-          if (inc[2]->process[0]) inc[2]->process[0](inc[2], val[2]);
-        }
-      }
+    shr.pass = 0;
+    if (_baneHVolPass(&shr, ctx, NULL, NULL)) {
+      biffAddf(BANE, "%s: trouble with pass A", me);
+      return 1;
     }
     if (hvp->makeMeasrVol) {
       hvp->measrVolDone = AIR_TRUE;
@@ -187,30 +731,10 @@ baneFindInclusion(double min[3], double max[3],
   if (inc[0]->process[1]
       || inc[1]->process[1]
       || inc[2]->process[1]) {
-    if (hvp->makeMeasrVol && !hvp->measrVol) {
-      if (nrrdMaybeAlloc_va(hvp->measrVol=nrrdNew(), nrrdTypeFloat, 4,
-                            AIR_CAST(size_t, 3),
-                            AIR_CAST(size_t, sx),
-                            AIR_CAST(size_t, sy),
-                            AIR_CAST(size_t, sz))) {
-        biffMovef(BANE, NRRD, "%s: couldn't allocate 3x%dx%dx%d VGH volume",
-                  me, sx, sy, sz);
-        return 1;
-      }
-    }
-    for (z=0; z<sz; z++) {
-      for (y=0; y<sy; y++) {
-        if (hvp->verbose && !((y+sy*z)%200)) {
-          fprintf(stderr, "%s", airDoneStr(0, y+sy*z, sy*sz, prog));
-          fflush(stderr);
-        }
-        for (x=0; x<sx; x++) {
-          baneProbe(val, nin, hvp, ctx, x, y, z);
-          if (inc[0]->process[1]) inc[0]->process[1](inc[0], val[0]);
-          if (inc[1]->process[1]) inc[1]->process[1](inc[1], val[1]);
-          if (inc[2]->process[1]) inc[2]->process[1](inc[2], val[2]);
-        }
-      }
+    shr.pass = 1;
+    if (_baneHVolPass(&shr, ctx, NULL, NULL)) {
+      biffAddf(BANE, "%s: trouble with pass B", me);
+      return 1;
     }
     if (hvp->makeMeasrVol) {
       hvp->measrVolDone = AIR_TRUE;
@@ -267,11 +791,12 @@ baneMakeHVol(Nrrd *hvol, Nrrd *nin, baneHVolParm *hvp) {
   char prog[13];
   gageContext *ctx;
   gagePerVolume *pvl;
-  int E, sx, sy, sz, shx, shy, shz, x, y, z, hx, hy, hz,
-    *rhvdata, clipVal, hval, pad;
+  int E, sx, sy, sz, shx, shy, shz, hx, hy, hz,
+    *rhvdata, clipVal, hval, pad, size[3], ai;
   /* these are doubles because ultimately the inclusion functions
      use doubles, because I wanted the most generality */
-  double val[3], min[3], max[3];
+  double min[3], max[3];
+  _baneHVolShared shr;
   size_t hidx, included;
   float fracIncluded;
   unsigned char *nhvdata;
@@ -370,31 +895,21 @@ baneMakeHVol(Nrrd *hvol, Nrrd *nin, baneHVolParm *hvp) {
   rhvdata = (int *)rawhvol->data;
   included = 0;
 
-  for (z=pad; z<sz-pad; z++) {
-    for (y=pad; y<sy-pad; y++) {
-      if (hvp->verbose && !((y-pad+(sy-2*pad)*(z-pad))%200)) {
-        fprintf(stderr, "%s", airDoneStr(0, y-pad+(sy-2*pad)*(z-pad),
-                                         (sy-2*pad)*(sz-2*pad), prog));
-        fflush(stderr);
-      }
-      for (x=pad; x<sx-pad; x++) {
-        baneProbe(val, nin, hvp, ctx, x, y, z);
-        if (!( AIR_IN_CL(min[0], val[0], max[0]) &&
-               AIR_IN_CL(min[1], val[1], max[1]) &&
-               AIR_IN_CL(min[2], val[2], max[2]) )) {
-          continue;
-        }
-        /* else this voxel will contribute to the histovol */
-        hx = airIndex(min[0], val[0], max[0], shx);
-        hy = airIndex(min[1], val[1], max[1], shy);
-        hz = airIndex(min[2], val[2], max[2], shz);
-        hidx = hx + shx*(hy + shy*hz);
-        if (rhvdata[hidx] < INT_MAX) {
-          ++rhvdata[hidx];
-        }
-        ++included;
-      }
-    }
+  memset(&shr, 0, sizeof(shr));
+  shr.nin = nin;
+  shr.hvp = hvp;
+  shr.pass = 2;
+  ELL_3V_SET(shr.shsz, shx, shy, shz);
+  ELL_3V_COPY(shr.min, min);
+  ELL_3V_COPY(shr.max, max);
+  ELL_3V_SET(size, sx, sy, sz);
+  for (ai=0; ai<3; ai++) {
+    shr.lo[ai] = AIR_CAST(unsigned int, pad);
+    shr.hi[ai] = AIR_CAST(unsigned int, AIR_MAX(pad, size[ai] - pad));
+  }
+  if (_baneHVolPass(&shr, ctx, rhvdata, &included)) {
+    biffAddf(BANE, "%s: trouble filling histogram volume", me);
+    airMopError(mop); return 1;
   }
   fracIncluded = (float)included/((sz-2*pad)*(sy-2*pad)*(sx-2*pad));
   if (fracIncluded < hvp->incLimit) {
@@ -433,9 +948,8 @@ baneMakeHVol(Nrrd *hvol, Nrrd *nin, baneHVolParm *hvp) {
   hvol->axis[0].max = max[0];
   hvol->axis[1].max = max[1];
   hvol->axis[2].max = max[2];
-  hvol->axis[0].label = airStrdup(hvp->axis[0].measr->name);
-  hvol->axis[1].label = airStrdup(hvp->axis[1].measr->name);
-  hvol->axis[2].label = airStrdup(hvp->axis[2].measr->name);
+  nrrdAxisInfoSet_va(hvol, nrrdAxisInfoLabel, hvp->axis[0].measr->name,
+                     hvp->axis[1].measr->name, hvp->axis[2].measr->name);
   hvol->axis[0].center = nrrdCenterCell;
   hvol->axis[1].center = nrrdCenterCell;
   hvol->axis[2].center = nrrdCenterCell;
@@ -69,6 +69,45 @@ _baneIncProcess_HistFill(baneInc *inc, double val) {
   return;
 }
 
+/*
+** _baneIncMerge
+**
+** for multi-threaded measurement: each thread processes (with pass
+** passIdx) its values into its own copy "part" of the baneInc, and
+** this merges what part learned into inc
+*/
+void
+_baneIncMerge(baneInc *inc, baneInc *part, int passIdx) {
+  int *hist, *phist;
+  size_t ii, nn;
+
+  if (_baneIncProcess_LearnMinMax == inc->process[passIdx]) {
+    if (AIR_EXISTS(part->nhist->axis[0].min)) {
+      if (AIR_EXISTS(inc->nhist->axis[0].min)) {
+        inc->nhist->axis[0].min = AIR_MIN(inc->nhist->axis[0].min,
+                                          part->nhist->axis[0].min);
+        inc->nhist->axis[0].max = AIR_MAX(inc->nhist->axis[0].max,
+                                          part->nhist->axis[0].max);
+      } else {
+        inc->nhist->axis[0].min = part->nhist->axis[0].min;
+        inc->nhist->axis[0].max = part->nhist->axis[0].max;
+      }
+    }
+  } else if (_baneIncProcess_HistFill == inc->process[passIdx]) {
+    hist = (int*)inc->nhist->data;
+    phist = (int*)part->nhist->data;
+    nn = inc->nhist->axis[0].size;
+    for (ii=0; ii<nn; ii++) {
+      hist[ii] += phist[ii];
+    }
+  } else if (_baneIncProcess_Stdv == inc->process[passIdx]) {
+    inc->S += part->S;
+    inc->SS += part->SS;
+    inc->num += part->num;
+  }
+  return;
+}
+
 /*
 ** _baneIncAnswer_Absolute
 **
@@ -66,6 +66,8 @@ baneHVolParmNew() {
     hvp->renormalize = baneDefRenormalize;
     hvp->clip = NULL;
     hvp->incLimit = baneDefIncLimit;
+    hvp->numThreads = 0;
+    hvp->separable = baneDefSeparable;
   }
   return hvp;
 }
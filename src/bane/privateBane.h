@@ -28,6 +28,9 @@
 extern "C" {
 #endif
 
+/* inc.c */
+extern void _baneIncMerge(baneInc *inc, baneInc *part, int passIdx);
+
 /* hvol.c */
 extern int _baneAxisCheck(baneAxis *axis);
 
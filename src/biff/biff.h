@@ -124,6 +124,7 @@ __attribute__ ((format(printf,3,4)))
 #endif
 ;
 BIFF_EXPORT void biffSetStrDone(char *str, const char *key);
+BIFF_EXPORT int biffThreadLocalSet(int local);
 /* ---- END non-NrrdIO */
 BIFF_EXPORT void biffDone(const char *key);
 BIFF_EXPORT char *biffGetDone(const char *key);
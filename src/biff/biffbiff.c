@@ -32,12 +32,104 @@
 #  define snprintf _snprintf
 #endif
 
-static biffMsg **
-_bmsg=NULL;            /* master array of biffMsg pointers */
-static unsigned int
-_bmsgNum=0;            /* length of _biffErr == # keys maintained */
-static airArray *
-_bmsgArr=NULL;         /* air array of _biffErr and _biffNum */
+/*
+** The biffMsgs for all the keys are kept in a _biffStore.  By default,
+** all threads share one process-wide store.  A thread whose errors
+** should be kept apart from those of other threads can get its own
+** store with biffThreadLocalSet().  Threads started with airThreadStart
+** (which includes all the threads started within Teem) begin with the
+** store of the thread that started them, so that the messages from
+** library worker threads end up where their caller will look for them.
+** Every store has its own mutex (when multi-threading is available),
+** so access to a store is only contended by the threads sharing it.
+*/
+typedef struct {
+  biffMsg **bmsg;        /* array of biffMsg pointers */
+  unsigned int bmsgNum;  /* length of bmsg == # keys maintained */
+  airArray *bmsgArr;     /* air array of bmsg and bmsgNum */
+  /* ---- BEGIN non-NrrdIO */
+  airThreadMutex *mutex; /* serializes access to this store */
+  /* ---- END non-NrrdIO */
+} _biffStore;
+
+static _biffStore
+_bstore;                   /* the process-wide store (all zero/NULL
+                              until first used, as with any static) */
+
+/* ---- BEGIN non-NrrdIO */
+static airThreadKey *
+_bthreadKey=NULL;          /* the store each thread uses, if not _bstore;
+                              inherited by new threads */
+static airThreadKey *
+_bthreadOwnKey=NULL;       /* the store (if any) each thread created with
+                              biffThreadLocalSet, and will free */
+static int
+_bthreadBroken=AIR_FALSE;  /* couldn't set up the above */
+
+static void
+_bthreadInit(void) {
+  static const char me[]="[biff] _bthreadInit";
+
+  _bstore.mutex = airThreadMutexNew();
+  _bthreadKey = airThreadKeyNew();
+  _bthreadOwnKey = airThreadKeyNew();
+  if (!_bstore.mutex) {
+    fprintf(stderr, "%s: PANIC: couldn't allocate mutex; biff is NOT "
+            "thread-safe\n", me);
+    _bthreadBroken = AIR_TRUE;
+  }
+  if (!(_bthreadKey && _bthreadOwnKey)
+      || airThreadKeyInheritSet(_bthreadKey, AIR_TRUE)) {
+    fprintf(stderr, "%s: PANIC: couldn't allocate thread keys; "
+            "biffThreadLocalSet won't work\n", me);
+    _bthreadKey = airThreadKeyNix(_bthreadKey);
+    _bthreadOwnKey = airThreadKeyNix(_bthreadOwnKey);
+    _bthreadBroken = AIR_TRUE;
+  }
+  return;
+}
+/* ---- END non-NrrdIO */
+
+/*
+** _bstoreGrab()
+**
+** returns the store that the calling thread uses, after locking it.
+** Every call must be matched by a call to _bstoreLetGo().
+*/
+static _biffStore *
+_bstoreGrab(void) {
+  _biffStore *store;
+
+  store = &_bstore;
+  /* ---- BEGIN non-NrrdIO */
+  if (airThreadCapable) {
+    _biffStore *local;
+    airThreadOnce(airThreadOnceBiff, _bthreadInit);
+    local = (_bthreadKey
+             ? AIR_CAST(_biffStore *, airThreadKeyGet(_bthreadKey))
+             : NULL);
+    if (local) {
+      store = local;
+    }
+    if (store->mutex) {
+      airThreadMutexLock(store->mutex);
+    }
+  }
+  /* ---- END non-NrrdIO */
+  return store;
+}
+
+static void
+_bstoreLetGo(_biffStore *store) {
+
+  AIR_UNUSED(store);
+  /* ---- BEGIN non-NrrdIO */
+  if (airThreadCapable && store->mutex) {
+    airThreadMutexUnlock(store->mutex);
+  }
+  /* ---- END non-NrrdIO */
+  return;
+}
 
 #define __INCR 2
 
@@ -55,31 +147,32 @@ typedef union {
 ** NOTE: Can be harmlessly called multiple times.
 */
 static void
-_bmsgStart(void) {
+_bmsgStart(_biffStore *store) {
   static const char me[]="[biff] _bmsgStart";
   _beu uu;
 
-  if (_bmsgArr) {
+  if (store->bmsgArr) {
     /* its non-NULL, must have been called already */
     return;
   }
-  uu.b = &_bmsg;
-  _bmsgArr = airArrayNew(uu.v, &_bmsgNum, sizeof(biffMsg*), __INCR);
-  if (!_bmsgArr) {
+  uu.b = &(store->bmsg);
+  store->bmsgArr = airArrayNew(uu.v, &(store->bmsgNum),
+                               sizeof(biffMsg*), __INCR);
+  if (!store->bmsgArr) {
     fprintf(stderr, "%s: PANIC: couldn't allocate internal data\n", me);
     /* exit(1); */
   }
-  /* airArrayPointerCB(_bmsgArr, NULL, (airMopper)biffMsgNix);*/
+  /* airArrayPointerCB(store->bmsgArr, NULL, (airMopper)biffMsgNix);*/
   return;
 }
 
 static void
-_bmsgFinish(void) {
+_bmsgFinish(_biffStore *store) {
 
-  if (_bmsgArr) {
-    /* setting _bmsgArr to NULL is needed to put biff back in initial state
+  if (store->bmsgArr) {
+    /* setting bmsgArr to NULL is needed to put biff back in initial state
        so that next calls to biff re-trigger _bmsgStart() */
-    _bmsgArr = airArrayNuke(_bmsgArr);
+    store->bmsgArr = airArrayNuke(store->bmsgArr);
   }
   return;
 }
@@ -87,11 +180,11 @@ _bmsgFinish(void) {
 /*
 ** _bmsgFind()
 **
-** returns the biffMsg (in _bmsg) of the entry with the given key, or
-** NULL if it was not found
+** returns the biffMsg (in store->bmsg) of the entry with the given key,
+** or NULL if it was not found
 */
 static biffMsg *
-_bmsgFind(const char *key) {
+_bmsgFind(_biffStore *store, const char *key) {
   static const char me[]="[biff] _bmsgFind";
   biffMsg *msg;
   unsigned int ii;
@@ -101,10 +194,10 @@ _bmsgFind(const char *key) {
     return NULL; /* exit(1); */
   }
   msg = NULL;
-  if (_bmsgNum) {
-    for (ii=0; ii<_bmsgNum; ii++) {
-      if (!strcmp(_bmsg[ii]->key, key)) {
-        msg = _bmsg[ii];
+  if (store->bmsgNum) {
+    for (ii=0; ii<store->bmsgNum; ii++) {
+      if (!strcmp(store->bmsg[ii]->key, key)) {
+        msg = store->bmsg[ii];
         break;
       }
     }
@@ -113,14 +206,14 @@ _bmsgFind(const char *key) {
 }
 
 /*
-** assumes that msg really is in _bmsg[]
+** assumes that msg really is in store->bmsg[]
 */
 static unsigned int
-_bmsgFindIdx(biffMsg *msg) {
+_bmsgFindIdx(_biffStore *store, biffMsg *msg) {
   unsigned int ii;
 
-  for (ii=0; ii<_bmsgNum; ii++) {
-    if (msg == _bmsg[ii]) {
+  for (ii=0; ii<store->bmsgNum; ii++) {
+    if (msg == store->bmsg[ii]) {
       break;
     }
   }
@@ -130,32 +223,32 @@ _bmsgFindIdx(biffMsg *msg) {
 /*
 ** _bmsgAdd()
 **
-** if given key already has a biffMsg in _bmsg, returns that.
-** otherise, adds a new biffMsg for given key to _bmsg, and returns it
-** panics if there is a problem
+** if given key already has a biffMsg in store->bmsg, returns that.
+** otherise, adds a new biffMsg for given key to store->bmsg, and returns
+** it panics if there is a problem
 */
 static biffMsg *
-_bmsgAdd(const char *key) {
+_bmsgAdd(_biffStore *store, const char *key) {
   static const char me[]="[biff] _bmsgAdd";
   unsigned int ii;
   biffMsg *msg;
 
   msg = NULL;
   /* find if key exists already */
-  for (ii=0; ii<_bmsgNum; ii++) {
-    if (!strcmp(key, _bmsg[ii]->key)) {
-      msg = _bmsg[ii];
+  for (ii=0; ii<store->bmsgNum; ii++) {
+    if (!strcmp(key, store->bmsg[ii]->key)) {
+      msg = store->bmsg[ii];
       break;
     }
   }
   if (!msg) {
     /* have to add new biffMsg */
-    ii = airArrayLenIncr(_bmsgArr, 1);
-    if (!_bmsg) {
+    ii = airArrayLenIncr(store->bmsgArr, 1);
+    if (!store->bmsg) {
       fprintf(stderr, "%s: PANIC: couldn't accommodate one more key\n", me);
       return NULL; /* exit(1); */
     }
-    msg = _bmsg[ii] = biffMsgNew(key);
+    msg = store->bmsg[ii] = biffMsgNew(key);
   }
   return msg;
 }
@@ -173,21 +266,27 @@ _bmsgAdd(const char *key) {
 */
 void
 biffAdd(const char *key, const char *err) {
+  _biffStore *store;
   biffMsg *msg;
 
-  _bmsgStart();
-  msg = _bmsgAdd(key);
+  store = _bstoreGrab();
+  _bmsgStart(store);
+  msg = _bmsgAdd(store, key);
   biffMsgAdd(msg, err);
+  _bstoreLetGo(store);
   return;
 }
 
 static void
 _biffAddVL(const char *key, const char *errfmt, va_list args) {
+  _biffStore *store;
   biffMsg *msg;
 
-  _bmsgStart();
-  msg = _bmsgAdd(key);
+  store = _bstoreGrab();
+  _bmsgStart(store);
+  msg = _bmsgAdd(store, key);
   _biffMsgAddVL(msg, errfmt, args);
+  _bstoreLetGo(store);
   return;
 }
 
@@ -257,22 +356,14 @@ biffMaybeAddf(int useBiff, const char *key, const char *errfmt, ...) {
 }
 
 
-/*
-******** biffGet()
-**
-** creates a string which records all the errors at given key and
-** returns it.  Returns NULL in case of error.  This function should
-** be considered a glorified strdup(): it is the callers responsibility
-** to free() this string later
-*/
-char * /*Teem: allocates char* */     /* this comment is an experiment */
-biffGet(const char *key) {
+static char *
+_biffGet(_biffStore *store, const char *key) {
   static const char me[]="biffGet";
   char *ret;
   biffMsg *msg;
 
-  _bmsgStart();
-  msg = _bmsgFind(key);
+  _bmsgStart(store);
+  msg = _bmsgFind(store, key);
   if (!msg) {
     static const char err[]="[%s] No information for this key!";
     size_t errlen;
@@ -296,6 +387,25 @@ biffGet(const char *key) {
   return ret;
 }
 
+/*
+******** biffGet()
+**
+** creates a string which records all the errors at given key and
+** returns it.  Returns NULL in case of error.  This function should
+** be considered a glorified strdup(): it is the callers responsibility
+** to free() this string later
+*/
+char * /*Teem: allocates char* */     /* this comment is an experiment */
+biffGet(const char *key) {
+  _biffStore *store;
+  char *ret;
+
+  store = _bstoreGrab();
+  ret = _biffGet(store, key);
+  _bstoreLetGo(store);
+  return ret;
+}
+
 /*
 ******** biffGetStrlen()
 **
@@ -305,29 +415,27 @@ biffGet(const char *key) {
 unsigned int
 biffGetStrlen(const char *key) {
   static const char me[]="biffGetStrlen";
+  _biffStore *store;
   biffMsg *msg;
   unsigned int len;
 
-  _bmsgStart();
-  msg = _bmsgFind(key);
+  store = _bstoreGrab();
+  _bmsgStart(store);
+  msg = _bmsgFind(store, key);
   if (!msg) {
     fprintf(stderr, "%s: WARNING: no information for key \"%s\"\n", me, key);
+    _bstoreLetGo(store);
     return 0;
   }
   len = biffMsgStrlen(msg);
   len += 1;  /* GLK forgets if the convention is that the caller allocates
                 for one more to include '\0'; this is safer */
+  _bstoreLetGo(store);
   return len;
 }
 
-/*
-******** biffSetStr()
-**
-** for when you want to allocate the buffer for the biff string, this is
-** how you get the error message itself
-*/
-void
-biffSetStr(char *str, const char *key) {
+static void
+_biffSetStr(_biffStore *store, char *str, const char *key) {
   static const char me[]="biffSetStr";
   biffMsg *msg;
 
@@ -336,8 +444,8 @@ biffSetStr(char *str, const char *key) {
     return;
   }
 
-  _bmsgStart();
-  msg = _bmsgFind(key);
+  _bmsgStart(store);
+  msg = _bmsgFind(store, key);
   if (!msg) {
     fprintf(stderr, "%s: WARNING: no information for key \"%s\"\n", me, key);
     return;
@@ -347,6 +455,22 @@ biffSetStr(char *str, const char *key) {
   return;
 }
 
+/*
+******** biffSetStr()
+**
+** for when you want to allocate the buffer for the biff string, this is
+** how you get the error message itself
+*/
+void
+biffSetStr(char *str, const char *key) {
+  _biffStore *store;
+
+  store = _bstoreGrab();
+  _biffSetStr(store, str, key);
+  _bstoreLetGo(store);
+  return;
+}
+
 /*
 ******** biffCheck()
 **
@@ -355,59 +479,78 @@ biffSetStr(char *str, const char *key) {
 */
 unsigned int
 biffCheck(const char *key) {
+  _biffStore *store;
+  unsigned int ret;
 
-  _bmsgStart();
-  return biffMsgErrNum(_bmsgFind(key));
+  store = _bstoreGrab();
+  _bmsgStart(store);
+  ret = biffMsgErrNum(_bmsgFind(store, key));
+  _bstoreLetGo(store);
+  return ret;
 }
 
-/*
-******** biffDone()
-**
-** frees everything associated with given key, and shrinks list of keys,
-** and calls _bmsgFinish() if there are no keys left
-*/
-void
-biffDone(const char *key) {
+static void
+_biffDone(_biffStore *store, const char *key) {
   static const char me[]="biffDone";
   unsigned int idx;
   biffMsg *msg;
 
-  _bmsgStart();
+  _bmsgStart(store);
 
-  msg = _bmsgFind(key);
+  msg = _bmsgFind(store, key);
   if (!msg) {
     fprintf(stderr, "%s: WARNING: no information for key \"%s\"\n", me, key);
     return;
   }
-  idx = _bmsgFindIdx(msg);
+  idx = _bmsgFindIdx(store, msg);
   biffMsgNix(msg);
-  if (_bmsgNum > 1) {
+  if (store->bmsgNum > 1) {
     /* if we have more than one key in action, move the last biffMsg
        to the position that was just cleared up */
-    _bmsg[idx] = _bmsg[_bmsgNum-1];
+    store->bmsg[idx] = store->bmsg[store->bmsgNum-1];
   }
-  airArrayLenIncr(_bmsgArr, -1);
+  airArrayLenIncr(store->bmsgArr, -1);
   /* if that was the last key, close shop */
-  if (!_bmsgArr->len) {
-    _bmsgFinish();
+  if (!store->bmsgArr->len) {
+    _bmsgFinish(store);
   }
 
   return;
 }
 
+/*
+******** biffDone()
+**
+** frees everything associated with given key, and shrinks list of keys,
+** and calls _bmsgFinish() if there are no keys left
+*/
+void
+biffDone(const char *key) {
+  _biffStore *store;
+
+  store = _bstoreGrab();
+  _biffDone(store, key);
+  _bstoreLetGo(store);
+  return;
+}
+
 void
 biffMove(const char *destKey, const char *err, const char *srcKey) {
   static const char me[]="biffMove";
+  _biffStore *store;
   biffMsg *dest, *src;
 
-  _bmsgStart();
-  dest = _bmsgAdd(destKey);
-  src = _bmsgFind(srcKey);
+  store = _bstoreGrab();
+  _bmsgStart(store);
+  dest = _bmsgAdd(store, destKey);
+  src = _bmsgFind(store, srcKey);
   if (!src) {
     fprintf(stderr, "%s: WARNING: key \"%s\" unknown\n", me, srcKey);
+    _bstoreLetGo(store);
     return;
   }
   biffMsgMove(dest, src, err);
+  _bstoreLetGo(store);
   return;
 }
 
@@ -415,16 +558,20 @@ static void
 _biffMoveVL(const char *destKey, const char *srcKey,
             const char *errfmt, va_list args) {
   static const char me[]="biffMovev";
+  _biffStore *store;
   biffMsg *dest, *src;
 
-  _bmsgStart();
-  dest = _bmsgAdd(destKey);
-  src = _bmsgFind(srcKey);
+  store = _bstoreGrab();
+  _bmsgStart(store);
+  dest = _bmsgAdd(store, destKey);
+  src = _bmsgFind(store, srcKey);
   if (!src) {
     fprintf(stderr, "%s: WARNING: key \"%s\" unknown\n", me, srcKey);
+    _bstoreLetGo(store);
     return;
   }
   _biffMsgMoveVL(dest, src, errfmt, args);
+  _bstoreLetGo(store);
   return;
 }
 
@@ -441,12 +588,13 @@ biffMovef(const char *destKey, const char *srcKey,
 
 char *
 biffGetDone(const char *key) {
+  _biffStore *store;
   char *ret;
 
-  _bmsgStart();
-
-  ret = biffGet(key);
-  biffDone(key);  /* will call _bmsgFinish if this is the last key */
+  store = _bstoreGrab();
+  ret = _biffGet(store, key);
+  _biffDone(store, key);  /* will call _bmsgFinish if this is the last key */
+  _bstoreLetGo(store);
 
   return ret;
 }
@@ -454,13 +602,93 @@ biffGetDone(const char *key) {
 /* ---- BEGIN non-NrrdIO */
 void
 biffSetStrDone(char *str, const char *key) {
+  _biffStore *store;
 
-  _bmsgStart();
-
-  biffSetStr(str, key);
-  biffDone(key);  /* will call _bmsgFinish if this is the last key */
+  store = _bstoreGrab();
+  _biffSetStr(store, str, key);
+  _biffDone(store, key);  /* will call _bmsgFinish if this is the last key */
+  _bstoreLetGo(store);
 
   return;
 }
+
+/*
+******** biffThreadLocalSet()
+**
+** With non-zero "local", gives the calling thread its own store of
+** biff messages (if it didn't already create one), so that all its biff
+** calls, with any key, neither see nor disturb those of other threads.
+** With zero "local", frees the store that the calling thread created
+** (if any), along with any messages left in it, and the thread goes
+** back to using the process-wide store that all threads share by
+** default.  A thread should do this before exiting, or its store is
+** leaked.
+**
+** Threads that a thread starts with airThreadStart (including those
+** started within Teem libraries, such as the workers of nrrd, gage,
+** pull, and ten) use the same store as the thread that started them,
+** so a caller with its own store sees all the messages that come from
+** the work it asked for.  The caller must not free its store (with
+** biffThreadLocalSet(AIR_FALSE)) while those threads are running.  A
+** started thread can still get a store of its own with this function.
+**
+** Without multi-threading, this does nothing.  Returns non-zero (with
+** a message to stderr) if there was a problem.
+*/
+int
+biffThreadLocalSet(int local) {
+  static const char me[]="biffThreadLocalSet";
+  _biffStore *own;
+  unsigned int ii;
+
+  if (!airThreadCapable) {
+    return 0;
+  }
+  airThreadOnce(airThreadOnceBiff, _bthreadInit);
+  if (_bthreadBroken) {
+    fprintf(stderr, "%s: ERROR: thread state not available\n", me);
+    return 1;
+  }
+  own = AIR_CAST(_biffStore *, airThreadKeyGet(_bthreadOwnKey));
+  if (local) {
+    if (!own) {
+      own = AIR_CALLOC(1, _biffStore);
+      if (!own) {
+        fprintf(stderr, "%s: ERROR: couldn't allocate store\n", me);
+        return 1;
+      }
+      if (!(own->mutex = airThreadMutexNew())) {
+        fprintf(stderr, "%s: ERROR: couldn't allocate mutex\n", me);
+        free(own);
+        return 1;
+      }
+      if (airThreadKeySet(_bthreadOwnKey, own)) {
+        fprintf(stderr, "%s: ERROR: couldn't set store\n", me);
+        airThreadMutexNix(own->mutex);
+        free(own);
+        return 1;
+      }
+    }
+    if (airThreadKeySet(_bthreadKey, own)) {
+      fprintf(stderr, "%s: ERROR: couldn't set store\n", me);
+      return 1;
+    }
+  } else {
+    if (airThreadKeySet(_bthreadKey, NULL)
+        || airThreadKeySet(_bthreadOwnKey, NULL)) {
+      fprintf(stderr, "%s: ERROR: couldn't unset store\n", me);
+      return 1;
+    }
+    if (own) {
+      for (ii=0; ii<own->bmsgNum; ii++) {
+        biffMsgNix(own->bmsg[ii]);
+      }
+      _bmsgFinish(own);
+      airThreadMutexNix(own->mutex);
+      free(own);
+    }
+  }
+  return 0;
+}
 /* ---- END non-NrrdIO */
 /* this is the end */
@@ -34,6 +34,8 @@ main(int argc, const char **argv) {
   airArray *mop;
 
   me = argv[0];
+  /* for the number of threads, as in tend and unu */
+  nrrdStateGetenv();
   /* no harm done in making sure we're sane */
   if (!nrrdSanity()) {
     fprintf(stderr, "******************************************\n");
@@ -41,12 +41,14 @@ main(int argc, const char *argv[]) {
   NrrdKernelSpec *ksp;
   mossSampler *msp;
   double mat[6], **matList, *origInfo, origMat[6], origInvMat[6], ox, oy,
-    min[2], max[2];
+    min[2], max[2], scale[4];
   int d, bound, ax0, size[2]; /* HEY size[] should be size_t */
-  unsigned int matListLen, _bkgLen, i, avgNum;
-  float *bkg, *_bkg, scale[4];
+  unsigned int matListLen, _bkgLen, i, avgNum, numThreads;
+  float *bkg, *_bkg;
 
   me = argv[0];
+  /* for the number of threads, as in tend and unu */
+  nrrdStateGetenv();
   mop = airMopNew();
   hparm = hestParmNew();
   airMopAdd(mop, hparm, (airMopper)hestParmFree, airMopAlways);
@@ -108,6 +110,10 @@ main(int argc, const char *argv[]) {
   hestOptAdd(&hopt, "a", "avg #", airTypeUInt, 1, 1, &avgNum, "0",
              "number of averages (if there there is only one "
              "rotation)");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &numThreads, "0",
+             "number of threads to compute output rows with, or 0 to use "
+             "the NRRD_STATE_NUM_THREADS environment variable "
+             "(or 1 if that isn't set)");
   hestOptAdd(&hopt, "o", "filename", airTypeString, 1, 1, &outS, "-",
              "file to write output nrrd to");
   hestParseOrDie(hopt, argc-1, argv+1, hparm,
@@ -122,6 +128,9 @@ main(int argc, const char *argv[]) {
   msp = mossSamplerNew();
   airMopAdd(mop, msp, (airMopper)mossSamplerNix, airMopAlways);
   msp->boundary = bound;
+  if (numThreads) {
+    nrrdStateNumThreads = numThreads;
+  }
   if (mossSamplerKernelSet(msp, ksp->kernel, ksp->parm)) {
     fprintf(stderr, "%s: trouble with sampler:\n%s\n",
             me, errS = biffGetDone(MOSS)); free(errS);
@@ -161,15 +170,15 @@ main(int argc, const char *argv[]) {
     fprintf(stderr, "%s: scale[0 + 2*%d] = %d\n", me, d,
             AIR_CAST(int, scale[0 + 2*d]));
     switch(AIR_CAST(int, scale[0 + 2*d])) {
-    case 0:
+    case unrrduScaleNothing:
       /* same number of samples as input */
       size[d] = AIR_CAST(int, nin->axis[ax0+d].size);
       break;
-    case 1:
+    case unrrduScaleMultiply:
       /* scaling of input # samples */
       size[d] = AIR_CAST(int, scale[1 + 2*d]*nin->axis[ax0+d].size);
       break;
-    case 2:
+    case unrrduScaleExact:
       /* explicit # of samples */
       size[d] = AIR_CAST(int, scale[1 + 2*d]);
       break;
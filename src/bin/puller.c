@@ -712,6 +712,80 @@ save_cb(fltk::Widget *, pullBag *bag) {
 
 #endif  /* DEFT */
 
+/*
+** what checkpoint_cb needs: the callback (if any) that was set before
+** "-ckpt" asked for checkpoints, which is called in turn
+*/
+typedef struct {
+  pullContext *pctx;
+  unsigned int period,          /* # iters between checkpoints */
+    cbPeriod;                   /* # iters between calls to cb */
+  void (*cb)(void *data);
+  void *cbData;
+} checkpointInfo;
+
+/*
+** with "-ckpt", called every so many iterations from pullRun to save
+** a snapshot, from which "-resume" can carry on. The snapshot is
+** written to a temporary file which is then renamed, so that an
+** interrupted save doesn't leave a partial ckpt.NNNNNN.pull behind.
+*/
+void
+checkpoint_cb(void *_cki) {
+  static const char me[]="checkpoint_cb";
+  checkpointInfo *cki;
+  pullContext *pctx;
+  char fname[AIR_STRLEN_MED], tname[AIR_STRLEN_MED], *err;
+  FILE *file;
+  int bad;
+
+  cki = AIR_CAST(checkpointInfo *, _cki);
+  pctx = cki->pctx;
+  if (cki->cb && !(pctx->iter % cki->cbPeriod)) {
+    cki->cb(cki->cbData);
+  }
+  if (pctx->iter % cki->period) {
+    return;
+  }
+  sprintf(fname, "ckpt.%06u.pull", pctx->iter);
+  sprintf(tname, "ckpt.%06u.pull.tmp", pctx->iter);
+  if (!(file = fopen(tname, "wb"))) {
+    fprintf(stderr, "%s: couldn't open %s for writing\n", me, tname);
+    return;
+  }
+  bad = AIR_FALSE;
+  if (pullContextSnapshotWrite(file, pctx)) {
+    err = biffGetDone(PULL);
+    fprintf(stderr, "%s: trouble saving %s:\n%s", me, tname, err);
+    free(err);
+    bad = AIR_TRUE;
+  }
+  if (fclose(file)) {
+    fprintf(stderr, "%s: trouble closing %s\n", me, tname);
+    bad = AIR_TRUE;
+  }
+  if (bad) {
+    remove(tname);
+  } else if (rename(tname, fname)) {
+    fprintf(stderr, "%s: couldn't rename %s to %s\n", me, tname, fname);
+    remove(tname);
+  }
+  return;
+}
+
+/* greatest common divisor, for the callback period with "-ckpt" */
+static unsigned int
+gcdUI(unsigned int aa, unsigned int bb) {
+  unsigned int tt;
+
+  while (bb) {
+    tt = aa % bb;
+    aa = bb;
+    bb = tt;
+  }
+  return aa;
+}
+
 int
 main(int argc, const char **argv) {
   hestOpt *hopt=NULL;
@@ -730,7 +804,8 @@ main(int argc, const char **argv) {
   pullBag bag;
 #endif
 
-  char *err, *outS, *extraOutBaseS, *addLogS, *cachePathSS;
+  char *err, *outS, *extraOutBaseS, *addLogS, *cachePathSS, *resumeS;
+  checkpointInfo ckptInfo;
   FILE *addLog;
   meetPullVol **vspec;
   meetPullInfo **idef;
@@ -741,7 +816,7 @@ main(int argc, const char **argv) {
   pullContext *pctx;
   int E=0, ret=0;
   unsigned int vspecNum, idefNum;
-  double scaleVec[3], glyphScaleRad;
+  double scaleVec[3], glyphScaleRad, cacheSizeMaxSS;
   /* things that used to be set directly inside pullContext */
   int energyFromStrength, nixAtVolumeEdgeSpace, constraintBeforeSeedThresh,
     binSingle, liveThresholdOnInit, permuteOnRebin, noPopCntlWithZeroAlpha,
@@ -751,7 +826,7 @@ main(int argc, const char **argv) {
   int interType, allowCodimension3Constraints, scaleIsTau, useHalton,
     pointPerVoxel;
   unsigned int samplesAlongScaleNum, pointNumInitial,
-    ppvZRange[2], snap, iterMax, stuckIterMax, constraintIterMax,
+    ppvZRange[2], snap, ckpt, iterMax, stuckIterMax, constraintIterMax,
     popCntlPeriod, addDescent, iterCallback, rngSeed, progressBinMod,
     threadNum, eipHalfLife, kssOpi, kssFinished, bspOpi, bspFinished;
   double jitter, stepInitial, constraintStepMin, radiusSpace, binWidthSpace,
@@ -935,6 +1010,10 @@ main(int argc, const char **argv) {
   hestOptAdd(&hopt, "sscp", "path", airTypeString, 1, 1, &cachePathSS, "./",
              "path (without trailing /) for where to read/write "
              "pre-blurred volumes for scale-space");
+  hestOptAdd(&hopt, "sscm", "MB", airTypeDouble, 1, 1, &cacheSizeMaxSS,
+             "0", "size budget (in megabytes) for the pre-blurred volumes "
+             "kept in the \"-sscp\" path; the least recently used ones are "
+             "removed to stay within budget. 0 means no limit");
   kssOpi =
   hestOptAdd(&hopt, "kssb", "kernel", airTypeOther, 1, 1, &kSSblur,
              "dgauss:1,5", "default blurring kernel, to sample scale space",
@@ -981,6 +1060,16 @@ main(int argc, const char **argv) {
   hestOptAdd(&hopt, "snap", "# iters", airTypeUInt, 1, 1,
              &snap, "0",
              "if non-zero, # iters between saved snapshots");
+  hestOptAdd(&hopt, "ckpt", "# iters", airTypeUInt, 1, 1,
+             &ckpt, "0",
+             "if non-zero, # iters between saving the whole state of the "
+             "system (to ckpt.NNNNNN.pull), from which \"-resume\" can "
+             "carry on the computation");
+  hestOptAdd(&hopt, "resume", "ckpt", airTypeString, 1, 1,
+             &resumeS, "",
+             "if non-empty, a file saved via \"-ckpt\", from which to "
+             "resume the computation, instead of initializing points. "
+             "All other options should be the same as when it was saved.");
   hestOptAdd(&hopt, "maxi", "# iters", airTypeUInt, 1, 1,
              &iterMax, "0",
              "if non-zero, max # iterations to run whole system");
@@ -1146,7 +1235,10 @@ main(int argc, const char **argv) {
       || pullIterParmSet(pctx, pullIterParmConstraintMax, constraintIterMax)
       || pullIterParmSet(pctx, pullIterParmPopCntlPeriod, popCntlPeriod)
       || pullIterParmSet(pctx, pullIterParmAddDescent, addDescent)
-      || pullIterParmSet(pctx, pullIterParmCallback, iterCallback)
+      || pullIterParmSet(pctx, pullIterParmCallback,
+                         (ckpt
+                          ? gcdUI(ckpt, AIR_MAX(1, iterCallback))
+                          : iterCallback))
       || pullIterParmSet(pctx, pullIterParmEnergyIncreasePermitHalfLife,
                          eipHalfLife)
       || pullSysParmSet(pctx, pullSysParmStepInitial, stepInitial)
@@ -1202,7 +1294,8 @@ main(int argc, const char **argv) {
   if (meetPullVolStackBlurParmFinishMulti(vspec, vspecNum,
                                           &kssFinished, &bspFinished,
                                           kSSblur, bspec)
-      || meetPullVolLoadMulti(vspec, vspecNum, cachePathSS, verbose)
+      || meetPullVolLoadMulti(vspec, vspecNum, cachePathSS,
+                              cacheSizeMaxSS, verbose)
       || meetPullVolAddMulti(pctx, vspec, vspecNum,
                              k00, k11, k22, kSSrecon)
       || meetPullInfoAddMulti(pctx, idef, idefNum)) {
@@ -1220,11 +1313,36 @@ main(int argc, const char **argv) {
             "meetPullVol specified boundary specs\n\n\n", me,
             hopt[bspOpi].flag);
   }
+  if (airStrlen(resumeS)) {
+    pullFlagSet(pctx, pullFlagStartSkipsPoints, AIR_TRUE);
+  }
   if (pullStart(pctx)) {
     airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble starting system:\n%s", me, err);
     airMopError(mop); return 1;
   }
+  if (airStrlen(resumeS)) {
+    FILE *resumeFile;
+    if (!(resumeFile = airFopen(resumeS, stdin, "rb"))) {
+      fprintf(stderr, "%s: couldn't open %s for reading\n", me, resumeS);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, resumeFile, (airMopper)airFclose, airMopAlways);
+    if (pullContextSnapshotRead(pctx, resumeFile)) {
+      airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble resuming from %s:\n%s", me, resumeS, err);
+      airMopError(mop); return 1;
+    }
+  }
+  if (ckpt) {
+    /* chain to whatever callback is already set */
+    ckptInfo.pctx = pctx;
+    ckptInfo.period = ckpt;
+    ckptInfo.cbPeriod = AIR_MAX(1, iterCallback);
+    ckptInfo.cb = pctx->iter_cb;
+    ckptInfo.cbData = pctx->data_cb;
+    pullCallbackSet(pctx, checkpoint_cb, &ckptInfo);
+  }
 
   /* -------------------------------------------------- */
 
@@ -1681,7 +1799,13 @@ main(int argc, const char **argv) {
   } else {
 
     /* set up callbacks in pull */
-    pullCallbackSet(pctx, iter_cb, &bag);
+    if (ckpt) {
+      /* checkpoint_cb calls iter_cb in turn */
+      ckptInfo.cb = iter_cb;
+      ckptInfo.cbData = &bag;
+    } else {
+      pullCallbackSet(pctx, iter_cb, &bag);
+    }
 
     /* this returns when the user quits */
     ret = fltk::run();
@@ -43,7 +43,7 @@ main(int argc, const char *argv[]) {
 
   char *outS;
   alanContext *actx;
-  int *size, sizeLen, fi, si, wrap, nt, cfn, ha, maxi;
+  int *size, sizeLen, fi, si, wrap, nt, cfn, ha, maxi, ib, ss;
   unsigned int srnd;
   double deltaT, mch, xch, alphabeta[2], time0, time1, deltaX, react, rrange;
   Nrrd *ninit=NULL, *nten=NULL, *nparm=NULL;
@@ -107,6 +107,14 @@ main(int argc, const char *argv[]) {
               : "number of \"threads\" to use in computation, which is "
               "moot here because this Teem build doesn't support "
               "multi-threading. "));
+  hestOptAdd(&hopt, "ib", "# iter", airTypeInt, 1, 1, &ib, "1",
+             "number of iterations to do on each slab of the texture "
+             "while it is in cache, before moving on to the next.  With "
+             "more than 1, convergence and divergence are only checked "
+             "(and frames and snapshots only saved) every so often");
+  hestOptAdd(&hopt, "ss", "# rows", airTypeInt, 1, 1, &ss, "0",
+             "number of rows (2D) or slices (3D) per slab, or \"0\" to "
+             "pick based on texture size");
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, NULL,
              "filename for output of final converged (two-channel) texture");
   hestParseOrDie(hopt, argc-1, argv+1, NULL,
@@ -152,6 +160,8 @@ main(int argc, const char *argv[]) {
       || alanParmSet(actx, alanParmConstantFilename, cfn)
       || alanParmSet(actx, alanParmWrapAround, wrap)
       || alanParmSet(actx, alanParmHomogAniso, ha)
+      || alanParmSet(actx, alanParmIterBlock, ib)
+      || alanParmSet(actx, alanParmSlabSize, ss)
       || alanParmSet(actx, alanParmNumThreads, nt)) {
     airMopAdd(mop, err = biffGetDone(ALAN), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble setting parameters:\n%s\n", me, err);
@@ -148,6 +148,16 @@ typedef struct {
                                          coil_t **iv3, double spacing[3],
                                          double parm[COIL_PARMS_NUM]);
   void (*update)(coil_t *val, coil_t *delta); /* how to apply update */
+                                    /* optional row-wise versions of filter[],
+                                       for radius 1 and valLen 1: sets
+                                       delta[0..sizeX-1] from the 3x3 rows
+                                       row[yi + 3*zi] around the current one,
+                                       each of which may also be indexed at
+                                       -1 and sizeX.  buff is sizeX+1 long */
+  void (*filterRow[COIL_METHOD_TYPE_MAX+1])(coil_t *delta, coil_t **row,
+                                            coil_t *buff, unsigned int sizeX,
+                                            double spacing[3],
+                                            double parm[COIL_PARMS_NUM]);
 } coilKind;
 
 struct coilContext_t;
@@ -169,6 +179,11 @@ typedef struct {
                                    /* how to fill iv3 */
   void (*iv3Fill)(coil_t **iv3, coil_t *here, unsigned int radius, int valLen,
                   int x0, int y0, int z0, int sizeX, int sizeY, int sizeZ);
+  coil_t *slab[2],                 /* with row path: two time levels of the
+                                      current slab and its ghost slices, each
+                                      row padded by one value on both ends */
+    *rowDelta, *rowBuff;           /* with row path: output and scratch of
+                                      kind->filterRow */
   void *returnPtr;                 /* for airThreadJoin */
 } coilTask;
 
@@ -190,6 +205,15 @@ typedef struct coilContext_t {
   double parm[COIL_PARMS_NUM];     /* all the parameters used to control the
                                       action of the filtering.  The timestep is
                                       probably the first value. */
+  int rowPath;                     /* if kind->filterRow[] has the method,
+                                      process whole X rows at a time, instead
+                                      of one iv3 neighborhood at a time
+                                      (default: AIR_TRUE) */
+  unsigned int iterBlock,          /* with row path: how many iterations are
+                                      done on each slab of slices while it is
+                                      in cache (temporal blocking) */
+    slabSize;                      /* with row path: number of slices in the
+                                      slabs handed to threads */
   /* ---------- internal */
   unsigned int iter;               /* what iteration we're on */
   size_t size[3],                  /* size of volume */
@@ -214,6 +238,13 @@ typedef struct coilContext_t {
                                       should go onward, and set "finished" */
     *updateBarrier;                /* after the update values have been
                                       applied to current values */
+  int rowDo;                       /* row path is in use */
+  unsigned int rowSrc,             /* with row path: which of the two values
+                                      per voxel in nvol is current; the other
+                                      is where the next iterBlock result goes
+                                      (there is no separate update phase) */
+    rowIter,                       /* # iterations in current block */
+    nextSlab;                      /* next slab to be processed */
 } coilContext;
 
 /* defaultsCoil.c */
@@ -203,6 +203,150 @@ _coilProcess(coilTask *task, int doFilter) {
   return;
 }
 
+/*
+** _coilRowLoad
+**
+** copies the row of value slot "src" in nvol at (yi,zi) into "row",
+** along with one (replicated) value of padding at both ends
+*/
+void
+_coilRowLoad(coil_t *row, const coil_t *vol, unsigned int src,
+             int yi, int zi, int sizeX, int sizeY) {
+  int xi;
+
+  vol += 2*sizeX*(yi + sizeY*zi) + src;
+  for (xi=0; xi<sizeX; xi++) {
+    row[xi] = vol[2*xi];
+  }
+  row[-1] = row[0];
+  row[sizeX] = row[sizeX-1];
+  return;
+}
+
+/*
+** _coilRowProcess
+**
+** the "row path": does cctx->rowIter iterations at once on slabs of
+** cctx->slabSize slices, reading value slot cctx->rowSrc of nvol and
+** writing the other slot.  Each slab is copied (with rowIter ghost
+** slices on either side) into task->slab[0], and then iteration k
+** computes into the other slab[] buffer all the slices that iterations
+** after k will still need, which is rowIter-k fewer ghost slices on
+** either side.  Clamping at the volume boundary is the same as with
+** iv3Fill, and the arithmetic of kind->filterRow[] is the same as that
+** of kind->filter[], so the results are the same as with rowIter
+** separate filter and update phases, but with far fewer passes through
+** memory.
+*/
+void
+_coilRowProcess(coilTask *task) {
+  static const char me[]="_coilRowProcess";
+  coilContext *cctx;
+  int sizeX, sizeY, sizeZ, stride, lo0, lo, hi, z0, z1, xi, yi, zi, ni,
+    yy, zz, iter, iterNum, slabSize;
+  unsigned int src, slabIdx, slabNum, cur;
+  coil_t *vol, *row[9], *in, *out;
+  void (*filterRow)(coil_t *delta, coil_t **row, coil_t *buff,
+                    unsigned int sizeX, double spacing[3],
+                    double parm[COIL_PARMS_NUM]);
+
+  cctx = task->cctx;
+  sizeX = AIR_CAST(int, cctx->size[0]);
+  sizeY = AIR_CAST(int, cctx->size[1]);
+  sizeZ = AIR_CAST(int, cctx->size[2]);
+  stride = sizeX + 2;
+  iterNum = AIR_CAST(int, cctx->rowIter);
+  slabSize = AIR_CAST(int, cctx->slabSize);
+  slabNum = (cctx->size[2] + cctx->slabSize - 1)/cctx->slabSize;
+  src = cctx->rowSrc;
+  vol = (coil_t*)(cctx->nvol->data);
+  filterRow = cctx->kind->filterRow[cctx->method->type];
+  while (1) {
+    if (cctx->numThreads > 1) {
+      airThreadMutexLock(cctx->nextSliceMutex);
+    }
+    slabIdx = cctx->nextSlab;
+    if (cctx->nextSlab < slabNum) {
+      cctx->nextSlab++;
+    }
+    if (cctx->numThreads > 1) {
+      airThreadMutexUnlock(cctx->nextSliceMutex);
+    }
+    if (slabIdx == slabNum) {
+      break;
+    }
+    z0 = slabSize*AIR_CAST(int, slabIdx);
+    z1 = AIR_MIN(z0 + slabSize, sizeZ);
+    if (cctx->verbose > 2) {
+      fprintf(stderr, "%s(%u): iter=%u, z=[%d,%d)\n",
+              me, task->threadIdx, cctx->iter, z0, z1);
+    }
+    /* load the slab and its ghost slices */
+    lo0 = AIR_MAX(z0 - iterNum, 0);
+    hi = AIR_MIN(z1 + iterNum, sizeZ);
+    for (zi=lo0; zi<hi; zi++) {
+      for (yi=0; yi<sizeY; yi++) {
+        _coilRowLoad(task->slab[0] + stride*(yi + sizeY*(zi - lo0)) + 1,
+                     vol, src, yi, zi, sizeX, sizeY);
+      }
+    }
+    /* iterate, losing one ghost slice on either side each time */
+    cur = 0;
+    for (iter=1; iter<=iterNum; iter++) {
+      lo = AIR_MAX(z0 - (iterNum - iter), 0);
+      hi = AIR_MIN(z1 + (iterNum - iter), sizeZ);
+      for (zi=lo; zi<hi; zi++) {
+        for (yi=0; yi<sizeY; yi++) {
+          for (ni=0; ni<9; ni++) {
+            yy = AIR_CLAMP(0, yi + ni%3 - 1, sizeY-1);
+            zz = AIR_CLAMP(0, zi + ni/3 - 1, sizeZ-1);
+            row[ni] = (task->slab[cur] + stride*(yy + sizeY*(zz - lo0))
+                       + 1);
+          }
+          filterRow(task->rowDelta, row, task->rowBuff, sizeX,
+                    cctx->spacing, cctx->parm);
+          /* kind->update for valLen 1 */
+          in = row[4];
+          out = task->slab[1-cur] + stride*(yi + sizeY*(zi - lo0)) + 1;
+          for (xi=0; xi<sizeX; xi++) {
+            out[xi] = in[xi] + task->rowDelta[xi];
+          }
+          out[-1] = out[0];
+          out[sizeX] = out[sizeX-1];
+        }
+      }
+      cur = 1 - cur;
+    }
+    /* store the slab */
+    for (zi=z0; zi<z1; zi++) {
+      for (yi=0; yi<sizeY; yi++) {
+        in = task->slab[cur] + stride*(yi + sizeY*(zi - lo0)) + 1;
+        out = vol + 2*sizeX*(yi + sizeY*zi) + (1 - src);
+        for (xi=0; xi<sizeX; xi++) {
+          out[2*xi] = in[xi];
+        }
+      }
+    }
+  }
+  return;
+}
+
+coilTask *
+_coilTaskNix(coilTask *task) {
+
+  if (task) {
+    task->thread = airThreadNix(task->thread);
+    task->_iv3 = (coil_t *)airFree(task->_iv3);
+    task->iv3 = (coil_t **)airFree(task->iv3);
+    task->slab[0] = (coil_t *)airFree(task->slab[0]);
+    task->slab[1] = (coil_t *)airFree(task->slab[1]);
+    task->rowDelta = (coil_t *)airFree(task->rowDelta);
+    task->rowBuff = (coil_t *)airFree(task->rowBuff);
+    free(task);
+  }
+  return NULL;
+}
+
 coilTask *
 _coilTaskNew(coilContext *cctx, int threadIdx) {
   coilTask *task;
@@ -227,23 +371,24 @@ _coilTaskNew(coilContext *cctx, int threadIdx) {
     } else {
       task->iv3Fill = _coilIv3Fill_R_L;
     }
+    if (cctx->rowDo) {
+      size_t slabLen;
+      slabLen = ((cctx->size[0] + 2)*cctx->size[1]
+                 *AIR_MIN(cctx->size[2], cctx->slabSize + 2*cctx->iterBlock));
+      task->slab[0] = (coil_t*)calloc(slabLen, sizeof(coil_t));
+      task->slab[1] = (coil_t*)calloc(slabLen, sizeof(coil_t));
+      task->rowDelta = (coil_t*)calloc(cctx->size[0], sizeof(coil_t));
+      task->rowBuff = (coil_t*)calloc(cctx->size[0] + 1, sizeof(coil_t));
+      if (!(task->slab[0] && task->slab[1]
+            && task->rowDelta && task->rowBuff)) {
+        return _coilTaskNix(task);
+      }
+    }
     task->returnPtr = NULL;
   }
   return task;
 }
 
-coilTask *
-_coilTaskNix(coilTask *task) {
-
-  if (task) {
-    task->thread = airThreadNix(task->thread);
-    task->_iv3 = (coil_t *)airFree(task->_iv3);
-    task->iv3 = (coil_t **)airFree(task->iv3);
-    free(task);
-  }
-  return NULL;
-}
-
 void *
 _coilWorker(void *_task) {
   static const char me[]="_coilWorker";
@@ -268,6 +413,15 @@ _coilWorker(void *_task) {
     }
     /* else there's work to do ... */
 
+    if (task->cctx->rowDo) {
+      /* filter and update together, one block of iterations */
+      _coilRowProcess(task);
+      if (task->cctx->numThreads > 1) {
+        airThreadBarrierWait(task->cctx->updateBarrier);
+      }
+      continue;
+    }
+
     /* first: filter */
     if (task->cctx->verbose > 1) {
       fprintf(stderr, "%s(%d): filtering ... \n",
@@ -301,6 +455,16 @@ coilStart(coilContext *cctx) {
     biffAddf(COIL, "%s: got NULL pointer", me);
     return 1;
   }
+  cctx->rowDo = (cctx->rowPath
+                 && 1 == cctx->radius
+                 && 1 == cctx->kind->valLen
+                 && cctx->kind->filterRow[cctx->method->type]);
+  if (cctx->rowDo && !(cctx->iterBlock && cctx->slabSize)) {
+    biffAddf(COIL, "%s: need non-zero iterBlock (%u) and slabSize (%u)",
+             me, cctx->iterBlock, cctx->slabSize);
+    return 1;
+  }
+  cctx->rowSrc = 0;
   cctx->task = (coilTask **)calloc(cctx->numThreads, sizeof(coilTask *));
   if (!(cctx->task)) {
     biffAddf(COIL, "%s: couldn't allocate array of tasks", me);
@@ -378,7 +542,39 @@ coilIterate(coilContext *cctx, int numIterations) {
   }
 
   time0 = airTime();
-  for (iter=0; iter<numIterations; iter++) {
+  if (cctx->rowDo) {
+    for (iter=0; iter<numIterations; iter += cctx->rowIter) {
+      cctx->iter = iter;
+      cctx->rowIter = AIR_MIN(cctx->iterBlock,
+                              AIR_CAST(unsigned int, numIterations - iter));
+      if (cctx->verbose) {
+        fprintf(stderr, "%s: starting iters %d-%u (of %d)\n", me, iter,
+                iter + cctx->rowIter - 1, numIterations);
+      }
+      cctx->nextSlab = 0;
+      cctx->finished = AIR_FALSE;
+      if (cctx->numThreads > 1) {
+        airThreadBarrierWait(cctx->filterBarrier);
+      }
+      _coilRowProcess(cctx->task[0]);
+      if (cctx->numThreads > 1) {
+        airThreadBarrierWait(cctx->updateBarrier);
+      }
+      cctx->rowSrc = 1 - cctx->rowSrc;
+    }
+    if (cctx->rowSrc) {
+      /* put current values back where coilOutputGet expects them */
+      coil_t *val;
+      size_t elIdx, elNum;
+      val = (coil_t*)(cctx->nvol->data);
+      elNum = cctx->size[0]*cctx->size[1]*cctx->size[2];
+      for (elIdx=0; elIdx<elNum; elIdx++) {
+        val[0 + 2*elIdx] = val[1 + 2*elIdx];
+      }
+      cctx->rowSrc = 0;
+    }
+  }
+  for (iter=0; !cctx->rowDo && iter<numIterations; iter++) {
     cctx->iter = iter;
     if (cctx->verbose) {
       fprintf(stderr, "%s: starting iter %d (of %d)\n", me, iter,
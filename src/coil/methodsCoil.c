@@ -56,6 +56,9 @@ coilContextNew() {
     cctx->nin = NULL;
     cctx->radius = coilDefaultRadius;
     cctx->numThreads = 1;
+    cctx->rowPath = AIR_TRUE;
+    cctx->iterBlock = 2;
+    cctx->slabSize = 16;
     ELL_3V_SET(cctx->spacing, AIR_NAN, AIR_NAN, AIR_NAN);
     cctx->nvol = NULL;
     cctx->finished = AIR_FALSE;
@@ -63,6 +66,10 @@ coilContextNew() {
     cctx->nextSliceMutex = NULL;
     cctx->filterBarrier = NULL;
     cctx->updateBarrier = NULL;
+    cctx->rowDo = AIR_FALSE;
+    cctx->rowSrc = 0;
+    cctx->rowIter = 0;
+    cctx->nextSlab = 0;
   }
   return cctx;
 }
@@ -316,6 +316,153 @@ _coilKindScalarFilterModifiedCurvatureRings(coil_t *delta,
   delta[0] *= AIR_CAST(coil_t, parm[0]);
 }
 
+/*
+** Row-wise versions of the Homogeneous, PeronaMalik, and
+** ModifiedCurvature filters above, doing the same arithmetic in the same
+** order (so the results are identical), but on a whole X row at a time.
+** row[b] here is iv3[*][b] above, with the X offset moved into the
+** index: iv3[0][b] is row[b][xi-1] and iv3[2][b] is row[b][xi+1].  The
+** loops over xi have no function calls other than exp() and sqrt(), so
+** that the compiler can vectorize them.
+**
+** The flux through the face between xi-1 and xi is both the "forwX"
+** of xi-1 and the "backX" of xi, so it is computed once, into buff[xi].
+*/
+
+void
+_coilKindScalarFilterRowHomogeneous(coil_t *delta, coil_t **row,
+                                    coil_t *buff, unsigned int sizeX,
+                                    double spacing[3],
+                                    double parm[COIL_PARMS_NUM]) {
+  coil_t *r1, *r3, *r4, *r5, *r7, step;
+  double ssX, ssY, ssZ;
+  int xi, sx;
+
+  AIR_UNUSED(buff);
+  sx = AIR_CAST(int, sizeX);
+  r1 = row[1]; r3 = row[3]; r4 = row[4]; r5 = row[5]; r7 = row[7];
+  ssX = spacing[0]*spacing[0];
+  ssY = spacing[1]*spacing[1];
+  ssZ = spacing[2]*spacing[2];
+  step = AIR_CAST(coil_t, parm[0]);
+  for (xi=0; xi<sx; xi++) {
+    delta[xi] = step*AIR_CAST(coil_t,
+                              (r4[xi-1] - 2*r4[xi] + r4[xi+1])/ssX
+                              + (r3[xi] - 2*r4[xi] + r5[xi])/ssY
+                              + (r1[xi] - 2*r4[xi] + r7[xi])/ssZ);
+  }
+}
+
+/* sets g[] to gradient at face between xi-1 and xi ("forwX" of xi-1) */
+#define _COIL_ROW_GRAD_X(g, xi)                                        \
+  (g)[0] = rspX*(r4[xi] - r4[xi-1]);                                   \
+  (g)[1] = rspY*(r5[xi-1] + r5[xi] - r3[xi-1] - r3[xi])/2;             \
+  (g)[2] = rspZ*(r7[xi-1] + r7[xi] - r1[xi-1] - r1[xi])/2
+
+/* sets forwY, backY, forwZ, backZ at xi */
+#define _COIL_ROW_GRAD_YZ(xi)                                          \
+  forwY[0] = rspX*(r4[xi+1] + r5[xi+1] - r4[xi-1] - r5[xi-1])/2;       \
+  forwY[1] = rspY*(r5[xi] - r4[xi]);                                   \
+  forwY[2] = rspZ*(r7[xi] + r8[xi] - r1[xi] - r2[xi])/2;               \
+  backY[0] = rspX*(r3[xi+1] + r4[xi+1] - r3[xi-1] - r4[xi-1])/2;       \
+  backY[1] = rspY*(r4[xi] - r3[xi]);                                   \
+  backY[2] = rspZ*(r6[xi] + r7[xi] - r0[xi] - r1[xi])/2;               \
+  forwZ[0] = rspX*(r4[xi+1] + r7[xi+1] - r4[xi-1] - r7[xi-1])/2;       \
+  forwZ[1] = rspY*(r5[xi] + r8[xi] - r3[xi] - r6[xi])/2;               \
+  forwZ[2] = rspZ*(r7[xi] - r4[xi]);                                   \
+  backZ[0] = rspX*(r1[xi+1] + r4[xi+1] - r1[xi-1] - r4[xi-1])/2;       \
+  backZ[1] = rspY*(r2[xi] + r5[xi] - r0[xi] - r3[xi])/2;               \
+  backZ[2] = rspZ*(r4[xi] - r1[xi])
+
+#define _COIL_ROW_SETUP                                                \
+  sx = AIR_CAST(int, sizeX);                                           \
+  r0 = row[0]; r1 = row[1]; r2 = row[2];                               \
+  r3 = row[3]; r4 = row[4]; r5 = row[5];                               \
+  r6 = row[6]; r7 = row[7]; r8 = row[8];                               \
+  rspX = AIR_CAST(coil_t, 1.0/spacing[0]);                             \
+  rspY = AIR_CAST(coil_t, 1.0/spacing[1]);                             \
+  rspZ = AIR_CAST(coil_t, 1.0/spacing[2])
+
+void
+_coilKindScalarFilterRowPeronaMalik(coil_t *delta, coil_t **row,
+                                    coil_t *buff, unsigned int sizeX,
+                                    double spacing[3],
+                                    double parm[COIL_PARMS_NUM]) {
+  coil_t *r0, *r1, *r2, *r3, *r4, *r5, *r6, *r7, *r8,
+    gX[3], forwY[3], backY[3], forwZ[3], backZ[3], KK, rspX, rspY, rspZ;
+  int xi, sx;
+
+  _COIL_ROW_SETUP;
+  KK = AIR_CAST(coil_t, parm[1]*parm[1]);
+  for (xi=0; xi<=sx; xi++) {
+    _COIL_ROW_GRAD_X(gX, xi);
+    buff[xi] = gX[0]*_COIL_CONDUCT(ELL_3V_DOT(gX, gX), KK);
+  }
+  for (xi=0; xi<sx; xi++) {
+    _COIL_ROW_GRAD_YZ(xi);
+    forwY[1] *= _COIL_CONDUCT(ELL_3V_DOT(forwY, forwY), KK);
+    forwZ[2] *= _COIL_CONDUCT(ELL_3V_DOT(forwZ, forwZ), KK);
+    backY[1] *= _COIL_CONDUCT(ELL_3V_DOT(backY, backY), KK);
+    backZ[2] *= _COIL_CONDUCT(ELL_3V_DOT(backZ, backZ), KK);
+    delta[xi] = AIR_CAST(coil_t, parm[0])*(rspX*(buff[xi+1] - buff[xi])
+                                           + rspY*(forwY[1] - backY[1])
+                                           + rspZ*(forwZ[2] - backZ[2]));
+  }
+}
+
+void
+_coilKindScalarFilterRowModifiedCurvature(coil_t *delta, coil_t **row,
+                                          coil_t *buff, unsigned int sizeX,
+                                          double spacing[3],
+                                          double parm[COIL_PARMS_NUM]) {
+  coil_t *r0, *r1, *r2, *r3, *r4, *r5, *r6, *r7, *r8,
+    gX[3], forwY[3], backY[3], forwZ[3], backZ[3], grad[3], gm, eps,
+    KK, LL, denom, lapl, rspX, rspY, rspZ, lerp;
+  double ssX, ssY, ssZ;
+  int xi, sx;
+
+  _COIL_ROW_SETUP;
+  ssX = spacing[0]*spacing[0];
+  ssY = spacing[1]*spacing[1];
+  ssZ = spacing[2]*spacing[2];
+  eps = 0.0000000001f;
+  KK = AIR_CAST(coil_t, parm[1]*parm[1]);
+  lerp = AIR_CAST(coil_t, parm[2]);
+  for (xi=0; xi<=sx; xi++) {
+    _COIL_ROW_GRAD_X(gX, xi);
+    LL = ELL_3V_DOT(gX, gX);
+    denom = AIR_CAST(coil_t, 1.0/(eps + sqrt(LL)));
+    buff[xi] = gX[0]*(_COIL_CONDUCT(LL, KK)*denom);
+  }
+  for (xi=0; xi<sx; xi++) {
+    _COIL_ROW_GRAD_YZ(xi);
+    grad[0] = rspX*(r4[xi+1] - r4[xi-1]);
+    grad[1] = rspY*(r5[xi] - r3[xi]);
+    grad[2] = rspZ*(r7[xi] - r1[xi]);
+    gm = AIR_CAST(coil_t, ELL_3V_LEN(grad));
+    LL = ELL_3V_DOT(forwY, forwY);
+    denom = AIR_CAST(coil_t, 1.0/(eps + sqrt(LL)));
+    forwY[1] *= _COIL_CONDUCT(LL, KK)*denom;
+    LL = ELL_3V_DOT(forwZ, forwZ);
+    denom = AIR_CAST(coil_t, 1.0/(eps + sqrt(LL)));
+    forwZ[2] *= _COIL_CONDUCT(LL, KK)*denom;
+    LL = ELL_3V_DOT(backY, backY);
+    denom = AIR_CAST(coil_t, 1.0/(eps + sqrt(LL)));
+    backY[1] *= _COIL_CONDUCT(LL, KK)*denom;
+    LL = ELL_3V_DOT(backZ, backZ);
+    denom = AIR_CAST(coil_t, 1.0/(eps + sqrt(LL)));
+    backZ[2] *= _COIL_CONDUCT(LL, KK)*denom;
+    lapl = AIR_CAST(coil_t, ((r4[xi-1] - 2*r4[xi] + r4[xi+1])/ssX
+                             + (r3[xi] - 2*r4[xi] + r5[xi])/ssY
+                             + (r1[xi] - 2*r4[xi] + r7[xi])/ssZ));
+    delta[xi] = (lerp*lapl
+                 + (1-lerp)*gm*(rspX*(buff[xi+1] - buff[xi])
+                                + rspY*(forwY[1] - backY[1])
+                                + rspZ*(forwZ[2] - backZ[2])));
+    delta[xi] *= AIR_CAST(coil_t, parm[0]);
+  }
+}
+
 void
 _coilKindScalarUpdate(coil_t *val, coil_t *delta) {
 
@@ -335,7 +482,16 @@ _coilKindScalar = {
    NULL,
    NULL,
    NULL},
-  _coilKindScalarUpdate
+  _coilKindScalarUpdate,
+  {NULL,
+   NULL,
+   _coilKindScalarFilterRowHomogeneous,
+   _coilKindScalarFilterRowPeronaMalik,
+   _coilKindScalarFilterRowModifiedCurvature,
+   NULL,
+   NULL,
+   NULL,
+   NULL}
 };
 
 const coilKind *
@@ -33,7 +33,8 @@ main(int argc, const char *argv[]) {
   airArray *mop;
 
   int numIters, numThreads, methodType, kindType, _parmLen, pi, radius,
-    verbose;
+    verbose, noRowPath;
+  unsigned int iterBlock, slabSize;
   Nrrd *nin, *nout;
   coilContext *cctx;
   double *_parm, parm[COIL_PARMS_NUM];
@@ -52,6 +53,14 @@ main(int argc, const char *argv[]) {
              "all the parameters required for filtering method", &_parmLen);
   hestOptAdd(&hopt, "r", "radius", airTypeInt, 1, 1, &radius, "1",
              "radius of filtering neighborhood");
+  hestOptAdd(&hopt, "nrp", NULL, airTypeInt, 0, 0, &noRowPath, NULL,
+             "don't use the row path (whole X rows at a time, several "
+             "iterations per slab of slices), even if the kind and method "
+             "support it");
+  hestOptAdd(&hopt, "ib", "# iters", airTypeUInt, 1, 1, &iterBlock, "2",
+             "with row path: number of iterations per pass through volume");
+  hestOptAdd(&hopt, "ss", "# slices", airTypeUInt, 1, 1, &slabSize, "16",
+             "with row path: number of slices per slab");
   hestOptAdd(&hopt, "v", "verbose", airTypeInt, 1, 1, &verbose, "1",
              "verbosity level");
   hestOptAdd(&hopt, "i", "nin", airTypeOther, 1, 1, &(nin), "",
@@ -81,8 +90,16 @@ main(int argc, const char *argv[]) {
   if (coilContextAllSet(cctx, nin,
                         coilKindArray[kindType], coilMethodArray[methodType],
                         radius, numThreads, verbose,
-                        parm)
-      || coilStart(cctx)
+                        parm)) {
+    airMopAdd(mop, err = biffGetDone(COIL), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with coil:\n%s\n", me, err);
+    airMopError(mop);
+    return 1;
+  }
+  cctx->rowPath = !noRowPath;
+  cctx->iterBlock = iterBlock;
+  cctx->slabSize = slabSize;
+  if (coilStart(cctx)
       || coilIterate(cctx, numIters)
       || coilFinish(cctx)
       || coilOutputGet(nout, cctx)) {
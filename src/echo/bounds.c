@@ -171,6 +171,12 @@ BNDS_TMPL(Instance,
           ELL_3V_MAX(hi, hi, b[7]);
           )
 
+BNDS_TMPL(BVH,
+          /* root node box already includes ECHO_EPSILON padding */
+          ELL_3V_COPY(lo, obj->node[0].min);
+          ELL_3V_COPY(hi, obj->node[0].max);
+          )
+
 _echoBoundsGet_t
 _echoBoundsGet[ECHO_TYPE_NUM] = {
   (_echoBoundsGet_t)_echoSphere_bounds,
@@ -185,6 +191,7 @@ _echoBoundsGet[ECHO_TYPE_NUM] = {
   (_echoBoundsGet_t)_echoSplit_bounds,
   (_echoBoundsGet_t)_echoList_bounds,
   (_echoBoundsGet_t)_echoInstance_bounds,
+  (_echoBoundsGet_t)_echoBVH_bounds,
 };
 
 void
@@ -0,0 +1,334 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "echo.h"
+#include "privateEcho.h"
+
+typedef struct {
+  unsigned int node,           /* index of node to fill in */
+    lo, hi,                    /* range of prim[] it covers */
+    depth;                     /* depth of node in tree */
+} _echoBVHTask;
+
+/* half the surface area of a box; the 2 cancels out in the SAH costs */
+static echoPos_t
+_echoBVHArea(const echoPos_t *min, const echoPos_t *max) {
+  echoPos_t dx, dy, dz;
+
+  if (min[0] > max[0]) {
+    /* box is empty */
+    return 0;
+  }
+  dx = max[0] - min[0];
+  dy = max[1] - min[1];
+  dz = max[2] - min[2];
+  return dx*dy + dy*dz + dz*dx;
+}
+
+static unsigned int
+_echoBVHBin(echoPos_t cc, echoPos_t cmin, echoPos_t scl) {
+  unsigned int bb;
+
+  bb = AIR_UINT((cc - cmin)*scl);
+  return AIR_MIN(bb, ECHO_BVH_BIN_NUM-1);
+}
+
+/*
+** _echoBVHBuild
+**
+** builds a BVH over primNum primitives, the bounding boxes of which are
+** given by pmin[] and pmax[] (3 values per primitive).  Splits are chosen
+** with the surface area heuristic, evaluated between ECHO_BVH_BIN_NUM
+** centroid bins along each axis.  The tree is built with an explicit
+** task stack rather than recursion, and its depth is limited to
+** ECHO_BVH_DEPTH_MAX so that traversal can use a fixed-size stack.
+**
+** prim[] (primNum long) is set to the permutation of primitive indices
+** such that every leaf covers a contiguous range of prim[].  Returns the
+** node array, and its length in *nodeNumP, or NULL if primNum is zero or
+** if allocation failed.
+*/
+echoBVHNode *
+_echoBVHBuild(unsigned int *nodeNumP, unsigned int *prim,
+              const echoPos_t *pmin, const echoPos_t *pmax,
+              unsigned int primNum) {
+  echoBVHNode *node, *nd;
+  echoPos_t *cent, cmin[3], cmax[3], lmin[3], lmax[3],
+    bmin[ECHO_BVH_BIN_NUM][3], bmax[ECHO_BVH_BIN_NUM][3],
+    rarea[ECHO_BVH_BIN_NUM], area, cost, bestCost, scl;
+  unsigned int bcnt[ECHO_BVH_BIN_NUM], rcnt[ECHO_BVH_BIN_NUM], cnt,
+    ii, jj, pp, num, mid, nodeNum, axis, bestAxis, bestBin, taskNum;
+  _echoBVHTask task[2*ECHO_BVH_DEPTH_MAX+2], tt;
+
+  if (!( nodeNumP && prim && pmin && pmax && primNum )) {
+    return NULL;
+  }
+  /* every leaf holds at least one primitive, so this is enough */
+  node = AIR_CALLOC(2*primNum-1, echoBVHNode);
+  cent = AIR_CALLOC(3*primNum, echoPos_t);
+  if (!( node && cent )) {
+    airFree(node);
+    airFree(cent);
+    return NULL;
+  }
+  for (ii=0; ii<primNum; ii++) {
+    prim[ii] = ii;
+    ELL_3V_ADD2(cent + 3*ii, pmin + 3*ii, pmax + 3*ii);
+    ELL_3V_SCALE(cent + 3*ii, 0.5, cent + 3*ii);
+  }
+
+  nodeNum = 1;
+  task[0].node = 0;
+  task[0].lo = 0;
+  task[0].hi = primNum;
+  task[0].depth = 0;
+  taskNum = 1;
+  while (taskNum) {
+    tt = task[--taskNum];
+    nd = node + tt.node;
+    num = tt.hi - tt.lo;
+    ELL_3V_SET(nd->min, ECHO_POS_MAX, ECHO_POS_MAX, ECHO_POS_MAX);
+    ELL_3V_SET(nd->max, ECHO_POS_MIN, ECHO_POS_MIN, ECHO_POS_MIN);
+    ELL_3V_COPY(cmin, nd->min);
+    ELL_3V_COPY(cmax, nd->max);
+    for (ii=tt.lo; ii<tt.hi; ii++) {
+      pp = prim[ii];
+      ELL_3V_MIN(nd->min, nd->min, pmin + 3*pp);
+      ELL_3V_MAX(nd->max, nd->max, pmax + 3*pp);
+      ELL_3V_MIN(cmin, cmin, cent + 3*pp);
+      ELL_3V_MAX(cmax, cmax, cent + 3*pp);
+    }
+    nd->offset = tt.lo;
+    nd->num = num;
+    if (num <= ECHO_BVH_LEAF_SIZE || ECHO_BVH_DEPTH_MAX == tt.depth) {
+      continue;
+    }
+    /* The cost of a leaf is num (one unit per primitive test), and the
+       cost of a split is one (for the traversal step) plus the children's
+       primitive counts, weighted by their area relative to this node */
+    area = _echoBVHArea(nd->min, nd->max);
+    area = area > 0 ? area : 1;
+    bestCost = AIR_CAST(echoPos_t, num);
+    bestAxis = 3;
+    bestBin = 0;
+    for (axis=0; axis<3; axis++) {
+      if (!( cmax[axis] > cmin[axis] )) {
+        continue;
+      }
+      scl = ECHO_BVH_BIN_NUM/(cmax[axis] - cmin[axis]);
+      for (jj=0; jj<ECHO_BVH_BIN_NUM; jj++) {
+        bcnt[jj] = 0;
+        ELL_3V_SET(bmin[jj], ECHO_POS_MAX, ECHO_POS_MAX, ECHO_POS_MAX);
+        ELL_3V_SET(bmax[jj], ECHO_POS_MIN, ECHO_POS_MIN, ECHO_POS_MIN);
+      }
+      for (ii=tt.lo; ii<tt.hi; ii++) {
+        pp = prim[ii];
+        jj = _echoBVHBin(cent[axis + 3*pp], cmin[axis], scl);
+        bcnt[jj]++;
+        ELL_3V_MIN(bmin[jj], bmin[jj], pmin + 3*pp);
+        ELL_3V_MAX(bmax[jj], bmax[jj], pmax + 3*pp);
+      }
+      /* sweep down to learn what is to the right of each plane ... */
+      ELL_3V_SET(lmin, ECHO_POS_MAX, ECHO_POS_MAX, ECHO_POS_MAX);
+      ELL_3V_SET(lmax, ECHO_POS_MIN, ECHO_POS_MIN, ECHO_POS_MIN);
+      cnt = 0;
+      for (jj=ECHO_BVH_BIN_NUM-1; jj>0; jj--) {
+        ELL_3V_MIN(lmin, lmin, bmin[jj]);
+        ELL_3V_MAX(lmax, lmax, bmax[jj]);
+        cnt += bcnt[jj];
+        rcnt[jj] = cnt;
+        rarea[jj] = _echoBVHArea(lmin, lmax);
+      }
+      /* ... then sweep up, costing the plane between bins jj-1 and jj */
+      ELL_3V_SET(lmin, ECHO_POS_MAX, ECHO_POS_MAX, ECHO_POS_MAX);
+      ELL_3V_SET(lmax, ECHO_POS_MIN, ECHO_POS_MIN, ECHO_POS_MIN);
+      cnt = 0;
+      for (jj=1; jj<ECHO_BVH_BIN_NUM; jj++) {
+        ELL_3V_MIN(lmin, lmin, bmin[jj-1]);
+        ELL_3V_MAX(lmax, lmax, bmax[jj-1]);
+        cnt += bcnt[jj-1];
+        if (!( cnt && rcnt[jj] )) {
+          continue;
+        }
+        cost = 1 + (_echoBVHArea(lmin, lmax)*cnt + rarea[jj]*rcnt[jj])/area;
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestAxis = axis;
+          bestBin = jj;
+        }
+      }
+    }
+    if (3 == bestAxis) {
+      /* no split is cheaper than testing everything here */
+      continue;
+    }
+    /* partition prim[tt.lo .. tt.hi-1] around the chosen plane */
+    scl = ECHO_BVH_BIN_NUM/(cmax[bestAxis] - cmin[bestAxis]);
+    ii = tt.lo;
+    jj = tt.hi;
+    while (ii < jj) {
+      if (_echoBVHBin(cent[bestAxis + 3*prim[ii]],
+                      cmin[bestAxis], scl) < bestBin) {
+        ii++;
+      } else {
+        jj--;
+        pp = prim[ii];
+        prim[ii] = prim[jj];
+        prim[jj] = pp;
+      }
+    }
+    mid = ii;
+    if (mid == tt.lo || mid == tt.hi) {
+      /* can't happen, but a leaf is still correct */
+      continue;
+    }
+    nd->offset = nodeNum;
+    nd->num = 0;
+    /* push the right child first, so the left is done next */
+    task[taskNum].node = nodeNum + 1;
+    task[taskNum].lo = mid;
+    task[taskNum].hi = tt.hi;
+    task[taskNum].depth = tt.depth + 1;
+    taskNum++;
+    task[taskNum].node = nodeNum;
+    task[taskNum].lo = tt.lo;
+    task[taskNum].hi = mid;
+    task[taskNum].depth = tt.depth + 1;
+    taskNum++;
+    nodeNum += 2;
+  }
+
+  /* give back what wasn't needed */
+  nd = AIR_CAST(echoBVHNode *, realloc(node, nodeNum*sizeof(echoBVHNode)));
+  if (nd) {
+    node = nd;
+  }
+  airFree(cent);
+  *nodeNumP = nodeNum;
+  return node;
+}
+
+/*
+** _echoTriMeshBVHSet
+**
+** (re-)builds the BVH over the triangles of a TriMesh; called by
+** echoTriMeshSet().  If this fails, trim->bvh is left NULL, and
+** intersection falls back on testing every triangle.
+*/
+void
+_echoTriMeshBVHSet(echoTriMesh *trim) {
+  echoPos_t *pmin, *pmax, *pos;
+  unsigned int fi, vi, numF;
+
+  trim->bvh = (echoBVHNode *)airFree(trim->bvh);
+  trim->bvhFace = (unsigned int *)airFree(trim->bvhFace);
+  trim->bvhNum = 0;
+  if (!( trim->numF > 0 && trim->pos && trim->vert )) {
+    return;
+  }
+  numF = AIR_UINT(trim->numF);
+  pmin = AIR_CALLOC(3*numF, echoPos_t);
+  pmax = AIR_CALLOC(3*numF, echoPos_t);
+  trim->bvhFace = AIR_CALLOC(numF, unsigned int);
+  if (pmin && pmax && trim->bvhFace) {
+    for (fi=0; fi<numF; fi++) {
+      pos = trim->pos + 3*trim->vert[0 + 3*fi];
+      ELL_3V_COPY(pmin + 3*fi, pos);
+      ELL_3V_COPY(pmax + 3*fi, pos);
+      for (vi=1; vi<3; vi++) {
+        pos = trim->pos + 3*trim->vert[vi + 3*fi];
+        ELL_3V_MIN(pmin + 3*fi, pmin + 3*fi, pos);
+        ELL_3V_MAX(pmax + 3*fi, pmax + 3*fi, pos);
+      }
+      /* same padding as in bounds.c */
+      for (vi=0; vi<3; vi++) {
+        pmin[vi + 3*fi] -= ECHO_EPSILON;
+        pmax[vi + 3*fi] += ECHO_EPSILON;
+      }
+    }
+    trim->bvh = _echoBVHBuild(&(trim->bvhNum), trim->bvhFace,
+                              pmin, pmax, numF);
+  }
+  if (!trim->bvh) {
+    trim->bvhFace = (unsigned int *)airFree(trim->bvhFace);
+    trim->bvhNum = 0;
+  }
+  airFree(pmin);
+  airFree(pmax);
+  return;
+}
+
+/*
+******** echoListBVH()
+**
+** returns an echoBVH that points to the same things as pointed to by
+** the given echoList, organized in a bounding volume hierarchy built
+** with the surface area heuristic.  Unlike echoListSplit3(), the tree
+** is stored in a single flat array of nodes, and it is traversed
+** without recursion.  As with echoListSplit(), the list is gutted, and
+** lists of only a few objects are returned as is.  Returns NULL if
+** allocation failed, in which case the list is not changed.
+*/
+echoObject *
+echoListBVH(echoScene *scene, echoObject *list) {
+  echoObject *ret;
+  echoPos_t *pmin, *pmax;
+  unsigned int *prim, ii, len;
+
+  if (!( scene && list && echoTypeList == list->type )) {
+    return list;
+  }
+  len = LIST(list)->objArr->len;
+  if (len <= ECHO_LEN_SMALL_ENOUGH) {
+    return list;
+  }
+
+  ret = NULL;
+  pmin = AIR_CALLOC(3*len, echoPos_t);
+  pmax = AIR_CALLOC(3*len, echoPos_t);
+  prim = AIR_CALLOC(len, unsigned int);
+  if (pmin && pmax && prim) {
+    for (ii=0; ii<len; ii++) {
+      echoBoundsGet(pmin + 3*ii, pmax + 3*ii, LIST(list)->obj[ii]);
+    }
+    ret = echoObjectNew(scene, echoTypeBVH);
+    BVH(ret)->obj = AIR_CALLOC(len, echoObject *);
+    BVH(ret)->node = _echoBVHBuild(&(BVH(ret)->nodeNum), prim,
+                                   pmin, pmax, len);
+    if (BVH(ret)->obj && BVH(ret)->node) {
+      for (ii=0; ii<len; ii++) {
+        BVH(ret)->obj[ii] = LIST(list)->obj[prim[ii]];
+      }
+      BVH(ret)->objNum = len;
+      /* as in echoListSplit(), the list can't be deleted, only gutted */
+      airArrayLenSet(LIST(list)->objArr, 0);
+    } else {
+      /* the scene still owns ret, and will free it */
+      ret = NULL;
+    }
+  }
+  airFree(pmin);
+  airFree(pmax);
+  airFree(prim);
+  return ret;
+}
@@ -83,6 +83,9 @@ typedef double echoCol_t;
 #define ECHO_EPSILON 0.00005      /* used for adjusting ray positions */
 #define ECHO_NEAR0 0.004          /* used for comparing transparency to zero */
 #define ECHO_LEN_SMALL_ENOUGH 5   /* to control splitting for split objects */
+#define ECHO_BVH_LEAF_SIZE 4      /* BVH nodes this small are always leaves */
+#define ECHO_BVH_BIN_NUM 16       /* # centroid bins for SAH split search */
+#define ECHO_BVH_DEPTH_MAX 48     /* BVH depth limit, bounds traversal stack */
 
 #define ECHO_THREAD_MAX 512       /* max number of threads */
 
@@ -100,7 +103,9 @@ typedef struct {
     seedRand,          /* call airSrandMT() (don't if repeatability wanted) */
     sqNRI,             /* how many iterations of newton-raphson we allow for
                           finding superquadric root (within tolorance sqTol) */
-    numThreads;        /* number of threads to spawn per rendering */
+    numThreads,        /* number of threads to spawn per rendering */
+    tileSize;          /* threads are handed square tiles of this many
+                          pixels on edge */
   echoPos_t
     sqTol;             /* how close newtwon-raphson must get to zero */
   echoCol_t
@@ -112,7 +117,11 @@ typedef struct {
                           Beer's law attenuation in glass */
   float aperture,      /* shallowness of field */
     timeGamma,         /* gamma for values in time image */
-    boxOpac;           /* opacity of bounding boxes with renderBoxes */
+    boxOpac,           /* opacity of bounding boxes with renderBoxes */
+    adaptThresh;       /* if > 0: progressive sampling.  First every pixel
+                          gets one sample, then only pixels where the
+                          variance of those samples (over a 3x3 pixel
+                          neighborhood) exceeds this get numSamples */
   echoCol_t
     maxRecCol[3];      /* color of max recursion depth being hit */
 } echoRTParm;
@@ -126,8 +135,10 @@ typedef struct {
   limnCamera *cam;
   struct echoScene_t *scene;
   echoRTParm *parm;
-  int workIdx;         /* next work assignment (such as a scanline) */
+  int workIdx;         /* next work assignment (a tile index) */
   airThreadMutex *workMutex; /* mutex around work assignment */
+  int refinePass;      /* in the second pass of progressive sampling */
+  unsigned char *refine; /* with refinePass: which pixels get more samples */
 } echoGlobalState;
 
 typedef struct {
@@ -256,10 +267,11 @@ enum {
   echoTypeSplit,          /*  9 */
   echoTypeList,           /* 10 */
   echoTypeInstance,       /* 11 */
+  echoTypeBVH,            /* 12 */
   echoTypeLast
 };
 
-#define ECHO_TYPE_NUM        12
+#define ECHO_TYPE_NUM        13
 
 /*
 ******** echoObject (generic) and all other object structs
@@ -323,6 +335,21 @@ typedef struct {
   echoPos_t origin[3], edge0[3], edge1[3];
 } echoRectangle;
 
+/*
+******** echoBVHNode
+**
+** one node of a bounding volume hierarchy, stored in a flat array in
+** depth-first order.  The two children of an interior node are adjacent
+** in the array (at offset and offset+1), so that both of their boxes
+** are fetched together during traversal.
+*/
+typedef struct {
+  echoPos_t min[3], max[3];    /* bounding box of everything below */
+  unsigned int offset,         /* interior: index of first child node;
+                                  leaf: index of first primitive */
+    num;                       /* # primitives in leaf; 0 for interior */
+} echoBVHNode;
+
 typedef struct {
   ECHO_OBJECT_COMMON;
   ECHO_OBJECT_MATTER;
@@ -330,6 +357,10 @@ typedef struct {
   int numV, numF;
   echoPos_t *pos;
   int *vert;
+  echoBVHNode *bvh;            /* BVH over triangles, made by
+                                  echoTriMeshSet(); NULL if none */
+  unsigned int bvhNum,         /* # nodes in bvh */
+    *bvhFace;                  /* face indices, in BVH leaf order */
 } echoTriMesh;
 
 typedef struct {
@@ -366,6 +397,14 @@ typedef struct {
   echoObject *obj;
 } echoInstance;
 
+typedef struct {
+  ECHO_OBJECT_COMMON;
+  echoBVHNode *node;           /* flat array of nodeNum nodes */
+  unsigned int nodeNum;
+  echoObject **obj;            /* objects, in BVH leaf order */
+  unsigned int objNum;
+} echoBVH;
+
 /*
 ******** echoScene
 **
@@ -464,6 +503,9 @@ ECHO_EXPORT echoObject *echoListSplit(echoScene *scene,
 ECHO_EXPORT echoObject *echoListSplit3(echoScene *scene,
                                        echoObject *list, int depth);
 
+/* bvh.c --------------------------------------- */
+ECHO_EXPORT echoObject *echoListBVH(echoScene *scene, echoObject *list);
+
 /* set.c --------------------------------------- */
 ECHO_EXPORT void echoSphereSet(echoObject *sphere,
                                echoPos_t x, echoPos_t y,
@@ -448,6 +448,136 @@ _echoRayIntx_Triangle(RAYINTX_ARGS(Triangle)) {
   return AIR_TRUE;
 }
 
+/*
+** _echoBVHBoxHit
+**
+** slab test of ray against a BVH node box, using the precomputed
+** reciprocal of the ray direction.  If the box is hit within
+** [ray->neer, ray->faar], sets *tP to where the ray enters it.
+*/
+static int
+_echoBVHBoxHit(echoPos_t *tP, const echoBVHNode *node,
+               const echoRay *ray, const echoPos_t idir[3]) {
+  echoPos_t t0, t1, tmp, tmin, tmax;
+  int ii;
+
+  tmin = ray->neer;
+  tmax = ray->faar;
+  for (ii=0; ii<3; ii++) {
+    t0 = (node->min[ii] - ray->from[ii])*idir[ii];
+    t1 = (node->max[ii] - ray->from[ii])*idir[ii];
+    if (t0 > t1) {
+      tmp = t0; t0 = t1; t1 = tmp;
+    }
+    tmin = t0 > tmin ? t0 : tmin;
+    tmax = t1 < tmax ? t1 : tmax;
+    if (tmin > tmax) {
+      return AIR_FALSE;
+    }
+  }
+  *tP = tmin;
+  return AIR_TRUE;
+}
+
+/*
+** _echoBVHDescend
+**
+** the interior-node step of BVH traversal, shared by the TriMesh and
+** BVH intersection below: tests both children of interior node nd, and
+** pushes the ones hit onto the stack so that the nearer is popped first.
+** Returns the new stack size.
+*/
+static unsigned int
+_echoBVHDescend(unsigned int *stack, echoPos_t *stackT, unsigned int sp,
+                const echoBVHNode *nd, const echoBVHNode *node,
+                const echoRay *ray, const echoPos_t idir[3],
+                echoIntx *intx) {
+  const echoBVHNode *kid;
+  echoPos_t t0, t1;
+  int hit0, hit1;
+
+  kid = node + nd->offset;
+  hit0 = _echoBVHBoxHit(&t0, kid, ray, idir);
+  hit1 = _echoBVHBoxHit(&t1, kid + 1, ray, idir);
+  intx->boxhits += hit0 + hit1;
+  if (hit0 && hit1) {
+    if (t0 <= t1) {
+      stack[sp] = nd->offset + 1; stackT[sp++] = t1;
+      stack[sp] = nd->offset;     stackT[sp++] = t0;
+    } else {
+      stack[sp] = nd->offset;     stackT[sp++] = t0;
+      stack[sp] = nd->offset + 1; stackT[sp++] = t1;
+    }
+  } else if (hit0) {
+    stack[sp] = nd->offset;       stackT[sp++] = t0;
+  } else if (hit1) {
+    stack[sp] = nd->offset + 1;   stackT[sp++] = t1;
+  }
+  return sp;
+}
+
+static void
+_echoBVHInvDir(echoPos_t idir[3], const echoRay *ray) {
+
+  /* division by zero gives the infinities the slab test wants */
+  idir[0] = 1.0/ray->dir[0];
+  idir[1] = 1.0/ray->dir[1];
+  idir[2] = 1.0/ray->dir[2];
+}
+
+static int
+_echoRayIntx_TriMeshBVH(RAYINTX_ARGS(TriMesh)) {
+  echoPos_t *pos, vert0[3], edge0[3], edge1[3], pvec[3], qvec[3], tvec[3],
+    det, t, u, v, tmp, idir[3], stackT[ECHO_BVH_DEPTH_MAX+2];
+  const echoBVHNode *nd;
+  unsigned int stack[ECHO_BVH_DEPTH_MAX+2], sp, ii, fi;
+  int ret;
+
+  AIR_UNUSED(parm);
+  AIR_UNUSED(tstate);
+  _echoBVHInvDir(idir, ray);
+  ret = AIR_FALSE;
+  sp = 0;
+  if (_echoBVHBoxHit(stackT + sp, obj->bvh, ray, idir)) {
+    stack[sp++] = 0;
+  }
+  while (sp) {
+    sp--;
+    if (stackT[sp] > ray->faar) {
+      /* something closer was hit since this was pushed */
+      continue;
+    }
+    nd = obj->bvh + stack[sp];
+    if (nd->num) {
+      for (ii=0; ii<nd->num; ii++) {
+        fi = obj->bvhFace[nd->offset + ii];
+        pos = obj->pos + 3*obj->vert[0 + 3*fi];
+        ELL_3V_COPY(vert0, pos);
+        pos = obj->pos + 3*obj->vert[1 + 3*fi];
+        ELL_3V_SUB(edge0, pos, vert0);
+        pos = obj->pos + 3*obj->vert[2 + 3*fi];
+        ELL_3V_SUB(edge1, pos, vert0);
+        TRI_INTX(ray, vert0, edge0, edge1,
+                 pvec, qvec, tvec, det, t, u, v,
+                 (v < 0.0 || u + v > 1.0), continue);
+        if (ray->shadow) {
+          return AIR_TRUE;
+        }
+        intx->t = ray->faar = t;
+        ELL_3V_CROSS(intx->norm, edge0, edge1);
+        ELL_3V_NORM(intx->norm, intx->norm, tmp);
+        intx->obj = (echoObject *)obj;
+        intx->face = AIR_CAST(int, fi);
+        ret = AIR_TRUE;
+      }
+    } else {
+      sp = _echoBVHDescend(stack, stackT, sp, nd, obj->bvh, ray, idir, intx);
+    }
+  }
+  /* does NOT set u, v */
+  return ret;
+}
+
 int
 _echoRayIntx_TriMesh(RAYINTX_ARGS(TriMesh)) {
   echoPos_t *pos, vert0[3], edge0[3], edge1[3], pvec[3], qvec[3], tvec[3],
@@ -469,7 +599,10 @@ _echoRayIntx_TriMesh(RAYINTX_ARGS(TriMesh)) {
     }
     return AIR_FALSE;
   }
-  /* stupid linear search for now */
+  if (trim->bvh) {
+    return _echoRayIntx_TriMeshBVH(intx, ray, trim, parm, tstate);
+  }
+  /* else stupid linear search */
   ret = AIR_FALSE;
   for (i=0; i<trim->numF; i++) {
     pos = trim->pos + 3*trim->vert[0 + 3*i];
@@ -620,6 +753,50 @@ _echoRayIntx_List(RAYINTX_ARGS(List)) {
   return ret;
 }
 
+/*
+** iterative, front-to-back traversal of the flat BVH node array; the
+** only dispatch through _echoRayIntx[] is for the objects in leaves
+*/
+int
+_echoRayIntx_BVH(RAYINTX_ARGS(BVH)) {
+  echoPos_t idir[3], stackT[ECHO_BVH_DEPTH_MAX+2];
+  const echoBVHNode *nd;
+  unsigned int stack[ECHO_BVH_DEPTH_MAX+2], sp, ii;
+  int ret;
+  echoObject *kid;
+
+  _echoBVHInvDir(idir, ray);
+  ret = AIR_FALSE;
+  sp = 0;
+  if (_echoBVHBoxHit(stackT + sp, obj->node, ray, idir)) {
+    intx->boxhits++;
+    stack[sp++] = 0;
+  }
+  while (sp) {
+    sp--;
+    if (stackT[sp] > ray->faar) {
+      continue;
+    }
+    nd = obj->node + stack[sp];
+    if (nd->num) {
+      for (ii=0; ii<nd->num; ii++) {
+        kid = obj->obj[nd->offset + ii];
+        if (_echoRayIntx[kid->type](intx, ray, kid, parm, tstate)) {
+          ray->faar = intx->t;
+          ret = AIR_TRUE;
+          if (ray->shadow) {
+            return ret;
+          }
+        }
+      }
+    } else {
+      sp = _echoBVHDescend(stack, stackT, sp, nd, obj->node, ray, idir, intx);
+    }
+  }
+
+  return ret;
+}
+
 int
 _echoRayIntx_Instance(RAYINTX_ARGS(Instance)) {
   echoPos_t a[4], b[4], tmp;
@@ -692,6 +869,7 @@ _echoRayIntx[ECHO_TYPE_NUM] = {
   (_echoRayIntx_t)_echoRayIntx_Split,
   (_echoRayIntx_t)_echoRayIntx_List,
   (_echoRayIntx_t)_echoRayIntx_Instance,
+  (_echoRayIntx_t)_echoRayIntx_BVH,
 };
 
 _echoRayIntxUV_t
@@ -707,7 +885,8 @@ _echoRayIntxUV[ECHO_TYPE_NUM] = {
   _echoRayIntxUV_Noop,    /* echoTypeAABBox */
   _echoRayIntxUV_Noop,    /* echoTypeSplit */
   _echoRayIntxUV_Noop,    /* echoTypeList */
-  _echoRayIntxUV_Noop     /* echoTypeInstance */
+  _echoRayIntxUV_Noop,    /* echoTypeInstance */
+  _echoRayIntxUV_Noop     /* echoTypeBVH */
 };
 
 int
@@ -48,10 +48,12 @@ echoRTParmNew(void) {
     parm->seedRand = AIR_TRUE;
     parm->sqNRI = 15;
     parm->numThreads = 1;
+    parm->tileSize = 16;
     parm->sqTol = 0.0001;
     parm->aperture = 0.0;     /* pinhole camera by default */
     parm->timeGamma = 6.0;
     parm->boxOpac = 0.2f;
+    parm->adaptThresh = 0.0;  /* uniform sampling by default */
     parm->shadow = 1.0;
     parm->glassC = 3;
     ELL_3V_SET(parm->maxRecCol, 1.0, 0.0, 1.0);
@@ -80,6 +82,8 @@ echoGlobalStateNew(void) {
     state->parm = NULL;
     state->workIdx = 0;
     state->workMutex = NULL;
+    state->refinePass = AIR_FALSE;
+    state->refine = NULL;
   }
   return state;
 }
@@ -99,10 +99,15 @@ NEW_TMPL(TriMesh,
          obj->numV = obj->numF = 0;
          obj->pos = NULL;
          obj->vert = NULL;
+         obj->bvh = NULL;
+         obj->bvhNum = 0;
+         obj->bvhFace = NULL;
          )
 NIX_TMPL(TriMesh,
          obj->pos = (echoPos_t *)airFree(obj->pos);
          obj->vert = (int *)airFree(obj->vert);
+         obj->bvh = (echoBVHNode *)airFree(obj->bvh);
+         obj->bvhFace = (unsigned int *)airFree(obj->bvhFace);
          )
 
 NEW_TMPL(Isosurface,
@@ -144,6 +149,17 @@ NEW_TMPL(Instance,
          obj->obj = NULL;
          )
 
+NEW_TMPL(BVH,
+         obj->node = NULL;
+         obj->nodeNum = 0;
+         obj->obj = NULL;
+         obj->objNum = 0;
+         )
+NIX_TMPL(BVH,
+         obj->node = (echoBVHNode *)airFree(obj->node);
+         obj->obj = (echoObject **)airFree(obj->obj);
+         )
+
 echoObject *(*
 _echoObjectNew[ECHO_TYPE_NUM])(void) = {
   (echoObject *(*)(void))_echoSphere_new,
@@ -157,7 +173,8 @@ _echoObjectNew[ECHO_TYPE_NUM])(void) = {
   (echoObject *(*)(void))_echoAABBox_new,
   (echoObject *(*)(void))_echoSplit_new,
   (echoObject *(*)(void))_echoList_new,
-  (echoObject *(*)(void))_echoInstance_new
+  (echoObject *(*)(void))_echoInstance_new,
+  (echoObject *(*)(void))_echoBVH_new
 };
 
 echoObject *
@@ -197,7 +214,8 @@ _echoObjectNix[ECHO_TYPE_NUM])(echoObject *) = {
   (echoObject *(*)(echoObject *))airFree,          /* echoTypeAABBox */
   (echoObject *(*)(echoObject *))airFree,          /* echoTypeSplit */
   (echoObject *(*)(echoObject *))_echoList_nix,    /* echoTypeList */
-  (echoObject *(*)(echoObject *))airFree           /* echoTypeInstance */
+  (echoObject *(*)(echoObject *))airFree,          /* echoTypeInstance */
+  (echoObject *(*)(echoObject *))_echoBVH_nix      /* echoTypeBVH */
 };
 
 echoObject *
@@ -63,6 +63,7 @@ extern "C" {
 #define TRIMESH(obj)   ((echoTriMesh*)obj)
 #define TRIANGLE(obj)  ((echoTriangle*)obj)
 #define INSTANCE(obj)  ((echoInstance*)obj)
+#define BVH(obj)       ((echoBVH*)obj)
 
 #define _ECHO_REFLECT(refl, norm, view, tmp) \
   (tmp) = 2*ELL_3V_DOT((view), (norm)); \
@@ -89,6 +90,14 @@ extern int _echoRayIntx_CubeSolid(echoPos_t *tminP, echoPos_t *tmaxP,
                                   echoPos_t zmin, echoPos_t zmax,
                                   echoRay *ray);
 
+/* bvh.c */
+extern echoBVHNode *_echoBVHBuild(unsigned int *nodeNumP,
+                                  unsigned int *prim,
+                                  const echoPos_t *pmin,
+                                  const echoPos_t *pmax,
+                                  unsigned int primNum);
+extern void _echoTriMeshBVHSet(echoTriMesh *trim);
+
 /* sqd.c */
 extern int _echoRayIntx_Superquad(RAYINTX_ARGS(Superquad));
 
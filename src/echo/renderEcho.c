@@ -179,6 +179,15 @@ echoRTRenderCheck(Nrrd *nraw, limnCamera *cam, echoScene *scene,
     biffAddf(ECHO, "%s: aperture doesn't exist", me);
     return 1;
   }
+  if (!(parm->tileSize > 0)) {
+    biffAddf(ECHO, "%s: tile size (%d) invalid", me, parm->tileSize);
+    return 1;
+  }
+  if (!(AIR_EXISTS(parm->adaptThresh) && parm->adaptThresh >= 0)) {
+    biffAddf(ECHO, "%s: adaptive sampling threshold (%g) invalid", me,
+             parm->adaptThresh);
+    return 1;
+  }
 
   switch (parm->jitterType) {
   case echoJitterNone:
@@ -280,31 +289,120 @@ echoRayColor(echoCol_t *chan, echoRay *ray,
   return;
 }
 
-void *
-_echoRTRenderThreadBody(void *_arg) {
-  char done[20];
-  int imgUi, imgVi,         /* integral pixel indices */
-    samp;                   /* which sample are we doing */
+/*
+** things about the view that every pixel of a thread needs
+*/
+typedef struct {
+  echoPos_t pixUsz, pixVsz,  /* U and V dimensions of a pixel */
+    U[4], V[4], N[4],        /* view space basis (only first 3 used) */
+    eye[3],                  /* eye center before jittering */
+    imgOrig[3];              /* image origin */
+} _echoRTView;
+
+/*
+** _echoRTRenderPixel
+**
+** casts sampNum rays (either 1, or parm->numSamples) through pixel
+** (imgUi, imgVi), using the jitter vectors of samples samp0 through
+** samp0+sampNum-1, and sets the pixel's channels in img
+*/
+static void
+_echoRTRenderPixel(echoCol_t *img, int imgUi, int imgVi,
+                   int samp0, int sampNum,
+                   const _echoRTView *view, echoThreadState *arg) {
+  int samp;                 /* which sample are we doing */
   echoPos_t tmp0, tmp1,
-    pixUsz, pixVsz,         /* U and V dimensions of a pixel */
-    U[4], V[4], N[4],       /* view space basis (only first 3 elements used) */
     imgU, imgV,             /* floating point pixel center locations */
-    eye[3],                 /* eye center before jittering */
-    at[3],                  /* ray destination (pixel center post-jittering) */
-    imgOrig[3];             /* image origin */
+    at[3];                  /* ray destination (pixel center post-jittering) */
   double time0;
   echoRay ray;              /* (not a pointer) */
+  echoCol_t *chan;          /* current sample of channel buffer array */
+  limnCamera *cam;
+  echoScene *scene;
+  echoRTParm *parm;
+
+  cam = arg->gstate->cam;
+  scene = arg->gstate->scene;
+  parm = arg->gstate->parm;
+  ray.shadow = AIR_FALSE;
+
+  imgV = NRRD_POS(nrrdCenterCell, cam->vRange[0], cam->vRange[1],
+                  parm->imgResV, imgVi);
+  imgU = NRRD_POS(nrrdCenterCell, cam->uRange[0], cam->uRange[1],
+                  parm->imgResU, imgUi);
+
+  /* initialize things on first "scanline" */
+  arg->jitt = (echoPos_t *)arg->njitt->data + 2*ECHO_JITTABLE_NUM*samp0;
+  chan = arg->chanBuff;
+
+  /*
+  arg->verbose = ( (48 == imgUi && 13 == imgVi)
+                   || (49 == imgUi && 13 == imgVi) );
+  */
+
+  if (arg->verbose) {
+    fprintf(stderr, "\n");
+    fprintf(stderr, "-----------------------------------------------\n");
+    fprintf(stderr, "----------------- (%3d, %3d) ------------------\n",
+            imgUi, imgVi);
+    fprintf(stderr, "-----------------------------------------------\n\n");
+  }
+
+  /* go through samples */
+  for (samp=0; samp<sampNum; samp++) {
+    /* set ray.from[] */
+    ELL_3V_COPY(ray.from, view->eye);
+    if (parm->aperture) {
+      tmp0 = parm->aperture*(arg->jitt[0 + 2*echoJittableLens]);
+      tmp1 = parm->aperture*(arg->jitt[1 + 2*echoJittableLens]);
+      ELL_3V_SCALE_ADD3(ray.from, 1, ray.from, tmp0, view->U, tmp1, view->V);
+    }
+
+    /* set at[] */
+    tmp0 = imgU + view->pixUsz*(arg->jitt[0 + 2*echoJittablePixel]);
+    tmp1 = imgV + view->pixVsz*(arg->jitt[1 + 2*echoJittablePixel]);
+    ELL_3V_SCALE_ADD3(at, 1, view->imgOrig, tmp0, view->U, tmp1, view->V);
+
+    /* do it! */
+    ELL_3V_SUB(ray.dir, at, ray.from);
+    ELL_3V_NORM(ray.dir, ray.dir, tmp0);
+    ray.neer = 0.0;
+    ray.faar = ECHO_POS_MAX;
+    time0 = airTime();
+    echoRayColor(chan, &ray, scene, parm, arg);
+    chan[4] = AIR_CAST(echoCol_t, airTime() - time0);
+
+    /* move to next "scanline" */
+    arg->jitt += 2*ECHO_JITTABLE_NUM;
+    chan += ECHO_IMG_CHANNELS;
+  }
+  if (sampNum == parm->numSamples) {
+    echoChannelAverage(img, parm, arg);
+  } else {
+    /* a single sample, from first pass of progressive sampling */
+    ELL_4V_COPY(img, arg->chanBuff);
+    img[4] = arg->chanBuff[4];
+  }
+  return;
+}
+
+void *
+_echoRTRenderThreadBody(void *_arg) {
+  char done[20];
+  int imgUi, imgVi,         /* integral pixel indices */
+    tileIdx, tileNumU, tileNum, tsz,
+    sampNum,                /* # samples per pixel in this pass */
+    samp0;                  /* first unused sample in jitter array */
+  _echoRTView view;
   echoThreadState *arg;
-  echoCol_t *img, *chan;    /* current scanline of channel buffer array */
+  echoCol_t *img, time1;
   Nrrd *nraw;               /* copies of arguments to echoRTRender . . . */
   limnCamera *cam;
-  echoScene *scene;
   echoRTParm *parm;
 
   arg = (echoThreadState *)_arg;
   nraw = arg->gstate->nraw;
   cam = arg->gstate->cam;
-  scene = arg->gstate->scene;
   parm = arg->gstate->parm;
 
   echoJitterCompute(arg->gstate->parm, arg);
@@ -313,108 +411,157 @@ _echoRTRenderThreadBody(void *_arg) {
   }
 
   /* set eye, U, V, N, imgOrig */
-  ELL_3V_COPY(eye, arg->gstate->cam->from);
-  ELL_4MV_ROW0_GET(U, cam->W2V);
-  ELL_4MV_ROW1_GET(V, cam->W2V);
-  ELL_4MV_ROW2_GET(N, cam->W2V);
-  ELL_3V_SCALE_ADD2(imgOrig, 1.0, eye, cam->vspDist, N);
+  ELL_3V_COPY(view.eye, arg->gstate->cam->from);
+  ELL_4MV_ROW0_GET(view.U, cam->W2V);
+  ELL_4MV_ROW1_GET(view.V, cam->W2V);
+  ELL_4MV_ROW2_GET(view.N, cam->W2V);
+  ELL_3V_SCALE_ADD2(view.imgOrig, 1.0, view.eye, cam->vspDist, view.N);
 
   /* determine size of a single pixel (based on cell-centering) */
-  pixUsz = (cam->uRange[1] - cam->uRange[0])/(parm->imgResU);
-  pixVsz = (cam->vRange[1] - cam->vRange[0])/(parm->imgResV);
+  view.pixUsz = (cam->uRange[1] - cam->uRange[0])/(parm->imgResU);
+  view.pixVsz = (cam->vRange[1] - cam->vRange[0])/(parm->imgResV);
 
   arg->depth = 0;
-  ray.shadow = AIR_FALSE;
   arg->verbose = AIR_FALSE;
 
+  /* the first pass of progressive sampling is one sample per pixel */
+  sampNum = (parm->adaptThresh > 0 && !arg->gstate->refinePass
+             ? 1 : parm->numSamples);
+  samp0 = 0;
+  tsz = parm->tileSize;
+  tileNumU = (parm->imgResU + tsz - 1)/tsz;
+  tileNum = tileNumU*((parm->imgResV + tsz - 1)/tsz);
   while (1) {
     if (arg->gstate->workMutex) {
       airThreadMutexLock(arg->gstate->workMutex);
     }
-    imgVi = arg->gstate->workIdx;
-    if (arg->gstate->workIdx < parm->imgResV) {
+    tileIdx = arg->gstate->workIdx;
+    if (arg->gstate->workIdx < tileNum) {
       arg->gstate->workIdx += 1;
     }
-    if (!(imgVi % 5)) {
-      fprintf(stderr, "%s", airDoneStr(0, imgVi, parm->imgResV-1, done));
+    if (tileNum > 1 && !(tileIdx % 5)) {
+      fprintf(stderr, "%s", airDoneStr(0, tileIdx, tileNum-1, done));
       fflush(stderr);
     }
     if (arg->gstate->workMutex) {
       airThreadMutexUnlock(arg->gstate->workMutex);
     }
-    if (imgVi == parm->imgResV) {
+    if (tileIdx == tileNum) {
       /* we're done! */
       break;
     }
 
-    imgV = NRRD_POS(nrrdCenterCell, cam->vRange[0], cam->vRange[1],
-                    parm->imgResV, imgVi);
-    for (imgUi=0; imgUi<parm->imgResU; imgUi++) {
-      imgU = NRRD_POS(nrrdCenterCell, cam->uRange[0], cam->uRange[1],
-                      parm->imgResU, imgUi);
-      img = ((echoCol_t *)nraw->data
-             + ECHO_IMG_CHANNELS*(imgUi + parm->imgResU*imgVi));
-
-      /* initialize things on first "scanline" */
-      arg->jitt = (echoPos_t *)arg->njitt->data;
-      chan = arg->chanBuff;
-
-      /*
-      arg->verbose = ( (48 == imgUi && 13 == imgVi)
-                       || (49 == imgUi && 13 == imgVi) );
-      */
-
-      if (arg->verbose) {
-        fprintf(stderr, "\n");
-        fprintf(stderr, "-----------------------------------------------\n");
-        fprintf(stderr, "----------------- (%3d, %3d) ------------------\n",
-                imgUi, imgVi);
-        fprintf(stderr, "-----------------------------------------------\n\n");
+    for (imgVi = tsz*(tileIdx / tileNumU);
+         imgVi < AIR_MIN(tsz*(tileIdx / tileNumU + 1), parm->imgResV);
+         imgVi++) {
+      for (imgUi = tsz*(tileIdx % tileNumU);
+           imgUi < AIR_MIN(tsz*(tileIdx % tileNumU + 1), parm->imgResU);
+           imgUi++) {
+        img = ((echoCol_t *)nraw->data
+               + ECHO_IMG_CHANNELS*(imgUi + parm->imgResU*imgVi));
+        if (arg->gstate->refinePass) {
+          if (!arg->gstate->refine[imgUi + parm->imgResU*imgVi]) {
+            continue;
+          }
+          /* the time channel includes the first pass */
+          time1 = img[4];
+          _echoRTRenderPixel(img, imgUi, imgVi, samp0, sampNum, &view, arg);
+          img[4] += time1;
+        } else {
+          _echoRTRenderPixel(img, imgUi, imgVi, samp0, sampNum, &view, arg);
+        }
+        /* with one sample per pixel, successive pixels use successive
+           samples, so that jitter is computed as often as per sample
+           as with uniform sampling */
+        samp0 += sampNum;
+        if (samp0 == parm->numSamples) {
+          samp0 = 0;
+          if (!parm->reuseJitter) {
+            echoJitterCompute(parm, arg);
+          }
+        }
       }
+    }
+  }
 
-      /* go through samples */
-      for (samp=0; samp<parm->numSamples; samp++) {
-        /* set ray.from[] */
-        ELL_3V_COPY(ray.from, eye);
-        if (parm->aperture) {
-          tmp0 = parm->aperture*(arg->jitt[0 + 2*echoJittableLens]);
-          tmp1 = parm->aperture*(arg->jitt[1 + 2*echoJittableLens]);
-          ELL_3V_SCALE_ADD3(ray.from, 1, ray.from, tmp0, U, tmp1, V);
-        }
+  return _arg;
+}
 
-        /* set at[] */
-        tmp0 = imgU + pixUsz*(arg->jitt[0 + 2*echoJittablePixel]);
-        tmp1 = imgV + pixVsz*(arg->jitt[1 + 2*echoJittablePixel]);
-        ELL_3V_SCALE_ADD3(at, 1, imgOrig, tmp0, U, tmp1, V);
-
-        /* do it! */
-        ELL_3V_SUB(ray.dir, at, ray.from);
-        ELL_3V_NORM(ray.dir, ray.dir, tmp0);
-        ray.neer = 0.0;
-        ray.faar = ECHO_POS_MAX;
-        time0 = airTime();
-        if (0) {
-          memset(chan, 0, ECHO_IMG_CHANNELS*sizeof(echoCol_t));
-        } else {
-          echoRayColor(chan, &ray, scene, parm, arg);
+/*
+** _echoRTRefineSet
+**
+** after the first pass of progressive sampling, decides which pixels
+** get numSamples samples in the second: those where, in any of the
+** r,g,b,a channels, the variance over the 3x3 neighborhood of first
+** pass samples exceeds parm->adaptThresh.  Returns the number of such
+** pixels.
+*/
+static int
+_echoRTRefineSet(echoGlobalState *gstate) {
+  echoRTParm *parm;
+  echoCol_t *raw, val, sum[4], sqsum[4], var;
+  int ui, vi, uu, vv, ci, num, refNum;
+
+  parm = gstate->parm;
+  raw = (echoCol_t *)gstate->nraw->data;
+  refNum = 0;
+  for (vi=0; vi<parm->imgResV; vi++) {
+    for (ui=0; ui<parm->imgResU; ui++) {
+      ELL_4V_SET(sum, 0, 0, 0, 0);
+      ELL_4V_SET(sqsum, 0, 0, 0, 0);
+      num = 0;
+      for (vv=AIR_MAX(vi-1, 0); vv<=AIR_MIN(vi+1, parm->imgResV-1); vv++) {
+        for (uu=AIR_MAX(ui-1, 0); uu<=AIR_MIN(ui+1, parm->imgResU-1);
+             uu++) {
+          for (ci=0; ci<4; ci++) {
+            val = raw[ci + ECHO_IMG_CHANNELS*(uu + parm->imgResU*vv)];
+            sum[ci] += val;
+            sqsum[ci] += val*val;
+          }
+          num++;
         }
-        chan[4] = AIR_CAST(echoCol_t, airTime() - time0);
-
-        /* move to next "scanline" */
-        arg->jitt += 2*ECHO_JITTABLE_NUM;
-        chan += ECHO_IMG_CHANNELS;
       }
-      echoChannelAverage(img, parm, arg);
-      img += ECHO_IMG_CHANNELS;
-      if (!parm->reuseJitter) {
-        echoJitterCompute(parm, arg);
+      gstate->refine[ui + parm->imgResU*vi] = AIR_FALSE;
+      for (ci=0; ci<4; ci++) {
+        var = sqsum[ci]/num - (sum[ci]/num)*(sum[ci]/num);
+        if (var > parm->adaptThresh) {
+          gstate->refine[ui + parm->imgResU*vi] = AIR_TRUE;
+          refNum++;
+          break;
+        }
       }
     }
   }
-
-  return _arg;
+  return refNum;
 }
 
+/*
+** _echoRTRenderPass
+**
+** runs all the threads once over all the tiles of the image
+*/
+static int
+_echoRTRenderPass(echoThreadState **tstate, echoGlobalState *gstate) {
+  static const char me[]="_echoRTRenderPass";
+  int tid, ret;
+
+  gstate->workIdx = 0;
+  for (tid=0; tid<gstate->parm->numThreads; tid++) {
+    if (( ret = airThreadStart(tstate[tid]->thread, _echoRTRenderThreadBody,
+                               (void *)(tstate[tid])) )) {
+      biffAddf(ECHO, "%s: thread[%d] failed to start: %d", me, tid, ret);
+      return 1;
+    }
+  }
+  for (tid=0; tid<gstate->parm->numThreads; tid++) {
+    if (( ret = airThreadJoin(tstate[tid]->thread,
+                              (void **)(&(tstate[tid]->returnPtr))) )) {
+      biffAddf(ECHO, "%s: thread[%d] failed to join: %d", me, tid, ret);
+      return 1;
+    }
+  }
+  return 0;
+}
 
 /*
 ******** echoRTRender
@@ -422,12 +569,16 @@ _echoRTRenderThreadBody(void *_arg) {
 ** top-level call to accomplish all (ray-tracing) rendering.  As much
 ** error checking as possible should be done here and not in the
 ** lower-level functions.
+**
+** Work is handed out to threads in square tiles of parm->tileSize
+** pixels on edge.  With parm->adaptThresh > 0 (and parm->numSamples > 1)
+** rendering is done in two passes, see _echoRTRefineSet().
 */
 int
 echoRTRender(Nrrd *nraw, limnCamera *cam, echoScene *scene,
              echoRTParm *parm, echoGlobalState *gstate) {
   static const char me[]="echoRTRender";
-  int tid, ret;
+  int tid, refNum;
   airArray *mop;
   echoThreadState *tstate[ECHO_THREAD_MAX];
 
@@ -474,22 +625,34 @@ echoRTRender(Nrrd *nraw, limnCamera *cam, echoScene *scene,
     }
     airMopAdd(mop, tstate[tid], (airMopper)echoThreadStateNix, airMopAlways);
   }
+  gstate->refinePass = AIR_FALSE;
+  gstate->refine = NULL;
   fprintf(stderr, "%s:       ", me);  /* prep for printing airDoneStr */
-  gstate->workIdx = 0;
-  for (tid=0; tid<parm->numThreads; tid++) {
-    if (( ret = airThreadStart(tstate[tid]->thread, _echoRTRenderThreadBody,
-                               (void *)(tstate[tid])) )) {
-      biffAddf(ECHO, "%s: thread[%d] failed to start: %d", me, tid, ret);
+  if (_echoRTRenderPass(tstate, gstate)) {
+    biffAddf(ECHO, "%s: trouble rendering", me);
+    airMopError(mop); return 1;
+  }
+  if (parm->adaptThresh > 0 && parm->numSamples > 1) {
+    gstate->refine = AIR_CALLOC(parm->imgResU*parm->imgResV, unsigned char);
+    if (!gstate->refine) {
+      biffAddf(ECHO, "%s: couldn't allocate refinement mask", me);
       airMopError(mop); return 1;
     }
-  }
-  for (tid=0; tid<parm->numThreads; tid++) {
-    if (( ret = airThreadJoin(tstate[tid]->thread,
-                              (void **)(&(tstate[tid]->returnPtr))) )) {
-      biffAddf(ECHO, "%s: thread[%d] failed to join: %d", me, tid, ret);
+    airMopAdd(mop, gstate->refine, airFree, airMopAlways);
+    refNum = _echoRTRefineSet(gstate);
+    fprintf(stderr, "\n%s: refining %d of %d pixels:       ", me,
+            refNum, parm->imgResU*parm->imgResV);
+    gstate->refinePass = AIR_TRUE;
+    if (refNum && _echoRTRenderPass(tstate, gstate)) {
+      biffAddf(ECHO, "%s: trouble refining", me);
+      gstate->refinePass = AIR_FALSE;
+      gstate->refine = NULL;
       airMopError(mop); return 1;
     }
+    gstate->refinePass = AIR_FALSE;
   }
+  /* refine is freed by mop */
+  gstate->refine = NULL;
 
   gstate->time = airTime() - gstate->time;
   fprintf(stderr, "\n%s: time = %g\n", me, gstate->time);
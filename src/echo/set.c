@@ -90,7 +90,8 @@ echoTriangleSet(echoObject *tri,
 **
 ** This has to be called any time that the locations of the points are
 ** changing, even if the connectivity is not changed, because of how
-** the bounding box and mean vert position is calculated here.
+** the bounding box, mean vert position, and BVH over the triangles
+** are calculated here.
 **
 ** NB: the TriMesh will directly use the given pos[] and vert[] arrays,
 ** so don't go freeing them after they've been passed here.
@@ -115,6 +116,7 @@ echoTriMeshSet(echoObject *trim,
       ELL_3V_INCR(TRIMESH(trim)->meanvert, pos + 3*i);
     }
     ELL_3V_SCALE(TRIMESH(trim)->meanvert, 1.0/numV, TRIMESH(trim)->meanvert);
+    _echoTriMeshBVHSet(TRIMESH(trim));
   }
   return;
 }
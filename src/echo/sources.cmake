@@ -2,6 +2,7 @@
 # Add new source files here.
 set(ECHO_SOURCES
   bounds.c
+  bvh.c
   color.c
   echo.h
   enumsEcho.c
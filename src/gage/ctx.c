@@ -75,6 +75,7 @@ gageContextNew() {
     strcpy(ctx->errStr, "");
     ctx->errNum = gageErrNone;
     ctx->edgeFrac = 0;
+    ctx->probeNum = ctx->fillNum = 0;
   }
   return ctx;
 }
@@ -160,6 +161,7 @@ gageContextCopy(gageContext *ctx) {
 
   /* make sure gageProbe() has to refill caches */
   gagePointReset(&ntx->point);
+  ntx->probeNum = ntx->fillNum = 0;
 
   return ntx;
 }
@@ -510,8 +512,12 @@ gagePerVolumeDetach(gageContext *ctx, gagePerVolume *pvl) {
 ** "switch(pvl->kind->valLen)", and #define'ing fddd to 64 (for 4x4x4
 ** neighborhoods) did not noticeably speed anything up.
 **
+** Per-volumes of lazily blurred stacks (pvl->lazy) are instead filled
+** by _gageStackLazyIv3Fill, which can fail (if a brick can't be
+** blurred); the return is non-zero, with ctx->errNum and ctx->errStr
+** set, in that case.
 */
-void
+int
 gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
   static const char me[]="gageIv3Fill";
   int lx, ly, lz, hx, hy, hz, _xx, _yy, _zz;
@@ -521,6 +527,9 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
   char *data, *here;
   unsigned int tup;
 
+  if (pvl->lazy) {
+    return _gageStackLazyIv3Fill(ctx, pvl);
+  }
   sx = ctx->shape->size[0];
   sy = ctx->shape->size[1];
   sz = ctx->shape->size[2];
@@ -686,7 +695,7 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
   if (ctx->verbose > 1) {
     fprintf(stderr, "%s: ^^^ bye\n", me);
   }
-  return;
+  return 0;
 }
 
 /*
@@ -743,6 +752,8 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
        point.idx[3] AND changes in stackFwNonZeroNum */
     idxChanged |= oldNnz != ctx->point.stackFwNonZeroNum;
   }
+  ctx->probeNum++;
+  ctx->fillNum += !!idxChanged;
   if (ctx->verbose > 3) {
     fprintf(stderr, "%s: oldIdx %u %u %u %u, point.idx %u %u %u %u --> %d\n",
             me, oldIdx[0], oldIdx[1], oldIdx[2], oldIdx[3],
@@ -756,7 +767,12 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
           fprintf(stderr, "%s: gageIv3Fill(pvl[%u/%u] %s): .......\n", me,
                   pvlIdx, ctx->pvlNum, ctx->pvl[pvlIdx]->kind->name);
         }
-        gageIv3Fill(ctx, ctx->pvl[pvlIdx]);
+        if (gageIv3Fill(ctx, ctx->pvl[pvlIdx])) {
+          /* ctx->errNum and ctx->errStr have been set; make sure the
+             next probe tries again to fill the iv3s */
+          gagePointReset(&ctx->point);
+          return 1;
+        }
       }
     } else {
       for (pvlIdx=0; pvlIdx<ctx->pvlNum-1; pvlIdx++) {
@@ -770,7 +786,11 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
             fprintf(stderr, "%s: stackFw[%u] == %g -> iv3fill needed\n", me,
                     pvlIdx, ctx->stackFw[pvlIdx]);
           }
-          gageIv3Fill(ctx, ctx->pvl[pvlIdx]);
+          if (gageIv3Fill(ctx, ctx->pvl[pvlIdx])) {
+            /* as above */
+            gagePointReset(&ctx->point);
+            return 1;
+          }
         } else {
           if (ctx->verbose > 3) {
             fprintf(stderr, "%s: stackFw[%u] == %g -> NO iv3fill\n", me,
@@ -146,9 +146,10 @@ enum {
   gageErrStackSearch,        /* 5: for some reason couldn't find the index
                                    position of the probed stack location */
   gageErrStackUnused,        /* 6: can't probe stack without parm.stackUse */
+  gageErrStackLazy,          /* 7: couldn't blur a brick of a lazy stack */
   gageErrLast
 };
-#define GAGE_ERR_MAX            6
+#define GAGE_ERR_MAX            7
 
 /*
 ******** gage{Ctx,Pvl}Flag.. enum
@@ -778,6 +779,13 @@ typedef struct gageContext_t {
      value is NOT meaningfully set if there is no clamping, and the probe
      location as fallen outside the volume */
   double edgeFrac;
+
+  /* simple tallies, for measuring the locality of probing: probeNum is
+     how many calls to gageProbe() (and friends) landed inside the volume,
+     and fillNum is how many of those required the iv3 caches to be
+     refilled.  Both are zeroed by gageContextNew() and gageContextCopy(),
+     and may be zeroed by the user at any time */
+  size_t probeNum, fillNum;
 } gageContext;
 
 /*
@@ -816,6 +824,15 @@ typedef struct gagePerVolume_t {
                                  so there is no channel for extra info to be
                                  passed into the pvl->data, other that what
                                  was put into kind->data */
+  struct gageStackLazy_t *lazy; /* if non-NULL, this is level lazyIdx of
+                                 a lazily blurred stack, and nin is the
+                                 (unblurred) volume it is blurred from;
+                                 see gageStackLazyPerVolumeNew */
+  unsigned int lazyIdx,
+    lazyPinLo[3], lazyPinHi[3]; /* if lazyPinned, the range of bricks
+                                 (of level lazyIdx) that this holds
+                                 pinned, since the last iv3 fill */
+  int lazyPinned;
 } gagePerVolume;
 
 /*
@@ -937,6 +954,20 @@ typedef struct {
                             along the first (fastest) axis */
     needSpatialBlur,     /* always do blurring in the spatial domain, even
                             if frequency space blurring is possible */
+    recursive,           /* (for Gaussian kernels) do spatial blurring with
+                            a recursive (IIR) filter approximating the
+                            continuous Gaussian, with per-sample cost
+                            independent of sigma; scales below
+                            gageStackBlurRecursiveSigmaMin are still
+                            blurred with kspec */
+    pyramid,             /* (for Gaussian kernels) blur the larger scales
+                            by upsampling from downsampled (and blurred)
+                            copies of the input, which are shared among
+                            scales; scales too small to be downsampled
+                            with gageStackBlurPyramidSigmaMin accuracy
+                            are still blurred with kspec.  Results differ
+                            from direct blurring by up to about 2e-5 of
+                            the data range */
     verbose;             /* verbosity level */
   double dgGoodSigmaMax; /* The same info as communicated by
                             nrrdKernelDiscreteGaussianGoodSigmaMax, but
@@ -948,6 +979,45 @@ typedef struct {
                             steps in diffusion time of goodSigmaMax^2 */
 } gageStackBlurParm;
 
+/*
+******** gageStackLazy struct
+**
+** For probing scale-space without blurring all of it ahead of time:
+** the levels are divided into bricks, which are blurred (from nin, as
+** described by sbp) when probing first needs them, and kept in a cache
+** shared by all levels and limited to memMax bytes, from which the
+** least recently used bricks are evicted.  See stackLazy.c.
+*/
+#define GAGE_STACK_LAZY_MUTEX_NUM 16 /* # of mutexes for brick slots */
+typedef struct gageStackLazy_t {
+  const Nrrd *nin;             /* volume being blurred; don't own */
+  const struct gageKind_t *kind; /* its kind */
+  gageStackBlurParm *sbp;      /* (our own copy of) how to blur */
+  unsigned int brickSize,      /* samples along each edge of a brick (fewer
+                                  for the last brick along an axis) */
+    brickNum[3],               /* number of bricks along each axis */
+    slotNum;                   /* sbp->num times bricks per level */
+  Nrrd **nbrick;               /* slotNum bricks, level slowest, NULL for
+                                  those not (or no longer) blurred */
+  unsigned int *pinNum,        /* per slot: # of per-volumes using it */
+    *lruPrev, *lruNext,        /* per slot: neighbors in the list of bricks
+                                  that are blurred but not pinned, from
+                                  least to most recently used (slotNum
+                                  for none) */
+    lruFirst, lruLast;         /* ends of that list (slotNum if empty) */
+  size_t memMax,               /* bytes allowed for bricks, or 0 for no
+                                  limit */
+    memUsed;                   /* bytes currently used by bricks */
+  unsigned int computeNum,     /* # of bricks blurred so far */
+    evictNum;                  /* # of bricks evicted so far */
+  airThreadMutex *slotMutex[GAGE_STACK_LAZY_MUTEX_NUM], /* slot si's nbrick
+                                  and pinNum are guarded by slotMutex[si %
+                                  GAGE_STACK_LAZY_MUTEX_NUM] */
+    *lruMutex;                 /* guards the list, memUsed, computeNum,
+                                  and evictNum; may be locked while
+                                  holding a slotMutex, not vice versa */
+} gageStackLazy;
+
 /*
 ******** gageOptimSigContext struct
 **
@@ -1203,6 +1273,8 @@ GAGE_EXPORT int gageStackProbeSpace(gageContext *ctx,
 
 /* stackBlur.c */
 GAGE_EXPORT const airEnum *const gageSigmaSampling;
+GAGE_EXPORT const double gageStackBlurRecursiveSigmaMin;
+GAGE_EXPORT const double gageStackBlurPyramidSigmaMin;
 GAGE_EXPORT gageStackBlurParm *gageStackBlurParmNew(void);
 GAGE_EXPORT int gageStackBlurParmCopy(gageStackBlurParm *sbpDst,
                                       const gageStackBlurParm *sbpSrc);
@@ -1236,6 +1308,10 @@ GAGE_EXPORT int gageStackBlurParmBoundarySpecSet(gageStackBlurParm *sbp,
                                                  const NrrdBoundarySpec *bsp);
 GAGE_EXPORT int gageStackBlurParmNeedSpatialBlurSet(gageStackBlurParm *sbp,
                                                     int sblur);
+GAGE_EXPORT int gageStackBlurParmRecursiveSet(gageStackBlurParm *sbp,
+                                              int recursive);
+GAGE_EXPORT int gageStackBlurParmPyramidSet(gageStackBlurParm *sbp,
+                                            int pyramid);
 GAGE_EXPORT int gageStackBlurParmVerboseSet(gageStackBlurParm *sbp,
                                             int verbose);
 GAGE_EXPORT int gageStackBlurParmOneDimSet(gageStackBlurParm *sbp,
@@ -1265,6 +1341,24 @@ GAGE_EXPORT int gageStackBlurManage(Nrrd ***nblurP, int *recomputedP,
                                     int saveIfComputed, NrrdEncoding *enc,
                                     const Nrrd *nin, const gageKind *kind);
 
+/* stackCache.c */
+GAGE_EXPORT int gageStackBlurCacheGet(Nrrd *const nblur[], int *recomputedP,
+                                      gageStackBlurParm *sbp,
+                                      const char *cacheDir,
+                                      double cacheSizeMax,
+                                      const Nrrd *nin, const gageKind *kind);
+
+/* stackLazy.c */
+GAGE_EXPORT gageStackLazy *gageStackLazyNew(const Nrrd *nin,
+                                            const gageKind *kind,
+                                            const gageStackBlurParm *sbp,
+                                            unsigned int brickSize,
+                                            double memMax);
+GAGE_EXPORT gageStackLazy *gageStackLazyNix(gageStackLazy *lazy);
+GAGE_EXPORT int gageStackLazyPerVolumeNew(gageContext *ctx,
+                                          gagePerVolume **pvlStack,
+                                          gageStackLazy *lazy);
+
 /* ctx.c */
 GAGE_EXPORT gageContext *gageContextNew(void);
 GAGE_EXPORT gageContext *gageContextCopy(gageContext *ctx);
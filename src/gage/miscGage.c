@@ -181,7 +181,8 @@ _gageErrStr[GAGE_ERR_MAX+1] = {
   "stack bounds",
   "stack integral",
   "stack search",
-  "stack unused"
+  "stack unused",
+  "stack lazy"
 };
 
 const airEnum
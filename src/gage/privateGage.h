@@ -65,6 +65,10 @@ extern int _gageLocationSet(gageContext *ctx,
 /* stack.c */
 extern int _gageStackBaseIv3Fill(gageContext *ctx);
 
+/* stackLazy.c */
+extern int _gageStackLazyIv3Fill(gageContext *ctx, gagePerVolume *pvl);
+extern void _gageStackLazyRelease(gagePerVolume *pvl);
+
 /* sclprint.c */
 extern void _gageSclIv3Print(FILE *, gageContext *ctx, gagePerVolume *pvl);
 
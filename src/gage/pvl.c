@@ -109,6 +109,9 @@ gagePerVolumeNew(gageContext *ctx, const Nrrd *nin, const gageKind *kind) {
     pvl->directAnswer[ii] = pvl->answer + gageKindAnswerOffset(kind, ii);
   }
   pvl->flag[gagePvlFlagVolume] = AIR_TRUE;
+  pvl->lazy = NULL;
+  pvl->lazyIdx = 0;
+  pvl->lazyPinned = AIR_FALSE;
   if (kind->pvlDataNew) {
     if (!(pvl->data = kind->pvlDataNew(kind))) {
       biffAddf(GAGE, "%s: double creating gagePerVolume data", me);
@@ -146,6 +149,8 @@ _gagePerVolumeCopy(gagePerVolume *pvl, unsigned int fd) {
      constant state of gage construction, this seems much simpler.
      Pointers to per-pervolume-allocated arrays are fixed below */
   memcpy(nvl, pvl, sizeof(gagePerVolume));
+  /* the bricks that pvl holds pinned are its own */
+  nvl->lazyPinned = AIR_FALSE;
   nvl->iv3 = AIR_CALLOC(fd*fd*fd*nvl->kind->valLen, double);
   nvl->iv2 = AIR_CALLOC(fd*fd*nvl->kind->valLen, double);
   nvl->iv1 = AIR_CALLOC(fd*nvl->kind->valLen, double);
@@ -193,6 +198,9 @@ gagePerVolume *
 gagePerVolumeNix(gagePerVolume *pvl) {
 
   if (pvl) {
+    if (pvl->lazy) {
+      _gageStackLazyRelease(pvl);
+    }
     if (pvl->kind->pvlDataNix) {
       pvl->data = pvl->kind->pvlDataNix(pvl->kind, pvl->data);
     }
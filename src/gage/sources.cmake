@@ -19,6 +19,8 @@ set(GAGE_SOURCES
   st.c
   stack.c
   stackBlur.c
+  stackCache.c
+  stackLazy.c
   update.c
   vecGage.c
   vecprint.c
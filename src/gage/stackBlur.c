@@ -69,6 +69,21 @@ _gageSigmaSampling_enum = {
 const airEnum *const
 gageSigmaSampling = &_gageSigmaSampling_enum;
 
+/* scales below this are not blurred recursively (with
+   gageStackBlurParm->recursive), since Deriche's approximation of the
+   Gaussian degrades quickly for smaller sigma */
+const double gageStackBlurRecursiveSigmaMin = 1.0;
+
+/* with gageStackBlurParm->pyramid, the blurrings done before
+   downsampling and while upsampling (on a grid with spacing "factor")
+   are both Gaussians with at least this sigma, in units of the coarse
+   grid. That attenuates the frequencies that can alias by at least
+   exp(-pi^2/2) in each of the two stages, for an overall error of
+   about 5e-5 (relative to the range of values), which is comparable to
+   that of recursive blurring. The smallest scale blurred this way is
+   sqrt(2)*2*gageStackBlurPyramidSigmaMin */
+const double gageStackBlurPyramidSigmaMin = 1.0;
+
 
 void
 gageStackBlurParmInit(gageStackBlurParm *parm) {
@@ -89,6 +104,8 @@ gageStackBlurParmInit(gageStackBlurParm *parm) {
     /* the cautious application of the FFT--based blurring justifies enables
        it by default */
     parm->needSpatialBlur = AIR_FALSE;
+    parm->recursive = AIR_FALSE;
+    parm->pyramid = AIR_FALSE;
     parm->verbose = 1; /* HEY: this may be revisited */
     parm->dgGoodSigmaMax = nrrdKernelDiscreteGaussianGoodSigmaMax;
   }
@@ -176,6 +193,8 @@ gageStackBlurParmCompare(const gageStackBlurParm *aa, const char *_nameA,
   CHECK(renormalize, %d);
   CHECK(oneDim, %d);
   CHECK(needSpatialBlur, %d);
+  CHECK(recursive, %d);
+  CHECK(pyramid, %d);
   /* This is sketchy: the apparent point of the function is to see if two
      sbp's are different.  But a big role of the function is to enable
      leeching in meet.  And for leeching, a difference in verbose is moot */
@@ -249,6 +268,8 @@ gageStackBlurParmCopy(gageStackBlurParm *dst,
       || gageStackBlurParmDgGoodSigmaMaxSet(dst, src->dgGoodSigmaMax)
       || gageStackBlurParmBoundarySpecSet(dst, src->bspec)
       || gageStackBlurParmNeedSpatialBlurSet(dst, src->needSpatialBlur)
+      || gageStackBlurParmRecursiveSet(dst, src->recursive)
+      || gageStackBlurParmPyramidSet(dst, src->pyramid)
       || gageStackBlurParmVerboseSet(dst, src->verbose)
       || gageStackBlurParmOneDimSet(dst, src->oneDim)) {
     biffAddf(GAGE, "%s: problem setting dst parm", me);
@@ -481,6 +502,30 @@ gageStackBlurParmNeedSpatialBlurSet(gageStackBlurParm *sbp,
   return 0;
 }
 
+int
+gageStackBlurParmRecursiveSet(gageStackBlurParm *sbp, int recursive) {
+  static const char me[]="gageStackBlurParmRecursiveSet";
+
+  if (!sbp) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  sbp->recursive = recursive;
+  return 0;
+}
+
+int
+gageStackBlurParmPyramidSet(gageStackBlurParm *sbp, int pyramid) {
+  static const char me[]="gageStackBlurParmPyramidSet";
+
+  if (!sbp) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  sbp->pyramid = pyramid;
+  return 0;
+}
+
 int
 gageStackBlurParmVerboseSet(gageStackBlurParm *sbp, int verbose) {
   static const char me[]="gageStackBlurParmVerboseSet";
@@ -551,6 +596,24 @@ gageStackBlurParmCheck(const gageStackBlurParm *sbp) {
   }
   /* HEY: no sanity check on kernel because there is no
      nrrdKernelSpecCheck(), but there should be! */
+  if (sbp->recursive
+      && !(nrrdKernelGaussian == sbp->kspec->kernel
+           || nrrdKernelDiscreteGaussian == sbp->kspec->kernel)) {
+    biffAddf(GAGE, "%s: recursive blurring only approximates a Gaussian, "
+             "but kernel is %s", me, sbp->kspec->kernel->name);
+    return 1;
+  }
+  if (sbp->pyramid
+      && !(nrrdKernelGaussian == sbp->kspec->kernel
+           || nrrdKernelDiscreteGaussian == sbp->kspec->kernel)) {
+    biffAddf(GAGE, "%s: pyramid blurring only approximates a Gaussian, "
+             "but kernel is %s", me, sbp->kspec->kernel->name);
+    return 1;
+  }
+  if (sbp->recursive && sbp->pyramid) {
+    biffAddf(GAGE, "%s: can't do both recursive and pyramid blurring", me);
+    return 1;
+  }
   if (nrrdBoundarySpecCheck(sbp->bspec)) {
     biffMovef(GAGE, NRRD, "%s: problem with boundary", me);
     return 1;
@@ -642,8 +705,10 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
          'u': uniform (in sigma) sampling
          'o': optimized (3d l2l2) sampling
          'p': need spatial blur
+         'i': recursive (IIR) blurring
+         'd': pyramid (downsampled) blurring of larger scales
       */
-      if (strchr("1ruop", *ff)) {
+      if (strchr("1ruopid", *ff)) {
         flagSeen[AIR_CAST(unsigned char, *ff)] = AIR_TRUE;
       } else {
         if (extraFlags) {
@@ -775,6 +840,12 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
   if (flagSeen['p']) {
     if (!E) E |= gageStackBlurParmNeedSpatialBlurSet(sbp, AIR_TRUE);
   }
+  if (flagSeen['i']) {
+    if (!E) E |= gageStackBlurParmRecursiveSet(sbp, AIR_TRUE);
+  }
+  if (flagSeen['d']) {
+    if (!E) E |= gageStackBlurParmPyramidSet(sbp, AIR_TRUE);
+  }
   if (verboseGot) {
     if (!E) E |= gageStackBlurParmVerboseSet(sbp, verbose);
   }
@@ -829,12 +900,16 @@ gageStackBlurParmSprint(char str[AIR_STRLEN_LARGE],
   needFlags = (sbp->oneDim
                || sbp->renormalize
                || sbp->needSpatialBlur
+               || sbp->recursive
+               || sbp->pyramid
                || hef);
   if (needFlags) {
     strcat(out, "-");
     if (sbp->oneDim)          { strcat(out, "1"); }
     if (sbp->renormalize)     { strcat(out, "r"); }
     if (sbp->needSpatialBlur) { strcat(out, "p"); }
+    if (sbp->recursive)       { strcat(out, "i"); }
+    if (sbp->pyramid)         { strcat(out, "d"); }
     if (hef) {
       for (fi=0; fi<256; fi++) {
         if (extraFlag[fi]) {
@@ -929,6 +1004,73 @@ _gageHestStackBlurParm = {
 hestCB *
 gageHestStackBlurParm = &_gageHestStackBlurParm;
 
+/* equality of doubles that may be non-existent (as for space vectors
+   of non-spatial axes); all non-existent values are considered equal */
+static int
+_sameDouble(double aa, double bb) {
+  return (AIR_EXISTS(aa)
+          ? aa == bb
+          : !AIR_EXISTS(bb));
+}
+
+/*
+** whether nblur has the same orientation as nin: space, space
+** origin, and per-axis spacing, centering, and space direction,
+** including the non-spatial axes of a non-scalar kind
+*/
+static int
+_sameOrient(const Nrrd *nblur, const Nrrd *nin, unsigned int blIdx) {
+  static const char me[]="_sameOrient";
+  unsigned int axi, si;
+
+  if (nblur->dim != nin->dim) {
+    biffAddf(GAGE, "%s: nblur[%u]->dim %u != nin->dim %u", me,
+             blIdx, nblur->dim, nin->dim);
+    return 0;
+  }
+  if (!( nblur->space == nin->space
+         && nblur->spaceDim == nin->spaceDim )) {
+    biffAddf(GAGE, "%s: nblur[%u] space %s (dim %u) != nin's %s (dim %u)",
+             me, blIdx, airEnumStr(nrrdSpace, nblur->space),
+             nblur->spaceDim, airEnumStr(nrrdSpace, nin->space),
+             nin->spaceDim);
+    return 0;
+  }
+  for (si=0; si<nin->spaceDim; si++) {
+    if (!_sameDouble(nblur->spaceOrigin[si], nin->spaceOrigin[si])) {
+      biffAddf(GAGE, "%s: nblur[%u] space origin[%u] %g != nin's %g", me,
+               blIdx, si, nblur->spaceOrigin[si], nin->spaceOrigin[si]);
+      return 0;
+    }
+  }
+  for (axi=0; axi<nin->dim; axi++) {
+    const NrrdAxisInfo *baxis, *iaxis;
+    baxis = nblur->axis + axi;
+    iaxis = nin->axis + axi;
+    if (!( baxis->size == iaxis->size
+           && _sameDouble(baxis->spacing, iaxis->spacing)
+           && baxis->center == iaxis->center )) {
+      biffAddf(GAGE, "%s: nblur[%u] axis %u size, spacing, or centering "
+               "(%u, %g, %s) != nin's (%u, %g, %s)", me, blIdx, axi,
+               AIR_UINT(baxis->size), baxis->spacing,
+               airEnumStr(nrrdCenter, baxis->center),
+               AIR_UINT(iaxis->size), iaxis->spacing,
+               airEnumStr(nrrdCenter, iaxis->center));
+      return 0;
+    }
+    for (si=0; si<nin->spaceDim; si++) {
+      if (!_sameDouble(baxis->spaceDirection[si],
+                       iaxis->spaceDirection[si])) {
+        biffAddf(GAGE, "%s: nblur[%u] axis %u space direction[%u] %g "
+                 "!= nin's %g", me, blIdx, axi, si,
+                 baxis->spaceDirection[si], iaxis->spaceDirection[si]);
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
 static int
 _checkNrrd(Nrrd *const nblur[], const Nrrd *const ncheck[],
            unsigned int blNum, int checking,
@@ -954,10 +1096,20 @@ _checkNrrd(Nrrd *const nblur[], const Nrrd *const ncheck[],
              3 + kind->baseDim, nin->dim, kind->baseDim);
     return 1;
   }
+  if (checking) {
+    /* blurrings of a volume with the same values but placed
+       differently in world space are not the ones wanted */
+    for (blIdx=0; blIdx<blNum; blIdx++) {
+      if (!_sameOrient(ncheck[blIdx], nin, blIdx)) {
+        biffAddf(GAGE, "%s: ncheck[%u] orientation != nin's", me, blIdx);
+        return 1;
+      }
+    }
+  }
   return 0;
 }
 
-#define KVP_NUM 9
+#define KVP_NUM 11
 
 static const char
 _blurKey[KVP_NUM][AIR_STRLEN_LARGE] = {/*  0  */ "gageStackBlur",
@@ -969,9 +1121,13 @@ _blurKey[KVP_NUM][AIR_STRLEN_LARGE] = {/*  0  */ "gageStackBlur",
                                        /*  6  */ "onedim",
                                        /*  7  */ "spatialblurred",
 #define KVP_SBLUR_IDX                      7
-                                       /*  8  */ "dgGoodSigmaMax"
+                                       /*  8  */ "dgGoodSigmaMax",
 #define KVP_DGGSM_IDX                      8
-                                       /* (9 == KVP_NUM, above) */};
+                                       /*  9  */ "recursive",
+#define KVP_RECUR_IDX                      9
+                                       /* 10  */ "pyramid"
+#define KVP_PYRAM_IDX                     10
+                                       /* (11 == KVP_NUM, above) */};
 
 typedef struct {
   char val[KVP_NUM][AIR_STRLEN_LARGE];
@@ -1004,6 +1160,10 @@ _blurValAlloc(airArray *mop, gageStackBlurParm *sbp, NrrdKernelSpec *kssb,
     sprintf(blurVal[blIdx].val[7], "%s",
             spatialBlurred ? "true" : "false");
     sprintf(blurVal[blIdx].val[8], "%.17g", sbp->dgGoodSigmaMax);
+    sprintf(blurVal[blIdx].val[9], "%s",
+            sbp->recursive ? "true" : "false");
+    sprintf(blurVal[blIdx].val[10], "%s",
+            sbp->pyramid ? "true" : "false");
   }
   airMopAdd(mop, blurVal, airFree, airMopAlways);
   return blurVal;
@@ -1196,6 +1356,449 @@ _stackBlurDiscreteGaussFFT(Nrrd *const nblur[], gageStackBlurParm *sbp,
   return 0;
 }
 
+/*
+** sets up everything in rsmc except the kernels on the spatial axes,
+** for resampling nin to the same size
+*/
+static int
+_stackBlurResampleSetup(NrrdResampleContext *rsmc,
+                        const gageStackBlurParm *sbp,
+                        const NrrdBoundarySpec *bspec, int typeOut,
+                        const Nrrd *nin, const gageKind *kind) {
+  unsigned int axi, bai;
+  int E;
+
+  E = 0;
+  if (!E) E |= nrrdResampleDefaultCenterSet(rsmc, nrrdDefaultCenter);
+  if (!E) E |= nrrdResampleInputSet(rsmc, nin);
+  for (bai=0; bai<kind->baseDim; bai++) {
+    if (!E) E |= nrrdResampleKernelSet(rsmc, bai, NULL, NULL);
+  }
+  for (axi=0; axi<3; axi++) {
+    if (!E) E |= nrrdResampleSamplesSet(rsmc, kind->baseDim + axi,
+                                        nin->axis[kind->baseDim + axi].size);
+    if (!E) E |= nrrdResampleRangeFullSet(rsmc, kind->baseDim + axi);
+  }
+  if (!E) E |= nrrdResampleBoundarySpecSet(rsmc, bspec);
+  if (!E) E |= nrrdResampleTypeOutSet(rsmc, typeOut);
+  if (!E) E |= nrrdResampleClampSet(rsmc, AIR_TRUE); /* probably moot */
+  if (!E) E |= nrrdResampleRenormalizeSet(rsmc, sbp->renormalize);
+  return E;
+}
+
+/*
+** Levels that don't depend on each other (all of them, except when
+** blurring iteratively with the discrete Gaussian) are computed
+** concurrently by _stackBlurLevels, one level per job, on
+** nrrdStateNumThreads threads, each job with its own
+** NrrdResampleContext.  Jobs are handed out largest scale first,
+** since those take the longest.
+**
+** With sbp->pyramid, the levels with large enough sigma are instead
+** made from coarse "base" volumes, one for each downsampling factor
+** (a power of two) in use: the base is nin blurred by a Gaussian with
+** sigma gageStackBlurPyramidSigmaMin (in units of the coarse grid)
+** while being downsampled, and a level is made by upsampling its base
+** with the Gaussian that brings the total variance to sigma^2.  The
+** work per level is then about the same for all scales, and the base
+** is computed once for all levels sharing it.  The bases extend past
+** the volume (with values set by the boundary spec) by the support of
+** the largest kernel, so the upsampling never sees the boundary of the
+** coarse grid, and the boundary handling is the same as for blurring
+** nin directly.  With nrrdBoundaryWeight, the bases are padded with
+** zero, and levels are divided by the (separable) fraction of kernel
+** weight that fell inside the volume.
+**
+** The jobs run on nrrdThreadRun's threads, each of which has its own
+** biff store, so the messages of a job that failed are taken out of
+** the store (by _stackBlurJobErr) and kept per level, to be reported
+** afterwards by the calling thread.
+*/
+
+typedef struct {
+  unsigned int factor,    /* downsampling factor */
+    loIdx[3];             /* coarse index of first sample of nin */
+  double sigmaMax;        /* largest sigma of levels using this base */
+  Nrrd *nbase;            /* coarse volume, of type nrrdResample_nt */
+} _pyramidBase;
+
+typedef struct {
+  Nrrd *const *nblur;
+  const gageStackBlurParm *sbp;
+  const Nrrd *nin;
+  const gageKind *kind;
+  double cut;             /* Gaussian cut-off, for pyramid blurring */
+  unsigned int blStart,   /* levels [blStart, sbp->num) are computed */
+    baseNum,              /* number of bases */
+    *baseIdx;             /* per level: which base, or baseNum if none */
+  _pyramidBase *base;
+  char **err;             /* per level, then per base: NULL if ok,
+                             else the messages of the job that failed */
+} _stackBlurLevels;
+
+static void *
+_stackBlurLevelsErrNix(void *_sl) {
+  _stackBlurLevels *sl;
+  unsigned int ii;
+
+  sl = AIR_CAST(_stackBlurLevels *, _sl);
+  for (ii=0; ii<2*sl->sbp->num; ii++) {
+    sl->err[ii] = AIR_CAST(char *, airFree(sl->err[ii]));
+  }
+  return NULL;
+}
+
+/* the nrrd messages of a job that failed */
+static char *
+_stackBlurJobErr(void) {
+
+  return (biffCheck(NRRD)
+          ? biffGetDone(NRRD)
+          : airStrdup("(no message)"));
+}
+
+/*
+** the downsampling factor for pyramid blurring at scale sigma,
+** or 1 if the scale is too small
+*/
+static unsigned int
+_pyramidFactor(double sigma) {
+  unsigned int factor;
+
+  factor = 1;
+  while (sqrt(2.0)*gageStackBlurPyramidSigmaMin*2*factor <= sigma) {
+    factor *= 2;
+  }
+  return factor;
+}
+
+static void
+_pyramidBaseJob(void *_sl, unsigned int jobIdx, unsigned int threadIdx) {
+  _stackBlurLevels *sl;
+  _pyramidBase *base;
+  NrrdResampleContext *rsmc;
+  NrrdBoundarySpec *bspec;
+  double kparm[NRRD_KERNEL_PARMS_NUM], margin;
+  unsigned int axi, axNum, marginIdx, size, sizeC, ax;
+  int E;
+
+  AIR_UNUSED(threadIdx);
+  sl = AIR_CAST(_stackBlurLevels *, _sl);
+  base = sl->base + jobIdx;
+  rsmc = nrrdResampleContextNew();
+  bspec = nrrdBoundarySpecCopy(sl->sbp->bspec);
+  if (!(rsmc && bspec)) {
+    sl->err[sl->sbp->num + jobIdx] = airStrdup("couldn't allocate");
+    nrrdResampleContextNix(rsmc);
+    nrrdBoundarySpecNix(bspec);
+    return;
+  }
+  if (nrrdBoundaryWeight == bspec->boundary) {
+    bspec->boundary = nrrdBoundaryPad;
+    bspec->padValue = 0.0;
+  }
+  /* support of the largest Gaussian, in units of nin samples */
+  kparm[0] = base->sigmaMax;
+  kparm[1] = sl->cut;
+  margin = nrrdKernelGaussian->support(kparm);
+  /* one extra coarse sample, in case the support is a whole number */
+  marginIdx = AIR_CAST(unsigned int, ceil(margin/base->factor)) + 1;
+  E = _stackBlurResampleSetup(rsmc, sl->sbp, bspec, nrrdResample_nt,
+                              sl->nin, sl->kind);
+  kparm[0] = gageStackBlurPyramidSigmaMin;
+  axNum = sl->sbp->oneDim ? 1 : 3;
+  for (axi=0; axi<axNum; axi++) {
+    ax = sl->kind->baseDim + axi;
+    size = AIR_CAST(unsigned int, sl->nin->axis[ax].size);
+    base->loIdx[axi] = marginIdx;
+    sizeC = (marginIdx + (size - 1 + base->factor - 1)/base->factor
+             + marginIdx + 1);
+    /* all in the index space of nin, in which the coarse samples are
+       exactly factor apart; kparm[0] is in units of coarse samples */
+    if (!E) E |= nrrdResampleOverrideCenterSet(rsmc, ax, nrrdCenterNode);
+    if (!E) E |= nrrdResampleSamplesSet(rsmc, ax, sizeC);
+    if (!E) E |= nrrdResampleRangeSet(rsmc, ax,
+                                      -AIR_CAST(double, marginIdx)
+                                      *base->factor,
+                                      AIR_CAST(double, sizeC - 1 - marginIdx)
+                                      *base->factor);
+    if (!E) E |= nrrdResampleKernelSet(rsmc, ax, nrrdKernelGaussian, kparm);
+  }
+  if (!E) E |= nrrdResampleExecute(rsmc, base->nbase);
+  if (E) {
+    sl->err[sl->sbp->num + jobIdx] = _stackBlurJobErr();
+  }
+  nrrdResampleContextNix(rsmc);
+  nrrdBoundarySpecNix(bspec);
+  return;
+}
+
+/*
+** the fraction of the weights of the Gaussian (with sigma, in kparm)
+** centered at each of the size samples that falls inside the volume
+*/
+static void
+_pyramidWeight(double *wght, unsigned int size, const double *kparm) {
+  double sumIn, sumAll, ww;
+  unsigned int ii;
+  int kk, supp;
+
+  supp = AIR_CAST(int, ceil(nrrdKernelGaussian->support(kparm)));
+  for (ii=0; ii<size; ii++) {
+    sumIn = sumAll = 0;
+    for (kk=-supp; kk<=supp; kk++) {
+      ww = nrrdKernelGaussian->eval1_d(kk, kparm);
+      sumAll += ww;
+      if (AIR_IN_CL(0, AIR_CAST(int, ii) + kk, AIR_CAST(int, size) - 1)) {
+        sumIn += ww;
+      }
+    }
+    wght[ii] = sumIn/sumAll;
+  }
+  return;
+}
+
+/* makes one level from its pyramid base */
+static int
+_pyramidLevel(Nrrd *nout, const _stackBlurLevels *sl, unsigned int blIdx) {
+  const _pyramidBase *base;
+  NrrdResampleContext *rsmc;
+  Nrrd *ntmp;
+  double kparm[NRRD_KERNEL_PARMS_NUM], sigma, *wght[3];
+  unsigned int axi, axNum, ax, size;
+  size_t II, xi, yi, zi, stride, size3[3];
+  nrrdResample_t *data;
+  airArray *mop;
+  int E;
+
+  base = sl->base + sl->baseIdx[blIdx];
+  mop = airMopNew();
+  rsmc = nrrdResampleContextNew();
+  airMopAdd(mop, rsmc, (airMopper)nrrdResampleContextNix, airMopAlways);
+  ntmp = nrrdNew();
+  airMopAdd(mop, ntmp, (airMopper)nrrdNuke, airMopAlways);
+  /* base has already been blurred by gageStackBlurPyramidSigmaMin */
+  sigma = sl->sbp->sigma[blIdx]/base->factor;
+  kparm[0] = sqrt(sigma*sigma - (gageStackBlurPyramidSigmaMin
+                                 *gageStackBlurPyramidSigmaMin));
+  kparm[1] = sl->cut;
+  E = _stackBlurResampleSetup(rsmc, sl->sbp, sl->sbp->bspec,
+                              nrrdResample_nt, base->nbase, sl->kind);
+  /* the coarse grid extends past the kernel support, so the
+     boundary behavior doesn't matter here */
+  if (!E) E |= nrrdResampleBoundarySet(rsmc, nrrdBoundaryBleed);
+  axNum = sl->sbp->oneDim ? 1 : 3;
+  for (axi=0; axi<axNum; axi++) {
+    ax = sl->kind->baseDim + axi;
+    size = AIR_CAST(unsigned int, sl->nin->axis[ax].size);
+    if (!E) E |= nrrdResampleOverrideCenterSet(rsmc, ax, nrrdCenterNode);
+    if (!E) E |= nrrdResampleSamplesSet(rsmc, ax, size);
+    if (!E) E |= nrrdResampleRangeSet(rsmc, ax, base->loIdx[axi],
+                                      (base->loIdx[axi]
+                                       + AIR_CAST(double, size - 1)
+                                       /base->factor));
+    if (!E) E |= nrrdResampleKernelSet(rsmc, ax, nrrdKernelGaussian, kparm);
+  }
+  if (!E) E |= nrrdResampleExecute(rsmc, ntmp);
+  if (E) {
+    airMopError(mop); return 1;
+  }
+  if (nrrdBoundaryWeight == sl->sbp->bspec->boundary) {
+    kparm[0] = sl->sbp->sigma[blIdx];
+    wght[0] = wght[1] = wght[2] = NULL;
+    for (axi=0; axi<axNum; axi++) {
+      size = AIR_CAST(unsigned int,
+                      sl->nin->axis[sl->kind->baseDim + axi].size);
+      wght[axi] = AIR_CALLOC(size, double);
+      if (!wght[axi]) {
+        airMopError(mop); return 1;
+      }
+      airMopAdd(mop, wght[axi], airFree, airMopAlways);
+      _pyramidWeight(wght[axi], size, kparm);
+    }
+    stride = 1;
+    for (ax=0; ax<sl->kind->baseDim; ax++) {
+      stride *= sl->nin->axis[ax].size;
+    }
+    for (axi=0; axi<3; axi++) {
+      size3[axi] = sl->nin->axis[sl->kind->baseDim + axi].size;
+    }
+    data = AIR_CAST(nrrdResample_t *, ntmp->data);
+    for (zi=0; zi<size3[2]; zi++) {
+      for (yi=0; yi<size3[1]; yi++) {
+        for (xi=0; xi<size3[0]; xi++) {
+          double ww = wght[0][xi];
+          if (axNum > 1) {
+            ww *= wght[1][yi]*wght[2][zi];
+          }
+          for (II=0; II<stride; II++) {
+            data[II] = AIR_CAST(nrrdResample_t, data[II]/ww);
+          }
+          data += stride;
+        }
+      }
+    }
+  }
+  /* as with iterative blurring in _stackBlurSpatial; the axis info
+     is from nin, since ntmp's was set by the coarse grid */
+  if (nrrdCastClampRound(nout, ntmp, sl->nin->type, AIR_TRUE,
+                         nrrdTypeIsIntegral[sl->nin->type])
+      || nrrdAxisInfoCopy(nout, sl->nin, NULL, NRRD_AXIS_INFO_NONE)
+      || nrrdBasicInfoCopy(nout, sl->nin,
+                           NRRD_BASIC_INFO_DATA_BIT
+                           | NRRD_BASIC_INFO_TYPE_BIT
+                           | NRRD_BASIC_INFO_BLOCKSIZE_BIT
+                           | NRRD_BASIC_INFO_DIMENSION_BIT
+                           | NRRD_BASIC_INFO_CONTENT_BIT
+                           | NRRD_BASIC_INFO_COMMENTS_BIT
+                           | NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT)
+      || nrrdContentSet_va(nout, "blur", sl->nin, "")) {
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/* blurs nin directly with kspec, at the given scale */
+static int
+_stackBlurDirect(Nrrd *nout, const _stackBlurLevels *sl, double sigma) {
+  NrrdResampleContext *rsmc;
+  double kparm[NRRD_KERNEL_PARMS_NUM];
+  unsigned int axi;
+  int E;
+
+  if (!( rsmc = nrrdResampleContextNew() )) {
+    return 1;
+  }
+  E = _stackBlurResampleSetup(rsmc, sl->sbp, sl->sbp->bspec,
+                              nrrdTypeDefault, sl->nin, sl->kind);
+  memcpy(kparm, sl->sbp->kspec->parm, sizeof(kparm));
+  kparm[0] = sigma;
+  for (axi=0; axi<(sl->sbp->oneDim ? 1u : 3u); axi++) {
+    if (!E) E |= nrrdResampleKernelSet(rsmc, sl->kind->baseDim + axi,
+                                       sl->sbp->kspec->kernel, kparm);
+  }
+  if (!E) E |= nrrdResampleExecute(rsmc, nout);
+  nrrdResampleContextNix(rsmc);
+  return E;
+}
+
+static void
+_stackBlurLevelJob(void *_sl, unsigned int jobIdx, unsigned int threadIdx) {
+  _stackBlurLevels *sl;
+  unsigned int blIdx;
+  int E;
+
+  AIR_UNUSED(threadIdx);
+  sl = AIR_CAST(_stackBlurLevels *, _sl);
+  /* largest scales first */
+  blIdx = sl->sbp->num - 1 - jobIdx;
+  if (sl->baseIdx[blIdx] < sl->baseNum) {
+    E = _pyramidLevel(sl->nblur[blIdx], sl, blIdx);
+  } else {
+    E = _stackBlurDirect(sl->nblur[blIdx], sl, sl->sbp->sigma[blIdx]);
+  }
+  if (E) {
+    sl->err[blIdx] = _stackBlurJobErr();
+  }
+  return;
+}
+
+/*
+** computes levels [blStart, sbp->num), each independently of the
+** others, either from a pyramid base (if pyramid) or directly from nin
+** (in which case kspec must not be the discrete Gaussian, which is
+** used iteratively)
+*/
+static int
+_stackBlurLevelsRun(Nrrd *const nblur[], const gageStackBlurParm *sbp,
+                    unsigned int blStart, int pyramid,
+                    const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_stackBlurLevelsRun";
+  _stackBlurLevels sl;
+  unsigned int blIdx, bi, factor, jobNum;
+  airArray *mop;
+
+  mop = airMopNew();
+  sl.nblur = nblur;
+  sl.sbp = sbp;
+  sl.nin = nin;
+  sl.kind = kind;
+  sl.cut = sbp->kspec->parm[1];
+  sl.blStart = blStart;
+  sl.baseNum = 0;
+  sl.baseIdx = AIR_CALLOC(sbp->num, unsigned int);
+  /* at most one base per level */
+  sl.base = AIR_CALLOC(sbp->num, _pyramidBase);
+  sl.err = AIR_CALLOC(2*sbp->num, char *);
+  if (!(sl.baseIdx && sl.base && sl.err)) {
+    biffAddf(GAGE, "%s: couldn't allocate", me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, sl.baseIdx, airFree, airMopAlways);
+  airMopAdd(mop, sl.base, airFree, airMopAlways);
+  airMopAdd(mop, sl.err, airFree, airMopAlways);
+  airMopAdd(mop, &sl, _stackBlurLevelsErrNix, airMopAlways);
+  for (blIdx=blStart; blIdx<sbp->num; blIdx++) {
+    factor = pyramid ? _pyramidFactor(sbp->sigma[blIdx]) : 1;
+    if (1 == factor) {
+      sl.baseIdx[blIdx] = sbp->num; /* fixed below to baseNum */
+      continue;
+    }
+    for (bi=0; bi<sl.baseNum; bi++) {
+      if (factor == sl.base[bi].factor) {
+        break;
+      }
+    }
+    if (bi == sl.baseNum) {
+      sl.base[bi].factor = factor;
+      sl.base[bi].nbase = nrrdNew();
+      airMopAdd(mop, sl.base[bi].nbase, (airMopper)nrrdNuke, airMopAlways);
+      sl.baseNum++;
+    }
+    /* sigmas are increasing */
+    sl.base[bi].sigmaMax = sbp->sigma[blIdx];
+    sl.baseIdx[blIdx] = bi;
+  }
+  for (blIdx=blStart; blIdx<sbp->num; blIdx++) {
+    sl.baseIdx[blIdx] = AIR_MIN(sl.baseIdx[blIdx], sl.baseNum);
+  }
+  jobNum = sbp->num - blStart;
+  if (sbp->verbose) {
+    fprintf(stderr, "%s: blurring scales %u through %u (from %u pyramid "
+            "bases) with %u threads\n", me, blStart, sbp->num - 1,
+            sl.baseNum, nrrdThreadNum(0, jobNum));
+  }
+  if (sl.baseNum) {
+    if (nrrdThreadRun(0, sl.baseNum, _pyramidBaseJob, &sl)) {
+      biffMovef(GAGE, NRRD, "%s: trouble making pyramid bases", me);
+      airMopError(mop); return 1;
+    }
+    for (bi=0; bi<sl.baseNum; bi++) {
+      if (sl.err[sbp->num + bi]) {
+        biffAddf(GAGE, "%s", sl.err[sbp->num + bi]);
+        biffAddf(GAGE, "%s: trouble making pyramid base for "
+                 "factor %u", me, sl.base[bi].factor);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+  if (nrrdThreadRun(0, jobNum, _stackBlurLevelJob, &sl)) {
+    biffMovef(GAGE, NRRD, "%s: trouble blurring", me);
+    airMopError(mop); return 1;
+  }
+  for (blIdx=blStart; blIdx<sbp->num; blIdx++) {
+    if (sl.err[blIdx]) {
+      biffAddf(GAGE, "%s", sl.err[blIdx]);
+      biffAddf(GAGE, "%s: trouble w/ %u of %u (scale %g)",
+               me, blIdx, sbp->num, sbp->sigma[blIdx]);
+      airMopError(mop); return 1;
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
 static int
 _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
                   NrrdKernelSpec *kssb,
@@ -1204,49 +1807,32 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
   NrrdResampleContext *rsmc;
   Nrrd *niter;
   unsigned int axi, blIdx;
-  int E, iterative, rsmpType;
+  int E;
   double timeStepMax, /* max length of diffusion time allowed per blur,
                          as determined by sbp->dgGoodSigmaMax */
     timeDone,         /* amount of diffusion time just applied */
     timeLeft;         /* amount of diffusion time left to do */
   airArray *mop;
 
+  if (nrrdKernelDiscreteGaussian != kssb->kernel) {
+    /* the levels don't depend on each other */
+    if (_stackBlurLevelsRun(nblur, sbp, 0, AIR_FALSE, nin, kind)) {
+      biffAddf(GAGE, "%s: trouble blurring levels", me);
+      return 1;
+    }
+    return 0;
+  }
+  /* else the discrete Gaussian is used iteratively, each level
+     starting from the previous one */
   mop = airMopNew();
   rsmc = nrrdResampleContextNew();
   airMopAdd(mop, rsmc, (airMopper)nrrdResampleContextNix, airMopAlways);
-  if (nrrdKernelDiscreteGaussian == kssb->kernel) {
-    iterative = AIR_TRUE;
-    /* we don't want to lose precision when iterating */
-    rsmpType = nrrdResample_nt;
-    /* may be used with iterative diffusion */
-    niter = nrrdNew();
-    airMopAdd(mop, niter, (airMopper)nrrdNuke, airMopAlways);
-  } else {
-    iterative = AIR_FALSE;
-    rsmpType = nrrdTypeDefault;
-    niter = NULL;
-  }
-
-  E = 0;
-  if (!E) E |= nrrdResampleDefaultCenterSet(rsmc, nrrdDefaultCenter);
-  /* the input for the first scale is indeed nin, regardless
-     of iterative */
-  if (!E) E |= nrrdResampleInputSet(rsmc, nin);
-  if (kind->baseDim) {
-    unsigned int bai;
-    for (bai=0; bai<kind->baseDim; bai++) {
-      if (!E) E |= nrrdResampleKernelSet(rsmc, bai, NULL, NULL);
-    }
-  }
-  for (axi=0; axi<3; axi++) {
-    if (!E) E |= nrrdResampleSamplesSet(rsmc, kind->baseDim + axi,
-                                        nin->axis[kind->baseDim + axi].size);
-    if (!E) E |= nrrdResampleRangeFullSet(rsmc, kind->baseDim + axi);
-  }
-  if (!E) E |= nrrdResampleBoundarySpecSet(rsmc, sbp->bspec);
-  if (!E) E |= nrrdResampleTypeOutSet(rsmc, rsmpType);
-  if (!E) E |= nrrdResampleClampSet(rsmc, AIR_TRUE); /* probably moot */
-  if (!E) E |= nrrdResampleRenormalizeSet(rsmc, sbp->renormalize);
+  niter = nrrdNew();
+  airMopAdd(mop, niter, (airMopper)nrrdNuke, airMopAlways);
+  /* we don't want to lose precision when iterating; the input for
+     the first scale is indeed nin */
+  E = _stackBlurResampleSetup(rsmc, sbp, sbp->bspec, nrrdResample_nt,
+                              nin, kind);
   if (E) {
     biffAddf(GAGE, "%s: trouble setting up resampling", me);
     airMopError(mop); return 1;
@@ -1255,108 +1841,98 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
   timeDone = 0;
   timeStepMax = (sbp->dgGoodSigmaMax)*(sbp->dgGoodSigmaMax);
   for (blIdx=0; blIdx<sbp->num; blIdx++) {
+    double timeNow = sbp->sigma[blIdx]*sbp->sigma[blIdx];
+    unsigned int passIdx = 0;
     if (sbp->verbose) {
       fprintf(stderr, "%s: . . . blurring %u / %u (scale %g) . . . ",
               me, blIdx, sbp->num, sbp->sigma[blIdx]);
       fflush(stderr);
     }
-    if (iterative) {
-      double timeNow = sbp->sigma[blIdx]*sbp->sigma[blIdx];
-      unsigned int passIdx = 0;
-      timeLeft = timeNow - timeDone;
-      if (sbp->verbose) {
-        fprintf(stderr, "\n");
-        fprintf(stderr, "%s: scale %g == time %g (tau %g);\n"
-                "               timeLeft %g = %g - %g\n",
-                me, sbp->sigma[blIdx], timeNow, gageTauOfTee(timeNow),
-                timeLeft, timeNow, timeDone);
-        if (timeLeft > timeStepMax) {
-          fprintf(stderr, "%s: diffusing for time %g in steps of %g\n", me,
-                  timeLeft, timeStepMax);
-        }
-        fflush(stderr);
+    timeLeft = timeNow - timeDone;
+    if (sbp->verbose) {
+      fprintf(stderr, "\n");
+      fprintf(stderr, "%s: scale %g == time %g (tau %g);\n"
+              "               timeLeft %g = %g - %g\n",
+              me, sbp->sigma[blIdx], timeNow, gageTauOfTee(timeNow),
+              timeLeft, timeNow, timeDone);
+      if (timeLeft > timeStepMax) {
+        fprintf(stderr, "%s: diffusing for time %g in steps of %g\n", me,
+                timeLeft, timeStepMax);
       }
-      do {
-        double timeDo;
-        if (blIdx || passIdx) {
-          /* either we're past the first scale (blIdx >= 1), or
-             (unlikely) we're on the first scale but after the first
-             pass of a multi-pass blurring, so we have to feed the
-             previous result back in as input.
-             AND: the way that niter is being used is very sneaky,
-             and probably too clever: the resampling happens in
-             multiple passes, among buffers internal to nrrdResample;
-             so its okay have the output and input nrrds be the same:
-             they're never used at the same time. */
-          if (!E) E |= nrrdResampleInputSet(rsmc, niter);
-        }
-        timeDo = (timeLeft > timeStepMax
-                  ? timeStepMax
-                  : timeLeft);
-        /* it is the repeated re-setting of this parm[0] which motivated
-           copying to our own kernel spec, so that the given one in the
-           gageStackBlurParm can stay untouched */
-        kssb->parm[0] = sqrt(timeDo);
-        for (axi=0; axi<3; axi++) {
-          if (!sbp->oneDim || !axi) {
-            /* we set the blurring kernel on this axis if
-               we are NOT doing oneDim, or, we are,
-               but this is axi == 0 */
-            if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
-                                               kssb->kernel,
-                                               kssb->parm);
-          } else {
-            /* what to do with oneDom on axi 1, 2 */
-            /* you might think that we should just do no resampling at all
-               on this axis, but that would undermine the in==out==niter
-               trick described above; and produce the mysterious behavior
-               that the second scale-space volume is all 0.0 */
-            double boxparm[NRRD_KERNEL_PARMS_NUM] = {1.0};
-            if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
-                                               nrrdKernelBox, boxparm);
-          }
-        }
-        if (sbp->verbose) {
-          fprintf(stderr, "  pass %u (timeLeft=%g => "
-                  "time=%g, sigma=%g) ...\n",
-                  passIdx, timeLeft, timeDo, kssb->parm[0]);
+      fflush(stderr);
+    }
+    do {
+      double timeDo;
+      if (blIdx || passIdx) {
+        /* either we're past the first scale (blIdx >= 1), or
+           (unlikely) we're on the first scale but after the first
+           pass of a multi-pass blurring, so we have to feed the
+           previous result back in as input.
+           AND: the way that niter is being used is very sneaky,
+           and probably too clever: the resampling happens in
+           multiple passes, among buffers internal to nrrdResample;
+           so its okay have the output and input nrrds be the same:
+           they're never used at the same time. */
+        if (!E) E |= nrrdResampleInputSet(rsmc, niter);
+      }
+      timeDo = (timeLeft > timeStepMax
+                ? timeStepMax
+                : timeLeft);
+      /* it is the repeated re-setting of this parm[0] which motivated
+         copying to our own kernel spec, so that the given one in the
+         gageStackBlurParm can stay untouched */
+      kssb->parm[0] = sqrt(timeDo);
+      for (axi=0; axi<3; axi++) {
+        if (!sbp->oneDim || !axi) {
+          /* we set the blurring kernel on this axis if
+             we are NOT doing oneDim, or, we are,
+             but this is axi == 0 */
+          if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
+                                             kssb->kernel,
+                                             kssb->parm);
+        } else {
+          /* what to do with oneDom on axi 1, 2 */
+          /* you might think that we should just do no resampling at all
+             on this axis, but that would undermine the in==out==niter
+             trick described above; and produce the mysterious behavior
+             that the second scale-space volume is all 0.0 */
+          double boxparm[NRRD_KERNEL_PARMS_NUM] = {1.0};
+          if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
+                                             nrrdKernelBox, boxparm);
         }
-        if (!E) E |= nrrdResampleExecute(rsmc, niter);
-        /* for debugging problem with getting zero output
-        if (!E) {
-          NrrdRange *nrange;
-          nrange = nrrdRangeNewSet(niter, AIR_FALSE);
-          fprintf(stderr, "%s: min/max = %g/%g\n", me,
-                  nrange->min, nrange->max);
-          if (!nrange->min || !nrange->max) {
-            fprintf(stderr, "%s: what? zero zero\n", me);
-            biffAddf(GAGE, "%s: no good", me);
-            airMopError(mop); return 1;
-          }
+      }
+      if (sbp->verbose) {
+        fprintf(stderr, "  pass %u (timeLeft=%g => "
+                "time=%g, sigma=%g) ...\n",
+                passIdx, timeLeft, timeDo, kssb->parm[0]);
+      }
+      if (!E) E |= nrrdResampleExecute(rsmc, niter);
+      /* for debugging problem with getting zero output
+      if (!E) {
+        NrrdRange *nrange;
+        nrange = nrrdRangeNewSet(niter, AIR_FALSE);
+        fprintf(stderr, "%s: min/max = %g/%g\n", me,
+                nrange->min, nrange->max);
+        if (!nrange->min || !nrange->max) {
+          fprintf(stderr, "%s: what? zero zero\n", me);
+          biffAddf(GAGE, "%s: no good", me);
+          airMopError(mop); return 1;
         }
-        */
-        timeLeft -= timeDo;
-        passIdx++;
-      } while (!E && timeLeft > 0.0);
-      /* at this point we have to replicate the behavior of the
-         last stage of resampling (e.g. _nrrdResampleOutputUpdate
-         in nrrd/resampleContext.c), since we've gently hijacked
-         the resampling to access the nrrdResample_t blurring
-         result (for further blurring) */
-      if (!E) E |= nrrdCastClampRound(nblur[blIdx], niter, nin->type,
-                                      AIR_TRUE,
-                                      nrrdTypeIsIntegral[nin->type]);
-      if (!E) E |= nrrdContentSet_va(nblur[blIdx], "blur", nin, "");
-      timeDone = timeNow;
-    } else { /* do blurring in one shot */
-      kssb->parm[0] = sbp->sigma[blIdx];
-      for (axi=0; axi<(sbp->oneDim ? 1u : 3u); axi++) {
-        if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
-                                           kssb->kernel,
-                                           kssb->parm);
       }
-      if (!E) E |= nrrdResampleExecute(rsmc, nblur[blIdx]);
-    }
+      */
+      timeLeft -= timeDo;
+      passIdx++;
+    } while (!E && timeLeft > 0.0);
+    /* at this point we have to replicate the behavior of the
+       last stage of resampling (e.g. _nrrdResampleOutputUpdate
+       in nrrd/resampleContext.c), since we've gently hijacked
+       the resampling to access the nrrdResample_t blurring
+       result (for further blurring) */
+    if (!E) E |= nrrdCastClampRound(nblur[blIdx], niter, nin->type,
+                                    AIR_TRUE,
+                                    nrrdTypeIsIntegral[nin->type]);
+    if (!E) E |= nrrdContentSet_va(nblur[blIdx], "blur", nin, "");
+    timeDone = timeNow;
     if (E) {
       if (sbp->verbose) {
         fprintf(stderr, "problem!\n");
@@ -1374,6 +1950,408 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
   return 0;
 }
 
+/*
+** Recursive (IIR) Gaussian blurring, following:
+**
+** R. Deriche. "Recursively Implementing the Gaussian and its
+** Derivatives", INRIA Research Report 1893; 1993
+**
+** The sum of a causal and an anti-causal 4th-order recursion, run along
+** each scanline, approximates the sampled continuous Gaussian, with a
+** per-sample cost that does not depend on sigma.  Boundary conditions are
+** handled by extending each scanline (according to the boundary spec) by
+** RECURSIVE_PAD_SIGMA*sigma samples on either end, and starting the
+** recursions in steady-state for the first (or last) sample.  For
+** nrrdBoundaryWeight, the extension is with zeros, and the result is
+** divided by the blurring of the indicator function of the scanline.
+** Scanlines are processed in batches of RECURSIVE_BATCH adjacent lines,
+** so that axes other than the fastest one are still traversed in memory
+** order, and the batches are divided among nrrdStateNumThreads threads.
+*/
+
+#define RECURSIVE_PAD_SIGMA 4.0
+#define RECURSIVE_BATCH 16
+
+typedef struct {
+  double nn[4],      /* causal numerator */
+    mm[5],           /* anti-causal numerator (mm[0] unused) */
+    dd[5],           /* denominator (dd[0] unused) */
+    scl,             /* to normalize the sum of the two recursions */
+    ssc, ssa;        /* steady-state causal and anti-causal output
+                        for unit input */
+} _recursiveCoef;
+
+/*
+** the coefficients for the (unnormalized) Gaussian from Table 1 of
+** Deriche, and the resulting recursions, from his equations (33-35)
+*/
+static void
+_recursiveCoefSet(_recursiveCoef *rc, double sigma) {
+  double a0=1.680, a1=3.735, b0=1.783, b1=1.723,
+    w0=0.6318, w1=1.997, c0=-0.6803, c1=-0.2598,
+    e0, e1, cw0, sw0, cw1, sw1, sn, sm, sd;
+
+  e0 = exp(-b0/sigma);
+  e1 = exp(-b1/sigma);
+  cw0 = cos(w0/sigma);
+  sw0 = sin(w0/sigma);
+  cw1 = cos(w1/sigma);
+  sw1 = sin(w1/sigma);
+  rc->nn[0] = a0 + c0;
+  rc->nn[1] = (e1*(c1*sw1 - (c0 + 2*a0)*cw1)
+               + e0*(a1*sw0 - (2*c0 + a0)*cw0));
+  rc->nn[2] = (2*e0*e1*((a0 + c0)*cw1*cw0 - a1*cw1*sw0 - c1*cw0*sw1)
+               + c0*e0*e0 + a0*e1*e1);
+  rc->nn[3] = (e1*e0*e0*(c1*sw1 - c0*cw1)
+               + e0*e1*e1*(a1*sw0 - a0*cw0));
+  rc->dd[0] = 0;
+  rc->dd[1] = -2*e1*cw1 - 2*e0*cw0;
+  rc->dd[2] = 4*cw1*cw0*e0*e1 + e1*e1 + e0*e0;
+  rc->dd[3] = -2*cw0*e0*e1*e1 - 2*cw1*e1*e0*e0;
+  rc->dd[4] = e0*e0*e1*e1;
+  rc->mm[0] = 0;
+  rc->mm[1] = rc->nn[1] - rc->dd[1]*rc->nn[0];
+  rc->mm[2] = rc->nn[2] - rc->dd[2]*rc->nn[0];
+  rc->mm[3] = rc->nn[3] - rc->dd[3]*rc->nn[0];
+  rc->mm[4] = -rc->dd[4]*rc->nn[0];
+  sn = rc->nn[0] + rc->nn[1] + rc->nn[2] + rc->nn[3];
+  sm = rc->mm[1] + rc->mm[2] + rc->mm[3] + rc->mm[4];
+  sd = 1 + rc->dd[1] + rc->dd[2] + rc->dd[3] + rc->dd[4];
+  rc->ssc = sn/sd;
+  rc->ssa = sm/sd;
+  rc->scl = 1/(rc->ssc + rc->ssa);
+  return;
+}
+
+/*
+** blurs "batch" interleaved scanlines of length len: sample ii of line
+** bi is xx[bi + batch*ii].  The xx, yc, and ya buffers are all of
+** length batch*(len + 8), and the scanline starts after 4 guard
+** samples; the output is put back into xx.
+*/
+static void
+_recursiveLine(double *xx, double *yc, double *ya, size_t len,
+               unsigned int batch, const _recursiveCoef *rc) {
+  double *x0, *x1, *x2, *x3, *x4, *y0, *y1, *y2, *y3, *y4;
+  size_t ii, kk;
+  unsigned int bi;
+
+  /* guard samples for starting in steady-state */
+  for (kk=0; kk<4; kk++) {
+    for (bi=0; bi<batch; bi++) {
+      double fst = xx[bi + batch*4], lst = xx[bi + batch*(len+3)];
+      xx[bi + batch*kk] = fst;
+      yc[bi + batch*kk] = fst*rc->ssc;
+      xx[bi + batch*(len+4+kk)] = lst;
+      ya[bi + batch*(len+4+kk)] = lst*rc->ssa;
+    }
+  }
+  /* causal */
+  for (ii=4; ii<len+4; ii++) {
+    x0 = xx + batch*ii; x1 = x0 - batch; x2 = x1 - batch; x3 = x2 - batch;
+    y0 = yc + batch*ii; y1 = y0 - batch; y2 = y1 - batch; y3 = y2 - batch;
+    y4 = y3 - batch;
+    for (bi=0; bi<batch; bi++) {
+      y0[bi] = (rc->nn[0]*x0[bi] + rc->nn[1]*x1[bi]
+                + rc->nn[2]*x2[bi] + rc->nn[3]*x3[bi]
+                - rc->dd[1]*y1[bi] - rc->dd[2]*y2[bi]
+                - rc->dd[3]*y3[bi] - rc->dd[4]*y4[bi]);
+    }
+  }
+  /* anti-causal */
+  for (ii=len+4; ii-- > 4;) {
+    x1 = xx + batch*(ii+1); x2 = x1 + batch; x3 = x2 + batch;
+    x4 = x3 + batch;
+    y0 = ya + batch*ii; y1 = y0 + batch; y2 = y1 + batch; y3 = y2 + batch;
+    y4 = y3 + batch;
+    for (bi=0; bi<batch; bi++) {
+      y0[bi] = (rc->mm[1]*x1[bi] + rc->mm[2]*x2[bi]
+                + rc->mm[3]*x3[bi] + rc->mm[4]*x4[bi]
+                - rc->dd[1]*y1[bi] - rc->dd[2]*y2[bi]
+                - rc->dd[3]*y3[bi] - rc->dd[4]*y4[bi]);
+    }
+  }
+  for (ii=4*batch; ii<(len+4)*batch; ii++) {
+    xx[ii] = rc->scl*(yc[ii] + ya[ii]);
+  }
+  return;
+}
+
+/* state shared by the threads doing one pass of _stackBlurRecursive */
+typedef struct {
+  const nrrdResample_t *src;   /* pass input */
+  nrrdResample_t *dst;         /* pass output; may be same as src */
+  size_t size,                 /* length of scanlines */
+    stride,                    /* (in values) between scanline samples,
+                                  == number of scanlines starting in
+                                  one "slab" of stride*size values */
+    pad,                       /* extension at each end of scanline */
+    batchPerSlab;              /* # batches needed to cover one slab */
+  const NrrdBoundarySpec *bspec;
+  _recursiveCoef rc;
+  const double *wght;          /* if non-NULL: normalization for
+                                  nrrdBoundaryWeight, for each sample */
+  double **line;               /* per-thread buffers for _recursiveLine */
+  size_t lineLen;              /* length of each of the three buffers
+                                  in line[threadIdx] */
+} _recursivePass;
+
+/* where to read sample ii (in extended scanline) from; -1 for padding */
+static ptrdiff_t
+_recursiveIndex(const _recursivePass *rp, size_t ii) {
+  ptrdiff_t idx, nn;
+
+  idx = AIR_CAST(ptrdiff_t, ii) - AIR_CAST(ptrdiff_t, rp->pad);
+  nn = AIR_CAST(ptrdiff_t, rp->size);
+  if (0 <= idx && idx < nn) {
+    return idx;
+  }
+  switch (rp->bspec->boundary) {
+  case nrrdBoundaryBleed:
+    idx = AIR_CLAMP(0, idx, nn-1);
+    break;
+  case nrrdBoundaryWrap:
+    idx = AIR_MOD(idx, nn);
+    break;
+  case nrrdBoundaryMirror:
+    idx = idx < 0 ? -idx : idx;
+    idx = idx % (2*nn);
+    idx = idx >= nn ? 2*nn - 1 - idx : idx;
+    break;
+  default:
+    /* nrrdBoundaryPad, nrrdBoundaryWeight */
+    idx = -1;
+    break;
+  }
+  return idx;
+}
+
+static void
+_recursivePassJob(void *_rp, unsigned int jobIdx, unsigned int threadIdx) {
+  _recursivePass *rp;
+  size_t slab, first, batch, bi, ii, extLen, base;
+  ptrdiff_t idx;
+  double *line, padVal;
+
+  rp = AIR_CAST(_recursivePass *, _rp);
+  line = rp->line[threadIdx];  /* == xx of _recursiveLine */
+  slab = jobIdx/rp->batchPerSlab;
+  first = (jobIdx % rp->batchPerSlab)*RECURSIVE_BATCH;
+  batch = AIR_MIN(RECURSIVE_BATCH, rp->stride - first);
+  base = first + slab*rp->stride*rp->size;
+  extLen = rp->size + 2*rp->pad;
+  padVal = (nrrdBoundaryPad == rp->bspec->boundary
+            ? rp->bspec->padValue
+            : 0.0);
+  for (ii=0; ii<extLen; ii++) {
+    double *ll = line + batch*(ii + 4);
+    idx = _recursiveIndex(rp, ii);
+    if (idx < 0) {
+      for (bi=0; bi<batch; bi++) {
+        ll[bi] = padVal;
+      }
+    } else {
+      const nrrdResample_t *ss = rp->src + base + idx*rp->stride;
+      for (bi=0; bi<batch; bi++) {
+        ll[bi] = ss[bi];
+      }
+    }
+  }
+  _recursiveLine(line, line + rp->lineLen, line + 2*rp->lineLen, extLen,
+                 AIR_CAST(unsigned int, batch), &(rp->rc));
+  for (ii=0; ii<rp->size; ii++) {
+    const double *ll = line + batch*(ii + rp->pad + 4);
+    nrrdResample_t *dd = rp->dst + base + ii*rp->stride;
+    double ww = rp->wght ? 1.0/rp->wght[ii] : 1.0;
+    for (bi=0; bi<batch; bi++) {
+      dd[bi] = AIR_CAST(nrrdResample_t, ww*ll[bi]);
+    }
+  }
+  return;
+}
+
+/*
+** recursively blurs the levels of the stack with sigma >=
+** gageStackBlurRecursiveSigmaMin; the others (which must precede them,
+** since sigmas are increasing) are blurred by _stackBlurSpatial
+*/
+static int
+_stackBlurRecursive(Nrrd *const nblur[], gageStackBlurParm *sbp,
+                    NrrdKernelSpec *kssb,
+                    const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_stackBlurRecursive";
+  gageStackBlurParm sbpSmall;
+  _recursivePass rp;
+  Nrrd *nsrc, *ndst;
+  unsigned int blIdx, blStart, axi, bai, tidx, threadNum, jobNum;
+  size_t stride, size[3], ii, padMax, extMax, num;
+  double *wline;
+  airArray *mop;
+
+  for (blStart=0; blStart<sbp->num; blStart++) {
+    if (sbp->sigma[blStart] >= gageStackBlurRecursiveSigmaMin) {
+      break;
+    }
+  }
+  if (blStart) {
+    /* shallow copy to describe just the small scales */
+    sbpSmall = *sbp;
+    sbpSmall.num = blStart;
+    if (sbp->verbose) {
+      fprintf(stderr, "%s: blurring %u scales < %g with kernel\n", me,
+              blStart, gageStackBlurRecursiveSigmaMin);
+    }
+    if (_stackBlurSpatial(nblur, &sbpSmall, kssb, nin, kind)) {
+      biffAddf(GAGE, "%s: trouble with small scales", me);
+      return 1;
+    }
+  }
+  if (blStart == sbp->num) {
+    return 0;
+  }
+
+  mop = airMopNew();
+  nsrc = nrrdNew();
+  airMopAdd(mop, nsrc, (airMopper)nrrdNuke, airMopAlways);
+  ndst = nrrdNew();
+  airMopAdd(mop, ndst, (airMopper)nrrdNuke, airMopAlways);
+  /* we don't want to lose precision between passes */
+  if (nrrdConvert(nsrc, nin, nrrdResample_nt)
+      || nrrdCopy(ndst, nsrc)) {
+    biffMovef(GAGE, NRRD, "%s: trouble allocating buffers", me);
+    airMopError(mop); return 1;
+  }
+  stride = 1;
+  for (bai=0; bai<kind->baseDim; bai++) {
+    stride *= nin->axis[bai].size;
+  }
+  for (axi=0; axi<3; axi++) {
+    size[axi] = nin->axis[kind->baseDim + axi].size;
+  }
+  num = nrrdElementNumber(nin);
+  padMax = AIR_CAST(size_t, ceil(RECURSIVE_PAD_SIGMA
+                                 *sbp->sigma[sbp->num-1]));
+  /* the most threads any pass will use */
+  threadNum = nrrdThreadNum(0, UINT_MAX);
+  /* longest extended scanline, with guard samples */
+  extMax = AIR_MAX(size[0], AIR_MAX(size[1], size[2])) + 2*padMax + 8;
+  rp.lineLen = RECURSIVE_BATCH*extMax;
+  rp.line = AIR_CALLOC(threadNum, double *);
+  wline = AIR_CALLOC(3*extMax, double);
+  if (!(rp.line && wline)) {
+    biffAddf(GAGE, "%s: couldn't allocate buffers", me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, rp.line, airFree, airMopAlways);
+  airMopAdd(mop, wline, airFree, airMopAlways);
+  for (tidx=0; tidx<threadNum; tidx++) {
+    rp.line[tidx] = AIR_CALLOC(3*rp.lineLen, double);
+    if (!rp.line[tidx]) {
+      biffAddf(GAGE, "%s: couldn't allocate buffer %u", me, tidx);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, rp.line[tidx], airFree, airMopAlways);
+  }
+  rp.bspec = sbp->bspec;
+  for (blIdx=blStart; blIdx<sbp->num; blIdx++) {
+    double sigma = sbp->sigma[blIdx];
+    if (sbp->verbose) {
+      fprintf(stderr, "%s: . . . blurring %u / %u (scale %g) . . . ",
+              me, blIdx, sbp->num, sigma);
+      fflush(stderr);
+    }
+    _recursiveCoefSet(&(rp.rc), sigma);
+    rp.pad = AIR_CAST(size_t, ceil(RECURSIVE_PAD_SIGMA*sigma));
+    rp.src = AIR_CAST(const nrrdResample_t *, nsrc->data);
+    rp.dst = AIR_CAST(nrrdResample_t *, ndst->data);
+    rp.stride = stride;
+    for (axi=0; axi<(sbp->oneDim ? 1u : 3u); axi++) {
+      rp.size = size[axi];
+      rp.batchPerSlab = (rp.stride + RECURSIVE_BATCH - 1)/RECURSIVE_BATCH;
+      if (nrrdBoundaryWeight == sbp->bspec->boundary) {
+        /* blur the indicator function of the scanline */
+        for (ii=0; ii<rp.size + 2*rp.pad; ii++) {
+          wline[ii + 4] = AIR_IN_CL(rp.pad, ii, rp.pad + rp.size - 1);
+        }
+        _recursiveLine(wline, wline + extMax, wline + 2*extMax,
+                       rp.size + 2*rp.pad, 1, &(rp.rc));
+        rp.wght = wline + 4 + rp.pad;
+      } else {
+        rp.wght = NULL;
+      }
+      jobNum = AIR_CAST(unsigned int,
+                        rp.batchPerSlab*(num/(rp.stride*rp.size)));
+      if (nrrdThreadRun(0, jobNum, _recursivePassJob, &rp)) {
+        biffMovef(GAGE, NRRD, "%s: trouble on axis %u of %u (scale %g)", me,
+                  axi, blIdx, sigma);
+        airMopError(mop); return 1;
+      }
+      /* later passes are in-place */
+      rp.src = rp.dst;
+      rp.stride *= rp.size;
+    }
+    /* as with iterative blurring in _stackBlurSpatial */
+    if (nrrdCastClampRound(nblur[blIdx], ndst, nin->type, AIR_TRUE,
+                           nrrdTypeIsIntegral[nin->type])
+        || nrrdContentSet_va(nblur[blIdx], "blur", nin, "")) {
+      biffMovef(GAGE, NRRD, "%s: trouble w/ %u of %u (scale %g)",
+                me, blIdx, sbp->num, sigma);
+      airMopError(mop); return 1;
+    }
+    if (sbp->verbose) {
+      fprintf(stderr, "  done.\n");
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** blurs the levels of the stack with large enough sigma from pyramid
+** bases; the others are blurred by _stackBlurSpatial
+*/
+static int
+_stackBlurPyramid(Nrrd *const nblur[], gageStackBlurParm *sbp,
+                  NrrdKernelSpec *kssb,
+                  const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_stackBlurPyramid";
+  gageStackBlurParm sbpSmall;
+  unsigned int axi, blStart;
+  int sizeOkay;
+
+  /* the coarse grid is node-centered, so needs at least two samples */
+  sizeOkay = AIR_TRUE;
+  for (axi=0; axi<(sbp->oneDim ? 1u : 3u); axi++) {
+    sizeOkay &= (nin->axis[kind->baseDim + axi].size >= 2);
+  }
+  if (nrrdKernelDiscreteGaussian == kssb->kernel) {
+    /* the small scales have to be done iteratively */
+    for (blStart=0; blStart<sbp->num; blStart++) {
+      if (sizeOkay && _pyramidFactor(sbp->sigma[blStart]) > 1) {
+        break;
+      }
+    }
+  } else {
+    blStart = 0;
+  }
+  if (blStart) {
+    /* shallow copy to describe just the small scales */
+    sbpSmall = *sbp;
+    sbpSmall.num = blStart;
+    if (_stackBlurSpatial(nblur, &sbpSmall, kssb, nin, kind)) {
+      biffAddf(GAGE, "%s: trouble with small scales", me);
+      return 1;
+    }
+  }
+  if (blStart < sbp->num
+      && _stackBlurLevelsRun(nblur, sbp, blStart, sizeOkay, nin, kind)) {
+    biffAddf(GAGE, "%s: trouble with pyramid blurring", me);
+    return 1;
+  }
+  return 0;
+}
+
 /*
 ** little helper function to do pre-blurring of a given nrrd
 ** of the sort that might be useful for scale-space gage use
@@ -1411,7 +2389,19 @@ gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
   fftable = (!sbp->needSpatialBlur
              && nrrdBoundaryWrap == sbp->bspec->boundary
              && nrrdKernelDiscreteGaussian == sbp->kspec->kernel);
-  if (fftable && nrrdFFTWEnabled) {
+  if (sbp->recursive) {
+    if (_stackBlurRecursive(nblur, sbp, kssb, nin, kind)) {
+      biffAddf(GAGE, "%s: trouble with recursive blurring", me);
+      airMopError(mop); return 1;
+    }
+    spatialBlurred = AIR_TRUE;
+  } else if (sbp->pyramid) {
+    if (_stackBlurPyramid(nblur, sbp, kssb, nin, kind)) {
+      biffAddf(GAGE, "%s: trouble with pyramid blurring", me);
+      airMopError(mop); return 1;
+    }
+    spatialBlurred = AIR_TRUE;
+  } else if (fftable && nrrdFFTWEnabled) {
     /* go directly to FFT-based blurring */
     if (_stackBlurDiscreteGaussFFT(nblur, sbp, nin, kind)) {
       biffAddf(GAGE, "%s: trouble with frequency-space blurring", me);
@@ -1449,7 +2439,14 @@ gageStackBlur(Nrrd *const nblur[], gageStackBlurParm *sbp,
   E = 0;
   for (blIdx=0; blIdx<sbp->num; blIdx++) {
     for (kvpIdx=0; kvpIdx<KVP_NUM; kvpIdx++) {
-      if (KVP_DGGSM_IDX != kvpIdx) {
+      if (KVP_RECUR_IDX == kvpIdx || KVP_PYRAM_IDX == kvpIdx) {
+        /* only saved when true, so that older stacks are
+           still recognized as neither recursive nor pyramid */
+        if (KVP_RECUR_IDX == kvpIdx ? sbp->recursive : sbp->pyramid) {
+          if (!E) E |= nrrdKeyValueAdd(nblur[blIdx], _blurKey[kvpIdx],
+                                       blurVal[blIdx].val[kvpIdx]);
+        }
+      } else if (KVP_DGGSM_IDX != kvpIdx) {
         if (!E) E |= nrrdKeyValueAdd(nblur[blIdx], _blurKey[kvpIdx],
                                      blurVal[blIdx].val[kvpIdx]);
       } else {
@@ -1500,6 +2497,8 @@ gageStackBlurCheck(const Nrrd *const nblur[],
       || _checkNrrd(NULL, nblur, sbp->num, AIR_TRUE, nin, kind)
       || (!( blurVal = _blurValAlloc(mop, sbp, kssb, nin,
                                      (sbp->needSpatialBlur
+                                      || sbp->recursive
+                                      || sbp->pyramid
                                       ? AIR_TRUE
                                       : AIR_FALSE)) )) ) {
     biffAddf(GAGE, "%s: problem", me);
@@ -1534,6 +2533,16 @@ gageStackBlurCheck(const Nrrd *const nblur[],
       char *tmpval;
       tmpval = nrrdKeyValueGet(nblur[blIdx], _blurKey[kvpIdx]);
       airMopAdd(mop, tmpval, airFree, airMopAlways);
+      if (KVP_RECUR_IDX == kvpIdx || KVP_PYRAM_IDX == kvpIdx) {
+        /* missing means not recursive, or not pyramid */
+        if (strcmp(tmpval ? tmpval : "false", blurVal[blIdx].val[kvpIdx])) {
+          biffAddf(GAGE, "%s: found key[%s] \"%s\" != wanted \"%s\"", me,
+                   _blurKey[kvpIdx], tmpval ? tmpval : "false",
+                   blurVal[blIdx].val[kvpIdx]);
+          airMopError(mop); return 1;
+        }
+        continue;
+      }
       if (KVP_DGGSM_IDX != kvpIdx) {
         if (!tmpval) {
           biffAddf(GAGE, "%s: didn't see key \"%s\" in nblur[%u]", me,
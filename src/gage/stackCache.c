@@ -0,0 +1,488 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "gage.h"
+#include "privateGage.h"
+
+/*
+** A content-addressed on-disk cache of scale-space stacks.
+**
+** The blurrings of an input volume are saved in a cache directory with
+** names based on a 64-bit hash of the input values (and type, sizes,
+** orientation, and kind) and of the gageStackBlurParm (as printed by
+** gageStackBlurParmSprint, but not including verbosity), so callers
+** don't have to manage file names, and a changed input volume is never
+** mistaken for an old one.  After loading, gageStackBlurCheck still
+** verifies the KVPs, so a hash collision just means recomputing.
+**
+** The directory also holds a small text index recording, for each
+** stack, its number of files, its size, and when it was last used, so
+** that the least recently used stacks can be evicted to keep the cache
+** within a size budget.  Files are written to temporary names and then
+** renamed, so readers never see partially written files.  Concurrent
+** users of one cache directory may lose each other's updates to the
+** index, which only means that some stacks are not (yet) candidates
+** for eviction.
+*/
+
+#define SBC_PREFIX "gsb-"
+#define SBC_INDEX "gsb-index.txt"
+#define SBC_KEY_LEN 16
+
+typedef struct {
+  char key[SBC_KEY_LEN+1];  /* hash as hex string */
+  unsigned int num;         /* number of blurrings (files) */
+  double size,              /* total bytes of files */
+    used;                   /* airTime() of last use */
+} _sbcEntry;
+
+/* 64-bit FNV-1a */
+static airULLong
+_sbcHashBytes(airULLong hash, const void *_data, size_t len) {
+  const unsigned char *data;
+  size_t ii;
+
+  data = AIR_CAST(const unsigned char *, _data);
+  for (ii=0; ii<len; ii++) {
+    hash ^= data[ii];
+    hash *= AIR_ULLONG(1099511628211);
+  }
+  return hash;
+}
+
+/* so that all non-existent values (of any NaN bit pattern) hash alike */
+static airULLong
+_sbcHashDouble(airULLong hash, double val) {
+  if (!AIR_EXISTS(val)) {
+    val = 0;
+    hash = _sbcHashBytes(hash, "nan", 3);
+  }
+  return _sbcHashBytes(hash, &val, sizeof(double));
+}
+
+static int
+_sbcKey(char key[SBC_KEY_LEN+1], const gageStackBlurParm *sbp,
+        const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_sbcKey";
+  gageStackBlurParm sbpQuiet;
+  char stmp[AIR_STRLEN_LARGE];
+  airULLong hash;
+  unsigned int axi, si;
+
+  /* the verbosity doesn't change the blurrings */
+  sbpQuiet = *sbp;
+  sbpQuiet.verbose = 0;
+  if (gageStackBlurParmSprint(stmp, &sbpQuiet, NULL, NULL)) {
+    biffAddf(GAGE, "%s: trouble printing blur parms", me);
+    return 1;
+  }
+  hash = AIR_ULLONG(14695981039346656037);
+  hash = _sbcHashBytes(hash, stmp, strlen(stmp));
+  hash = _sbcHashBytes(hash, kind->name, strlen(kind->name));
+  hash = _sbcHashBytes(hash, &(nin->type), sizeof(nin->type));
+  /* the orientation is saved with the blurrings, so a volume with the
+     same values but a different placement in world space needs its
+     own stack */
+  hash = _sbcHashBytes(hash, &(nin->space), sizeof(nin->space));
+  hash = _sbcHashBytes(hash, &(nin->spaceDim), sizeof(nin->spaceDim));
+  for (si=0; si<nin->spaceDim; si++) {
+    hash = _sbcHashDouble(hash, nin->spaceOrigin[si]);
+  }
+  for (axi=0; axi<nin->dim; axi++) {
+    const NrrdAxisInfo *axis = nin->axis + axi;
+    hash = _sbcHashBytes(hash, &(axis->size), sizeof(size_t));
+    hash = _sbcHashDouble(hash, axis->spacing);
+    hash = _sbcHashBytes(hash, &(axis->center), sizeof(int));
+    for (si=0; si<nin->spaceDim; si++) {
+      hash = _sbcHashDouble(hash, axis->spaceDirection[si]);
+    }
+  }
+  hash = _sbcHashBytes(hash, nin->data,
+                       nrrdElementNumber(nin)*nrrdElementSize(nin));
+  sprintf(key, "%08x%08x",
+          AIR_CAST(unsigned int, hash >> 32),
+          AIR_CAST(unsigned int, hash & 0xffffffff));
+  return 0;
+}
+
+/* rename that replaces any existing dst, as on POSIX */
+static int
+_sbcRename(const char *src, const char *dst) {
+#ifdef _WIN32
+  remove(dst);
+#endif
+  return rename(src, dst);
+}
+
+/*
+** reads the index in cacheDir into an airArray of _sbcEntry;
+** a missing index is the same as an empty one
+*/
+static int
+_sbcIndexRead(airArray *entArr, _sbcEntry **entP, const char *cacheDir) {
+  static const char me[]="_sbcIndexRead";
+  char *iname, line[AIR_STRLEN_MED], key[AIR_STRLEN_MED];
+  _sbcEntry *ent;
+  unsigned int idx, num;
+  double size, used;
+  FILE *file;
+
+  iname = AIR_CALLOC(strlen(cacheDir) + strlen(SBC_INDEX) + 2, char);
+  if (!iname) {
+    biffAddf(GAGE, "%s: couldn't allocate index name", me);
+    return 1;
+  }
+  sprintf(iname, "%s/%s", cacheDir, SBC_INDEX);
+  file = fopen(iname, "r");
+  free(iname);
+  if (!file) {
+    return 0;
+  }
+  while (fgets(line, AIR_STRLEN_MED, file)) {
+    if ('#' == line[0]) {
+      continue;
+    }
+    if (4 != sscanf(line, "%s %u %lg %lg", key, &num, &size, &used)
+        || SBC_KEY_LEN != strlen(key)) {
+      /* skip garbled lines */
+      continue;
+    }
+    idx = airArrayLenIncr(entArr, 1);
+    ent = *entP + idx;
+    strcpy(ent->key, key);
+    ent->num = num;
+    ent->size = size;
+    ent->used = used;
+  }
+  fclose(file);
+  return 0;
+}
+
+static int
+_sbcIndexWrite(const _sbcEntry *ent, unsigned int entNum,
+               const char *cacheDir) {
+  static const char me[]="_sbcIndexWrite";
+  char *iname, *tname;
+  unsigned int ei;
+  airArray *mop;
+  FILE *file;
+
+  mop = airMopNew();
+  iname = AIR_CALLOC(strlen(cacheDir) + strlen(SBC_INDEX) + 2, char);
+  airMopAdd(mop, iname, airFree, airMopAlways);
+  tname = AIR_CALLOC(strlen(cacheDir) + strlen(SBC_INDEX)
+                     + AIR_STRLEN_SMALL, char);
+  airMopAdd(mop, tname, airFree, airMopAlways);
+  if (!(iname && tname)) {
+    biffAddf(GAGE, "%s: couldn't allocate file names", me);
+    airMopError(mop); return 1;
+  }
+  sprintf(iname, "%s/%s", cacheDir, SBC_INDEX);
+  sprintf(tname, "%s.%.0f.tmp", iname, 1000000*airTime());
+  if (!( file = fopen(tname, "w") )) {
+    biffAddf(GAGE, "%s: couldn't open \"%s\" for writing", me, tname);
+    airMopError(mop); return 1;
+  }
+  fprintf(file, "# gageStackBlur cache index: key, #files, bytes, "
+          "last used\n");
+  for (ei=0; ei<entNum; ei++) {
+    fprintf(file, "%s %u %.17g %.17g\n", ent[ei].key, ent[ei].num,
+            ent[ei].size, ent[ei].used);
+  }
+  if (fclose(file) || _sbcRename(tname, iname)) {
+    remove(tname);
+    biffAddf(GAGE, "%s: couldn't write \"%s\"", me, iname);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/* removes the files of a cached stack */
+static void
+_sbcEvict(const _sbcEntry *ent, const char *cacheDir, int verbose) {
+  static const char me[]="_sbcEvict";
+  char *fname;
+  unsigned int ii;
+
+  fname = AIR_CALLOC(strlen(cacheDir) + AIR_STRLEN_SMALL, char);
+  if (!fname) {
+    return;
+  }
+  if (verbose) {
+    fprintf(stderr, "%s: evicting %s (%g bytes)\n", me, ent->key, ent->size);
+  }
+  for (ii=0; ii<ent->num; ii++) {
+    sprintf(fname, "%s/" SBC_PREFIX "%s-%03u.nrrd", cacheDir, ent->key, ii);
+    remove(fname);
+  }
+  free(fname);
+  return;
+}
+
+/*
+** records that the stack with the given key was just used (and maybe
+** just created), and then evicts least recently used stacks (other
+** than this one) until the total size is within cacheSizeMax megabytes
+** (or not at all, if cacheSizeMax is zero)
+*/
+static int
+_sbcIndexUpdate(const char *key, unsigned int num, double size,
+                const char *cacheDir, double cacheSizeMax, int verbose) {
+  static const char me[]="_sbcIndexUpdate";
+  airArray *mop, *entArr;
+  _sbcEntry *ent;
+  unsigned int ei, entNum;
+  double total;
+
+  mop = airMopNew();
+  ent = NULL;
+  entArr = airArrayNew(AIR_CAST(void **, &ent), &entNum,
+                       sizeof(_sbcEntry), 32);
+  airMopAdd(mop, entArr, (airMopper)airArrayNuke, airMopAlways);
+  if (_sbcIndexRead(entArr, &ent, cacheDir)) {
+    biffAddf(GAGE, "%s: trouble reading index", me);
+    airMopError(mop); return 1;
+  }
+  for (ei=0; ei<entNum; ei++) {
+    if (!strcmp(key, ent[ei].key)) {
+      break;
+    }
+  }
+  if (ei == entNum) {
+    airArrayLenIncr(entArr, 1);
+    strcpy(ent[ei].key, key);
+  }
+  ent[ei].num = num;
+  ent[ei].size = size;
+  ent[ei].used = airTime();
+  if (cacheSizeMax > 0) {
+    total = 0;
+    for (ei=0; ei<entNum; ei++) {
+      total += ent[ei].size;
+    }
+    while (total > cacheSizeMax*1024*1024) {
+      unsigned int oldIdx = entNum;
+      for (ei=0; ei<entNum; ei++) {
+        if (strcmp(key, ent[ei].key)
+            && (oldIdx == entNum || ent[ei].used < ent[oldIdx].used)) {
+          oldIdx = ei;
+        }
+      }
+      if (oldIdx == entNum) {
+        /* only the current stack is left */
+        break;
+      }
+      _sbcEvict(ent + oldIdx, cacheDir, verbose);
+      total -= ent[oldIdx].size;
+      ent[oldIdx] = ent[entNum-1];
+      airArrayLenIncr(entArr, -1);
+    }
+  }
+  if (_sbcIndexWrite(ent, entNum, cacheDir)) {
+    biffAddf(GAGE, "%s: trouble writing index", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/* saves the blurrings, each to a temporary file that is then renamed */
+static int
+_sbcSave(double *sizeP, Nrrd *const nblur[], unsigned int num,
+         const char *format) {
+  static const char me[]="_sbcSave";
+  char *fname, *tname;
+  unsigned int ii;
+  airArray *mop;
+  NrrdIoState *nio;
+
+  mop = airMopNew();
+  fname = AIR_CALLOC(strlen(format) + AIR_STRLEN_SMALL, char);
+  airMopAdd(mop, fname, airFree, airMopAlways);
+  tname = AIR_CALLOC(strlen(format) + 2*AIR_STRLEN_SMALL, char);
+  airMopAdd(mop, tname, airFree, airMopAlways);
+  nio = nrrdIoStateNew();
+  airMopAdd(mop, nio, (airMopper)nrrdIoStateNix, airMopAlways);
+  if (!(fname && tname && nio)) {
+    biffAddf(GAGE, "%s: couldn't allocate", me);
+    airMopError(mop); return 1;
+  }
+  /* not relying on the (temporary) file name to set the format */
+  if (nrrdIoStateFormatSet(nio, nrrdFormatNRRD)) {
+    biffMovef(GAGE, NRRD, "%s: couldn't set format", me);
+    airMopError(mop); return 1;
+  }
+  *sizeP = 0;
+  for (ii=0; ii<num; ii++) {
+    sprintf(fname, format, ii);
+    sprintf(tname, "%s.%.0f.tmp", fname, 1000000*airTime());
+    if (nrrdSave(tname, nblur[ii], nio)) {
+      remove(tname);
+      biffMovef(GAGE, NRRD, "%s: couldn't save blurring %u", me, ii);
+      airMopError(mop); return 1;
+    }
+    if (_sbcRename(tname, fname)) {
+      remove(tname);
+      biffAddf(GAGE, "%s: couldn't rename \"%s\" to \"%s\"",
+               me, tname, fname);
+      airMopError(mop); return 1;
+    }
+    *sizeP += nrrdElementNumber(nblur[ii])*nrrdElementSize(nblur[ii]);
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** gageStackBlurCacheGet
+**
+** like gageStackBlurGet, but the blurrings are looked for in, and if
+** (re)computed, saved to, the content-addressed cache in directory
+** cacheDir (which must exist).  The cache is kept to (about)
+** cacheSizeMax megabytes by evicting the least recently used stacks;
+** cacheSizeMax 0 means no limit.  Problems saving to the cache are
+** not errors, since the blurrings are still computed (but they are
+** described on stderr when sbp->verbose).
+*/
+int
+gageStackBlurCacheGet(Nrrd *const nblur[], int *recomputedP,
+                      gageStackBlurParm *sbp,
+                      const char *cacheDir, double cacheSizeMax,
+                      const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="gageStackBlurCacheGet";
+  char key[SBC_KEY_LEN+1], *format, *suberr;
+  unsigned int ii;
+  int recompute;
+  double size;
+  airArray *mop;
+  FILE *file;
+
+  if (!( nblur && sbp && cacheDir && nin && kind )) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  for (ii=0; ii<sbp->num; ii++) {
+    if (!nblur[ii]) {
+      biffAddf(GAGE, "%s: nblur[%u] NULL", me, ii);
+      return 1;
+    }
+  }
+  if (gageStackBlurParmCheck(sbp)) {
+    biffAddf(GAGE, "%s: trouble with blur parms", me);
+    return 1;
+  }
+  if (!(cacheSizeMax >= 0)) {
+    biffAddf(GAGE, "%s: cacheSizeMax %g not >= 0", me, cacheSizeMax);
+    return 1;
+  }
+  mop = airMopNew();
+  if (_sbcKey(key, sbp, nin, kind)) {
+    biffAddf(GAGE, "%s: trouble computing cache key", me);
+    airMopError(mop); return 1;
+  }
+  format = AIR_CALLOC(strlen(cacheDir) + AIR_STRLEN_SMALL, char);
+  if (!format) {
+    biffAddf(GAGE, "%s: couldn't allocate format", me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, format, airFree, airMopAlways);
+  sprintf(format, "%s/" SBC_PREFIX "%s-%%03u.nrrd", cacheDir, key);
+
+  /* see if the last file is there, since it is renamed into place last */
+  {
+    char *fname;
+    fname = AIR_CALLOC(strlen(format) + AIR_STRLEN_SMALL, char);
+    if (!fname) {
+      biffAddf(GAGE, "%s: couldn't allocate fname", me);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, fname, airFree, airMopAlways);
+    sprintf(fname, format, sbp->num-1);
+    file = fopen(fname, "rb");
+    recompute = !file;
+    airFclose(file);
+  }
+  if (recompute) {
+    if (sbp->verbose) {
+      fprintf(stderr, "%s: no cached stack %s; will compute\n", me, key);
+    }
+  } else if (nrrdLoadMulti(nblur, sbp->num, format, 0, NULL)) {
+    airMopAdd(mop, suberr = biffGetDone(NRRD), airFree, airMopAlways);
+    if (sbp->verbose) {
+      fprintf(stderr, "%s: will recompute blurrings that couldn't be "
+              "read:\n%s\n", me, suberr);
+    }
+    recompute = AIR_TRUE;
+  } else if (gageStackBlurCheck(AIR_CAST(const Nrrd*const*, nblur),
+                                sbp, nin, kind)) {
+    airMopAdd(mop, suberr = biffGetDone(GAGE), airFree, airMopAlways);
+    if (sbp->verbose) {
+      fprintf(stderr, "%s: will recompute cached blurrings %s "
+              "that don't match:\n%s\n", me, key, suberr);
+    }
+    recompute = AIR_TRUE;
+  } else if (sbp->verbose) {
+    fprintf(stderr, "%s: will reuse cached stack %s\n", me, key);
+  }
+
+  size = 0;
+  if (recompute) {
+    if (gageStackBlur(nblur, sbp, nin, kind)) {
+      biffAddf(GAGE, "%s: trouble computing blurrings", me);
+      airMopError(mop); return 1;
+    }
+    if (_sbcSave(&size, nblur, sbp->num, format)) {
+      airMopAdd(mop, suberr = biffGetDone(GAGE), airFree, airMopAlways);
+      if (sbp->verbose) {
+        fprintf(stderr, "%s: couldn't save to cache:\n%s\n", me, suberr);
+      }
+    } else if (_sbcIndexUpdate(key, sbp->num, size, cacheDir,
+                               cacheSizeMax, sbp->verbose)) {
+      airMopAdd(mop, suberr = biffGetDone(GAGE), airFree, airMopAlways);
+      if (sbp->verbose) {
+        fprintf(stderr, "%s: couldn't update cache index:\n%s\n",
+                me, suberr);
+      }
+    }
+  } else {
+    for (ii=0; ii<sbp->num; ii++) {
+      size += nrrdElementNumber(nblur[ii])*nrrdElementSize(nblur[ii]);
+    }
+    if (_sbcIndexUpdate(key, sbp->num, size, cacheDir,
+                        cacheSizeMax, sbp->verbose)) {
+      airMopAdd(mop, suberr = biffGetDone(GAGE), airFree, airMopAlways);
+      if (sbp->verbose) {
+        fprintf(stderr, "%s: couldn't update cache index:\n%s\n",
+                me, suberr);
+      }
+    }
+  }
+  if (recomputedP) {
+    *recomputedP = recompute;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,690 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "gage.h"
+#include "privateGage.h"
+
+/*
+** Lazy scale-space stacks.
+**
+** Instead of blurring the whole input volume at every scale before
+** probing (with gageStackBlur), each blurring level is divided into
+** bricks of brickSize^3 samples, and a brick is blurred only when
+** gageIv3Fill first needs one of its samples.  Bricks are kept in a
+** cache, shared by all levels, which is limited to memMax megabytes
+** by evicting the least recently used bricks.  A brick is blurred by
+** cropping nin to the brick plus the support of the blurring kernel
+** (or, with wrap or mirror boundaries, the whole axis if that support
+** crosses the boundary), and resampling just the brick from that, so
+** bricks have the same values as the corresponding parts of
+** (spatial-domain) gageStackBlur output.  Levels are blurred directly
+** from nin, so with nrrdKernelDiscreteGaussian the diffusion is done
+** in (equal) steps of at most sbp->dgGoodSigmaMax for each level,
+** rather than starting from the previous level; sbp->recursive and
+** sbp->pyramid are not used.
+**
+** The per-volumes from gageStackLazyPerVolumeNew, and their copies
+** made by gageContextCopy, all use the same gageStackLazy, possibly
+** from different threads.  Each per-volume keeps the bricks used by its
+** last iv3 fill pinned (so they can't be evicted), until a fill needs
+** a different set of bricks (or the per-volume is nixed).  Successive
+** probes mostly need the same bricks, so most fills take no locks at
+** all.  Pinning and unpinning take the one of GAGE_STACK_LAZY_MUTEX_NUM
+** mutexes that guards the brick's slot, and the mutex of the list of
+** unpinned bricks (in order of last use, so evicting the least recently
+** used one doesn't need a search) only when a brick becomes pinned or
+** unpinned.  Bricks are blurred without holding any mutex; two threads
+** needing the same new brick may both blur it, in which case one of the
+** results is discarded.
+*/
+
+static size_t
+_lazyBrickBytes(const Nrrd *nbrick) {
+
+  return nrrdElementNumber(nbrick)*nrrdElementSize(nbrick);
+}
+
+static unsigned int
+_lazySlot(const gageStackLazy *lazy, unsigned int blIdx,
+          unsigned int bx, unsigned int by, unsigned int bz) {
+
+  return (bx + lazy->brickNum[0]*(by + lazy->brickNum[1]*(bz
+                                   + lazy->brickNum[2]*blIdx)));
+}
+
+/*
+******** gageStackLazyNew
+**
+** creates a gageStackLazy for the blurrings of nin described by sbp
+** (which is copied), in bricks with brickSize samples along each
+** axis, using at most memMax megabytes for the bricks (or with no
+** limit, if memMax is zero).  nin is not copied, and has to persist
+** until gageStackLazyNix.
+*/
+gageStackLazy *
+gageStackLazyNew(const Nrrd *nin, const gageKind *kind,
+                 const gageStackBlurParm *sbp,
+                 unsigned int brickSize, double memMax) {
+  static const char me[]="gageStackLazyNew";
+  gageStackLazy *lazy;
+  unsigned int axi, mi, size;
+  airArray *mop;
+  int E;
+
+  if (!(nin && kind && sbp)) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return NULL;
+  }
+  if (gageStackBlurParmCheck(sbp)) {
+    biffAddf(GAGE, "%s: problem with blurring parms", me);
+    return NULL;
+  }
+  if (gageKindVolumeCheck(kind, nin)) {
+    biffAddf(GAGE, "%s: problem with volume as %s kind", me, kind->name);
+    return NULL;
+  }
+  if (!brickSize) {
+    biffAddf(GAGE, "%s: need non-zero brick size", me);
+    return NULL;
+  }
+  if (!( AIR_EXISTS(memMax) && memMax >= 0 )) {
+    biffAddf(GAGE, "%s: need non-negative memMax (not %g)", me, memMax);
+    return NULL;
+  }
+  mop = airMopNew();
+  lazy = AIR_CALLOC(1, gageStackLazy);
+  if (!lazy) {
+    biffAddf(GAGE, "%s: couldn't allocate", me);
+    airMopError(mop); return NULL;
+  }
+  airMopAdd(mop, lazy, (airMopper)gageStackLazyNix, airMopOnError);
+  lazy->nin = nin;
+  lazy->kind = kind;
+  lazy->sbp = gageStackBlurParmNew();
+  if (!lazy->sbp || gageStackBlurParmCopy(lazy->sbp, sbp)) {
+    biffAddf(GAGE, "%s: couldn't copy blurring parms", me);
+    airMopError(mop); return NULL;
+  }
+  lazy->brickSize = brickSize;
+  lazy->slotNum = sbp->num;
+  for (axi=0; axi<3; axi++) {
+    size = AIR_CAST(unsigned int, nin->axis[kind->baseDim + axi].size);
+    lazy->brickNum[axi] = (size + brickSize - 1)/brickSize;
+    lazy->slotNum *= lazy->brickNum[axi];
+  }
+  lazy->nbrick = AIR_CALLOC(lazy->slotNum, Nrrd *);
+  lazy->pinNum = AIR_CALLOC(lazy->slotNum, unsigned int);
+  lazy->lruPrev = AIR_CALLOC(lazy->slotNum, unsigned int);
+  lazy->lruNext = AIR_CALLOC(lazy->slotNum, unsigned int);
+  lazy->lruMutex = airThreadMutexNew();
+  E = !(lazy->nbrick && lazy->pinNum && lazy->lruPrev && lazy->lruNext
+        && lazy->lruMutex);
+  for (mi=0; mi<GAGE_STACK_LAZY_MUTEX_NUM; mi++) {
+    E |= !(lazy->slotMutex[mi] = airThreadMutexNew());
+  }
+  if (E) {
+    biffAddf(GAGE, "%s: couldn't allocate for %u bricks", me,
+             lazy->slotNum);
+    airMopError(mop); return NULL;
+  }
+  lazy->lruFirst = lazy->lruLast = lazy->slotNum;
+  lazy->memMax = AIR_CAST(size_t, memMax*1024*1024);
+  lazy->memUsed = 0;
+  lazy->computeNum = 0;
+  lazy->evictNum = 0;
+  airMopOkay(mop);
+  return lazy;
+}
+
+gageStackLazy *
+gageStackLazyNix(gageStackLazy *lazy) {
+  unsigned int si, mi;
+
+  if (lazy) {
+    if (lazy->nbrick) {
+      for (si=0; si<lazy->slotNum; si++) {
+        nrrdNuke(lazy->nbrick[si]);
+      }
+      airFree(lazy->nbrick);
+    }
+    airFree(lazy->pinNum);
+    airFree(lazy->lruPrev);
+    airFree(lazy->lruNext);
+    gageStackBlurParmNix(lazy->sbp);
+    for (mi=0; mi<GAGE_STACK_LAZY_MUTEX_NUM; mi++) {
+      airThreadMutexNix(lazy->slotMutex[mi]);
+    }
+    airThreadMutexNix(lazy->lruMutex);
+    airFree(lazy);
+  }
+  return NULL;
+}
+
+/*
+** the sigmas of the passes of blurring that make level blIdx from nin:
+** one pass for most kernels, but for nrrdKernelDiscreteGaussian, the
+** same sequence of steps (of at most sbp->dgGoodSigmaMax) with which
+** _stackBlurSpatial gets to this level, one level at a time, so that
+** the results match.  Returns the number of passes, and sets psig[]
+** if non-NULL.
+*/
+static unsigned int
+_lazyPassSigma(double *psig, const gageStackBlurParm *sbp,
+               unsigned int blIdx) {
+  unsigned int li, passNum;
+  double timeStepMax, timeDone, timeLeft, timeDo;
+
+  passNum = 0;
+  if (nrrdKernelDiscreteGaussian != sbp->kspec->kernel) {
+    if (sbp->sigma[blIdx] > 0) {
+      if (psig) {
+        psig[passNum] = sbp->sigma[blIdx];
+      }
+      passNum++;
+    }
+    return passNum;
+  }
+  timeStepMax = (sbp->dgGoodSigmaMax)*(sbp->dgGoodSigmaMax);
+  timeDone = 0;
+  for (li=0; li<=blIdx; li++) {
+    timeLeft = sbp->sigma[li]*sbp->sigma[li] - timeDone;
+    do {
+      timeDo = (timeLeft > timeStepMax
+                ? timeStepMax
+                : timeLeft);
+      if (timeDo > 0) {
+        if (psig) {
+          psig[passNum] = sqrt(timeDo);
+        }
+        passNum++;
+      }
+      timeLeft -= timeDo;
+    } while (timeLeft > 0.0);
+    timeDone = sbp->sigma[li]*sbp->sigma[li];
+  }
+  return passNum;
+}
+
+/*
+** blurs the brick at brick coordinates bxyz of level blIdx into nout;
+** does not use the GAGE biff key, but on error leaves messages in the
+** NRRD key, which the caller has to take out
+*/
+static int
+_lazyBrickBlur(Nrrd *nout, const gageStackLazy *lazy,
+               unsigned int blIdx, const unsigned int bxyz[3]) {
+  const gageStackBlurParm *sbp;
+  NrrdResampleContext *rsmc;
+  Nrrd *ncrop;
+  double kparm[NRRD_KERNEL_PARMS_NUM], *psig;
+  size_t cmin[NRRD_DIM_MAX], cmax[NRRD_DIM_MAX],
+    lo[3], hi[3];
+  ptrdiff_t cm0, cm1, size;
+  unsigned int axi, ax, passIdx, passNum, margin;
+  int E, wrapped;
+  airArray *mop;
+
+  sbp = lazy->sbp;
+  mop = airMopNew();
+  passNum = _lazyPassSigma(NULL, sbp, blIdx);
+  psig = NULL;
+  if (passNum) {
+    if (!( psig = AIR_CALLOC(passNum, double) )) {
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, psig, airFree, airMopAlways);
+    _lazyPassSigma(psig, sbp, blIdx);
+  }
+  memcpy(kparm, sbp->kspec->parm, sizeof(kparm));
+  /* every pass can spread the effects of the crop boundary inward */
+  margin = 0;
+  for (passIdx=0; passIdx<passNum; passIdx++) {
+    kparm[0] = psig[passIdx];
+    margin += AIR_CAST(unsigned int,
+                       ceil(sbp->kspec->kernel->support(kparm)));
+  }
+  wrapped = (nrrdBoundaryWrap == sbp->bspec->boundary
+             || nrrdBoundaryMirror == sbp->bspec->boundary);
+  for (ax=0; ax<lazy->kind->baseDim; ax++) {
+    cmin[ax] = 0;
+    cmax[ax] = lazy->nin->axis[ax].size - 1;
+  }
+  for (axi=0; axi<3; axi++) {
+    ax = lazy->kind->baseDim + axi;
+    size = AIR_CAST(ptrdiff_t, lazy->nin->axis[ax].size);
+    lo[axi] = AIR_CAST(size_t, bxyz[axi])*lazy->brickSize;
+    hi[axi] = AIR_MIN(lo[axi] + lazy->brickSize,
+                      AIR_CAST(size_t, size)) - 1;
+    if (sbp->oneDim && axi) {
+      cmin[ax] = lo[axi];
+      cmax[ax] = hi[axi];
+      continue;
+    }
+    cm0 = AIR_CAST(ptrdiff_t, lo[axi]) - margin;
+    cm1 = AIR_CAST(ptrdiff_t, hi[axi]) + margin;
+    if (wrapped && (cm0 < 0 || cm1 > size - 1)) {
+      /* the kernel will need samples from the other end of the axis */
+      cm0 = 0;
+      cm1 = size - 1;
+    }
+    cmin[ax] = AIR_CAST(size_t, AIR_MAX(0, cm0));
+    cmax[ax] = AIR_CAST(size_t, AIR_MIN(size - 1, cm1));
+  }
+  if (!passNum) {
+    /* no blurring; margin is zero so the crop is the brick */
+    if (nrrdCrop(nout, lazy->nin, cmin, cmax)) {
+      airMopError(mop); return 1;
+    }
+    airMopOkay(mop);
+    return 0;
+  }
+  ncrop = nrrdNew();
+  airMopAdd(mop, ncrop, (airMopper)nrrdNuke, airMopAlways);
+  rsmc = nrrdResampleContextNew();
+  airMopAdd(mop, rsmc, (airMopper)nrrdResampleContextNix, airMopAlways);
+  E = nrrdCrop(ncrop, lazy->nin, cmin, cmax);
+  if (!E) E |= nrrdResampleDefaultCenterSet(rsmc, nrrdDefaultCenter);
+  if (!E) E |= nrrdResampleInputSet(rsmc, ncrop);
+  for (ax=0; ax<lazy->kind->baseDim; ax++) {
+    if (!E) E |= nrrdResampleKernelSet(rsmc, ax, NULL, NULL);
+  }
+  for (axi=0; axi<3; axi++) {
+    ax = lazy->kind->baseDim + axi;
+    if (sbp->oneDim && axi) {
+      if (!E) E |= nrrdResampleKernelSet(rsmc, ax, NULL, NULL);
+    }
+    if (!E) E |= nrrdResampleSamplesSet(rsmc, ax, ncrop->axis[ax].size);
+    if (!E) E |= nrrdResampleRangeFullSet(rsmc, ax);
+  }
+  if (!E) E |= nrrdResampleBoundarySpecSet(rsmc, sbp->bspec);
+  if (!E) E |= nrrdResampleClampSet(rsmc, AIR_TRUE);
+  if (!E) E |= nrrdResampleRenormalizeSet(rsmc, sbp->renormalize);
+  for (passIdx=0; !E && passIdx<passNum; passIdx++) {
+    kparm[0] = psig[passIdx];
+    for (axi=0; axi<(sbp->oneDim ? 1u : 3u); axi++) {
+      if (!E) E |= nrrdResampleKernelSet(rsmc, lazy->kind->baseDim + axi,
+                                         sbp->kspec->kernel, kparm);
+    }
+    if (passIdx) {
+      /* ncrop holds the previous pass; as in _stackBlurSpatial, it's
+         okay for it to be both the input and output of resampling */
+      if (!E) E |= nrrdResampleInputSet(rsmc, ncrop);
+    }
+    if (passIdx == passNum - 1) {
+      /* last pass: only resample the brick, in index space of ncrop */
+      for (axi=0; axi<3; axi++) {
+        if (sbp->oneDim && axi) {
+          continue;
+        }
+        ax = lazy->kind->baseDim + axi;
+        /* cell-centered, so that single-sample bricks are possible */
+        if (!E) E |= nrrdResampleOverrideCenterSet(rsmc, ax,
+                                                   nrrdCenterCell);
+        if (!E) E |= nrrdResampleSamplesSet(rsmc, ax,
+                                            hi[axi] - lo[axi] + 1);
+        if (!E) E |= nrrdResampleRangeSet(rsmc, ax,
+                                          AIR_CAST(double,
+                                                   lo[axi] - cmin[ax])
+                                          - 0.5,
+                                          AIR_CAST(double,
+                                                   hi[axi] - cmin[ax])
+                                          + 0.5);
+      }
+      if (!E) E |= nrrdResampleTypeOutSet(rsmc, lazy->nin->type);
+      if (!E) E |= nrrdResampleExecute(rsmc, nout);
+    } else {
+      if (!E) E |= nrrdResampleTypeOutSet(rsmc, nrrdResample_nt);
+      if (!E) E |= nrrdResampleExecute(rsmc, ncrop);
+    }
+  }
+  if (E) {
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+static airThreadMutex *
+_lazySlotMutex(gageStackLazy *lazy, unsigned int slot) {
+
+  return lazy->slotMutex[slot % GAGE_STACK_LAZY_MUTEX_NUM];
+}
+
+/* with lruMutex locked: takes slot out of the list of unpinned bricks */
+static void
+_lazyLruRemove(gageStackLazy *lazy, unsigned int slot) {
+  unsigned int prev, next;
+
+  prev = lazy->lruPrev[slot];
+  next = lazy->lruNext[slot];
+  if (prev < lazy->slotNum) {
+    lazy->lruNext[prev] = next;
+  } else {
+    lazy->lruFirst = next;
+  }
+  if (next < lazy->slotNum) {
+    lazy->lruPrev[next] = prev;
+  } else {
+    lazy->lruLast = prev;
+  }
+  lazy->lruPrev[slot] = lazy->lruNext[slot] = lazy->slotNum;
+  return;
+}
+
+/* with lruMutex locked: puts slot at the (most recent) end of the list */
+static void
+_lazyLruAppend(gageStackLazy *lazy, unsigned int slot) {
+
+  lazy->lruPrev[slot] = lazy->lruLast;
+  lazy->lruNext[slot] = lazy->slotNum;
+  if (lazy->lruLast < lazy->slotNum) {
+    lazy->lruNext[lazy->lruLast] = slot;
+  } else {
+    lazy->lruFirst = slot;
+  }
+  lazy->lruLast = slot;
+  return;
+}
+
+/*
+** evicts least recently used unpinned bricks until within budget (or
+** everything left is pinned).  A brick is in the list exactly when it
+** is blurred but not pinned, which only changes with both its slot
+** mutex and lruMutex locked, so the list head is re-checked after
+** taking the mutexes in the right order.
+*/
+static void
+_lazyEvict(gageStackLazy *lazy) {
+  unsigned int slot;
+  airThreadMutex *smutex;
+  Nrrd *nbrick;
+
+  if (!lazy->memMax) {
+    return;
+  }
+  for (;;) {
+    airThreadMutexLock(lazy->lruMutex);
+    slot = lazy->lruFirst;
+    if (!( lazy->memUsed > lazy->memMax && slot < lazy->slotNum )) {
+      airThreadMutexUnlock(lazy->lruMutex);
+      break;
+    }
+    airThreadMutexUnlock(lazy->lruMutex);
+    smutex = _lazySlotMutex(lazy, slot);
+    airThreadMutexLock(smutex);
+    airThreadMutexLock(lazy->lruMutex);
+    nbrick = NULL;
+    if (lazy->nbrick[slot] && !lazy->pinNum[slot]) {
+      /* (still) in the list */
+      _lazyLruRemove(lazy, slot);
+      nbrick = lazy->nbrick[slot];
+      lazy->nbrick[slot] = NULL;
+      lazy->memUsed -= _lazyBrickBytes(nbrick);
+      lazy->evictNum++;
+    }
+    airThreadMutexUnlock(lazy->lruMutex);
+    airThreadMutexUnlock(smutex);
+    nrrdNuke(nbrick);
+  }
+  return;
+}
+
+/*
+** makes sure the given brick is in the cache (blurring it if needed),
+** and pins it there
+*/
+static int
+_lazyBrickPin(gageStackLazy *lazy, unsigned int blIdx,
+              const unsigned int bxyz[3]) {
+  unsigned int slot;
+  airThreadMutex *smutex;
+  Nrrd *nbrick, *nmine;
+
+  slot = _lazySlot(lazy, blIdx, bxyz[0], bxyz[1], bxyz[2]);
+  smutex = _lazySlotMutex(lazy, slot);
+  nmine = NULL;
+  airThreadMutexLock(smutex);
+  if (!lazy->nbrick[slot]) {
+    airThreadMutexUnlock(smutex);
+    nbrick = nrrdNew();
+    if (!nbrick || _lazyBrickBlur(nbrick, lazy, blIdx, bxyz)) {
+      nrrdNuke(nbrick);
+      return 1;
+    }
+    airThreadMutexLock(smutex);
+    if (lazy->nbrick[slot]) {
+      /* another thread got here first */
+      nmine = nbrick;
+    } else {
+      lazy->nbrick[slot] = nbrick;
+      lazy->pinNum[slot] = 1;
+      airThreadMutexLock(lazy->lruMutex);
+      lazy->memUsed += _lazyBrickBytes(nbrick);
+      lazy->computeNum++;
+      airThreadMutexUnlock(lazy->lruMutex);
+      airThreadMutexUnlock(smutex);
+      return 0;
+    }
+  }
+  if (!lazy->pinNum[slot]++) {
+    airThreadMutexLock(lazy->lruMutex);
+    _lazyLruRemove(lazy, slot);
+    airThreadMutexUnlock(lazy->lruMutex);
+  }
+  airThreadMutexUnlock(smutex);
+  nrrdNuke(nmine);
+  return 0;
+}
+
+static void
+_lazyBrickUnpin(gageStackLazy *lazy, unsigned int slot) {
+  airThreadMutex *smutex;
+
+  smutex = _lazySlotMutex(lazy, slot);
+  airThreadMutexLock(smutex);
+  if (!--lazy->pinNum[slot]) {
+    airThreadMutexLock(lazy->lruMutex);
+    _lazyLruAppend(lazy, slot);
+    airThreadMutexUnlock(lazy->lruMutex);
+  }
+  airThreadMutexUnlock(smutex);
+  return;
+}
+
+/* unpins the first pinNum bricks in [blo,bhi], in pinning order */
+static void
+_lazyRangeUnpin(gageStackLazy *lazy, unsigned int blIdx,
+                const unsigned int blo[3], const unsigned int bhi[3],
+                unsigned int pinNum) {
+  unsigned int bx, by, bz;
+
+  for (bz=blo[2]; bz<=bhi[2]; bz++) {
+    for (by=blo[1]; by<=bhi[1]; by++) {
+      for (bx=blo[0]; bx<=bhi[0] && pinNum; bx++) {
+        _lazyBrickUnpin(lazy, _lazySlot(lazy, blIdx, bx, by, bz));
+        pinNum--;
+      }
+    }
+  }
+  return;
+}
+
+/*
+** _gageStackLazyRelease
+**
+** unpins the bricks that pvl holds pinned, if any
+*/
+void
+_gageStackLazyRelease(gagePerVolume *pvl) {
+
+  if (pvl->lazy && pvl->lazyPinned) {
+    _lazyRangeUnpin(pvl->lazy, pvl->lazyIdx,
+                    pvl->lazyPinLo, pvl->lazyPinHi, UINT_MAX);
+    pvl->lazyPinned = AIR_FALSE;
+    _lazyEvict(pvl->lazy);
+  }
+  return;
+}
+
+/*
+** _gageStackLazyIv3Fill
+**
+** the gageIv3Fill() for per-volumes from gageStackLazyPerVolumeNew:
+** the same clamping at the volume boundary, but with values copied
+** from the (possibly newly blurred) bricks.  Returns non-zero, with
+** ctx->errNum and ctx->errStr set, if a brick couldn't be blurred.
+*/
+int
+_gageStackLazyIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
+  static const char me[]="_gageStackLazyIv3Fill";
+  gageStackLazy *lazy;
+  const Nrrd *nbrick;
+  int lo[3], hi[3], _xx, _yy, _zz;
+  unsigned int axi, fr, fddd, size[3], blo[3], bhi[3], bxyz[3], pinNum,
+    xx, yy, zz, bsx, bsy, tup, valLen, cacheIdx, edgeNum;
+  size_t dataIdx, dataStride;
+  double *iv3;
+
+  lazy = pvl->lazy;
+  fr = ctx->radius;
+  for (axi=0; axi<3; axi++) {
+    size[axi] = ctx->shape->size[axi];
+    /* idx[0]-1: see Thu Jan 14 comment in filter.c */
+    lo[axi] = ctx->point.idx[axi]-1 - (fr - 1);
+    hi[axi] = lo[axi] + 2*fr - 1;
+    blo[axi] = AIR_CLAMP(0, lo[axi], AIR_CAST(int, size[axi]-1))
+      /lazy->brickSize;
+    bhi[axi] = AIR_CLAMP(0, hi[axi], AIR_CAST(int, size[axi]-1))
+      /lazy->brickSize;
+  }
+  if (!( pvl->lazyPinned
+         && ELL_3V_EQUAL(blo, pvl->lazyPinLo)
+         && ELL_3V_EQUAL(bhi, pvl->lazyPinHi) )) {
+    /* pin the new bricks before unpinning the old ones, so that
+       bricks in both are not made evictable in between */
+    pinNum = 0;
+    for (bxyz[2]=blo[2]; bxyz[2]<=bhi[2]; bxyz[2]++) {
+      for (bxyz[1]=blo[1]; bxyz[1]<=bhi[1]; bxyz[1]++) {
+        for (bxyz[0]=blo[0]; bxyz[0]<=bhi[0]; bxyz[0]++) {
+          if (_lazyBrickPin(lazy, pvl->lazyIdx, bxyz)) {
+            char *nerr;
+            _lazyRangeUnpin(lazy, pvl->lazyIdx, blo, bhi, pinNum);
+            /* take the messages that blurring left, so that they
+               don't pile up */
+            nerr = biffCheck(NRRD) ? biffGetDone(NRRD) : NULL;
+            if (ctx->parm.generateErrStr) {
+              sprintf(ctx->errStr, "%s: couldn't blur brick (%u,%u,%u) "
+                      "of level %u: ", me, bxyz[0], bxyz[1], bxyz[2],
+                      pvl->lazyIdx);
+              if (nerr) {
+                airStrcpy(ctx->errStr + strlen(ctx->errStr),
+                          AIR_STRLEN_LARGE - strlen(ctx->errStr), nerr);
+              }
+            } else {
+              strcpy(ctx->errStr, _GAGE_NON_ERR_STR);
+            }
+            airFree(nerr);
+            ctx->errNum = gageErrStackLazy;
+            return 1;
+          }
+          pinNum++;
+        }
+      }
+    }
+    _gageStackLazyRelease(pvl);
+    ELL_3V_COPY(pvl->lazyPinLo, blo);
+    ELL_3V_COPY(pvl->lazyPinHi, bhi);
+    pvl->lazyPinned = AIR_TRUE;
+  }
+  /* as in the boundary case of gageIv3Fill */
+  fddd = 2*fr*2*fr*2*fr;
+  valLen = pvl->kind->valLen;
+  dataStride = valLen*nrrdTypeSize[lazy->nin->type];
+  iv3 = pvl->iv3;
+  cacheIdx = 0;
+  edgeNum = 0;
+  for (_zz=lo[2]; _zz<=hi[2]; _zz++) {
+    zz = AIR_CLAMP(0, _zz, AIR_CAST(int, size[2]-1));
+    for (_yy=lo[1]; _yy<=hi[1]; _yy++) {
+      yy = AIR_CLAMP(0, _yy, AIR_CAST(int, size[1]-1));
+      for (_xx=lo[0]; _xx<=hi[0]; _xx++) {
+        xx = AIR_CLAMP(0, _xx, AIR_CAST(int, size[0]-1));
+        edgeNum += ((AIR_CAST(int, zz) != _zz)
+                    || (AIR_CAST(int, yy) != _yy)
+                    || (AIR_CAST(int, xx) != _xx));
+        /* pinned by pvl, so it can be read without any mutex */
+        nbrick = lazy->nbrick[_lazySlot(lazy, pvl->lazyIdx,
+                                        xx/lazy->brickSize,
+                                        yy/lazy->brickSize,
+                                        zz/lazy->brickSize)];
+        bsx = AIR_CAST(unsigned int,
+                       nbrick->axis[pvl->kind->baseDim + 0].size);
+        bsy = AIR_CAST(unsigned int,
+                       nbrick->axis[pvl->kind->baseDim + 1].size);
+        dataIdx = (xx % lazy->brickSize
+                   + bsx*(yy % lazy->brickSize
+                          + bsy*(zz % lazy->brickSize)));
+        for (tup=0; tup<valLen; tup++) {
+          iv3[cacheIdx + fddd*tup] =
+            pvl->lup(AIR_CAST(char *, nbrick->data) + dataIdx*dataStride,
+                     tup);
+        }
+        cacheIdx++;
+      }
+    }
+  }
+  ctx->edgeFrac = AIR_CAST(double, edgeNum)/fddd;
+  return 0;
+}
+
+/*
+******** gageStackLazyPerVolumeNew
+**
+** like gageStackPerVolumeNew, but for the lazily blurred levels of
+** the given gageStackLazy, of which there are lazy->sbp->num (and
+** pvlStack has to be allocated for that many).  The resulting
+** per-volumes are attached with gageStackPerVolumeAttach as usual.
+** lazy has to persist until the gageContext is nixed.
+*/
+int
+gageStackLazyPerVolumeNew(gageContext *ctx, gagePerVolume **pvlStack,
+                          gageStackLazy *lazy) {
+  static const char me[]="gageStackLazyPerVolumeNew";
+  unsigned int blIdx;
+
+  if (!( ctx && pvlStack && lazy )) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  for (blIdx=0; blIdx<lazy->sbp->num; blIdx++) {
+    if (!( pvlStack[blIdx] = gagePerVolumeNew(ctx, lazy->nin,
+                                              lazy->kind) )) {
+      biffAddf(GAGE, "%s: on pvl %u of %u", me, blIdx, lazy->sbp->num);
+      return 1;
+    }
+    pvlStack[blIdx]->lazy = lazy;
+    pvlStack[blIdx]->lazyIdx = blIdx;
+  }
+  return 0;
+}
@@ -177,7 +177,8 @@ MEET_EXPORT int meetPullVolStackBlurParmFinishMulti(meetPullVol **mpv,
                                                     const NrrdKernelSpec *ksp,
                                                     const NrrdBoundarySpec *bsp);
 MEET_EXPORT int meetPullVolLoadMulti(meetPullVol **mpv, unsigned int mpvNum,
-                                     char *cachePath, int verbose);
+                                     char *cachePath, double cacheSizeMax,
+                                     int verbose);
 MEET_EXPORT int meetPullVolAddMulti(pullContext *pctx,
                                     meetPullVol **mpv, unsigned int mpvNum,
                                     const NrrdKernelSpec *k00,
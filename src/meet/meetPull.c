@@ -464,10 +464,15 @@ meetPullVolStackBlurParmFinishMulti(meetPullVol **mpv, unsigned int mpvNum,
 ** at this point the only per-pullVolume information required for
 ** loading/creating the volumes, which isn't already in the
 ** meetPullVol, is the cachePath, so that is passed explicitly.
+** The scale-space stacks are kept in cachePath by
+** gageStackBlurCacheGet, so they are reused as long as the input
+** volume and blurring parameters are unchanged; the stacks least
+** recently used are removed to keep the cache within cacheSizeMax
+** megabytes (or, with cacheSizeMax 0, there is no limit).
 */
 int
 meetPullVolLoadMulti(meetPullVol **mpv, unsigned int mpvNum,
-                     char *cachePath, int verbose) {
+                     char *cachePath, double cacheSizeMax, int verbose) {
   static const char me[]="meetPullVolLoadMulti";
   unsigned int mpvIdx;
   airArray *mop;
@@ -518,17 +523,28 @@ meetPullVolLoadMulti(meetPullVol **mpv, unsigned int mpvNum,
       airMopError(mop); return 1;
     }
     if (vol->sbp) {
-      char formatSS[AIR_STRLEN_LARGE];
-      sprintf(formatSS, "%s/%s-%%03u-%03u.nrrd",
-              cachePath, vol->volName, vol->sbp->num);
+      unsigned int ssi;
+      vol->ninSS = AIR_CALLOC(vol->sbp->num, Nrrd *);
+      if (!vol->ninSS) {
+        biffAddf(MEET, "%s: couldn't allocate %u stack pointers",
+                 me, vol->sbp->num);
+        airMopError(mop); return 1;
+      }
+      airMopAdd(mop, &(vol->ninSS), (airMopper)airSetNull, airMopOnError);
+      airMopAdd(mop, vol->ninSS, airFree, airMopOnError);
+      for (ssi=0; ssi<vol->sbp->num; ssi++) {
+        vol->ninSS[ssi] = nrrdNew();
+        airMopAdd(mop, vol->ninSS[ssi], (airMopper)nrrdNuke, airMopOnError);
+      }
       if (verbose) {
-        fprintf(stderr, "%s: managing %s ... \n", me, formatSS);
+        fprintf(stderr, "%s: getting stack for %s from %s ... \n", me,
+                vol->volName, cachePath);
       }
-      if (gageStackBlurManage(&(vol->ninSS), &(vol->recomputedSS), vol->sbp,
-                              formatSS, AIR_TRUE, NULL,
-                              vol->nin, vol->kind)) {
+      if (gageStackBlurCacheGet(vol->ninSS, &(vol->recomputedSS), vol->sbp,
+                                cachePath, cacheSizeMax,
+                                vol->nin, vol->kind)) {
         biffMovef(MEET, GAGE, "%s: trouble getting volume stack (\"%s\")",
-                  me, formatSS);
+                  me, vol->volName);
         airMopError(mop); return 1;
       }
       if (verbose) {
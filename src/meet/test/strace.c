@@ -151,7 +151,6 @@ findAndTraceMorePoints(Nrrd *nplot,
                        unsigned int pointNum) {
   static const char me[]="findAndTraceMorePoints";
   unsigned int pointsSoFar, idtagBase, pidx, addedNum;
-  pullTrace *trace;
   pullPoint *point;
   Nrrd *nPosOut;
   airArray *mop;
@@ -199,28 +198,18 @@ findAndTraceMorePoints(Nrrd *nplot,
   }
   pos = AIR_CAST(double *, nPosOut->data);
   addedNum = nPosOut->axis[1].size;
-  printf("%s: tracing . . .       ", me);
-  for (pidx=0; pidx<addedNum; pidx++) {
-    double seedPos[4];
-    int added;
-    printf("%s", airDoneStr(0, pidx, addedNum, doneStr)); fflush(stdout);
-    trace = pullTraceNew();
-    ELL_4V_COPY(seedPos, pos + 4*pidx);
-    if (pullTraceSet(pctx, trace,
-                     AIR_TRUE /* recordStrength */,
-                     AIR_TRUE /* sigmaNorm */,
-                     scaleStep, scaleHalfLen,
-                     speedLimit, traceArrIncr,
-                     seedPos)
-        || pullTraceMultiAdd(mtrc, trace, &added)) {
-      biffAddf(PULL, "%s: trouble on point %u", me, pidx);
-      airMopError(mop); return 1;
-    }
-    if (!added) {
-      trace = pullTraceNix(trace);
-    }
+  printf("%s: tracing %u points . . . ", me, addedNum);
+  fflush(stdout);
+  if (pullTraceMultiSet(pctx, mtrc,
+                        AIR_TRUE /* recordStrength */,
+                        AIR_TRUE /* sigmaNorm */,
+                        scaleStep, scaleHalfLen,
+                        speedLimit, traceArrIncr,
+                        pos, addedNum)) {
+    biffAddf(PULL, "%s: trouble tracing", me);
+    airMopError(mop); return 1;
   }
-  printf("%s\n", airDoneStr(0, pidx, pointNum, doneStr));
+  printf("done\n");
 
   if (pullTraceMultiPlotAdd(nplot, mtrc, NULL,
                             strengthUse, 0, 0)) {
@@ -303,12 +292,12 @@ main(int argc, const char **argv) {
   pullTraceMulti *mtrc=NULL;
   int E=0, ret=0;
   unsigned int vspecNum, idefNum;
-  double scaleVec[3], glyphScaleRad;
+  double scaleVec[3], glyphScaleRad, cacheSizeMaxSS;
   /* things that used to be set directly inside pullContext */
   int nixAtVolumeEdgeSpace, constraintBeforeSeedThresh,
     binSingle, liveThresholdOnInit, permuteOnRebin,
     noAdd, unequalShapesAllow,
-    zeroZ, strnUse;
+    zeroZ, strnUse, tracesBinary;
   int verbose;
   int interType, allowCodimension3Constraints, scaleIsTau, useHalton;
   unsigned int samplesAlongScaleNum, pointNumInitial, pointPerVoxel,
@@ -413,6 +402,10 @@ main(int argc, const char **argv) {
   hestOptAdd(&hopt, "sscp", "path", airTypeString, 1, 1, &cachePathSS, "./",
              "path (without trailing /) for where to read/write "
              "pre-blurred volumes for scale-space");
+  hestOptAdd(&hopt, "sscm", "MB", airTypeDouble, 1, 1, &cacheSizeMaxSS,
+             "0", "size budget (in megabytes) for the pre-blurred volumes "
+             "kept in the \"-sscp\" path; the least recently used ones are "
+             "removed to stay within budget. 0 means no limit");
   kssOpi =
   hestOptAdd(&hopt, "kssb", "kernel", airTypeOther, 1, 1, &kSSblur,
              "ds:1,5", "default blurring kernel, to sample scale space",
@@ -452,6 +445,9 @@ main(int argc, const char **argv) {
              &tracesInS, "", "input file of pre-computed traces");
   hestOptAdd(&hopt, "to", "fname", airTypeString, 1, 1,
              &tracesOutS, "", "file for saving *computed* traces");
+  hestOptAdd(&hopt, "tob", NULL, airTypeInt, 0, 0, &tracesBinary, NULL,
+             "save computed traces in binary format, which is much "
+             "faster to write and read than the default text format");
 
   hestOptAdd(&hopt, "ppv", "# pnts/vox", airTypeUInt, 1, 1,
              &pointPerVoxel, "0",
@@ -639,7 +635,8 @@ main(int argc, const char **argv) {
   if (meetPullVolStackBlurParmFinishMulti(vspec, vspecNum,
                                           &kssFinished, &bspFinished,
                                           kSSblur, bspec)
-      || meetPullVolLoadMulti(vspec, vspecNum, cachePathSS, verbose)
+      || meetPullVolLoadMulti(vspec, vspecNum, cachePathSS,
+                              cacheSizeMaxSS, verbose)
       || meetPullVolAddMulti(pctx, vspec, vspecNum,
                              k00, k11, k22, kSSrecon)
       || meetPullInfoAddMulti(pctx, idef, idefNum)) {
@@ -742,11 +739,9 @@ main(int argc, const char **argv) {
   }
 
   {
-    double *pos, seedPos[4], scaleWin, scaleStep, dist=0;
-    unsigned int pidx, pnum, passIdx;
-    pullTrace *pts;
+    double *pos, scaleWin, scaleStep, dist=0;
+    unsigned int pnum, passIdx;
     Nrrd *nsplot, *nprogA, *nprogB, *nlsplot;
-    char doneStr[AIR_STRLEN_SMALL];
 
     pos = AIR_CAST(double *, nPosOut->data);
     nlsplot = nrrdNew();
@@ -767,28 +762,19 @@ main(int argc, const char **argv) {
     scaleStep = sstep*(ssrange[1]-ssrange[0]);
 
     pnum = nPosOut->axis[1].size;
-    printf("!%s: tracing initial %u points . . .       ", me, pnum);
-    for (pidx=0; pidx<pnum; pidx++) {
-      int added;
-      printf("%s", airDoneStr(0, pidx, pnum, doneStr)); fflush(stdout);
-      pts = pullTraceNew();
-      ELL_4V_COPY(seedPos, pos + 4*pidx);
-      if (pullTraceSet(pctx, pts,
-                       AIR_TRUE /* recordStrength */,
-                       AIR_TRUE /* sigmaNorm */,
-                       scaleStep, scaleWin/2,
-                       sslim, AIR_CAST(unsigned int, sslim/scaleStep),
-                       seedPos)
-          || pullTraceMultiAdd(mtrc, pts, &added)) {
-        airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
-        fprintf(stderr, "%s: trouble on point %u:\n%s", me, pidx, err);
-        airMopError(mop); return 1;
-      }
-      if (!added) {
-        pts = pullTraceNix(pts);
-      }
+    printf("!%s: tracing initial %u points . . . ", me, pnum);
+    fflush(stdout);
+    if (pullTraceMultiSet(pctx, mtrc,
+                          AIR_TRUE /* recordStrength */,
+                          AIR_TRUE /* sigmaNorm */,
+                          scaleStep, scaleWin/2,
+                          sslim, AIR_CAST(unsigned int, sslim/scaleStep),
+                          pos, pnum)) {
+      airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble tracing:\n%s", me, err);
+      airMopError(mop); return 1;
     }
-    printf("%s\n", airDoneStr(0, pidx, pnum, doneStr));
+    printf("done\n");
     if (!mtrc->traceNum) {
       fprintf(stderr, "%s: %u initial points led to zero traces\n", me, pnum);
       airMopError(mop); return 1;
@@ -836,7 +822,7 @@ main(int argc, const char **argv) {
     }
     if (airStrlen(tracesOutS) && !airStrlen(tracesInS)) {
       tracesFile = airFopen(tracesOutS, stdout, "wb");
-      if (pullTraceMultiWrite(tracesFile, mtrc)) {
+      if (pullTraceMultiWrite(tracesFile, mtrc, tracesBinary)) {
         airMopAdd(mop, err = biffGetDone(PULL), airFree, airMopAlways);
         fprintf(stderr, "%s: trouble writing:\n%s", me, err);
         airMopError(mop); return 1;
@@ -140,6 +140,252 @@ mossMatApply (double *ox, double *oy, double *mat, double ix, double iy) {
   *oy = mat[3]*ix + mat[4]*iy + mat[5];
 }
 
+/*
+** mossLinearTransform splits the output into contiguous bands of rows,
+** one per thread (nrrdStateNumThreads of them, run by nrrdThreadRun).
+** When inv[1] (or inv[3])
+** of the inverse transform is zero, the input x (or y) position depends
+** only on the output column (or row), so the kernel sample indices and
+** weights along that axis are computed once per column (or row), rather
+** than once per pixel.  When both are zero (scaling, flipping, and
+** translation), the transform is separable and is done in two passes:
+** every input row that is needed is resampled along x once, into a small
+** per-thread cache of rows, and these are then combined along y.  In all
+** cases the arithmetic happens in the same order as in mossSamplerSample,
+** so the output is the same as sampling every pixel with it.
+*/
+typedef struct {
+  Nrrd *nout;
+  const Nrrd *nin;
+  const mossSampler *msp;
+  float (*lup)(const void *v, size_t I);
+  float (*ins)(void *v, size_t I, float f);
+  float (*clamp)(float val);
+  double *inv, xMin, xMax, yMin, yMax;
+  int xSize, ySize, xCent, yCent, sx, sy, ncol, fdiam, pad;
+  int *xTIdx, *yTIdx;          /* if non-NULL, fdiam sample indices for
+                                  each output column (row) */
+  double *xTWght, *yTWght,     /* if non-NULL, fdiam weights for each
+                                  output column (row) */
+    *bgRow;                    /* with pad boundary: an input row of all
+                                  bg, resampled along x */
+} _mossXformShared;
+
+typedef struct {
+  const _mossXformShared *shr;
+  int yLo, yHi;                /* range of output rows for this job */
+  float *val,                  /* ncol output values */
+    *fRow;                     /* one input row, looked up to float */
+  int *xIdx, *yIdx;            /* fdiam indices for current pixel */
+  double *xWght, *yWght,       /* fdiam weights for current pixel */
+    *cache;                    /* fdiam+1 rows resampled along x */
+  const double **hRow;         /* fdiam rows resampled along x */
+  int *cacheRow,               /* input row in each cache slot, or -1 */
+    *cacheUsed;                /* last output row to use each slot */
+} _mossXformTask;
+
+/*
+** sets fdiam sample indices and weights for one axis, exactly as
+** mossSamplerSample does; with pad boundary, indices may be outside
+** [0, size-1]
+*/
+static void
+_mossXformAxis(int *idx, double *wght, const mossSampler *msp,
+               double pos, int size) {
+  int i, ii, frad;
+  double ff;
+
+  ii = (int)floor(pos); ff = pos - ii;
+  frad = msp->fdiam/2;
+  for (i=0; i<msp->fdiam; i++) {
+    idx[i] = ii + i - frad + 1;
+    wght[i] = ff - i + frad - 1;
+    if (nrrdBoundaryBleed == msp->boundary) {
+      idx[i] = AIR_CLAMP(0, idx[i], size-1);
+    } else if (nrrdBoundaryWrap == msp->boundary) {
+      idx[i] = AIR_MOD(idx[i], size);
+    }
+  }
+  msp->kernel->evalN_d(wght, wght, msp->fdiam, msp->kparm);
+  return;
+}
+
+static void
+_mossXformPixel(float *val, const _mossXformShared *shr,
+                const int *xIdx, const double *xWght,
+                const int *yIdx, const double *yWght) {
+  int ci, xi, yi;
+  double tmp;
+  float ss;
+
+  for (ci=0; ci<shr->ncol; ci++) {
+    val[ci] = 0;
+    for (yi=0; yi<shr->fdiam; yi++) {
+      tmp = 0;
+      for (xi=0; xi<shr->fdiam; xi++) {
+        if (shr->pad && !(AIR_IN_CL(0, xIdx[xi], shr->sx-1)
+                          && AIR_IN_CL(0, yIdx[yi], shr->sy-1))) {
+          ss = shr->msp->bg[ci];
+        } else {
+          ss = shr->lup(shr->nin->data,
+                        ci + shr->ncol*(xIdx[xi]
+                                        + AIR_CAST(size_t, shr->sx)*yIdx[yi]));
+        }
+        tmp += xWght[xi]*ss;
+      }
+      val[ci] += AIR_CAST(float, yWght[yi]*tmp);
+    }
+  }
+  return;
+}
+
+/*
+** resamples one input row frow (or if frow is NULL, a row of all bg)
+** along x, into hrow
+*/
+static void
+_mossXformRowSet(double *hrow, const float *frow,
+                 const _mossXformShared *shr) {
+  int ci, xi, xo, ncol, fdiam;
+  const int *idx;
+  const double *wght;
+  double tmp;
+
+  ncol = shr->ncol;
+  fdiam = shr->fdiam;
+  for (xo=0; xo<shr->xSize; xo++) {
+    idx = shr->xTIdx + fdiam*xo;
+    wght = shr->xTWght + fdiam*xo;
+    for (ci=0; ci<ncol; ci++) {
+      tmp = 0;
+      for (xi=0; xi<fdiam; xi++) {
+        tmp += wght[xi]*(!frow || (shr->pad
+                                   && !AIR_IN_CL(0, idx[xi], shr->sx-1))
+                         ? shr->msp->bg[ci]
+                         : frow[ci + ncol*idx[xi]]);
+      }
+      hrow[ci + ncol*xo] = tmp;
+    }
+  }
+  return;
+}
+
+/*
+** returns input row yy resampled along x, from the task's cache if
+** possible; otherwise the least recently used slot that output row yo
+** isn't already using is refilled
+*/
+static const double *
+_mossXformRowGet(_mossXformTask *task, int yy, int yo) {
+  const _mossXformShared *shr;
+  int si, sbest, xi, sxc;
+  size_t rowLen;
+  double *hrow;
+
+  shr = task->shr;
+  sbest = -1;
+  for (si=0; si<=shr->fdiam; si++) {
+    if (yy == task->cacheRow[si]) {
+      sbest = si;
+      break;
+    }
+    if (yo != task->cacheUsed[si]
+        && (-1 == sbest || task->cacheUsed[si] < task->cacheUsed[sbest])) {
+      sbest = si;
+    }
+  }
+  rowLen = AIR_CAST(size_t, shr->ncol)*shr->xSize;
+  hrow = task->cache + rowLen*sbest;
+  if (yy != task->cacheRow[sbest]) {
+    sxc = shr->sx*shr->ncol;
+    for (xi=0; xi<sxc; xi++) {
+      task->fRow[xi] = shr->lup(shr->nin->data,
+                                xi + AIR_CAST(size_t, sxc)*yy);
+    }
+    _mossXformRowSet(hrow, task->fRow, shr);
+    task->cacheRow[sbest] = yy;
+  }
+  task->cacheUsed[sbest] = yo;
+  return hrow;
+}
+
+static void
+_mossXformJob(void *_task0, unsigned int jobIdx, unsigned int threadIdx) {
+  _mossXformTask *task;
+  const _mossXformShared *shr;
+  const Nrrd *nin;
+  int xo, yo, ax0, ci, yi, ncol, fdiam;
+  const int *xIdx, *yIdx;
+  const double *xWght, *yWght;
+  double xInPos, xOutPos, yInPos, yOutPos;
+  size_t oIdx;
+  float acc;
+
+  AIR_UNUSED(threadIdx);
+  task = AIR_CAST(_mossXformTask *, _task0) + jobIdx;
+  shr = task->shr;
+  nin = shr->nin;
+  ax0 = MOSS_AXIS0(nin);
+  ncol = shr->ncol;
+  fdiam = shr->fdiam;
+  for (yo=task->yLo; yo<task->yHi; yo++) {
+    oIdx = AIR_CAST(size_t, ncol)*shr->xSize*yo;
+    if (shr->xTIdx && shr->yTIdx) {
+      /* separable */
+      yIdx = shr->yTIdx + fdiam*yo;
+      yWght = shr->yTWght + fdiam*yo;
+      for (yi=0; yi<fdiam; yi++) {
+        task->hRow[yi] = (shr->pad && !AIR_IN_CL(0, yIdx[yi], shr->sy-1)
+                          ? shr->bgRow
+                          : _mossXformRowGet(task, yIdx[yi], yo));
+      }
+      for (xo=0; xo<shr->xSize; xo++) {
+        for (ci=0; ci<ncol; ci++) {
+          acc = 0;
+          for (yi=0; yi<fdiam; yi++) {
+            acc += AIR_CAST(float, yWght[yi]*task->hRow[yi][ci + ncol*xo]);
+          }
+          shr->ins(shr->nout->data, oIdx + ci + ncol*xo, shr->clamp(acc));
+        }
+      }
+      continue;
+    }
+    yOutPos = NRRD_POS(shr->yCent, shr->yMin, shr->yMax, shr->ySize, yo);
+    for (xo=0; xo<shr->xSize; xo++) {
+      xOutPos = NRRD_POS(shr->xCent, shr->xMin, shr->xMax, shr->xSize, xo);
+      mossMatApply(&xInPos, &yInPos, shr->inv, xOutPos, yOutPos);
+      if (shr->xTIdx) {
+        xIdx = shr->xTIdx + fdiam*xo;
+        xWght = shr->xTWght + fdiam*xo;
+      } else {
+        xInPos = NRRD_IDX(shr->xCent, nin->axis[ax0+0].min,
+                          nin->axis[ax0+0].max, nin->axis[ax0+0].size,
+                          xInPos);
+        _mossXformAxis(task->xIdx, task->xWght, shr->msp, xInPos, shr->sx);
+        xIdx = task->xIdx;
+        xWght = task->xWght;
+      }
+      if (shr->yTIdx) {
+        yIdx = shr->yTIdx + fdiam*yo;
+        yWght = shr->yTWght + fdiam*yo;
+      } else {
+        yInPos = NRRD_IDX(shr->yCent, nin->axis[ax0+1].min,
+                          nin->axis[ax0+1].max, nin->axis[ax0+1].size,
+                          yInPos);
+        _mossXformAxis(task->yIdx, task->yWght, shr->msp, yInPos, shr->sy);
+        yIdx = task->yIdx;
+        yWght = task->yWght;
+      }
+      _mossXformPixel(task->val, shr, xIdx, xWght, yIdx, yWght);
+      for (ci=0; ci<ncol; ci++) {
+        shr->ins(shr->nout->data, oIdx + ci + ncol*xo,
+                 shr->clamp(task->val[ci]));
+      }
+    }
+  }
+  return;
+}
+
 int
 mossLinearTransform (Nrrd *nout, Nrrd *nin, float *bg,
                      double *mat, mossSampler *msp,
@@ -147,9 +393,12 @@ mossLinearTransform (Nrrd *nout, Nrrd *nin, float *bg,
                      double yMin, double yMax,
                      int xSize, int ySize) {
   static const char me[]="mossLinearTransform";
-  int ncol, xi, yi, ci, ax0, xCent, yCent;
-  float *val, (*ins)(void *v, size_t I, float f), (*clamp)(float val);
+  int ncol, xi, yi, ax0, fdiam, tidx, numThreads;
+  float *val;
   double inv[6], xInPos, xOutPos, yInPos, yOutPos;
+  _mossXformShared shr;
+  _mossXformTask *task;
+  airArray *mop;
 
   if (!(nout && nin && mat && msp && !mossImageCheck(nin))) {
     biffAddf(MOSS, "%s: got NULL pointer or bad image", me);
@@ -177,47 +426,151 @@ mossLinearTransform (Nrrd *nout, Nrrd *nin, float *bg,
   if (mossImageAlloc(nout, nin->type, xSize, ySize, ncol)) {
     biffAddf(MOSS, "%s: ", me); return 1;
   }
-  val = (float*)calloc(ncol, sizeof(float));
+  mop = airMopNew();
+  val = AIR_CALLOC(ncol, float);
+  airMopAdd(mop, val, airFree, airMopAlways);
   if (nrrdCenterUnknown == nout->axis[ax0+0].center)
     nout->axis[ax0+0].center = _mossCenter(nin->axis[ax0+0].center);
-  xCent = nout->axis[ax0+0].center;
+  shr.xCent = nout->axis[ax0+0].center;
   if (nrrdCenterUnknown == nout->axis[ax0+1].center)
     nout->axis[ax0+1].center = _mossCenter(nin->axis[ax0+1].center);
-  yCent = nout->axis[ax0+1].center;
+  shr.yCent = nout->axis[ax0+1].center;
   nout->axis[ax0+0].min = xMin;
   nout->axis[ax0+0].max = xMax;
   nout->axis[ax0+1].min = yMin;
   nout->axis[ax0+1].max = yMax;
-  ins = nrrdFInsert[nin->type];
-  clamp = nrrdFClamp[nin->type];
 
   if (mossSamplerSample(val, msp, 0, 0)) {
     biffAddf(MOSS, "%s: trouble in sampler", me);
-    free(val); return 1;
+    airMopError(mop); return 1;
   }
 
   mossMatInvert(inv, mat);
-  for (yi=0; yi<ySize; yi++) {
-    yOutPos = NRRD_POS(yCent, yMin, yMax, ySize, yi);
+  fdiam = msp->fdiam;
+  shr.nout = nout;
+  shr.nin = nin;
+  shr.msp = msp;
+  shr.lup = nrrdFLookup[nin->type];
+  shr.ins = nrrdFInsert[nin->type];
+  shr.clamp = nrrdFClamp[nin->type];
+  shr.inv = inv;
+  shr.xMin = xMin;
+  shr.xMax = xMax;
+  shr.yMin = yMin;
+  shr.yMax = yMax;
+  shr.xSize = xSize;
+  shr.ySize = ySize;
+  shr.sx = MOSS_SX(nin);
+  shr.sy = MOSS_SY(nin);
+  shr.ncol = ncol;
+  shr.fdiam = fdiam;
+  shr.pad = (nrrdBoundaryPad == msp->boundary);
+  shr.xTIdx = shr.yTIdx = NULL;
+  shr.xTWght = shr.yTWght = shr.bgRow = NULL;
+  /* with inv[1] == 0, the product with yOutPos in mossMatApply is zero,
+     so the table entries are exactly what would be computed per pixel */
+  if (0 == inv[1]) {
+    shr.xTIdx = AIR_CALLOC(fdiam*xSize, int);
+    airMopAdd(mop, shr.xTIdx, airFree, airMopAlways);
+    shr.xTWght = AIR_CALLOC(fdiam*xSize, double);
+    airMopAdd(mop, shr.xTWght, airFree, airMopAlways);
+    if (!(shr.xTIdx && shr.xTWght)) {
+      biffAddf(MOSS, "%s: couldn't allocate x tables", me);
+      airMopError(mop); return 1;
+    }
+    yOutPos = NRRD_POS(shr.yCent, yMin, yMax, ySize, 0);
     for (xi=0; xi<xSize; xi++) {
-      /*
-      mossVerbose = ( (36 == xi && 72 == yi) ||
-                      (37 == xi && 73 == yi) ||
-                      (105 == xi && 175 == yi) );
-      */
-      xOutPos = NRRD_POS(xCent, xMin, xMax, xSize, xi);
+      xOutPos = NRRD_POS(shr.xCent, xMin, xMax, xSize, xi);
       mossMatApply(&xInPos, &yInPos, inv, xOutPos, yOutPos);
-      xInPos = NRRD_IDX(xCent, nin->axis[ax0+0].min, nin->axis[ax0+0].max,
-                        nin->axis[ax0+0].size, xInPos);
-      yInPos = NRRD_IDX(yCent, nin->axis[ax0+1].min, nin->axis[ax0+1].max,
-                        nin->axis[ax0+1].size, yInPos);
-      mossSamplerSample(val, msp, xInPos, yInPos);
-      for (ci=0; ci<ncol; ci++) {
-        ins(nout->data, ci + ncol*(xi + xSize*yi), clamp(val[ci]));
+      xInPos = NRRD_IDX(shr.xCent, nin->axis[ax0+0].min,
+                        nin->axis[ax0+0].max, nin->axis[ax0+0].size, xInPos);
+      _mossXformAxis(shr.xTIdx + fdiam*xi, shr.xTWght + fdiam*xi,
+                     msp, xInPos, shr.sx);
+    }
+  }
+  if (0 == inv[3]) {
+    shr.yTIdx = AIR_CALLOC(fdiam*ySize, int);
+    airMopAdd(mop, shr.yTIdx, airFree, airMopAlways);
+    shr.yTWght = AIR_CALLOC(fdiam*ySize, double);
+    airMopAdd(mop, shr.yTWght, airFree, airMopAlways);
+    if (!(shr.yTIdx && shr.yTWght)) {
+      biffAddf(MOSS, "%s: couldn't allocate y tables", me);
+      airMopError(mop); return 1;
+    }
+    xOutPos = NRRD_POS(shr.xCent, xMin, xMax, xSize, 0);
+    for (yi=0; yi<ySize; yi++) {
+      yOutPos = NRRD_POS(shr.yCent, yMin, yMax, ySize, yi);
+      mossMatApply(&xInPos, &yInPos, inv, xOutPos, yOutPos);
+      yInPos = NRRD_IDX(shr.yCent, nin->axis[ax0+1].min,
+                        nin->axis[ax0+1].max, nin->axis[ax0+1].size, yInPos);
+      _mossXformAxis(shr.yTIdx + fdiam*yi, shr.yTWght + fdiam*yi,
+                     msp, yInPos, shr.sy);
+    }
+  }
+  if (shr.xTIdx && shr.yTIdx && shr.pad) {
+    shr.bgRow = AIR_CALLOC(ncol*xSize, double);
+    airMopAdd(mop, shr.bgRow, airFree, airMopAlways);
+    if (!shr.bgRow) {
+      biffAddf(MOSS, "%s: couldn't allocate background row", me);
+      airMopError(mop); return 1;
+    }
+    _mossXformRowSet(shr.bgRow, NULL, &shr);
+  }
+
+  /* one job per thread */
+  numThreads = AIR_INT(nrrdThreadNum(0, AIR_UINT(ySize)));
+  task = AIR_CALLOC(numThreads, _mossXformTask);
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (!task) {
+    biffAddf(MOSS, "%s: couldn't allocate %d tasks", me, numThreads);
+    airMopError(mop); return 1;
+  }
+  for (tidx=0; tidx<numThreads; tidx++) {
+    task[tidx].shr = &shr;
+    task[tidx].yLo = AIR_INT(AIR_CAST(double, ySize)*tidx/numThreads);
+    task[tidx].yHi = AIR_INT(AIR_CAST(double, ySize)*(tidx+1)/numThreads);
+    task[tidx].val = AIR_CALLOC(ncol, float);
+    airMopAdd(mop, task[tidx].val, airFree, airMopAlways);
+    task[tidx].xIdx = AIR_CALLOC(2*fdiam, int);
+    airMopAdd(mop, task[tidx].xIdx, airFree, airMopAlways);
+    task[tidx].xWght = AIR_CALLOC(2*fdiam, double);
+    airMopAdd(mop, task[tidx].xWght, airFree, airMopAlways);
+    if (!(task[tidx].val && task[tidx].xIdx && task[tidx].xWght)) {
+      biffAddf(MOSS, "%s: couldn't allocate buffers for thread %d",
+               me, tidx);
+      airMopError(mop); return 1;
+    }
+    task[tidx].yIdx = task[tidx].xIdx + fdiam;
+    task[tidx].yWght = task[tidx].xWght + fdiam;
+    if (shr.xTIdx && shr.yTIdx) {
+      task[tidx].fRow = AIR_CALLOC(ncol*shr.sx, float);
+      airMopAdd(mop, task[tidx].fRow, airFree, airMopAlways);
+      task[tidx].hRow = AIR_CALLOC(fdiam, const double *);
+      airMopAdd(mop, task[tidx].hRow, airFree, airMopAlways);
+      task[tidx].cache = AIR_CALLOC(AIR_CAST(size_t, fdiam+1)*ncol*xSize,
+                                    double);
+      airMopAdd(mop, task[tidx].cache, airFree, airMopAlways);
+      task[tidx].cacheRow = AIR_CALLOC(2*(fdiam+1), int);
+      airMopAdd(mop, task[tidx].cacheRow, airFree, airMopAlways);
+      if (!(task[tidx].fRow && task[tidx].hRow && task[tidx].cache
+            && task[tidx].cacheRow)) {
+        biffAddf(MOSS, "%s: couldn't allocate row cache for thread %d",
+                 me, tidx);
+        airMopError(mop); return 1;
+      }
+      task[tidx].cacheUsed = task[tidx].cacheRow + fdiam+1;
+      for (yi=0; yi<=fdiam; yi++) {
+        task[tidx].cacheRow[yi] = -1;
+        task[tidx].cacheUsed[yi] = -1;
       }
     }
   }
+  if (nrrdThreadRun(AIR_UINT(numThreads), AIR_UINT(numThreads),
+                    _mossXformJob, task)) {
+    biffMovef(MOSS, NRRD, "%s: trouble with %d threads", me, numThreads);
+    airMopError(mop); return 1;
+  }
 
-  free(val);
+  airMopOkay(mop);
   return 0;
 }
@@ -273,13 +273,152 @@ _nrrdApply1DSetUp(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
   return 0;
 }
 
+/* state shared by the threads of _nrrdApply1DLutOrRegMap */
+typedef struct {
+  const NrrdRange *range;
+  int ramps, rescale, multi;
+  const char *inData, *mapData;
+  char *outData;
+  double (*inLoad)(const void *v), (*mapLup)(const void *v, size_t I),
+    (*outInsert)(void *v, size_t I, double d),
+    domMin, domMax;
+  unsigned int mapLen, entLen, entSize, inSize, outSize;
+  size_t N;                 /* number of values to be mapped */
+  const char *tab;          /* if non-NULL: mapped output entry for
+                               every value of the integral input type,
+                               starting with tabMin */
+  int tabMin;
+} _nrrdApply1DShared;
+
+/* number of values mapped by one job */
+#define APPLY_CHUNK 65536
+
+/*
+** maps one value "val" through the map entries at mapData, to
+** the output entry at outData
+*/
+static void
+_nrrdApply1DValue(const _nrrdApply1DShared *as, char *outData,
+                  const char *mapData, double val) {
+  const char *entData0, *entData1;
+  double mapIdxFrac;
+  unsigned int i, mapIdx;
+
+  if (as->rescale) {
+    val = (as->range->min != as->range->max
+           ? AIR_AFFINE(as->range->min, val, as->range->max,
+                        as->domMin, as->domMax)
+           : as->domMin);
+  }
+  if (!AIR_EXISTS(val)) {
+    /* copy non-existent values from input to output */
+    for (i=0; i<as->entLen; i++) {
+      as->outInsert(outData, i, val);
+    }
+    return;
+  }
+  if (as->ramps) {
+    /* regular map */
+    val = AIR_CLAMP(as->domMin, val, as->domMax);
+    mapIdxFrac = AIR_AFFINE(as->domMin, val, as->domMax, 0, as->mapLen-1);
+    mapIdx = (unsigned int)mapIdxFrac;
+    mapIdx -= mapIdx == as->mapLen-1;
+    mapIdxFrac -= mapIdx;
+    entData0 = mapData + mapIdx*as->entSize;
+    entData1 = mapData + (mapIdx+1)*as->entSize;
+    for (i=0; i<as->entLen; i++) {
+      val = ((1-mapIdxFrac)*as->mapLup(entData0, i) +
+             mapIdxFrac*as->mapLup(entData1, i));
+      as->outInsert(outData, i, val);
+    }
+  } else {
+    /* lookup table */
+    mapIdx = airIndexClamp(as->domMin, val, as->domMax, as->mapLen);
+    entData0 = mapData + mapIdx*as->entSize;
+    for (i=0; i<as->entLen; i++) {
+      as->outInsert(outData, i, as->mapLup(entData0, i));
+    }
+  }
+  return;
+}
+
+static void
+_nrrdApply1DJob(void *_as, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdApply1DShared *as;
+  size_t I, lo, hi;
+  const char *inData, *mapData;
+  char *outData;
+
+  AIR_UNUSED(threadIdx);
+  as = AIR_CAST(_nrrdApply1DShared *, _as);
+  lo = AIR_CAST(size_t, jobIdx)*APPLY_CHUNK;
+  hi = AIR_MIN(as->N, lo + APPLY_CHUNK);
+  outData = as->outData + lo*as->outSize;
+  if (as->tab) {
+    /* copy whole output entries from table, with a constant size when
+       possible, so that the compiler can do each with wide stores */
+#define TAB_LOOP(TYPE, SIZE)                                            \
+    {                                                                   \
+      const TYPE *in = AIR_CAST(const TYPE *, as->inData) + lo;         \
+      for (I=lo; I<hi; I++, in++, outData += (SIZE)) {                  \
+        memcpy(outData, as->tab + (*in - as->tabMin)*(SIZE), (SIZE));   \
+      }                                                                 \
+    }
+#define TAB_SIZES(TYPE)                                                 \
+    switch (as->outSize) {                                              \
+    case 1: TAB_LOOP(TYPE, 1); break;                                   \
+    case 2: TAB_LOOP(TYPE, 2); break;                                   \
+    case 3: TAB_LOOP(TYPE, 3); break;                                   \
+    case 4: TAB_LOOP(TYPE, 4); break;                                   \
+    case 8: TAB_LOOP(TYPE, 8); break;                                   \
+    case 12: TAB_LOOP(TYPE, 12); break;                                 \
+    case 16: TAB_LOOP(TYPE, 16); break;                                 \
+    default: TAB_LOOP(TYPE, as->outSize); break;                        \
+    }
+    switch (as->inSize) {
+    case 1:
+      if (as->tabMin) {
+        TAB_SIZES(signed char);
+      } else {
+        TAB_SIZES(unsigned char);
+      }
+      break;
+    case 2:
+      if (as->tabMin) {
+        TAB_SIZES(signed short);
+      } else {
+        TAB_SIZES(unsigned short);
+      }
+      break;
+    }
+#undef TAB_SIZES
+#undef TAB_LOOP
+  } else {
+    inData = as->inData + lo*as->inSize;
+    mapData = as->mapData;
+    if (as->multi) {
+      mapData += lo*as->mapLen*as->entSize;
+    }
+    for (I=lo; I<hi; I++) {
+      _nrrdApply1DValue(as, outData, mapData, as->inLoad(inData));
+      inData += as->inSize;
+      outData += as->outSize;
+      if (as->multi) {
+        mapData += as->mapLen*as->entSize;
+      }
+    }
+  }
+  return;
+}
+
 /*
 ** _nrrdApply1DLutOrRegMap()
 **
 ** the guts of nrrdApply1DLut and nrrdApply1DRegMap
 **
-** yikes, does NOT use biff, since we're only supposed to be called
-** after copious error checking.
+** yikes, does NOT use biff for checking its arguments, since we're only
+** supposed to be called after copious error checking; the only error
+** (with biff) is failing to start or join threads.
 **
 ** FOR INSTANCE, this allows nout == nin, which could be a big
 ** problem if mapAxis == 1.
@@ -292,129 +431,93 @@ _nrrdApply1DSetUp(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
 ** are probaby undefined.  HEY: there is currently no warning message
 ** or error handling based on nrrdStateDisallowIntegerNonExist, but
 ** there really should be.
+**
+** With 8- and 16-bit integral input (and a non-multi map), every
+** possible input value is first mapped into a table of output entries,
+** which are then just copied to the output.  The mapping is done with
+** nrrdStateNumThreads threads.  In the unlikely event of not being
+** able to allocate the table, it is done without one.
 */
 int
 _nrrdApply1DLutOrRegMap(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
                         const Nrrd *nmap, int ramps, int rescale, int multi) {
-  /* static const char me[]="_nrrdApply1DLutOrRegMap"; */
-  char *inData, *outData, *mapData, *entData0, *entData1;
-  size_t N, I;
-  double (*inLoad)(const void *v), (*mapLup)(const void *v, size_t I),
-    (*outInsert)(void *v, size_t I, double d),
-    val, mapIdxFrac, domMin, domMax;
-  unsigned int i, mapAxis, mapLen, mapIdx, entSize, entLen, inSize, outSize;
+  static const char me[]="_nrrdApply1DLutOrRegMap";
+  _nrrdApply1DShared as;
+  unsigned int mapAxis, tabNum, ti, jobNum;
+  char *tab;
 
   if (!multi) {
     mapAxis = nmap->dim - 1;           /* axis of nmap containing entries */
   } else {
     mapAxis = nmap->dim - nin->dim - 1;
   }
-  mapData = (char *)nmap->data;        /* map data, as char* */
+  as.range = range;
+  as.ramps = ramps;
+  as.rescale = rescale;
+  as.multi = multi;
+  as.mapData = (char *)nmap->data;     /* map data, as char* */
                                        /* low end of map domain */
-  domMin = _nrrdApplyDomainMin(nmap, ramps, mapAxis);
+  as.domMin = _nrrdApplyDomainMin(nmap, ramps, mapAxis);
                                        /* high end of map domain */
-  domMax = _nrrdApplyDomainMax(nmap, ramps, mapAxis);
-  mapLen = AIR_CAST(unsigned int, nmap->axis[mapAxis].size);   /* number of entries in map */
-  mapLup = nrrdDLookup[nmap->type];    /* how to get doubles out of map */
-  inData = (char *)nin->data;          /* input data, as char* */
-  inLoad = nrrdDLoad[nin->type];       /* how to get doubles out of nin */
-  inSize = AIR_CAST(unsigned int, nrrdElementSize(nin));       /* size of one input value */
-  outData = (char *)nout->data;        /* output data, as char* */
-  outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
-  entLen = (mapAxis                    /* number of elements in one entry */
-            ? AIR_CAST(unsigned int, nmap->axis[0].size)
-            : 1);
-  outSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nout)); /* size of entry in output */
-  entSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nmap)); /* size of entry in map */
+  as.domMax = _nrrdApplyDomainMax(nmap, ramps, mapAxis);
+                                       /* number of entries in map */
+  as.mapLen = AIR_CAST(unsigned int, nmap->axis[mapAxis].size);
+  as.mapLup = nrrdDLookup[nmap->type]; /* how to get doubles out of map */
+  as.inData = (char *)nin->data;       /* input data, as char* */
+  as.inLoad = nrrdDLoad[nin->type];    /* how to get doubles out of nin */
+                                       /* size of one input value */
+  as.inSize = AIR_CAST(unsigned int, nrrdElementSize(nin));
+  as.outData = (char *)nout->data;     /* output data, as char* */
+  as.outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
+  as.entLen = (mapAxis                 /* number of elements in one entry */
+               ? AIR_CAST(unsigned int, nmap->axis[0].size)
+               : 1);
+                                       /* size of entry in output */
+  as.outSize = as.entLen*AIR_CAST(unsigned int, nrrdElementSize(nout));
+                                       /* size of entry in map */
+  as.entSize = as.entLen*AIR_CAST(unsigned int, nrrdElementSize(nmap));
+  as.N = nrrdElementNumber(nin);       /* the number of values to be mapped */
+  as.tab = NULL;
+  as.tabMin = 0;
 
-  N = nrrdElementNumber(nin);       /* the number of values to be mapped */
-  if (ramps) {
-    /* regular map */
-    for (I=0; I<N; I++) {
-      /* ...
-      if (!(I % 100)) fprintf(stderr, "I = %d\n", (int)I);
-      ... */
-      val = inLoad(inData);
-      /* ...
-      fprintf(stderr, "##%s: val = \na% 31.15f --> ", me, val);
-      ... */
-      if (rescale) {
-        val = (range->min != range->max
-               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
-               : domMin);
-        /* ...
-        fprintf(stderr, "\nb% 31.15f (min,max = %g,%g)--> ", val,
-                range->min, range->max);
-        ... */
-      }
-      /* ...
-      fprintf(stderr, "\nc% 31.15f --> clamp(%g,%g), %d --> ",
-              val, domMin, domMax, mapLen);
-      ... */
-      if (AIR_EXISTS(val)) {
-        val = AIR_CLAMP(domMin, val, domMax);
-        mapIdxFrac = AIR_AFFINE(domMin, val, domMax, 0, mapLen-1);
-        /* ...
-        fprintf(stderr, "mapIdxFrac = \nd% 31.15f --> ",
-                mapIdxFrac);
-        ... */
-        mapIdx = (unsigned int)mapIdxFrac;
-        mapIdx -= mapIdx == mapLen-1;
-        mapIdxFrac -= mapIdx;
-        /* ...
-        fprintf(stderr, "%s: (%d,\ne% 31.15f) --> \n",
-                me, mapIdx, mapIdxFrac);
-        ... */
-        entData0 = mapData + mapIdx*entSize;
-        entData1 = mapData + (mapIdx+1)*entSize;
-        for (i=0; i<entLen; i++) {
-          val = ((1-mapIdxFrac)*mapLup(entData0, i) +
-                 mapIdxFrac*mapLup(entData1, i));
-          outInsert(outData, i, val);
-          /* ...
-          fprintf(stderr, "f% 31.15f\n", val);
-          ... */
-        }
-      } else {
-        /* copy non-existent values from input to output */
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, val);
-        }
-      }
-      inData += inSize;
-      outData += outSize;
-      if (multi) {
-        mapData += mapLen*entSize;
-      }
-    }
-  } else {
-    /* lookup table */
-    for (I=0; I<N; I++) {
-      val = inLoad(inData);
-      if (rescale) {
-        val = (range->min != range->max
-               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
-               : domMin);
-      }
-      if (AIR_EXISTS(val)) {
-        mapIdx = airIndexClamp(domMin, val, domMax, mapLen);
-        entData0 = mapData + mapIdx*entSize;
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, mapLup(entData0, i));
-        }
-      } else {
-        /* copy non-existent values from input to output */
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, val);
-        }
-      }
-      inData += inSize;
-      outData += outSize;
-      if (multi) {
-        mapData += mapLen*entSize;
+  switch (nin->type) {
+  case nrrdTypeChar:
+    tabNum = 1 + SCHAR_MAX - SCHAR_MIN;
+    as.tabMin = SCHAR_MIN;
+    break;
+  case nrrdTypeUChar:
+    tabNum = 1 + UCHAR_MAX;
+    break;
+  case nrrdTypeShort:
+    tabNum = 1 + SHRT_MAX - SHRT_MIN;
+    as.tabMin = SHRT_MIN;
+    break;
+  case nrrdTypeUShort:
+    tabNum = 1 + USHRT_MAX;
+    break;
+  default:
+    tabNum = 0;
+    break;
+  }
+  tab = NULL;
+  if (!multi && tabNum && as.N >= tabNum) {
+    /* worth making table; if allocation fails, just go without */
+    tab = AIR_CALLOC(AIR_CAST(size_t, tabNum)*as.outSize, char);
+    if (tab) {
+      for (ti=0; ti<tabNum; ti++) {
+        _nrrdApply1DValue(&as, tab + AIR_CAST(size_t, ti)*as.outSize,
+                          as.mapData, as.tabMin + AIR_CAST(int, ti));
       }
+      as.tab = tab;
     }
   }
+  jobNum = AIR_CAST(unsigned int, (as.N + APPLY_CHUNK - 1)/APPLY_CHUNK);
+  if (nrrdThreadRun(0, jobNum, _nrrdApply1DJob, &as)) {
+    biffAddf(NRRD, "%s: trouble mapping", me);
+    airFree(tab);
+    return 1;
+  }
+  airFree(tab);
 
   return 0;
 }
@@ -258,6 +258,374 @@ _nrrdCCFind_N(Nrrd *nout, unsigned int *numid, airArray *eqvArr,
   return 1;
 }
 
+/*
+** Multi-threaded connected component labeling, used by nrrdCCFind
+** when nrrdStateNumThreads > 1, for 2-D and 3-D data.  The volume
+** (with 2-D images handled as sx-by-1-by-sy volumes) is cut into slabs
+** along its slowest axis, and these are labeled independently with
+** union-find over a "parent" array of linear sample indices, in which
+** a parent always precedes its children in raster order, so that the
+** root of each CC is its first sample in raster order.  The slabs are
+** then merged pairwise in a binary tree, level by level: merges that
+** run concurrently work within disjoint sets of slabs, so no locking
+** is needed.  Finally, the roots are numbered in raster order, which
+** gives the same CC ids as the single-threaded code.
+*/
+typedef struct {
+  const Nrrd *nin;            /* for nrrdCCAdjacency: CC ids */
+  const unsigned int *val;    /* input values */
+  unsigned int *par,          /* union-find parents */
+    *out,                     /* output CC ids; may be same as val */
+    size[3],                  /* sizes of volume, with slabs along [2] */
+    slabNum,
+    *slabZ,                   /* slab s is slices [slabZ[s], slabZ[s+1]) */
+    *rootNum,                 /* per slab: # roots, then first root id */
+    nbrNum,                   /* number of (previous) neighbors */
+    level,                    /* merging level */
+    adjNum;                   /* for nrrdCCAdjacency: number of ids */
+  int nbr[13][3];             /* neighbor offsets, all earlier in raster
+                                 order */
+  size_t nbrOff[13];          /* (negated) linear index offsets of nbr[] */
+  unsigned int yPad;          /* 1 if some nbr[] changes y, else 0 */
+  unsigned int (*lup)(const void *, size_t);  /* for nrrdCCAdjacency */
+  unsigned char *adj;         /* for nrrdCCAdjacency: output matrix */
+} _nrrdCCPar;
+
+static void
+_nrrdCCParNbrSet(_nrrdCCPar *ccp, unsigned int dim, unsigned int conny) {
+  static const int nbr3[13][3] = {{-1, 0, 0}, {0, -1, 0}, {0, 0, -1},
+                                  {-1, -1, 0}, {1, -1, 0}, {0, -1, -1},
+                                  {-1, 0, -1}, {1, 0, -1}, {0, 1, -1},
+                                  {-1, -1, -1}, {1, -1, -1},
+                                  {-1, 1, -1}, {1, 1, -1}},
+    nbr2[4][2] = {{-1, 0}, {0, -1}, {-1, -1}, {1, -1}};
+  static const unsigned int conny3[13] = {1, 1, 1, 2, 2, 2, 2, 2, 2,
+                                          3, 3, 3, 3},
+    conny2[4] = {1, 1, 2, 2};
+  unsigned int ni;
+
+  ccp->nbrNum = 0;
+  if (2 == dim) {
+    /* 2-D (x,y) neighbors are (x,0,y) neighbors in 3-D */
+    for (ni=0; ni<4; ni++) {
+      if (conny2[ni] <= conny) {
+        ccp->nbr[ccp->nbrNum][0] = nbr2[ni][0];
+        ccp->nbr[ccp->nbrNum][1] = 0;
+        ccp->nbr[ccp->nbrNum][2] = nbr2[ni][1];
+        ccp->nbrNum++;
+      }
+    }
+  } else {
+    for (ni=0; ni<13; ni++) {
+      if (conny3[ni] <= conny) {
+        ccp->nbr[ccp->nbrNum][0] = nbr3[ni][0];
+        ccp->nbr[ccp->nbrNum][1] = nbr3[ni][1];
+        ccp->nbr[ccp->nbrNum][2] = nbr3[ni][2];
+        ccp->nbrNum++;
+      }
+    }
+  }
+  return;
+}
+
+/*
+** _nrrdCCParNbr: linear index (in *nP) of neighbor ni of sample
+** (xi,yi,zi), if it is inside the volume and not before slice zmin
+*/
+static int
+_nrrdCCParNbr(size_t *nP, const _nrrdCCPar *ccp, unsigned int ni,
+              unsigned int xi, unsigned int yi, unsigned int zi,
+              unsigned int zmin) {
+  int xx, yy, zz;
+
+  xx = AIR_CAST(int, xi) + ccp->nbr[ni][0];
+  yy = AIR_CAST(int, yi) + ccp->nbr[ni][1];
+  zz = AIR_CAST(int, zi) + ccp->nbr[ni][2];
+  if (!( AIR_IN_CL(0, xx, AIR_CAST(int, ccp->size[0])-1)
+         && AIR_IN_CL(0, yy, AIR_CAST(int, ccp->size[1])-1)
+         && AIR_IN_CL(AIR_CAST(int, zmin), zz,
+                      AIR_CAST(int, ccp->size[2])-1) )) {
+    return AIR_FALSE;
+  }
+  *nP = xx + ccp->size[0]*(yy + ccp->size[1]*AIR_CAST(size_t, zz));
+  return AIR_TRUE;
+}
+
+static unsigned int
+_nrrdCCParFind(unsigned int *par, unsigned int ii) {
+
+  while (par[ii] != ii) {
+    /* path halving */
+    par[ii] = par[par[ii]];
+    ii = par[ii];
+  }
+  return ii;
+}
+
+static void
+_nrrdCCParUnion(unsigned int *par, unsigned int ii, unsigned int jj) {
+
+  ii = _nrrdCCParFind(par, ii);
+  jj = _nrrdCCParFind(par, jj);
+  if (ii < jj) {
+    par[jj] = ii;
+  } else if (jj < ii) {
+    par[ii] = jj;
+  }
+  return;
+}
+
+/* union-find within slab jobIdx */
+static void
+_nrrdCCParLabelJob(void *_ccp, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdCCPar *ccp;
+  unsigned int xi, yi, zi, ni, zmin, vv, *par, xlo, xhi;
+  size_t II, NI;
+  int inside;
+
+  AIR_UNUSED(threadIdx);
+  ccp = AIR_CAST(_nrrdCCPar *, _ccp);
+  par = ccp->par;
+  zmin = ccp->slabZ[jobIdx];
+  for (zi=zmin; zi<ccp->slabZ[jobIdx+1]; zi++) {
+    for (yi=0; yi<ccp->size[1]; yi++) {
+      II = ccp->size[0]*(yi + ccp->size[1]*AIR_CAST(size_t, zi));
+      /* all neighbors of the samples in [xlo, xhi) are in the slab */
+      inside = (zi > zmin
+                && yi >= ccp->yPad && yi + ccp->yPad < ccp->size[1]);
+      xlo = inside ? 1 : ccp->size[0];
+      xhi = inside ? ccp->size[0]-1 : ccp->size[0];
+      for (xi=0; xi<ccp->size[0]; xi++, II++) {
+        vv = ccp->val[II];
+        par[II] = AIR_CAST(unsigned int, II);
+        if (xlo <= xi && xi < xhi) {
+          for (ni=0; ni<ccp->nbrNum; ni++) {
+            NI = II - ccp->nbrOff[ni];
+            if (vv == ccp->val[NI]) {
+              _nrrdCCParUnion(par, AIR_CAST(unsigned int, II),
+                              AIR_CAST(unsigned int, NI));
+            }
+          }
+        } else {
+          for (ni=0; ni<ccp->nbrNum; ni++) {
+            if (_nrrdCCParNbr(&NI, ccp, ni, xi, yi, zi, zmin)
+                && vv == ccp->val[NI]) {
+              _nrrdCCParUnion(par, AIR_CAST(unsigned int, II),
+                              AIR_CAST(unsigned int, NI));
+            }
+          }
+        }
+      }
+    }
+  }
+  return;
+}
+
+/*
+** at merge level L, job jobIdx joins the group of 2^L slabs starting at
+** slab jobIdx*2^(L+1) to the group of 2^L slabs after it, by union-find
+** across the first slice of the second group
+*/
+static void
+_nrrdCCParMergeJob(void *_ccp, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdCCPar *ccp;
+  unsigned int xi, yi, zi, ni, vv, slab;
+  size_t II, NI;
+
+  AIR_UNUSED(threadIdx);
+  ccp = AIR_CAST(_nrrdCCPar *, _ccp);
+  slab = (2*jobIdx + 1) << ccp->level;
+  zi = ccp->slabZ[slab];
+  for (yi=0; yi<ccp->size[1]; yi++) {
+    II = ccp->size[0]*(yi + ccp->size[1]*AIR_CAST(size_t, zi));
+    for (xi=0; xi<ccp->size[0]; xi++, II++) {
+      vv = ccp->val[II];
+      for (ni=0; ni<ccp->nbrNum; ni++) {
+        if (-1 == ccp->nbr[ni][2]
+            && _nrrdCCParNbr(&NI, ccp, ni, xi, yi, zi, 0)
+            && vv == ccp->val[NI]) {
+          _nrrdCCParUnion(ccp->par, AIR_CAST(unsigned int, II),
+                          AIR_CAST(unsigned int, NI));
+        }
+      }
+    }
+  }
+  return;
+}
+
+static void
+_nrrdCCParCountJob(void *_ccp, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdCCPar *ccp;
+  size_t II, lo, hi;
+  unsigned int num;
+
+  AIR_UNUSED(threadIdx);
+  ccp = AIR_CAST(_nrrdCCPar *, _ccp);
+  lo = ccp->size[0]*ccp->size[1]*AIR_CAST(size_t, ccp->slabZ[jobIdx]);
+  hi = ccp->size[0]*ccp->size[1]*AIR_CAST(size_t, ccp->slabZ[jobIdx+1]);
+  num = 0;
+  for (II=lo; II<hi; II++) {
+    num += (ccp->par[II] == II);
+  }
+  ccp->rootNum[jobIdx] = num;
+  return;
+}
+
+static void
+_nrrdCCParRootJob(void *_ccp, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdCCPar *ccp;
+  size_t II, lo, hi;
+  unsigned int id;
+
+  AIR_UNUSED(threadIdx);
+  ccp = AIR_CAST(_nrrdCCPar *, _ccp);
+  lo = ccp->size[0]*ccp->size[1]*AIR_CAST(size_t, ccp->slabZ[jobIdx]);
+  hi = ccp->size[0]*ccp->size[1]*AIR_CAST(size_t, ccp->slabZ[jobIdx+1]);
+  id = ccp->rootNum[jobIdx];
+  for (II=lo; II<hi; II++) {
+    if (ccp->par[II] == II) {
+      ccp->out[II] = id++;
+    }
+  }
+  return;
+}
+
+static void
+_nrrdCCParIdJob(void *_ccp, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdCCPar *ccp;
+  size_t II, lo, hi;
+  unsigned int root, *par;
+
+  AIR_UNUSED(threadIdx);
+  ccp = AIR_CAST(_nrrdCCPar *, _ccp);
+  par = ccp->par;
+  lo = ccp->size[0]*ccp->size[1]*AIR_CAST(size_t, ccp->slabZ[jobIdx]);
+  hi = ccp->size[0]*ccp->size[1]*AIR_CAST(size_t, ccp->slabZ[jobIdx+1]);
+  for (II=lo; II<hi; II++) {
+    if (par[II] != II) {
+      /* no path compression: other threads are reading par[] */
+      root = par[II];
+      while (par[root] != root) {
+        root = par[root];
+      }
+      ccp->out[II] = ccp->out[root];
+    }
+  }
+  return;
+}
+
+/*
+** _nrrdCCParInit: sets up the slabs of ccp (with nin->dim 2 or 3),
+** allocating slabZ and rootNum, which are added to mop
+*/
+static int
+_nrrdCCParInit(_nrrdCCPar *ccp, const Nrrd *nin, unsigned int conny,
+               airArray *mop) {
+  static const char me[]="_nrrdCCParInit";
+  unsigned int numThreads, si;
+  size_t off;
+
+  ccp->size[0] = AIR_CAST(unsigned int, nin->axis[0].size);
+  if (2 == nin->dim) {
+    ccp->size[1] = 1;
+    ccp->size[2] = AIR_CAST(unsigned int, nin->axis[1].size);
+  } else {
+    ccp->size[1] = AIR_CAST(unsigned int, nin->axis[1].size);
+    ccp->size[2] = AIR_CAST(unsigned int, nin->axis[2].size);
+  }
+  _nrrdCCParNbrSet(ccp, nin->dim, conny);
+  ccp->yPad = 0;
+  for (si=0; si<ccp->nbrNum; si++) {
+    ccp->yPad |= !!ccp->nbr[si][1];
+    /* unsigned arithmetic wraps around correctly here */
+    off = (AIR_CAST(size_t, ccp->nbr[si][2])*ccp->size[1]
+           + AIR_CAST(size_t, ccp->nbr[si][1]));
+    off = off*ccp->size[0] + AIR_CAST(size_t, ccp->nbr[si][0]);
+    ccp->nbrOff[si] = 0 - off;
+  }
+  /* a few slabs per thread, for load balancing */
+  numThreads = nrrdThreadNum(0, ccp->size[2]);
+  ccp->slabNum = AIR_MIN(ccp->size[2], 4*numThreads);
+  ccp->slabZ = AIR_CALLOC(ccp->slabNum+1, unsigned int);
+  ccp->rootNum = AIR_CALLOC(ccp->slabNum, unsigned int);
+  airMopAdd(mop, ccp->slabZ, airFree, airMopAlways);
+  airMopAdd(mop, ccp->rootNum, airFree, airMopAlways);
+  if (!( ccp->slabZ && ccp->rootNum )) {
+    biffAddf(NRRD, "%s: couldn't allocate %u slabs", me, ccp->slabNum);
+    return 1;
+  }
+  for (si=0; si<=ccp->slabNum; si++) {
+    ccp->slabZ[si] = AIR_CAST(unsigned int,
+                              AIR_CAST(size_t, ccp->size[2])*si
+                              /ccp->slabNum);
+  }
+  return 0;
+}
+
+/*
+** _nrrdCCFindPar: the multi-threaded replacement for the first pass
+** and the equivalence resolution of nrrdCCFind; nfpid holds the
+** input values (as uints), which are replaced by the final CC ids.
+*/
+static int
+_nrrdCCFindPar(Nrrd *nfpid, unsigned int *numidP, const Nrrd *nin,
+               unsigned int conny) {
+  static const char me[]="_nrrdCCFindPar";
+  _nrrdCCPar ccp;
+  airArray *mop;
+  size_t NN;
+  unsigned int si, jobNum, num, sum;
+
+  mop = airMopNew();
+  memset(&ccp, 0, sizeof(ccp));
+  if (_nrrdCCParInit(&ccp, nin, conny, mop)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  NN = nrrdElementNumber(nfpid);
+  ccp.val = AIR_CAST(const unsigned int *, nfpid->data);
+  ccp.out = AIR_CAST(unsigned int *, nfpid->data);
+  ccp.par = AIR_CALLOC(NN, unsigned int);
+  if (!ccp.par) {
+    biffAddf(NRRD, "%s: couldn't allocate parent array", me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, ccp.par, airFree, airMopAlways);
+  if (nrrdThreadRun(0, ccp.slabNum, _nrrdCCParLabelJob, &ccp)) {
+    biffAddf(NRRD, "%s: trouble labeling slabs", me);
+    airMopError(mop); return 1;
+  }
+  for (ccp.level=0; (1u << ccp.level) < ccp.slabNum; ccp.level++) {
+    /* # of slabs (2*jobIdx + 1)*2^level less than slabNum */
+    jobNum = ((ccp.slabNum - 1) >> ccp.level);
+    jobNum = (jobNum + 1)/2;
+    if (nrrdThreadRun(0, jobNum, _nrrdCCParMergeJob, &ccp)) {
+      biffAddf(NRRD, "%s: trouble merging slabs (level %u)", me,
+               ccp.level);
+      airMopError(mop); return 1;
+    }
+  }
+  if (nrrdThreadRun(0, ccp.slabNum, _nrrdCCParCountJob, &ccp)) {
+    biffAddf(NRRD, "%s: trouble counting CCs", me);
+    airMopError(mop); return 1;
+  }
+  sum = 0;
+  for (si=0; si<ccp.slabNum; si++) {
+    num = ccp.rootNum[si];
+    ccp.rootNum[si] = sum;
+    sum += num;
+  }
+  /* the values in val (== out) are no longer needed */
+  if (nrrdThreadRun(0, ccp.slabNum, _nrrdCCParRootJob, &ccp)
+      || nrrdThreadRun(0, ccp.slabNum, _nrrdCCParIdJob, &ccp)) {
+    biffAddf(NRRD, "%s: trouble assigning CC ids", me);
+    airMopError(mop); return 1;
+  }
+  *numidP = sum;
+  airMopOkay(mop);
+  return 0;
+}
+
 /*
 ******** nrrdCCFind
 **
@@ -276,6 +644,9 @@ _nrrdCCFind_N(Nrrd *nout, unsigned int *numid, airArray *eqvArr,
 ** The caller can get a record of the values in each CC by passing a
 ** non-NULL nval, which will be allocated to an array of the same type
 ** as nin, so that nval->data[I] is the value in nin inside CC #I.
+**
+** With nrrdStateNumThreads > 1, 2-D and 3-D inputs are labeled with
+** multiple threads (see _nrrdCCFindPar), with identical results.
 */
 int
 nrrdCCFind(Nrrd *nout, Nrrd **nvalP, const Nrrd *nin, int type,
@@ -285,7 +656,7 @@ nrrdCCFind(Nrrd *nout, Nrrd **nvalP, const Nrrd *nin, int type,
   airArray *mop, *eqvArr;
   unsigned int *fpid, numid, numsettleid, *map,
     (*lup)(const void *, size_t), (*ins)(void *, size_t, unsigned int);
-  int ret;
+  int ret, parallel;
   size_t I, NN;
   void *val;
 
@@ -337,33 +708,47 @@ nrrdCCFind(Nrrd *nout, Nrrd **nvalP, const Nrrd *nin, int type,
   eqvArr = airArrayNew(NULL, NULL, 2*sizeof(unsigned int), _nrrdCC_EqvIncr);
   airMopAdd(mop, eqvArr, (airMopper)airArrayNuke, airMopAlways);
   ret = 0;
-  switch(nin->dim) {
-  case 1:
-    ret = _nrrdCCFind_1(nfpid, &numid, nin);
-    break;
-  case 2:
-    ret = _nrrdCCFind_2(nfpid, &numid, eqvArr, nin, conny);
-    break;
-  case 3:
-    ret = _nrrdCCFind_3(nfpid, &numid, eqvArr, nin, conny);
-    break;
-  default:
-    ret = _nrrdCCFind_N(nfpid, &numid, eqvArr, nin, conny);
-    break;
-  }
-  if (ret) {
-    biffAddf(NRRD, "%s: initial pass failed", me);
-    airMopError(mop); return 1;
+  NN = nrrdElementNumber(nfpid);
+  /* the parallel code uses uint sample indices */
+  parallel = ((2 == nin->dim || 3 == nin->dim)
+              && NN <= UINT_MAX
+              && nrrdThreadNum(0, AIR_CAST(unsigned int,
+                                           nin->axis[nin->dim-1].size)) > 1);
+  if (parallel) {
+    if (_nrrdCCFindPar(nfpid, &numsettleid, nin, conny)) {
+      biffAddf(NRRD, "%s: multi-threaded labeling failed", me);
+      airMopError(mop); return 1;
+    }
+  } else {
+    switch(nin->dim) {
+    case 1:
+      ret = _nrrdCCFind_1(nfpid, &numid, nin);
+      break;
+    case 2:
+      ret = _nrrdCCFind_2(nfpid, &numid, eqvArr, nin, conny);
+      break;
+    case 3:
+      ret = _nrrdCCFind_3(nfpid, &numid, eqvArr, nin, conny);
+      break;
+    default:
+      ret = _nrrdCCFind_N(nfpid, &numid, eqvArr, nin, conny);
+      break;
+    }
+    if (ret) {
+      biffAddf(NRRD, "%s: initial pass failed", me);
+      airMopError(mop); return 1;
+    }
   }
 
-  map = AIR_MALLOC(numid, unsigned int);
-  airMopAdd(mop, map, airFree, airMopAlways);
-  numsettleid = airEqvMap(eqvArr, map, numid);
-  /* convert fpid values to final id values */
   fpid = (unsigned int*)(nfpid->data);
-  NN = nrrdElementNumber(nfpid);
-  for (I=0; I<NN; I++) {
-    fpid[I] = map[fpid[I]];
+  if (!parallel) {
+    map = AIR_MALLOC(numid, unsigned int);
+    airMopAdd(mop, map, airFree, airMopAlways);
+    numsettleid = airEqvMap(eqvArr, map, numid);
+    /* convert fpid values to final id values */
+    for (I=0; I<NN; I++) {
+      fpid[I] = map[fpid[I]];
+    }
   }
   if (nvalP) {
     if (!(*nvalP)) {
@@ -535,12 +920,48 @@ _nrrdCCAdj_N(unsigned char *out, int numid, const Nrrd *nin,
   return 1;
 }
 
+/*
+** multi-threaded version of _nrrdCCAdj_2 and _nrrdCCAdj_3, with one job
+** per slab.  Jobs only ever store 1 into the adjacency matrix, so it's
+** harmless for two of them to set the same entry.
+*/
+static void
+_nrrdCCAdjParJob(void *_ccp, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdCCPar *ccp;
+  unsigned int xi, yi, zi, ni, id, nid, numid;
+  size_t II, NI;
+
+  AIR_UNUSED(threadIdx);
+  ccp = AIR_CAST(_nrrdCCPar *, _ccp);
+  numid = ccp->adjNum;
+  for (zi=ccp->slabZ[jobIdx]; zi<ccp->slabZ[jobIdx+1]; zi++) {
+    for (yi=0; yi<ccp->size[1]; yi++) {
+      II = ccp->size[0]*(yi + ccp->size[1]*AIR_CAST(size_t, zi));
+      for (xi=0; xi<ccp->size[0]; xi++, II++) {
+        id = ccp->lup(ccp->nin->data, II);
+        for (ni=0; ni<ccp->nbrNum; ni++) {
+          if (_nrrdCCParNbr(&NI, ccp, ni, xi, yi, zi, 0)) {
+            nid = ccp->lup(ccp->nin->data, NI);
+            if (id != nid) {
+              ccp->adj[id + numid*AIR_CAST(size_t, nid)] =
+                ccp->adj[nid + numid*AIR_CAST(size_t, id)] = 1;
+            }
+          }
+        }
+      }
+    }
+  }
+  return;
+}
+
 int
 nrrdCCAdjacency(Nrrd *nout, const Nrrd *nin, unsigned int conny) {
   static const char me[]="nrrdCCAdjacency", func[]="ccadj";
   int ret;
   unsigned int maxid;
   unsigned char *out;
+  _nrrdCCPar ccp;
+  airArray *mop;
 
   if (!( nout && nrrdCCValid(nin) )) {
     biffAddf(NRRD, "%s: invalid args", me);
@@ -564,19 +985,33 @@ nrrdCCAdjacency(Nrrd *nout, const Nrrd *nin, unsigned int conny) {
   }
   out = (unsigned char *)(nout->data);
 
-  switch(nin->dim) {
-  case 1:
-    ret = _nrrdCCAdj_1(out, maxid+1, nin);
-    break;
-  case 2:
-    ret = _nrrdCCAdj_2(out, maxid+1, nin, conny);
-    break;
-  case 3:
-    ret = _nrrdCCAdj_3(out, maxid+1, nin, conny);
-    break;
-  default:
-    ret = _nrrdCCAdj_N(out, maxid+1, nin, conny);
-    break;
+  if ((2 == nin->dim || 3 == nin->dim)
+      && nrrdThreadNum(0, AIR_CAST(unsigned int,
+                                   nin->axis[nin->dim-1].size)) > 1) {
+    mop = airMopNew();
+    memset(&ccp, 0, sizeof(ccp));
+    ccp.nin = nin;
+    ccp.lup = nrrdUILookup[nin->type];
+    ccp.adj = out;
+    ccp.adjNum = maxid+1;
+    ret = (_nrrdCCParInit(&ccp, nin, conny, mop)
+           || nrrdThreadRun(0, ccp.slabNum, _nrrdCCAdjParJob, &ccp));
+    airMopOkay(mop);
+  } else {
+    switch(nin->dim) {
+    case 1:
+      ret = _nrrdCCAdj_1(out, maxid+1, nin);
+      break;
+    case 2:
+      ret = _nrrdCCAdj_2(out, maxid+1, nin, conny);
+      break;
+    case 3:
+      ret = _nrrdCCAdj_3(out, maxid+1, nin, conny);
+      break;
+    default:
+      ret = _nrrdCCAdj_N(out, maxid+1, nin, conny);
+      break;
+    }
   }
   if (ret) {
     biffAddf(NRRD, "%s: trouble", me);
@@ -595,6 +1030,58 @@ nrrdCCAdjacency(Nrrd *nout, const Nrrd *nin, unsigned int conny) {
   return 0;
 }
 
+/* for multi-threading the loops in nrrdCCMerge */
+typedef struct {
+  const unsigned char *adj;
+  unsigned int numid, *nn, jobNum;
+  const unsigned int *map;
+  const Nrrd *nin;
+  Nrrd *nout;
+  size_t NN;
+} _nrrdCCMergePar;
+
+/* counts neighbors of a range of CCs */
+static void
+_nrrdCCMergeNNJob(void *_cmp, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdCCMergePar *cmp;
+  unsigned int i, j, lo, hi;
+
+  AIR_UNUSED(threadIdx);
+  cmp = AIR_CAST(_nrrdCCMergePar *, _cmp);
+  lo = AIR_CAST(unsigned int, AIR_CAST(size_t, cmp->numid)*jobIdx
+                /cmp->jobNum);
+  hi = AIR_CAST(unsigned int, AIR_CAST(size_t, cmp->numid)*(jobIdx+1)
+                /cmp->jobNum);
+  for (i=lo; i<hi; i++) {
+    cmp->nn[i] = 0;
+    for (j=0; j<cmp->numid; j++) {
+      cmp->nn[i] += cmp->adj[j + cmp->numid*AIR_CAST(size_t, i)];
+    }
+  }
+  return;
+}
+
+/* relabels a range of samples */
+static void
+_nrrdCCMergeMapJob(void *_cmp, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdCCMergePar *cmp;
+  unsigned int (*lup)(const void *, size_t),
+    (*ins)(void *, size_t, unsigned int);
+  size_t I, lo, hi;
+
+  AIR_UNUSED(threadIdx);
+  cmp = AIR_CAST(_nrrdCCMergePar *, _cmp);
+  lup = nrrdUILookup[cmp->nin->type];
+  ins = nrrdUIInsert[cmp->nout->type];
+  hi = (cmp->NN + cmp->jobNum - 1)/cmp->jobNum;
+  lo = AIR_MIN(cmp->NN, hi*jobIdx);
+  hi = AIR_MIN(cmp->NN, lo + hi);
+  for (I=lo; I<hi; I++) {
+    ins(cmp->nout->data, I, cmp->map[lup(cmp->nin->data, I)]);
+  }
+  return;
+}
+
 /*
 ******** nrrdCCMerge
 **
@@ -633,6 +1120,9 @@ nrrdCCAdjacency(Nrrd *nout, const Nrrd *nin, unsigned int conny) {
 ** Note: the output of this is not "settled"- the CC id values are not
 ** shiftward downwards to their lowest possible values, since this would
 ** needlessly invalidate the nval value store.
+**
+** With nrrdStateNumThreads > 1, the adjacency, neighbor counting, and
+** relabeling are multi-threaded; the merge decisions are not.
 */
 int
 nrrdCCMerge(Nrrd *nout, const Nrrd *nin, Nrrd *_nval,
@@ -648,7 +1138,8 @@ nrrdCCMerge(Nrrd *nout, const Nrrd *nin, Nrrd *_nval,
   unsigned char *adj;
   unsigned int *map, *id;
   airArray *mop;
-  size_t I, NN;
+  size_t I;
+  _nrrdCCMergePar cmp;
 
   mop = airMopNew();
   if (!( nout && nrrdCCValid(nin) )) {
@@ -684,11 +1175,13 @@ nrrdCCMerge(Nrrd *nout, const Nrrd *nin, Nrrd *_nval,
   adj = (unsigned char*)(nadj->data);
   nn = (unsigned int*)(nnn->data);
   numid = AIR_CAST(unsigned int, nsize->axis[0].size);
-  for (i=0; i<numid; i++) {
-    nn[i] = 0;
-    for (j=0; j<numid; j++) {
-      nn[i] += adj[j + numid*i];
-    }
+  cmp.adj = adj;
+  cmp.numid = numid;
+  cmp.nn = nn;
+  cmp.jobNum = AIR_MIN(numid, 16*nrrdThreadNum(0, numid));
+  if (nrrdThreadRun(0, cmp.jobNum, _nrrdCCMergeNNJob, &cmp)) {
+    biffAddf(NRRD, "%s: trouble counting neighbors", me);
+    airMopError(mop); return 1;
   }
   map = AIR_MALLOC(numid, unsigned int);
   id = AIR_MALLOC(numid, unsigned int);
@@ -752,11 +1245,22 @@ nrrdCCMerge(Nrrd *nout, const Nrrd *nin, Nrrd *_nval,
     map[i] = bigi;
     hit[bigi] = AIR_TRUE;
   }
-  lup = nrrdUILookup[nin->type];
-  ins = nrrdUIInsert[nout->type];
-  NN = nrrdElementNumber(nin);
-  for (I=0; I<NN; I++) {
-    ins(nout->data, I, map[lup(nin->data, I)]);
+  cmp.map = map;
+  cmp.nin = nin;
+  cmp.nout = nout;
+  cmp.NN = nrrdElementNumber(nin);
+  cmp.jobNum = AIR_CAST(unsigned int, AIR_MIN(cmp.NN, 1024));
+  if (nrrdThreadNum(0, cmp.jobNum) > 1) {
+    if (nrrdThreadRun(0, cmp.jobNum, _nrrdCCMergeMapJob, &cmp)) {
+      biffAddf(NRRD, "%s: trouble relabeling", me);
+      airMopError(mop); return 1;
+    }
+  } else {
+    lup = nrrdUILookup[nin->type];
+    ins = nrrdUIInsert[nout->type];
+    for (I=0; I<cmp.NN; I++) {
+      ins(nout->data, I, map[lup(nin->data, I)]);
+    }
   }
 
   valcnt = ((_nval && _nval->content)
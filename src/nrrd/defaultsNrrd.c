@@ -68,6 +68,7 @@ int nrrdStateMeasureType = nrrdTypeFloat;
 int nrrdStateMeasureModeBins = 1024;
 int nrrdStateMeasureHistoType = nrrdTypeFloat;
 int nrrdStateDisallowIntegerNonExist = AIR_TRUE;
+unsigned int nrrdStateNumThreads = 1;
 /* ---- END non-NrrdIO */
 int nrrdStateAlwaysSetContent = AIR_TRUE;
 int nrrdStateDisableContent = AIR_FALSE;
@@ -142,6 +143,8 @@ const char *const nrrdEnvVarStateMeasureHistoType
   = "NRRD_STATE_MEASURE_HISTO_TYPE";
 const char *const nrrdEnvVarStateGrayscaleImage3D
   = "NRRD_STATE_GRAYSCALE_IMAGE_3D";
+const char *const nrrdEnvVarStateNumThreads
+  = "NRRD_STATE_NUM_THREADS";
 
 /*
 **    return
@@ -346,6 +349,8 @@ nrrdStateGetenv(void) {
                  nrrdEnvVarStateMeasureHistoType);
   nrrdGetenvBool(/**/ &nrrdStateGrayscaleImage3D, NULL,
                  nrrdEnvVarStateGrayscaleImage3D);
+  nrrdGetenvUInt(/**/ &nrrdStateNumThreads, NULL,
+                 nrrdEnvVarStateNumThreads);
 
   return;
 }
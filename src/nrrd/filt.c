@@ -424,6 +424,458 @@ nrrdCheapMedian(Nrrd *_nout, const Nrrd *_nin,
   return 0;
 }
 
+/*
+** The exact median (or other quantile) filter of nrrdExactMedian is
+** the constant-time algorithm of Perreault and Hebert ("Median
+** Filtering in Constant Time", IEEE TIP 2007), generalized to 1-D and
+** 3-D.  Every sample is first replaced by its "level": an index into
+** the sorted list of values (or of histogram bins, when there are too
+** many different values).  Then for each output scanline, there is a
+** "column" histogram for every x position, counting the levels in the
+** window's cross-section (along y, or along y and z in 3-D).  The
+** histograms are two-tier: coarse bins of fineNum levels each, plus
+** the fine per-level counts.  The kernel histogram moves along x by
+** adding one column histogram and subtracting another, and is updated
+** (lazily, when the quantile search needs it) only in the one coarse
+** bin containing the quantile.  The column histograms move along y
+** with one update per sample in the window's (y) leading and trailing
+** faces.  Work is divided into jobs by z (in 3-D) and by strips of x.
+*/
+typedef struct {
+  unsigned int *colCrs,      /* size[0]-by-crsNum column coarse hists */
+    *colFine,                /* size[0]-by-crsNum*fineNum column hists */
+    *kerCrs,                 /* crsNum kernel coarse hist */
+    *kerFine;                /* crsNum*fineNum kernel fine hist */
+  int *stamp;                /* for each coarse bin, the x position at
+                                which the kernel fine hist is valid, or
+                                -1 if it is not valid */
+} _nrrdEMBuff;
+
+typedef struct {
+  const unsigned int *lev;   /* per-sample level */
+  const double *levVal;      /* output value for each level */
+  unsigned int levNum,       /* number of levels */
+    fineNum,                 /* levels per coarse bin (power of 2) */
+    fineShift,               /* log2(fineNum) */
+    crsNum,                  /* number of coarse bins */
+    size[3], rad[3],         /* volume size and window radii, with
+                                (for 1-D and 2-D) size 1 and radius 0
+                                on the missing axes */
+    rank,                    /* 0-based rank within window of output */
+    stripNum;                /* number of strips along x */
+  Nrrd *nout;
+  _nrrdEMBuff *buff;         /* per-thread buffers */
+} _nrrdEMShared;
+
+/* adds (incr = 1) or removes (incr = -1 as uint) the samples along z
+   in the window at (xi, yi), to/from the hist of column xi */
+static void
+_nrrdEMColumn(const _nrrdEMShared *shr, _nrrdEMBuff *bf, unsigned int incr,
+              unsigned int xi, unsigned int yi, unsigned int zi) {
+  unsigned int *crs, *fine, L, zz;
+  size_t II, sxy;
+
+  crs = bf->colCrs + shr->crsNum*AIR_CAST(size_t, xi);
+  fine = bf->colFine + shr->crsNum*shr->fineNum*AIR_CAST(size_t, xi);
+  sxy = AIR_CAST(size_t, shr->size[0])*shr->size[1];
+  II = xi + shr->size[0]*(yi + shr->size[1]*AIR_CAST(size_t,
+                                                       zi - shr->rad[2]));
+  for (zz=0; zz<2*shr->rad[2]+1; zz++, II += sxy) {
+    L = shr->lev[II];
+    crs[L >> shr->fineShift] += incr;
+    fine[L] += incr;
+  }
+  return;
+}
+
+/* brings kernel fine hist of coarse bin cc up-to-date at position xi */
+static void
+_nrrdEMFine(const _nrrdEMShared *shr, _nrrdEMBuff *bf, unsigned int cc,
+            unsigned int xi) {
+  unsigned int *kf, fi, fnum, rx, xx;
+  const unsigned int *cf, *cfs;
+  size_t cstride;
+
+  fnum = shr->fineNum;
+  rx = shr->rad[0];
+  kf = bf->kerFine + cc*fnum;
+  cstride = AIR_CAST(size_t, shr->crsNum)*fnum;
+  if (-1 == bf->stamp[cc]
+      || 2*(xi - AIR_CAST(unsigned int, bf->stamp[cc])) > 2*rx+1) {
+    /* re-build from the 2*rx+1 columns */
+    memset(kf, 0, fnum*sizeof(unsigned int));
+    cf = bf->colFine + cstride*(xi - rx) + cc*fnum;
+    for (xx=0; xx<2*rx+1; xx++, cf += cstride) {
+      for (fi=0; fi<fnum; fi++) {
+        kf[fi] += cf[fi];
+      }
+    }
+  } else {
+    /* slide from previous position */
+    for (xx=AIR_CAST(unsigned int, bf->stamp[cc])+1; xx<=xi; xx++) {
+      cf = bf->colFine + cstride*(xx + rx) + cc*fnum;
+      cfs = bf->colFine + cstride*(xx - rx - 1) + cc*fnum;
+      for (fi=0; fi<fnum; fi++) {
+        kf[fi] += cf[fi] - cfs[fi];
+      }
+    }
+  }
+  bf->stamp[cc] = AIR_CAST(int, xi);
+  return;
+}
+
+static void
+_nrrdEMJob(void *_shr, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdEMShared *shr;
+  _nrrdEMBuff *bf;
+  unsigned int xi, yi, zi, yy, x0, x1, cx0, cx1, xnum, cc, cnum, fi, sum,
+    rx, ry, *kc;
+  const unsigned int *add, *sub;
+  size_t cstride;
+  double (*ins)(void *, size_t, double);
+
+  shr = AIR_CAST(_nrrdEMShared *, _shr);
+  bf = shr->buff + threadIdx;
+  rx = shr->rad[0];
+  ry = shr->rad[1];
+  cnum = shr->crsNum;
+  kc = bf->kerCrs;
+  cstride = AIR_CAST(size_t, cnum)*shr->fineNum;
+  ins = nrrdDInsert[shr->nout->type];
+  zi = shr->rad[2] + jobIdx/shr->stripNum;
+  xnum = shr->size[0] - 2*rx;
+  x0 = rx + AIR_CAST(unsigned int, AIR_CAST(size_t, xnum)
+                     *(jobIdx % shr->stripNum)/shr->stripNum);
+  x1 = rx + AIR_CAST(unsigned int, AIR_CAST(size_t, xnum)
+                     *(jobIdx % shr->stripNum + 1)/shr->stripNum);
+  if (x0 == x1) {
+    return;
+  }
+  cx0 = x0 - rx;
+  cx1 = x1 + rx;
+  for (yi=ry; yi<shr->size[1]-ry; yi++) {
+    if (ry == yi) {
+      memset(bf->colCrs + cnum*cx0, 0,
+             cnum*(cx1 - cx0)*sizeof(unsigned int));
+      memset(bf->colFine + cstride*cx0, 0,
+             cstride*(cx1 - cx0)*sizeof(unsigned int));
+      for (xi=cx0; xi<cx1; xi++) {
+        for (yy=0; yy<2*ry+1; yy++) {
+          _nrrdEMColumn(shr, bf, 1, xi, yy, zi);
+        }
+      }
+    } else {
+      for (xi=cx0; xi<cx1; xi++) {
+        _nrrdEMColumn(shr, bf, AIR_CAST(unsigned int, -1),
+                      xi, yi - ry - 1, zi);
+        _nrrdEMColumn(shr, bf, 1, xi, yi + ry, zi);
+      }
+    }
+    memset(kc, 0, cnum*sizeof(unsigned int));
+    for (xi=cx0; xi<=x0+rx; xi++) {
+      add = bf->colCrs + cnum*xi;
+      for (cc=0; cc<cnum; cc++) {
+        kc[cc] += add[cc];
+      }
+    }
+    for (cc=0; cc<cnum; cc++) {
+      bf->stamp[cc] = -1;
+    }
+    for (xi=x0; xi<x1; xi++) {
+      if (xi > x0) {
+        add = bf->colCrs + cnum*(xi + rx);
+        sub = bf->colCrs + cnum*(xi - rx - 1);
+        for (cc=0; cc<cnum; cc++) {
+          kc[cc] += add[cc] - sub[cc];
+        }
+      }
+      /* find coarse bin, and then level, containing rank */
+      sum = 0;
+      for (cc=0; sum + kc[cc] <= shr->rank; cc++) {
+        sum += kc[cc];
+      }
+      _nrrdEMFine(shr, bf, cc, xi);
+      for (fi=cc*shr->fineNum; sum + bf->kerFine[fi] <= shr->rank; fi++) {
+        sum += bf->kerFine[fi];
+      }
+      ins(shr->nout->data,
+          xi + shr->size[0]*(yi + shr->size[1]*AIR_CAST(size_t, zi)),
+          shr->levVal[fi]);
+    }
+  }
+  return;
+}
+
+/*
+** _nrrdEMLevels: sets up levels: if nin has at most "bins" distinct
+** values, the levels are exactly those values; otherwise the levels
+** are bins-many histogram bins spanning the value range.  Allocates
+** *levP and *levValP, which are added to mop.
+*/
+static int
+_nrrdEMLevels(unsigned int **levP, double **levValP, unsigned int *levNumP,
+              const Nrrd *nin, unsigned int bins, airArray *mop) {
+  static const char me[]="_nrrdEMLevels";
+  double (*lup)(const void *, size_t), *sorted, val;
+  unsigned int *lev, levNum, lo, hi, mid;
+  NrrdRange *range;
+  size_t II, NN, uu;
+
+  NN = nrrdElementNumber(nin);
+  lup = nrrdDLookup[nin->type];
+  range = nrrdRangeNewSet(nin, nrrdBlind8BitRangeFalse);
+  airMopAdd(mop, range, (airMopper)nrrdRangeNix, airMopAlways);
+  if (range->hasNonExist) {
+    biffAddf(NRRD, "%s: can't handle non-existent values", me);
+    return 1;
+  }
+  lev = AIR_CALLOC(NN, unsigned int);
+  airMopAdd(mop, lev, airFree, airMopAlways);
+  if (!lev) {
+    biffAddf(NRRD, "%s: couldn't allocate levels", me);
+    return 1;
+  }
+  sorted = NULL;
+  if (nrrdTypeIsIntegral[nin->type]
+      && range->max - range->min + 1 <= bins) {
+    /* quick: every integer in the range gets a level */
+    levNum = AIR_CAST(unsigned int, range->max - range->min + 1);
+    sorted = AIR_CALLOC(levNum, double);
+    airMopAdd(mop, sorted, airFree, airMopAlways);
+    if (!sorted) {
+      biffAddf(NRRD, "%s: couldn't allocate %u levels", me, levNum);
+      return 1;
+    }
+    for (uu=0; uu<levNum; uu++) {
+      sorted[uu] = range->min + uu;
+    }
+    for (II=0; II<NN; II++) {
+      lev[II] = AIR_CAST(unsigned int, lup(nin->data, II) - range->min);
+    }
+  } else {
+    /* find the distinct values */
+    sorted = AIR_CALLOC(NN, double);
+    airMopAdd(mop, sorted, airFree, airMopAlways);
+    if (!sorted) {
+      biffAddf(NRRD, "%s: couldn't allocate sorting buffer", me);
+      return 1;
+    }
+    for (II=0; II<NN; II++) {
+      sorted[II] = lup(nin->data, II);
+    }
+    qsort(sorted, NN, sizeof(double), nrrdValCompare[nrrdTypeDouble]);
+    uu = 0;
+    for (II=1; II<NN && uu < bins; II++) {
+      if (sorted[II] != sorted[uu]) {
+        sorted[++uu] = sorted[II];
+      }
+    }
+    if (uu < bins) {
+      /* exact; find every sample's level by bisection */
+      levNum = AIR_CAST(unsigned int, uu+1);
+      for (II=0; II<NN; II++) {
+        val = lup(nin->data, II);
+        lo = 0;
+        hi = levNum-1;
+        while (lo < hi) {
+          mid = (lo + hi)/2;
+          if (sorted[mid] < val) {
+            lo = mid+1;
+          } else {
+            hi = mid;
+          }
+        }
+        lev[II] = lo;
+      }
+    } else {
+      /* too many values: quantize as in nrrdCheapMedian */
+      levNum = bins;
+      for (uu=0; uu<levNum; uu++) {
+        sorted[uu] = NRRD_NODE_POS(range->min, range->max, levNum, uu);
+      }
+      for (II=0; II<NN; II++) {
+        lev[II] = airIndex(range->min, lup(nin->data, II), range->max,
+                           levNum);
+      }
+    }
+  }
+  *levP = lev;
+  *levValP = sorted;
+  *levNumP = levNum;
+  return 0;
+}
+
+/*
+******** nrrdExactMedian
+**
+** median filtering (or, with quantile != 0.5, rank filtering) over a
+** (2*radius+1)^dim window of a 1-, 2-, or 3-D nrrd, with cost per
+** sample that doesn't grow with the radius (see comment above
+** _nrrdEMBuff).  As long as nin has at most "bins" distinct values
+** (e.g. 8- and 16-bit data, or quantized floats), the output is exact;
+** otherwise, values are quantized to "bins" histogram bins, as with
+** nrrdCheapMedian.  The output value is the one with 0-based rank
+** quantile*(N-1) (rounded) among the N values in the window.
+**
+** "pad" is as with nrrdCheapMedian: without it, samples within radius
+** of the boundary are copied from the input.  Uses nrrdStateNumThreads
+** threads.
+*/
+int
+nrrdExactMedian(Nrrd *_nout, const Nrrd *_nin, int pad,
+                unsigned int radius, double quantile, unsigned int bins) {
+  static const char me[]="nrrdExactMedian", func[]="emedian";
+  _nrrdEMShared shr;
+  Nrrd *nout, *nin;
+  airArray *mop;
+  unsigned int *lev, ai, tidx, numThreads, jobNum, winNum;
+  double *levVal;
+  size_t colNum;
+
+  if (!(_nin && _nout)) {
+    biffAddf(NRRD, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (_nout == _nin) {
+    biffAddf(NRRD, "%s: nout==nin disallowed", me);
+    return 1;
+  }
+  if (!(radius >= 1)) {
+    biffAddf(NRRD, "%s: need radius >= 1 (got %u)", me, radius);
+    return 1;
+  }
+  if (!(bins >= 1)) {
+    biffAddf(NRRD, "%s: need bins >= 1 (got %u)", me, bins);
+    return 1;
+  }
+  if (!(AIR_IN_CL(0.0, quantile, 1.0))) {
+    biffAddf(NRRD, "%s: quantile %g not in [0.0,1.0]", me, quantile);
+    return 1;
+  }
+  if (!(AIR_IN_CL(1, _nin->dim, 3))) {
+    biffAddf(NRRD, "%s: sorry, can only handle dim 1, 2, 3 (not %u)",
+             me, _nin->dim);
+    return 1;
+  }
+  if (nrrdTypeBlock == _nin->type) {
+    biffAddf(NRRD, "%s: can't filter nrrd type %s", me,
+             airEnumStr(nrrdType, nrrdTypeBlock));
+    return 1;
+  }
+  for (ai=0; ai<_nin->dim; ai++) {
+    if (!pad && _nin->axis[ai].size < 2*radius+1) {
+      biffAddf(NRRD, "%s: axis %u size (%u) smaller than filtering "
+               "window size (%u) with radius %u; must enable padding", me,
+               ai, AIR_CAST(unsigned int, _nin->axis[ai].size),
+               2*radius+1, radius);
+      return 1;
+    }
+  }
+
+  mop = airMopNew();
+  airMopAdd(mop, nin=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+  if (pad) {
+    airMopAdd(mop, nout=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
+    if (nrrdSimplePad_va(nin, _nin, radius, nrrdBoundaryBleed)) {
+      biffAddf(NRRD, "%s: trouble padding input", me);
+      airMopError(mop); return 1;
+    }
+  } else {
+    if (nrrdCopy(nin, _nin)) {
+      biffAddf(NRRD, "%s: trouble copying input", me);
+      airMopError(mop); return 1;
+    }
+    nout = _nout;
+  }
+  if (nrrdCopy(nout, nin)) {
+    biffAddf(NRRD, "%s: failed to create initial copy of input", me);
+    airMopError(mop); return 1;
+  }
+  if (nrrdElementNumber(nin) > UINT_MAX) {
+    /* because of the (uint) histogram counts */
+    biffAddf(NRRD, "%s: sorry, can't handle more than %u samples", me,
+             UINT_MAX);
+    airMopError(mop); return 1;
+  }
+  if (_nrrdEMLevels(&lev, &levVal, &shr.levNum, nin, bins, mop)) {
+    biffAddf(NRRD, "%s: trouble setting up levels", me);
+    airMopError(mop); return 1;
+  }
+  shr.lev = lev;
+  shr.levVal = levVal;
+  /* balance cost of coarse and fine hists */
+  for (shr.fineShift=0; (1u << 2*shr.fineShift) < shr.levNum;
+       shr.fineShift++)
+    ;
+  shr.fineNum = 1u << shr.fineShift;
+  shr.crsNum = (shr.levNum + shr.fineNum - 1) >> shr.fineShift;
+  winNum = 1;
+  for (ai=0; ai<3; ai++) {
+    shr.size[ai] = (ai < nin->dim
+                    ? AIR_CAST(unsigned int, nin->axis[ai].size)
+                    : 1);
+    shr.rad[ai] = ai < nin->dim ? radius : 0;
+    winNum *= 2*shr.rad[ai] + 1;
+  }
+  shr.rank = AIR_CAST(unsigned int, quantile*(winNum - 1) + 0.5);
+  shr.nout = nout;
+  /* strips along x only if z doesn't give enough jobs */
+  jobNum = shr.size[2] - 2*shr.rad[2];
+  numThreads = nrrdThreadNum(0, UINT_MAX);
+  shr.stripNum = (jobNum >= 2*numThreads
+                  ? 1
+                  : AIR_MIN(numThreads, shr.size[0] - 2*shr.rad[0]));
+  jobNum *= shr.stripNum;
+  numThreads = nrrdThreadNum(0, jobNum);
+  shr.buff = AIR_CALLOC(numThreads, _nrrdEMBuff);
+  airMopAdd(mop, shr.buff, airFree, airMopAlways);
+  if (!shr.buff) {
+    biffAddf(NRRD, "%s: couldn't allocate %u buffers", me, numThreads);
+    airMopError(mop); return 1;
+  }
+  colNum = AIR_CAST(size_t, shr.size[0])*shr.crsNum;
+  for (tidx=0; tidx<numThreads; tidx++) {
+    _nrrdEMBuff *bf;
+    bf = shr.buff + tidx;
+    bf->colCrs = AIR_CALLOC(colNum, unsigned int);
+    airMopAdd(mop, bf->colCrs, airFree, airMopAlways);
+    bf->colFine = AIR_CALLOC(colNum*shr.fineNum, unsigned int);
+    airMopAdd(mop, bf->colFine, airFree, airMopAlways);
+    bf->kerCrs = AIR_CALLOC(shr.crsNum, unsigned int);
+    airMopAdd(mop, bf->kerCrs, airFree, airMopAlways);
+    bf->kerFine = AIR_CALLOC(shr.crsNum*shr.fineNum, unsigned int);
+    airMopAdd(mop, bf->kerFine, airFree, airMopAlways);
+    bf->stamp = AIR_CALLOC(shr.crsNum, int);
+    airMopAdd(mop, bf->stamp, airFree, airMopAlways);
+    if (!( bf->colCrs && bf->colFine && bf->kerCrs
+           && bf->kerFine && bf->stamp )) {
+      biffAddf(NRRD, "%s: couldn't allocate histograms for thread %u",
+               me, tidx);
+      airMopError(mop); return 1;
+    }
+  }
+  if (nrrdThreadRun(numThreads, jobNum, _nrrdEMJob, &shr)) {
+    biffAddf(NRRD, "%s: trouble filtering", me);
+    airMopError(mop); return 1;
+  }
+
+  nrrdAxisInfoCopy(nout, nin, NULL, NRRD_AXIS_INFO_NONE);
+  if (nrrdContentSet_va(nout, func, nin, "%u,%g,%u",
+                        radius, quantile, bins)) {
+    biffAddf(NRRD, "%s:", me);
+    airMopError(mop); return 1;
+  }
+  if (pad) {
+    if (nrrdSimpleCrop(_nout, nout, radius)) {
+      biffAddf(NRRD, "%s: trouble cropping output", me);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
 /*
 ** returns intersection of parabolas c(x) = spc^2 (x - xi)^2 + yi
 */
@@ -503,26 +955,95 @@ distanceL2Sqrd1D(double *dd, const double *ff,
   return;
 }
 
+/* number of scanlines processed together in a distance transform pass */
+#define DIST_BATCH 32
+
+/* state shared between threads for one pass of distanceL2Sqrd */
+typedef struct {
+  const void *in;
+  void *out;
+  int type;                 /* nrrdTypeFloat or nrrdTypeDouble */
+  size_t valNum,            /* length of scanlines */
+    lineNum;                /* number of scanlines */
+  double spc;
+  double **blk,             /* per-thread DIST_BATCH*valNum lines */
+    **dd, **zz;             /* per-thread buffers for distanceL2Sqrd1D */
+  unsigned int **vv;
+} _distPass;
+
+/*
+** one job: DIST_BATCH consecutive scanlines, which are contiguous in
+** the input, and which are written (transposed) to the output so that
+** for each position along the scanline, the values from all the
+** scanlines in the batch are contiguous
+*/
+static void
+_distPassJob(void *_dp, unsigned int jobIdx, unsigned int threadIdx) {
+  _distPass *dp;
+  size_t line0, lineCnt, li, vi, valNum, lineNum;
+  double *blk, *dd, *ln;
+
+  dp = AIR_CAST(_distPass *, _dp);
+  valNum = dp->valNum;
+  lineNum = dp->lineNum;
+  line0 = AIR_CAST(size_t, jobIdx)*DIST_BATCH;
+  lineCnt = AIR_MIN(DIST_BATCH, lineNum - line0);
+  blk = dp->blk[threadIdx];
+  dd = dp->dd[threadIdx];
+  if (nrrdTypeFloat == dp->type) {
+    const float *in = AIR_CAST(const float *, dp->in) + valNum*line0;
+    for (vi=0; vi<valNum*lineCnt; vi++) {
+      blk[vi] = in[vi];
+    }
+  } else {
+    const double *in = AIR_CAST(const double *, dp->in) + valNum*line0;
+    memcpy(blk, in, valNum*lineCnt*sizeof(double));
+  }
+  for (li=0; li<lineCnt; li++) {
+    ln = blk + valNum*li;
+    distanceL2Sqrd1D(dd, ln, dp->zz[threadIdx], dp->vv[threadIdx],
+                     valNum, dp->spc);
+    memcpy(ln, dd, valNum*sizeof(double));
+  }
+  if (nrrdTypeFloat == dp->type) {
+    float *out = AIR_CAST(float *, dp->out) + line0;
+    for (vi=0; vi<valNum; vi++) {
+      for (li=0; li<lineCnt; li++) {
+        out[li + lineNum*vi] = AIR_CAST(float, blk[vi + valNum*li]);
+      }
+    }
+  } else {
+    double *out = AIR_CAST(double *, dp->out) + line0;
+    for (vi=0; vi<valNum; vi++) {
+      for (li=0; li<lineCnt; li++) {
+        out[li + lineNum*vi] = blk[vi + valNum*li];
+      }
+    }
+  }
+  return;
+}
+
+/*
+** the scanline passes are done with nrrdStateNumThreads threads
+*/
 static int
 distanceL2Sqrd(Nrrd *ndist, double *spcMean) {
   static const char me[]="distanceL2Sqrd";
   size_t sizeMax;           /* max size of all axes */
-  Nrrd *ntmpA, *ntmpB, *npass[NRRD_DIM_MAX+1];
+  Nrrd *ntmp, *npass[NRRD_DIM_MAX+1];
   int spcSomeExist, spcSomeNonExist;
-  unsigned int di, *vv;
-  double *dd, *ff, *zz;
+  unsigned int di, ti, jobNum, numThreads;
   double spc[NRRD_DIM_MAX], vector[NRRD_SPACE_DIM_MAX];
-  double (*lup)(const void *, size_t), (*ins)(void *, size_t, double);
+  _distPass dp;
   airArray *mop;
 
   if (!( nrrdTypeFloat == ndist->type || nrrdTypeDouble == ndist->type )) {
-    /* MWC: This error condition was/is being ignored. */
-    /*    biffAddf(NRRD, "%s: sorry, can only process type %s or %s (not %s)",
-                  me,
-                  airEnumStr(nrrdType, nrrdTypeFloat),
-                  airEnumStr(nrrdType, nrrdTypeDouble),
-                  airEnumStr(nrrdType, ndist->type));
-    */
+    biffAddf(NRRD, "%s: sorry, can only process type %s or %s (not %s)",
+             me,
+             airEnumStr(nrrdType, nrrdTypeFloat),
+             airEnumStr(nrrdType, nrrdTypeDouble),
+             airEnumStr(nrrdType, ndist->type));
+    return 1;
   }
 
   spcSomeExist = AIR_FALSE;
@@ -552,39 +1073,58 @@ distanceL2Sqrd(Nrrd *ndist, double *spcMean) {
     sizeMax = AIR_MAX(sizeMax, ndist->axis[di].size);
   }
 
-  /* create mop and allocate tmp buffers */
+  /* create mop and allocate tmp buffers; the passes alternate between
+     ndist and a single buffer nrrd */
   mop = airMopNew();
-  ntmpA = nrrdNew();
-  airMopAdd(mop, ntmpA, (airMopper)nrrdNuke, airMopAlways);
-  if (ndist->dim > 2) {
-    ntmpB = nrrdNew();
-    airMopAdd(mop, ntmpB, (airMopper)nrrdNuke, airMopAlways);
-  } else {
-    ntmpB = NULL;
+  ntmp = nrrdNew();
+  airMopAdd(mop, ntmp, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdCopy(ntmp, ndist)) {
+    biffAddf(NRRD, "%s: couldn't allocate image buffer", me);
+    airMopError(mop); return 1;
   }
-  if (nrrdCopy(ntmpA, ndist)
-      || (ndist->dim > 2 && nrrdCopy(ntmpB, ndist))) {
-    biffAddf(NRRD, "%s: couldn't allocate image buffers", me);
+  jobNum = 0;
+  for (di=0; di<ndist->dim; di++) {
+    size_t lineNum;
+    lineNum = nrrdElementNumber(ndist)/ndist->axis[di].size;
+    lineNum = (lineNum + DIST_BATCH - 1)/DIST_BATCH;
+    if (lineNum > UINT_MAX) {
+      biffAddf(NRRD, "%s: sorry, too many scanlines along axis %u", me, di);
+      airMopError(mop); return 1;
+    }
+    jobNum = AIR_MAX(jobNum, AIR_CAST(unsigned int, lineNum));
   }
-  dd = AIR_CAST(double *, calloc(sizeMax, sizeof(double)));
-  ff = AIR_CAST(double *, calloc(sizeMax, sizeof(double)));
-  zz = AIR_CAST(double *, calloc(sizeMax+1, sizeof(double)));
-  vv = AIR_CAST(unsigned int *, calloc(sizeMax, sizeof(unsigned int)));
-  airMopAdd(mop, dd, airFree, airMopAlways);
-  airMopAdd(mop, ff, airFree, airMopAlways);
-  airMopAdd(mop, zz, airFree, airMopAlways);
-  airMopAdd(mop, vv, airFree, airMopAlways);
-  if (!( dd && ff && zz && vv )) {
-    /* MWC: This error condition was/is being ignored. */
-    /* biffAddf(NRRD, "%s: couldn't allocate scanline buffers", me); */
+  numThreads = nrrdThreadNum(0, jobNum);
+  dp.blk = AIR_CALLOC(numThreads, double *);
+  dp.dd = AIR_CALLOC(numThreads, double *);
+  dp.zz = AIR_CALLOC(numThreads, double *);
+  dp.vv = AIR_CALLOC(numThreads, unsigned int *);
+  airMopAdd(mop, dp.blk, airFree, airMopAlways);
+  airMopAdd(mop, dp.dd, airFree, airMopAlways);
+  airMopAdd(mop, dp.zz, airFree, airMopAlways);
+  airMopAdd(mop, dp.vv, airFree, airMopAlways);
+  if (!( dp.blk && dp.dd && dp.zz && dp.vv )) {
+    biffAddf(NRRD, "%s: couldn't allocate buffer pointers", me);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<numThreads; ti++) {
+    dp.blk[ti] = AIR_CALLOC(DIST_BATCH*sizeMax, double);
+    dp.dd[ti] = AIR_CALLOC(sizeMax, double);
+    dp.zz[ti] = AIR_CALLOC(sizeMax+1, double);
+    dp.vv[ti] = AIR_CALLOC(sizeMax, unsigned int);
+    airMopAdd(mop, dp.blk[ti], airFree, airMopAlways);
+    airMopAdd(mop, dp.dd[ti], airFree, airMopAlways);
+    airMopAdd(mop, dp.zz[ti], airFree, airMopAlways);
+    airMopAdd(mop, dp.vv[ti], airFree, airMopAlways);
+    if (!( dp.blk[ti] && dp.dd[ti] && dp.zz[ti] && dp.vv[ti] )) {
+      biffAddf(NRRD, "%s: couldn't allocate scanline buffers", me);
+      airMopError(mop); return 1;
+    }
   }
 
   /* set up array of buffers */
-  npass[0] = ndist;
-  for (di=1; di<ndist->dim; di++) {
-    npass[di] = (di % 2) ? ntmpA : ntmpB;
+  for (di=0; di<=ndist->dim; di++) {
+    npass[di] = (di % 2) ? ntmp : ndist;
   }
-  npass[ndist->dim] = ndist;
 
   /* run the multiple passes */
   /* what makes the indexing here so simple is that by assuming that
@@ -597,26 +1137,23 @@ distanceL2Sqrd(Nrrd *ndist, double *spcMean) {
      buffers are really being mis-used, in that the axis sizes and
      raster ordering of what we're storing there is *not* the same as
      told by axis[].size */
-  lup = nrrdDLookup[ndist->type];
-  ins = nrrdDInsert[ndist->type];
+  dp.type = ndist->type;
   for (di=0; di<ndist->dim; di++) {
-    size_t lineIdx, lineNum, valIdx, valNum;
-
-    valNum = ndist->axis[di].size;
-    lineNum = nrrdElementNumber(ndist)/valNum;
-    for (lineIdx=0; lineIdx<lineNum; lineIdx++) {
-      /* read input scanline into ff */
-      for (valIdx=0; valIdx<valNum; valIdx++) {
-        ff[valIdx] = lup(npass[di]->data, valIdx + valNum*lineIdx);
-      }
-      /* do the transform */
-      distanceL2Sqrd1D(dd, ff, zz, vv, valNum, spc[di]);
-      /* write dd to output scanline */
-      for (valIdx=0; valIdx<valNum; valIdx++) {
-        ins(npass[di+1]->data, lineIdx + lineNum*valIdx, dd[valIdx]);
-      }
+    dp.in = npass[di]->data;
+    dp.out = npass[di+1]->data;
+    dp.valNum = ndist->axis[di].size;
+    dp.lineNum = nrrdElementNumber(ndist)/dp.valNum;
+    dp.spc = spc[di];
+    jobNum = AIR_CAST(unsigned int, (dp.lineNum + DIST_BATCH - 1)/DIST_BATCH);
+    if (nrrdThreadRun(numThreads, jobNum, _distPassJob, &dp)) {
+      biffAddf(NRRD, "%s: trouble with pass %u", me, di);
+      airMopError(mop); return 1;
     }
   }
+  if (npass[ndist->dim] != ndist) {
+    memcpy(ndist->data, npass[ndist->dim]->data,
+           nrrdElementNumber(ndist)*nrrdElementSize(ndist));
+  }
 
   airMopOkay(mop);
   return 0;
@@ -710,6 +1247,10 @@ _distanceBase(Nrrd *nout, const Nrrd *nin,
 ** signed distance map, the transition from interior to exterior
 ** distance values is smooth.  Without this trick, there is a
 ** small little plateau at the transition.
+**
+** All the work happens in an array of type typeOut, so with
+** nrrdTypeFloat, no double-precision copy of the volume is made.
+** The per-axis scanline passes use nrrdStateNumThreads threads.
 */
 int
 nrrdDistanceL2(Nrrd *nout, const Nrrd *nin,
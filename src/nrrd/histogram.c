@@ -24,6 +24,314 @@
 #include "nrrd.h"
 #include "privateNrrd.h"
 
+/*
+** The histogramming functions below share the following machinery
+** for computing bin indices and for multi-threading.  A "binner"
+** knows how one input nrrd's values map to bin indices; with 8- and
+** 16-bit integral types, it does so with a look-up table computed
+** (with the same floating-point logic) from all possible values.
+*/
+
+/* bin index signifying that a sample doesn't go in the histogram */
+#define HISTO_SKIP ((size_t)(-1))
+/* number of samples for which bin indices are computed at once */
+#define HISTO_BLOCK 1024
+
+typedef struct {
+  const Nrrd *nin;
+  double min, max, eps;
+  size_t bins;
+  int joint,            /* non-zero: nrrdHistoJoint semantics */
+    clamp;              /* for joint: clamp values outside range */
+  size_t *lut;          /* NULL, or bin index for each possible value,
+                           offset by -lutMin */
+  int lutMin;
+} _nrrdHistoBinner;
+
+static size_t
+_nrrdHistoBinIndex(const _nrrdHistoBinner *hb, double val) {
+
+  if (!AIR_EXISTS(val)) {
+    return HISTO_SKIP;
+  }
+  if (hb->joint) {
+    if (!AIR_IN_CL(hb->min, val, hb->max)) {
+      if (hb->clamp) {
+        val = AIR_CLAMP(hb->min, val, hb->max);
+      } else {
+        return HISTO_SKIP;
+      }
+    }
+    return AIR_CAST(size_t, airIndexClampULL(hb->min, val, hb->max,
+                                             hb->bins));
+  }
+  if (val < hb->min || val > hb->max + hb->eps
+      || !AIR_IN_CL(hb->min, val, hb->max)) {
+    return HISTO_SKIP;
+  }
+  return airIndex(hb->min, val, hb->max + hb->eps,
+                  AIR_CAST(unsigned int, hb->bins));
+}
+
+/*
+** _nrrdHistoBinnerInit: after min, max, eps, bins, joint, and clamp
+** are set, sets up the look-up table, if possible.  The table is
+** added to the mop.
+*/
+static int
+_nrrdHistoBinnerInit(_nrrdHistoBinner *hb, const Nrrd *nin, airArray *mop) {
+  static const char me[]="_nrrdHistoBinnerInit";
+  int lutNum, vi;
+
+  hb->nin = nin;
+  hb->lut = NULL;
+  switch (nin->type) {
+  case nrrdTypeChar:
+    hb->lutMin = SCHAR_MIN;
+    lutNum = 1 + SCHAR_MAX - SCHAR_MIN;
+    break;
+  case nrrdTypeUChar:
+    hb->lutMin = 0;
+    lutNum = 1 + UCHAR_MAX;
+    break;
+  case nrrdTypeShort:
+    hb->lutMin = SHRT_MIN;
+    lutNum = 1 + SHRT_MAX - SHRT_MIN;
+    break;
+  case nrrdTypeUShort:
+    hb->lutMin = 0;
+    lutNum = 1 + USHRT_MAX;
+    break;
+  default:
+    lutNum = 0;
+    break;
+  }
+  if (lutNum) {
+    hb->lut = AIR_CALLOC(lutNum, size_t);
+    if (!hb->lut) {
+      biffAddf(NRRD, "%s: couldn't allocate %d-entry look-up table",
+               me, lutNum);
+      return 1;
+    }
+    airMopAdd(mop, hb->lut, airFree, airMopAlways);
+    for (vi=0; vi<lutNum; vi++) {
+      hb->lut[vi] = _nrrdHistoBinIndex(hb, hb->lutMin + vi);
+    }
+  }
+  return 0;
+}
+
+/* bin indices of samples [I0, I0+num) */
+static void
+_nrrdHistoBinBlock(size_t *idx, const _nrrdHistoBinner *hb,
+                   size_t I0, size_t num) {
+  double (*lup)(const void *, size_t);
+  const void *data;
+  size_t ii;
+
+  data = hb->nin->data;
+#define LUT_LOOP(TYPE)                                      \
+  {                                                         \
+    const TYPE *tdata = AIR_CAST(const TYPE *, data) + I0;  \
+    for (ii=0; ii<num; ii++) {                              \
+      idx[ii] = hb->lut[tdata[ii] - hb->lutMin];            \
+    }                                                       \
+  }
+  if (hb->lut) {
+    switch (hb->nin->type) {
+    case nrrdTypeChar: LUT_LOOP(signed char); break;
+    case nrrdTypeUChar: LUT_LOOP(unsigned char); break;
+    case nrrdTypeShort: LUT_LOOP(signed short); break;
+    case nrrdTypeUShort: LUT_LOOP(unsigned short); break;
+    }
+  } else {
+    lup = nrrdDLookup[hb->nin->type];
+    for (ii=0; ii<num; ii++) {
+      idx[ii] = _nrrdHistoBinIndex(hb, lup(data, I0 + ii));
+    }
+  }
+#undef LUT_LOOP
+  return;
+}
+
+/*
+** state shared by threads making a (joint) histogram: the samples are
+** divided into one contiguous range per job.  With one job, the counts
+** go straight into nout, clamped at every increment, as they always
+** have been.  With more, each job accumulates into its own histogram of
+** doubles; these are summed (in job order) and clamped at the end,
+** which is only done when that gives the same result (see
+** _nrrdHistoRun).
+*/
+typedef struct {
+  const _nrrdHistoBinner *hb;
+  unsigned int hbNum;       /* number of binners (input nrrds) */
+  const Nrrd *nwght;
+  Nrrd *nout;
+  size_t num,               /* number of samples */
+    histLen,                /* total number of bins */
+    stride[NRRD_DIM_MAX];   /* stride in histogram of each binner */
+  unsigned int jobNum;
+  double **hist;            /* per-job histograms, or NULL if one job */
+} _nrrdHistoShared;
+
+static void
+_nrrdHistoJob(void *_hs, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdHistoShared *hs;
+  size_t lo, hi, I0, bnum, ii, idx[HISTO_BLOCK], tmp[HISTO_BLOCK];
+  double *hist, incr, (*lup)(const void *, size_t),
+    (*olup)(const void *, size_t), (*clmp)(double),
+    (*ins)(void *, size_t, double);
+  unsigned int hbi;
+
+  AIR_UNUSED(threadIdx);
+  hs = AIR_CAST(_nrrdHistoShared *, _hs);
+  hist = hs->hist ? hs->hist[jobIdx] : NULL;
+  lup = hs->nwght ? nrrdDLookup[hs->nwght->type] : NULL;
+  olup = nrrdDLookup[hs->nout->type];
+  clmp = nrrdDClamp[hs->nout->type];
+  ins = nrrdDInsert[hs->nout->type];
+  lo = hs->num/hs->jobNum*jobIdx + AIR_MIN(jobIdx, hs->num % hs->jobNum);
+  hi = lo + hs->num/hs->jobNum + (jobIdx < hs->num % hs->jobNum);
+  for (I0=lo; I0<hi; I0 += HISTO_BLOCK) {
+    bnum = AIR_MIN(HISTO_BLOCK, hi - I0);
+    _nrrdHistoBinBlock(idx, hs->hb + 0, I0, bnum);
+    for (hbi=1; hbi<hs->hbNum; hbi++) {
+      _nrrdHistoBinBlock(tmp, hs->hb + hbi, I0, bnum);
+      for (ii=0; ii<bnum; ii++) {
+        idx[ii] = (HISTO_SKIP == idx[ii] || HISTO_SKIP == tmp[ii]
+                   ? HISTO_SKIP
+                   : idx[ii] + hs->stride[hbi]*tmp[ii]);
+      }
+    }
+    if (!hist) {
+      for (ii=0; ii<bnum; ii++) {
+        if (HISTO_SKIP != idx[ii]) {
+          incr = lup ? lup(hs->nwght->data, I0 + ii) : 1;
+          ins(hs->nout->data, idx[ii],
+              clmp(olup(hs->nout->data, idx[ii]) + incr));
+        }
+      }
+    } else if (lup) {
+      for (ii=0; ii<bnum; ii++) {
+        if (HISTO_SKIP != idx[ii]) {
+          hist[idx[ii]] += lup(hs->nwght->data, I0 + ii);
+        }
+      }
+    } else {
+      for (ii=0; ii<bnum; ii++) {
+        if (HISTO_SKIP != idx[ii]) {
+          hist[idx[ii]] += 1;
+        }
+      }
+    }
+  }
+  return;
+}
+
+/*
+** _nrrdHistoRun: fills (already allocated and zeroed) nout with the
+** histogram described by hs (with hb, hbNum, nwght, num, and stride
+** set).  Several threads are used only if clamping the summed totals
+** gives the same as clamping after every increment: the increments
+** are non-negative integers (unweighted, or with unsigned integral
+** weights), which a double holds exactly, and nout is integral (or
+** double) so that storing the running count doesn't round it.
+*/
+static int
+_nrrdHistoRun(Nrrd *nout, _nrrdHistoShared *hs, airArray *mop) {
+  static const char me[]="_nrrdHistoRun";
+  unsigned int ji;
+  size_t hi;
+  int threadable;
+  double sum, (*clmp)(double), (*ins)(void *, size_t, double);
+
+  hs->nout = nout;
+  hs->histLen = nrrdElementNumber(nout);
+  threadable = ((!hs->nwght
+                 || (nrrdTypeIsIntegral[hs->nwght->type]
+                     && nrrdTypeIsUnsigned[hs->nwght->type]))
+                && (nrrdTypeIsIntegral[nout->type]
+                    || nrrdTypeDouble == nout->type));
+  hs->jobNum = (threadable
+                ? nrrdThreadNum(0, AIR_CAST(unsigned int,
+                                            AIR_MIN(UINT_MAX,
+                                                    hs->num/4096)))
+                : 1);
+  if (1 == hs->jobNum) {
+    hs->hist = NULL;
+    _nrrdHistoJob(hs, 0, 0);
+    return 0;
+  }
+  hs->hist = AIR_CALLOC(hs->jobNum, double *);
+  if (!hs->hist) {
+    biffAddf(NRRD, "%s: couldn't allocate histogram pointers", me);
+    return 1;
+  }
+  airMopAdd(mop, hs->hist, airFree, airMopAlways);
+  for (ji=0; ji<hs->jobNum; ji++) {
+    hs->hist[ji] = AIR_CALLOC(hs->histLen, double);
+    if (!hs->hist[ji]) {
+      char stmp[AIR_STRLEN_SMALL];
+      biffAddf(NRRD, "%s: couldn't allocate histogram %u (len %s)", me,
+               ji, airSprintSize_t(stmp, hs->histLen));
+      return 1;
+    }
+    airMopAdd(mop, hs->hist[ji], airFree, airMopAlways);
+  }
+  if (nrrdThreadRun(hs->jobNum, hs->jobNum, _nrrdHistoJob, hs)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    return 1;
+  }
+  clmp = nrrdDClamp[nout->type];
+  ins = nrrdDInsert[nout->type];
+  for (hi=0; hi<hs->histLen; hi++) {
+    sum = 0;
+    for (ji=0; ji<hs->jobNum; ji++) {
+      sum += hs->hist[ji][hi];
+    }
+    ins(nout->data, hi, clmp(sum));
+  }
+  return 0;
+}
+
+/* for nrrdHistoAxis: the input is seen as A-by-H-by-B, where H is the
+   histogrammed axis, and the output as A-by-bins-by-B */
+typedef struct {
+  const _nrrdHistoBinner *hb;
+  Nrrd *nout;
+  size_t A, H, B, aChunkNum;
+} _nrrdHistoAxisShared;
+
+/* jobs are disjoint parts of the output, so can write there directly */
+static void
+_nrrdHistoAxisJob(void *_hs, unsigned int jobIdx, unsigned int threadIdx) {
+  _nrrdHistoAxisShared *hs;
+  size_t a0, anum, bb, hh, ii, hI, idx[HISTO_BLOCK];
+  double count, (*lup)(const void *, size_t), (*clmp)(double),
+    (*ins)(void *, size_t, double);
+
+  AIR_UNUSED(threadIdx);
+  hs = AIR_CAST(_nrrdHistoAxisShared *, _hs);
+  lup = nrrdDLookup[hs->nout->type];
+  clmp = nrrdDClamp[hs->nout->type];
+  ins = nrrdDInsert[hs->nout->type];
+  bb = jobIdx/hs->aChunkNum;
+  a0 = (jobIdx % hs->aChunkNum)*HISTO_BLOCK;
+  anum = AIR_MIN(HISTO_BLOCK, hs->A - a0);
+  for (hh=0; hh<hs->H; hh++) {
+    _nrrdHistoBinBlock(idx, hs->hb, a0 + hs->A*(hh + hs->H*bb), anum);
+    for (ii=0; ii<anum; ii++) {
+      if (HISTO_SKIP != idx[ii]) {
+        hI = a0 + ii + hs->A*(idx[ii] + hs->hb->bins*bb);
+        count = lup(hs->nout->data, hI);
+        ins(hs->nout->data, hI, clmp(count + 1));
+      }
+    }
+  }
+  return;
+}
+
 /*
 ******** nrrdHisto()
 **
@@ -37,15 +345,20 @@
 ** this are ignored (they don't contribute to the histogram).
 **
 ** post-NrrdRange policy:
+**
+** The counts are clamped to the range of the output type.  When that
+** gives the same result (see _nrrdHistoRun), the histogram is made
+** with nrrdStateNumThreads threads.
 */
 int
 nrrdHisto(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
           const Nrrd *nwght, size_t bins, int type) {
   static const char me[]="nrrdHisto", func[]="histo";
-  size_t I, num, idx;
   airArray *mop;
   NrrdRange *range;
-  double min, max, eps, val, count, incr, (*lup)(const void *v, size_t I);
+  double min, max, eps;
+  _nrrdHistoBinner hb;
+  _nrrdHistoShared hs;
 
   if (!(nin && nout)) {
     /* _range and nwght can be NULL */
@@ -80,9 +393,6 @@ nrrdHisto(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
       biffAddf(NRRD, "%s: nwght size mismatch with nin", me);
       return 1;
     }
-    lup = nrrdDLookup[nwght->type];
-  } else {
-    lup = NULL;
   }
 
   if (nrrdMaybeAlloc_va(nout, type, 1, bins)) {
@@ -120,28 +430,23 @@ nrrdHisto(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
   /* nout->axis[0].label set below */
 
   /* make histogram */
-  num = nrrdElementNumber(nin);
-  for (I=0; I<num; I++) {
-    val = nrrdDLookup[nin->type](nin->data, I);
-    if (AIR_EXISTS(val)) {
-      if (val < min || val > max+eps) {
-        /* value is outside range; ignore it */
-        continue;
-      }
-      if (AIR_IN_CL(min, val, max)) {
-        idx = airIndex(min, val, max+eps, AIR_CAST(unsigned int, bins));
-        /*
-        printf("!%s: %d: index(%g, %g, %g, %d) = %d\n",
-               me, (int)I, min, val, max, bins, idx);
-        */
-        /* count is a double in order to simplify clamping the
-           hit values to the representable range for nout->type */
-        count = nrrdDLookup[nout->type](nout->data, idx);
-        incr = nwght ? lup(nwght->data, I) : 1;
-        count = nrrdDClamp[nout->type](count + incr);
-        nrrdDInsert[nout->type](nout->data, idx, count);
-      }
-    }
+  hb.min = min;
+  hb.max = max;
+  hb.eps = eps;
+  hb.bins = bins;
+  hb.joint = AIR_FALSE;
+  hb.clamp = AIR_FALSE;
+  if (_nrrdHistoBinnerInit(&hb, nin, mop)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  hs.hb = &hb;
+  hs.hbNum = 1;
+  hs.nwght = nwght;
+  hs.num = nrrdElementNumber(nin);
+  if (_nrrdHistoRun(nout, &hs, mop)) {
+    biffAddf(NRRD, "%s: trouble making histogram", me);
+    airMopError(mop); return 1;
   }
 
   if (nrrdContentSet_va(nout, func, nin, "%d", bins)) {
@@ -329,20 +634,19 @@ nrrdHistoDraw(Nrrd *nout, const Nrrd *nin,
 ** By its very nature, and by the simplicity of this implemention,
 ** this can be a slow process due to terrible memory locality.  User
 ** may want to permute axes before and after this, but that can be
-** slow too...
+** slow too...  Uses nrrdStateNumThreads threads.
 */
 int
 nrrdHistoAxis(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
               unsigned int hax, size_t bins, int type) {
   static const char me[]="nrrdHistoAxis", func[]="histax";
   int map[NRRD_DIM_MAX];
-  unsigned int ai, hidx;
-  size_t szIn[NRRD_DIM_MAX], szOut[NRRD_DIM_MAX], size[NRRD_DIM_MAX],
-    coordIn[NRRD_DIM_MAX], coordOut[NRRD_DIM_MAX];
-  size_t I, hI, num;
-  double val, count;
+  unsigned int ai;
+  size_t size[NRRD_DIM_MAX];
   airArray *mop;
   NrrdRange *range;
+  _nrrdHistoBinner hb;
+  _nrrdHistoAxisShared hs;
 
   if (!(nin && nout)) {
     biffAddf(NRRD, "%s: got NULL pointer", me);
@@ -411,27 +715,40 @@ nrrdHistoAxis(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
     nout->axis[hax].kind = nrrdKindDomain;
   }
 
-  /* the skinny: we traverse the input samples in linear order, and
-     increment the bin in the histogram for the scanline we're in.
-     This is not terribly clever, and the memory locality is a
-     disaster */
-  nrrdAxisInfoGet_nva(nin, nrrdAxisInfoSize, szIn);
-  nrrdAxisInfoGet_nva(nout, nrrdAxisInfoSize, szOut);
-  memset(coordIn, 0, NRRD_DIM_MAX*sizeof(size_t));
-  num = nrrdElementNumber(nin);
-  for (I=0; I<num; I++) {
-    /* get input nrrd value and compute its histogram index */
-    val = nrrdDLookup[nin->type](nin->data, I);
-    if (AIR_EXISTS(val) && AIR_IN_CL(range->min, val, range->max)) {
-      hidx = airIndex(range->min, val, range->max, AIR_CAST(unsigned int, bins));
-      memcpy(coordOut, coordIn, nin->dim*sizeof(size_t));
-      coordOut[hax] = (unsigned int)hidx;
-      NRRD_INDEX_GEN(hI, coordOut, szOut, nout->dim);
-      count = nrrdDLookup[nout->type](nout->data, hI);
-      count = nrrdDClamp[nout->type](count + 1);
-      nrrdDInsert[nout->type](nout->data, hI, count);
-    }
-    NRRD_COORD_INCR(coordIn, szIn, nin->dim, 0);
+  /* the skinny: for each part of the output, we traverse the input
+     samples in linear order, and increment the bin in the histogram for
+     the scanline we're in.  This is not terribly clever, and the
+     memory locality is not great */
+  hb.min = range->min;
+  hb.max = range->max;
+  hb.eps = 0;
+  hb.bins = bins;
+  hb.joint = AIR_FALSE;
+  hb.clamp = AIR_FALSE;
+  if (_nrrdHistoBinnerInit(&hb, nin, mop)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  hs.hb = &hb;
+  hs.nout = nout;
+  hs.A = hs.B = 1;
+  for (ai=0; ai<nin->dim; ai++) {
+    if (ai < hax) {
+      hs.A *= nin->axis[ai].size;
+    } else if (ai > hax) {
+      hs.B *= nin->axis[ai].size;
+    }
+  }
+  hs.H = nin->axis[hax].size;
+  hs.aChunkNum = (hs.A + HISTO_BLOCK - 1)/HISTO_BLOCK;
+  if (hs.aChunkNum*hs.B > UINT_MAX) {
+    biffAddf(NRRD, "%s: sorry, too many scanlines", me);
+    airMopError(mop); return 1;
+  }
+  if (nrrdThreadRun(0, AIR_CAST(unsigned int, hs.aChunkNum*hs.B),
+                    _nrrdHistoAxisJob, &hs)) {
+    biffAddf(NRRD, "%s: trouble making histograms", me);
+    airMopError(mop); return 1;
   }
 
   if (nrrdContentSet_va(nout, func, nin, "%d,%d", hax, bins)) {
@@ -446,18 +763,26 @@ nrrdHistoAxis(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
   return 0;
 }
 
+/*
+******** nrrdHistoJoint
+**
+** makes a numNin-dimensional joint histogram of numNin same-sized
+** nrrds.  As with nrrdHisto, the counts are clamped to the range of
+** the output type, and several threads are used when possible.
+*/
 int
 nrrdHistoJoint(Nrrd *nout, const Nrrd *const *nin,
                const NrrdRange *const *_range, unsigned int numNin,
                const Nrrd *nwght, const size_t *bins,
                int type, const int *clamp) {
   static const char me[]="nrrdHistoJoint", func[]="jhisto";
-  int skip, hadContent;
-  double val, count, incr, (*lup)(const void *v, size_t I);
-  size_t Iin, Iout, numEl, coord[NRRD_DIM_MAX], totalContentStrlen;
+  int hadContent;
+  size_t totalContentStrlen;
   airArray *mop;
   NrrdRange **range;
   unsigned int nii, ai;
+  _nrrdHistoBinner *hb;
+  _nrrdHistoShared hs;
 
   /* error checking */
   /* nwght can be NULL -> weighting is constant 1.0 */
@@ -542,9 +867,6 @@ nrrdHistoJoint(Nrrd *nout, const Nrrd *const *nin,
                airSprintSize_t(stmp1, nrrdElementNumber(nwght)));
       return 1;
     }
-    lup = nrrdDLookup[nwght->type];
-  } else {
-    lup = NULL;
   }
 
   /* allocate output nrrd */
@@ -586,39 +908,32 @@ nrrdHistoJoint(Nrrd *nout, const Nrrd *const *nin,
   }
 
   /* the skinny */
-  numEl = nrrdElementNumber(nin[0]);
-  for (Iin=0; Iin<numEl; Iin++) {
-    skip = 0;
-    for (ai=0; ai<numNin; ai++) {
-      val = nrrdDLookup[nin[ai]->type](nin[ai]->data, Iin);
-      if (!AIR_EXISTS(val)) {
-        /* coordinate d in the joint histo can't be determined
-           if nin[ai] has a non-existent value here */
-        skip = 1;
-        break;
-      }
-      if (!AIR_IN_CL(range[ai]->min, val, range[ai]->max)) {
-        if (clamp[ai]) {
-          val = AIR_CLAMP(range[ai]->min, val, range[ai]->max);
-        } else {
-          skip = 1;
-          break;
-        }
-      }
-      coord[ai] = AIR_CAST(size_t, airIndexClampULL(range[ai]->min,
-                                                    val,
-                                                    range[ai]->max,
-                                                    bins[ai]));
-      /* printf(" -> coord = %d; ", coord[d]); fflush(stdout); */
-    }
-    if (skip) {
-      continue;
-    }
-    NRRD_INDEX_GEN(Iout, coord, bins, numNin);
-    count = nrrdDLookup[nout->type](nout->data, Iout);
-    incr = nwght ? lup(nwght->data, Iin) : 1.0;
-    count = nrrdDClamp[nout->type](count + incr);
-    nrrdDInsert[nout->type](nout->data, Iout, count);
+  hb = AIR_CALLOC(numNin, _nrrdHistoBinner);
+  if (!hb) {
+    biffAddf(NRRD, "%s: couldn't allocate binners", me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, hb, airFree, airMopAlways);
+  for (ai=0; ai<numNin; ai++) {
+    hb[ai].min = range[ai]->min;
+    hb[ai].max = range[ai]->max;
+    hb[ai].eps = 0;
+    hb[ai].bins = bins[ai];
+    hb[ai].joint = AIR_TRUE;
+    hb[ai].clamp = clamp[ai];
+    if (_nrrdHistoBinnerInit(hb + ai, nin[ai], mop)) {
+      biffAddf(NRRD, "%s: trouble with nin[%u]", me, ai);
+      airMopError(mop); return 1;
+    }
+    hs.stride[ai] = ai ? hs.stride[ai-1]*bins[ai-1] : 1;
+  }
+  hs.hb = hb;
+  hs.hbNum = numNin;
+  hs.nwght = nwght;
+  hs.num = nrrdElementNumber(nin[0]);
+  if (_nrrdHistoRun(nout, &hs, mop)) {
+    biffAddf(NRRD, "%s: trouble making histogram", me);
+    airMopError(mop); return 1;
   }
 
   /* HEY: switch to nrrdContentSet_va? */
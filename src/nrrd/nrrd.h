@@ -668,6 +668,15 @@ typedef struct {
   double padValue;             /* padding value, if needed */
 } NrrdBoundarySpec;
 
+/*
+******** nrrdThreadJob
+**
+** one job given to nrrdThreadRun: does job number jobIdx, in the thread
+** numbered threadIdx, with the shared state passed to nrrdThreadRun
+*/
+typedef void (*nrrdThreadJob)(void *shared, unsigned int jobIdx,
+                              unsigned int threadIdx);
+
 /* ---- END non-NrrdIO */
 
 /******** defaults (nrrdDefault..) and state (nrrdState..) */
@@ -697,6 +706,7 @@ NRRD_EXPORT int nrrdStateMeasureType;
 NRRD_EXPORT int nrrdStateMeasureModeBins;
 NRRD_EXPORT int nrrdStateMeasureHistoType;
 NRRD_EXPORT int nrrdStateDisallowIntegerNonExist;
+NRRD_EXPORT unsigned int nrrdStateNumThreads;
 /* ---- END non-NrrdIO */
 NRRD_EXPORT int nrrdStateAlwaysSetContent;
 NRRD_EXPORT int nrrdStateDisableContent;
@@ -724,6 +734,7 @@ NRRD_EXPORT const char *const nrrdEnvVarStateMeasureType;
 NRRD_EXPORT const char *const nrrdEnvVarStateMeasureModeBins;
 NRRD_EXPORT const char *const nrrdEnvVarStateMeasureHistoType;
 NRRD_EXPORT const char *const nrrdEnvVarStateGrayscaleImage3D;
+NRRD_EXPORT const char *const nrrdEnvVarStateNumThreads;
 NRRD_EXPORT int nrrdGetenvBool(int *val, char **envStr,
                                const char *envVar);
 NRRD_EXPORT int nrrdGetenvEnum(int *val, char **envStr, const airEnum *enm,
@@ -1298,6 +1309,9 @@ NRRD_EXPORT int nrrdCheapMedian(Nrrd *nout, const Nrrd *nin,
                                 int pad, int mode,
                                 unsigned int radius, float wght,
                                 unsigned int bins);
+NRRD_EXPORT int nrrdExactMedian(Nrrd *nout, const Nrrd *nin, int pad,
+                                unsigned int radius, double quantile,
+                                unsigned int bins);
 NRRD_EXPORT int nrrdDistanceL2(Nrrd *nout, const Nrrd *nin,
                                int typeOut, const int *axisDo,
                                double thresh, int insideHigher);
@@ -1469,6 +1483,13 @@ NRRD_EXPORT int nrrdFFT(Nrrd *nout, const Nrrd *nin,
                         int sign, int rescale, int preCompLevel);
 NRRD_EXPORT int nrrdFFTWWisdomWrite(FILE *file);
 
+/******** multi-threading */
+/* threadNrrd.c */
+NRRD_EXPORT int nrrdThreadRun(unsigned int numThreads, unsigned int jobNum,
+                              nrrdThreadJob job, void *shared);
+NRRD_EXPORT unsigned int nrrdThreadNum(unsigned int numThreads,
+                                       unsigned int jobNum);
+
 /******** kernels (interpolation, 1st and 2nd derivatives) */
 /* new kernels should also be registered with
    meet/meetNrrd.c/meetNrrdKernelAll() */
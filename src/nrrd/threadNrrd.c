@@ -0,0 +1,188 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "nrrd.h"
+#include "privateNrrd.h"
+
+/*
+** the (few) nrrd functions that can use multiple threads break their
+** work up into some number of jobs, which are handed out (in order)
+** to threads by nrrdThreadRun.  The number of threads used is
+** nrrdStateNumThreads, unless the caller says otherwise.  Other
+** libraries (gage, bane, moss, ...) use the same pool, so that
+** nrrdStateNumThreads is the one knob for all of them.
+*/
+
+typedef struct {
+  nrrdThreadJob job;
+  void *shared;
+  unsigned int jobNum,
+    jobNext;                  /* next job to hand out */
+  int stop;                   /* hand out no more jobs */
+  airThreadMutex *mutex;      /* NULL if single-threaded */
+} _nrrdThreadCrew;
+
+typedef struct {
+  _nrrdThreadCrew *crew;
+  airThread *thread;
+  unsigned int threadIdx;
+} _nrrdThreadTask;
+
+static void *
+_nrrdThreadWorker(void *_task) {
+  _nrrdThreadTask *task;
+  _nrrdThreadCrew *crew;
+  unsigned int jobIdx;
+
+  task = AIR_CAST(_nrrdThreadTask *, _task);
+  crew = task->crew;
+  if (task->threadIdx) {
+    /* if this fails, biff messages go to the caller's store */
+    biffThreadLocalSet(AIR_TRUE);
+  }
+  while (1) {
+    if (crew->mutex) {
+      airThreadMutexLock(crew->mutex);
+    }
+    jobIdx = crew->stop ? crew->jobNum : crew->jobNext;
+    if (jobIdx < crew->jobNum) {
+      crew->jobNext++;
+    }
+    if (crew->mutex) {
+      airThreadMutexUnlock(crew->mutex);
+    }
+    if (jobIdx == crew->jobNum) {
+      break;
+    }
+    crew->job(crew->shared, jobIdx, task->threadIdx);
+  }
+  if (task->threadIdx) {
+    biffThreadLocalSet(AIR_FALSE);
+  }
+  return _task;
+}
+
+/*
+******** nrrdThreadRun
+**
+** calls job(shared, jobIdx, threadIdx) once for every jobIdx in
+** [0, jobNum), with numThreads threads (or nrrdStateNumThreads threads,
+** if numThreads is 0), but never more threads than jobs. threadIdx
+** identifies the calling thread, for jobs that need per-thread storage.
+** Thread 0 is the caller of nrrdThreadRun.
+**
+** The other threads each have their own biff store while they run
+** (see biffThreadLocalSet), which is freed when they finish, so that
+** jobs failing at the same time don't mix their messages.  A job that
+** fails should take its messages with biffGetDone(), and leave them in
+** "shared" for the caller to biffAdd after nrrdThreadRun returns.
+**
+** Returns non-zero, with a biff message, if a thread couldn't be
+** started or joined.  If a thread can't be started, the threads that
+** were started are told to stop, and joined, before returning.
+*/
+int
+nrrdThreadRun(unsigned int numThreads, unsigned int jobNum,
+              nrrdThreadJob job, void *shared) {
+  static const char me[]="nrrdThreadRun";
+  _nrrdThreadCrew crew;
+  _nrrdThreadTask *task;
+  airArray *mop;
+  unsigned int tidx;
+
+  if (!job) {
+    biffAddf(NRRD, "%s: got NULL pointer", me);
+    return 1;
+  }
+  numThreads = nrrdThreadNum(numThreads, jobNum);
+  crew.job = job;
+  crew.shared = shared;
+  crew.jobNum = jobNum;
+  crew.jobNext = 0;
+  crew.stop = AIR_FALSE;
+  crew.mutex = NULL;
+  mop = airMopNew();
+  task = AIR_CALLOC(numThreads, _nrrdThreadTask);
+  if (!task) {
+    biffAddf(NRRD, "%s: couldn't allocate %u tasks", me, numThreads);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, task, airFree, airMopAlways);
+  if (numThreads > 1) {
+    crew.mutex = airThreadMutexNew();
+    airMopAdd(mop, crew.mutex, (airMopper)airThreadMutexNix, airMopAlways);
+    if (!airThreadCapable && airThreadNoopWarning) {
+      fprintf(stderr, "%s: WARNING: not multi-threaded; will do %u "
+              "\"threads\" serially !!!\n", me, numThreads);
+    }
+  }
+  for (tidx=0; tidx<numThreads; tidx++) {
+    task[tidx].crew = &crew;
+    task[tidx].threadIdx = tidx;
+    if (tidx) {
+      task[tidx].thread = airThreadNew();
+      airMopAdd(mop, task[tidx].thread, (airMopper)airThreadNix,
+                airMopAlways);
+      if (airThreadStart(task[tidx].thread, _nrrdThreadWorker,
+                         AIR_CAST(void *, task + tidx))) {
+        unsigned int ti;
+        biffAddf(NRRD, "%s: couldn't start thread %u", me, tidx);
+        /* the threads already started have to finish before the
+           crew and tasks they use go away */
+        airThreadMutexLock(crew.mutex);
+        crew.stop = AIR_TRUE;
+        airThreadMutexUnlock(crew.mutex);
+        for (ti=1; ti<tidx; ti++) {
+          airThreadJoin(task[ti].thread, NULL);
+        }
+        airMopError(mop); return 1;
+      }
+    }
+  }
+  _nrrdThreadWorker(AIR_CAST(void *, task + 0));
+  for (tidx=1; tidx<numThreads; tidx++) {
+    if (airThreadJoin(task[tidx].thread, NULL)) {
+      biffAddf(NRRD, "%s: couldn't join thread %u", me, tidx);
+      airMopError(mop); return 1;
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** nrrdThreadNum
+**
+** how many threads nrrdThreadRun(numThreads, jobNum, ...) will use;
+** for callers that allocate per-thread storage
+*/
+unsigned int
+nrrdThreadNum(unsigned int numThreads, unsigned int jobNum) {
+
+  if (!numThreads) {
+    numThreads = nrrdStateNumThreads;
+  }
+  numThreads = AIR_MIN(numThreads, jobNum);
+  return AIR_MAX(1, numThreads);
+}
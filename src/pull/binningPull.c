@@ -103,20 +103,13 @@ _pullBinNeighborSet(pullContext *pctx, pullBin *bin) {
 }
 
 /*
-** bins on boundary now extend to infinity; so the only time this
-** returns NULL (indicating error) is for non-existent positions
+** index of bin containing an (existent) position; no biff, so this
+** can be called from any thread
 */
-pullBin *
-_pullBinLocate(pullContext *pctx, double *posWorld) {
-  static const char me[]="_pullBinLocate";
+unsigned int
+_pullBinIndex(const pullContext *pctx, const double *posWorld) {
   unsigned int axi, eidx[4], binIdx;
 
-  if (!ELL_4V_EXISTS(posWorld)) {
-    biffAddf(PULL, "%s: non-existent position (%g,%g,%g,%g)", me,
-             posWorld[0], posWorld[1], posWorld[2], posWorld[3]);
-    return NULL;
-  }
-
   if (pctx->flag.binSingle) {
     binIdx = 0;
   } else {
@@ -131,8 +124,24 @@ _pullBinLocate(pullContext *pctx, double *posWorld) {
                     eidx[1] + pctx->binsEdge[1]*(
                          eidx[2] + pctx->binsEdge[2] * eidx[3])));
   }
+  return binIdx;
+}
+
+/*
+** bins on boundary now extend to infinity; so the only time this
+** returns NULL (indicating error) is for non-existent positions
+*/
+pullBin *
+_pullBinLocate(pullContext *pctx, double *posWorld) {
+  static const char me[]="_pullBinLocate";
+
+  if (!ELL_4V_EXISTS(posWorld)) {
+    biffAddf(PULL, "%s: non-existent position (%g,%g,%g,%g)", me,
+             posWorld[0], posWorld[1], posWorld[2], posWorld[3]);
+    return NULL;
+  }
 
-  return pctx->bin + binIdx;
+  return pctx->bin + _pullBinIndex(pctx, posWorld);
 }
 
 /*
@@ -206,30 +215,17 @@ pullBinsPointAdd(pullContext *pctx, pullPoint *point, pullBin **binP) {
   return 0;
 }
 
-int
-pullBinsPointMaybeAdd(pullContext *pctx, pullPoint *point,
-                      /* output */
-                      pullBin **binP, int *added) {
-  static const char me[]="pullBinsPointMaybeAdd";
-  pullBin *bin;
+/*
+** adds point to given bin, unless pctx->flag.restrictiveAddToBins and
+** the bin already has a point too close to it
+*/
+static int
+_pullBinPointMaybeAdd(pullContext *pctx, pullBin *bin, pullPoint *point,
+                      int *added) {
+  static const char me[]="_pullBinPointMaybeAdd";
   unsigned int idx;
   int okay;
 
-  if (binP) {
-    *binP = NULL;
-  }
-  if (!(pctx && point && added)) {
-    biffAddf(PULL, "%s: got NULL pointer", me);
-    return 1;
-  }
-  if (!( bin = _pullBinLocate(pctx, point->pos) )) {
-    biffAddf(PULL, "%s: can't locate point %p %u",
-             me, AIR_CAST(void*, point), point->idtag);
-    return 1;
-  }
-  if (binP) {
-    *binP = bin;
-  }
   if (pctx->flag.restrictiveAddToBins) {
     okay = AIR_TRUE;
     for (idx=0; idx<bin->pointNum; idx++) {
@@ -264,6 +260,173 @@ pullBinsPointMaybeAdd(pullContext *pctx, pullPoint *point,
   return 0;
 }
 
+int
+pullBinsPointMaybeAdd(pullContext *pctx, pullPoint *point,
+                      /* output */
+                      pullBin **binP, int *added) {
+  static const char me[]="pullBinsPointMaybeAdd";
+  pullBin *bin;
+
+  if (binP) {
+    *binP = NULL;
+  }
+  if (!(pctx && point && added)) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!( bin = _pullBinLocate(pctx, point->pos) )) {
+    biffAddf(PULL, "%s: can't locate point %p %u",
+             me, AIR_CAST(void*, point), point->idtag);
+    return 1;
+  }
+  if (binP) {
+    *binP = bin;
+  }
+  if (_pullBinPointMaybeAdd(pctx, bin, point, added)) {
+    biffAddf(PULL, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
+
+typedef struct {
+  pullContext *pctx;
+  pullPoint **point;
+  unsigned int pointNum, jobNum,
+    *binIdx,         /* per-point: which bin it goes in */
+    *binEnd,         /* per-bin: end of its run in order[] */
+    *order;          /* point indices, sorted by bin */
+  int maybe;
+  unsigned char *added;
+} _pullBinsAddShared;
+
+static int
+_pullBinsLocateJob(pullTask *task, void *_shared, unsigned int jobIdx) {
+  _pullBinsAddShared *shared;
+  unsigned int lo, hi, ii;
+  const pullPoint *point;
+
+  AIR_UNUSED(task);
+  shared = AIR_CAST(_pullBinsAddShared *, _shared);
+  _pullFinishJobRange(&lo, &hi, jobIdx, shared->jobNum, shared->pointNum);
+  for (ii=lo; ii<hi; ii++) {
+    point = shared->point[ii];
+    shared->binIdx[ii] = (ELL_4V_EXISTS(point->pos)
+                          ? _pullBinIndex(shared->pctx, point->pos)
+                          : shared->pctx->binNum);
+  }
+  return 0;
+}
+
+static int
+_pullBinsAddJob(pullTask *task, void *_shared, unsigned int jobIdx) {
+  _pullBinsAddShared *shared;
+  pullContext *pctx;
+  unsigned int blo, bhi, bi, oi, ii;
+  int added;
+
+  AIR_UNUSED(task);
+  shared = AIR_CAST(_pullBinsAddShared *, _shared);
+  pctx = shared->pctx;
+  _pullFinishJobRange(&blo, &bhi, jobIdx, shared->jobNum, pctx->binNum);
+  for (bi=blo; bi<bhi; bi++) {
+    /* this job is the only one touching bin bi */
+    for (oi=(bi ? shared->binEnd[bi-1] : 0); oi<shared->binEnd[bi]; oi++) {
+      ii = shared->order[oi];
+      if (shared->maybe) {
+        if (_pullBinPointMaybeAdd(pctx, pctx->bin + bi, shared->point[ii],
+                                  &added)) {
+          return 1;
+        }
+      } else {
+        if (_pullBinPointAdd(pctx, pctx->bin + bi, shared->point[ii])) {
+          return 1;
+        }
+        added = AIR_TRUE;
+      }
+      shared->added[ii] = AIR_CAST(unsigned char, added);
+    }
+  }
+  return 0;
+}
+
+/*
+******** _pullBinsPointsAdd
+**
+** adds all the given points to the bins (with pullBinsPointMaybeAdd
+** if maybe, else pullBinsPointAdd), with the same result as doing
+** them one at a time, in order. The tasks first locate the points'
+** bins in parallel, then a (cheap) counting sort on bin index groups
+** the points by bin, preserving order, and finally bins are filled
+** in parallel, each by one task. The bin index of each point is saved
+** in binIdx[], and whether it was added in added[], both arrays
+** allocated by the caller for pointNum values.
+*/
+int
+_pullBinsPointsAdd(pullContext *pctx, pullPoint **point,
+                   unsigned int pointNum, int maybe,
+                   unsigned int *binIdx, unsigned char *added) {
+  static const char me[]="_pullBinsPointsAdd";
+  _pullBinsAddShared shared;
+  unsigned int ii, bi, sum;
+  airArray *mop;
+
+  if (!pointNum) {
+    return 0;
+  }
+  mop = airMopNew();
+  shared.pctx = pctx;
+  shared.point = point;
+  shared.pointNum = pointNum;
+  shared.binIdx = binIdx;
+  shared.maybe = maybe;
+  shared.added = added;
+  shared.binEnd = AIR_CALLOC(pctx->binNum, unsigned int);
+  airMopAdd(mop, shared.binEnd, airFree, airMopAlways);
+  shared.order = AIR_CALLOC(pointNum, unsigned int);
+  airMopAdd(mop, shared.order, airFree, airMopAlways);
+  if (!( shared.binEnd && shared.order )) {
+    biffAddf(PULL, "%s: couldn't allocate buffers for %u bins, %u points",
+             me, pctx->binNum, pointNum);
+    airMopError(mop); return 1;
+  }
+  shared.jobNum = _pullFinishJobNum(pctx, pointNum);
+  if (_pullFinishRun(pctx, shared.jobNum, _pullBinsLocateJob, &shared)) {
+    biffAddf(PULL, "%s: trouble locating points", me);
+    airMopError(mop); return 1;
+  }
+  /* count points per bin */
+  for (ii=0; ii<pointNum; ii++) {
+    if (binIdx[ii] == pctx->binNum) {
+      biffAddf(PULL, "%s: point %u has non-existent position "
+               "(%g,%g,%g,%g)", me, point[ii]->idtag,
+               point[ii]->pos[0], point[ii]->pos[1],
+               point[ii]->pos[2], point[ii]->pos[3]);
+      airMopError(mop); return 1;
+    }
+    shared.binEnd[binIdx[ii]]++;
+  }
+  /* exclusive prefix sum: binEnd[bi] becomes start of bin bi's run */
+  sum = 0;
+  for (bi=0; bi<pctx->binNum; bi++) {
+    unsigned int cnt;
+    cnt = shared.binEnd[bi];
+    shared.binEnd[bi] = sum;
+    sum += cnt;
+  }
+  /* scatter; this leaves binEnd[bi] at the end of bin bi's run */
+  for (ii=0; ii<pointNum; ii++) {
+    shared.order[shared.binEnd[binIdx[ii]]++] = ii;
+  }
+  shared.jobNum = _pullFinishJobNum(pctx, pctx->binNum);
+  if (_pullFinishRun(pctx, shared.jobNum, _pullBinsAddJob, &shared)) {
+    biffAddf(PULL, "%s: trouble adding points to bins", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
 int
 _pullBinSetup(pullContext *pctx) {
   static const char me[]="_pullBinSetup";
@@ -372,24 +535,66 @@ _pullBinFinish(pullContext *pctx) {
   pctx->binNum = 0;
 }
 
+typedef struct {
+  pullContext *pctx;
+  unsigned int jobNum,
+    *binStart;       /* per-bin: where its points go in tmpPointPtr */
+} _pullGatherShared;
+
+/*
+** empties bins into pctx->tmpPointPtr, in the same order as
+** repeatedly removing bin->point[0] with _pullBinPointRemove (which
+** had been how this was done): point[0], then point[N-1] down to point[1]
+*/
+static int
+_pullBinsGatherJob(pullTask *task, void *_shared, unsigned int jobIdx) {
+  _pullGatherShared *shared;
+  pullContext *pctx;
+  pullPoint **dst;
+  pullBin *bin;
+  unsigned int blo, bhi, bi, pi;
+
+  AIR_UNUSED(task);
+  shared = AIR_CAST(_pullGatherShared *, _shared);
+  pctx = shared->pctx;
+  _pullFinishJobRange(&blo, &bhi, jobIdx, shared->jobNum, pctx->binNum);
+  for (bi=blo; bi<bhi; bi++) {
+    bin = pctx->bin + bi;
+    if (!bin->pointNum) {
+      continue;
+    }
+    dst = pctx->tmpPointPtr + shared->binStart[bi];
+    dst[0] = bin->point[0];
+    for (pi=1; pi<bin->pointNum; pi++) {
+      dst[pi] = bin->point[bin->pointNum - pi];
+    }
+    airArrayLenSet(bin->pointArr, 0);
+  }
+  return 0;
+}
+
 /*
 ** sets pctx->stuckNum
 ** resets all task[]->stuckNum
 ** reallocates pctx->tmpPointPerm and pctx->tmpPointPtr
 ** the point of this is to do rebinning
 **
-** This function is only called by the master thread, this
-** does *not* have to be thread-safe in any way
+** This function is only called by the master thread; the other tasks
+** help (via _pullFinishRun) with emptying and refilling the bins
 */
 int
 _pullIterFinishDescent(pullContext *pctx) {
   static const char me[]="_pullIterFinishDescent";
-  unsigned int oldBinIdx, pointIdx, taskIdx, runIdx, pointNum;
-  pullBin *oldBin;
-  pullPoint *point;
-  int added;
-
-  _pullNixTheNixed(pctx);
+  unsigned int binIdx, pointIdx, taskIdx, pointNum, *pointBin;
+  pullPoint **point;
+  unsigned char *added;
+  _pullGatherShared gather;
+  airArray *mop;
+
+  if (_pullNixTheNixed(pctx)) {
+    biffAddf(PULL, "%s: trouble nixing points", me);
+    return 1;
+  }
 
   pctx->stuckNum = 0;
   for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
@@ -417,15 +622,31 @@ _pullIterFinishDescent(pullContext *pctx) {
     }
     pctx->tmpPointNum = pointNum;
   }
-  runIdx = 0;
-  for (oldBinIdx=0; oldBinIdx<pctx->binNum; oldBinIdx++) {
-    oldBin = pctx->bin + oldBinIdx;
-    while (oldBin->pointNum) {
-      /* tricky: we can't traverse bin->point[], because of how it is
-         re-ordered on point removal, so we always grab point[0] */
-      pctx->tmpPointPtr[runIdx++] = oldBin->point[0];
-      _pullBinPointRemove(pctx, oldBin, 0);
-    }
+  mop = airMopNew();
+  gather.pctx = pctx;
+  gather.binStart = AIR_CALLOC(pctx->binNum, unsigned int);
+  airMopAdd(mop, gather.binStart, airFree, airMopAlways);
+  point = AIR_CALLOC(pointNum, pullPoint *);
+  airMopAdd(mop, point, airFree, airMopAlways);
+  pointBin = AIR_CALLOC(pointNum, unsigned int);
+  airMopAdd(mop, pointBin, airFree, airMopAlways);
+  added = AIR_CALLOC(pointNum, unsigned char);
+  airMopAdd(mop, added, airFree, airMopAlways);
+  if (!( gather.binStart
+         && (!pointNum || (point && pointBin && added)) )) {
+    biffAddf(PULL, "%s: couldn't allocate rebinning buffers", me);
+    airMopError(mop); return 1;
+  }
+  /* exclusive prefix sum of bin sizes */
+  pointIdx = 0;
+  for (binIdx=0; binIdx<pctx->binNum; binIdx++) {
+    gather.binStart[binIdx] = pointIdx;
+    pointIdx += pctx->bin[binIdx].pointNum;
+  }
+  gather.jobNum = _pullFinishJobNum(pctx, pctx->binNum);
+  if (_pullFinishRun(pctx, gather.jobNum, _pullBinsGatherJob, &gather)) {
+    biffAddf(PULL, "%s: trouble emptying bins", me);
+    airMopError(mop); return 1;
   }
   airShuffle_r(pctx->task[0]->rng,
                pctx->tmpPointPerm, pointNum, pctx->flag.permuteOnRebin);
@@ -433,42 +654,33 @@ _pullIterFinishDescent(pullContext *pctx) {
     printf("%s: permuting %u points\n", me, pointNum);
   }
   for (pointIdx=0; pointIdx<pointNum; pointIdx++) {
-    point = pctx->tmpPointPtr[pctx->tmpPointPerm[pointIdx]];
-    /*
-    if (1 == pctx->iter && 102 == point->idtag) {
-      _pullDebugSanity(pctx->task[0], point);
-    }
-    */
-    /* Sun Jul 14 01:30:41 CDT 2013: the previous code was basically
-       just pullBinsPointAdd(). But when working with codim-3
-       constraints (like finding spatial maxima with maximal strength
-       along scale), its easy for many points to start piling on top
-       of each other; that is the problem that
-       pullFlagRestrictiveAddToBins was designed to solve. */
-    if (pctx->constraint && 0 == pctx->constraintDim) {
-      if (pullBinsPointMaybeAdd(pctx, point, NULL, &added)) {
-        biffAddf(PULL, "%s: trouble binning? point %u", me, point->idtag);
-        return 1;
-      }
-      if (!added) {
-        /* the point wasn't owned by any bin, and now it turns out
-           no bin wanted to own it, so we have to remove it */
-        /* in the case of point maxima searching; this mainly happened
-           because two points at the same spatial positition slowly
-           descended along scale towards each other at the scale of
-           maximal strength */
-        point = pullPointNix(point);
-      }
-    } else {
-      if (pullBinsPointAdd(pctx, point, NULL)) {
-        biffAddf(PULL, "%s: trouble binning point %u", me, point->idtag);
-        return 1;
-      }
-      point = NULL;
-    }
+    point[pointIdx] = pctx->tmpPointPtr[pctx->tmpPointPerm[pointIdx]];
     pctx->tmpPointPtr[pctx->tmpPointPerm[pointIdx]] = NULL;
   }
+  /* Sun Jul 14 01:30:41 CDT 2013: the previous code was basically
+     just pullBinsPointAdd(). But when working with codim-3
+     constraints (like finding spatial maxima with maximal strength
+     along scale), its easy for many points to start piling on top
+     of each other; that is the problem that
+     pullFlagRestrictiveAddToBins was designed to solve. */
+  if (_pullBinsPointsAdd(pctx, point, pointNum,
+                         pctx->constraint && 0 == pctx->constraintDim,
+                         pointBin, added)) {
+    biffAddf(PULL, "%s: trouble rebinning %u points", me, pointNum);
+    airMopError(mop); return 1;
+  }
+  for (pointIdx=0; pointIdx<pointNum; pointIdx++) {
+    if (!added[pointIdx]) {
+      /* the point wasn't owned by any bin, and now it turns out
+         no bin wanted to own it, so we have to remove it */
+      /* in the case of point maxima searching; this mainly happened
+         because two points at the same spatial positition slowly
+         descended along scale towards each other at the scale of
+         maximal strength */
+      _pullTaskPointRecycle(pctx->task[0], point[pointIdx]);
+    }
+  }
 
+  airMopOkay(mop);
   return 0;
 }
-
@@ -88,12 +88,23 @@ pullContextNew(void) {
   pctx->task = NULL;
   pctx->iterBarrierA = NULL;
   pctx->iterBarrierB = NULL;
+  pctx->finishCrew = NULL;
 #if PULL_HINTER
   pctx->nhinter  = nrrdNew();
 #endif
   pctx->logAdd = NULL;
+  pctx->runActive = AIR_FALSE;
+  pctx->runResume = AIR_FALSE;
+  pctx->runConverged = AIR_FALSE;
+  pctx->runIterFirst = 0;
+  pctx->runEnergyLast = AIR_NAN;
+  pctx->runEnergyDecreaseAvg = AIR_NAN;
 
   pctx->timeIteration = 0;
+  pctx->timeProcess = 0;
+  pctx->timeFinish = 0;
+  pctx->timeProcessTotal = 0;
+  pctx->timeFinishTotal = 0;
   pctx->timeRun = 0;
   pctx->energy = AIR_NAN;
   pctx->addNum = 0;
@@ -75,6 +75,161 @@ _pullProcess(pullTask *task) {
   return 0;
 }
 
+/*
+** _pullTaskErrKeep
+**
+** the worker threads each have their own biff store (so that threads
+** failing at the same time don't mix their messages); this is how a
+** worker takes its messages, keeping the first of them in task->err for
+** the master thread to report with _pullTaskErrReport. The master
+** thread's messages are already where they should be.
+*/
+static void
+_pullTaskErrKeep(pullTask *task) {
+  char *err;
+
+  if (!task->threadIdx || !biffCheck(PULL)) {
+    return;
+  }
+  err = biffGetDone(PULL);
+  if (task->err) {
+    airFree(err);
+  } else {
+    task->err = err;
+  }
+  return;
+}
+
+/*
+** _pullTaskErrReport
+**
+** called by the master thread once the workers are waiting again: adds
+** (and forgets) the messages that the workers kept
+*/
+static void
+_pullTaskErrReport(pullContext *pctx) {
+  unsigned int tidx;
+
+  for (tidx=1; tidx<pctx->threadNum; tidx++) {
+    if (pctx->task[tidx]->err) {
+      biffAddf(PULL, "%s", pctx->task[tidx]->err);
+      pctx->task[tidx]->err = AIR_CAST(char *,
+                                       airFree(pctx->task[tidx]->err));
+    }
+  }
+  return;
+}
+
+/*
+** the other thing that worker threads do: as long as there are jobs
+** left in the parallel finishing phase, get the next one, and do it
+*/
+static void
+_pullFinishWork(pullTask *task) {
+  _pullFinishCrew *crew;
+  unsigned int jobIdx;
+
+  crew = AIR_CAST(_pullFinishCrew *, task->pctx->finishCrew);
+  while (1) {
+    if (task->pctx->threadNum > 1) {
+      airThreadMutexLock(task->pctx->binMutex);
+    }
+    jobIdx = crew->jobNext;
+    if (crew->jobNext < crew->jobNum) {
+      crew->jobNext++;
+    }
+    if (task->pctx->threadNum > 1) {
+      airThreadMutexUnlock(task->pctx->binMutex);
+    }
+    if (jobIdx == crew->jobNum) {
+      break;
+    }
+    if (crew->job(task, crew->shared, jobIdx)) {
+      /* no lock needed: it only ever changes to AIR_TRUE */
+      crew->error = AIR_TRUE;
+      _pullTaskErrKeep(task);
+    }
+  }
+  return;
+}
+
+/*
+** _pullFinishJobNum
+**
+** how many jobs to break workNum units of finishing work into
+*/
+unsigned int
+_pullFinishJobNum(const pullContext *pctx, unsigned int workNum) {
+  unsigned int jobNum;
+
+  jobNum = pctx->threadNum*_PULL_FINISH_JOB_PER_THREAD;
+  return AIR_MIN(jobNum, workNum);
+}
+
+/*
+** _pullFinishJobRange
+**
+** sets [*loP, *hiP) to the part of [0, workNum) that is job jobIdx of
+** jobNum; the parts are contiguous and differ in size by at most one
+*/
+void
+_pullFinishJobRange(unsigned int *loP, unsigned int *hiP,
+                    unsigned int jobIdx, unsigned int jobNum,
+                    unsigned int workNum) {
+  unsigned int chunk, extra;
+
+  chunk = workNum/jobNum;
+  extra = workNum % jobNum;
+  *loP = jobIdx*chunk + AIR_MIN(jobIdx, extra);
+  *hiP = *loP + chunk + (jobIdx < extra);
+  return;
+}
+
+/*
+** _pullFinishRun
+**
+** has all the tasks call job(task, shared, jobIdx), once for every
+** jobIdx in [0, jobNum), using the worker threads that would otherwise
+** be waiting on iterBarrierA for the next iteration. Jobs have to be
+** independent of each other; anything a job counts should be recorded
+** per job (in shared) and summed afterwards.
+**
+** This must only be called by the master thread while the workers are
+** waiting on iterBarrierA: after iterBarrierB (from an iteration
+** finisher), or between iterations (as by pullTraceMultiSet, between
+** pullStart and pullFinish). Returns non-zero if any job did.
+*/
+int
+_pullFinishRun(pullContext *pctx, unsigned int jobNum,
+               _pullFinishJob_t *job, void *shared) {
+  static const char me[]="_pullFinishRun";
+  _pullFinishCrew crew;
+
+  if (!jobNum) {
+    return 0;
+  }
+  crew.job = job;
+  crew.shared = shared;
+  crew.jobNum = jobNum;
+  crew.jobNext = 0;
+  crew.error = AIR_FALSE;
+  pctx->finishCrew = AIR_CAST(void *, &crew);
+  if (pctx->threadNum > 1) {
+    airThreadBarrierWait(pctx->iterBarrierA);
+  }
+  _pullFinishWork(pctx->task[0]);
+  if (pctx->threadNum > 1) {
+    airThreadBarrierWait(pctx->iterBarrierB);
+  }
+  pctx->finishCrew = NULL;
+  if (crew.error) {
+    _pullTaskErrReport(pctx);
+    biffAddf(PULL, "%s: trouble with %u finishing jobs", me, jobNum);
+    return 1;
+  }
+  return 0;
+}
+
 /* the main loop for each worker thread */
 void *
 _pullWorker(void *_task) {
@@ -82,6 +237,8 @@ _pullWorker(void *_task) {
   pullTask *task;
 
   task = (pullTask *)_task;
+  /* if this fails, biff messages go to the master thread's store */
+  biffThreadLocalSet(AIR_TRUE);
 
   while (1) {
     if (task->pctx->verbose > 1) {
@@ -97,13 +254,19 @@ _pullWorker(void *_task) {
       break;
     }
     /* else there's work to do . . . */
-    if (task->pctx->verbose > 1) {
-      fprintf(stderr, "%s(%u): starting to process\n", me, task->threadIdx);
-    }
-    if (_pullProcess(task)) {
-      /* HEY clearly not threadsafe to have errors . . . */
-      biffAddf(PULL, "%s: thread %u trouble", me, task->threadIdx);
-      task->pctx->finished = AIR_TRUE;
+    if (task->pctx->finishCrew) {
+      /* . . . helping the master thread finish the iteration */
+      _pullFinishWork(task);
+    } else {
+      if (task->pctx->verbose > 1) {
+        fprintf(stderr, "%s(%u): starting to process\n",
+                me, task->threadIdx);
+      }
+      if (_pullProcess(task)) {
+        biffAddf(PULL, "%s: thread %u trouble", me, task->threadIdx);
+        _pullTaskErrKeep(task);
+        task->pctx->finished = AIR_TRUE;
+      }
     }
     if (task->pctx->verbose > 1) {
       fprintf(stderr, "%s(%u): waiting on barrier B\n",
@@ -111,6 +274,7 @@ _pullWorker(void *_task) {
     }
     airThreadBarrierWait(task->pctx->iterBarrierB);
   }
+  biffThreadLocalSet(AIR_FALSE);
 
   return _task;
 }
@@ -164,6 +328,10 @@ pullStart(pullContext *pctx) {
   }
 
   pctx->timeIteration = 0;
+  pctx->timeProcess = 0;
+  pctx->timeFinish = 0;
+  pctx->timeProcessTotal = 0;
+  pctx->timeFinishTotal = 0;
   pctx->timeRun = 0;
 
   return 0;
@@ -222,7 +390,7 @@ pullFinish(pullContext *pctx) {
 int
 _pullIterate(pullContext *pctx, int mode) {
   static const char me[]="_pullIterate";
-  double time0;
+  double time0, time1;
   int myError, E;
   unsigned int ti;
 
@@ -290,6 +458,7 @@ _pullIterate(pullContext *pctx, int mode) {
     airThreadBarrierWait(pctx->iterBarrierB);
   }
   if (pctx->finished) {
+    _pullTaskErrReport(pctx);
     if (!myError) {
       /* we didn't set finished- one of the workers must have */
       biffAddf(PULL, "%s: worker error on iter %u", me, pctx->iter);
@@ -303,6 +472,7 @@ _pullIterate(pullContext *pctx, int mode) {
   }
 
   /* depending on mode, run one of the iteration finishers */
+  time1 = airTime();
   E = 0;
   switch (mode) {
   case pullProcessModeDescent:
@@ -329,6 +499,15 @@ _pullIterate(pullContext *pctx, int mode) {
   }
 
   pctx->timeIteration = airTime() - time0;
+  pctx->timeProcess = time1 - time0;
+  pctx->timeFinish = pctx->timeIteration - pctx->timeProcess;
+  pctx->timeProcessTotal += pctx->timeProcess;
+  pctx->timeFinishTotal += pctx->timeFinish;
+  if (pctx->verbose) {
+    fprintf(stderr, "%s(%s): processing %g sec, finishing %g sec\n", me,
+            airEnumStr(pullProcessMode, mode),
+            pctx->timeProcess, pctx->timeFinish);
+  }
 
 #if PULL_HINTER
   if (pullProcessModeDescent == mode && pctx->nhinter) {
@@ -344,6 +523,22 @@ _pullIterate(pullContext *pctx, int mode) {
   return 0;
 }
 
+/*
+** records the state of an active pullRun() in the context
+*/
+static void
+_pullRunStateSet(pullContext *pctx, unsigned int iterFirst,
+                 int converged, double energyLast,
+                 double energyDecreaseAvg) {
+
+  pctx->runActive = AIR_TRUE;
+  pctx->runIterFirst = iterFirst;
+  pctx->runConverged = converged;
+  pctx->runEnergyLast = energyLast;
+  pctx->runEnergyDecreaseAvg = energyDecreaseAvg;
+  return;
+}
+
 int
 pullRun(pullContext *pctx) {
   static const char me[]="pullRun";
@@ -358,22 +553,37 @@ pullRun(pullContext *pctx) {
     fprintf(stderr, "%s: hello\n", me);
   }
   time0 = airTime();
-  firstIter = pctx->iter;
-  if (pctx->verbose) {
-    fprintf(stderr, "%s: doing priming iteration (iter now %u)\n", me,
-            pctx->iter);
-  }
-  if (_pullIterate(pctx, pullProcessModeDescent)) {
-    biffAddf(PULL, "%s: trouble on priming iter %u", me, pctx->iter);
-    return 1;
-  }
-  pctx->iter += 1;
-  enrLast = enrNew = _pullEnergyTotal(pctx);
-  if (pctx->verbose) {
-    fprintf(stderr, "%s: starting system energy = %g\n", me, enrLast);
+  if (pctx->runResume) {
+    /* carry on with the run that pullContextSnapshotRead() restored */
+    firstIter = pctx->runIterFirst;
+    enrLast = enrNew = pctx->runEnergyLast;
+    enrDecrease = 0;
+    enrDecreaseAvg = pctx->runEnergyDecreaseAvg;
+    converged = pctx->runConverged;
+    pctx->runResume = AIR_FALSE;
+    if (pctx->verbose) {
+      fprintf(stderr, "%s: resuming run (from iter %u) at iter %u, "
+              "energy = %g\n", me, firstIter, pctx->iter, enrLast);
+    }
+  } else {
+    firstIter = pctx->iter;
+    if (pctx->verbose) {
+      fprintf(stderr, "%s: doing priming iteration (iter now %u)\n", me,
+              pctx->iter);
+    }
+    if (_pullIterate(pctx, pullProcessModeDescent)) {
+      biffAddf(PULL, "%s: trouble on priming iter %u", me, pctx->iter);
+      return 1;
+    }
+    pctx->iter += 1;
+    enrLast = enrNew = _pullEnergyTotal(pctx);
+    if (pctx->verbose) {
+      fprintf(stderr, "%s: starting system energy = %g\n", me, enrLast);
+    }
+    enrDecrease = enrDecreaseAvg = 0;
+    converged = AIR_FALSE;
   }
-  enrDecrease = enrDecreaseAvg = 0;
-  converged = AIR_FALSE;
+  _pullRunStateSet(pctx, firstIter, converged, enrLast, enrDecreaseAvg);
   while ((pctx->iterParm.min && pctx->iter <= pctx->iterParm.min)
          ||
          ((!pctx->iterParm.max || pctx->iter < pctx->iterParm.max)
@@ -476,6 +686,8 @@ pullRun(pullContext *pctx) {
              enrDecreaseAvg, pctx->sysParm.energyDecreaseMin);
     }
     _pullPointStepEnergyScale(pctx, pctx->sysParm.opporStepScale);
+    /* so that the callback can save a snapshot from which to resume */
+    _pullRunStateSet(pctx, firstIter, converged, enrLast, enrDecreaseAvg);
     /* call the callback */
     if (!(pctx->iter % pctx->iterParm.callback)
         && pctx->iter_cb) {
@@ -490,9 +702,17 @@ pullRun(pullContext *pctx) {
            pctx->iter, enrNew, enrDecrease, enrDecreaseAvg, pctx->stuckNum);
   }
   time1 = airTime();
+  pctx->runActive = AIR_FALSE;
 
   pctx->timeRun += time1 - time0;
   pctx->energy = enrNew;
+  if (pctx->verbose) {
+    double tsum;
+    tsum = pctx->timeProcessTotal + pctx->timeFinishTotal;
+    printf("%s: so far, %g sec processing, %g sec (%g%%) finishing iters\n",
+           me, pctx->timeProcessTotal, pctx->timeFinishTotal,
+           100*pctx->timeFinishTotal/(tsum ? tsum : 1));
+  }
 
   /* we do one final neighbor-learn iteration, to set the fields
      (like stability) that are only learned then */
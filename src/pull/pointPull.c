@@ -27,6 +27,38 @@
 
 #define DEBUG 1
 
+/*
+** (re-)sets everything in a point except its idtag and arrays, the
+** way pullPointNew leaves them
+*/
+void
+_pullPointReset(const pullContext *pctx, pullPoint *pnt) {
+  unsigned int ii;
+
+  pnt->idCC = 0;
+  pnt->neighDistMean = 0;
+  ELL_10V_ZERO_SET(pnt->neighCovar);
+  pnt->stability = 0.0;
+#if PULL_TANCOVAR
+  ELL_6V_ZERO_SET(pnt->neighTanCovar);
+#endif
+  pnt->neighInterNum = 0;
+  pnt->stuckIterNum = 0;
+#if PULL_PHIST
+  airArrayLenSet(pnt->phistArr, 0);
+#endif
+  pnt->status = 0;
+  ELL_4V_SET(pnt->pos, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
+  pnt->energy = AIR_NAN;
+  ELL_4V_SET(pnt->force, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
+  pnt->stepEnergy = pctx->sysParm.stepInitial;
+  pnt->stepConstr = pctx->sysParm.stepInitial;
+  for (ii=0; ii<pctx->infoTotalLen; ii++) {
+    pnt->info[ii] = AIR_NAN;
+  }
+  return;
+}
+
 /*
 ** HEY: this has to be threadsafe, at least threadsafe when there
 ** are no errors, because this can now be called from multiple
@@ -36,7 +68,6 @@ pullPoint *
 pullPointNew(pullContext *pctx) {
   static const char me[]="pullPointNew";
   pullPoint *pnt;
-  unsigned int ii;
   size_t pntSize;
   pullPtrPtrUnion pppu;
 
@@ -59,7 +90,6 @@ pullPointNew(pullContext *pctx) {
   }
 
   pnt->idtag = pctx->idtagNext++;
-  pnt->idCC = 0;
   pnt->neighPoint = NULL;
   pnt->neighPointNum = 0;
   pppu.points = &(pnt->neighPoint);
@@ -67,14 +97,6 @@ pullPointNew(pullContext *pctx) {
                                    sizeof(pullPoint *),
                                    PULL_POINT_NEIGH_INCR);
   pnt->neighPointArr->noReallocWhenSmaller = AIR_TRUE;
-  pnt->neighDistMean = 0;
-  ELL_10V_ZERO_SET(pnt->neighCovar);
-  pnt->stability = 0.0;
-#if PULL_TANCOVAR
-  ELL_6V_ZERO_SET(pnt->neighTanCovar);
-#endif
-  pnt->neighInterNum = 0;
-  pnt->stuckIterNum = 0;
 #if PULL_PHIST
   pnt->phist = NULL;
   pnt->phistNum = 0;
@@ -82,15 +104,7 @@ pullPointNew(pullContext *pctx) {
                               &(pnt->phistNum),
                               _PHN*sizeof(double), 32);
 #endif
-  pnt->status = 0;
-  ELL_4V_SET(pnt->pos, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
-  pnt->energy = AIR_NAN;
-  ELL_4V_SET(pnt->force, AIR_NAN, AIR_NAN, AIR_NAN, AIR_NAN);
-  pnt->stepEnergy = pctx->sysParm.stepInitial;
-  pnt->stepConstr = pctx->sysParm.stepInitial;
-  for (ii=0; ii<pctx->infoTotalLen; ii++) {
-    pnt->info[ii] = AIR_NAN;
-  }
+  _pullPointReset(pctx, pnt);
   return pnt;
 }
 
@@ -105,6 +119,151 @@ pullPointNix(pullPoint *pnt) {
   return NULL;
 }
 
+/*
+** _pullTaskPointNew, _pullTaskPointRecycle: population control adds
+** and nixes points every iteration, so rather than free() a nixed
+** point, _pullTaskPointRecycle keeps it in the task's pool, from which
+** _pullTaskPointNew can take it (with a new idtag, and reset the way
+** pullPointNew would have left it) before resorting to pullPointNew.
+** Each task only touches its own pool, so no locking is needed. The
+** pools are trimmed by _pullTaskPoolTrim, and freed with the tasks.
+**
+** The neighbor lists of live points can still refer to a pooled point
+** (until the lists are next learned), so pooled points are marked for
+** nixing, which makes the energy computations pass over them. A pooled
+** point that a list refers to must not be re-used, or the list would
+** take the new point for a neighbor (maybe twice), so only the first
+** poolPointReuseNum points in the pool, which were pooled before all
+** lists were last learned (_pullIterFinishNeighLearn), are re-used.
+*/
+pullPoint *
+_pullTaskPointNew(pullTask *task) {
+  pullPoint *pnt;
+  unsigned int ri;
+
+  if (task->poolPointReuseNum) {
+    ri = --task->poolPointReuseNum;
+    pnt = task->poolPoint[ri];
+    /* keep the points pooled since then in order after the others */
+    memmove(task->poolPoint + ri, task->poolPoint + ri + 1,
+            (task->poolPointNum - ri - 1)*sizeof(pullPoint *));
+    airArrayLenIncr(task->poolPointArr, -1);
+    pnt->idtag = task->pctx->idtagNext++;
+    airArrayLenSet(pnt->neighPointArr, 0);
+    _pullPointReset(task->pctx, pnt);
+  } else {
+    pnt = pullPointNew(task->pctx);
+  }
+  return pnt;
+}
+
+void
+_pullTaskPointRecycle(pullTask *task, pullPoint *pnt) {
+  unsigned int idx;
+
+  idx = airArrayLenIncr(task->poolPointArr, 1);
+  if (task->poolPoint) {
+    pnt->status |= PULL_STATUS_NIXME_BIT;
+    task->poolPoint[idx] = pnt;
+  } else {
+    /* couldn't grow the pool; just free it */
+    pullPointNix(pnt);
+  }
+  return;
+}
+
+static int
+_pullPointPtrCompare(const void *_a, const void *_b) {
+  const pullPoint *a, *b;
+
+  a = *AIR_CAST(const pullPoint *const *, _a);
+  b = *AIR_CAST(const pullPoint *const *, _b);
+  return (a < b
+          ? -1
+          : (a > b
+             ? 1
+             : 0));
+}
+
+/*
+** _pullTaskPoolTrim: so that the pools don't hold on to every point
+** that was ever nixed (as when the population shrinks a lot), this
+** frees the oldest pooled points beyond each task's share of the live
+** points, which is about as many as one round of population control
+** could add.
+** Since neighbor lists can still refer to pooled points, those entries
+** are first removed from the lists of the live points (in the bins),
+** so this can only be called between iterations, and not while points
+** are being added.
+*/
+int
+_pullTaskPoolTrim(pullContext *pctx) {
+  static const char me[]="_pullTaskPoolTrim";
+  pullPoint **gone;
+  unsigned int poolMax, goneNum, taskIdx, binIdx, pointIdx, ii, nn;
+
+  poolMax = ((pullPointNumber(pctx) + pctx->threadNum - 1)
+             /pctx->threadNum);
+  goneNum = 0;
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    nn = pctx->task[taskIdx]->poolPointNum;
+    goneNum += nn > poolMax ? nn - poolMax : 0;
+  }
+  if (!goneNum) {
+    return 0;
+  }
+  gone = AIR_CALLOC(goneNum, pullPoint *);
+  if (!gone) {
+    biffAddf(PULL, "%s: couldn't allocate %u pointers", me, goneNum);
+    return 1;
+  }
+  goneNum = 0;
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    pullTask *task;
+    task = pctx->task[taskIdx];
+    /* the oldest ones go, since neighbor lists are least likely to
+       refer to them, and _pullTaskPointNew takes the newest of those
+       it may re-use */
+    for (ii=0; ii+poolMax<task->poolPointNum; ii++) {
+      gone[goneNum++] = task->poolPoint[ii];
+    }
+  }
+  qsort(gone, goneNum, sizeof(pullPoint *), _pullPointPtrCompare);
+  for (binIdx=0; binIdx<pctx->binNum; binIdx++) {
+    pullBin *bin;
+    bin = pctx->bin + binIdx;
+    for (pointIdx=0; pointIdx<bin->pointNum; pointIdx++) {
+      pullPoint *point;
+      point = bin->point[pointIdx];
+      nn = 0;
+      for (ii=0; ii<point->neighPointNum; ii++) {
+        if (!bsearch(point->neighPoint + ii, gone, goneNum,
+                     sizeof(pullPoint *), _pullPointPtrCompare)) {
+          point->neighPoint[nn++] = point->neighPoint[ii];
+        }
+      }
+      airArrayLenSet(point->neighPointArr, nn);
+    }
+  }
+  for (ii=0; ii<goneNum; ii++) {
+    pullPointNix(gone[ii]);
+  }
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    pullTask *task;
+    task = pctx->task[taskIdx];
+    nn = task->poolPointNum > poolMax ? task->poolPointNum - poolMax : 0;
+    task->poolPointReuseNum -= AIR_MIN(nn, task->poolPointReuseNum);
+    if (task->poolPointNum > poolMax) {
+      memmove(task->poolPoint,
+              task->poolPoint + task->poolPointNum - poolMax,
+              poolMax*sizeof(pullPoint *));
+      airArrayLenSet(task->poolPointArr, poolMax);
+    }
+  }
+  airFree(gone);
+  return 0;
+}
+
 #if PULL_PHIST
 void
 _pullPointHistInit(pullPoint *point) {
@@ -435,8 +594,7 @@ pullProbe(pullTask *task, pullPoint *point) {
       /* its after the 1st iteration (#0), and this vol is only for seeding */
       continue;
     }
-    /* HEY should task->vol[ii]->scaleNum be the using-scale-space test? */
-    if (!task->vol[ii]->ninScale) {
+    if (!task->vol[ii]->scaleNum) {
       /*
         if (81 == point->idtag) {
         printf("%s: probing vol[%u] @ %g %g %g\n", me, ii,
@@ -1198,7 +1356,7 @@ _pullPointSetup(pullContext *pctx) {
      seeders to determine placement along the scale axis */
   scaleVol = NULL;
   for (ii=0; ii<pctx->volNum; ii++) {
-    if (pctx->vol[ii]->ninScale) {
+    if (pctx->vol[ii]->scaleNum) {
       scaleVol = pctx->vol[ii];
       break;
     }
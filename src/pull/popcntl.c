@@ -171,7 +171,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
     return 0;
   }
   /* initial pos is good, now we start getting serious */
-  newpnt = pullPointNew(task->pctx);
+  newpnt = _pullTaskPointNew(task);
   if (!newpnt) {
     biffAddf(PULL, "%s: couldn't spawn new point from %u", me, point->idtag);
     return 1;
@@ -194,7 +194,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
       /* constraint satisfaction failed, which isn't an error for us,
          we just don't try to add this point.  Can do immediate nix
          because no neighbors know about this point. */
-      pullPointNix(newpnt);
+      _pullTaskPointRecycle(task, newpnt);
       return 0;
     }
     if (!_pullInsideBBox(task->pctx, newpnt->pos)) {
@@ -203,7 +203,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
                me, newpnt->idtag, newpnt->pos[0], newpnt->pos[1],
                newpnt->pos[2], newpnt->pos[3]);
       }
-      newpnt = pullPointNix(newpnt);
+      _pullTaskPointRecycle(task, newpnt);
       return 0;
     }
   }
@@ -227,7 +227,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
         printf("%s: possible newpnt %u stuck @ iter %u; nope\n", me,
                newpnt->idtag, iter);
       }
-      newpnt = pullPointNix(newpnt);
+      _pullTaskPointRecycle(task, newpnt);
       /* if we don't change the mode back, then pullBinProcess() won't
          know to try adding for the rest of the bins it sees, bad HACK */
       task->processMode = pullProcessModeAdding;
@@ -239,7 +239,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
                me, newpnt->idtag, newpnt->pos[0], newpnt->pos[1],
                newpnt->pos[2], newpnt->pos[3]);
       }
-      newpnt = pullPointNix(newpnt);
+      _pullTaskPointRecycle(task, newpnt);
       task->processMode = pullProcessModeAdding;
       return 0;
     }
@@ -251,7 +251,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
         printf("%s: newpnt %u went too far %g from old point %u; nope\n",
                me, newpnt->idtag, ELL_4V_LEN(diff), point->idtag);
       }
-      newpnt = pullPointNix(newpnt);
+      _pullTaskPointRecycle(task, newpnt);
       task->processMode = pullProcessModeAdding;
       return 0;
     }
@@ -273,7 +273,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
       && 0 > pullPointScalar(task->pctx, newpnt, pullInfoLiveThresh,
                              NULL, NULL)) {
     /* didn't meet threshold */
-    newpnt = pullPointNix(newpnt);
+    _pullTaskPointRecycle(task, newpnt);
     task->processMode = pullProcessModeAdding;
     return 0;
   }
@@ -281,7 +281,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
       && 0 > pullPointScalar(task->pctx, newpnt, pullInfoLiveThresh2,
                              NULL, NULL)) {
     /* didn't meet threshold */
-    newpnt = pullPointNix(newpnt);
+    _pullTaskPointRecycle(task, newpnt);
     task->processMode = pullProcessModeAdding;
     return 0;
   }
@@ -289,14 +289,14 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
       && 0 > pullPointScalar(task->pctx, newpnt, pullInfoLiveThresh3,
                              NULL, NULL)) {
     /* didn't meet threshold */
-    newpnt = pullPointNix(newpnt);
+    _pullTaskPointRecycle(task, newpnt);
     task->processMode = pullProcessModeAdding;
     return 0;
   }
   /* see if the new point should be nixed because its at a volume edge */
   if (task->pctx->flag.nixAtVolumeEdgeSpace
       && (newpnt->status & PULL_STATUS_EDGE_BIT)) {
-    newpnt = pullPointNix(newpnt);
+    _pullTaskPointRecycle(task, newpnt);
     task->processMode = pullProcessModeAdding;
     return 0;
   }
@@ -340,7 +340,7 @@ _pullPointProcessAdding(pullTask *task, pullBin *bin, pullPoint *point) {
       _pullEnergyFromPoints(task, bin, newpnt->neighPoint[npi], NULL);
     }
     task->processMode = pullProcessModeAdding;
-    newpnt = pullPointNix(newpnt);
+    _pullTaskPointRecycle(task, newpnt);
   }
   return 0;
 }
@@ -395,73 +395,157 @@ _pullPointProcessNixing(pullTask *task, pullBin *bin, pullPoint *point) {
   return 0;
 }
 
+/*
+** the neighbor lists of all the points in the bins were just learned
+** (from the bins), so no list refers to any point now in a pool, and
+** all of them can be re-used by the next adding
+*/
 int
 _pullIterFinishNeighLearn(pullContext *pctx) {
   static const char me[]="_pullIterFinishNeighLearn";
+  unsigned int taskIdx;
 
-  /* a no-op for now */
-  AIR_UNUSED(pctx);
   AIR_UNUSED(me);
-
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    pctx->task[taskIdx]->poolPointReuseNum
+      = pctx->task[taskIdx]->poolPointNum;
+  }
   return 0;
 }
 
+/*
+** new points are binned in parallel (by _pullBinsPointsAdd), with the
+** same outcome as binning them one at a time, in order of task and then
+** of place in the task's addPoint queue.  Dealing with the few points
+** that weren't added requires their neighbors to relearn neighbors,
+** from the bins as they were when the point was (in that order) turned
+** down.  So the points added after the first rejected one are taken
+** back out of the bins (they are last in their bins, in order), and
+** from there on points are again added, or rejected, one at a time.
+*/
 int
 _pullIterFinishAdding(pullContext *pctx) {
   static const char me[]="_pullIterFinishAdding";
-  unsigned int taskIdx;
+  unsigned int taskIdx, pointIdx, pointNum, rejIdx, *pointBin, *pointTask;
+  pullPoint **point;
+  unsigned char *added;
+  airArray *mop;
 
   pctx->addNum = 0;
+  pointNum = 0;
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    pointNum += pctx->task[taskIdx]->addPointNum;
+  }
+  if (!pointNum) {
+    return 0;
+  }
+  mop = airMopNew();
+  point = AIR_CALLOC(pointNum, pullPoint *);
+  airMopAdd(mop, point, airFree, airMopAlways);
+  pointBin = AIR_CALLOC(pointNum, unsigned int);
+  airMopAdd(mop, pointBin, airFree, airMopAlways);
+  pointTask = AIR_CALLOC(pointNum, unsigned int);
+  airMopAdd(mop, pointTask, airFree, airMopAlways);
+  added = AIR_CALLOC(pointNum, unsigned char);
+  airMopAdd(mop, added, airFree, airMopAlways);
+  if (!( point && pointBin && pointTask && added )) {
+    biffAddf(PULL, "%s: couldn't allocate buffers for %u new points",
+             me, pointNum);
+    airMopError(mop); return 1;
+  }
+  pointNum = 0;
   for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
     pullTask *task;
     task = pctx->task[taskIdx];
-    if (task->addPointNum) {
-      unsigned int pointIdx;
-      int added;
-      for (pointIdx=0; pointIdx<task->addPointNum; pointIdx++) {
-        pullPoint *point;
-        pullBin *bin;
-        point = task->addPoint[pointIdx];
-        point->status &= ~PULL_STATUS_NEWBIE_BIT;
-        if (pullBinsPointMaybeAdd(pctx, point, &bin, &added)) {
-          biffAddf(PULL, "%s: trouble binning new point %u", me, point->idtag);
-          return 1;
-        }
-        if (added) {
-          pctx->addNum++;
-        } else {
-          unsigned int npi, xpi;
-          if (pctx->verbose) {
-            printf("%s: decided NOT to add new point %u\n", me, point->idtag);
-          }
-          /* HEY: copied from above */
-          /* ugh, have to signal to neigs that its no longer their neighbor */
-          task->processMode = pullProcessModeNeighLearn;
-          point->status |= PULL_STATUS_NIXME_BIT;
-          for (npi=0; npi<point->neighPointNum; npi++) {
-            _pullEnergyFromPoints(task, bin, point->neighPoint[npi], NULL);
-          }
-          task->processMode = pullProcessModeAdding;
-          /* can't do immediate nix for reasons GLK doesn't quite understand */
-          xpi = airArrayLenIncr(task->nixPointArr, 1);
-          task->nixPoint[xpi] = point;
-        }
+    for (pointIdx=0; pointIdx<task->addPointNum; pointIdx++) {
+      point[pointNum] = task->addPoint[pointIdx];
+      point[pointNum]->status &= ~PULL_STATUS_NEWBIE_BIT;
+      pointTask[pointNum] = taskIdx;
+      pointNum++;
+    }
+  }
+  if (_pullBinsPointsAdd(pctx, point, pointNum, AIR_TRUE,
+                         pointBin, added)) {
+    biffAddf(PULL, "%s: trouble binning %u new points", me, pointNum);
+    airMopError(mop); return 1;
+  }
+  for (rejIdx=0; rejIdx<pointNum && added[rejIdx]; rejIdx++) {
+    pctx->addNum++;
+  }
+  /* undo binning of points after the first rejected one */
+  for (pointIdx=pointNum; pointIdx>rejIdx+1; pointIdx--) {
+    if (added[pointIdx-1]) {
+      pullBin *bin;
+      bin = pctx->bin + pointBin[pointIdx-1];
+      if (!( bin->pointNum
+             && point[pointIdx-1] == bin->point[bin->pointNum-1] )) {
+        biffAddf(PULL, "%s: new point %u not last in its bin %u", me,
+                 point[pointIdx-1]->idtag, pointBin[pointIdx-1]);
+        airMopError(mop); return 1;
       }
-      airArrayLenSet(task->addPointArr, 0);
+      airArrayLenIncr(bin->pointArr, -1);
+    }
+  }
+  for (pointIdx=rejIdx; pointIdx<pointNum; pointIdx++) {
+    pullBin *bin;
+    bin = pctx->bin + pointBin[pointIdx];
+    if (added[pointIdx]) {
+      /* (the first rejected point isn't added, so this is re-adding) */
+      if (_pullBinPointAdd(pctx, bin, point[pointIdx])) {
+        biffAddf(PULL, "%s: trouble re-binning new point %u", me,
+                 point[pointIdx]->idtag);
+        airMopError(mop); return 1;
+      }
+      pctx->addNum++;
+    } else {
+      pullTask *task;
+      pullPoint *pnt;
+      unsigned int npi, xpi;
+      pnt = point[pointIdx];
+      task = pctx->task[pointTask[pointIdx]];
+      if (pctx->verbose) {
+        printf("%s: decided NOT to add new point %u\n", me, pnt->idtag);
+      }
+      /* HEY: copied from above */
+      /* ugh, have to signal to neigs that its no longer their neighbor */
+      task->processMode = pullProcessModeNeighLearn;
+      pnt->status |= PULL_STATUS_NIXME_BIT;
+      for (npi=0; npi<pnt->neighPointNum; npi++) {
+        _pullEnergyFromPoints(task, bin, pnt->neighPoint[npi], NULL);
+      }
+      task->processMode = pullProcessModeAdding;
+      /* can't do immediate nix for reasons GLK doesn't quite understand */
+      xpi = airArrayLenIncr(task->nixPointArr, 1);
+      task->nixPoint[xpi] = pnt;
     }
   }
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    airArrayLenSet(pctx->task[taskIdx]->addPointArr, 0);
+  }
   if (pctx->verbose && pctx->addNum) {
     printf("%s: ADDED %u\n", me, pctx->addNum);
   }
+  airMopOkay(mop);
   return 0;
 }
 
-void
-_pullNixTheNixed(pullContext *pctx) {
-  unsigned int binIdx;
+typedef struct {
+  pullContext *pctx;
+  unsigned int jobNum,
+    *nixNum;         /* per-job: # points nixed */
+} _pullNixShared;
 
-  pctx->nixNum = 0;
-  for (binIdx=0; binIdx<pctx->binNum; binIdx++) {
+static int
+_pullNixJob(pullTask *task, void *_shared, unsigned int jobIdx) {
+  _pullNixShared *shared;
+  pullContext *pctx;
+  unsigned int blo, bhi, binIdx;
+
+  shared = AIR_CAST(_pullNixShared *, _shared);
+  pctx = shared->pctx;
+  _pullFinishJobRange(&blo, &bhi, jobIdx, shared->jobNum, pctx->binNum);
+  shared->nixNum[jobIdx] = 0;
+  for (binIdx=blo; binIdx<bhi; binIdx++) {
     pullBin *bin;
     unsigned int pointIdx;
     bin = pctx->bin + binIdx;
@@ -474,17 +558,48 @@ _pullNixTheNixed(pullContext *pctx) {
         point->status |= PULL_STATUS_NIXME_BIT;
       }
       if (point->status & PULL_STATUS_NIXME_BIT) {
-        pullPointNix(point);
+        _pullTaskPointRecycle(task, point);
         /* copy last point pointer to this slot */
         bin->point[pointIdx] = bin->point[bin->pointNum-1];
         airArrayLenIncr(bin->pointArr, -1); /* will decrement bin->pointNum */
-        pctx->nixNum++;
+        shared->nixNum[jobIdx]++;
       } else {
         pointIdx++;
       }
     }
   }
-  return;
+  return 0;
+}
+
+/*
+** removes the points marked for nixing from all bins (to be recycled
+** by the task that removed them); each bin is handled by one task, so
+** the tasks can do this in parallel
+*/
+int
+_pullNixTheNixed(pullContext *pctx) {
+  static const char me[]="_pullNixTheNixed";
+  _pullNixShared shared;
+  unsigned int jobIdx;
+
+  pctx->nixNum = 0;
+  shared.pctx = pctx;
+  shared.jobNum = _pullFinishJobNum(pctx, pctx->binNum);
+  shared.nixNum = AIR_CALLOC(shared.jobNum, unsigned int);
+  if (!shared.nixNum) {
+    biffAddf(PULL, "%s: couldn't allocate %u counts", me, shared.jobNum);
+    return 1;
+  }
+  if (_pullFinishRun(pctx, shared.jobNum, _pullNixJob, &shared)) {
+    biffAddf(PULL, "%s: trouble", me);
+    airFree(shared.nixNum);
+    return 1;
+  }
+  for (jobIdx=0; jobIdx<shared.jobNum; jobIdx++) {
+    pctx->nixNum += shared.nixNum[jobIdx];
+  }
+  airFree(shared.nixNum);
+  return 0;
 }
 
 int
@@ -492,7 +607,10 @@ _pullIterFinishNixing(pullContext *pctx) {
   static const char me[]="_pullIterFinishNixing";
   unsigned int taskIdx;
 
-  _pullNixTheNixed(pctx);
+  if (_pullNixTheNixed(pctx)) {
+    biffAddf(PULL, "%s: trouble nixing points", me);
+    return 1;
+  }
   /* finish nixing the things that we decided not to add */
   for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
     pullTask *task;
@@ -500,14 +618,17 @@ _pullIterFinishNixing(pullContext *pctx) {
     if (task->nixPointNum) {
       unsigned int xpi;
       for (xpi=0; xpi<task->nixPointNum; xpi++) {
-        pullPointNix(task->nixPoint[xpi]);
+        _pullTaskPointRecycle(task, task->nixPoint[xpi]);
       }
       airArrayLenSet(task->nixPointArr, 0);
     }
   }
+  if (_pullTaskPoolTrim(pctx)) {
+    biffAddf(PULL, "%s: trouble trimming pools", me);
+    return 1;
+  }
   if (pctx->verbose && pctx->nixNum) {
     printf("%s: NIXED %u\n", me, pctx->nixNum);
   }
   return 0;
 }
-
@@ -96,6 +96,29 @@ extern "C" {
 /* resolution of histogram of (r,s) coords of interactions ("hinter") */
 #define _PULL_HINTER_SIZE 601
 
+/* the parallel parts of finishing an iteration (rebinning, population
+   control) break their work into this many jobs per thread, to balance
+   the load across threads */
+#define _PULL_FINISH_JOB_PER_THREAD 8
+
+/*
+** a job of a parallel finishing phase, run by _pullFinishRun; task is
+** the task of the thread doing the job
+*/
+typedef int (_pullFinishJob_t)(pullTask *task, void *shared,
+                               unsigned int jobIdx);
+
+/*
+** what the tasks share while running _pullFinishRun
+*/
+typedef struct {
+  _pullFinishJob_t *job;
+  void *shared;
+  unsigned int jobNum,
+    jobNext;                  /* next job to hand out */
+  int error;                  /* some job returned non-zero */
+} _pullFinishCrew;
+
 /* initPull.c */
 extern void _pullInitParmInit(pullInitParm *initParm);
 extern int _pullInitParmCheck(pullInitParm *iparm);
@@ -163,6 +186,10 @@ extern void _pullPointHistAdd(pullPoint *point, int cond, double val);
 #define _pullPointHistInit(p)       /* no-op */
 #define _pullPointHistAdd(p, c, v)  /* no-op */
 #endif
+extern void _pullPointReset(const pullContext *pctx, pullPoint *pnt);
+extern pullPoint *_pullTaskPointNew(pullTask *task);
+extern void _pullTaskPointRecycle(pullTask *task, pullPoint *pnt);
+extern int _pullTaskPoolTrim(pullContext *pctx);
 extern double _pullStepInterAverage(const pullContext *pctx);
 extern double _pullStepConstrAverage(const pullContext *pctx);
 extern double _pullEnergyTotal(const pullContext *pctx);
@@ -180,12 +207,19 @@ extern int _pullPointProcessNixing(pullTask *task, pullBin *bin,
 extern int _pullIterFinishNeighLearn(pullContext *pctx);
 extern int _pullIterFinishAdding(pullContext *pctx);
 extern int _pullIterFinishNixing(pullContext *pctx);
-extern void _pullNixTheNixed(pullContext *pctx);
+extern int _pullNixTheNixed(pullContext *pctx);
 
 /* binningPull.c */
 extern void _pullBinInit(pullBin *bin);
 extern void _pullBinDone(pullBin *bin);
+extern unsigned int _pullBinIndex(const pullContext *pctx,
+                                  const double *pos);
 extern pullBin *_pullBinLocate(pullContext *pctx, double *pos);
+extern int _pullBinPointAdd(pullContext *pctx, pullBin *bin,
+                            pullPoint *point);
+extern int _pullBinsPointsAdd(pullContext *pctx, pullPoint **point,
+                              unsigned int pointNum, int maybe,
+                              unsigned int *binIdx, unsigned char *added);
 extern void _pullBinPointRemove(pullContext *pctx, pullBin *bin, int loseIdx);
 extern int _pullBinSetup(pullContext *pctx);
 extern int _pullIterFinishDescent(pullContext *pctx);
@@ -196,6 +230,13 @@ extern int _pullVerbose;
 extern int _pullProcess(pullTask *task);
 extern void *_pullWorker(void *_task);
 extern int _pullIterate(pullContext *pctx, int mode);
+extern unsigned int _pullFinishJobNum(const pullContext *pctx,
+                                      unsigned int workNum);
+extern void _pullFinishJobRange(unsigned int *loP, unsigned int *hiP,
+                                unsigned int jobIdx, unsigned int jobNum,
+                                unsigned int workNum);
+extern int _pullFinishRun(pullContext *pctx, unsigned int jobNum,
+                          _pullFinishJob_t *job, void *shared);
 
 #ifdef __cplusplus
 }
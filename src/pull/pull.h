@@ -456,6 +456,9 @@ typedef struct {
   const Nrrd *const *ninScale; /* don't own;
                                   NOTE: only one of ninSingle and ninScale
                                   can be non-NULL */
+  gageStackLazy *lazySS;       /* don't own; if non-NULL, the scale-space
+                                  samples are lazily blurred from
+                                  ninSingle, and ninScale is NULL */
   unsigned int scaleNum;       /* number of scale-space samples (volumes) */
   double *scalePos;            /* location of all samples in scale */
   int scaleDerivNorm;          /* normalize derivatives based on scale */
@@ -513,8 +516,20 @@ typedef struct pullTask_t {
   pullPoint **nixPoint;         /* points to nix before next iter */
   unsigned int nixPointNum;     /* # of points to nix */
   airArray *nixPointArr;        /* airArray around nixPoint, nixPointNum */
+  pullPoint **poolPoint;        /* points that were nixed, kept for re-use
+                                   (by population control) rather than
+                                   being freed and re-allocated */
+  unsigned int poolPointNum;    /* # of points in pool */
+  airArray *poolPointArr;       /* airArray around poolPoint, poolPointNum */
+  unsigned int poolPointReuseNum; /* # of points, at the start of the pool,
+                                   that were pooled before all neighbor
+                                   lists were last learned; only these
+                                   may be re-used */
   void *returnPtr;              /* for airThreadJoin */
   unsigned int stuckNum;        /* # stuck particles seen by this task */
+  char *err;                    /* with a worker thread (which has its own
+                                   biff store): its biff messages, kept for
+                                   the master thread to report */
 } pullTask;
 
 /*
@@ -881,7 +896,8 @@ typedef struct pullContext_t {
   pullVolume
     *vol[PULL_VOLUME_MAXNUM];      /* the volumes we analyze (we DO OWN),
                                       set by either pullVolumeSingleAdd()
-                                      or pullVolumeStackAdd() */
+                                      pullVolumeStackAdd(), or
+                                      pullVolumeStackLazyAdd() */
   unsigned int volNum;             /* actual length of vol[] used */
   pullInfoSpec
     *ispec[PULL_INFO_MAX+1];       /* info ii is in effect if ispec[ii] is
@@ -961,6 +977,10 @@ typedef struct pullContext_t {
   pullTask **task;                 /* dynamically allocated array of tasks */
   airThreadBarrier *iterBarrierA;  /* barriers between iterations */
   airThreadBarrier *iterBarrierB;  /* barriers between iterations */
+  void *finishCrew;                /* non-NULL (a _pullFinishCrew) while
+                                      the tasks are sharing the work of
+                                      finishing an iteration, instead of
+                                      processing bins */
 #if PULL_HINTER
   Nrrd *nhinter;                   /* 2-D histogram of (r,s)-space relative
                                       locations of interacting particles
@@ -969,10 +989,30 @@ typedef struct pullContext_t {
   FILE *logAdd;                    /* text-file record of all the particles
                                       that have been added
                                       (NOT thread-safe) */
+  int runActive,                   /* non-zero while pullRun() is iterating;
+                                      with the next four fields, this is the
+                                      state of pullRun() that a snapshot
+                                      needs to save (for resuming the run) */
+    runResume,                     /* non-zero if the next pullRun() should
+                                      carry on with the run recorded by
+                                      pullContextSnapshotRead(), rather than
+                                      starting with a priming iteration */
+    runConverged;                  /* pullRun()'s convergence test result */
+  unsigned int runIterFirst;       /* iter at which the run started */
+  double runEnergyLast,            /* system energy after last iteration */
+    runEnergyDecreaseAvg;          /* running average of energy decrease */
 
   /* OUTPUT ---------------------------- */
 
   double timeIteration,            /* time needed for last (single) iter */
+    timeProcess,                   /* time spent processing bins, and */
+    timeFinish,                    /* time spent in the iteration finisher
+                                      (population control, rebinning), in
+                                      last iter; both are within
+                                      timeIteration */
+    timeProcessTotal,              /* timeProcess, and */
+    timeFinishTotal,               /* timeFinish, summed over all iters
+                                      since pullStart() */
     timeRun,                       /* total time spent in pullRun() */
     energy;                        /* final energy of system */
   unsigned int addNum,             /* # prtls added by PopCntl in last iter */
@@ -1108,6 +1148,18 @@ PULL_EXPORT int pullVolumeStackAdd(pullContext *pctx,
                                    const NrrdKernelSpec *ksp11,
                                    const NrrdKernelSpec *ksp22,
                                    const NrrdKernelSpec *kspSS);
+PULL_EXPORT int pullVolumeStackLazyAdd(pullContext *pctx,
+                                       const gageKind *kind,
+                                       char *name,
+                                       const Nrrd *nin,
+                                       gageStackLazy *lazy,
+                                       double *scalePos,
+                                       int scaleDerivNorm,
+                                       double scaleDerivNormBias,
+                                       const NrrdKernelSpec *ksp00,
+                                       const NrrdKernelSpec *ksp11,
+                                       const NrrdKernelSpec *ksp22,
+                                       const NrrdKernelSpec *kspSS);
 PULL_EXPORT const pullVolume *pullVolumeLookup(const pullContext *pctx,
                                                const char *volName);
 PULL_EXPORT int pullConstraintScaleRange(pullContext *pctx,
@@ -1200,6 +1252,12 @@ PULL_EXPORT pullTraceMulti *pullTraceMultiNew(void);
 PULL_EXPORT pullTraceMulti *pullTraceMultiNix(pullTraceMulti *mtrc);
 PULL_EXPORT int pullTraceMultiAdd(pullTraceMulti *mtrc, pullTrace *trc,
                                   int *addedP);
+PULL_EXPORT int pullTraceMultiSet(pullContext *pctx, pullTraceMulti *mtrc,
+                                  int recordStrength, int sigmaNorm,
+                                  double scaleDelta, double halfScaleWin,
+                                  double velocityMax, unsigned int arrIncr,
+                                  const double *seedPos,
+                                  unsigned int seedNum);
 PULL_EXPORT int pullTraceMultiFilterConcaveDown(Nrrd *nfilt,
                                                 const pullTraceMulti *mtrc,
                                                 double winLenFrac);
@@ -1208,7 +1266,8 @@ PULL_EXPORT int pullTraceMultiPlotAdd(Nrrd *nplot,
                                       const Nrrd *nfilt, int strengthUse,
                                       unsigned int trcIdxMin,
                                       unsigned int trcNum);
-PULL_EXPORT int pullTraceMultiWrite(FILE *file, const pullTraceMulti *mtrc);
+PULL_EXPORT int pullTraceMultiWrite(FILE *file, const pullTraceMulti *mtrc,
+                                    int binary);
 PULL_EXPORT int pullTraceMultiRead(pullTraceMulti *mtrc, FILE *file);
 
 /* actionPull.c */
@@ -1223,6 +1282,10 @@ PULL_EXPORT int pullStart(pullContext *pctx);
 PULL_EXPORT int pullRun(pullContext *pctx);
 PULL_EXPORT int pullFinish(pullContext *pctx);
 
+/* snapshotPull.c */
+PULL_EXPORT int pullContextSnapshotWrite(FILE *file, const pullContext *pctx);
+PULL_EXPORT int pullContextSnapshotRead(pullContext *pctx, FILE *file);
+
 /* ccPull.c */
 PULL_EXPORT int pullCCFind(pullContext *pctx);
 PULL_EXPORT int pullCCMeasure(pullContext *pctx, Nrrd *nmeas,
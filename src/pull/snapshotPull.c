@@ -0,0 +1,667 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "pull.h"
+#include "privatePull.h"
+
+/*
+** A snapshot is everything about a started pullContext that changes
+** as it iterates: the points (and which bins they're in, in what order),
+** the RNG state of every task, the iteration counters, and the state of
+** pullRun(). Everything that is set up before pullStart() (volumes,
+** infos, parameters) is NOT saved; to resume, set up the context in the
+** same way, call pullStart(), and then pullContextSnapshotRead().
+**
+** The format is a short text header, followed by native-endian binary
+** data:
+**   taskNum RNG states (AIR_RANDMT_N+2 unsigned ints each)
+**   pointNum fixed-size point records (see _snapPointPack)
+**   the fixed-size records of the points in each task's pool of nixed
+**     points (poolNum[taskIdx] of them for task taskIdx)
+**   neighNum unsigned ints: indices (into all the point records) of the
+**     points' neighbors, in the order of the points
+** The pools are saved because neighbor lists can still refer to points
+** that have been nixed (and recycled into a pool) since the lists were
+** learned; those entries are used (as the uninterrupted run would use
+** them) and so are kept. The neighbor lists of pooled points are not
+** saved, since they are emptied when the point is re-used.
+** Because the point records are all the same size, the point data can
+** be used in place (or seeked into) once the file is read.
+*/
+
+#define PULL_SNAP_MAGIC "PULLSNAP0002"
+
+/* # of unsigned ints, floats, and (not counting info) doubles in
+   each point's record; the sizes in bytes are all multiples of 8 */
+#define _SNAP_UINT_NUM 8
+#define _SNAP_FLOAT_NUM 18
+#define _SNAP_DOUBLE_NUM 12
+
+/* # of unsigned ints for each task's RNG */
+#define _SNAP_RNG_NUM (AIR_RANDMT_N + 2)
+
+static size_t
+_snapRecordSize(unsigned int infoLen) {
+
+  return (_SNAP_UINT_NUM*sizeof(unsigned int)
+          + _SNAP_FLOAT_NUM*sizeof(float)
+          + (_SNAP_DOUBLE_NUM + infoLen)*sizeof(double));
+}
+
+static void
+_snapPointPack(unsigned char *rec, const pullPoint *pnt,
+               unsigned int infoLen, unsigned int binIdx,
+               unsigned int neighNum) {
+  unsigned int uu[_SNAP_UINT_NUM];
+  float ff[_SNAP_FLOAT_NUM];
+  double dd[_SNAP_DOUBLE_NUM];
+  unsigned int ii;
+
+  uu[0] = pnt->idtag;
+  uu[1] = pnt->idCC;
+  uu[2] = AIR_UINT(pnt->status);
+  uu[3] = pnt->neighInterNum;
+  uu[4] = pnt->stuckIterNum;
+  uu[5] = neighNum;
+  uu[6] = binIdx;
+  uu[7] = 0;
+  for (ii=0; ii<_SNAP_FLOAT_NUM; ii++) {
+    ff[ii] = 0;
+  }
+  for (ii=0; ii<10; ii++) {
+    ff[ii] = pnt->neighCovar[ii];
+  }
+#if PULL_TANCOVAR
+  for (ii=0; ii<6; ii++) {
+    ff[10 + ii] = pnt->neighTanCovar[ii];
+  }
+#endif
+  ff[16] = pnt->stability;
+  ELL_4V_COPY(dd + 0, pnt->pos);
+  dd[4] = pnt->energy;
+  ELL_4V_COPY(dd + 5, pnt->force);
+  dd[9] = pnt->stepEnergy;
+  dd[10] = pnt->stepConstr;
+  dd[11] = pnt->neighDistMean;
+  memcpy(rec, uu, sizeof(uu));
+  rec += sizeof(uu);
+  memcpy(rec, ff, sizeof(ff));
+  rec += sizeof(ff);
+  memcpy(rec, dd, sizeof(dd));
+  rec += sizeof(dd);
+  memcpy(rec, pnt->info, infoLen*sizeof(double));
+  return;
+}
+
+static void
+_snapPointUnpack(pullPoint *pnt, unsigned int *binIdxP,
+                 unsigned int *neighNumP, const unsigned char *rec,
+                 unsigned int infoLen) {
+  unsigned int uu[_SNAP_UINT_NUM];
+  float ff[_SNAP_FLOAT_NUM];
+  double dd[_SNAP_DOUBLE_NUM];
+  unsigned int ii;
+
+  memcpy(uu, rec, sizeof(uu));
+  rec += sizeof(uu);
+  memcpy(ff, rec, sizeof(ff));
+  rec += sizeof(ff);
+  memcpy(dd, rec, sizeof(dd));
+  rec += sizeof(dd);
+  memcpy(pnt->info, rec, infoLen*sizeof(double));
+  pnt->idtag = uu[0];
+  pnt->idCC = uu[1];
+  pnt->status = AIR_INT(uu[2]);
+  pnt->neighInterNum = uu[3];
+  pnt->stuckIterNum = uu[4];
+  *neighNumP = uu[5];
+  *binIdxP = uu[6];
+  for (ii=0; ii<10; ii++) {
+    pnt->neighCovar[ii] = ff[ii];
+  }
+#if PULL_TANCOVAR
+  for (ii=0; ii<6; ii++) {
+    pnt->neighTanCovar[ii] = ff[10 + ii];
+  }
+#endif
+  pnt->stability = ff[16];
+  ELL_4V_COPY(pnt->pos, dd + 0);
+  pnt->energy = dd[4];
+  ELL_4V_COPY(pnt->force, dd + 5);
+  pnt->stepEnergy = dd[9];
+  pnt->stepConstr = dd[10];
+  pnt->neighDistMean = dd[11];
+  return;
+}
+
+typedef struct {
+  const pullPoint *point;
+  unsigned int idx;
+} _snapPointIdx;
+
+static int
+_snapPointIdxCompare(const void *_a, const void *_b) {
+  const _snapPointIdx *a, *b;
+
+  a = AIR_CAST(const _snapPointIdx *, _a);
+  b = AIR_CAST(const _snapPointIdx *, _b);
+  return (a->point < b->point
+          ? -1
+          : (a->point > b->point
+             ? 1
+             : 0));
+}
+
+/*
+******** pullContextSnapshotWrite
+**
+** saves (to file) the state of a started pullContext, from which
+** pullContextSnapshotRead can resume. This can be called between
+** iterations, which means from the pullContext->iter_cb callback (to
+** checkpoint a pullRun() in progress), or after pullRun() returns.
+**
+** It is an error for a point's neighbor list to refer to something that
+** is neither a point in the system nor a point in a task's pool.
+*/
+int
+pullContextSnapshotWrite(FILE *file, const pullContext *pctx) {
+  static const char me[]="pullContextSnapshotWrite";
+  unsigned int pointNum, pointIdx, binIdx, taskIdx, neighIdx, neighNum,
+    *neighIdxArr, *neighNumArr, *pointBin, rng[_SNAP_RNG_NUM], infoLen, ci,
+    poolTotal, allNum;
+  _snapPointIdx *pidx, *found, key;
+  const pullPoint **point;
+  unsigned char *rec;
+  size_t recSize;
+  airArray *mop;
+  pullBin *bin;
+
+  if (!(file && pctx)) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!pctx->task) {
+    biffAddf(PULL, "%s: NULL task array, didn't call pullStart()?", me);
+    return 1;
+  }
+
+  /* learn points in bin order, then the pooled points in task order,
+     and the points' neighbors' indices */
+  mop = airMopNew();
+  pointNum = pullPointNumber(pctx);
+  poolTotal = 0;
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    poolTotal += pctx->task[taskIdx]->poolPointNum;
+  }
+  allNum = pointNum + poolTotal;
+  infoLen = pctx->infoTotalLen;
+  recSize = _snapRecordSize(infoLen);
+  point = AIR_CALLOC(allNum, const pullPoint *);
+  airMopAdd(mop, AIR_CAST(void *, point), airFree, airMopAlways);
+  pointBin = AIR_CALLOC(pointNum, unsigned int);
+  airMopAdd(mop, pointBin, airFree, airMopAlways);
+  pidx = AIR_CALLOC(allNum, _snapPointIdx);
+  airMopAdd(mop, pidx, airFree, airMopAlways);
+  neighNumArr = AIR_CALLOC(pointNum, unsigned int);
+  airMopAdd(mop, neighNumArr, airFree, airMopAlways);
+  rec = AIR_CALLOC(recSize, unsigned char);
+  airMopAdd(mop, rec, airFree, airMopAlways);
+  if (!( rec && (!allNum || (point && pidx))
+         && (!pointNum || (pointBin && neighNumArr)) )) {
+    biffAddf(PULL, "%s: couldn't allocate buffers for %u points",
+             me, allNum);
+    airMopError(mop); return 1;
+  }
+  pointIdx = 0;
+  neighNum = 0;
+  for (binIdx=0; binIdx<pctx->binNum; binIdx++) {
+    unsigned int pi;
+    bin = pctx->bin + binIdx;
+    for (pi=0; pi<bin->pointNum; pi++) {
+      point[pointIdx] = bin->point[pi];
+      pointBin[pointIdx] = binIdx;
+      pidx[pointIdx].point = bin->point[pi];
+      pidx[pointIdx].idx = pointIdx;
+      neighNum += bin->point[pi]->neighPointNum;
+      pointIdx++;
+    }
+  }
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    const pullTask *task;
+    unsigned int pi;
+    task = pctx->task[taskIdx];
+    for (pi=0; pi<task->poolPointNum; pi++) {
+      point[pointIdx] = task->poolPoint[pi];
+      pidx[pointIdx].point = task->poolPoint[pi];
+      pidx[pointIdx].idx = pointIdx;
+      pointIdx++;
+    }
+  }
+  qsort(pidx, allNum, sizeof(_snapPointIdx), _snapPointIdxCompare);
+  neighIdxArr = AIR_CALLOC(AIR_MAX(1, neighNum), unsigned int);
+  airMopAdd(mop, neighIdxArr, airFree, airMopAlways);
+  if (!neighIdxArr) {
+    biffAddf(PULL, "%s: couldn't allocate %u neighbor indices",
+             me, neighNum);
+    airMopError(mop); return 1;
+  }
+  /* the neighbor lists can refer to points that were since nixed, so
+     the pointers are looked up among all the points, live and pooled */
+  neighNum = 0;
+  for (pointIdx=0; pointIdx<pointNum; pointIdx++) {
+    for (neighIdx=0; neighIdx<point[pointIdx]->neighPointNum; neighIdx++) {
+      key.point = point[pointIdx]->neighPoint[neighIdx];
+      found = AIR_CAST(_snapPointIdx *,
+                       bsearch(&key, pidx, allNum, sizeof(_snapPointIdx),
+                               _snapPointIdxCompare));
+      if (!found) {
+        biffAddf(PULL, "%s: neighbor %u of point %u (idtag %u) is "
+                 "neither a point nor a pooled point", me, neighIdx,
+                 pointIdx, point[pointIdx]->idtag);
+        airMopError(mop); return 1;
+      }
+      neighIdxArr[neighNum++] = found->idx;
+    }
+    neighNumArr[pointIdx] = point[pointIdx]->neighPointNum;
+  }
+
+  fprintf(file, "%s\n", PULL_SNAP_MAGIC);
+  fprintf(file, "endian: %s\n", airEnumStr(airEndian, airMyEndian()));
+  fprintf(file, "point num: %u\n", pointNum);
+  fprintf(file, "info len: %u\n", infoLen);
+  fprintf(file, "bins: %u %u %u %u\n", pctx->binsEdge[0],
+          pctx->binsEdge[1], pctx->binsEdge[2], pctx->binsEdge[3]);
+  fprintf(file, "neigh num: %u\n", neighNum);
+  fprintf(file, "task num: %u\n", pctx->threadNum);
+  fprintf(file, "pool num:");
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    fprintf(file, " %u", pctx->task[taskIdx]->poolPointNum);
+  }
+  fprintf(file, "\n");
+  fprintf(file, "iter: %u\n", pctx->iter);
+  fprintf(file, "idtag next: %u\n", pctx->idtagNext);
+  fprintf(file, "halton offset: %u\n", pctx->haltonOffset);
+  fprintf(file, "add nix stuck CC num: %u %u %u %u\n", pctx->addNum,
+          pctx->nixNum, pctx->stuckNum, pctx->CCNum);
+  fprintf(file, "energy increase permit: %.17g\n",
+          pctx->sysParm.energyIncreasePermit);
+  fprintf(file, "energy: %.17g\n", pctx->energy);
+  fprintf(file, "time run: %.17g\n", pctx->timeRun);
+  fprintf(file, "run: %d %u %d %.17g %.17g\n", pctx->runActive,
+          pctx->runIterFirst, pctx->runConverged, pctx->runEnergyLast,
+          pctx->runEnergyDecreaseAvg);
+  fprintf(file, "count:");
+  for (ci=0; ci<=PULL_COUNT_MAX; ci++) {
+    fprintf(file, " %u", pctx->count[ci]);
+  }
+  fprintf(file, "\n\n");
+
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    const airRandMTState *rst;
+    rst = pctx->task[taskIdx]->rng;
+    memcpy(rng, rst->state, AIR_RANDMT_N*sizeof(unsigned int));
+    rng[AIR_RANDMT_N] = AIR_UINT(rst->pNext - rst->state);
+    rng[AIR_RANDMT_N+1] = rst->left;
+    if (_SNAP_RNG_NUM != fwrite(rng, sizeof(unsigned int),
+                                _SNAP_RNG_NUM, file)) {
+      biffAddf(PULL, "%s: couldn't write RNG of task %u", me, taskIdx);
+      airMopError(mop); return 1;
+    }
+  }
+  for (pointIdx=0; pointIdx<pointNum; pointIdx++) {
+    _snapPointPack(rec, point[pointIdx], infoLen, pointBin[pointIdx],
+                   neighNumArr[pointIdx]);
+    if (1 != fwrite(rec, recSize, 1, file)) {
+      biffAddf(PULL, "%s: couldn't write point %u", me, pointIdx);
+      airMopError(mop); return 1;
+    }
+  }
+  for (pointIdx=pointNum; pointIdx<allNum; pointIdx++) {
+    _snapPointPack(rec, point[pointIdx], infoLen, 0, 0);
+    if (1 != fwrite(rec, recSize, 1, file)) {
+      biffAddf(PULL, "%s: couldn't write pooled point %u", me,
+               pointIdx - pointNum);
+      airMopError(mop); return 1;
+    }
+  }
+  if (neighNum != fwrite(neighIdxArr, sizeof(unsigned int), neighNum,
+                         file)) {
+    biffAddf(PULL, "%s: couldn't write %u neighbor indices", me, neighNum);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** reads a header line, which has to start with "<key>: ", and returns
+** a pointer to the rest of the line, or NULL if there was a problem
+*/
+static const char *
+_snapLine(char *line, FILE *file, const char *key) {
+  static const char me[]="_snapLine";
+  size_t keyLen;
+
+  if (!airOneLine(file, line, AIR_STRLEN_LARGE)) {
+    biffAddf(PULL, "%s: hit EOF before \"%s\" line", me, key);
+    return NULL;
+  }
+  keyLen = strlen(key);
+  if (strncmp(line, key, keyLen) || strncmp(line + keyLen, ": ", 2)) {
+    biffAddf(PULL, "%s: line \"%s\" isn't \"%s\" line", me, line, key);
+    return NULL;
+  }
+  return line + keyLen + 2;
+}
+
+/* SSCANF is the parenthesized arguments to sscanf, starting with str */
+#define SNAP_LINE(KEY, NUM, SSCANF)                                  \
+  if (!(str = _snapLine(line, file, KEY))                            \
+      || NUM != sscanf SSCANF) {                                     \
+    biffAddf(PULL, "%s: couldn't parse " KEY " line", me);           \
+    airMopError(mop); return 1;                                      \
+  }
+
+/*
+******** pullContextSnapshotRead
+**
+** restores a pullContext to the state saved by pullContextSnapshotWrite.
+** The context has to have been set up just as the one that was saved,
+** and pullStart()ed (possibly with pullFlagStartSkipsPoints, since any
+** existing points are discarded). If the snapshot was taken during
+** pullRun(), the next pullRun() picks up where that run left off, which
+** (with a single thread) gives the same results as the run would have
+** if it hadn't been interrupted.
+**
+** The file is fully read and checked before the context is changed.
+*/
+int
+pullContextSnapshotRead(pullContext *pctx, FILE *file) {
+  static const char me[]="pullContextSnapshotRead";
+  char line[AIR_STRLEN_LARGE], endianStr[AIR_STRLEN_SMALL];
+  const char *str;
+  unsigned int pointNum, infoLen, binsEdge[4], neighNum, taskNum, iter,
+    idtagNext, haltonOffset, addNum, nixNum, stuckNum, CCNum,
+    count[PULL_COUNT_MAX+1], runIterFirst, *rng, *neighIdxArr, pointIdx,
+    binIdx, neighIdx, taskIdx, ci, *poolNum, poolTotal, allNum;
+  int runActive, runConverged;
+  double eip, energy, timeRun, runEnergyLast, runEnergyDecreaseAvg;
+  unsigned char *rec;
+  size_t recSize;
+  pullPoint **point;
+  airArray *mop;
+  pullBin *bin;
+
+  if (!(pctx && file)) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!pctx->task) {
+    biffAddf(PULL, "%s: NULL task array, didn't call pullStart()?", me);
+    return 1;
+  }
+  mop = airMopNew();
+  if (!airOneLine(file, line, AIR_STRLEN_LARGE)
+      || strcmp(line, PULL_SNAP_MAGIC)) {
+    biffAddf(PULL, "%s: didn't see magic \"%s\"", me, PULL_SNAP_MAGIC);
+    airMopError(mop); return 1;
+  }
+  /* AIR_STRLEN_SMALL == 129 */
+  SNAP_LINE("endian", 1, (str, "%128s", endianStr));
+  if (airMyEndian() != airEnumVal(airEndian, endianStr)) {
+    biffAddf(PULL, "%s: snapshot is %s endian, but this is %s endian", me,
+             endianStr, airEnumStr(airEndian, airMyEndian()));
+    airMopError(mop); return 1;
+  }
+  SNAP_LINE("point num", 1, (str, "%u", &pointNum));
+  SNAP_LINE("info len", 1, (str, "%u", &infoLen));
+  SNAP_LINE("bins", 4, (str, "%u %u %u %u", binsEdge + 0, binsEdge + 1,
+                          binsEdge + 2, binsEdge + 3));
+  SNAP_LINE("neigh num", 1, (str, "%u", &neighNum));
+  SNAP_LINE("task num", 1, (str, "%u", &taskNum));
+  poolNum = AIR_CALLOC(AIR_MAX(1, taskNum), unsigned int);
+  airMopAdd(mop, poolNum, airFree, airMopAlways);
+  if (!poolNum) {
+    biffAddf(PULL, "%s: couldn't allocate for %u tasks", me, taskNum);
+    airMopError(mop); return 1;
+  }
+  if (!(str = _snapLine(line, file, "pool num"))
+      || taskNum != airParseStrUI(poolNum, str, " ", taskNum)) {
+    biffAddf(PULL, "%s: couldn't parse %u numbers from pool num line",
+             me, taskNum);
+    airMopError(mop); return 1;
+  }
+  poolTotal = 0;
+  for (taskIdx=0; taskIdx<taskNum; taskIdx++) {
+    poolTotal += poolNum[taskIdx];
+  }
+  SNAP_LINE("iter", 1, (str, "%u", &iter));
+  SNAP_LINE("idtag next", 1, (str, "%u", &idtagNext));
+  SNAP_LINE("halton offset", 1, (str, "%u", &haltonOffset));
+  SNAP_LINE("add nix stuck CC num", 4, (str, "%u %u %u %u", &addNum,
+                                          &nixNum, &stuckNum, &CCNum));
+  SNAP_LINE("energy increase permit", 1, (str, "%lg", &eip));
+  SNAP_LINE("energy", 1, (str, "%lg", &energy));
+  SNAP_LINE("time run", 1, (str, "%lg", &timeRun));
+  SNAP_LINE("run", 5, (str, "%d %u %d %lg %lg", &runActive,
+                        &runIterFirst, &runConverged, &runEnergyLast,
+                        &runEnergyDecreaseAvg));
+  if (!(str = _snapLine(line, file, "count"))) {
+    biffAddf(PULL, "%s: couldn't parse count line", me);
+    airMopError(mop); return 1;
+  }
+  if (PULL_COUNT_MAX+1 != airParseStrUI(count, str, " ",
+                                        PULL_COUNT_MAX+1)) {
+    biffAddf(PULL, "%s: didn't see %u counts in \"%s\"", me,
+             PULL_COUNT_MAX+1, str);
+    airMopError(mop); return 1;
+  }
+  if (1 != airOneLine(file, line, AIR_STRLEN_LARGE)) {
+    biffAddf(PULL, "%s: didn't see blank line at end of header", me);
+    airMopError(mop); return 1;
+  }
+  if (infoLen != pctx->infoTotalLen) {
+    biffAddf(PULL, "%s: snapshot info length %u != context's %u "
+             "(different infos?)", me, infoLen, pctx->infoTotalLen);
+    airMopError(mop); return 1;
+  }
+  if (!ELL_4V_EQUAL(binsEdge, pctx->binsEdge)) {
+    biffAddf(PULL, "%s: snapshot bins %u %u %u %u != context's "
+             "%u %u %u %u (different volumes or parameters?)", me,
+             binsEdge[0], binsEdge[1], binsEdge[2], binsEdge[3],
+             pctx->binsEdge[0], pctx->binsEdge[1],
+             pctx->binsEdge[2], pctx->binsEdge[3]);
+    airMopError(mop); return 1;
+  }
+
+  /* read and check all the binary data */
+  allNum = pointNum + poolTotal;
+  recSize = _snapRecordSize(infoLen);
+  rng = AIR_CALLOC(AIR_MAX(1, taskNum)*_SNAP_RNG_NUM, unsigned int);
+  airMopAdd(mop, rng, airFree, airMopAlways);
+  rec = AIR_CALLOC(AIR_MAX(1, allNum)*recSize, unsigned char);
+  airMopAdd(mop, rec, airFree, airMopAlways);
+  neighIdxArr = AIR_CALLOC(AIR_MAX(1, neighNum), unsigned int);
+  airMopAdd(mop, neighIdxArr, airFree, airMopAlways);
+  point = AIR_CALLOC(AIR_MAX(1, allNum), pullPoint *);
+  airMopAdd(mop, point, airFree, airMopAlways);
+  if (!(rng && rec && neighIdxArr && point)) {
+    biffAddf(PULL, "%s: couldn't allocate buffers for %u points", me,
+             allNum);
+    airMopError(mop); return 1;
+  }
+  if (taskNum*_SNAP_RNG_NUM != fread(rng, sizeof(unsigned int),
+                                     taskNum*_SNAP_RNG_NUM, file)
+      || allNum != fread(rec, recSize, allNum, file)
+      || neighNum != fread(neighIdxArr, sizeof(unsigned int),
+                           neighNum, file)) {
+    biffAddf(PULL, "%s: couldn't read data for %u tasks, %u points "
+             "(%u pooled), and %u neighbors", me, taskNum, allNum,
+             poolTotal, neighNum);
+    airMopError(mop); return 1;
+  }
+  for (taskIdx=0; taskIdx<taskNum; taskIdx++) {
+    if (!( rng[_SNAP_RNG_NUM*taskIdx + AIR_RANDMT_N] <= AIR_RANDMT_N )) {
+      biffAddf(PULL, "%s: bad RNG state for task %u", me, taskIdx);
+      airMopError(mop); return 1;
+    }
+  }
+  for (neighIdx=0; neighIdx<neighNum; neighIdx++) {
+    if (!( neighIdxArr[neighIdx] < allNum )) {
+      biffAddf(PULL, "%s: neighbor %u index %u not < #points %u", me,
+               neighIdx, neighIdxArr[neighIdx], allNum);
+      airMopError(mop); return 1;
+    }
+  }
+
+  /* out with the old points */
+  for (binIdx=0; binIdx<pctx->binNum; binIdx++) {
+    bin = pctx->bin + binIdx;
+    for (pointIdx=0; pointIdx<bin->pointNum; pointIdx++) {
+      bin->point[pointIdx] = pullPointNix(bin->point[pointIdx]);
+    }
+    if (bin->pointArr) {
+      airArrayLenSet(bin->pointArr, 0);
+    }
+  }
+  for (taskIdx=0; taskIdx<pctx->threadNum; taskIdx++) {
+    pullTask *task;
+    unsigned int pi;
+    task = pctx->task[taskIdx];
+    for (pi=0; pi<task->poolPointNum; pi++) {
+      pullPointNix(task->poolPoint[pi]);
+    }
+    airArrayLenSet(task->poolPointArr, 0);
+    /* the saved neighbor lists can refer to any of the pooled points */
+    task->poolPointReuseNum = 0;
+  }
+  /* in with the new; as each point is added to its bin (or pool) before
+     the next is created, the bins and pools own everything if there's
+     an error */
+  neighIdx = 0;
+  for (pointIdx=0; pointIdx<pointNum; pointIdx++) {
+    unsigned int pnn;
+    if (!(point[pointIdx] = pullPointNew(pctx))) {
+      biffAddf(PULL, "%s: couldn't create point %u", me, pointIdx);
+      airMopError(mop); return 1;
+    }
+    _snapPointUnpack(point[pointIdx], &binIdx, &pnn,
+                     rec + pointIdx*recSize, infoLen);
+    if (!( binIdx < pctx->binNum && neighIdx + pnn <= neighNum )) {
+      biffAddf(PULL, "%s: point %u bin %u (of %u) or neighbors "
+               "[%u,%u) (of %u) out of range", me, pointIdx,
+               binIdx, pctx->binNum, neighIdx, neighIdx + pnn, neighNum);
+      point[pointIdx] = pullPointNix(point[pointIdx]);
+      airMopError(mop); return 1;
+    }
+    if (_pullBinPointAdd(pctx, pctx->bin + binIdx, point[pointIdx])) {
+      biffAddf(PULL, "%s: couldn't bin point %u", me, pointIdx);
+      point[pointIdx] = pullPointNix(point[pointIdx]);
+      airMopError(mop); return 1;
+    }
+    airArrayLenSet(point[pointIdx]->neighPointArr, pnn);
+    if (pnn && !point[pointIdx]->neighPoint) {
+      biffAddf(PULL, "%s: couldn't allocate %u neighbors of point %u",
+               me, pnn, pointIdx);
+      airMopError(mop); return 1;
+    }
+    neighIdx += pnn;
+  }
+  /* the pools of tasks that aren't here now go to task 0 */
+  pointIdx = pointNum;
+  for (taskIdx=0; taskIdx<taskNum; taskIdx++) {
+    pullTask *task;
+    unsigned int pi, pnn, ppi;
+    task = pctx->task[taskIdx < pctx->threadNum ? taskIdx : 0];
+    for (pi=0; pi<poolNum[taskIdx]; pi++) {
+      if (!(point[pointIdx] = pullPointNew(pctx))) {
+        biffAddf(PULL, "%s: couldn't create pooled point %u", me,
+                 pointIdx - pointNum);
+        airMopError(mop); return 1;
+      }
+      /* (no bin, and no saved neighbors) */
+      _snapPointUnpack(point[pointIdx], &binIdx, &pnn,
+                       rec + pointIdx*recSize, infoLen);
+      ppi = airArrayLenIncr(task->poolPointArr, 1);
+      if (!task->poolPoint) {
+        biffAddf(PULL, "%s: couldn't pool point %u", me,
+                 pointIdx - pointNum);
+        point[pointIdx] = pullPointNix(point[pointIdx]);
+        airMopError(mop); return 1;
+      }
+      task->poolPoint[ppi] = point[pointIdx];
+      pointIdx++;
+    }
+  }
+  if (neighIdx != neighNum) {
+    biffAddf(PULL, "%s: points have %u neighbors, not %u",
+             me, neighIdx, neighNum);
+    airMopError(mop); return 1;
+  }
+  neighIdx = 0;
+  for (pointIdx=0; pointIdx<pointNum; pointIdx++) {
+    unsigned int ni;
+    for (ni=0; ni<point[pointIdx]->neighPointNum; ni++) {
+      point[pointIdx]->neighPoint[ni] = point[neighIdxArr[neighIdx++]];
+    }
+  }
+  if (taskNum != pctx->threadNum && pctx->verbose) {
+    fprintf(stderr, "%s: WARNING: snapshot had %u tasks but now have %u; "
+            "will not exactly reproduce original run\n", me, taskNum,
+            pctx->threadNum);
+  }
+  for (taskIdx=0; taskIdx<AIR_MIN(taskNum, pctx->threadNum); taskIdx++) {
+    airRandMTState *rst;
+    const unsigned int *trng;
+    rst = pctx->task[taskIdx]->rng;
+    trng = rng + _SNAP_RNG_NUM*taskIdx;
+    memcpy(rst->state, trng, AIR_RANDMT_N*sizeof(unsigned int));
+    rst->pNext = rst->state + trng[AIR_RANDMT_N];
+    rst->left = trng[AIR_RANDMT_N+1];
+  }
+
+  pctx->iter = iter;
+  pctx->idtagNext = idtagNext;
+  pctx->haltonOffset = haltonOffset;
+  pctx->addNum = addNum;
+  pctx->nixNum = nixNum;
+  pctx->stuckNum = stuckNum;
+  pctx->CCNum = CCNum;
+  pctx->pointNum = pointNum;
+  pctx->sysParm.energyIncreasePermit = eip;
+  pctx->energy = energy;
+  pctx->timeRun = timeRun;
+  for (ci=0; ci<=PULL_COUNT_MAX; ci++) {
+    pctx->count[ci] = count[ci];
+  }
+  pctx->runActive = AIR_FALSE;
+  pctx->runResume = runActive;
+  pctx->runConverged = runConverged;
+  pctx->runIterFirst = runIterFirst;
+  pctx->runEnergyLast = runEnergyLast;
+  pctx->runEnergyDecreaseAvg = runEnergyDecreaseAvg;
+
+  airMopOkay(mop);
+  return 0;
+}
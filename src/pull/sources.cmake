@@ -20,6 +20,7 @@ set(PULL_SOURCES
   ccPull.c
   enumsPull.c
   trace.c
+  snapshotPull.c
   )
 
 ADD_TEEM_LIBRARY(pull ${PULL_SOURCES})
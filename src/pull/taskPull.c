@@ -113,8 +113,17 @@ _pullTaskNew(pullContext *pctx, int threadIdx) {
                                   sizeof(pullPoint*),
                                   /* not exactly the right semantics . . . */
                                   PULL_POINT_NEIGH_INCR);
+  task->poolPoint = NULL;
+  task->poolPointNum = 0;
+  pppu.points = &(task->poolPoint);
+  task->poolPointArr = airArrayNew(pppu.v, &(task->poolPointNum),
+                                   sizeof(pullPoint*),
+                                   PULL_POINT_NEIGH_INCR);
+  task->poolPointArr->noReallocWhenSmaller = AIR_TRUE;
+  task->poolPointReuseNum = 0;
   task->returnPtr = NULL;
   task->stuckNum = 0;
+  task->err = NULL;
   return task;
 }
 
@@ -134,6 +143,11 @@ _pullTaskNix(pullTask *task) {
     airFree(task->neighPoint);
     task->addPointArr = airArrayNuke(task->addPointArr);
     task->nixPointArr = airArrayNuke(task->nixPointArr);
+    for (ii=0; ii<task->poolPointNum; ii++) {
+      pullPointNix(task->poolPoint[ii]);
+    }
+    task->poolPointArr = airArrayNuke(task->poolPointArr);
+    airFree(task->err);
     airFree(task);
   }
   return NULL;
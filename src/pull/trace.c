@@ -56,24 +56,15 @@ pullTraceNix(pullTrace *pts) {
 }
 
 
-int
-pullTraceSet(pullContext *pctx, pullTrace *pts,
-             int recordStrength, int sigmaNorm,
-             double scaleDelta, double halfScaleWin,
-             double velocityMax, unsigned int arrIncr,
-             const double _seedPos[4]) {
-  static const char me[]="pullTraceSet";
-  pullPoint *point;
-  airArray *mop, *trceArr[2], *hstrnArr[2];
-  double *trce[2], ssrange[2], *vert, *hstrn[2], *strn, *velo,
-    seedPos[4], travmax;
-  int constrFail;
-  unsigned int dirIdx, lentmp, tidx, oidx, vertNum;
+/*
+** checks the tracing parameters that don't depend on the seed point,
+** and learns the scale range
+*/
+static int
+_traceCheck(pullContext *pctx, int recordStrength,
+            double scaleDelta, double halfScaleWin, double ssrange[2]) {
+  static const char me[]="_traceCheck";
 
-  if (!( pctx && pts && _seedPos )) {
-    biffAddf(PULL, "%s: got NULL pointer", me);
-    return 1;
-  }
   if (!( AIR_EXISTS(scaleDelta) && scaleDelta > 0.0 )) {
     biffAddf(PULL, "%s: need existing scaleDelta > 0 (not %g)",
              me, scaleDelta);
@@ -96,6 +87,30 @@ pullTraceSet(pullContext *pctx, pullTrace *pts,
     biffAddf(PULL, "%s: trouble getting scale range", me);
     return 1;
   }
+  return 0;
+}
+
+/*
+** the work of pullTraceSet, using the given task (and its gage
+** contexts) and the given point, which is reset first. Different
+** threads can trace at the same time with different tasks and points.
+*/
+static int
+_traceSet(pullTask *task, pullPoint *point, pullTrace *pts,
+          int recordStrength, int sigmaNorm,
+          double scaleDelta, double halfScaleWin,
+          double velocityMax, unsigned int arrIncr,
+          const double _seedPos[4], const double ssrange[2]) {
+  static const char me[]="_traceSet";
+  pullContext *pctx;
+  airArray *mop, *trceArr[2], *hstrnArr[2];
+  double *trce[2], *vert, *hstrn[2], *strn, *velo,
+    seedPos[4], travmax;
+  int constrFail;
+  unsigned int dirIdx, lentmp, tidx, oidx, vertNum;
+
+  pctx = task->pctx;
+  _pullPointReset(pctx, point);
 
   /* re-initialize termination descriptions (in case of trace re-use) */
   pts->whyStop[0] = pts->whyStop[1] = pullTraceStopUnknown;
@@ -111,8 +126,6 @@ pullTraceSet(pullContext *pctx, pullTrace *pts,
   ELL_4V_COPY(pts->seedPos, seedPos);
 
   mop = airMopNew();
-  point = pullPointNew(pctx); /* we'll want to decrement idtagNext later */
-  airMopAdd(mop, point, (airMopper)pullPointNix, airMopAlways);
 
   /* travmax is passed to _pullConstraintSatisfy; the intention is
      that constraint satisfaction should not fail because the point
@@ -128,7 +141,7 @@ pullTraceSet(pullContext *pctx, pullTrace *pts,
             seedPos[0], seedPos[1], seedPos[2], seedPos[3]);
   }
   */
-  if (_pullConstraintSatisfy(pctx->task[0], point, travmax, &constrFail)) {
+  if (_pullConstraintSatisfy(task, point, travmax, &constrFail)) {
     biffAddf(PULL, "%s: constraint sat on seed point", me);
     airMopError(mop);
     return 1;
@@ -209,7 +222,7 @@ pullTraceSet(pullContext *pctx, pullTrace *pts,
               point->idtag, point->pos[0], point->pos[1],
               point->pos[2], point->pos[3]);
       */
-      if (_pullConstraintSatisfy(pctx->task[0], point,
+      if (_pullConstraintSatisfy(task, point,
                                  travmax, &constrFail)) {
         biffAddf(PULL, "%s: dir %u, step %u", me, dirIdx, step);
         airMopError(mop);
@@ -364,6 +377,40 @@ pullTraceSet(pullContext *pctx, pullTrace *pts,
   return 0;
 }
 
+int
+pullTraceSet(pullContext *pctx, pullTrace *pts,
+             int recordStrength, int sigmaNorm,
+             double scaleDelta, double halfScaleWin,
+             double velocityMax, unsigned int arrIncr,
+             const double seedPos[4]) {
+  static const char me[]="pullTraceSet";
+  pullPoint *point;
+  double ssrange[2];
+
+  if (!( pctx && pts && seedPos )) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (_traceCheck(pctx, recordStrength, scaleDelta, halfScaleWin, ssrange)) {
+    biffAddf(PULL, "%s: problem with parameters", me);
+    return 1;
+  }
+  /* we'll want to decrement idtagNext later */
+  if (!( point = pullPointNew(pctx) )) {
+    biffAddf(PULL, "%s: couldn't allocate point", me);
+    return 1;
+  }
+  if (_traceSet(pctx->task[0], point, pts, recordStrength, sigmaNorm,
+                scaleDelta, halfScaleWin, velocityMax, arrIncr,
+                seedPos, ssrange)) {
+    biffAddf(PULL, "%s: trouble", me);
+    pullPointNix(point);
+    return 1;
+  }
+  pullPointNix(point);
+  return 0;
+}
+
 typedef union {
   pullTrace ***trace;
   void **v;
@@ -422,6 +469,162 @@ pullTraceMultiAdd(pullTraceMulti *mtrc, pullTrace *trc, int *addedP) {
   return 0;
 }
 
+typedef struct {
+  pullTrace **trace;          /* per-seed; NULL once handed to mtrc */
+  unsigned int seedNum;
+  pullPoint **point;          /* per-task point to trace with */
+  const double *seedPos;
+  double ssrange[2], scaleDelta, halfScaleWin, velocityMax;
+  int recordStrength, sigmaNorm;
+  unsigned int arrIncr;
+  char **err;                 /* per-seed: biff messages, if tracing had
+                                 an error */
+} _traceMultiShared;
+
+/* a mopper for the traces not (yet) handed off to the pullTraceMulti,
+   and for the error messages; one mop entry for all of them, rather
+   than one each */
+static void *
+_traceMultiSharedDone(void *_shared) {
+  _traceMultiShared *shared;
+  unsigned int si;
+
+  shared = AIR_CAST(_traceMultiShared *, _shared);
+  if (shared->trace) {
+    for (si=0; si<shared->seedNum; si++) {
+      shared->trace[si] = pullTraceNix(shared->trace[si]);
+    }
+  }
+  if (shared->err) {
+    for (si=0; si<shared->seedNum; si++) {
+      shared->err[si] = AIR_CAST(char *, airFree(shared->err[si]));
+    }
+  }
+  return NULL;
+}
+
+static int
+_traceMultiJob(pullTask *task, void *_shared, unsigned int seedIdx) {
+  _traceMultiShared *shared;
+
+  shared = AIR_CAST(_traceMultiShared *, _shared);
+  if (_traceSet(task, shared->point[task->threadIdx], shared->trace[seedIdx],
+                shared->recordStrength, shared->sigmaNorm,
+                shared->scaleDelta, shared->halfScaleWin,
+                shared->velocityMax, shared->arrIncr,
+                shared->seedPos + 4*seedIdx, shared->ssrange)) {
+    /* kept per seed, so that which one is reported doesn't depend on
+       which thread failed first */
+    shared->err[seedIdx] = (biffCheck(PULL)
+                            ? biffGetDone(PULL)
+                            : airStrdup("(no message)"));
+    return 1;
+  }
+  return 0;
+}
+
+/*
+******** pullTraceMultiSet
+**
+** traces from each of the seedNum seed points (4 doubles each) in
+** seedPos, as with pullTraceSet, and adds the (non-stub) traces to mtrc,
+** in seed order. The tracing is shared among pctx's tasks, each with its
+** own gage contexts, so this has to be called between pullStart and
+** pullFinish (such as after pullRun). Since tracing from a seed doesn't
+** depend on any other seed, the result is the same for any threadNum.
+*/
+int
+pullTraceMultiSet(pullContext *pctx, pullTraceMulti *mtrc,
+                  int recordStrength, int sigmaNorm,
+                  double scaleDelta, double halfScaleWin,
+                  double velocityMax, unsigned int arrIncr,
+                  const double *seedPos, unsigned int seedNum) {
+  static const char me[]="pullTraceMultiSet";
+  _traceMultiShared shared;
+  unsigned int si, ti;
+  airArray *mop;
+
+  if (!( pctx && mtrc && seedPos )) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!pctx->task) {
+    biffAddf(PULL, "%s: NULL task array, didn't call pullStart()?", me);
+    return 1;
+  }
+  if (pctx->finished) {
+    biffAddf(PULL, "%s: context is finished (maybe after an error)", me);
+    return 1;
+  }
+  if (_traceCheck(pctx, recordStrength, scaleDelta, halfScaleWin,
+                  shared.ssrange)) {
+    biffAddf(PULL, "%s: problem with parameters", me);
+    return 1;
+  }
+  if (!seedNum) {
+    return 0;
+  }
+  mop = airMopNew();
+  shared.seedNum = seedNum;
+  shared.trace = AIR_CALLOC(seedNum, pullTrace *);
+  airMopAdd(mop, shared.trace, airFree, airMopAlways);
+  shared.err = AIR_CALLOC(seedNum, char *);
+  airMopAdd(mop, shared.err, airFree, airMopAlways);
+  /* added after shared.trace and shared.err, so called before they are
+     freed */
+  airMopAdd(mop, &shared, _traceMultiSharedDone, airMopAlways);
+  shared.point = AIR_CALLOC(pctx->threadNum, pullPoint *);
+  airMopAdd(mop, shared.point, airFree, airMopAlways);
+  if (!( shared.trace && shared.err && shared.point )) {
+    biffAddf(PULL, "%s: couldn't allocate for %u seeds", me, seedNum);
+    airMopError(mop); return 1;
+  }
+  for (si=0; si<seedNum; si++) {
+    if (!( shared.trace[si] = pullTraceNew() )) {
+      biffAddf(PULL, "%s: couldn't allocate trace %u", me, si);
+      airMopError(mop); return 1;
+    }
+  }
+  for (ti=0; ti<pctx->threadNum; ti++) {
+    if (!( shared.point[ti] = pullPointNew(pctx) )) {
+      biffAddf(PULL, "%s: couldn't allocate point %u", me, ti);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, shared.point[ti], (airMopper)pullPointNix, airMopAlways);
+  }
+  shared.seedPos = seedPos;
+  shared.scaleDelta = scaleDelta;
+  shared.halfScaleWin = halfScaleWin;
+  shared.velocityMax = velocityMax;
+  shared.recordStrength = recordStrength;
+  shared.sigmaNorm = sigmaNorm;
+  shared.arrIncr = arrIncr;
+  if (_pullFinishRun(pctx, seedNum, _traceMultiJob, &shared)) {
+    /* report the lowest-index seed that had trouble */
+    for (si=0; si<seedNum && !shared.err[si]; si++);
+    if (si < seedNum) {
+      biffAddf(PULL, "%s", shared.err[si]);
+    }
+    biffAddf(PULL, "%s: trouble tracing from seed %u (of %u)",
+             me, si, seedNum);
+    airMopError(mop); return 1;
+  }
+  for (si=0; si<seedNum; si++) {
+    int added;
+    if (pullTraceMultiAdd(mtrc, shared.trace[si], &added)) {
+      biffAddf(PULL, "%s: trouble adding trace %u", me, si);
+      airMopError(mop); return 1;
+    }
+    if (!added) {
+      pullTraceNix(shared.trace[si]);
+    }
+    /* either way, it is no longer ours to nix */
+    shared.trace[si] = NULL;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
 int
 pullTraceMultiFilterConcaveDown(Nrrd *nfilt, const pullTraceMulti *mtrc,
                                 double winLenFrac) {
@@ -634,6 +837,7 @@ pullTraceMultiNix(pullTraceMulti *mtrc) {
 
 
 #define PULL_MTRC_MAGIC "PULLMTRC0001"
+#define PULL_MTRC_BIN_MAGIC "PULLMTRC0002"
 #define DEMARK_STR "======"
 
 static int
@@ -668,8 +872,64 @@ tracewrite(FILE *file, const pullTrace *trc, unsigned int ti) {
   return 0;
 }
 
+/*
+** The binary format is like a NRRD file: a line of text per trace,
+** followed by its raw (native endian) doubles: 4*vertNum of vert, then
+** vertNum of strn (if there is one), then vertNum of velo. The text line
+** is: ti vertNum seedIdx haveStrn whyStop[0] whyStop[1] whyNowhere
+** seedPos[0..3], and the endianness is recorded once after the magic.
+*/
+static int
+tracewritebin(FILE *file, const pullTrace *trc, unsigned int ti) {
+  static const char me[]="tracewritebin";
+  unsigned int vertNum;
+  int haveStrn;
+
+  if (!( nrrdTypeDouble == trc->nvert->type
+         && nrrdTypeDouble == trc->nvelo->type )) {
+    biffAddf(PULL, "%s: need type %s vert and velo (not %s, %s)", me,
+             airEnumStr(nrrdType, nrrdTypeDouble),
+             airEnumStr(nrrdType, trc->nvert->type),
+             airEnumStr(nrrdType, trc->nvelo->type));
+    return 1;
+  }
+  vertNum = AIR_UINT(trc->nvert->axis[1].size);
+  haveStrn = !!(trc->nstrn && trc->nstrn->data);
+  if (haveStrn && !( nrrdTypeDouble == trc->nstrn->type
+                     && vertNum == nrrdElementNumber(trc->nstrn) )) {
+    biffAddf(PULL, "%s: strn isn't %u %ss", me, vertNum,
+             airEnumStr(nrrdType, nrrdTypeDouble));
+    return 1;
+  }
+  fprintf(file, "%u %u %u %d %s %s %s %.17g %.17g %.17g %.17g\n", ti,
+          vertNum, trc->seedIdx, haveStrn,
+          airEnumStr(pullTraceStop, trc->whyStop[0]),
+          airEnumStr(pullTraceStop, trc->whyStop[1]),
+          airEnumStr(pullTraceStop, trc->whyNowhere),
+          trc->seedPos[0], trc->seedPos[1],
+          trc->seedPos[2], trc->seedPos[3]);
+  if (4*vertNum != fwrite(trc->nvert->data, sizeof(double), 4*vertNum, file)
+      || (haveStrn
+          && vertNum != fwrite(trc->nstrn->data, sizeof(double),
+                               vertNum, file))
+      || vertNum != fwrite(trc->nvelo->data, sizeof(double),
+                           vertNum, file)) {
+    biffAddf(PULL, "%s: couldn't write data of trace %u", me, ti);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+******** pullTraceMultiWrite
+**
+** writes all the traces to file, either as text (with a NRRD for each
+** of a trace's arrays) or, if binary, in a compact binary format that
+** is much faster to write and read for many traces. pullTraceMultiRead
+** reads either.
+*/
 int
-pullTraceMultiWrite(FILE *file, const pullTraceMulti *mtrc) {
+pullTraceMultiWrite(FILE *file, const pullTraceMulti *mtrc, int binary) {
   static const char me[]="pullTraceMultiWrite";
   unsigned int ti;
 
@@ -677,11 +937,19 @@ pullTraceMultiWrite(FILE *file, const pullTraceMulti *mtrc) {
     biffAddf(PULL, "%s: got NULL pointer", me);
     return 1;
   }
-  fprintf(file, "%s\n", PULL_MTRC_MAGIC);
-  fprintf(file, "%u traces\n", mtrc->traceNum);
+  if (binary) {
+    fprintf(file, "%s\n", PULL_MTRC_BIN_MAGIC);
+    fprintf(file, "%u traces, %s endian\n", mtrc->traceNum,
+            airEnumStr(airEndian, airMyEndian()));
+  } else {
+    fprintf(file, "%s\n", PULL_MTRC_MAGIC);
+    fprintf(file, "%u traces\n", mtrc->traceNum);
+  }
 
   for (ti=0; ti<mtrc->traceNum; ti++) {
-    if (tracewrite(file, mtrc->trace[ti], ti)) {
+    if (binary
+        ? tracewritebin(file, mtrc->trace[ti], ti)
+        : tracewrite(file, mtrc->trace[ti], ti)) {
       biffAddf(PULL, "%s: trace %u/%u", me, ti, mtrc->traceNum);
       return 1;
     }
@@ -772,14 +1040,91 @@ traceread(pullTrace *trc, FILE *file, unsigned int _ti) {
              pullTraceStop->name, name, line);
     return 1;
   }
+  trc->whyStop[0] = stops[0];
+  trc->whyStop[1] = stops[1];
+  trc->whyNowhere = stops[2];
 
   return 0;
 }
+
+static int
+tracereadbin(pullTrace *trc, FILE *file, unsigned int _ti, int swap) {
+  static const char me[]="tracereadbin";
+  char line[AIR_STRLEN_MED], stopStr[3][AIR_STRLEN_SMALL];
+  unsigned int ti, vertNum, sii;
+  int haveStrn, stops[3];
+
+  if (!airOneLine(file, line, AIR_STRLEN_MED)) {
+    biffAddf(PULL, "%s: didn't get line for trace %u", me, _ti);
+    return 1;
+  }
+  /* AIR_STRLEN_SMALL == 129 */
+  if (11 != sscanf(line, "%u %u %u %d %128s %128s %128s %lg %lg %lg %lg",
+                   &ti, &vertNum, &(trc->seedIdx), &haveStrn,
+                   stopStr[0], stopStr[1], stopStr[2],
+                   trc->seedPos + 0, trc->seedPos + 1,
+                   trc->seedPos + 2, trc->seedPos + 3)) {
+    biffAddf(PULL, "%s: couldn't parse \"%s\" as trace %u line",
+             me, line, _ti);
+    return 1;
+  }
+  if (ti != _ti) {
+    biffAddf(PULL, "%s: read trace index %u but wanted %u", me, ti, _ti);
+    return 1;
+  }
+  for (sii=0; sii<3; sii++) {
+    stops[sii] = airEnumVal(pullTraceStop, stopStr[sii]);
+    if (pullTraceStopUnknown == stops[sii]
+        && strcmp(stopStr[sii], airEnumStr(pullTraceStop, stops[sii]))) {
+      biffAddf(PULL, "%s: didn't recognize %s \"%s\"",
+               me, pullTraceStop->name, stopStr[sii]);
+      return 1;
+    }
+  }
+  trc->whyStop[0] = stops[0];
+  trc->whyStop[1] = stops[1];
+  trc->whyNowhere = stops[2];
+  if (nrrdMaybeAlloc_va(trc->nvert, nrrdTypeDouble, 2,
+                        AIR_CAST(size_t, 4), AIR_CAST(size_t, vertNum))
+      || nrrdMaybeAlloc_va(trc->nvelo, nrrdTypeDouble, 1,
+                           AIR_CAST(size_t, vertNum))
+      || (haveStrn
+          && nrrdMaybeAlloc_va(trc->nstrn, nrrdTypeDouble, 1,
+                               AIR_CAST(size_t, vertNum)))) {
+    biffMovef(PULL, NRRD, "%s: couldn't allocate trace %u", me, ti);
+    return 1;
+  }
+  if (4*vertNum != fread(trc->nvert->data, sizeof(double), 4*vertNum, file)
+      || (haveStrn
+          && vertNum != fread(trc->nstrn->data, sizeof(double),
+                              vertNum, file))
+      || vertNum != fread(trc->nvelo->data, sizeof(double), vertNum, file)) {
+    biffAddf(PULL, "%s: couldn't read data of trace %u", me, ti);
+    return 1;
+  }
+  if (swap) {
+    nrrdSwapEndian(trc->nvert);
+    nrrdSwapEndian(trc->nvelo);
+    if (haveStrn) {
+      nrrdSwapEndian(trc->nstrn);
+    }
+  }
+  return 0;
+}
+
+/*
+******** pullTraceMultiRead
+**
+** reads into mtrc (after emptying it) what pullTraceMultiWrite wrote,
+** in either format. On error, mtrc holds the traces read so far.
+*/
 int
 pullTraceMultiRead(pullTraceMulti *mtrc, FILE *file) {
   static const char me[]="pullTraceMultiRead";
-  char line[AIR_STRLEN_MED], name[AIR_STRLEN_MED];
+  char line[AIR_STRLEN_MED], name[AIR_STRLEN_MED],
+    endianStr[AIR_STRLEN_SMALL];
   unsigned int lineLen, ti, tnum;
+  int binary, swap;
   pullTrace *trc;
 
   if (!(mtrc && file)) {
@@ -793,9 +1138,13 @@ pullTraceMultiRead(pullTraceMulti *mtrc, FILE *file) {
     biffAddf(PULL, "%s: didn't get %s line", me, name);
     return 1;
   }
-  if (strcmp(line, PULL_MTRC_MAGIC)) {
-    biffAddf(PULL, "%s: %s line \"%s\" not expected \"%s\"",
-             me, name, line, PULL_MTRC_MAGIC);
+  if (!strcmp(line, PULL_MTRC_MAGIC)) {
+    binary = AIR_FALSE;
+  } else if (!strcmp(line, PULL_MTRC_BIN_MAGIC)) {
+    binary = AIR_TRUE;
+  } else {
+    biffAddf(PULL, "%s: %s line \"%s\" not expected \"%s\" or \"%s\"",
+             me, name, line, PULL_MTRC_MAGIC, PULL_MTRC_BIN_MAGIC);
     return 1;
   }
 
@@ -805,19 +1154,45 @@ pullTraceMultiRead(pullTraceMulti *mtrc, FILE *file) {
     biffAddf(PULL, "%s: didn't get %s line", me, name);
     return 1;
   }
-  if (1 != sscanf(line, "%u traces", &tnum)) {
-    biffAddf(PULL, "%s: \"%s\" doesn't look like %s line", me, line, name);
-    return 1;
+  swap = AIR_FALSE;
+  if (binary) {
+    int endian;
+    /* AIR_STRLEN_SMALL == 129 */
+    if (2 != sscanf(line, "%u traces, %128s endian", &tnum, endianStr)) {
+      biffAddf(PULL, "%s: \"%s\" doesn't look like %s line",
+               me, line, name);
+      return 1;
+    }
+    if (airEndianUnknown == (endian = airEnumVal(airEndian, endianStr))) {
+      biffAddf(PULL, "%s: couldn't parse endianness \"%s\"",
+               me, endianStr);
+      return 1;
+    }
+    swap = (endian != airMyEndian());
+  } else {
+    if (1 != sscanf(line, "%u traces", &tnum)) {
+      biffAddf(PULL, "%s: \"%s\" doesn't look like %s line",
+               me, line, name);
+      return 1;
+    }
   }
   for (ti=0; ti<tnum; ti++) {
     int added;
-    trc = pullTraceNew();
-    if (traceread(trc, file, ti)) {
+    if (!( trc = pullTraceNew() )) {
+      biffAddf(PULL, "%s: couldn't allocate trace %u/%u", me, ti, tnum);
+      return 1;
+    }
+    if (binary
+        ? tracereadbin(trc, file, ti, swap)
+        : traceread(trc, file, ti)) {
       biffAddf(PULL, "%s: on trace %u/%u", me, ti, tnum);
+      pullTraceNix(trc);
       return 1;
     }
     if (pullTraceMultiAdd(mtrc, trc, &added)) {
+      /* mtrc didn't take it */
       biffAddf(PULL, "%s: adding trace %u/%u", me, ti, tnum);
+      pullTraceNix(trc);
       return 1;
     }
     if (!added) {
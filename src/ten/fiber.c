@@ -449,14 +449,176 @@ _tenFiberIntegrate_RK4(tenFiberContext *tfx, double forwDir[3]) {
   return 0;
 }
 
+/*
+** Dormand-Prince 5(4): the 5th order solution is used, and its difference
+** from the embedded 4th order solution is the error estimate.  The step
+** size tfx->stepSizeCurr is carried from one call to the next (along one
+** fiber half), growing where the fiber is straight and shrinking where
+** it curves, within [stepSizeMin, stepSizeMax].  A step that would leave
+** the volume is retried with a smaller step, and only fails (stopping
+** the fiber) if the step is already at the minimum.  Stopping criteria
+** are still only checked between steps, so a large stepSizeMax may let
+** fibers cross thin regions of low anisotropy.
+*/
+int
+_tenFiberIntegrate_RK45(tenFiberContext *tfx, double forwDir[3]) {
+  static const double
+    aa[6][6] = {{1.0/5, 0, 0, 0, 0, 0},
+                {3.0/40, 9.0/40, 0, 0, 0, 0},
+                {44.0/45, -56.0/15, 32.0/9, 0, 0, 0},
+                {19372.0/6561, -25360.0/2187, 64448.0/6561, -212.0/729, 0, 0},
+                {9017.0/3168, -355.0/33, 46732.0/5247, 49.0/176,
+                 -5103.0/18656, 0},
+                {35.0/384, 0, 500.0/1113, 125.0/192, -2187.0/6784,
+                 11.0/84}},
+    /* 5th order weights minus embedded 4th order weights */
+    ee[7] = {71.0/57600, 0, -71.0/16695, 71.0/1920, -17253.0/339200,
+             22.0/525, -1.0/40};
+  double kk[7][3], loc[3], err[3], hh, hmin, hmax, errLen, fac;
+  unsigned int si, sj;
+  int gret;
+
+  hmin = tfx->stepSizeMin ? tfx->stepSizeMin : tfx->stepSize/10;
+  hmax = tfx->stepSizeMax ? tfx->stepSizeMax : tfx->stepSize*10;
+  hh = AIR_CLAMP(hmin, tfx->stepSizeCurr, hmax);
+  /* as with the other integrators, a probe at tfx->wPos was just done */
+  _tenFiberStep[tfx->fiberType](tfx, kk[0]);
+  while (1) {
+    gret = 0;
+    for (si=1; si<7 && !gret; si++) {
+      ELL_3V_COPY(loc, tfx->wPos);
+      for (sj=0; sj<si; sj++) {
+        ELL_3V_SCALE_INCR(loc, hh*aa[si-1][sj], kk[sj]);
+      }
+      _tenFiberProbe(tfx, &gret, loc, AIR_FALSE);
+      if (!gret) {
+        _tenFiberStep[tfx->fiberType](tfx, kk[si]);
+      }
+    }
+    if (gret) {
+      if (hh > hmin) {
+        hh = AIR_MAX(hmin, hh/2);
+        continue;
+      }
+      return 1;
+    }
+    /* the last stage was evaluated at the 5th order solution */
+    ELL_3V_SUB(forwDir, loc, tfx->wPos);
+    ELL_3V_SET(err, 0, 0, 0);
+    for (si=0; si<7; si++) {
+      ELL_3V_SCALE_INCR(err, hh*ee[si], kk[si]);
+    }
+    errLen = ELL_3V_LEN(err);
+    fac = (errLen
+           ? 0.9*pow(tfx->errTol/errLen, 0.2)
+           : 5.0);
+    if (errLen <= tfx->errTol || hh <= hmin) {
+      tfx->stepSizeCurr = AIR_CLAMP(hmin, hh*AIR_MIN(fac, 5.0), hmax);
+      break;
+    }
+    hh = AIR_MAX(hmin, hh*AIR_MAX(fac, 0.2));
+  }
+  return 0;
+}
+
 int (*
 _tenFiberIntegrate[TEN_FIBER_INTG_MAX+1])(tenFiberContext *tfx, double *) = {
   NULL,
   _tenFiberIntegrate_Euler,
   _tenFiberIntegrate_Midpoint,
-  _tenFiberIntegrate_RK4
+  _tenFiberIntegrate_RK4,
+  _tenFiberIntegrate_RK45
 };
 
+/*
+** resamples the points (and probed values, if pansArr is non-NULL) of
+** one fiber half so that they are spaced at world-space arc length
+** tfx->stepSize, starting at the seedpoint, by linear interpolation of
+** the points as they were traced.  This is for tenFiberParmResample, so
+** that adaptive step sizes don't change the vertex spacing.
+*/
+static int
+_fiberHalfResample(tenFiberContext *tfx, airArray *fptsArr,
+                   airArray *pansArr, unsigned int pansLen) {
+  static const char me[]="_fiberHalfResample";
+  airArray *mop;
+  double *pts, *vals, *arc, *npts, *nvals, wA[3], wB[3], tt, ff;
+  unsigned int ii, jj, num, nnum;
+
+  num = fptsArr->len;
+  if (num < 2) {
+    return 0;
+  }
+  mop = airMopNew();
+  pts = AIR_CAST(double *, fptsArr->data);
+  vals = pansArr ? AIR_CAST(double *, pansArr->data) : NULL;
+  /* these temporary buffers all come from one arena owned by the mop */
+  arc = AIR_CAST(double *, airMopArenaAlloc(mop, num*sizeof(double)));
+  if (!arc) {
+    biffAddf(TEN, "%s: couldn't allocate arc length array", me);
+    airMopError(mop); return 1;
+  }
+  /* arc length is always measured in world space */
+  arc[0] = 0;
+  if (tfx->useIndexSpace) {
+    gageShapeItoW(tfx->gtx->shape, wA, pts + 3*0);
+  } else {
+    ELL_3V_COPY(wA, pts + 3*0);
+  }
+  for (ii=1; ii<num; ii++) {
+    if (tfx->useIndexSpace) {
+      gageShapeItoW(tfx->gtx->shape, wB, pts + 3*ii);
+    } else {
+      ELL_3V_COPY(wB, pts + 3*ii);
+    }
+    arc[ii] = arc[ii-1] + ELL_3V_DIST(wA, wB);
+    ELL_3V_COPY(wA, wB);
+  }
+  nnum = 1 + AIR_CAST(unsigned int, arc[num-1]/tfx->stepSize);
+  npts = AIR_CAST(double *, airMopArenaAlloc(mop, 3*nnum*sizeof(double)));
+  nvals = ((vals && pansLen)
+           ? AIR_CAST(double *,
+                      airMopArenaAlloc(mop, pansLen*nnum*sizeof(double)))
+           : NULL);
+  if (!( npts && (nvals || !(vals && pansLen)) )) {
+    biffAddf(TEN, "%s: couldn't allocate %u resampled points", me, nnum);
+    airMopError(mop); return 1;
+  }
+  jj = 0;
+  for (ii=0; ii<nnum; ii++) {
+    tt = ii*tfx->stepSize;
+    while (jj < num-2 && arc[jj+1] < tt) {
+      jj++;
+    }
+    ff = (arc[jj+1] > arc[jj]
+          ? AIR_AFFINE(arc[jj], tt, arc[jj+1], 0.0, 1.0)
+          : 0.0);
+    ff = AIR_CLAMP(0.0, ff, 1.0);
+    ELL_3V_LERP(npts + 3*ii, ff, pts + 3*jj, pts + 3*(jj+1));
+    if (nvals) {
+      unsigned int vi;
+      for (vi=0; vi<pansLen; vi++) {
+        nvals[vi + pansLen*ii] = AIR_LERP(ff, vals[vi + pansLen*jj],
+                                          vals[vi + pansLen*(jj+1)]);
+      }
+    }
+  }
+  airArrayLenSet(fptsArr, nnum);
+  if (nvals) {
+    airArrayLenSet(pansArr, nnum);
+  }
+  if (!( nnum == fptsArr->len && (!nvals || nnum == pansArr->len) )) {
+    biffAddf(TEN, "%s: couldn't resize arrays to %u", me, nnum);
+    airMopError(mop); return 1;
+  }
+  memcpy(fptsArr->data, npts, 3*nnum*sizeof(double));
+  if (nvals) {
+    memcpy(pansArr->data, nvals, pansLen*nnum*sizeof(double));
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
 /*
 ** modified body of previous tenFiberTraceSet, in order to
 ** permit passing the nval for storing desired probed values
@@ -632,6 +794,7 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
     tfx->radius = DBL_MAX;
     ELL_3V_SET(tfx->lastDir, 0, 0, 0);
     tfx->lastDirSet = AIR_FALSE;
+    tfx->stepSizeCurr = tfx->stepSize;
     for (tfx->numSteps[tfx->halfIdx] = 0;
          AIR_TRUE;
          tfx->numSteps[tfx->halfIdx]++) {
@@ -644,15 +807,20 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
         fprintf(stderr, "!%s: A tfx->whyStop[%d] = %s\n", me, tfx->halfIdx,
                 airEnumStr(tenFiberStop, tfx->whyStop[tfx->halfIdx]));
         */
+        /* the step to here wasn't successful (see below) */
+        if (tfx->numSteps[tfx->halfIdx]) {
+          tfx->numSteps[tfx->halfIdx]--;
+        }
         break;
       }
       if ((whyStop = _tenFiberStopCheck(tfx))) {
-        if (tenFiberStopNumSteps == whyStop) {
-          /* we stopped along this direction because
-             tfx->numSteps[tfx->halfIdx] exceeded tfx->maxNumSteps.
-             Okay.  But tfx->numSteps[tfx->halfIdx] is supposed to be
-             a record of how steps were (successfully) taken.  So we
-             need to decrementing before moving on ... */
+        /* tfx->numSteps[tfx->halfIdx] is supposed to be a record of how
+           many steps were (successfully) taken, which is one less than
+           the number of points saved for this half (including the seed
+           point).  The point we stopped at isn't saved, so the step to
+           it doesn't count, regardless of why we stopped (including
+           because tfx->numSteps[tfx->halfIdx] exceeded maxNumSteps) */
+        if (tfx->numSteps[tfx->halfIdx]) {
           tfx->numSteps[tfx->halfIdx]--;
         }
         tfx->whyStop[tfx->halfIdx] = whyStop;
@@ -774,6 +942,20 @@ _fiberTraceSet(tenFiberContext *tfx, Nrrd *nval, Nrrd *nfiber,
       *startIdxP = *endIdxP = 0;
     }
   } else {
+    if (tfx->resample && nfiber) {
+      for (tfx->halfIdx=0; tfx->halfIdx<=1; tfx->halfIdx++) {
+        if (_fiberHalfResample(tfx, fptsArr[tfx->halfIdx],
+                               nval ? pansArr[tfx->halfIdx] : NULL,
+                               pansLen)) {
+          biffAddf(TEN, "%s: trouble resampling half %d", me, tfx->halfIdx);
+          airMopError(mop); return 1;
+        }
+        /* as when not resampling: one less than the number of points */
+        tfx->numSteps[tfx->halfIdx] = (fptsArr[tfx->halfIdx]->len
+                                       ? fptsArr[tfx->halfIdx]->len - 1
+                                       : 0);
+      }
+    }
     if (nval) {
       if (nrrdMaybeAlloc_va(nval, nrrdTypeDouble, 2,
                             AIR_CAST(size_t, pansLen),
@@ -993,6 +1175,7 @@ tenFiberMultiNew() {
   if (ret) {
     ret->fiber = NULL;
     ret->fiberNum = 0;
+    ret->probeNum = ret->fillNum = 0;
     tfu.f = &(ret->fiber);
     ret->fiberArr = airArrayNew(tfu.v, &(ret->fiberNum),
                                 sizeof(tenFiberSingle), 512 /* incr */);
@@ -1041,22 +1224,228 @@ tenFiberMultiNix(tenFiberMulti *tfm) {
   return NULL;
 }
 
+/*
+** state shared by all threads of tenFiberMultiTrace.  The jobs run on
+** nrrdThreadRun's threads, each of which has its own biff store, so a
+** job that fails takes its messages out of the store and keeps them in
+** err[jobIdx], for the calling thread to report afterwards.
+*/
+typedef struct {
+  tenFiberMulti *tfml;
+  tenFiberContext **tfx;          /* per thread: thread 0 gets the caller's
+                                     context, others get copies of it */
+  const double *seedData;
+  const unsigned int *fiberStart; /* index into tfml->fiber of first fiber
+                                     from each seed; seedNum+1 long */
+  const unsigned int *seedOrder;  /* if non-NULL, the order in which to
+                                     trace seeds; else it's 0,1,2,... */
+  unsigned int seedNum,
+    seedChunk,                    /* # seeds (consecutive in seedOrder)
+                                     per job */
+    *errSeed;                     /* per job: the seed it failed on */
+  char **err;                     /* per job: NULL if ok, else the
+                                     messages from the seed that failed */
+} _tenFiberMultiShared;
+
+static void *
+_fiberMultiErrNix(void *_shr) {
+  _tenFiberMultiShared *shr;
+  unsigned int jobIdx, jobNum;
+
+  shr = AIR_CAST(_tenFiberMultiShared *, _shr);
+  jobNum = (shr->seedNum + shr->seedChunk - 1)/shr->seedChunk;
+  for (jobIdx=0; jobIdx<jobNum; jobIdx++) {
+    shr->err[jobIdx] = AIR_CAST(char *, airFree(shr->err[jobIdx]));
+  }
+  return NULL;
+}
+
+/*
+** traces all directions from one seed, into the fibers at
+** shr->fiberStart[seedIdx] and up
+*/
+static int
+_fiberMultiSeedTrace(tenFiberContext *tfx, _tenFiberMultiShared *shr,
+                     unsigned int seedIdx) {
+  static const char me[]="tenFiberMultiTrace";
+  tenFiberSingle *tfbs;
+  unsigned int dirNum, dirIdx;
+  double seed[3];
+
+  dirNum = shr->fiberStart[seedIdx+1] - shr->fiberStart[seedIdx];
+  for (dirIdx=0; dirIdx<dirNum; dirIdx++) {
+    tfbs = shr->tfml->fiber + shr->fiberStart[seedIdx] + dirIdx;
+    if (tfx->verbose > 1) {
+      fprintf(stderr, "%s: dir %u/%u on seed %u/%u; # %u\n",
+              me, dirIdx, dirNum, seedIdx, shr->seedNum,
+              shr->fiberStart[seedIdx] + dirIdx);
+    }
+    ELL_3V_COPY(tfbs->seedPos, shr->seedData + 3*seedIdx);
+    tfbs->dirIdx = dirIdx;
+    tfbs->dirNum = dirNum;
+    ELL_3V_COPY(seed, shr->seedData + 3*seedIdx);
+    if (tenFiberSingleTrace(tfx, tfbs, seed, dirIdx)) {
+      return 1;
+    }
+    if (tfx->verbose) {
+      if (tenFiberStopUnknown == tfbs->whyNowhere) {
+        fprintf(stderr, "%s: (%g,%g,%g) ->\n"
+                "   steps = %u,%u; len = %g,%g; whyStop = %s,%s\n",
+                me, seed[0], seed[1], seed[2],
+                tfbs->stepNum[0], tfbs->stepNum[1],
+                tfbs->halfLen[0], tfbs->halfLen[1],
+                airEnumStr(tenFiberStop, tfbs->whyStop[0]),
+                airEnumStr(tenFiberStop, tfbs->whyStop[1]));
+      } else {
+        fprintf(stderr, "%s: (%g,%g,%g) -> whyNowhere: %s\n",
+                me, seed[0], seed[1], seed[2],
+                airEnumStr(tenFiberStop, tfbs->whyNowhere));
+      }
+    }
+  }
+  return 0;
+}
+
+/*
+** nrrdThreadRun job for tenFiberMultiTrace: traces the seedChunk seeds
+** (consecutive in shr->seedOrder, if that's set) of job jobIdx, with
+** the context of thread threadIdx, stopping at the first that fails.
+** Because every fiber goes into a slot in tfml->fiber determined only
+** by its seed and direction index, the output doesn't depend on which
+** thread traced which seed.
+*/
+static void
+_fiberMultiJob(void *_shr, unsigned int jobIdx, unsigned int threadIdx) {
+  _tenFiberMultiShared *shr;
+  unsigned int seedLo, seedHi, seedPos, seedIdx;
+
+  shr = AIR_CAST(_tenFiberMultiShared *, _shr);
+  seedLo = jobIdx*shr->seedChunk;
+  seedHi = AIR_MIN(seedLo + shr->seedChunk, shr->seedNum);
+  for (seedPos=seedLo; seedPos<seedHi; seedPos++) {
+    seedIdx = shr->seedOrder ? shr->seedOrder[seedPos] : seedPos;
+    if (_fiberMultiSeedTrace(shr->tfx[threadIdx], shr, seedIdx)) {
+      shr->errSeed[jobIdx] = seedIdx;
+      shr->err[jobIdx] = (biffCheck(TEN)
+                          ? biffGetDone(TEN)
+                          : airStrdup("(no message)"));
+      return;
+    }
+  }
+  return;
+}
+
+/*
+** for sorting seeds by _fiberMultiSeedSort: a Z-order key, and the seed
+** index, which breaks ties so that the ordering is fully determined
+*/
+typedef struct {
+  unsigned int key, seedIdx;
+} _tenFiberSeedKey;
+
+static int
+_fiberSeedKeyCompare(const void *_aa, const void *_bb) {
+  const _tenFiberSeedKey *aa, *bb;
+
+  aa = AIR_CAST(const _tenFiberSeedKey *, _aa);
+  bb = AIR_CAST(const _tenFiberSeedKey *, _bb);
+  return (aa->key < bb->key
+          ? -1
+          : (aa->key > bb->key
+             ? 1
+             : (aa->seedIdx < bb->seedIdx
+                ? -1
+                : (aa->seedIdx > bb->seedIdx))));
+}
+
+/*
+** sets seedOrder[] to the permutation of seed indices that visits the
+** seeds in Z-order (Morton order) of their index-space voxel coordinates,
+** quantized as needed to fit 10 bits per axis.  Consecutive seeds then
+** tend to be near each other, so that the volume data needed by one
+** fiber is more likely to still be in the memory cache when tracing
+** the next one, and so that the chunks of seeds handed to each thread
+** are spatially compact.
+*/
+static int
+_fiberMultiSeedSort(tenFiberContext *tfx, unsigned int *seedOrder,
+                    const double *seedData, unsigned int seedNum) {
+  static const char me[]="_fiberMultiSeedSort";
+  _tenFiberSeedKey *skey;
+  const gageShape *shape;
+  unsigned int seedIdx, axi, shift, bit, vi[3], sizeMax;
+  double ipos[3];
+
+  skey = AIR_CALLOC(seedNum, _tenFiberSeedKey);
+  if (!skey) {
+    biffAddf(TEN, "%s: couldn't allocate %u seed keys", me, seedNum);
+    return 1;
+  }
+  shape = tfx->gtx->shape;
+  sizeMax = AIR_MAX(shape->size[0], AIR_MAX(shape->size[1], shape->size[2]));
+  shift = 0;
+  while ((sizeMax >> shift) > 1024) {
+    shift++;
+  }
+  for (seedIdx=0; seedIdx<seedNum; seedIdx++) {
+    if (tfx->useIndexSpace) {
+      ELL_3V_COPY(ipos, seedData + 3*seedIdx);
+    } else {
+      gageShapeWtoI(shape, ipos, seedData + 3*seedIdx);
+    }
+    for (axi=0; axi<3; axi++) {
+      vi[axi] = AIR_CAST(unsigned int,
+                         AIR_CLAMP(0, ipos[axi] + 0.5, shape->size[axi]-1));
+      vi[axi] = AIR_MIN(vi[axi] >> shift, 1023);
+    }
+    skey[seedIdx].key = 0;
+    for (bit=0; bit<10; bit++) {
+      skey[seedIdx].key |= (((vi[0] >> bit) & 1) << (3*bit + 0)
+                            | ((vi[1] >> bit) & 1) << (3*bit + 1)
+                            | ((vi[2] >> bit) & 1) << (3*bit + 2));
+    }
+    skey[seedIdx].seedIdx = seedIdx;
+  }
+  qsort(skey, seedNum, sizeof(_tenFiberSeedKey), _fiberSeedKeyCompare);
+  for (seedIdx=0; seedIdx<seedNum; seedIdx++) {
+    seedOrder[seedIdx] = skey[seedIdx].seedIdx;
+  }
+  free(skey);
+  return 0;
+}
+
 /*
 ******** tenFiberMultiTrace
 **
 ** does tractography for a list of seedpoints
 **
 ** tfml has been returned from tenFiberMultiNew()
+**
+** If tfx->numThreads (set via tenFiberParmNumThreads) is more than one,
+** blocks of seeds are traced concurrently by nrrdThreadRun, with each
+** thread using its own tenFiberContextCopy of tfx.  If tfx->seedSort
+** (tenFiberParmSeedSort) is set, the seeds are traced in Z-order of
+** their position, for better memory locality.  In any case, the fibers
+** in tfml are in order of seed index, and then direction index, and if
+** tracing fails on some seeds, the biff error is about the one with the
+** lowest index.
+**
+** The total number of gage probes done (by all threads), and how many
+** of those had to refill the iv3 caches, are saved in tfml->probeNum
+** and tfml->fillNum.
 */
 int
 tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml,
                    const Nrrd *_nseed) {
   static const char me[]="tenFiberMultiTrace";
   airArray *mop;
-  const double *seedData;
   double seed[3];
-  unsigned int seedNum, seedIdx, fibrNum, dirNum, dirIdx;
+  unsigned int seedIdx, dirNum, *fiberStart, *seedOrder, tidx, numThreads,
+    jobNum, jobIdx, errJob;
+  size_t probeNum0, fillNum0;
+  char stmp[2][AIR_STRLEN_SMALL];
   Nrrd *nseed;
+  _tenFiberMultiShared shr;
 
   if (!(tfx && tfml && _nseed)) {
     biffAddf(TEN, "%s: got NULL pointer", me);
@@ -1072,74 +1461,140 @@ tenFiberMultiTrace(tenFiberContext *tfx, tenFiberMulti *tfml,
             AIR_CAST(unsigned int, _nseed->axis[0].size));
     return 1;
   }
+  numThreads = AIR_MAX(1, tfx->numThreads);
+  if (numThreads > 1 && tfx->useDwi) {
+    biffAddf(TEN, "%s: sorry, can't (yet) use %u threads for DWI "
+             "tractography", me, numThreads);
+    return 1;
+  }
 
   mop = airMopNew();
 
-  seedNum = _nseed->axis[1].size;
+  probeNum0 = tfx->gtx->probeNum;
+  fillNum0 = tfx->gtx->fillNum;
+  memset(&shr, 0, sizeof(shr));
+  shr.tfml = tfml;
+  shr.seedNum = _nseed->axis[1].size;
   if (nrrdTypeDouble == _nseed->type) {
-    seedData = AIR_CAST(const double *, _nseed->data);
+    shr.seedData = AIR_CAST(const double *, _nseed->data);
   } else {
     nseed = nrrdNew();
     airMopAdd(mop, nseed, AIR_CAST(airMopper, nrrdNuke), airMopAlways);
     if (nrrdConvert(nseed, _nseed, nrrdTypeDouble)) {
       biffMovef(TEN, NRRD, "%s: couldn't convert seed list", me);
-      return 1;
+      airMopError(mop); return 1;
     }
-    seedData = AIR_CAST(const double *, nseed->data);
+    shr.seedData = AIR_CAST(const double *, nseed->data);
   }
 
-  /* HEY: the correctness of the use of the airArray here is quite subtle */
-  fibrNum = 0;
-  for (seedIdx=0; seedIdx<seedNum; seedIdx++) {
+  /* learn where in tfml->fiber each seed's fibers will go */
+  fiberStart = AIR_CALLOC(shr.seedNum+1, unsigned int);
+  if (!fiberStart) {
+    biffAddf(TEN, "%s: couldn't allocate fiber index array", me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, fiberStart, airFree, airMopAlways);
+  fiberStart[0] = 0;
+  for (seedIdx=0; seedIdx<shr.seedNum; seedIdx++) {
+    ELL_3V_COPY(seed, shr.seedData + 3*seedIdx);
     dirNum = tenFiberDirectionNumber(tfx, seed);
     if (!dirNum) {
       biffAddf(TEN, "%s: couldn't learn dirNum at seed (%g,%g,%g)", me,
               seed[0], seed[1], seed[2]);
-      return 1;
+      airMopError(mop); return 1;
     }
-    for (dirIdx=0; dirIdx<dirNum; dirIdx++) {
-      if (tfx->verbose > 1) {
-        fprintf(stderr, "%s: dir %u/%u on seed %u/%u; len %u; # %u\n",
-                me, dirIdx, dirNum, seedIdx, seedNum,
-                tfml->fiberArr->len, fibrNum);
-      }
-      /* tfml->fiberArr->len can never be < fibrNum */
-      if (tfml->fiberArr->len == fibrNum) {
-        airArrayLenIncr(tfml->fiberArr, 1);
-      }
-      ELL_3V_COPY(tfml->fiber[fibrNum].seedPos, seedData + 3*seedIdx);
-      tfml->fiber[fibrNum].dirIdx = dirIdx;
-      tfml->fiber[fibrNum].dirNum = dirNum;
-      ELL_3V_COPY(seed, seedData + 3*seedIdx);
-      if (tenFiberSingleTrace(tfx, &(tfml->fiber[fibrNum]), seed, dirIdx)) {
-        biffAddf(TEN, "%s: trouble on seed (%g,%g,%g) %u/%u, dir %u/%u", me,
-                seed[0], seed[1], seed[2], seedIdx, seedNum, dirIdx, dirNum);
-        return 1;
-      }
-      if (tfx->verbose) {
-        if (tenFiberStopUnknown == tfml->fiber[fibrNum].whyNowhere) {
-          fprintf(stderr, "%s: (%g,%g,%g) ->\n"
-                  "   steps = %u,%u; len = %g,%g; whyStop = %s,%s\n",
-                  me, seed[0], seed[1], seed[2],
-                  tfml->fiber[fibrNum].stepNum[0],
-                  tfml->fiber[fibrNum].stepNum[1],
-                  tfml->fiber[fibrNum].halfLen[0],
-                  tfml->fiber[fibrNum].halfLen[1],
-                  airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyStop[0]),
-                  airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyStop[1]));
-        } else {
-          fprintf(stderr, "%s: (%g,%g,%g) -> whyNowhere: %s\n",
-                  me, seed[0], seed[1], seed[2],
-                  airEnumStr(tenFiberStop, tfml->fiber[fibrNum].whyNowhere));
-        }
-      }
-      fibrNum++;
+    fiberStart[seedIdx+1] = fiberStart[seedIdx] + dirNum;
+  }
+  shr.fiberStart = fiberStart;
+  /* if the airArray was already this long, this is a no-op.  Otherwise,
+     via the callbacks, it will create the tenFiberSingles we need, or
+     clear out the ones that we don't */
+  airArrayLenSet(tfml->fiberArr, fiberStart[shr.seedNum]);
+  if (fiberStart[shr.seedNum] && !tfml->fiber) {
+    biffAddf(TEN, "%s: couldn't allocate %u fibers", me,
+             fiberStart[shr.seedNum]);
+    airMopError(mop); return 1;
+  }
+  if (!shr.seedNum) {
+    tfml->probeNum = tfml->fillNum = 0;
+    airMopOkay(mop);
+    return 0;
+  }
+
+  if (tfx->seedSort) {
+    seedOrder = AIR_CALLOC(shr.seedNum, unsigned int);
+    if (!seedOrder) {
+      biffAddf(TEN, "%s: couldn't allocate seed order array", me);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, seedOrder, airFree, airMopAlways);
+    if (_fiberMultiSeedSort(tfx, seedOrder, shr.seedData, shr.seedNum)) {
+      biffAddf(TEN, "%s: trouble sorting seeds", me);
+      airMopError(mop); return 1;
     }
+    shr.seedOrder = seedOrder;
+  } else {
+    shr.seedOrder = NULL;
+  }
+  shr.seedChunk = AIR_MAX(1, shr.seedNum/(16*numThreads));
+  shr.seedChunk = AIR_MIN(shr.seedChunk, TEN_FIBER_INCR);
+  jobNum = (shr.seedNum + shr.seedChunk - 1)/shr.seedChunk;
+  numThreads = nrrdThreadNum(numThreads, jobNum);
+  shr.tfx = AIR_CALLOC(numThreads, tenFiberContext *);
+  airMopAdd(mop, shr.tfx, airFree, airMopAlways);
+  shr.errSeed = AIR_CALLOC(jobNum, unsigned int);
+  airMopAdd(mop, shr.errSeed, airFree, airMopAlways);
+  shr.err = AIR_CALLOC(jobNum, char *);
+  airMopAdd(mop, shr.err, airFree, airMopAlways);
+  if (!(shr.tfx && shr.errSeed && shr.err)) {
+    biffAddf(TEN, "%s: couldn't allocate per-thread and per-job arrays",
+             me);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, &shr, _fiberMultiErrNix, airMopAlways);
+  shr.tfx[0] = tfx;
+  for (tidx=1; tidx<numThreads; tidx++) {
+    shr.tfx[tidx] = tenFiberContextCopy(tfx);
+    if (!shr.tfx[tidx]) {
+      biffAddf(TEN, "%s: couldn't copy context for thread %u", me, tidx);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, shr.tfx[tidx], (airMopper)tenFiberContextNix,
+              airMopAlways);
+  }
+  if (nrrdThreadRun(numThreads, jobNum, _fiberMultiJob, &shr)) {
+    biffMovef(TEN, NRRD, "%s: trouble tracing", me);
+    airMopError(mop); return 1;
+  }
+  tfml->probeNum = tfx->gtx->probeNum - probeNum0;
+  tfml->fillNum = tfx->gtx->fillNum - fillNum0;
+  for (tidx=1; tidx<numThreads; tidx++) {
+    tfml->probeNum += shr.tfx[tidx]->gtx->probeNum;
+    tfml->fillNum += shr.tfx[tidx]->gtx->fillNum;
+  }
+  if (tfx->verbose) {
+    fprintf(stderr, "%s: %s gage probes, %s (%g%%) refilled iv3 caches\n",
+            me, airSprintSize_t(stmp[0], tfml->probeNum),
+            airSprintSize_t(stmp[1], tfml->fillNum),
+            (tfml->probeNum
+             ? 100.0*AIR_CAST(double, tfml->fillNum)/tfml->probeNum
+             : 0.0));
+  }
+  /* report the failed seed with the lowest index */
+  errJob = jobNum;
+  for (jobIdx=0; jobIdx<jobNum; jobIdx++) {
+    if (shr.err[jobIdx]
+        && (jobNum == errJob || shr.errSeed[jobIdx] < shr.errSeed[errJob])) {
+      errJob = jobIdx;
+    }
+  }
+  if (errJob < jobNum) {
+    ELL_3V_COPY(seed, shr.seedData + 3*shr.errSeed[errJob]);
+    biffAddf(TEN, "%s", shr.err[errJob]);
+    biffAddf(TEN, "%s: trouble on seed (%g,%g,%g) %u/%u", me,
+             seed[0], seed[1], seed[2], shr.errSeed[errJob], shr.seedNum);
+    airMopError(mop); return 1;
   }
-  /* if the airArray got to be its length only because of the work above,
-     then the following will be a no-op.  Otherwise, via the callbacks,
-     it will clear out the tenFiberSingle's that we didn't create here */
-  airArrayLenSet(tfml->fiberArr, fibrNum);
 
   airMopOkay(mop);
   return 0;
@@ -168,7 +168,13 @@ _tenFiberContextCommonNew(const Nrrd *vol, int useDwi,
   tfx->minNumSteps = 0;
   tfx->useIndexSpace = tenDefFiberUseIndexSpace;
   tfx->verbose = 0;
+  tfx->numThreads = 1;
+  tfx->seedSort = AIR_FALSE;
   tfx->stepSize = tenDefFiberStepSize;
+  tfx->stepSizeMin = 0;
+  tfx->stepSizeMax = 0;
+  tfx->errTol = tenDefFiberErrTol;
+  tfx->stepSizeCurr = tfx->stepSize;
   tfx->maxHalfLen = tenDefFiberMaxHalfLen;
   tfx->minWholeLen = 0.0;
   tfx->confThresh = 0.5; /* why do I even bother setting these- they'll
@@ -177,6 +183,7 @@ _tenFiberContextCommonNew(const Nrrd *vol, int useDwi,
   tfx->minRadius = 1;    /* above lament applies here as well */
   tfx->minFraction = 0.5; /* and here */
   tfx->wPunct = tenDefFiberWPunct;
+  tfx->resample = AIR_FALSE;
 
   GAGE_QUERY_RESET(tfx->query);
   tfx->mframe[0] = vol->measurementFrame[0][0];
@@ -769,6 +776,25 @@ tenFiberParmSet(tenFiberContext *tfx, int parm, double val) {
     case tenFiberParmVerbose:
       tfx->verbose = AIR_CAST(int, val);
       break;
+    case tenFiberParmNumThreads:
+      tfx->numThreads = AIR_CAST(unsigned int,
+                                 AIR_CLAMP(1, val, TEN_FIBER_THREAD_MAX));
+      break;
+    case tenFiberParmSeedSort:
+      tfx->seedSort = !!val;
+      break;
+    case tenFiberParmErrTol:
+      tfx->errTol = val;
+      break;
+    case tenFiberParmStepSizeMin:
+      tfx->stepSizeMin = val;
+      break;
+    case tenFiberParmStepSizeMax:
+      tfx->stepSizeMax = val;
+      break;
+    case tenFiberParmResample:
+      tfx->resample = !!val;
+      break;
     default:
       fprintf(stderr, "%s: WARNING!!! tenFiberParm %d not handled\n",
               me, parm);
@@ -807,6 +833,22 @@ tenFiberUpdate(tenFiberContext *tfx) {
     biffAddf(TEN, "%s: no fiber stopping criteria set", me);
     return 1;
   }
+  if (tenFiberIntgRK45 == tfx->intg) {
+    if (!( tfx->stepSize > 0 )) {
+      biffAddf(TEN, "%s: initial step size %g not > 0", me, tfx->stepSize);
+      return 1;
+    }
+    if (!( tfx->errTol > 0 )) {
+      biffAddf(TEN, "%s: error tolerance %g not > 0", me, tfx->errTol);
+      return 1;
+    }
+    if (tfx->stepSizeMin && tfx->stepSizeMax
+        && !( tfx->stepSizeMin <= tfx->stepSizeMax )) {
+      biffAddf(TEN, "%s: step size min %g not <= max %g", me,
+               tfx->stepSizeMin, tfx->stepSizeMax);
+      return 1;
+    }
+  }
   /* HEY there should be a better place for setting this */
   if (tfx->fiberProbeItem) {
     GAGE_QUERY_ITEM_ON(tfx->query, tfx->fiberProbeItem);
@@ -826,41 +868,67 @@ tenFiberUpdate(tenFiberContext *tfx) {
   return 0;
 }
 
+/*
+** the gage answer pointers in a tenFiberContext point into the answer
+** buffer of its pvl; this finds the same answer in another pvl
+*/
+static const double *
+_tenFiberAnswerRebase(const gagePerVolume *pvlNew,
+                      const gagePerVolume *pvlOld, const double *ans) {
+
+  return (ans
+          ? pvlNew->answer + (ans - pvlOld->answer)
+          : NULL);
+}
+
 /*
 ** exact same precautions about utility of this as with gageContextCopy!!!
 ** So: only after tenFiberUpdate, and don't touch anything, and don't
 ** call anything except tenFiberTrace and tenFiberContextNix
+**
+** uses biff; returns NULL on error
 */
 tenFiberContext *
 tenFiberContextCopy(tenFiberContext *oldTfx) {
   static const char me[]="tenFiberContextCopy";
   tenFiberContext *tfx;
 
+  if (!oldTfx) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return NULL;
+  }
   if (oldTfx->useDwi) {
-    fprintf(stderr, "!%s: sorry, can't copy DWI contexts; bye.\n", me);
-    exit(1);
+    biffAddf(TEN, "%s: sorry, can't copy DWI contexts", me);
+    return NULL;
   }
   tfx = AIR_CALLOC(1, tenFiberContext);
+  if (!tfx) {
+    biffAddf(TEN, "%s: couldn't allocate new context", me);
+    return NULL;
+  }
   memcpy(tfx, oldTfx, sizeof(tenFiberContext));
   tfx->ksp = nrrdKernelSpecCopy(oldTfx->ksp);
   tfx->gtx = gageContextCopy(oldTfx->gtx);
+  if (!( tfx->ksp && tfx->gtx )) {
+    biffMovef(TEN, GAGE, "%s: couldn't copy kernel or gage context", me);
+    tfx->ksp = nrrdKernelSpecNix(tfx->ksp);
+    tfx->gtx = gageContextNix(tfx->gtx);
+    free(tfx);
+    return NULL;
+  }
   tfx->pvl = tfx->gtx->pvl[0];  /* HEY! gage API sucks */
-  tfx->gageTen = gageAnswerPointer(tfx->gtx, tfx->pvl, tenGageTensor);
-  tfx->gageEval = gageAnswerPointer(tfx->gtx, tfx->pvl, tenGageEval0);
-  /* HEY: COPY AND PASTE */
-  tfx->gageEvec
-    = gageAnswerPointer(tfx->gtx, tfx->pvl,
-                        (tenFiberTypeEvec0 == tfx->fiberType
-                         ? tenGageEvec0
-                         : (tenFiberTypeEvec1 == tfx->fiberType
-                            ? tenGageEvec1
-                            : tenGageEvec2)));
-  tfx->gageAnisoStop = gageAnswerPointer(tfx->gtx, tfx->pvl,
-                                         tfx->anisoStopType);
-  tfx->gageAnisoSpeed = (tfx->anisoSpeedType
-                         ? gageAnswerPointer(tfx->gtx, tfx->pvl,
-                                             tfx->anisoSpeedType)
-                         : NULL);
+  tfx->gageTen = _tenFiberAnswerRebase(tfx->pvl, oldTfx->pvl,
+                                       oldTfx->gageTen);
+  tfx->gageEval = _tenFiberAnswerRebase(tfx->pvl, oldTfx->pvl,
+                                        oldTfx->gageEval);
+  tfx->gageEvec = _tenFiberAnswerRebase(tfx->pvl, oldTfx->pvl,
+                                        oldTfx->gageEvec);
+  tfx->gageAnisoStop = _tenFiberAnswerRebase(tfx->pvl, oldTfx->pvl,
+                                             oldTfx->gageAnisoStop);
+  tfx->gageAnisoSpeed = _tenFiberAnswerRebase(tfx->pvl, oldTfx->pvl,
+                                              oldTfx->gageAnisoSpeed);
+  tfx->gageTen2 = _tenFiberAnswerRebase(tfx->pvl, oldTfx->pvl,
+                                        oldTfx->gageTen2);
   return tfx;
 }
 
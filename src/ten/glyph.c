@@ -670,8 +670,8 @@ tenGlyphGen(limnObject *glyphsLimn, echoScene *glyphsEcho,
     glyphsLimn->setVertexRGBAFromLook = svRGBAfl;
   }
   if (glyphsEcho) {
-    split = echoListSplit3(glyphsEcho, list, 10);
-    echoObjectAdd(glyphsEcho, split);
+    split = echoListBVH(glyphsEcho, list);
+    echoObjectAdd(glyphsEcho, split ? split : list);
   }
 
   airMopOkay(mop);
@@ -78,7 +78,6 @@ _TEN_SQE_FIT(tenModel1Cylinder)
 
 _TEN_NLL
 _TEN_NLL_GRAD_STUB
-_TEN_NLL_FIT_STUB
 
 tenModel
 _tenModel1Cylinder = {
@@ -127,7 +127,6 @@ _TEN_SQE_FIT(tenModel1Tensor2)
 
 _TEN_NLL
 _TEN_NLL_GRAD_STUB
-_TEN_NLL_FIT_STUB
 
 tenModel
 _tenModel1Tensor2 = {
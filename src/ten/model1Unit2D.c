@@ -64,7 +64,6 @@ _TEN_SQE_FIT(tenModel1Unit2D)
 
 _TEN_NLL
 _TEN_NLL_GRAD_STUB
-_TEN_NLL_FIT_STUB
 
 tenModel
 _tenModel1Unit2D = {
@@ -61,7 +61,6 @@ _TEN_SQE_FIT(tenModelB0)
 
 _TEN_NLL
 _TEN_NLL_GRAD_STUB
-_TEN_NLL_FIT_STUB
 
 tenModel
 _tenModelB0 = {
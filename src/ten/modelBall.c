@@ -63,7 +63,6 @@ _TEN_SQE_FIT(tenModelBall)
 
 _TEN_NLL
 _TEN_NLL_GRAD_STUB
-_TEN_NLL_FIT_STUB
 
 tenModel
 _tenModelBall = {
@@ -87,6 +86,6 @@ _tenModelBall = {
   sqeFit,
   nll,
   nllGrad,
-  nllFit
+  NULL
 };
 const tenModel *const tenModelBall = &_tenModelBall;
@@ -85,7 +85,6 @@ _TEN_SQE_FIT(tenModelBall1Cylinder)
 
 _TEN_NLL
 _TEN_NLL_GRAD_STUB
-_TEN_NLL_FIT_STUB
 
 tenModel
 _tenModelBall1Cylinder = {
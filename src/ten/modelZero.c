@@ -115,20 +115,6 @@ _TEN_SQE_FIT(tenModelZero)
 _TEN_NLL
 _TEN_NLL_GRAD_STUB
 
-static double
-nllFit(double *parm, const tenExperSpec *espec,
-       const double *dwiMeas, const double *parmInit,
-       int rician, double sigma, int knownB0) {
-  AIR_UNUSED(parm);
-  AIR_UNUSED(espec);
-  AIR_UNUSED(dwiMeas);
-  AIR_UNUSED(parmInit);
-  AIR_UNUSED(rician);
-  AIR_UNUSED(sigma);
-  AIR_UNUSED(knownB0);
-  return AIR_NAN;
-}
-
 tenModel
 _tenModelZero = {
   TEN_MODEL_STR_ZERO,
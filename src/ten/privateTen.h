@@ -415,31 +415,14 @@ nllGrad(double *grad, const double *parm,       \
   return;                                       \
 }
 
-#define _TEN_NLL_FIT_STUB                               \
-static double                                           \
-nllFit(double *parm, const tenExperSpec *espec,         \
-       const double *dwiMeas, const double *parmInit,   \
-       int rician, double sigma, int knownB0) {         \
-  unsigned int pp;                                      \
-                                                        \
-  AIR_UNUSED(espec);                                    \
-  AIR_UNUSED(dwiMeas);                                  \
-  AIR_UNUSED(rician);                                   \
-  AIR_UNUSED(sigma);                                    \
-  AIR_UNUSED(knownB0);                                  \
-  for (pp=0; pp<PARM_NUM; pp++) {                       \
-    parm[pp] = parmInit[pp];                            \
-  }                                                     \
-  return 0;                                             \
-}
-
 #define _TEN_MODEL_FIELDS                                           \
   PARM_NUM, parmDesc,                                               \
   simulate,                                                         \
   parmSprint, parmAlloc, parmRand,                                  \
   parmStep, parmDist, parmCopy, parmConvert,                        \
   sqe, sqeGrad, sqeFit,                                             \
-  nll, nllGrad, nllFit
+  nll, nllGrad,                                                     \
+  NULL /* nllFit: no model has maximum-likelihood fitting yet */
 
 #ifdef __cplusplus
 }
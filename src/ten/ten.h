@@ -721,9 +721,11 @@ enum {
   tenFiberIntgEuler,     /* 1: dumb but fast */
   tenFiberIntgMidpoint,  /* 2: 2nd order Runge-Kutta */
   tenFiberIntgRK4,       /* 3: 4rth order Runge-Kutta */
+  tenFiberIntgRK45,      /* 4: adaptive step size Dormand-Prince 5(4)
+                            Runge-Kutta, with embedded error estimate */
   tenFiberIntgLast
 };
-#define TEN_FIBER_INTG_MAX  3
+#define TEN_FIBER_INTG_MAX  4
 
 /*
 ******** tenFiberStop* enum
@@ -779,9 +781,31 @@ enum {
                                   instead of default world */
   tenFiberParmWPunct,          /* 3: tensor-line parameter */
   tenFiberParmVerbose,         /* 4: verbosity */
+  tenFiberParmNumThreads,      /* 5: # threads for tenFiberMultiTrace */
+  tenFiberParmSeedSort,        /* 6: non-zero iff tenFiberMultiTrace should
+                                  trace seeds in Z-order (Morton order) of
+                                  their index-space positions */
+  tenFiberParmErrTol,          /* 7: with tenFiberIntgRK45: max error (in
+                                  world space) allowed in one step */
+  tenFiberParmStepSizeMin,     /* 8: with tenFiberIntgRK45: smallest step
+                                  size allowed (0: stepSize/10) */
+  tenFiberParmStepSizeMax,     /* 9: with tenFiberIntgRK45: largest step
+                                  size allowed (0: 10*stepSize) */
+  tenFiberParmResample,        /* 10: non-zero iff fiber vertices should be
+                                  resampled to spacing stepSize (in world
+                                  space arc length), when the fiber goes
+                                  into a nrrd (rather than a buffer) */
   tenFiberParmLast
 };
-#define TEN_FIBER_PARM_MAX        4
+#define TEN_FIBER_PARM_MAX        10
+
+/*
+******** #define TEN_FIBER_THREAD_MAX
+**
+** max number of threads (each with its own copy of the tenFiberContext)
+** that tenFiberMultiTrace will use
+*/
+#define TEN_FIBER_THREAD_MAX 512
 
 enum {
   tenTripleTypeUnknown,    /* 0: nobody knows */
@@ -819,11 +843,19 @@ typedef struct {
     stop,               /* BITFLAG for different reasons to stop a fiber */
     useIndexSpace,      /* output in index space, not world space */
     verbose;            /* blah blah blah */
+  unsigned int numThreads; /* # threads used by tenFiberMultiTrace, each
+                              with its own copy of this context */
+  int seedSort;         /* tenFiberMultiTrace traces seeds in Z-order of
+                           position, rather than given order */
   double anisoThresh,   /* anisotropy threshold */
     anisoSpeedFunc[3];  /* parameters of mapping aniso to speed */
   unsigned int maxNumSteps, /* max # steps allowed on one fiber *half* */
     minNumSteps;        /* min signficiant # steps on *whole* fiber */
-  double stepSize,      /* step size in world space */
+  double stepSize,      /* step size in world space; with tenFiberIntgRK45
+                           this is only the initial step size */
+    stepSizeMin,        /* with tenFiberIntgRK45: bounds on step size, */
+    stepSizeMax,        /* or 0 to use stepSize/10 and 10*stepSize */
+    errTol,             /* with tenFiberIntgRK45: max error per step */
     maxHalfLen,         /* longest propagation (forward or backward) allowed
                            from midpoint */
     minWholeLen,        /* minimum significant length of whole fiber */
@@ -831,6 +863,7 @@ typedef struct {
     minRadius,          /* minimum radius of curvature of path */
     minFraction;        /* minimum fractional constituency in multi-tensor */
   double wPunct;        /* knob for tensor lines */
+  int resample;         /* resample vertices to uniform spacing stepSize */
   unsigned int ten2Which;  /* which path to follow in 2-tensor tracking */
   /* ---- internal ----- */
   gageQuery query;      /* query we'll send to gageQuerySet */
@@ -842,6 +875,7 @@ typedef struct {
     wDir[3],            /* difference between this and last world space pos */
     lastDir[3],         /* previous value of wDir */
     seedEvec[3];        /* principal eigenvector first found at seed point */
+  double stepSizeCurr;  /* with tenFiberIntgRK45: current step size */
   int lastDirSet,       /* lastDir[] is usefully set */
     lastTenSet;         /* lastTen[] is usefully set */
   unsigned int ten2Use; /* which of the 2-tensors was last used */
@@ -860,7 +894,9 @@ typedef struct {
   double radius;        /* current radius of curvature */
   /* ---- output ------- */
   double halfLen[2];    /* length of each fiber half in world space */
-  unsigned int numSteps[2]; /* how many samples are used for each fiber half */
+  unsigned int numSteps[2]; /* how many steps were taken along each fiber
+                               half: one less than the number of vertices
+                               in the half (which includes the seed) */
   int whyStop[2],       /* why backward/forward (0/1) tracing stopped
                            (from tenFiberStop* enum) */
     whyNowhere;         /* why fiber never got started (from tenFiberStop*) */
@@ -897,6 +933,9 @@ typedef struct {
   tenFiberSingle *fiber;
   unsigned int fiberNum;
   airArray *fiberArr;
+  size_t probeNum,      /* # gage probes, and # of those needing iv3 */
+    fillNum;            /* refills, summed over all threads of the last
+                           tenFiberMultiTrace */
 } tenFiberMulti;
 
 /*
@@ -1173,6 +1212,9 @@ typedef struct {
 #define TEN_MODEL_DIFF_MAX 0.006  /* in units of mm^2/sec; diffusivity of
                                      water is about 0.003 mm^2/sec */
 #define TEN_MODEL_PARM_GRAD_EPS 0.000005 /* for gradient calculations */
+#define TEN_MODEL_FIT_THREAD_MAX 512     /* max # threads for fitting */
+#define TEN_MODEL_FIT_CHUNK_MAX 256      /* max # samples a fitting thread
+                                            grabs at once */
 
 /*
 ******** struct tenModel
@@ -1238,6 +1280,8 @@ typedef struct tenModel_t {
                   const tenExperSpec *espec,
                   double *dwiBuff, const double *dwiMeas,
                   int rician, double sigma);
+  /* NULL if the model has no maximum-likelihood fitting (which is
+     so far the case for all of them) */
   double (*nllFit)(double *parm, const tenExperSpec *espec,
                    const double *dwiMeas, const double *parmInit,
                    int rician, double sigma, int knownB0);
@@ -1255,6 +1299,7 @@ TEN_EXPORT int tenDefFiberAnisoStopType;
 TEN_EXPORT double tenDefFiberAnisoThresh;
 TEN_EXPORT int tenDefFiberIntg;
 TEN_EXPORT double tenDefFiberWPunct;
+TEN_EXPORT double tenDefFiberErrTol;
 
 /* triple.c */
 TEN_EXPORT void tenTripleConvertSingle_d(double dst[3],
@@ -1519,6 +1564,10 @@ TEN_EXPORT int tenAnisoPlot(Nrrd *nout, int aniso, unsigned int res,
                             int hflip, int whole, int nanout);
 TEN_EXPORT int tenAnisoVolume(Nrrd *nout, const Nrrd *nin,
                               int aniso, double confThresh);
+TEN_EXPORT int tenAnisoVolumeMulti(Nrrd *nout, const Nrrd *nin,
+                                   const int *aniso, unsigned int anisoNum,
+                                   double confThresh, int closedForm,
+                                   unsigned int numThreads);
 TEN_EXPORT int tenAnisoHistogram(Nrrd *nout, const Nrrd *nin,
                                  const Nrrd *nwght, int right,
                                  int version, unsigned int resolution);
@@ -1667,13 +1716,17 @@ TEN_EXPORT int tenModelSqeFit(Nrrd *nparm,
                               const tenExperSpec *espec, const Nrrd *ndwi,
                               int knownB0, int saveB0, int typeOut,
                               unsigned int minIter, unsigned int maxIter,
-                              unsigned int starts, double convEps,
-                              airRandMTState *rng,
-                              int verbose);
+                              unsigned int starts, unsigned int startsAgree,
+                              double convEps, airRandMTState *rng,
+                              unsigned int numThreads, int verbose);
 TEN_EXPORT int tenModelNllFit(Nrrd *nparm, Nrrd **nnllP,
                               const tenModel *model,
                               const tenExperSpec *espec, const Nrrd *ndwi,
-                              int rician, double sigma, int knownB0);
+                              int rician, double sigma, int knownB0,
+                              int saveB0, int typeOut,
+                              unsigned int starts, unsigned int startsAgree,
+                              double convEps, airRandMTState *rng,
+                              unsigned int numThreads, int verbose);
 TEN_EXPORT int tenModelConvert(Nrrd *nparmDst, int *convRet,
                                const tenModel *modelDst,
                                const Nrrd *nparmSrc,
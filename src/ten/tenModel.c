@@ -416,39 +416,250 @@ _tenModelSqeFitSingle(const tenModel *model,
   return val;
 }
 
-int
-tenModelSqeFit(Nrrd *nparm,
-               Nrrd **nsqeP, Nrrd **nconvP, Nrrd **niterP,
-               const tenModel *model,
-               const tenExperSpec *espec, const Nrrd *ndwi,
-               int knownB0, int saveB0, int typeOut,
-               unsigned int minIter, unsigned int maxIter,
-               unsigned int starts, double convEps,
-               airRandMTState *_rng, int verbose) {
-  static const char me[]="tenModelSqeFit";
+/*
+** state shared by all threads of tenModelSqeFit and tenModelNllFit
+*/
+typedef struct {
+  /* input */
+  const tenModel *model;
+  const tenExperSpec *espec;
+  const Nrrd *ndwi;
+  int knownB0, saveB0, nll, rician, verbose;
+  double sigma, convEps;
+  unsigned int minIter, maxIter, starts, startsAgree, saveParmNum,
+    seed;                      /* base of per-sample RNG seeds */
+  /* output; all but nparm may be NULL */
+  Nrrd *nparm, *nerr, *nconv, *niter;
+  /* work assignment: each nrrdThreadRun job is workChunk samples */
+  size_t numSamp,              /* total number of samples to fit */
+    workChunk;                 /* # samples in one job */
+  struct _tenModelFitTask_t **task; /* per-thread state */
+} _tenModelFitShared;
+
+/*
+** per-thread state; nothing in here is seen by other threads
+*/
+typedef struct _tenModelFitTask_t {
+  _tenModelFitShared *shr;
+  unsigned int threadIdx;
+  airRandMTState *rng;
+  double *ddwi, *dwibuff, *dparm, *dparmBest,
+    startsTaken;               /* # starts used by this thread */
+} _tenModelFitTask;
+
+static _tenModelFitTask *
+_tenModelFitTaskNix(_tenModelFitTask *task) {
+
+  if (task) {
+    task->rng = airRandMTStateNix(task->rng);
+    airFree(task->ddwi);
+    airFree(task->dwibuff);
+    airFree(task->dparm);
+    airFree(task->dparmBest);
+    free(task);
+  }
+  return NULL;
+}
+
+static _tenModelFitTask *
+_tenModelFitTaskNew(_tenModelFitShared *shr, unsigned int threadIdx) {
+  _tenModelFitTask *task;
+
+  task = AIR_CALLOC(1, _tenModelFitTask);
+  if (task) {
+    task->shr = shr;
+    task->threadIdx = threadIdx;
+    task->rng = airRandMTStateNew(0);
+    task->ddwi = AIR_CALLOC(shr->espec->imgNum, double);
+    task->dwibuff = AIR_CALLOC(shr->espec->imgNum, double);
+    task->dparm = shr->model->alloc();
+    task->dparmBest = shr->model->alloc();
+    if (!( task->rng && task->ddwi && task->dwibuff
+           && task->dparm && task->dparmBest )) {
+      task = _tenModelFitTaskNix(task);
+    }
+  }
+  return task;
+}
+
+/*
+** _tenModelFitSample
+**
+** does all the (random) starts of fitting for one sample, and
+** saves the results.  The RNG is re-seeded from the sample index,
+** so that the result is the same regardless of which thread got
+** this sample.  If shr->startsAgree is non-zero, the starts stop
+** as soon as that many of them (including the best one) converged
+** to within convEps (as measured by model->dist) of the best fit.
+** Returns the number of starts actually used.
+*/
+static unsigned int
+_tenModelFitSample(_tenModelFitTask *task, size_t II) {
+  _tenModelFitShared *shr;
+  const tenModel *model;
+  double (*lup)(const void *v, size_t I), (*ins)(void *v, size_t I, double d),
+    err, errBest, cvf, convFrac;
+  unsigned int ii, ss, dwiNum, itak, itersTaken, agree;
+  int same;
+
+  shr = task->shr;
+  model = shr->model;
+  dwiNum = shr->espec->imgNum;
+  lup = nrrdDLookup[shr->ndwi->type];
+  ins = nrrdDInsert[shr->nparm->type];
+  for (ii=0; ii<dwiNum; ii++) {
+    task->ddwi[ii] = lup(shr->ndwi->data, ii + dwiNum*II);
+  }
+  airSrandMT_r(task->rng, shr->seed + AIR_UINT(II));
+  errBest = DBL_MAX; /* forces at least one improvement */
+  convFrac = 0;
+  itersTaken = 0;
+  agree = 0;
+  for (ss=0; ss<shr->starts; ss++) {
+    if (shr->knownB0) {
+      task->dparm[0] = tenExperSpecKnownB0Get(shr->espec, task->ddwi);
+    }
+    model->rand(task->dparm, task->rng, shr->knownB0);
+    if (shr->nll) {
+      model->nllFit(task->dparm, shr->espec, task->ddwi, task->dparm,
+                    shr->rician, shr->sigma, shr->knownB0);
+      /* re-evaluate, so starts are compared in the same way for all
+         models, regardless of what nllFit returns */
+      err = model->nll(task->dparm, shr->espec, task->dwibuff, task->ddwi,
+                       shr->rician, shr->sigma, shr->knownB0);
+      cvf = 0;
+      itak = 0;
+    } else {
+      err = model->sqeFit(task->dparm, &cvf, &itak,
+                          shr->espec, task->dwibuff, task->ddwi,
+                          task->dparm, shr->knownB0,
+                          shr->minIter, shr->maxIter,
+                          shr->convEps, shr->verbose);
+    }
+    same = (DBL_MAX != errBest
+            && model->dist(task->dparm, task->dparmBest) < shr->convEps);
+    if (err <= errBest) {
+      errBest = err;
+      model->copy(task->dparmBest, task->dparm);
+      itersTaken = itak;
+      convFrac = cvf;
+      agree = same ? agree + 1 : 1;
+    } else if (same) {
+      agree++;
+    }
+    if (shr->startsAgree && agree >= shr->startsAgree) {
+      ss++;
+      break;
+    }
+  }
+  for (ii=0; ii<shr->saveParmNum; ii++) {
+    ins(shr->nparm->data, ii + shr->saveParmNum*II,
+        shr->saveB0 ? task->dparmBest[ii] : task->dparmBest[ii+1]);
+  }
+  if (shr->nerr) {
+    ins(shr->nerr->data, II, errBest);
+  }
+  if (shr->nconv) {
+    nrrdDInsert[nrrdTypeDouble](shr->nconv->data, II, convFrac);
+  }
+  if (shr->niter) {
+    nrrdDInsert[nrrdTypeUInt](shr->niter->data, II, itersTaken);
+  }
+  return ss;
+}
+
+/*
+** fits the samples in one job's chunk, with the calling thread's task
+*/
+static void
+_tenModelFitJob(void *_shr, unsigned int jobIdx, unsigned int threadIdx) {
+  _tenModelFitShared *shr;
+  _tenModelFitTask *task;
+  size_t II, IIlo, IIhi;
   char doneStr[13];
-  double *ddwi, *dwibuff, sqe, sqeBest,
-    *dparm, *dparmBest,
-    (*ins)(void *v, size_t I, double d),
-    (*lup)(const void *v, size_t I);
+
+  shr = AIR_CAST(_tenModelFitShared *, _shr);
+  task = shr->task[threadIdx];
+  IIlo = jobIdx*shr->workChunk;
+  IIhi = AIR_MIN(IIlo + shr->workChunk, shr->numSamp);
+  if (shr->verbose && !threadIdx) {
+    /* only the calling thread reports progress */
+    fprintf(stderr, "%s", airDoneStr(0, IIlo, shr->numSamp, doneStr));
+    fflush(stderr);
+  }
+  for (II=IIlo; II<IIhi; II++) {
+    task->startsTaken += _tenModelFitSample(task, II);
+  }
+  return;
+}
+
+static int
+_tenModelFitInfoCopy(Nrrd *nout, const Nrrd *ndwi, const int *axmap) {
+
+  return (nrrdAxisInfoCopy(nout, ndwi, axmap, NRRD_AXIS_INFO_SIZE_BIT)
+          || nrrdBasicInfoCopy(nout, ndwi,
+                               NRRD_BASIC_INFO_DATA_BIT
+                               | NRRD_BASIC_INFO_TYPE_BIT
+                               | NRRD_BASIC_INFO_BLOCKSIZE_BIT
+                               | NRRD_BASIC_INFO_DIMENSION_BIT
+                               | NRRD_BASIC_INFO_CONTENT_BIT
+                               | NRRD_BASIC_INFO_COMMENTS_BIT
+                               | (nrrdStateKeyValuePairsPropagate
+                                  ? 0
+                                  : NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT)));
+}
+
+static Nrrd *
+_tenModelFitOutput(Nrrd **nP, int type, const size_t *size,
+                   unsigned int dim) {
+  Nrrd *nout;
+
+  if (!nP) {
+    return NULL;
+  }
+  nout = *nP;
+  if (!nout) {
+    nout = nrrdNew();
+    *nP = nout;
+  }
+  if (nrrdMaybeAlloc_nva(nout, type, dim, size)) {
+    return NULL;
+  }
+  return nout;
+}
+
+/*
+** _tenModelFit
+**
+** the shared implementation of tenModelSqeFit and tenModelNllFit
+*/
+static int
+_tenModelFit(const char *me, _tenModelFitShared *shr,
+             Nrrd **nerrP, Nrrd **nconvP, Nrrd **niterP,
+             int typeOut, airRandMTState *_rng, unsigned int numThreads) {
   airArray *mop;
-  unsigned int saveParmNum, dwiNum, ii, lablen, itersTaken;
-  size_t szOut[NRRD_DIM_MAX], II, numSamp;
-  int axmap[NRRD_DIM_MAX], erraxmap[NRRD_DIM_MAX], fitVerbose;
-  const char *dwi;
-  char *parm;
-  airRandMTState *rng;
-  Nrrd *nsqe, *nconv, *niter;
+  unsigned int ii, tidx, dwiNum, lablen, jobNum;
+  double startsTaken;
+  size_t szOut[NRRD_DIM_MAX];
+  int axmap[NRRD_DIM_MAX], erraxmap[NRRD_DIM_MAX];
+  const Nrrd *ndwi;
+  char doneStr[13];
 
-  /* nsqeP, nconvP, niterP can be NULL */
-  if (!( nparm && model && espec && ndwi )) {
+  /* nerrP, nconvP, niterP can be NULL */
+  if (!( shr->nparm && shr->model && shr->espec && shr->ndwi )) {
     biffAddf(TEN, "%s: got NULL pointer", me);
     return 1;
   }
-  if (!( starts > 0 )) {
+  ndwi = shr->ndwi;
+  if (!( shr->starts > 0 )) {
     biffAddf(TEN, "%s: need non-zero starts", me);
     return 1;
   }
+  if (!( numThreads <= TEN_MODEL_FIT_THREAD_MAX )) {
+    biffAddf(TEN, "%s: numThreads %u not in valid range [0,%u]", me,
+             numThreads, TEN_MODEL_FIT_THREAD_MAX);
+    return 1;
+  }
   if (!( nrrdTypeFloat == typeOut || nrrdTypeDouble == typeOut )) {
     biffAddf(TEN, "%s: typeOut must be %s or %s, not %s", me,
              airEnumStr(nrrdType, nrrdTypeFloat),
@@ -457,26 +668,20 @@ tenModelSqeFit(Nrrd *nparm,
     return 1;
   }
   dwiNum = ndwi->axis[0].size;
-  if (espec->imgNum != dwiNum) {
+  if (shr->espec->imgNum != dwiNum) {
     biffAddf(TEN, "%s: espec expects %u images but dwi has %u on axis 0",
-             me, espec->imgNum, AIR_CAST(unsigned int, dwiNum));
+             me, shr->espec->imgNum, AIR_CAST(unsigned int, dwiNum));
     return 1;
   }
 
   /* allocate output (and set axmap) */
-  dparm = model->alloc();
-  dparmBest = model->alloc();
-  if (!( dparm && dparmBest )) {
-    biffAddf(TEN, "%s: couldn't allocate parm vecs", me);
-    return 1;
-  }
   mop = airMopNew();
-  airMopAdd(mop, dparm, airFree, airMopAlways);
-  airMopAdd(mop, dparmBest, airFree, airMopAlways);
-  saveParmNum = saveB0 ? model->parmNum : model->parmNum-1;
+  shr->saveParmNum = (shr->saveB0
+                      ? shr->model->parmNum
+                      : shr->model->parmNum-1);
   for (ii=0; ii<ndwi->dim; ii++) {
     szOut[ii] = (!ii
-                 ? saveParmNum
+                 ? shr->saveParmNum
                  : ndwi->axis[ii].size);
     axmap[ii] = (!ii
                  ? -1
@@ -485,219 +690,198 @@ tenModelSqeFit(Nrrd *nparm,
       erraxmap[ii-1] = AIR_CAST(int, ii);
     }
   }
-  if (nrrdMaybeAlloc_nva(nparm, typeOut, ndwi->dim, szOut)) {
+  if (nrrdMaybeAlloc_nva(shr->nparm, typeOut, ndwi->dim, szOut)) {
     biffMovef(TEN, NRRD, "%s: couldn't allocate output "
-              "(saveB0 %d, knownB0 %d)", me, saveB0, knownB0);
+              "(saveB0 %d, knownB0 %d)", me, shr->saveB0, shr->knownB0);
     airMopError(mop); return 1;
   }
-  if (nsqeP) {
-    nsqe = *nsqeP;
-    if (!nsqe) {
-      nsqe = nrrdNew();
-      *nsqeP = nsqe;
-    }
-    if (nrrdMaybeAlloc_nva(nsqe, typeOut, ndwi->dim-1, szOut+1)) {
-      biffMovef(TEN, NRRD, "%s: couldn't allocate error output", me);
-      airMopError(mop); return 1;
-    }
-  } else {
-    nsqe = NULL;
-  }
-  if (nconvP) {
-    nconv = *nconvP;
-    if (!nconv) {
-      nconv = nrrdNew();
-      *nconvP = nconv;
-    }
-    if (nrrdMaybeAlloc_nva(nconv, nrrdTypeDouble, ndwi->dim-1, szOut+1)) {
-      biffMovef(TEN, NRRD, "%s: couldn't allocate conv output", me);
-      airMopError(mop); return 1;
-    }
-  } else {
-    nconv = NULL;
-  }
-  if (niterP) {
-    niter = *niterP;
-    if (!niter) {
-      niter = nrrdNew();
-      *niterP = niter;
-    }
-    if (nrrdMaybeAlloc_nva(niter, nrrdTypeUInt, ndwi->dim-1, szOut+1)) {
-      biffMovef(TEN, NRRD, "%s: couldn't allocate iter output", me);
-      airMopError(mop); return 1;
-    }
-  } else {
-    niter = NULL;
-  }
-  ddwi = AIR_CALLOC(espec->imgNum, double);
-  dwibuff = AIR_CALLOC(espec->imgNum, double);
-  if (!(ddwi && dwibuff)) {
-    biffAddf(TEN, "%s: couldn't allocate dwi buffers", me);
+  shr->nerr = _tenModelFitOutput(nerrP, typeOut, szOut+1, ndwi->dim-1);
+  shr->nconv = _tenModelFitOutput(nconvP, nrrdTypeDouble,
+                                  szOut+1, ndwi->dim-1);
+  shr->niter = _tenModelFitOutput(niterP, nrrdTypeUInt,
+                                  szOut+1, ndwi->dim-1);
+  if ((nerrP && !shr->nerr)
+      || (nconvP && !shr->nconv)
+      || (niterP && !shr->niter)) {
+    biffMovef(TEN, NRRD, "%s: couldn't allocate error, conv, or iter "
+              "output", me);
     airMopError(mop); return 1;
   }
-  airMopAdd(mop, ddwi, airFree, airMopAlways);
-  airMopAdd(mop, dwibuff, airFree, airMopAlways);
 
-  /* set output */
+  /* the one thing taken from the given (or global) RNG is the base of
+     the per-sample seeds; so the fit depends on the RNG state, but not
+     on the number of threads */
   if (_rng) {
-    rng = _rng;
+    shr->seed = airUIrandMT_r(_rng);
   } else {
     airRandMTStateGlobalInit();
-    rng = airRandMTStateGlobal;
+    shr->seed = airUIrandMT_r(airRandMTStateGlobal);
+  }
+  shr->numSamp = nrrdElementNumber(ndwi)/ndwi->axis[0].size;
+  numThreads = nrrdThreadNum(numThreads, UINT_MAX);
+  shr->workChunk = AIR_MAX(1, shr->numSamp/(32*numThreads));
+  shr->workChunk = AIR_MIN(shr->workChunk, TEN_MODEL_FIT_CHUNK_MAX);
+  jobNum = AIR_UINT((shr->numSamp + shr->workChunk - 1)/shr->workChunk);
+  numThreads = nrrdThreadNum(numThreads, jobNum);
+  shr->task = AIR_CALLOC(numThreads, _tenModelFitTask *);
+  if (!shr->task) {
+    biffAddf(TEN, "%s: couldn't allocate %u tasks", me, numThreads);
+    airMopError(mop); return 1;
   }
-  numSamp = nrrdElementNumber(ndwi)/ndwi->axis[0].size;
-  lup = nrrdDLookup[ndwi->type];
-  ins = nrrdDInsert[typeOut];
-  parm = AIR_CAST(char *, nparm->data);
-  dwi = AIR_CAST(char *, ndwi->data);
-  itersTaken = 0;
-  if (verbose) {
+  airMopAdd(mop, shr->task, airFree, airMopAlways);
+  for (tidx=0; tidx<numThreads; tidx++) {
+    shr->task[tidx] = _tenModelFitTaskNew(shr, tidx);
+    if (!shr->task[tidx]) {
+      biffAddf(TEN, "%s: couldn't allocate task %u", me, tidx);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, shr->task[tidx], (airMopper)_tenModelFitTaskNix,
+              airMopAlways);
+  }
+  if (shr->verbose) {
     fprintf(stderr, "%s: fitting ...       ", me);
     fflush(stderr);
   }
-  for (II=0; II<numSamp; II++) {
-    double cvf, convFrac=0;
-    unsigned int ss, itak;
-    if (verbose) {
-      fprintf(stderr, "%s", airDoneStr(0, II, numSamp, doneStr));
-      fflush(stderr);
-    }
-    for (ii=0; ii<dwiNum; ii++) {
-      ddwi[ii] = lup(dwi, ii);
-    }
-    sqeBest = DBL_MAX; /* forces at least one improvement */
-    for (ss=0; ss<starts; ss++) {
-      /* can add other debugging conditions here */
-      fitVerbose = verbose;
-      if (knownB0) {
-        dparm[0] = tenExperSpecKnownB0Get(espec, ddwi);
-      }
-      model->rand(dparm, rng, knownB0);
-      sqe = model->sqeFit(dparm, &cvf, &itak,
-                          espec, dwibuff, ddwi,
-                          dparm, knownB0, minIter, maxIter,
-                          convEps, fitVerbose);
-      if (sqe <= sqeBest) {
-        sqeBest = sqe;
-        model->copy(dparmBest, dparm);
-        itersTaken = itak;
-        convFrac = cvf;
-      }
-    }
-    for (ii=0; ii<saveParmNum; ii++) {
-      ins(parm, ii, saveB0 ? dparmBest[ii] : dparmBest[ii+1]);
-    }
-    /* save things about fitting into nrrds */
-    if (nsqeP) {
-      ins(nsqe->data, II, sqeBest);
-    }
-    if (nconvP) {
-      nrrdDInsert[nrrdTypeDouble](nconv->data, II, convFrac);
-    }
-    if (niterP) {
-      nrrdDInsert[nrrdTypeUInt](niter->data, II, itersTaken);
-    }
-    parm += saveParmNum*nrrdTypeSize[typeOut];
-    dwi += espec->imgNum*nrrdTypeSize[ndwi->type];
+  if (nrrdThreadRun(numThreads, jobNum, _tenModelFitJob, shr)) {
+    biffMovef(TEN, NRRD, "%s: trouble fitting", me);
+    airMopError(mop); return 1;
+  }
+  startsTaken = 0;
+  for (tidx=0; tidx<numThreads; tidx++) {
+    startsTaken += shr->task[tidx]->startsTaken;
   }
-  if (verbose) {
-    fprintf(stderr, "%s\n", airDoneStr(0, II, numSamp, doneStr));
+  if (shr->verbose) {
+    fprintf(stderr, "%s\n", airDoneStr(0, shr->numSamp, shr->numSamp,
+                                       doneStr));
+    fprintf(stderr, "%s: used %g starts per sample (of %u)\n", me,
+            shr->numSamp ? startsTaken/shr->numSamp : 0.0,
+            shr->starts);
   }
 
-  if (nrrdAxisInfoCopy(nparm, ndwi, axmap, NRRD_AXIS_INFO_SIZE_BIT)
-      || nrrdBasicInfoCopy(nparm, ndwi,
-                           NRRD_BASIC_INFO_DATA_BIT
-                           | NRRD_BASIC_INFO_TYPE_BIT
-                           | NRRD_BASIC_INFO_BLOCKSIZE_BIT
-                           | NRRD_BASIC_INFO_DIMENSION_BIT
-                           | NRRD_BASIC_INFO_CONTENT_BIT
-                           | NRRD_BASIC_INFO_COMMENTS_BIT
-                           | (nrrdStateKeyValuePairsPropagate
-                              ? 0
-                              : NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT))) {
+  if (_tenModelFitInfoCopy(shr->nparm, ndwi, axmap)) {
     biffMovef(TEN, NRRD, "%s: couldn't copy axis or basic info", me);
     airMopError(mop); return 1;
   }
-  if (nsqeP) {
-    if (nrrdAxisInfoCopy(nsqe, ndwi, erraxmap, NRRD_AXIS_INFO_SIZE_BIT)
-        || nrrdBasicInfoCopy(nsqe, ndwi,
-                             NRRD_BASIC_INFO_DATA_BIT
-                             | NRRD_BASIC_INFO_TYPE_BIT
-                             | NRRD_BASIC_INFO_BLOCKSIZE_BIT
-                             | NRRD_BASIC_INFO_DIMENSION_BIT
-                             | NRRD_BASIC_INFO_CONTENT_BIT
-                             | NRRD_BASIC_INFO_COMMENTS_BIT
-                             | (nrrdStateKeyValuePairsPropagate
-                                ? 0
-                                : NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT))) {
-      biffMovef(TEN, NRRD,
-                "%s: couldn't copy axis or basic info to error out", me);
-      airMopError(mop); return 1;
-    }
-  }
-  if (nconvP) {
-    if (nrrdAxisInfoCopy(nconv, ndwi, erraxmap, NRRD_AXIS_INFO_SIZE_BIT)
-        || nrrdBasicInfoCopy(nconv, ndwi,
-                             NRRD_BASIC_INFO_DATA_BIT
-                             | NRRD_BASIC_INFO_TYPE_BIT
-                             | NRRD_BASIC_INFO_BLOCKSIZE_BIT
-                             | NRRD_BASIC_INFO_DIMENSION_BIT
-                             | NRRD_BASIC_INFO_CONTENT_BIT
-                             | NRRD_BASIC_INFO_COMMENTS_BIT
-                             | (nrrdStateKeyValuePairsPropagate
-                                ? 0
-                                : NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT))) {
-      biffMovef(TEN, NRRD,
-                "%s: couldn't copy axis or basic info to conv out", me);
-      airMopError(mop); return 1;
-    }
-  }
-  if (niterP) {
-    if (nrrdAxisInfoCopy(niter, ndwi, erraxmap, NRRD_AXIS_INFO_SIZE_BIT)
-        || nrrdBasicInfoCopy(niter, ndwi,
-                             NRRD_BASIC_INFO_DATA_BIT
-                             | NRRD_BASIC_INFO_TYPE_BIT
-                             | NRRD_BASIC_INFO_BLOCKSIZE_BIT
-                             | NRRD_BASIC_INFO_DIMENSION_BIT
-                             | NRRD_BASIC_INFO_CONTENT_BIT
-                             | NRRD_BASIC_INFO_COMMENTS_BIT
-                             | (nrrdStateKeyValuePairsPropagate
-                                ? 0
-                                : NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT))) {
-      biffMovef(TEN, NRRD,
-                "%s: couldn't copy axis or basic info to iter out", me);
-      airMopError(mop); return 1;
-    }
+  if ((shr->nerr && _tenModelFitInfoCopy(shr->nerr, ndwi, erraxmap))
+      || (shr->nconv && _tenModelFitInfoCopy(shr->nconv, ndwi, erraxmap))
+      || (shr->niter && _tenModelFitInfoCopy(shr->niter, ndwi, erraxmap))) {
+    biffMovef(TEN, NRRD, "%s: couldn't copy axis or basic info to "
+              "error, conv, or iter out", me);
+    airMopError(mop); return 1;
   }
   lablen = (strlen(tenModelPrefixStr)
-            + (saveB0 ? strlen("B0+") : 0)
-            + strlen(model->name)
+            + (shr->saveB0 ? strlen("B0+") : 0)
+            + strlen(shr->model->name)
             + 1);
-  nparm->axis[0].label = AIR_CALLOC(lablen, char);
-  sprintf(nparm->axis[0].label, "%s%s%s",
+  airFree(shr->nparm->axis[0].label);
+  shr->nparm->axis[0].label = AIR_CALLOC(lablen, char);
+  sprintf(shr->nparm->axis[0].label, "%s%s%s",
           tenModelPrefixStr,
-          saveB0 ? "B0+" : "",
-          model->name);
+          shr->saveB0 ? "B0+" : "",
+          shr->model->name);
 
   airMopOkay(mop);
   return 0;
 }
 
+/*
+******** tenModelSqeFit
+**
+** least-squares fitting of given model at every sample of ndwi, with
+** "starts" random starting points per sample.  Samples are distributed
+** among numThreads threads (nrrdStateNumThreads if numThreads is 0) with
+** nrrdThreadRun; the fit at each sample uses an RNG seeded from the
+** sample index (and one draw from the given rng, or the global one if
+** rng is NULL), so results do not depend on numThreads.  If startsAgree
+** is non-zero, the starts at a sample are cut short once that many of
+** them have converged to the same best fit.
+*/
 int
-tenModelNllFit(Nrrd *nparm, Nrrd **nnllP,
+tenModelSqeFit(Nrrd *nparm,
+               Nrrd **nsqeP, Nrrd **nconvP, Nrrd **niterP,
                const tenModel *model,
                const tenExperSpec *espec, const Nrrd *ndwi,
-               int rician, double sigma, int knownB0) {
-
-  AIR_UNUSED(nparm);
-  AIR_UNUSED(nnllP);
-  AIR_UNUSED(model);
-  AIR_UNUSED(espec);
-  AIR_UNUSED(ndwi);
-  AIR_UNUSED(rician);
-  AIR_UNUSED(sigma);
-  AIR_UNUSED(knownB0);
+               int knownB0, int saveB0, int typeOut,
+               unsigned int minIter, unsigned int maxIter,
+               unsigned int starts, unsigned int startsAgree,
+               double convEps, airRandMTState *rng,
+               unsigned int numThreads, int verbose) {
+  static const char me[]="tenModelSqeFit";
+  _tenModelFitShared shr;
+
+  memset(&shr, 0, sizeof(shr));
+  shr.model = model;
+  shr.espec = espec;
+  shr.ndwi = ndwi;
+  shr.knownB0 = knownB0;
+  shr.saveB0 = saveB0;
+  shr.nll = AIR_FALSE;
+  shr.verbose = verbose;
+  shr.convEps = convEps;
+  shr.minIter = minIter;
+  shr.maxIter = maxIter;
+  shr.starts = starts;
+  shr.startsAgree = startsAgree;
+  shr.nparm = nparm;
+  if (_tenModelFit(me, &shr, nsqeP, nconvP, niterP,
+                   typeOut, rng, numThreads)) {
+    biffAddf(TEN, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
 
+/*
+******** tenModelNllFit
+**
+** like tenModelSqeFit, but minimizing negative log-likelihood (with
+** Rician noise if "rician", else Gaussian) with noise parameter sigma.
+** The per-start fitting is done by the model's nllFit method; for
+** models without one (currently all of them), this is a biff error.
+*/
+int
+tenModelNllFit(Nrrd *nparm, Nrrd **nnllP,
+               const tenModel *model,
+               const tenExperSpec *espec, const Nrrd *ndwi,
+               int rician, double sigma, int knownB0, int saveB0,
+               int typeOut, unsigned int starts, unsigned int startsAgree,
+               double convEps, airRandMTState *rng,
+               unsigned int numThreads, int verbose) {
+  static const char me[]="tenModelNllFit";
+  _tenModelFitShared shr;
+
+  if (!model) {
+    biffAddf(TEN, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!model->nllFit) {
+    biffAddf(TEN, "%s: sorry, no maximum-likelihood fitting implemented "
+             "for model %s", me, model->name);
+    return 1;
+  }
+  if (!( sigma > 0 )) {
+    biffAddf(TEN, "%s: need positive sigma (not %g)", me, sigma);
+    return 1;
+  }
+  memset(&shr, 0, sizeof(shr));
+  shr.model = model;
+  shr.espec = espec;
+  shr.ndwi = ndwi;
+  shr.knownB0 = knownB0;
+  shr.saveB0 = saveB0;
+  shr.nll = AIR_TRUE;
+  shr.rician = rician;
+  shr.sigma = sigma;
+  shr.verbose = verbose;
+  shr.convEps = convEps;
+  shr.starts = starts;
+  shr.startsAgree = startsAgree;
+  shr.nparm = nparm;
+  if (_tenModelFit(me, &shr, nnllP, NULL, NULL,
+                   typeOut, rng, numThreads)) {
+    biffAddf(TEN, "%s: trouble", me);
+    return 1;
+  }
   return 0;
 }
 
@@ -28,7 +28,9 @@
 static const char *_tend_anvolInfoL =
   (INFO
    ".  The anisotropy value will be zero in the locations which "
-   "don't meet the given confidence threshold.");
+   "don't meet the given confidence threshold.  Multiple metrics can "
+   "be computed in one pass; the output then has the different metrics "
+   "along a new first axis.");
 
 int
 tend_anvolMain(int argc, const char **argv, const char *me,
@@ -38,16 +40,26 @@ tend_anvolMain(int argc, const char **argv, const char *me,
   char *perr, *err;
   airArray *mop;
 
-  int aniso;
+  int *aniso;
+  unsigned int anisoNum, numThreads;
+  int closedForm;
   Nrrd *nin, *nout;
   char *outS;
   float thresh;
 
-  hestOptAdd(&hopt, "a", "aniso", airTypeEnum, 1, 1, &aniso, NULL,
-             "Which anisotropy metric to plot.  " TEN_ANISO_DESC,
-             NULL, tenAniso);
+  hestOptAdd(&hopt, "a", "aniso", airTypeEnum, 1, -1, &aniso, NULL,
+             "Which anisotropy metric(s) to compute.  " TEN_ANISO_DESC,
+             &anisoNum, tenAniso);
   hestOptAdd(&hopt, "t", "thresh", airTypeFloat, 1, 1, &thresh, "0.5",
              "confidence threshold");
+  hestOptAdd(&hopt, "cf", NULL, airTypeInt, 0, 0, &closedForm, NULL,
+             "compute eigenvalues in closed form, which is faster, but "
+             "eigenvalue-based measures are then not exactly those of "
+             "\"tend anvol\" with one measure at a time");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &numThreads, "0",
+             "number of threads to use, or 0 to use the "
+             "NRRD_STATE_NUM_THREADS environment variable "
+             "(or 1 if that isn't set)");
   hestOptAdd(&hopt, "i", "nin", airTypeOther, 1, 1, &nin, "-",
              "input diffusion tensor volume", NULL, NULL, nrrdHestNrrd);
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
@@ -61,7 +73,8 @@ tend_anvolMain(int argc, const char **argv, const char *me,
 
   nout = nrrdNew();
   airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
-  if (tenAnisoVolume(nout, nin, aniso, thresh)) {
+  if (tenAnisoVolumeMulti(nout, nin, aniso, anisoNum, thresh,
+                          closedForm, numThreads)) {
     airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble making aniso volume:\n%s\n", me, err);
     airMopError(mop); return 1;
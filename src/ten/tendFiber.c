@@ -41,11 +41,11 @@ tend_fiberMain(int argc, const char **argv, const char *me,
   tenFiberContext *tfx;
   tenFiberSingle *tfbs;
   NrrdKernelSpec *ksp;
-  double start[3], step, *_stop, *stop;
+  double start[3], step, *_stop, *stop, errTol, stepMinMax[2];
   const airEnum *ftypeEnum;
   char *ftypeS;
   int E, intg, useDwi, allPaths, verbose, worldSpace, worldSpaceOut,
-    ftype, ftypeDef;
+    ftype, ftypeDef, numThreads, seedSort, resample;
   Nrrd *nin, *nseed, *nmat, *_nmat;
   unsigned int si, stopLen, whichPath;
   double matx[16]={1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
@@ -83,7 +83,17 @@ tend_fiberMain(int argc, const char **argv, const char *me,
              "output should be in worldspace, even if input is not "
              "(this feature is unstable and/or confusing)");
   hestOptAdd(&hopt, "step", "step size", airTypeDouble, 1, 1, &step, "0.01",
-             "stepsize along fiber, in world space");
+             "stepsize along fiber, in world space (with \"-n rk45\", "
+             "only the initial step size)");
+  hestOptAdd(&hopt, "tol", "tolerance", airTypeDouble, 1, 1, &errTol,
+             "0.0001", "with \"-n rk45\": error allowed per step, "
+             "in world space");
+  hestOptAdd(&hopt, "smm", "min max", airTypeDouble, 2, 2, stepMinMax,
+             "0 0", "with \"-n rk45\": range of allowed step sizes; "
+             "0 means stepsize/10 or 10*stepsize, respectively");
+  hestOptAdd(&hopt, "rs", NULL, airTypeInt, 0, 0, &resample, NULL,
+             "resample fiber vertices to uniform spacing (given by "
+             "\"-step\") along the fiber, which is useful with \"-n rk45\"");
   hestOptAdd(&hopt, "stop", "stop1", airTypeOther, 1, -1, &_stop, NULL,
              "the conditions that should signify the end of a fiber, or "
              "when to discard a fiber that is done propagating. "
@@ -109,6 +119,13 @@ tend_fiberMain(int argc, const char **argv, const char *me,
              &stopLen, NULL, tendFiberStopCB);
   hestOptAdd(&hopt, "v", "verbose", airTypeInt, 1, 1, &verbose, "0",
              "verbosity level");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeInt, 1, 1, &numThreads, "1",
+             "number of threads to use for tracing from multiple seeds "
+             "(with \"-ap\"); the output does not depend on this");
+  hestOptAdd(&hopt, "ss", NULL, airTypeInt, 0, 0, &seedSort, NULL,
+             "with \"-ap\", trace seeds in Z-order of their position, "
+             "rather than the order given, for better memory locality "
+             "(the order of fibers in the output is unchanged)");
   hestOptAdd(&hopt, "nmat", "transform", airTypeOther, 1, 1, &_nmat, "",
              "a 4x4 homogenous transform matrix (as a nrrd, or just a text "
              "file) given with this option will be applied to the output "
@@ -218,6 +235,12 @@ tend_fiberMain(int argc, const char **argv, const char *me,
   if (!E) E |= tenFiberParmSet(tfx, tenFiberParmStepSize, step);
   if (!E) E |= tenFiberParmSet(tfx, tenFiberParmUseIndexSpace,
                                worldSpace ? AIR_FALSE: AIR_TRUE);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmNumThreads, numThreads);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmSeedSort, seedSort);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmErrTol, errTol);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmStepSizeMin, stepMinMax[0]);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmStepSizeMax, stepMinMax[1]);
+  if (!E) E |= tenFiberParmSet(tfx, tenFiberParmResample, resample);
   if (!E) E |= tenFiberUpdate(tfx);
   if (E) {
     airMopAdd(mop, err = biffGetDone(TEN), airFree, airMopAlways);
@@ -299,6 +299,12 @@ tend_glyphMain(int argc, const char **argv, const char *me,
   hestOptAdd(&hopt, "ns", "# samp", airTypeInt, 1, 1, &(eparm->numSamples),"4",
              "(* ray-traced only *) "
              "number of samples per pixel (must be a square number)");
+  hestOptAdd(&hopt, "adt", "thresh", airTypeFloat, 1, 1,
+             &(eparm->adaptThresh), "0",
+             "(* ray-traced only *) "
+             "if non-zero, progressive sampling: first one sample per "
+             "pixel, then \"-ns\" samples only where the color variance "
+             "in the 3x3 pixel neighborhood exceeds this threshold");
   if (airThreadCapable) {
     hestOptAdd(&hopt, "nt", "# threads", airTypeInt, 1, 1,
                &(eparm->numThreads), "1",
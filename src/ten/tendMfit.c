@@ -40,7 +40,7 @@ tend_mfitMain(int argc, const char **argv, const char *me,
   Nrrd *nin, *nout, *nterr, *nconv, *niter;
   char *outS, *terrS, *convS, *iterS, *modS;
   int knownB0, saveB0, verbose, mlfit, typeOut;
-  unsigned int maxIter, minIter, starts;
+  unsigned int maxIter, minIter, starts, startsAgree, numThreads;
   double sigma, eps;
   const tenModel *model;
   tenExperSpec *espec;
@@ -55,9 +55,19 @@ tend_mfitMain(int argc, const char **argv, const char *me,
   hestOptAdd(&hopt, "ns", "# starts", airTypeUInt, 1, 1, &starts, "1",
              "number of random starting points at which to initialize "
              "fitting");
+  hestOptAdd(&hopt, "sa", "# agree", airTypeUInt, 1, 1, &startsAgree, "0",
+             "if non-zero, stop trying more starting points at a sample "
+             "once this many of them have converged (to within \"-eps\") "
+             "to the best fit found so far. By default (0), all "
+             "\"-ns\" starting points are always used.");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &numThreads, "0",
+             "number of threads to fit with; the results do not depend "
+             "on the number of threads. By default (0), the number of "
+             "threads is nrrdStateNumThreads.");
   hestOptAdd(&hopt, "ml", NULL, airTypeInt, 0, 0, &mlfit, NULL,
              "do ML fitting, rather than least-squares, which also "
-             "requires setting \"-sigma\"");
+             "requires setting \"-sigma\". Currently no model implements "
+             "ML fitting, so this is an error.");
   hestOptAdd(&hopt, "sigma", "sigma", airTypeDouble, 1, 1, &sigma, "nan",
              "Gaussian/Rician noise parameter");
   hestOptAdd(&hopt, "eps", "eps", airTypeDouble, 1, 1, &eps, "0.01",
@@ -119,17 +129,35 @@ tend_mfitMain(int argc, const char **argv, const char *me,
     fprintf(stderr, "%s: trouble getting exper from kvp:\n%s\n", me, err);
     airMopError(mop); return 1;
   }
-  if (tenModelSqeFit(nout,
-                     airStrlen(terrS) ? &nterr : NULL,
-                     airStrlen(convS) ? &nconv : NULL,
-                     airStrlen(iterS) ? &niter : NULL,
-                     model, espec, nin,
-                     knownB0, saveB0, typeOut,
-                     minIter, maxIter, starts, eps,
-                     NULL, verbose)) {
-    airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
-    fprintf(stderr, "%s: trouble fitting:\n%s\n", me, err);
-    airMopError(mop); return 1;
+  if (mlfit) {
+    if (airStrlen(convS) || airStrlen(iterS)) {
+      fprintf(stderr, "%s: can't save convergence or iterations "
+              "with ML fitting\n", me);
+      airMopError(mop); return 1;
+    }
+    if (tenModelNllFit(nout,
+                       airStrlen(terrS) ? &nterr : NULL,
+                       model, espec, nin,
+                       AIR_TRUE /* rician */, sigma, knownB0, saveB0,
+                       typeOut, starts, startsAgree, eps,
+                       NULL, numThreads, verbose)) {
+      airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble fitting:\n%s\n", me, err);
+      airMopError(mop); return 1;
+    }
+  } else {
+    if (tenModelSqeFit(nout,
+                       airStrlen(terrS) ? &nterr : NULL,
+                       airStrlen(convS) ? &nconv : NULL,
+                       airStrlen(iterS) ? &niter : NULL,
+                       model, espec, nin,
+                       knownB0, saveB0, typeOut,
+                       minIter, maxIter, starts, startsAgree, eps,
+                       NULL, numThreads, verbose)) {
+      airMopAdd(mop, err=biffGetDone(TEN), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble fitting:\n%s\n", me, err);
+      airMopError(mop); return 1;
+    }
   }
 
   if (nrrdSave(outS, nout, NULL)
@@ -35,9 +35,54 @@ static const char *_unrrdu_cmedianInfoL =
  "of bins in the histogram, which probably means a loss of precision for "
  "anything except 8-bit data.  Also, integral values can be recovered "
  "exactly only when the number of bins is exactly min-max+1 (as reported "
- "by \"unu minmax\").\n "
- "* Uses nrrdCheapMedian, plus nrrdSlice and nrrdJoin in "
- "case of \"-c\"");
+ "by \"unu minmax\"). "
+ "With \"-exact\", a different (constant time per sample) "
+ "method gives exact medians, or other quantiles, as long as there are "
+ "at most as many distinct values as bins (by default 65536, enough for "
+ "any 8- or 16-bit data); a warning is printed otherwise.\n "
+ "* Uses nrrdCheapMedian or nrrdExactMedian, plus nrrdSlice and "
+ "nrrdJoin in case of \"-c\"");
+
+/* the default number of bins with "-exact"; the histograms take
+   (at most) 4*bins bytes per sample on a scanline, per thread */
+#define CMEDIAN_EXACT_BINS 65536
+
+/*
+** sets *quantP to whether nrrdExactMedian will have to quantize nin,
+** because it has more than bins distinct values
+*/
+static int
+cmedianQuantizes(int *quantP, const Nrrd *nin, unsigned int bins,
+                 airArray *mop) {
+  double (*lup)(const void *, size_t), *val;
+  NrrdRange *range;
+  size_t II, NN, distNum;
+
+  range = nrrdRangeNewSet(nin, nrrdBlind8BitRangeFalse);
+  airMopAdd(mop, range, (airMopper)nrrdRangeNix, airMopAlways);
+  if (nrrdTypeIsIntegral[nin->type]
+      && range->max - range->min + 1 <= bins) {
+    *quantP = AIR_FALSE;
+    return 0;
+  }
+  NN = nrrdElementNumber(nin);
+  val = AIR_CALLOC(NN, double);
+  if (!val) {
+    return 1;
+  }
+  lup = nrrdDLookup[nin->type];
+  for (II=0; II<NN; II++) {
+    val[II] = lup(nin->data, II);
+  }
+  qsort(val, NN, sizeof(double), nrrdValCompare[nrrdTypeDouble]);
+  distNum = NN ? 1 : 0;
+  for (II=1; II<NN && distNum <= bins; II++) {
+    distNum += (val[II] != val[II-1]);
+  }
+  free(val);
+  *quantP = (distNum > bins);
+  return 0;
+}
 
 int
 unrrdu_cmedianMain(int argc, const char **argv, const char *me,
@@ -45,10 +90,11 @@ unrrdu_cmedianMain(int argc, const char **argv, const char *me,
   hestOpt *opt = NULL;
   char *out, *err;
   Nrrd *nin, *nout, *ntmp, **mnout;
-  int pad, pret, mode, chan, ni, nsize;
-  unsigned int bins, radius;
+  int pad, pret, mode, chan, ni, nsize, exact, ret, quantize;
+  unsigned int bins, radius, numThreads;
   airArray *mop;
   float wght;
+  double quant;
 
   hestOptAdd(&opt, "r,radius", "radius", airTypeUInt, 1, 1, &radius, NULL,
              "how big a window to filter over. \"-r 1\" leads to a "
@@ -57,10 +103,11 @@ unrrdu_cmedianMain(int argc, const char **argv, const char *me,
              "By default, median filtering is done.  Using this option "
              "enables mode filtering, in which the most common value is "
              "used as output");
-  hestOptAdd(&opt, "b,bins", "num", airTypeUInt, 1, 1, &bins, "256",
+  hestOptAdd(&opt, "b,bins", "num", airTypeUInt, 1, 1, &bins, "0",
              "# of bins in histogram.  It is in your interest to minimize "
              "this number, since big histograms mean slower execution "
-             "times.  8-bit data needs at most 256 bins.");
+             "times.  8-bit data needs at most 256 bins. By default (0), "
+             "256 bins, or with \"-exact\", 65536.");
   hestOptAdd(&opt, "w,weight", "weight", airTypeFloat, 1, 1, &wght, "1.0",
              "How much higher to preferentially weight samples that are "
              "closer to the center of the window.  \"1.0\" weight means that "
@@ -76,6 +123,20 @@ unrrdu_cmedianMain(int argc, const char **argv, const char *me,
              "and crop the output, so as to "
              "overcome our cheapness and correctly "
              "handle the border.  Obviously, this takes more memory.");
+  hestOptAdd(&opt, "exact", NULL, airTypeInt, 0, 0, &exact, NULL,
+             "Do exact median (or quantile) filtering, with a histogram "
+             "of the input's distinct values, falling back (with a "
+             "warning) to \"-b\" bins if there are more distinct values "
+             "than that. Can't be used with \"-mode\" or \"-w\".");
+  hestOptAdd(&opt, "q,quantile", "q", airTypeDouble, 1, 1, &quant, "nan",
+             "only with \"-exact\": which quantile of the window values "
+             "to output: 0.5 for median, 0 for minimum, 1 for maximum. "
+             "By default, 0.5.");
+  hestOptAdd(&opt, "nt,numthreads", "num", airTypeUInt, 1, 1,
+             &numThreads, "0",
+             "with \"-exact\": number of threads to use, or 0 to use "
+             "the NRRD_STATE_NUM_THREADS environment variable "
+             "(or 1 if that isn't set)");
   hestOptAdd(&opt, "c,channel", NULL, airTypeInt, 0, 0, &chan, NULL,
              "Slice the input along axis 0, run filtering on all slices, "
              "and join the results back together.  This is the way you'd "
@@ -92,6 +153,39 @@ unrrdu_cmedianMain(int argc, const char **argv, const char *me,
 
   nout = nrrdNew();
   airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  if (exact && (mode || 1.0 != wght)) {
+    fprintf(stderr, "%s: can't use \"-exact\" with \"-mode\" "
+            "or non-uniform weighting\n", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (!exact && AIR_EXISTS(quant)) {
+    fprintf(stderr, "%s: can't use \"-q\" without \"-exact\"\n", me);
+    airMopError(mop);
+    return 1;
+  }
+  if (!AIR_EXISTS(quant)) {
+    quant = 0.5;
+  }
+  if (!bins) {
+    bins = exact ? CMEDIAN_EXACT_BINS : 256;
+  }
+  if (exact) {
+    if (cmedianQuantizes(&quantize, nin, bins, mop)) {
+      fprintf(stderr, "%s: couldn't allocate buffer to count values\n", me);
+      airMopError(mop);
+      return 1;
+    }
+    if (quantize) {
+      fprintf(stderr, "%s: WARNING: input has more than %u distinct "
+              "values, so they will be quantized to %u bins, and the "
+              "output won't be exact (use bigger \"-b\")\n", me,
+              bins, bins);
+    }
+  }
+  if (numThreads) {
+    nrrdStateNumThreads = numThreads;
+  }
 
   if (chan) {
     nsize = AIR_UINT(nin->axis[0].size);
@@ -108,9 +202,13 @@ unrrdu_cmedianMain(int argc, const char **argv, const char *me,
         return 1;
       }
       airMopAdd(mop, mnout[ni] = nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-      if (nrrdCheapMedian(mnout[ni], ntmp, pad, mode, radius, wght, bins)) {
+      ret = (exact
+             ? nrrdExactMedian(mnout[ni], ntmp, pad, radius, quant, bins)
+             : nrrdCheapMedian(mnout[ni], ntmp, pad, mode, radius,
+                               wght, bins));
+      if (ret) {
         airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
-        fprintf(stderr, "%s: error doing cheap median:\n%s", me, err);
+        fprintf(stderr, "%s: error doing median:\n%s", me, err);
         airMopError(mop);
         return 1;
       }
@@ -138,9 +236,12 @@ unrrdu_cmedianMain(int argc, const char **argv, const char *me,
       return 1;
     }
   } else {
-    if (nrrdCheapMedian(nout, nin, pad, mode, radius, wght, bins)) {
+    ret = (exact
+           ? nrrdExactMedian(nout, nin, pad, radius, quant, bins)
+           : nrrdCheapMedian(nout, nin, pad, mode, radius, wght, bins));
+    if (ret) {
       airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
-      fprintf(stderr, "%s: error doing cheap median:\n%s", me, err);
+      fprintf(stderr, "%s: error doing median:\n%s", me, err);
       airMopError(mop);
       return 1;
     }
@@ -45,6 +45,7 @@ unrrdu_distMain(int argc, const char **argv, const char *me,
   int pret;
 
   int E, typeOut, invert, sign;
+  unsigned int numThreads;
   double thresh, bias;
   airArray *mop;
 
@@ -62,6 +63,11 @@ unrrdu_distMain(int argc, const char **argv, const char *me,
              "values *below* threshold are considered interior to object. "
              "By default (not using this option), values above threshold "
              "are considered interior. ");
+  hestOptAdd(&opt, "nt,numthreads", "num", airTypeUInt, 1, 1,
+             &numThreads, "0",
+             "number of threads to use, or 0 to use the "
+             "NRRD_STATE_NUM_THREADS environment variable "
+             "(or 1 if that isn't set)");
   OPT_ADD_NIN(nin, "input nrrd");
   OPT_ADD_NOUT(out, "output nrrd");
 
@@ -81,6 +87,9 @@ unrrdu_distMain(int argc, const char **argv, const char *me,
     airMopError(mop);
     return 1;
   }
+  if (numThreads) {
+    nrrdStateNumThreads = numThreads;
+  }
 
   if (sign) {
     E = nrrdDistanceL2Signed(nout, nin, typeOut, NULL, thresh, !invert);
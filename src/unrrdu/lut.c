@@ -43,6 +43,7 @@ unrrdu_lutMain(int argc, const char **argv, const char *me,
   Nrrd *nin, *nlut, *nout;
   airArray *mop;
   int typeOut, rescale, pret, blind8BitRange;
+  unsigned int numThreads;
   double min, max;
   NrrdRange *range=NULL;
 
@@ -74,6 +75,11 @@ unrrdu_lutMain(int argc, const char **argv, const char *me,
              "By default (not using this option), the output type "
              "is the lut's type.",
              NULL, NULL, &unrrduHestMaybeTypeCB);
+  hestOptAdd(&opt, "nt,numthreads", "num", airTypeUInt, 1, 1,
+             &numThreads, "0",
+             "number of threads to use, or 0 to use the "
+             "NRRD_STATE_NUM_THREADS environment variable "
+             "(or 1 if that isn't set)");
   OPT_ADD_NIN(nin, "input nrrd");
   OPT_ADD_NOUT(out, "output nrrd");
 
@@ -98,6 +104,9 @@ unrrdu_lutMain(int argc, const char **argv, const char *me,
     nrrdRangeSafeSet(range, nin, blind8BitRange);
   }
 
+  if (numThreads) {
+    nrrdStateNumThreads = numThreads;
+  }
   if (nrrdTypeDefault == typeOut) {
     typeOut = nlut->type;
   }
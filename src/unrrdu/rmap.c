@@ -51,6 +51,7 @@ unrrdu_rmapMain(int argc, const char **argv, const char *me,
   airArray *mop;
   NrrdRange *range=NULL;
   int typeOut, rescale, pret, blind8BitRange;
+  unsigned int numThreads;
   double min, max;
 
   hestOptAdd(&opt, "m,map", "map", airTypeOther, 1, 1, &nmap, NULL,
@@ -85,6 +86,11 @@ unrrdu_rmapMain(int argc, const char **argv, const char *me,
              "By default (not using this option), the output type "
              "is the map's type.",
              NULL, NULL, &unrrduHestMaybeTypeCB);
+  hestOptAdd(&opt, "nt,numthreads", "num", airTypeUInt, 1, 1,
+             &numThreads, "0",
+             "number of threads to use, or 0 to use the "
+             "NRRD_STATE_NUM_THREADS environment variable "
+             "(or 1 if that isn't set)");
   OPT_ADD_NIN(nin, "input nrrd");
   OPT_ADD_NOUT(out, "output nrrd");
 
@@ -115,6 +121,9 @@ unrrdu_rmapMain(int argc, const char **argv, const char *me,
     nrrdRangeSafeSet(range, nin, blind8BitRange);
   }
 
+  if (numThreads) {
+    nrrdStateNumThreads = numThreads;
+  }
   if (nrrdTypeDefault == typeOut) {
     typeOut = nmap->type;
   }